@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 namespace opengm {
 
@@ -260,6 +261,210 @@ Partition<T>::numberOfSets() const
    return numberOfSets_;
 }
 
+/// \cond HIDDEN_SYMBOLS
+namespace detail_partition {
+   template<class T>
+   inline bool compareAndSwap(T* address, const T expected, const T desired)
+   {
+      #if defined(__GNUC__) || defined(__clang__)
+      return __sync_bool_compare_and_swap(address, expected, desired);
+      #else
+      bool swapped = false;
+      #pragma omp critical(opengm_partition_compare_and_swap)
+      {
+         if(*address == expected) {
+            *address = desired;
+            swapped = true;
+         }
+      }
+      return swapped;
+      #endif
+   }
+}
+/// \endcond
+
+/// Disjoint set data structure whose find and merge operations can be
+/// called concurrently from several threads.
+///
+/// The implementation is lock-free: roots are linked by compare-and-swap,
+/// always from the larger to the smaller element (which rules out cycles),
+/// and find compresses paths by path halving.
+///
+/// \ingroup datastructures
+template<class T = size_t>
+class ConcurrentPartition {
+public:
+   typedef T value_type;
+
+   ConcurrentPartition();
+   ConcurrentPartition(const value_type&);
+
+   // query
+   value_type find(value_type); // thread-safe
+   value_type numberOfElements() const;
+   value_type numberOfSets() const; // linear time
+   template<class Iterator> void representatives(Iterator) const;
+
+   // manipulation
+   void reset(const value_type&);
+   bool merge(value_type, value_type); // thread-safe
+
+private:
+   value_type parent(const value_type) const;
+
+   std::vector<value_type> parents_;
+};
+
+/// Construct a partition.
+template<class T>
+inline
+ConcurrentPartition<T>::ConcurrentPartition()
+:  parents_()
+{}
+
+/// Construct a partition.
+///
+/// \param size Number of distinct sets.
+///
+template<class T>
+inline
+ConcurrentPartition<T>::ConcurrentPartition
+(
+   const value_type& size
+)
+:  parents_(static_cast<size_t>(size))
+{
+   reset(size);
+}
+
+/// Reset a partition such that each set contains precisely one element
+///
+/// \param size Number of distinct sets.
+///
+template<class T>
+inline void
+ConcurrentPartition<T>::reset
+(
+   const value_type& size
+)
+{
+   parents_.resize(static_cast<size_t>(size));
+   for(T j=0; j<size; ++j) {
+      parents_[static_cast<size_t>(j)] = j;
+   }
+}
+
+template<class T>
+inline typename ConcurrentPartition<T>::value_type
+ConcurrentPartition<T>::parent
+(
+   const value_type element
+) const
+{
+   // read through volatile such that concurrent updates are seen
+   return *static_cast<const volatile value_type*>(&parents_[static_cast<size_t>(element)]);
+}
+
+/// Find the representative element of the set that contains the given element.
+///
+/// This function can be called concurrently with find and merge.
+///
+/// \param element Element.
+///
+template<class T>
+inline typename ConcurrentPartition<T>::value_type
+ConcurrentPartition<T>::find
+(
+   value_type element
+)
+{
+   for(;;) {
+      const value_type p = parent(element);
+      if(p == element) {
+         return element;
+      }
+      const value_type gp = parent(p);
+      if(gp != p) {
+         // path halving, fails harmlessly if another thread was faster
+         detail_partition::compareAndSwap(&parents_[static_cast<size_t>(element)], p, gp);
+      }
+      element = gp;
+   }
+}
+
+/// Merge two sets.
+///
+/// This function can be called concurrently with find and merge.
+///
+/// \param element1 Element in the first set.
+/// \param element2 Element in the second set.
+/// \return true if the sets have been different
+///
+template<class T>
+inline bool
+ConcurrentPartition<T>::merge
+(
+   value_type element1,
+   value_type element2
+)
+{
+   for(;;) {
+      element1 = find(element1);
+      element2 = find(element2);
+      if(element1 == element2) {
+         return false;
+      }
+      if(element1 < element2) {
+         std::swap(element1, element2);
+      }
+      // link the root element1 to element2, unless element1 has been
+      // linked by another thread in the meantime
+      if(detail_partition::compareAndSwap(&parents_[static_cast<size_t>(element1)], element1, element2)) {
+         return true;
+      }
+   }
+}
+
+/// Output all elements which are set representatives.
+///
+/// \param it (Output) Iterator into a container.
+///
+template<class T>
+template<class Iterator>
+inline void
+ConcurrentPartition<T>::representatives
+(
+   Iterator it
+) const
+{
+   for(value_type j=0; j<numberOfElements(); ++j) {
+      if(parents_[static_cast<size_t>(j)] == j) {
+         *it = j;
+         ++it;
+      }
+   }
+}
+
+template<class T>
+inline typename ConcurrentPartition<T>::value_type
+ConcurrentPartition<T>::numberOfElements() const
+{
+   return static_cast<value_type>(parents_.size());
+}
+
+template<class T>
+inline typename ConcurrentPartition<T>::value_type
+ConcurrentPartition<T>::numberOfSets() const
+{
+   value_type n = 0;
+   for(value_type j=0; j<numberOfElements(); ++j) {
+      if(parents_[static_cast<size_t>(j)] == j) {
+         ++n;
+      }
+   }
+   return n;
+}
+
 } // namespace opengm
 
 #endif // #ifndef OPENGM_PARTITION_HXX
@@ -90,6 +90,7 @@ namespace opengm {
       void unlock();  
       void lock();  
       template<class ACC> void lockAndTentacelElimination(); 
+      template<class ACC> IndexType fixSmallSubModels(const IndexType);
       bool isFixed(const typename GM::IndexType)const;
 
    private:
@@ -846,6 +847,96 @@ namespace opengm {
       //std::cout <<"done "<< std::endl;
    }
  
+/// \brief fix the variables of small independent subparts to their optimal labeling
+///
+/// Connected components of the non-fixed variables with at most maxNumberOfVariables
+/// variables are optimized by enumeration, all factors connected to them are evaluated
+/// with the fixed variables set to their labels. The optimal labeling is fixed, such
+/// that no submodel is built for these components.
+/// \return number of newly fixed variables
+   template<class GM>
+   template<class ACC>
+   typename GraphicalModelManipulator<GM>::IndexType
+   GraphicalModelManipulator<GM>::fixSmallSubModels(const IndexType maxNumberOfVariables)
+   {
+      OPENGM_ASSERT(!isLocked());
+      if(isLocked() || maxNumberOfVariables==0)
+         return 0;
+
+      IndexType numberOfFixedVariables = 0;
+      std::vector<bool> closedVar = fixVariable_;
+      std::vector<bool> usedFactor(gm_.numberOfFactors(),false);
+      std::vector<IndexType> position(gm_.numberOfVariables(),0);
+      std::vector<IndexType> component;
+      std::vector<IndexType> factors;
+      std::vector<LabelType> labeling;
+      std::vector<LabelType> bestLabeling;
+      std::vector<LabelType> factorLabeling;
+
+      for(IndexType var=0; var<gm_.numberOfVariables(); ++var){
+         if(closedVar[var])
+            continue;
+
+         // collect the connected component of var (without recursion)
+         component.assign(1,var);
+         closedVar[var] = true;
+         factors.resize(0);
+         for(size_t n=0; n<component.size(); ++n){
+            for(typename GM::ConstFactorIterator itf = gm_.factorsOfVariableBegin(component[n]); itf!=gm_.factorsOfVariableEnd(component[n]); ++itf){
+               if(usedFactor[*itf])
+                  continue;
+               usedFactor[*itf] = true;
+               factors.push_back(*itf);
+               for(typename GM::ConstVariableIterator itv = gm_.variablesOfFactorBegin(*itf); itv!=gm_.variablesOfFactorEnd(*itf); ++itv){
+                  if(!closedVar[*itv]){
+                     closedVar[*itv] = true;
+                     component.push_back(*itv);
+                  }
+               }
+            }
+         }
+         if(component.size()>maxNumberOfVariables)
+            continue;
+
+         // exhaustive search over the labelings of the component
+         for(size_t n=0; n<component.size(); ++n)
+            position[component[n]] = n;
+         labeling.assign(component.size(),0);
+         bestLabeling = labeling;
+         ValueType bestValue;
+         ACC::neutral(bestValue);
+         for(;;){
+            ValueType value;
+            GM::OperatorType::neutral(value);
+            for(size_t i=0; i<factors.size(); ++i){
+               const typename GM::FactorType& factor = gm_[factors[i]];
+               factorLabeling.resize(factor.numberOfVariables());
+               for(IndexType j=0; j<factor.numberOfVariables(); ++j){
+                  const IndexType v = factor.variableIndex(j);
+                  factorLabeling[j] = fixVariable_[v] ? fixVariableLabel_[v] : labeling[position[v]];
+               }
+               GM::OperatorType::op(factor(factorLabeling.begin()),value);
+            }
+            if(ACC::bop(value,bestValue)){
+               bestValue = value;
+               bestLabeling = labeling;
+            }
+            size_t n = 0;
+            for(; n<component.size(); ++n){
+               if(++labeling[n]<gm_.numberOfLabels(component[n]))
+                  break;
+               labeling[n] = 0;
+            }
+            if(n==component.size())
+               break;
+         }
+         for(size_t n=0; n<component.size(); ++n)
+            fixVariable(component[n],bestLabeling[n]);
+         numberOfFixedVariables += component.size();
+      }
+      return numberOfFixedVariables;
+   }
+
 ////////////////////
 // Private Methods
 ////////////////////    
@@ -855,12 +946,20 @@ namespace opengm {
    {
       if(closedVar[var])
          return;
-      else{
-         closedVar[var]       = true;
-         var2subProblem_[var] = CCN;
-         for( typename GM::ConstFactorIterator itf = gm_.factorsOfVariableBegin(var); itf!=gm_.factorsOfVariableEnd(var); ++itf){
+      // explicit stack, the components can be too large for recursion
+      std::vector<IndexType> stack(1,var);
+      closedVar[var]       = true;
+      var2subProblem_[var] = CCN;
+      while(!stack.empty()){
+         const IndexType v = stack.back();
+         stack.pop_back();
+         for( typename GM::ConstFactorIterator itf = gm_.factorsOfVariableBegin(v); itf!=gm_.factorsOfVariableEnd(v); ++itf){
             for( typename  GM::ConstVariableIterator itv = gm_.variablesOfFactorBegin(*itf); itv!=gm_.variablesOfFactorEnd(*itf);++itv){
-               expand(*itv, CCN, closedVar);
+               if(!closedVar[*itv]){
+                  closedVar[*itv]       = true;
+                  var2subProblem_[*itv] = CCN;
+                  stack.push_back(*itv);
+               }
             }
          }
       }
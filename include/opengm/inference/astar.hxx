@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <iostream>
 #include <functional>
+#include <limits>
 
 #include "opengm/opengm.hxx"
 #include "opengm/graphicalmodel/graphicalmodel.hxx"
@@ -22,10 +23,39 @@ namespace opengm {
 
 /// \cond HIDDEN_SYMBOLS
 
-   // node of the search tree for the a-star search
-   template<class FactorType> struct AStarNode {
-      typename std::vector<typename FactorType::LabelType>    conf;
-      typename FactorType::ValueType     value;
+   // node of the search tree for the a-star search, the labels of the
+   // labeled variables are stored bit-packed in the node arena of AStar
+   template<class ValueType> struct AStarNode {
+      ValueType value;                // bound of all labelings below the node
+      ValueType familyBound;          // best bound of the children (frontier nodes only)
+      size_t    parent;
+      size_t    firstChild;
+      size_t    nextSibling;
+      size_t    depth;                // number of labeled variables
+      size_t    numberOfChildren;
+      size_t    numberOfInnerChildren; // children that have been expanded
+      bool      open;
+      bool      frontier;             // has children, none of them expanded
+   };
+
+   // entry of the open list and of the list of frontier nodes
+   template<class ValueType> struct AStarEntry {
+      AStarEntry(const ValueType v, const size_t d, const size_t n)
+      :  value(v), depth(d), node(n)
+      {}
+      ValueType value;
+      size_t    depth;
+      size_t    node;
+   };
+
+   // best bound first, ties are broken in favor of deeper nodes
+   template<class ACC, class ValueType> struct AStarEntryLess {
+      bool operator()(const AStarEntry<ValueType>& a, const AStarEntry<ValueType>& b) const {
+         if(ACC::bop(a.value, b.value)) return true;
+         if(ACC::bop(b.value, a.value)) return false;
+         if(a.depth != b.depth) return a.depth > b.depth;
+         return a.node < b.node;
+      }
    };
 /*
    template<class AStar, bool Verbose=false>
@@ -59,6 +89,14 @@ namespace opengm {
    /// to underestimate the cost to a goal node. This lower bound allows us to reduce the search to an
    /// manageable subspace of the exponentially large search-space.
    ///
+   /// The search is memory-bounded (SMA*-like): at most maxHeapSize_ search
+   /// nodes are kept in an arena in which partial labelings are bit-packed.
+   /// If the arena is full, the children of the node with the worst bound
+   /// among all nodes whose children are unexpanded are forgotten and their
+   /// best bound is backed up into the parent, which is re-expanded when
+   /// needed. Hence, the solutions remain optimal, which is reported by
+   /// optimal().
+   ///
    /// \ingroup inference
    template<class GM,class ACC>
    class AStar : public Inference<GM,ACC>
@@ -110,6 +148,7 @@ namespace opengm {
         :   maxHeapSize_(p.maxHeapSize_),
             numberOfOpt_(p.numberOfOpt_),
             objectiveBound_(p.objectiveBound_),
+            heuristic_(p.heuristic_),
             nodeOrder_(p.nodeOrder_),
             treeFactorIds_(p.treeFactorIds_){
         }
@@ -124,7 +163,7 @@ namespace opengm {
         static const size_t FASTHEURISTIC = 1;
         /// STANDARDHEURISTIC
         static const size_t STANDARDHEURISTIC = 2;
-        /// maxHeapSize_ maximum size of the heap
+        /// maxHeapSize_ maximum number of search nodes kept in memory
         size_t maxHeapSize_;
         /// number od N-best solutions that should be found
         size_t              numberOfOpt_;
@@ -149,18 +188,50 @@ namespace opengm {
     template<class VisitorType> InferenceTermination infer(VisitorType& vistitor);
     ValueType bound()const {return belowBound_;}
     ValueType value()const;
+    /// true if the found solutions are proven to be the best ones
+    bool optimal() const {return optimal_;}
+    /// number of search nodes in memory
+    size_t numberOfNodes() const {return nodes_.size()-freeNodes_.size();}
     virtual InferenceTermination marginal(const size_t,IndependentFactorType& out)const        {return UNKNOWN;}
     virtual InferenceTermination factorMarginal(const size_t, IndependentFactorType& out)const {return UNKNOWN;}
     virtual InferenceTermination arg(std::vector<LabelType>& v, const size_t = 1)const;
     virtual InferenceTermination args(std::vector< std::vector<LabelType> >& v)const;
 
    private:
+      typedef AStarNode<ValueType>                          NodeType;
+      typedef AStarEntry<ValueType>                         EntryType;
+      typedef std::set<EntryType, AStarEntryLess<ACC, ValueType> > EntrySet;
+
+      // labeling independent part of the fast heuristic at one depth
+      struct HeuristicCache {
+         HeuristicCache() : valid_(false) {}
+         bool valid_;
+         // energies of the unlabeled variables
+         std::vector<std::vector<ValueType> > nodeEnergy_;
+         // factors connected to at least one labeled variable
+         std::vector<size_t> labeledFactors_;
+         // tree factors in the order of elimination, true if the first variable is eliminated
+         std::vector<std::pair<size_t, bool> > schedule_;
+         // unlabeled variables which are not eliminated, except the next one
+         std::vector<size_t> roots_;
+      };
+
       const GM&                                   gm_;
       Parameter                                   parameter_;
       // remeber passed parameter in  parameterInitial_
       // to reset astar
       Parameter                                   parameterInitial_;
-      std::vector<AStarNode<IndependentFactorType> >  array_;
+      std::vector<NodeType>                       nodes_;
+      std::vector<UInt64Type>                     labelWords_;
+      std::vector<size_t>                         freeNodes_;
+      size_t                                      wordsPerNode_;
+      std::vector<size_t>                         labelWord_;
+      std::vector<size_t>                         labelShift_;
+      std::vector<UInt64Type>                     labelMask_;
+      EntrySet                                    open_;
+      EntrySet                                    frontier_;
+      std::vector<HeuristicCache>                 heuristicCache_;
+      std::vector<std::vector<ValueType> >        nodeEnergy_;
       std::vector<size_t>                         numStates_;
       size_t                                      numNodes_;
       std::vector<IndependentFactorType>          treeFactor_;
@@ -169,14 +240,26 @@ namespace opengm {
       std::vector<bool>                           isTreeFactor_;
       ValueType                                   aboveBound_;
       ValueType                                   belowBound_;
-      template<class VisitorType> void  expand(VisitorType& vistitor);
-      std::vector<ValueType>           fastHeuristic(ConfVec conf);
-      inline static bool                comp1(const AStarNode<IndependentFactorType>& a, const AStarNode<IndependentFactorType>& b)
-         {return  AccumulationType::ibop(a.value,b.value);};
-      inline static bool                comp2(const AStarNode<IndependentFactorType>& a, const AStarNode<IndependentFactorType>& b)
-         { return  AccumulationType::bop(a.value,b.value);};
-      inline static ValueType          better(ValueType a, ValueType b)   {return AccumulationType::op(a,b);};
-      inline static ValueType          wrose(ValueType a,  ValueType b)   {return AccumulationType::iop(a,b);};
+      bool                                        optimal_;
+      static const size_t                         noNode_ = static_cast<size_t>(-1);
+
+      void                              expand(const size_t);
+      void                              makeRoom(const size_t);
+      void                              forgetChildren(const size_t);
+      void                              removeNode(size_t);
+      void                              enterFrontier(const size_t);
+      void                              leaveFrontier(const size_t);
+      void                              openNode(const size_t);
+      void                              closeNode(const size_t);
+      size_t                            allocateNode();
+      LabelType                         label(const size_t, const size_t) const;
+      void                              setLabel(const size_t, const size_t, const LabelType);
+      void                              labeling(const size_t, ConfVec&) const;
+      void                              buildHeuristicCache(const size_t);
+      void                              fastHeuristic(const ConfVec&, std::vector<ValueType>&);
+      void                              standardHeuristic(const ConfVec&, std::vector<ValueType>&);
+      inline static ValueType          better(ValueType a, ValueType b)   {ValueType r; AccumulationType::op(a,b,r); return r;};
+      inline static ValueType          wrose(ValueType a,  ValueType b)   {ValueType r; AccumulationType::iop(a,b,r); return r;};
    };
 
 
@@ -206,6 +289,7 @@ namespace opengm {
       OPENGM_ASSERT(parameter_.heuristic_ == Parameter::FASTHEURISTIC || parameter_.heuristic_ == Parameter::STANDARDHEURISTIC);
       ACC::ineutral(belowBound_);
       ACC::neutral(aboveBound_);
+      optimal_ = false;
       //Set variables
       isTreeFactor_.resize(gm_.numberOfFactors());
       numStates_.resize(gm_.numberOfVariables());
@@ -257,12 +341,27 @@ namespace opengm {
          OPENGM_ASSERT(optimizedFactor_[i].numberOfVariables() == 1);
          OPENGM_ASSERT(optimizedFactor_[i].variableIndex(0) == index[0]);
       }
-      //PUSH EMPTY CONFIGURATION TO HEAP
-      AStarNode<IndependentFactorType> a;
-      a.conf.resize(0);
-      a.value = 0;
-      array_.push_back(a);
-      make_heap(array_.begin(), array_.end(), comp1);
+      //BIT-PACKED LABELINGS: the label of the i-th variable in node order
+      //is stored in labelWord_[i] at labelShift_[i], no label spans two words
+      labelWord_.resize(numNodes_);
+      labelShift_.resize(numNodes_);
+      labelMask_.resize(numNodes_);
+      size_t word = 0;
+      size_t shift = 0;
+      for(size_t i=0; i<numNodes_; ++i) {
+         size_t bits = 0;
+         while((static_cast<UInt64Type>(1) << bits) < numStates_[parameter_.nodeOrder_[i]])
+            ++bits;
+         if(shift+bits > 64) {
+            ++word;
+            shift = 0;
+         }
+         labelWord_[i]  = word;
+         labelShift_[i] = shift;
+         labelMask_[i]  = (static_cast<UInt64Type>(1) << bits) - 1;
+         shift += bits;
+      }
+      wordsPerNode_ = word+1;
       //Check if maximal order is smaller equal 2, otherwise fall back to naive computation of heuristic
       if(parameter_.heuristic_ == parameter_.FASTHEURISTIC) {
          for(size_t i=0; i<parameter_.treeFactorIds_.size(); ++i) {
@@ -280,19 +379,26 @@ namespace opengm {
          isTreeFactor_[factorId] = true;
          treeFactor_.push_back(gm_[factorId]);
       }
+      heuristicCache_.resize(numNodes_);
    }
   
    /// \brief reset
    ///
    /// \warning  reset assumes that the structure of
    /// the graphical model has not changed
-   ///
-   /// TODO
    template<class GM, class ACC >
    void
    AStar<GM,ACC>::reset()
    {
-      ///todo
+      nodes_.clear();
+      labelWords_.clear();
+      freeNodes_.clear();
+      open_.clear();
+      frontier_.clear();
+      optConf_.clear();
+      optimal_ = false;
+      ACC::ineutral(belowBound_);
+      ACC::neutral(aboveBound_);
    }
 
    template <class GM, class ACC>
@@ -309,39 +415,54 @@ namespace opengm {
    template<class VisitorType>
    InferenceTermination AStar<GM,ACC>::infer(VisitorType& visitor)
    { 
+      //PUSH EMPTY CONFIGURATION
+      reset();
+      const size_t root = allocateNode();
+      ACC::ineutral(nodes_[root].value);
+      openNode(root);
+
       size_t exitFlag=0;
-      optConf_.resize(0);
+      InferenceTermination termination = UNKNOWN;
+      std::vector<LabelType> conf(numNodes_);
+      std::vector<LabelType> partialConf;
       visitor.begin(*this);    
-      while(array_.size()>0 && exitFlag==0) {
+      while(!open_.empty() && exitFlag==0) {
          if(parameter_.numberOfOpt_ == optConf_.size()) {
-            visitor.end(*this);
-            return NORMAL;
+            termination = NORMAL;
+            break;
          }
-         while(array_.front().conf.size() < numNodes_ && exitFlag==0) {
-            expand(visitor);
-            belowBound_ = array_.front().value;
+         const size_t node = open_.begin()->node;
+         belowBound_ = nodes_[node].value;
+         if(nodes_[node].depth < numNodes_) {
+            expand(node);
             exitFlag = visitor(*this); 
-            //visitor(*this, array_.front().conf, array_.size(), array_.front().value, globalBound_, time);
+            continue;
          }
-         if(array_.front().conf.size()>=numNodes_){
-            ValueType  value = array_.front().value;
-            belowBound_ = value;
-            std::vector<LabelType> conf(numNodes_);
-            for(size_t n=0; n<numNodes_; ++n) {
-               conf[parameter_.nodeOrder_[n]] = array_.front().conf[n];
-            } 
-            optConf_.push_back(conf);
-            visitor(*this);
-            if(ACC::bop(parameter_.objectiveBound_, value)) {
-               visitor.end(*this);
-               return NORMAL;
-            }
+         //GOAL NODE
+         const ValueType value = nodes_[node].value;
+         closeNode(node);
+         labeling(node, partialConf);
+         for(size_t n=0; n<numNodes_; ++n) {
+            conf[parameter_.nodeOrder_[n]] = partialConf[n];
+         }
+         removeNode(node);
+         // solutions are generated again if their parent has been re-expanded
+         if(std::find(optConf_.begin(), optConf_.end(), conf) != optConf_.end()) {
+            continue;
+         }
+         optConf_.push_back(conf);
+         visitor(*this);
+         if(ACC::bop(parameter_.objectiveBound_, value)) {
+            termination = NORMAL;
+            break;
          }
-         pop_heap(array_.begin(), array_.end(),  comp1); //greater<FactorType,Accumulation>);
-         array_.pop_back();
       }
+      // goal nodes are popped in the order of their values and no labeling
+      // is lost due to the memory bound, hence all found solutions are
+      // optimal unless the search has been stopped before
+      optimal_ = (exitFlag==0);
       visitor.end(*this);     
-      return UNKNOWN;
+      return termination;
    } 
 
    template<class GM, class ACC>
@@ -381,328 +502,493 @@ namespace opengm {
    }
 
    template<class GM, class ACC>
-   template<class VisitorType>
-   void AStar<GM, ACC>::expand(VisitorType& visitor)
+   size_t AStar<GM, ACC>::allocateNode()
    {
-      //CHECK HEAP SIZE
-      if(array_.size()>parameter_.maxHeapSize_*0.99) {
-         partial_sort(array_.begin(), array_.begin()+(int)(parameter_.maxHeapSize_/2), array_.end(),  comp2);
-         array_.resize((int)(parameter_.maxHeapSize_/2));
-      }
-      //GET HEAP HEAD
-      AStarNode<IndependentFactorType> a           = array_.front();
-      size_t            subconfsize = a.conf.size();
-      //REMOVE HEAD FROM HEAP
-      OPENGM_ASSERT(array_.size() > 0);
-      pop_heap(array_.begin(), array_.end(),  comp1); //greater<FactorType,Accumulation>);
-      array_.pop_back();
-      if( parameter_.heuristic_ == parameter_.STANDARDHEURISTIC) { 
+      size_t node;
+      if(freeNodes_.size()>0) {
+         node = freeNodes_.back();
+         freeNodes_.pop_back();
+      }
+      else{
+         node = nodes_.size();
+         nodes_.push_back(NodeType());
+         labelWords_.resize(labelWords_.size()+wordsPerNode_);
+      }
+      NodeType& n = nodes_[node];
+      n.parent                = noNode_;
+      n.firstChild            = noNode_;
+      n.nextSibling           = noNode_;
+      n.depth                 = 0;
+      n.numberOfChildren      = 0;
+      n.numberOfInnerChildren = 0;
+      n.open                  = false;
+      n.frontier              = false;
+      std::fill(labelWords_.begin()+node*wordsPerNode_, labelWords_.begin()+(node+1)*wordsPerNode_, static_cast<UInt64Type>(0));
+      return node;
+   }
 
-         //BUILD GRAPHICAL MODEL FOR HEURISTC CALCULATION
-          
-         typedef typename opengm::DiscreteSpace<IndexType, LabelType> MSpaceType;
-         typedef typename meta::TypeListGenerator< ExplicitFunction<ValueType,IndexType,LabelType>, ViewFixVariablesFunction<GM>, ViewFunction<GM>, ConstantFunction<ValueType, IndexType, LabelType> >::type MFunctionTypeList;
-         typedef GraphicalModel<ValueType, typename GM::OperatorType, MFunctionTypeList, MSpaceType> MGM;
-
-         IndexType numberOfVariables = 0;
-         std::vector<IndexType> varMap(gm_.numberOfVariables(),0);
-         std::vector<LabelType> fixVariableLabel(gm_.numberOfVariables(),0);
-         std::vector<bool> fixVariable(gm_.numberOfVariables(),false);
-         for(size_t i =0; i<subconfsize ; ++i) {
-            fixVariableLabel[parameter_.nodeOrder_[i]] = a.conf[i];
-            fixVariable[parameter_.nodeOrder_[i]] = true;
-         }
+   template<class GM, class ACC>
+   inline typename AStar<GM, ACC>::LabelType
+   AStar<GM, ACC>::label(const size_t node, const size_t i) const
+   {
+      return static_cast<LabelType>((labelWords_[node*wordsPerNode_+labelWord_[i]] >> labelShift_[i]) & labelMask_[i]);
+   }
 
-         for(IndexType var=0; var<gm_.numberOfVariables();++var){
-            if(fixVariable[var]==false){
-               varMap[var] = numberOfVariables++;
-            }
+   template<class GM, class ACC>
+   inline void
+   AStar<GM, ACC>::setLabel(const size_t node, const size_t i, const LabelType l)
+   {
+      UInt64Type& word = labelWords_[node*wordsPerNode_+labelWord_[i]];
+      word &= ~(labelMask_[i] << labelShift_[i]);
+      word |= static_cast<UInt64Type>(l) << labelShift_[i];
+   }
+
+   template<class GM, class ACC>
+   void
+   AStar<GM, ACC>::labeling(const size_t node, ConfVec& conf) const
+   {
+      conf.resize(nodes_[node].depth);
+      for(size_t i=0; i<conf.size(); ++i)
+         conf[i] = label(node, i);
+   }
+
+   template<class GM, class ACC>
+   inline void AStar<GM, ACC>::openNode(const size_t node)
+   {
+      nodes_[node].open = true;
+      open_.insert(EntryType(nodes_[node].value, nodes_[node].depth, node));
+   }
+
+   template<class GM, class ACC>
+   inline void AStar<GM, ACC>::closeNode(const size_t node)
+   {
+      if(nodes_[node].open) {
+         open_.erase(EntryType(nodes_[node].value, nodes_[node].depth, node));
+         nodes_[node].open = false;
+      }
+   }
+
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::enterFrontier(const size_t node)
+   {
+      OPENGM_ASSERT(!nodes_[node].frontier && nodes_[node].numberOfChildren > 0);
+      ValueType bound;
+      ACC::neutral(bound);
+      for(size_t c=nodes_[node].firstChild; c!=noNode_; c=nodes_[c].nextSibling)
+         ACC::op(nodes_[c].value, bound);
+      nodes_[node].familyBound = bound;
+      nodes_[node].frontier = true;
+      frontier_.insert(EntryType(bound, nodes_[node].depth, node));
+   }
+
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::leaveFrontier(const size_t node)
+   {
+      if(nodes_[node].frontier) {
+         frontier_.erase(EntryType(nodes_[node].familyBound, nodes_[node].depth, node));
+         nodes_[node].frontier = false;
+      }
+   }
+
+   /// forget the (unexpanded) children of a node and re-open the node with
+   /// the best bound of its children
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::forgetChildren(const size_t node)
+   {
+      OPENGM_ASSERT(nodes_[node].frontier);
+      const ValueType bound = nodes_[node].familyBound;
+      leaveFrontier(node);
+      size_t c = nodes_[node].firstChild;
+      while(c != noNode_) {
+         const size_t next = nodes_[c].nextSibling;
+         closeNode(c);
+         freeNodes_.push_back(c);
+         c = next;
+      }
+      nodes_[node].firstChild = noNode_;
+      nodes_[node].numberOfChildren = 0;
+      nodes_[node].value = wrose(nodes_[node].value, bound);
+      openNode(node);
+      const size_t parent = nodes_[node].parent;
+      if(parent != noNode_) {
+         --nodes_[parent].numberOfInnerChildren;
+         if(nodes_[parent].numberOfInnerChildren == 0)
+            enterFrontier(parent);
+      }
+   }
+
+   /// remove a node without children, parents whose subtree has been
+   /// searched completely are removed as well
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::removeNode(size_t node)
+   {
+      while(node != noNode_) {
+         OPENGM_ASSERT(nodes_[node].numberOfChildren == 0 && !nodes_[node].open);
+         const size_t parent = nodes_[node].parent;
+         const bool   inner  = nodes_[node].depth < numNodes_;
+         leaveFrontier(node);
+         freeNodes_.push_back(node);
+         if(parent == noNode_)
+            return;
+         //UNLINK
+         if(nodes_[parent].firstChild == node) {
+            nodes_[parent].firstChild = nodes_[node].nextSibling;
          }
-         std::vector<LabelType> shape(numberOfVariables,0);
-         for(IndexType var=0; var<gm_.numberOfVariables();++var){
-            if(fixVariable[var]==false){
-               shape[varMap[var]] = gm_.numberOfLabels(var);
-            }
+         else{
+            size_t c = nodes_[parent].firstChild;
+            while(nodes_[c].nextSibling != node)
+               c = nodes_[c].nextSibling;
+            nodes_[c].nextSibling = nodes_[node].nextSibling;
          }
-         MSpaceType space(shape.begin(),shape.end());
-         MGM mgm(space);
- 
-         std::vector<PositionAndLabel<IndexType,LabelType> > fixedVars;
-         std::vector<IndexType> MVars;
-         ValueType constant;
-         GM::OperatorType::neutral(constant);
-
-         for(IndexType f=0; f<gm_.numberOfFactors();++f){
-            fixedVars.resize(0); 
-            MVars.resize(0);
-            for(IndexType i=0; i<gm_[f].numberOfVariables(); ++i){
-               const IndexType var = gm_[f].variableIndex(i);
-               if(fixVariable[var]){
-                  fixedVars.push_back(PositionAndLabel<IndexType,LabelType>(i,fixVariableLabel[var]));
-               }else{
-                  MVars.push_back(varMap[var]);
-               }
-            }
-            if(fixedVars.size()==gm_[f].numberOfVariables()){//all fixed
-               std::vector<LabelType> fixedStates(gm_[f].numberOfVariables(),0);
-               for(IndexType i=0; i<gm_[f].numberOfVariables(); ++i){
-                  fixedStates[i]=fixVariableLabel[ gm_[f].variableIndex(i)];
-               }     
-               GM::OperatorType::op(gm_[f](fixedStates.begin()),constant);       
-            }else{
-               if(MVars.size()<2 || isTreeFactor_[f]){
-                  const ViewFixVariablesFunction<GM> func(gm_[f], fixedVars);
-                  mgm.addFactor(mgm.addFunction(func),MVars.begin(), MVars.end());
-               }else{
-                  std::vector<IndexType> variablesIndices(optimizedFactor_[f].numberOfVariables());
-                  for(size_t i=0; i<variablesIndices.size(); ++i)
-                     variablesIndices[i] = varMap[optimizedFactor_[f].variableIndex(i)];
-                  LabelType numberOfLabels = optimizedFactor_[f].numberOfLabels(0);
-                  opengm::ExplicitFunction<ValueType,IndexType,LabelType> func(&numberOfLabels,&numberOfLabels+1,0);
-                  for(LabelType i=0; i<numberOfLabels; ++i)
-                     func(i) = optimizedFactor_[f](i);
-                  mgm.addFactor(mgm.addFunction(func),variablesIndices.begin(),variablesIndices.end() );
-                  OPENGM_ASSERT(mgm[mgm.numberOfFactors()-1].numberOfVariables()==1);
-               }
+         --nodes_[parent].numberOfChildren;
+         if(inner)
+            --nodes_[parent].numberOfInnerChildren;
+         if(nodes_[parent].numberOfChildren == 0) {
+            node = parent;
+         }
+         else{
+            if(nodes_[parent].numberOfInnerChildren == 0) {
+               leaveFrontier(parent);
+               enterFrontier(parent);
             }
+            node = noNode_;
          }
-         {
-            LabelType temp;
-            ConstantFunction<ValueType, IndexType, LabelType> func(&temp, &temp, constant);
-            mgm.addFactor(mgm.addFunction(func),MVars.begin(), MVars.begin());
-         } 
-         typedef typename opengm::BeliefPropagationUpdateRules<MGM,ACC> UpdateRules;
-         typename MessagePassing<MGM, ACC, UpdateRules, opengm::MaxDistance>::Parameter bpPara;
-         bpPara.isAcyclic_ = opengm::Tribool::False;
-         bpPara.maximumNumberOfSteps_ = mgm.numberOfVariables();
-         OPENGM_ASSERT(mgm.isAcyclic());
-         MessagePassing<MGM, ACC, UpdateRules, opengm::MaxDistance> bp(mgm,bpPara);  
-         try{
-            bp.infer();//Asynchronous();
+      }
+   }
+
+   /// make room for n additional nodes in the arena
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::makeRoom(const size_t n)
+   {
+      while(numberOfNodes()+n > parameter_.maxHeapSize_ && !frontier_.empty()) {
+         typename EntrySet::iterator worst = frontier_.end();
+         --worst;
+         forgetChildren(worst->node);
+      }
+      if(numberOfNodes()+n > parameter_.maxHeapSize_) {
+         throw RuntimeError("The maximal number of search nodes of AStar is too small for the search depth.");
+      }
+   }
+
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::expand(const size_t node)
+   {
+      const size_t depth = nodes_[node].depth;
+      ConfVec conf;
+      labeling(node, conf);
+      std::vector<ValueType> bound;
+      if( parameter_.heuristic_ == parameter_.STANDARDHEURISTIC) { 
+         standardHeuristic(conf, bound);
+      }
+      if( parameter_.heuristic_ == parameter_.FASTHEURISTIC) {
+         fastHeuristic(conf, bound);
+      }
+      //REMOVE NODE FROM OPEN LIST
+      closeNode(node);
+      const size_t parent = nodes_[node].parent;
+      if(parent != noNode_) {
+         leaveFrontier(parent);
+         ++nodes_[parent].numberOfInnerChildren;
+      }
+      //GENERATE CHILDREN
+      makeRoom(bound.size());
+      for(size_t i=0; i<bound.size(); ++i) {
+         const size_t child = allocateNode();
+         std::copy(labelWords_.begin()+node*wordsPerNode_, labelWords_.begin()+(node+1)*wordsPerNode_, labelWords_.begin()+child*wordsPerNode_);
+         setLabel(child, depth, static_cast<LabelType>(i));
+         nodes_[child].depth       = depth+1;
+         nodes_[child].parent      = node;
+         nodes_[child].nextSibling = nodes_[node].firstChild;
+         // the bound of a node is also a bound for its children
+         nodes_[child].value       = wrose(bound[i], nodes_[node].value);
+         nodes_[node].firstChild   = child;
+         ++nodes_[node].numberOfChildren;
+         openNode(child);
+      }
+      enterFrontier(node);
+   }
+
+   template<class GM, class ACC>
+   void AStar<GM, ACC>::standardHeuristic(const ConfVec& conf, std::vector<ValueType>& bound)
+   {
+      //BUILD GRAPHICAL MODEL FOR HEURISTC CALCULATION
+      typedef typename opengm::DiscreteSpace<IndexType, LabelType> MSpaceType;
+      typedef typename meta::TypeListGenerator< ExplicitFunction<ValueType,IndexType,LabelType>, ViewFixVariablesFunction<GM>, ViewFunction<GM>, ConstantFunction<ValueType, IndexType, LabelType> >::type MFunctionTypeList;
+      typedef GraphicalModel<ValueType, typename GM::OperatorType, MFunctionTypeList, MSpaceType> MGM;
+
+      IndexType numberOfVariables = 0;
+      std::vector<IndexType> varMap(gm_.numberOfVariables(),0);
+      std::vector<LabelType> fixVariableLabel(gm_.numberOfVariables(),0);
+      std::vector<bool> fixVariable(gm_.numberOfVariables(),false);
+      for(size_t i =0; i<conf.size() ; ++i) {
+         fixVariableLabel[parameter_.nodeOrder_[i]] = conf[i];
+         fixVariable[parameter_.nodeOrder_[i]] = true;
+      }
+
+      for(IndexType var=0; var<gm_.numberOfVariables();++var){
+         if(fixVariable[var]==false){
+            varMap[var] = numberOfVariables++;
          }
-         catch(...) {
-            throw RuntimeError("bp failed in astar");
+      }
+      std::vector<LabelType> shape(numberOfVariables,0);
+      for(IndexType var=0; var<gm_.numberOfVariables();++var){
+         if(fixVariable[var]==false){
+            shape[varMap[var]] = gm_.numberOfLabels(var);
          }
-         ACC::op(bp.value(),aboveBound_,aboveBound_);
-         std::vector<LabelType> conf(mgm.numberOfVariables()); 
- 
-         std::vector<IndexType> theVar(1, varMap[parameter_.nodeOrder_[subconfsize]]); 
+      }
+      MSpaceType space(shape.begin(),shape.end());
+      MGM mgm(space);
  
-         std::vector<LabelType> theLabel(1,0);
-         a.conf.resize(subconfsize+1);
-         for(size_t i=0; i<numStates_[parameter_.nodeOrder_[subconfsize]]; ++i) {
-            a.conf[subconfsize] = i;
-            theLabel[0] =i;
-            bp.constrainedOptimum(theVar,theLabel,conf);
-            a.value   = mgm.evaluate(conf);
-            array_.push_back(a);
-            push_heap(array_.begin(), array_.end(),  comp1); //greater<FactorType,Accumulation>) ;
+      std::vector<PositionAndLabel<IndexType,LabelType> > fixedVars;
+      std::vector<IndexType> MVars;
+      ValueType constant;
+      GM::OperatorType::neutral(constant);
+
+      for(IndexType f=0; f<gm_.numberOfFactors();++f){
+         fixedVars.resize(0); 
+         MVars.resize(0);
+         for(IndexType i=0; i<gm_[f].numberOfVariables(); ++i){
+            const IndexType var = gm_[f].variableIndex(i);
+            if(fixVariable[var]){
+               fixedVars.push_back(PositionAndLabel<IndexType,LabelType>(i,fixVariableLabel[var]));
+            }else{
+               MVars.push_back(varMap[var]);
+            }
          }
-      }
-      if( parameter_.heuristic_ == parameter_.FASTHEURISTIC) {
-         std::vector<LabelType> conf(subconfsize);
-         for(size_t i=0;i<subconfsize;++i)
-            conf[i] = a.conf[i];
-         std::vector<ValueType> bound = fastHeuristic(conf);
-         a.conf.resize(subconfsize+1);
-         for(size_t i=0; i<numStates_[parameter_.nodeOrder_[subconfsize]]; ++i) {
-            a.conf[subconfsize] = i;
-            a.value             = bound[i];
-            //if(bound[i]<10) {
-            array_.push_back(a);
-            push_heap(array_.begin(), array_.end(),  comp1); //greater<FactorType,Accumulation>) ;
-            //}
+         if(fixedVars.size()==gm_[f].numberOfVariables()){//all fixed
+            std::vector<LabelType> fixedStates(gm_[f].numberOfVariables(),0);
+            for(IndexType i=0; i<gm_[f].numberOfVariables(); ++i){
+               fixedStates[i]=fixVariableLabel[ gm_[f].variableIndex(i)];
+            }     
+            GM::OperatorType::op(gm_[f](fixedStates.begin()),constant);       
+         }else{
+            if(MVars.size()<2 || isTreeFactor_[f]){
+               const ViewFixVariablesFunction<GM> func(gm_[f], fixedVars);
+               mgm.addFactor(mgm.addFunction(func),MVars.begin(), MVars.end());
+            }else{
+               std::vector<IndexType> variablesIndices(optimizedFactor_[f].numberOfVariables());
+               for(size_t i=0; i<variablesIndices.size(); ++i)
+                  variablesIndices[i] = varMap[optimizedFactor_[f].variableIndex(i)];
+               LabelType numberOfLabels = optimizedFactor_[f].numberOfLabels(0);
+               opengm::ExplicitFunction<ValueType,IndexType,LabelType> func(&numberOfLabels,&numberOfLabels+1,0);
+               for(LabelType i=0; i<numberOfLabels; ++i)
+                  func(i) = optimizedFactor_[f](i);
+               mgm.addFactor(mgm.addFunction(func),variablesIndices.begin(),variablesIndices.end() );
+               OPENGM_ASSERT(mgm[mgm.numberOfFactors()-1].numberOfVariables()==1);
+            }
          }
       }
+      {
+         LabelType temp;
+         ConstantFunction<ValueType, IndexType, LabelType> func(&temp, &temp, constant);
+         mgm.addFactor(mgm.addFunction(func),MVars.begin(), MVars.begin());
+      } 
+      typedef typename opengm::BeliefPropagationUpdateRules<MGM,ACC> UpdateRules;
+      typename MessagePassing<MGM, ACC, UpdateRules, opengm::MaxDistance>::Parameter bpPara;
+      bpPara.isAcyclic_ = opengm::Tribool::False;
+      bpPara.maximumNumberOfSteps_ = mgm.numberOfVariables();
+      OPENGM_ASSERT(mgm.isAcyclic());
+      MessagePassing<MGM, ACC, UpdateRules, opengm::MaxDistance> bp(mgm,bpPara);  
+      try{
+         bp.infer();//Asynchronous();
+      }
+      catch(...) {
+         throw RuntimeError("bp failed in astar");
+      }
+      ACC::op(bp.value(),aboveBound_,aboveBound_);
+      std::vector<LabelType> mconf(mgm.numberOfVariables());
+      std::vector<IndexType> theVar(1, varMap[parameter_.nodeOrder_[conf.size()]]);
+      std::vector<LabelType> theLabel(1,0);
+      bound.resize(numStates_[parameter_.nodeOrder_[conf.size()]]);
+      for(size_t i=0; i<bound.size(); ++i) {
+         theLabel[0] =i;
+         bp.constrainedOptimum(theVar,theLabel,mconf);
+         bound[i] = mgm.evaluate(mconf);
+      }
    }
 
+   /// labeling independent part of the fast heuristic: energies from the
+   /// factors of unlabeled variables and the elimination order of the tree
    template<class GM, class ACC>
-   std::vector<typename AStar<GM, ACC>::ValueType>
-   AStar<GM, ACC>::fastHeuristic(typename AStar<GM, ACC>::ConfVec conf)
+   void AStar<GM, ACC>::buildHeuristicCache(const size_t depth)
    {
+      HeuristicCache& cache = heuristicCache_[depth];
       std::list<size_t>                 factorList;
       std::vector<size_t>               nodeDegree(numNodes_,0);
-      std::vector<int>                  nodeLabel(numNodes_,-1);
-      std::vector<std::vector<ValueType > > nodeEnergy(numNodes_);
-      size_t                            nextNode = parameter_.nodeOrder_[conf.size()];
+      std::vector<bool>                 labeled(numNodes_,false);
+      std::vector<bool>                 eliminated(numNodes_,false);
+      const size_t                      nextNode = parameter_.nodeOrder_[depth];
+      for(size_t i=0; i<depth; ++i)
+         labeled[parameter_.nodeOrder_[i]] = true;
+      cache.nodeEnergy_.resize(numNodes_);
       for(size_t i=0; i<numNodes_; ++i) {
-         nodeEnergy[i].resize(numStates_[i]); //the energy passed to node i
-         for(size_t j=0;j<numStates_[i];++j)
-            OperatorType::neutral(nodeEnergy[i][j]);
+         cache.nodeEnergy_[i].resize(labeled[i] ? 0 : numStates_[i]); //the energy passed to node i
+         for(size_t j=0;j<cache.nodeEnergy_[i].size();++j)
+            OperatorType::neutral(cache.nodeEnergy_[i][j]);
       }
-      for(size_t i=0;i<conf.size();++i) {
-         nodeLabel[parameter_.nodeOrder_[i]] = conf[i];
-      }
-      //First run:
-      // * add unarry function
-      // * add pairwise functions with at least one observed node
-      // * add the approximation for pairwise none-tree edges
+      cache.labeledFactors_.clear();
+      cache.schedule_.clear();
+      cache.roots_.clear();
       for(size_t i=0; i<gm_.numberOfFactors(); ++i) {
          const FactorType & f    = gm_[i];
-         size_t nvar = f.numberOfVariables();
-         //factors depending from 1 variable can be include
+         const size_t nvar = f.numberOfVariables();
+         if(nvar==0) continue;
+         bool isLabeled = false;
+         for(size_t j=0; j<nvar; ++j)
+            isLabeled = isLabeled || labeled[f.variableIndex(j)];
+         if(isLabeled) {
+            cache.labeledFactors_.push_back(i);
+            continue;
+         }
+         const size_t index = f.variableIndex(0);
          if(nvar==1) {
-            int index = f.variableIndex(0);
-            if(nodeLabel[index]>=0) {
-               nodeEnergy[index].resize(1);
-               //nodeEnergy[index][0] = operatipon(f(nodeLabel[index]), nodeEnergy[index][0]);
-               LabelType coordinates[]={static_cast<LabelType>(nodeLabel[index])};
-               OperatorType::op(f(coordinates), nodeEnergy[index][0]);
-            }
-            else{
-               OPENGM_ASSERT(numStates_[index] == nodeEnergy[index].size());
-               for(size_t j=0;j<numStates_[index];++j) {
-                  //nodeEnergy[index][j] = operation(f(j),nodeEnergy[index][j]);
-                  LabelType coordinates[]={static_cast<LabelType>(j)};
-                  OperatorType::op(f(coordinates),nodeEnergy[index][j]);
-               }
+            for(size_t j=0;j<numStates_[index];++j) {
+               LabelType coordinates[]={static_cast<LabelType>(j)};
+               OperatorType::op(f(coordinates),cache.nodeEnergy_[index][j]);
             }
          }
-         if(nvar==2) {
-            size_t index1 = f.variableIndex(0);
-            size_t index2 = f.variableIndex(1);
-            if(nodeLabel[index1]>=0) {
-               if(nodeLabel[index2]>=0) {
-                  nodeEnergy[index1].resize(1);
-                  //nodeEnergy[index1][0] = operation(f(nodeLabel[index1],nodeLabel[index2]),nodeEnergy[index1][0]);
-                  LabelType coordinates[]={
-                     static_cast<LabelType>(nodeLabel[index1]),
-                     static_cast<LabelType>(nodeLabel[index2])
-                  };
-                  OperatorType::op(f(coordinates),nodeEnergy[index1][0]);
-               }
-               else{
-                  OPENGM_ASSERT(numStates_[index2] == nodeEnergy[index2].size());
-                  for(size_t j=0;j<numStates_[index2];++j) {
-                     //nodeEnergy[index2][j] = operation(f(nodeLabel[index1],j), nodeEnergy[index2][j]);
-                     LabelType coordinates[]={
-                        static_cast<LabelType>(nodeLabel[index1]),
-                        static_cast<LabelType>(j)
-                     };
-                     OperatorType::op(f(coordinates), nodeEnergy[index2][j]);
-                  }
-               }
-            }
-            else if(nodeLabel[index2]>=0) {
-               OPENGM_ASSERT(numStates_[index1] == nodeEnergy[index1].size());
-               for(size_t j=0;j<numStates_[index1];++j) {
-                  //nodeEnergy[index1][j] = operation(f(j,nodeLabel[index2]),nodeEnergy[index1][j]);
-                  LabelType coordinates[]={
-                     static_cast<LabelType>(j),
-                     static_cast<LabelType>(nodeLabel[index2])
-                  };
-                  OperatorType::op(f(coordinates),nodeEnergy[index1][j]);
-               }
+         else if(nvar==2 && isTreeFactor_[i]) {
+            factorList.push_front(i);
+            ++nodeDegree[f.variableIndex(0)];
+            ++nodeDegree[f.variableIndex(1)];
+         }
+         else{
+            //approximation for none-tree factors
+            for(size_t j=0;j<numStates_[index];++j) {
+               LabelType coordinates[]={static_cast<LabelType>(j)};
+               OperatorType::op(optimizedFactor_[i](coordinates), cache.nodeEnergy_[index][j]);
             }
-            else if(isTreeFactor_[i]) {
-               factorList.push_front(i);
-               ++nodeDegree[index1];
-               ++nodeDegree[index2];
-               continue;
+         }
+      }
+      nodeDegree[nextNode] += numNodes_;
+      // Order of the dynamic programming over the tree-structured problem.
+      size_t postponed = 0;
+      while(factorList.size()>0) {
+         size_t    id  = factorList.front();
+         factorList.pop_front();
+         size_t    index1 = gm_[id].variableIndex(0);
+         size_t    index2 = gm_[id].variableIndex(1);
+         if(nodeDegree[index1]==1) {
+            cache.schedule_.push_back(std::pair<size_t, bool>(id, true));
+            eliminated[index1] = true;
+         }
+         else if(nodeDegree[index2]==1) {
+            cache.schedule_.push_back(std::pair<size_t, bool>(id, false));
+            eliminated[index2] = true;
+         }
+         else{
+            factorList.push_back(id);
+            if(++postponed > factorList.size())
+               throw RuntimeError("The tree factors of the AStar heuristic contain a cycle.");
+            continue;
+         }
+         postponed = 0;
+         --nodeDegree[index1];
+         --nodeDegree[index2];
+      }
+      for(size_t i=0; i<numNodes_; ++i) {
+         if(!labeled[i] && !eliminated[i] && i!=nextNode)
+            cache.roots_.push_back(i);
+      }
+      cache.valid_ = true;
+   }
+
+   template<class GM, class ACC>
+   void
+   AStar<GM, ACC>::fastHeuristic(const ConfVec& conf, std::vector<ValueType>& bound)
+   {
+      const size_t depth = conf.size();
+      if(!heuristicCache_[depth].valid_)
+         buildHeuristicCache(depth);
+      const HeuristicCache& cache = heuristicCache_[depth];
+      const size_t nextNode = parameter_.nodeOrder_[depth];
+      std::vector<int> nodeLabel(numNodes_,-1);
+      for(size_t i=0;i<depth;++i) {
+         nodeLabel[parameter_.nodeOrder_[i]] = conf[i];
+      }
+      nodeEnergy_ = cache.nodeEnergy_;
+      ValueType constant;
+      OperatorType::neutral(constant);
+      //Factors with at least one labeled variable
+      // * include them if all variables are labeled or only one is unlabeled
+      // * add the approximation for higher order factors
+      std::vector<LabelType> state;
+      for(size_t n=0; n<cache.labeledFactors_.size(); ++n) {
+         const size_t        i    = cache.labeledFactors_[n];
+         const FactorType &  f    = gm_[i];
+         const size_t        nvar = f.numberOfVariables();
+         size_t free  = 0;
+         size_t index = 0;
+         state.resize(nvar);
+         for(size_t j=0; j<nvar; ++j) {
+            if(nodeLabel[f.variableIndex(j)]<0) {
+               ++free;
+               index = j;
             }
             else{
-               for(size_t j=0;j<numStates_[index1];++j) {
-                  //nodeEnergy[index1][j] = operation(optimizedFactor_[i](j), nodeEnergy[index1][j]);
-                  LabelType coordinates[]={static_cast<LabelType>(j)};
-                  OperatorType::op(optimizedFactor_[i](coordinates), nodeEnergy[index1][j]);
-               }
+               state[j] = static_cast<LabelType>(nodeLabel[f.variableIndex(j)]);
             }
          }
-         if(nvar>2) {
-            bool covered = true;
-            std::vector<size_t> state(nvar);
-            for(size_t j=0; j<nvar; ++j) {
-               if(nodeLabel[f.variableIndex(j)]<0) {
-                  state[j] = nodeLabel[f.variableIndex(j)];
-                  covered = false;
-               }
+         if(free==0) {
+            OperatorType::op(f(state.begin()),constant);
+         }
+         else if(free==1) {
+            const size_t var = f.variableIndex(index);
+            for(size_t j=0;j<numStates_[var];++j) {
+               state[index] = static_cast<LabelType>(j);
+               OperatorType::op(f(state.begin()), nodeEnergy_[var][j]);
+            }
+         }
+         else{
+            const size_t var = f.variableIndex(0);
+            if(nodeLabel[var]>=0) {
+               LabelType coordinates[]={static_cast<LabelType>(nodeLabel[var])};
+               OperatorType::op(optimizedFactor_[i](coordinates), constant);
             }
-            if(covered)
-               nodeEnergy[f.variableIndex(0)][0] = f(state.begin());
             else{
-               for(size_t j=0;j<numStates_[f.variableIndex(0)];++j) {
-                  //nodeEnergy[f.variableIndex(0)][j] = operation(optimizedFactor_[i](j), nodeEnergy[f.variableIndex(0)][j]);
+               for(size_t j=0;j<numStates_[var];++j) {
                   LabelType coordinates[]={static_cast<LabelType>(j)};
-                  OperatorType::op(optimizedFactor_[i](coordinates), nodeEnergy[f.variableIndex(0)][j]);
+                  OperatorType::op(optimizedFactor_[i](coordinates), nodeEnergy_[var][j]);
                }
             }
          }
       }
-      nodeDegree[nextNode] += numNodes_;
       // Start dynamic programming to solve the treestructured problem.
-      while(factorList.size()>0) {
-         size_t    id  = factorList.front();
-         factorList.pop_front();
-         const FactorType &  f      = gm_[id];
-         size_t    index1 = f.variableIndex(0);
-         size_t    index2 = f.variableIndex(1);
+      for(size_t n=0; n<cache.schedule_.size(); ++n) {
+         const FactorType &  f      = gm_[cache.schedule_[n].first];
+         const bool          first  = cache.schedule_[n].second;
+         const size_t        leaf   = f.variableIndex(first ? 0 : 1);
+         const size_t        other  = f.variableIndex(first ? 1 : 0);
          typename FactorType::ValueType temp;
-         OPENGM_ASSERT(index1 < numNodes_);
-         OPENGM_ASSERT(index2 < numNodes_);
-         OPENGM_ASSERT(gm_.numberOfLabels(index1) == numStates_[index1]);
-         OPENGM_ASSERT(gm_.numberOfLabels(index2) == numStates_[index2]);
-         if(nodeDegree[index1]==1) {
-            typename FactorType::ValueType min;
-            OPENGM_ASSERT(numStates_[index2] == nodeEnergy[index2].size());
-            for(size_t j2=0;j2<numStates_[index2];++j2) {
-               ACC::neutral(min);
-               OPENGM_ASSERT(numStates_[index1] == nodeEnergy[index1].size());
-               for(size_t j1=0;j1<numStates_[index1];++j1) {
-                  LabelType coordinates[]={static_cast<LabelType>(j1),static_cast<LabelType>(j2)};
-                  OperatorType::op(f(coordinates),nodeEnergy[index1][j1],temp);
-                  ACC::op(min,temp,min);
-               }
-               //nodeEnergy[index2][j2] = operation(min,nodeEnergy[index2][j2]);
-               OperatorType::op(min,nodeEnergy[index2][j2]);
-            }
-            --nodeDegree[index1];
-            --nodeDegree[index2];
-            nodeEnergy[index1].resize(1);
-            OperatorType::neutral(nodeEnergy[index1][0]);
-         }
-         else if(nodeDegree[index2]==1) {
-            typename FactorType::ValueType min;
-            OPENGM_ASSERT(numStates_[index1] == nodeEnergy[index1].size());
-            for(size_t j1=0;j1<numStates_[index1];++j1) {
-               ACC::neutral(min);
-               OPENGM_ASSERT(numStates_[index2] == nodeEnergy[index2].size());
-               for(size_t j2=0;j2<numStates_[index2];++j2) {
-                  LabelType coordinates[]={static_cast<LabelType>(j1),static_cast<LabelType>(j2)};
-                  OperatorType::op(f(coordinates),nodeEnergy[index2][j2],temp);
-                  ACC::op(min,temp,min);
-                  //if(min>f(j1,j2)*node_energy[index2][j2]) min=f(j1,j2)*node_energy[index2][j2];
-               }
-               //nodeEnergy[index1][j1] = operation(min,nodeEnergy[index1][j1]);
-               OperatorType::op(min,nodeEnergy[index1][j1]);
+         typename FactorType::ValueType min;
+         OPENGM_ASSERT(numStates_[other] == nodeEnergy_[other].size());
+         OPENGM_ASSERT(numStates_[leaf] == nodeEnergy_[leaf].size());
+         for(size_t jo=0;jo<numStates_[other];++jo) {
+            ACC::neutral(min);
+            for(size_t jl=0;jl<numStates_[leaf];++jl) {
+               LabelType coordinates[2];
+               coordinates[first ? 0 : 1] = static_cast<LabelType>(jl);
+               coordinates[first ? 1 : 0] = static_cast<LabelType>(jo);
+               OperatorType::op(f(coordinates),nodeEnergy_[leaf][jl],temp);
+               ACC::op(min,temp,min);
             }
-            --nodeDegree[index1];
-            --nodeDegree[index2];
-            nodeEnergy[index2].resize(1);
-            OperatorType::neutral(nodeEnergy[index2][0]);
-         }
-         else{
-            factorList.push_back(id);
+            OperatorType::op(min,nodeEnergy_[other][jo]);
          }
       }
       //Evaluate
-      ValueType result;
+      ValueType result = constant;
       ValueType min;
-      OperatorType::neutral(result);
-      std::vector<ValueType > bound;
-      for(size_t i=0;i<numNodes_;++i) {
-         if(i==nextNode) continue;
+      for(size_t n=0;n<cache.roots_.size();++n) {
+         const size_t i = cache.roots_[n];
          ACC::neutral(min);
-         for(size_t j=0; j<nodeEnergy[i].size();++j)
-            ACC::op(min,nodeEnergy[i][j],min);
-         //result = operation(result,min);
+         for(size_t j=0; j<nodeEnergy_[i].size();++j)
+            ACC::op(min,nodeEnergy_[i][j],min);
          OperatorType::op(min,result);
       }
-      bound.resize(nodeEnergy[nextNode].size());
-      for(size_t j=0; j<nodeEnergy[nextNode].size();++j) {
-         //bound[j] = operation(nodeEnergy[nextNode][j],result);
-         OperatorType::op(nodeEnergy[nextNode][j],result,bound[j]);
+      bound.resize(nodeEnergy_[nextNode].size());
+      for(size_t j=0; j<nodeEnergy_[nextNode].size();++j) {
+         OperatorType::op(nodeEnergy_[nextNode][j],result,bound[j]);
       }
-      return bound;
    }
 
    template<class GM, class ACC>
@@ -715,4 +1001,3 @@ namespace opengm {
 } // namespace opengm
 
 #endif // #ifndef OPENGM_ASTAR_HXX
-
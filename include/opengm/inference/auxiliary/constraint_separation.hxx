@@ -0,0 +1,598 @@
+#pragma once
+#ifndef OPENGM_CONSTRAINT_SEPARATION_HXX
+#define OPENGM_CONSTRAINT_SEPARATION_HXX
+
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <limits>
+#include <cstddef>
+#ifdef WITH_BOOST
+#include <boost/unordered_map.hpp>
+#else
+#include <ext/hash_map>
+#endif
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include "opengm/opengm.hxx"
+
+namespace opengm {
+
+/// \brief Pool of violated linear constraints found by a separation routine
+///
+/// Separation routines running in parallel add the constraints they find
+/// to their own buffer (one per thread). merge() removes duplicates and
+/// keeps the constraints with the largest violation, at most
+/// maxNumberOfConstraints (all if 0). A constraint is
+///    sum_i coefficient_i * x_{index_i}  (>=, <= or ==)  bound
+/// and two constraints are duplicates if they have the same terms, the
+/// same sense and the same bound. Ties in the violation are broken by the id given by the
+/// separation routine, such that the result does not depend on the number
+/// of buffers.
+///
+/// \ingroup inference
+template<class INDEX = size_t, class VALUE = double>
+class ViolatedConstraintPool {
+public:
+   typedef INDEX IndexType;
+   typedef VALUE ValueType;
+   typedef std::pair<IndexType, ValueType> TermType;
+   typedef typename std::vector<TermType>::const_iterator TermIteratorType;
+   enum Sense {GreaterEqual, LessEqual, Equal};
+
+   ViolatedConstraintPool(const size_t = 0, const size_t = 1);
+   void reset(const size_t, const size_t);
+   size_t numberOfBuffers() const
+      { return buffers_.size(); }
+   size_t maxNumberOfConstraints() const
+      { return maxNumberOfConstraints_; }
+
+   template<class INDEX_ITERATOR, class COEFFICIENT_ITERATOR>
+      void add(const size_t, INDEX_ITERATOR, INDEX_ITERATOR, COEFFICIENT_ITERATOR, const ValueType, const ValueType, const size_t);
+   template<class INDEX_ITERATOR, class COEFFICIENT_ITERATOR>
+      void add(const size_t, INDEX_ITERATOR, INDEX_ITERATOR, COEFFICIENT_ITERATOR, const Sense, const ValueType, const ValueType, const size_t);
+   size_t merge();
+
+   // access to the merged constraints, ordered by decreasing violation
+   size_t size() const
+      { return merged_.size(); }
+   ValueType violation(const size_t i) const
+      { return merged_[i].violation_; }
+   Sense sense(const size_t i) const
+      { return merged_[i].sense_; }
+   ValueType bound(const size_t i) const
+      { return merged_[i].bound_; }
+   size_t id(const size_t i) const
+      { return merged_[i].id_; }
+   TermIteratorType termsBegin(const size_t i) const
+      { return merged_[i].terms_.begin(); }
+   TermIteratorType termsEnd(const size_t i) const
+      { return merged_[i].terms_.end(); }
+
+private:
+   struct Constraint {
+      ValueType violation_;
+      Sense sense_;
+      ValueType bound_;
+      size_t id_;
+      size_t hash_;
+      std::vector<TermType> terms_;
+
+      bool sameAs(const Constraint& other) const
+         { return hash_ == other.hash_ && sense_ == other.sense_ && bound_ == other.bound_ && terms_ == other.terms_; }
+   };
+   struct ConstraintPointerGreater {
+      bool operator()(const Constraint* a, const Constraint* b) const
+         { return a->violation_ > b->violation_ || (a->violation_ == b->violation_ && a->id_ < b->id_); }
+   };
+   #ifdef WITH_BOOST
+   typedef boost::unordered_multimap<size_t, size_t> HashMapType;
+   #else
+   typedef __gnu_cxx::hash_multimap<size_t, size_t> HashMapType;
+   #endif
+
+   void select(std::vector<Constraint>&, std::vector<Constraint>&) const;
+
+   size_t maxNumberOfConstraints_;
+   std::vector<std::vector<Constraint> > buffers_;
+   std::vector<Constraint> merged_;
+};
+
+/// \brief Separation of violated cycle inequalities of the multicut polytope
+///
+/// For an edge e = (u, v) with value x_e > 0, a shortest path from u to v
+/// w.r.t. the (non-negative part of the) edge values is searched by the
+/// Dijkstra algorithm. If its length is smaller than x_e, the cycle
+/// inequality
+///    sum_{f in path} x_f - x_e >= 0
+/// is violated by x_e - length. The searches are independent and run in
+/// parallel (WITH_OPENMP), each thread has its own Dijkstra buffers which
+/// are reset only where they have been touched. The found inequalities are
+/// collected in a ViolatedConstraintPool, where the indices are the edge
+/// indices.
+///
+/// \ingroup inference
+template<class INDEX = size_t>
+class CycleSeparation {
+public:
+   typedef INDEX IndexType;
+
+   struct Parameter {
+      Parameter
+      (
+         const bool chordless = false,
+         const bool chordlessSearch = false,
+         const double tolerance = 1e-8,
+         const size_t numberOfThreads = 0
+      )
+      :  chordless_(chordless),
+         chordlessSearch_(chordlessSearch),
+         tolerance_(tolerance),
+         numberOfThreads_(numberOfThreads)
+      {}
+
+      /// only add chordless cycles (which define facets)
+      bool chordless_;
+      /// avoid chords already during the search (otherwise cycles with
+      /// chords are discarded after the search)
+      bool chordlessSearch_;
+      double tolerance_;
+      /// number of threads (0 = default of OpenMP)
+      size_t numberOfThreads_;
+   };
+
+   CycleSeparation(const size_t = 0);
+   void reset(const size_t);
+   size_t addEdge(const IndexType, const IndexType);
+   void finalize();
+   size_t numberOfNodes() const
+      { return numberOfNodes_; }
+   size_t numberOfEdges() const
+      { return edges_.size(); }
+
+   template<class WEIGHTS, class POOL>
+      size_t separate(const WEIGHTS&, POOL&, const Parameter& = Parameter(), const std::vector<bool>* = NULL);
+
+private:
+   typedef std::pair<double, IndexType> QueueEntry;
+
+   struct Workspace {
+      std::vector<double> distance_;
+      std::vector<size_t> previousEdge_;
+      std::vector<IndexType> touchedNodes_;
+      std::vector<size_t> path_;
+      std::vector<double> coefficients_;
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue_;
+   };
+
+   bool adjacent(const IndexType, const IndexType) const;
+   template<class WEIGHTS>
+      double shortestPath(const WEIGHTS&, const size_t, const Parameter&, Workspace&) const;
+
+   size_t numberOfNodes_;
+   std::vector<std::pair<IndexType, IndexType> > edges_;
+   // adjacency in compressed row storage, sorted by the adjacent node
+   std::vector<size_t> adjacencyBegin_;
+   std::vector<std::pair<IndexType, size_t> > adjacency_;
+   std::vector<Workspace> workspaces_;
+};
+
+template<class INDEX, class VALUE>
+inline
+ViolatedConstraintPool<INDEX, VALUE>::ViolatedConstraintPool
+(
+   const size_t maxNumberOfConstraints,
+   const size_t numberOfBuffers
+)
+:  maxNumberOfConstraints_(maxNumberOfConstraints),
+   buffers_(numberOfBuffers)
+{}
+
+/// remove all constraints
+template<class INDEX, class VALUE>
+inline void
+ViolatedConstraintPool<INDEX, VALUE>::reset
+(
+   const size_t maxNumberOfConstraints,
+   const size_t numberOfBuffers
+) {
+   maxNumberOfConstraints_ = maxNumberOfConstraints;
+   buffers_.clear();
+   buffers_.resize(numberOfBuffers);
+   merged_.clear();
+}
+
+/// add a violated constraint (>= bound) to a buffer
+///
+/// Different buffers can be used by different threads concurrently.
+///
+/// \param buffer index of the buffer, e.g. the thread number
+/// \param bound right hand side of the constraint
+/// \param violation amount by which the constraint is violated
+/// \param id identifier of the constraint used to break ties
+template<class INDEX, class VALUE>
+template<class INDEX_ITERATOR, class COEFFICIENT_ITERATOR>
+inline void
+ViolatedConstraintPool<INDEX, VALUE>::add
+(
+   const size_t buffer,
+   INDEX_ITERATOR indicesBegin,
+   INDEX_ITERATOR indicesEnd,
+   COEFFICIENT_ITERATOR coefficient,
+   const ValueType bound,
+   const ValueType violation,
+   const size_t id
+) {
+   add(buffer, indicesBegin, indicesEnd, coefficient, GreaterEqual, bound, violation, id);
+}
+
+/// add a violated constraint to a buffer
+template<class INDEX, class VALUE>
+template<class INDEX_ITERATOR, class COEFFICIENT_ITERATOR>
+inline void
+ViolatedConstraintPool<INDEX, VALUE>::add
+(
+   const size_t buffer,
+   INDEX_ITERATOR indicesBegin,
+   INDEX_ITERATOR indicesEnd,
+   COEFFICIENT_ITERATOR coefficient,
+   const Sense sense,
+   const ValueType bound,
+   const ValueType violation,
+   const size_t id
+) {
+   OPENGM_ASSERT(buffer < buffers_.size());
+   std::vector<Constraint>& constraints = buffers_[buffer];
+   constraints.push_back(Constraint());
+   Constraint& constraint = constraints.back();
+   constraint.violation_ = violation;
+   constraint.sense_ = sense;
+   constraint.bound_ = bound;
+   constraint.id_ = id;
+   for(; indicesBegin != indicesEnd; ++indicesBegin, ++coefficient) {
+      constraint.terms_.push_back(TermType(static_cast<IndexType>(*indicesBegin), static_cast<ValueType>(*coefficient)));
+   }
+   std::sort(constraint.terms_.begin(), constraint.terms_.end());
+   size_t hash = 0;
+   for(size_t i = 0; i < constraint.terms_.size(); ++i) {
+      hash = hash * 1000003 + static_cast<size_t>(constraint.terms_[i].first);
+      hash = hash * 31 + (constraint.terms_[i].second > 0 ? 1 : 2);
+   }
+   constraint.hash_ = hash;
+   // bound the memory, the best distinct constraints of a buffer are kept
+   if(maxNumberOfConstraints_ != 0 && constraints.size() >= 2 * maxNumberOfConstraints_ + 1024) {
+      std::vector<Constraint> selected;
+      select(constraints, selected);
+      constraints.swap(selected);
+   }
+}
+
+/// merge the buffers
+///
+/// \return number of distinct constraints with the largest violation
+template<class INDEX, class VALUE>
+inline size_t
+ViolatedConstraintPool<INDEX, VALUE>::merge() {
+   std::vector<Constraint> all;
+   size_t size = 0;
+   for(size_t b = 0; b < buffers_.size(); ++b) {
+      size += buffers_[b].size();
+   }
+   all.reserve(size);
+   for(size_t b = 0; b < buffers_.size(); ++b) {
+      for(size_t i = 0; i < buffers_[b].size(); ++i) {
+         all.push_back(Constraint());
+         all.back().violation_ = buffers_[b][i].violation_;
+         all.back().sense_ = buffers_[b][i].sense_;
+         all.back().bound_ = buffers_[b][i].bound_;
+         all.back().id_ = buffers_[b][i].id_;
+         all.back().hash_ = buffers_[b][i].hash_;
+         all.back().terms_.swap(buffers_[b][i].terms_);
+      }
+      buffers_[b].clear();
+   }
+   merged_.clear();
+   select(all, merged_);
+   return merged_.size();
+}
+
+/// \cond HIDDEN_SYMBOLS
+template<class INDEX, class VALUE>
+inline void
+ViolatedConstraintPool<INDEX, VALUE>::select
+(
+   std::vector<Constraint>& constraints,
+   std::vector<Constraint>& selected
+) const {
+   std::vector<Constraint*> order(constraints.size());
+   for(size_t i = 0; i < constraints.size(); ++i) {
+      order[i] = &constraints[i];
+   }
+   std::sort(order.begin(), order.end(), ConstraintPointerGreater());
+   HashMapType hashes;
+   selected.clear();
+   for(size_t i = 0; i < order.size(); ++i) {
+      if(maxNumberOfConstraints_ != 0 && selected.size() == maxNumberOfConstraints_) {
+         break;
+      }
+      bool duplicate = false;
+      std::pair<typename HashMapType::const_iterator, typename HashMapType::const_iterator> range = hashes.equal_range(order[i]->hash_);
+      for(; range.first != range.second; ++range.first) {
+         if(selected[range.first->second].sameAs(*order[i])) {
+            duplicate = true;
+            break;
+         }
+      }
+      if(!duplicate) {
+         hashes.insert(std::make_pair(order[i]->hash_, selected.size()));
+         selected.push_back(Constraint());
+         selected.back().violation_ = order[i]->violation_;
+         selected.back().sense_ = order[i]->sense_;
+         selected.back().bound_ = order[i]->bound_;
+         selected.back().id_ = order[i]->id_;
+         selected.back().hash_ = order[i]->hash_;
+         selected.back().terms_.swap(order[i]->terms_);
+      }
+   }
+}
+/// \endcond
+
+template<class INDEX>
+inline
+CycleSeparation<INDEX>::CycleSeparation
+(
+   const size_t numberOfNodes
+)
+:  numberOfNodes_(numberOfNodes)
+{}
+
+/// remove all edges
+template<class INDEX>
+inline void
+CycleSeparation<INDEX>::reset
+(
+   const size_t numberOfNodes
+) {
+   numberOfNodes_ = numberOfNodes;
+   edges_.clear();
+   adjacencyBegin_.clear();
+   adjacency_.clear();
+   workspaces_.clear();
+}
+
+/// add an edge, finalize() has to be called after the last edge is added
+/// \return index of the edge (the edges are numbered consecutively)
+template<class INDEX>
+inline size_t
+CycleSeparation<INDEX>::addEdge
+(
+   const IndexType u,
+   const IndexType v
+) {
+   OPENGM_ASSERT(u < numberOfNodes_ && v < numberOfNodes_ && u != v);
+   edges_.push_back(std::make_pair(u, v));
+   return edges_.size() - 1;
+}
+
+template<class INDEX>
+inline void
+CycleSeparation<INDEX>::finalize() {
+   adjacencyBegin_.assign(numberOfNodes_ + 1, 0);
+   for(size_t e = 0; e < edges_.size(); ++e) {
+      ++adjacencyBegin_[edges_[e].first + 1];
+      ++adjacencyBegin_[edges_[e].second + 1];
+   }
+   for(size_t n = 0; n < numberOfNodes_; ++n) {
+      adjacencyBegin_[n + 1] += adjacencyBegin_[n];
+   }
+   adjacency_.resize(2 * edges_.size());
+   std::vector<size_t> position(adjacencyBegin_.begin(), adjacencyBegin_.end() - 1);
+   for(size_t e = 0; e < edges_.size(); ++e) {
+      adjacency_[position[edges_[e].first]++] = std::make_pair(edges_[e].second, e);
+      adjacency_[position[edges_[e].second]++] = std::make_pair(edges_[e].first, e);
+   }
+   for(size_t n = 0; n < numberOfNodes_; ++n) {
+      std::sort(adjacency_.begin() + adjacencyBegin_[n], adjacency_.begin() + adjacencyBegin_[n + 1]);
+   }
+}
+
+/// find violated cycle inequalities
+///
+/// \param weights edge values, weights[e] for the e-th edge
+/// \param pool violated inequalities are added to this pool; it is reset
+///        with one buffer per thread and merged, its maximal number of
+///        constraints is kept
+/// \param candidates if given, only edges e with (*candidates)[e] are tested
+/// \return number of violated inequalities in the pool
+template<class INDEX>
+template<class WEIGHTS, class POOL>
+size_t
+CycleSeparation<INDEX>::separate
+(
+   const WEIGHTS& weights,
+   POOL& pool,
+   const Parameter& parameter,
+   const std::vector<bool>* candidates
+) {
+   OPENGM_ASSERT(adjacencyBegin_.size() == numberOfNodes_ + 1);
+   #ifdef WITH_OPENMP
+   const size_t numberOfThreads = parameter.numberOfThreads_ != 0 ? parameter.numberOfThreads_ : static_cast<size_t>(omp_get_max_threads());
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+   pool.reset(pool.maxNumberOfConstraints(), numberOfThreads);
+   if(workspaces_.size() != numberOfThreads) {
+      workspaces_.resize(numberOfThreads);
+   }
+   for(size_t t = 0; t < numberOfThreads; ++t) {
+      workspaces_[t].distance_.resize(numberOfNodes_, std::numeric_limits<double>::infinity());
+      workspaces_[t].previousEdge_.resize(numberOfNodes_);
+   }
+   std::vector<double> values(edges_.size());
+   for(size_t e = 0; e < edges_.size(); ++e) {
+      values[e] = static_cast<double>(weights[e]);
+   }
+
+   #ifdef WITH_OPENMP
+   #pragma omp parallel for schedule(dynamic, 16) num_threads(static_cast<int>(numberOfThreads))
+   #endif
+   for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(edges_.size()); ++i) {
+      const size_t e = static_cast<size_t>(i);
+      if(values[e] <= parameter.tolerance_ || (candidates != NULL && !(*candidates)[e])) {
+         continue;
+      }
+      #ifdef WITH_OPENMP
+      const size_t thread = omp_get_thread_num();
+      #else
+      const size_t thread = 0;
+      #endif
+      Workspace& workspace = workspaces_[thread];
+      const double length = shortestPath(values, e, parameter, workspace);
+      if(length < values[e] - parameter.tolerance_) {
+         std::vector<size_t>& path = workspace.path_;
+         if(parameter.chordless_ && !parameter.chordlessSearch_) {
+            // the path starts at the second node of e and ends at the first
+            bool chordless = true;
+            std::vector<IndexType>& nodes = workspace.touchedNodes_;
+            nodes.clear();
+            IndexType n = edges_[e].second;
+            nodes.push_back(n);
+            for(size_t j = 0; j < path.size(); ++j) {
+               n = edges_[path[j]].first == n ? edges_[path[j]].second : edges_[path[j]].first;
+               nodes.push_back(n);
+            }
+            for(size_t j = 0; j < nodes.size() && chordless; ++j)
+            for(size_t k = j + 2; k < nodes.size(); ++k) {
+               if((j != 0 || k != nodes.size() - 1) && adjacent(nodes[j], nodes[k])) {
+                  chordless = false;
+                  break;
+               }
+            }
+            if(!chordless) {
+               continue;
+            }
+         }
+         std::vector<double>& coefficients = workspace.coefficients_;
+         coefficients.assign(path.size(), 1.0);
+         path.push_back(e);
+         coefficients.push_back(-1.0);
+         pool.add(thread, path.begin(), path.end(), coefficients.begin(), 0.0, values[e] - length, e);
+      }
+   }
+   return pool.merge();
+}
+
+/// \cond HIDDEN_SYMBOLS
+template<class INDEX>
+inline bool
+CycleSeparation<INDEX>::adjacent
+(
+   const IndexType u,
+   const IndexType v
+) const {
+   const std::pair<IndexType, size_t> key(v, 0);
+   typename std::vector<std::pair<IndexType, size_t> >::const_iterator it =
+      std::lower_bound(adjacency_.begin() + adjacencyBegin_[u], adjacency_.begin() + adjacencyBegin_[u + 1], key);
+   return it != adjacency_.begin() + adjacencyBegin_[u + 1] && it->first == v;
+}
+
+/// Dijkstra from the first to the second node of the edge e without using
+/// e and without paths longer than weights[e]. The edges of the path are
+/// stored in workspace.path_.
+template<class INDEX>
+template<class WEIGHTS>
+double
+CycleSeparation<INDEX>::shortestPath
+(
+   const WEIGHTS& weights,
+   const size_t e,
+   const Parameter& parameter,
+   Workspace& workspace
+) const {
+   const double infinity = std::numeric_limits<double>::infinity();
+   const IndexType source = edges_[e].first;
+   const IndexType target = edges_[e].second;
+   const double maxLength = weights[e];
+   const size_t noEdge = edges_.size();
+   std::vector<double>& distance = workspace.distance_;
+   std::vector<size_t>& previousEdge = workspace.previousEdge_;
+   std::vector<IndexType>& touchedNodes = workspace.touchedNodes_;
+   touchedNodes.clear();
+   workspace.path_.clear();
+   OPENGM_ASSERT(workspace.queue_.empty());
+
+   distance[source] = 0.0;
+   previousEdge[source] = noEdge;
+   touchedNodes.push_back(source);
+   workspace.queue_.push(QueueEntry(0.0, source));
+   while(!workspace.queue_.empty()) {
+      const QueueEntry entry = workspace.queue_.top();
+      workspace.queue_.pop();
+      const IndexType node = entry.second;
+      if(entry.first > distance[node]) {
+         continue;
+      }
+      if(node == target) {
+         break;
+      }
+      for(size_t j = adjacencyBegin_[node]; j < adjacencyBegin_[node + 1]; ++j) {
+         const IndexType node2 = adjacency_[j].first;
+         const size_t edge = adjacency_[j].second;
+         if(edge == e) {
+            continue;
+         }
+         const double length = entry.first + std::max(0.0, weights[edge]);
+         if(length < distance[node2] && length < maxLength) {
+            if(parameter.chordless_ && parameter.chordlessSearch_) {
+               // do not extend the path if node2 is adjacent to a node on it
+               bool chordal = false;
+               IndexType s = node;
+               while(s != source) {
+                  s = edges_[previousEdge[s]].first == s ? edges_[previousEdge[s]].second : edges_[previousEdge[s]].first;
+                  if(s == source && node2 == target) {
+                     continue;
+                  }
+                  if(adjacent(node2, s)) {
+                     chordal = true;
+                     break;
+                  }
+               }
+               if(chordal) {
+                  continue;
+               }
+            }
+            if(distance[node2] == infinity) {
+               touchedNodes.push_back(node2);
+            }
+            distance[node2] = length;
+            previousEdge[node2] = edge;
+            workspace.queue_.push(QueueEntry(length, node2));
+         }
+      }
+   }
+   const double length = distance[target];
+   if(length != infinity) {
+      IndexType n = target;
+      while(n != source) {
+         const size_t edge = previousEdge[n];
+         workspace.path_.push_back(edge);
+         n = edges_[edge].first == n ? edges_[edge].second : edges_[edge].first;
+      }
+   }
+   // reset the buffers
+   while(!workspace.queue_.empty()) {
+      workspace.queue_.pop();
+   }
+   for(size_t j = 0; j < touchedNodes.size(); ++j) {
+      distance[touchedNodes[j]] = infinity;
+   }
+   return length;
+}
+/// \endcond
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_CONSTRAINT_SEPARATION_HXX
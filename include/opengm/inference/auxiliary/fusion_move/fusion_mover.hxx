@@ -4,6 +4,10 @@
 
 
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
 #include "opengm/opengm.hxx"
 #include "opengm/graphicalmodel/graphicalmodel.hxx"
 #include "opengm/graphicalmodel/space/discretespace.hxx"
@@ -11,20 +15,19 @@
 #include "opengm/functions/view.hxx"
 #include "opengm/functions/view_fix_variables_function.hxx"
 #include <opengm/utilities/metaprogramming.hxx>
+#include "opengm/operations/adder.hxx"
 
 #include "opengm/functions/function_properties_base.hxx"
-#include "opengm/inference/fix-fusion/fusion-move.hpp"
+#include "opengm/inference/auxiliary/higher_order_reduction.hxx"
 
 #include "opengm/inference/lazyflipper.hxx"
 
 #ifdef WITH_CPLEX
 #include "opengm/inference/lpcplex.hxx"
 #endif
-#ifdef WITH_QPBO
-#include "QPBO.h"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
 #include "opengm/inference/reducedinference.hxx"
 #include "opengm/inference/hqpbo.hxx"
-#endif
 
 
 
@@ -201,6 +204,17 @@ struct NativeModelProxy
         delete model_;
     }
 
+    void reserveFactors(const size_t nFactors, const size_t nVis)
+    {
+        model_->reserveFactors(nFactors);
+        model_->reserveFactorsVarialbeIndices(nVis);
+    }
+    template<class F>
+    void reserveFunctions(const size_t nFunctions)
+    {
+        model_->template reserveFunctions<F>(nFunctions);
+    }
+
     template<class F, class ITER>
     void addFactor(const F &f, ITER viBegin, ITER viEnd)
     {
@@ -240,6 +254,14 @@ struct QpboModelProxy
         delete model_;
     }
 
+    void reserveFactors(const size_t, const size_t)
+    {
+    }
+    template<class F>
+    void reserveFunctions(const size_t)
+    {
+    }
+
     template<class F, class ITER>
     void addFactor(const F &f, ITER viBegin, ITER viEnd)
     {
@@ -286,6 +308,14 @@ struct Ad3ModelProxy
         delete model_;
     }
 
+    void reserveFactors(const size_t, const size_t)
+    {
+    }
+    template<class F>
+    void reserveFunctions(const size_t)
+    {
+    }
+
     template<class F, class ITER>
     void addFactor(const F &f, ITER viBegin, ITER viEnd)
     {
@@ -320,6 +350,7 @@ public:
     typedef typename meta::TypeListGenerator< FuseViewingFunction, FuseViewingFixingFunction, ArrayFunction >::type SubFunctionTypeList;
     typedef GraphicalModel<ValueType, typename GM::OperatorType, SubFunctionTypeList, SubSpaceType> SubGmType;
 public:
+    typedef HigherOrderReduction<ValueType, IndexType> HigherOrderReductionType;
 
     FusionMover(const GM &gm);
 
@@ -358,6 +389,14 @@ public:
     ValueType fuseFixQpbo(
     );
 
+    // fusion with QPBO on the higher order reduction, reduction and
+    // quadratic are buffers which can be reused for all fusion moves
+    template<class SOLVER>
+    ValueType fuseFixQpbo(
+        HigherOrderReductionType & reduction,
+        typename HigherOrderReductionType::QuadraticType & quadratic
+    );
+
     ValueType valueResult()const
     {
         return valueResult_;
@@ -375,8 +414,8 @@ private:
     template<class MODEL_PROXY>
     void fillSubModel(MODEL_PROXY &modelProy);
 
-    // needed for  higher fix order reduction
-    static const size_t maxOrder_ = 9;
+    ValueType evaluateResult();
+
     // graphical model to fuse states from
     const GraphicalModelType &gm_;
 
@@ -398,6 +437,19 @@ private:
     std::vector<IndexType> globalToLocalVi_;
     IndexType nLocalVar_;
 
+    // workspace which is reused for all fusion moves:
+    // - factorStamp_[fi]==stamp_ marks factor fi as already visited
+    //   in the current pass (replaces a per call std::set)
+    // - lvisBuffer_ holds the local variable indices of a single factor
+    // - localArg_ holds the labeling of the fusion move model
+    // - labelBufferA_ / labelBufferResult_ hold the labels of a single
+    //   factor for the incremental evaluation of the fused labeling
+    std::vector<UInt64Type> factorStamp_;
+    UInt64Type stamp_;
+    std::vector<IndexType> lvisBuffer_;
+    std::vector<LabelType> localArg_;
+    std::vector<LabelType> labelBufferA_;
+    std::vector<LabelType> labelBufferResult_;
 
 };
 
@@ -426,12 +478,10 @@ public:
     typedef typename FusionMoverType::SubGmType                 SubGmType;
 
 
-    #ifdef WITH_QPBO
-    typedef kolmogorov::qpbo::QPBO<double>                          QpboSubInf;
+    typedef QPBOGraph<double>                                       QpboSubInf;
     //typedef opengm::external::QPBO<SubGmType>                     QPBOSubInf;
     typedef opengm::HQPBO<SubGmType,AccumulationType>               HQPBOSubInf;
     typedef typename ReducedInferenceHelper<SubGmType>::InfGmType   ReducedGmType;
-    #endif
     #ifdef WITH_CPLEX
     typedef opengm::LPCplex<SubGmType,AccumulationType>         CplexSubInf;
     #endif
@@ -498,34 +548,21 @@ public:
 
         // set default fusion mover
         if(param_.fusionSolver_==DefaulFusion){
-            param_.fusionSolver_= LazyFlipperFusion;
-            #ifdef  WITH_QPBO 
-                param_.fusionSolver_ = QpboFusion;
-            #endif
+            param_.fusionSolver_ = QpboFusion;
         }
 
 
         // check 
-        if(param_.fusionSolver_ == QpboFusion){
-            #ifndef  WITH_QPBO 
-                throw RuntimeError("WITH_QPBO need to be enabled for QpboFusion");
-            #endif
-        }
         if(param_.fusionSolver_ == CplexFuison){
             #ifndef  WITH_CPLEX 
                 throw RuntimeError("WITH_CPLEX need to be enabled for CplexFusion");
             #endif
         }
-        if(param_.reducedInf_){
-            #ifndef  WITH_QPBO 
-                throw RuntimeError("WITH_QPBO need to be enabled for reducedInference");
-            #endif
-        }
 
     }
 
 
-    bool fuse(const LabelVector & argA, const LabelVector argB, LabelVector & argRes,
+    bool fuse(const LabelVector & argA, const LabelVector & argB, LabelVector & argRes,
                    const ValueType valA, const ValueType valB,ValueType & valRes){
 
         fusionMover_.setup(argA, argB, argRes, valA, valB);
@@ -534,30 +571,25 @@ public:
 
         if(fusionMover_.numberOfFusionMoveVariable()>0){
             if(param_.fusionSolver_ == QpboFusion){
-                #ifdef  WITH_QPBO
                 if(factorOrder_<=2){
                     valRes = fusionMover_. template fuseQpbo<QpboSubInf> ();
                 }
                 else{
-                    typename HQPBOSubInf::Parameter subInfParam;
-                    valRes = fusionMover_. template fuse<HQPBOSubInf> (subInfParam,true);
+                    valRes = fusionMover_. template fuseFixQpbo<QpboSubInf> (reduction_,quadratic_);
                 }
-                #endif
             }
             else if(param_.fusionSolver_ == CplexFuison){
                 #ifdef  WITH_CPLEX
                     // with reduced inference
                     if(param_.reducedInf_){
-                        #ifdef WITH_QPBO
-                            typedef opengm::LPCplex<ReducedGmType, AccumulationType>              _CplexSubInf;
-                            typedef ReducedInference<SubGmType,AccumulationType,_CplexSubInf>     CplexReducedSubInf; 
-                            typename _CplexSubInf::Parameter _subInfParam;
-                            _subInfParam.integerConstraint_ = true; 
-                            _subInfParam.numberOfThreads_   = 1;
-                            _subInfParam.timeLimit_         = param_.fusionTimeLimit_; 
-                            typename CplexReducedSubInf::Parameter subInfParam(true,param_.tentacles_,param_.connectedComponents_,_subInfParam);
-                            valRes = fusionMover_. template fuse<CplexReducedSubInf> (subInfParam,true);      
-                        #endif 
+                        typedef opengm::LPCplex<ReducedGmType, AccumulationType>              _CplexSubInf;
+                        typedef ReducedInference<SubGmType,AccumulationType,_CplexSubInf>     CplexReducedSubInf; 
+                        typename _CplexSubInf::Parameter _subInfParam;
+                        _subInfParam.integerConstraint_ = true; 
+                        _subInfParam.numberOfThreads_   = 1;
+                        _subInfParam.timeLimit_         = param_.fusionTimeLimit_; 
+                        typename CplexReducedSubInf::Parameter subInfParam(true,param_.tentacles_,param_.connectedComponents_,_subInfParam);
+                        valRes = fusionMover_. template fuse<CplexReducedSubInf> (subInfParam,true);      
                     }
                     // without reduced inference
                     else{
@@ -571,14 +603,12 @@ public:
             }
             else if(param_.fusionSolver_ == LazyFlipperFusion){
                 if(param_.reducedInf_){
-                    #ifdef WITH_QPBO
-                        typedef opengm::LazyFlipper<ReducedGmType, AccumulationType>          _LfSubInf;
-                        typedef ReducedInference<SubGmType,AccumulationType,_LfSubInf>        LfReducedSubInf; 
-                        typename _LfSubInf::Parameter _subInfParam;
-                        _subInfParam.maxSubgraphSize_= param_.maxSubgraphSize_;
-                        typename LfReducedSubInf::Parameter subInfParam(true,param_.tentacles_,param_.connectedComponents_,_subInfParam);
-                        valRes = fusionMover_. template fuse<LfReducedSubInf> (subInfParam,true);      
-                    #endif 
+                    typedef opengm::LazyFlipper<ReducedGmType, AccumulationType>          _LfSubInf;
+                    typedef ReducedInference<SubGmType,AccumulationType,_LfSubInf>        LfReducedSubInf; 
+                    typename _LfSubInf::Parameter _subInfParam;
+                    _subInfParam.maxSubgraphSize_= param_.maxSubgraphSize_;
+                    typename LfReducedSubInf::Parameter subInfParam(true,param_.tentacles_,param_.connectedComponents_,_subInfParam);
+                    valRes = fusionMover_. template fuse<LfReducedSubInf> (subInfParam,true);      
                 }
                 else{
                     const typename LazyFlipperSubInf::Parameter fuseInfParam(param_.maxSubgraphSize_);
@@ -600,6 +630,9 @@ private:
     Parameter param_;
     FusionMoverType fusionMover_;
     size_t factorOrder_;
+    // reused by the QPBO fusion of higher order models
+    typename FusionMoverType::HigherOrderReductionType reduction_;
+    typename FusionMoverType::HigherOrderReductionType::QuadraticType quadratic_;
 };
 
 
@@ -702,9 +735,16 @@ FusionMover<GM, ACC>::FusionMover(const GM &gm)
     subSpace_(gm.numberOfVariables(), 2),
     localToGlobalVi_(gm.numberOfVariables()),
     globalToLocalVi_(gm.numberOfVariables()),
-    nLocalVar_(0)
+    nLocalVar_(0),
+    factorStamp_(gm.numberOfFactors(), 0),
+    stamp_(0),
+    lvisBuffer_(),
+    localArg_(),
+    labelBufferA_(gm.factorOrder()),
+    labelBufferResult_(gm.factorOrder())
 {
-
+    lvisBuffer_.reserve(gm.factorOrder());
+    localArg_.reserve(gm.numberOfVariables());
 }
 
 
@@ -760,8 +800,59 @@ void FusionMover<GM, ACC>::fillSubModel(MODEL_PROXY &modelProxy)
 
     OPENGM_CHECK_OP(nLocalVar_, > , 0, "nothing to fuse");
 
+    // first pass: count the factors and functions of the fusion move model
+    // such that the model can reserve all its storage at once
+    size_t nUnary   = 0;
+    size_t nView    = 0;
+    size_t nFixView = 0;
+    size_t nVis     = 0;
+    ++stamp_;
+    for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
+    {
+        const IndexType vi = localToGlobalVi_[lvi];
+        const IndexType nFacVi = gm_.numberOfFactors(vi);
+        for (IndexType f = 0; f < nFacVi; ++f)
+        {
+            const IndexType fi      = gm_.factorOfVariable(vi, f);
+            const IndexType fOrder  = gm_.numberOfVariables(fi);
+            if (fOrder == 1)
+            {
+                ++nUnary;
+                ++nVis;
+            }
+            else if (factorStamp_[fi] != stamp_)
+            {
+                factorStamp_[fi] = stamp_;
+                IndexType notFixedVar = 0;
+                for (IndexType vf = 0; vf < fOrder; ++vf)
+                {
+                    const IndexType viFactor = gm_[fi].variableIndex(vf);
+                    if ((*argA_)[viFactor] != (*argB_)[viFactor])
+                    {
+                        notFixedVar += 1;
+                    }
+                }
+                if (notFixedVar == fOrder)
+                {
+                    ++nView;
+                }
+                else
+                {
+                    ++nFixView;
+                }
+                nVis += notFixedVar;
+            }
+        }
+    }
+
     modelProxy.createModel(nLocalVar_);
-    std::set<IndexType> addedFactors;
+    modelProxy.reserveFactors(nUnary + nView + nFixView, nVis);
+    modelProxy.template reserveFunctions<ArrayFunction>(nUnary);
+    modelProxy.template reserveFunctions<FuseViewingFunction>(nView);
+    modelProxy.template reserveFunctions<FuseViewingFixingFunction>(nFixView);
+
+    // second pass: add the factors
+    ++stamp_;
     for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
     {
 
@@ -789,94 +880,88 @@ void FusionMover<GM, ACC>::fillSubModel(MODEL_PROXY &modelProxy)
                 f(0) = gm_[fi](c  );
                 f(1) = gm_[fi](c + 1);
 
-                //subGm_.addFactor(subGm_.addFunction(f),vis,vis+1);
-
                 modelProxy.addFactor(f, vis, vis + 1);
             }
 
             // high order
-            else if ( addedFactors.find(fi) == addedFactors.end() )
+            else if (factorStamp_[fi] != stamp_)
             {
-                addedFactors.insert(fi);
-                IndexType fixedVar      = 0;
-                IndexType notFixedVar   = 0;
+                factorStamp_[fi] = stamp_;
 
+                // get local vis of the variables which are not fixed
+                lvisBuffer_.clear();
                 for (IndexType vf = 0; vf < fOrder; ++vf)
                 {
-                    const IndexType viFactor = gm_[fi].variableIndex(vf);
-                    if ((*argA_)[viFactor] != (*argB_)[viFactor])
-                    {
-                        notFixedVar += 1;
-                    }
-                    else
+                    const IndexType gvi = gm_[fi].variableIndex(vf);
+                    if ((*argA_)[gvi] != (*argB_)[gvi])
                     {
-                        fixedVar += 1;
+                        lvisBuffer_.push_back(globalToLocalVi_[gvi]);
                     }
                 }
-                OPENGM_CHECK_OP(notFixedVar, > , 0, "internal error");
-
+                OPENGM_CHECK_OP(lvisBuffer_.size(), > , 0, "internal error");
 
-                if (fixedVar == 0)
+                if (lvisBuffer_.size() == fOrder)
                 {
-                    OPENGM_CHECK_OP(notFixedVar, == , fOrder, "interal error")
-
-                    //std::cout<<"no fixations \n";
-
-                    // get local vis
-                    std::vector<IndexType> lvis(fOrder);
-                    for (IndexType vf = 0; vf < fOrder; ++vf)
-                    {
-                        lvis[vf] = globalToLocalVi_[gm_[fi].variableIndex(vf)];
-                    }
-
-                    //std::cout<<"construct view\n";
                     FuseViewingFunction f(gm_[fi], *argA_, *argB_);
-
-
-
-                    //std::cout<<"add  view\n";
-                    //subGm_.addFactor(subGm_.addFunction(f),lvis.begin(),lvis.end());
-                    modelProxy.addFactor(f, lvis.begin(), lvis.end());
-                    //std::cout<<"done \n";
-
+                    modelProxy.addFactor(f, lvisBuffer_.begin(), lvisBuffer_.end());
                 }
                 else
                 {
-                    OPENGM_CHECK_OP(notFixedVar + fixedVar, == , fOrder, "interal error")
+                    FuseViewingFixingFunction f(gm_[fi], *argA_, *argB_);
+                    modelProxy.addFactor(f, lvisBuffer_.begin(), lvisBuffer_.end());
+                }
+            }
+        }
+    }
+}
 
-                    //std::cout<<"fixedVar    "<<fixedVar<<"\n";
-                    //std::cout<<"notFixedVar "<<notFixedVar<<"\n";
 
-                    // get local vis
-                    std::vector<IndexType> lvis;
-                    lvis.reserve(notFixedVar);
-                    for (IndexType vf = 0; vf < fOrder; ++vf)
-                    {
-                        const IndexType gvi = gm_[fi].variableIndex(vf);
-                        if ((*argA_)[gvi] != (*argB_)[gvi])
-                        {
-                            lvis.push_back(globalToLocalVi_[gvi]);
-                        }
-                    }
-                    OPENGM_CHECK_OP(lvis.size(), == , notFixedVar, "internal error");
 
 
-                    //std::cout<<"construct fix view\n";
-                    FuseViewingFixingFunction f(gm_[fi], *argA_, *argB_);
-                    //std::cout<<"add  fix view\n";
-                    modelProxy.addFactor(f, lvis.begin(), lvis.end());
-                    //subGm_.addFactor(subGm_.addFunction(f),lvis.begin(),lvis.end());
-                    //std::cout<<"done \n";
+template<class GM, class ACC>
+typename FusionMover<GM, ACC>::ValueType
+FusionMover<GM, ACC>::evaluateResult()
+{
+    // valueA - f(argA) + f(result) is undefined (inf - inf) if argA violates
+    // a hard constraint
+    const ValueType maxValue = std::numeric_limits<ValueType>::max();
+    if (!meta::Compare<OperatorType, Adder>::value || !(valueA_ <= maxValue && valueA_ >= -maxValue))
+    {
+        return gm_.evaluate(*argResult_);
+    }
 
+    // the result differs from argA only in the fusion move variables,
+    // therefore only the factors connected to them need to be evaluated
+    ValueType value = valueA_;
+    ++stamp_;
+    for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
+    {
+        const IndexType vi = localToGlobalVi_[lvi];
+        const IndexType nFacVi = gm_.numberOfFactors(vi);
+        for (IndexType f = 0; f < nFacVi; ++f)
+        {
+            const IndexType fi = gm_.factorOfVariable(vi, f);
+            if (factorStamp_[fi] != stamp_)
+            {
+                factorStamp_[fi] = stamp_;
+                const IndexType fOrder = gm_.numberOfVariables(fi);
+                for (IndexType vf = 0; vf < fOrder; ++vf)
+                {
+                    const IndexType gvi = gm_[fi].variableIndex(vf);
+                    labelBufferA_[vf]      = (*argA_)[gvi];
+                    labelBufferResult_[vf] = (*argResult_)[gvi];
                 }
+                OperatorType::iop(gm_[fi](labelBufferA_.begin()), value);
+                OperatorType::op(gm_[fi](labelBufferResult_.begin()), value);
             }
         }
     }
+    OPENGM_ASSERT(value == gm_.evaluate(*argResult_)
+        || std::fabs(value - gm_.evaluate(*argResult_)) <= 1e-6 * std::max<ValueType>(1, std::fabs(gm_.evaluate(*argResult_))));
+    return value;
 }
 
 
-
-
 template<class GM, class ACC>
 template<class SOLVER>
 typename FusionMover<GM, ACC>::ValueType
@@ -894,22 +979,21 @@ FusionMover<GM, ACC>::fuse(
 
     //std::cout<<"solve sub problem ... "<<std::flush;
     SOLVER solver(*(modelProxy.model_), param);
-    std::vector<LabelType> localArg(nLocalVar_);
+    localArg_.assign(nLocalVar_, bestLabel_);
     if (warmStart)
     {
-        std::fill( localArg.begin(), localArg.end(),bestLabel_);
-        solver.setStartingPoint(localArg.begin());
+        solver.setStartingPoint(localArg_.begin());
     }
 
     if(solver.infer()!=UNKNOWN){
-       solver.arg(localArg);
+       solver.arg(localArg_);
        for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
        {
           const IndexType globalVi = localToGlobalVi_[lvi];
-          const LabelType l = localArg[lvi];
+          const LabelType l = localArg_[lvi];
           (*argResult_)[globalVi] =  (l == 0 ?  (*argA_)[globalVi]  :   (*argB_)[globalVi]) ;
        }
-       valueResult_ = gm_.evaluate(*argResult_);
+       valueResult_ = this->evaluateResult();
        if (AccumulationType::bop(valueBest_, valueResult_))
        {
           valueResult_ = valueBest_;
@@ -937,17 +1021,17 @@ FusionMover<GM, ACC>::fuseAd3(
 
 
 
-    std::vector<LabelType> localArg(nLocalVar_);
+    localArg_.resize(nLocalVar_);
     modelProxy.model_->infer();
-    modelProxy.model_->arg(localArg);
+    modelProxy.model_->arg(localArg_);
 
     for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
     {
         const IndexType globalVi = localToGlobalVi_[lvi];
-        const LabelType l = localArg[lvi];
+        const LabelType l = localArg_[lvi];
         (*argResult_)[globalVi] =  (l == 0 ?  (*argA_)[globalVi]  :   (*argB_)[globalVi]) ;
     }
-    valueResult_ = gm_.evaluate(*argResult_);
+    valueResult_ = this->evaluateResult();
 
     if (AccumulationType::bop(valueBest_, valueResult_))
     {
@@ -998,7 +1082,7 @@ FusionMover<GM, ACC>::fuseQpbo(
             (*argResult_)[globalVi] =  (*argBest_)[globalVi];
         }
     }
-    valueResult_ = gm_.evaluate(*argResult_);
+    valueResult_ = this->evaluateResult();
     if (AccumulationType::bop(valueBest_, valueResult_))
     {
         valueResult_ = valueBest_;
@@ -1016,115 +1100,39 @@ FusionMover<GM, ACC>::fuseFixQpbo(
 
 )
 {
+    HigherOrderReductionType reduction;
+    typename HigherOrderReductionType::QuadraticType quadratic;
+    return this-> template fuseFixQpbo<SOLVER>(reduction, quadratic);
+}
 
-    //std::cout<<"fill native for qbpo fix reduction model\n";
+
+template<class GM, class ACC>
+template<class SOLVER>
+typename FusionMover<GM, ACC>::ValueType
+FusionMover<GM, ACC>::fuseFixQpbo(
+    HigherOrderReductionType & reduction,
+    typename HigherOrderReductionType::QuadraticType & quadratic
+)
+{
     NativeModelProxy<SubGmType> modelProxy;
     this->fillSubModel(modelProxy);
 
     const SubGmType &subGm = *(modelProxy.model_);
 
     // DO MOVE
-    unsigned int maxNumAssignments = 1 << maxOrder_;
-    std::vector<ValueType> coeffs(maxNumAssignments);
-    std::vector<LabelType> cliqueLabels(maxOrder_);
-
-    HigherOrderEnergy<ValueType, maxOrder_> hoe;
-    hoe.AddVars(subGm.numberOfVariables());
-    for (IndexType f = 0; f < subGm.numberOfFactors(); ++f)
-    {
-        IndexType size = subGm[f].numberOfVariables();
-        if (size == 0)
-        {
-            continue;
-        }
-        else if (size == 1)
-        {
-            IndexType var = subGm[f].variableIndex(0);
-
-            const LabelType lla[] = {0};
-            const LabelType llb[] = {1};
-
-
-            ValueType e0 = subGm[f](lla);
-            ValueType e1 = subGm[f](llb);
-            hoe.AddUnaryTerm(var, e1 - e0);
-        }
-        else
-        {
-
-            // unsigned int numAssignments = std::pow(2,size);
-            unsigned int numAssignments = 1 << size;
-
-
-            // -- // ValueType coeffs[numAssignments];
-            for (unsigned int subset = 1; subset < numAssignments; ++subset)
-            {
-                coeffs[subset] = 0;
-            }
-            // For each boolean assignment, get the clique energy at the
-            // corresponding labeling
-            // -- // LabelType cliqueLabels[size];
-            for (unsigned int assignment = 0;  assignment < numAssignments; ++assignment)
-            {
-                for (unsigned int i = 0; i < size; ++i)
-                {
-                    //if (    assignment%2 ==  (std::pow(2,i))%2  )
-                    if (assignment & (1 << i))
-                    {
-                        cliqueLabels[i] = 0;
-                    }
-                    else
-                    {
-                        cliqueLabels[i] = 1;
-                    }
-                }
-                ValueType energy = subGm[f](cliqueLabels.begin());
-                for (unsigned int subset = 1; subset < numAssignments; ++subset)
-                {
-                    // if (assigment%2 != subset%2)
-                    if (assignment & ~subset)
-                    {
-                        continue;
-                    }
-                    //(assigment%2 == subset%2)
-                    else
-                    {
-                        int parity = 0;
-                        for (unsigned int b = 0; b < size; ++b)
-                        {
-                            parity ^=  (((assignment ^ subset) & (1 << b)) != 0);
-                        }
-                        coeffs[subset] += parity ? -energy : energy;
-                    }
-                }
-            }
-            typename HigherOrderEnergy<ValueType, maxOrder_> ::VarId vars[maxOrder_];
-            for (unsigned int subset = 1; subset < numAssignments; ++subset)
-            {
-                int degree = 0;
-                for (unsigned int b = 0; b < size; ++b)
-                {
-                    if (subset & (1 << b))
-                    {
-                        vars[degree++] = subGm[f].variableIndex(b);
-                    }
-                }
-                std::sort(vars, vars + degree);
-                hoe.AddTerm(coeffs[subset], degree, vars);
-            }
-        }
-    }
-    SOLVER  qr(subGm.numberOfVariables(), 0);
-    hoe.ToQuadratic(qr);
+    // (label 0 of a fusion move variable is argA, label 1 is argB)
+    reduction.addModel(subGm);
+    reduction.reduce(quadratic);
+    SOLVER  qr(quadratic.numberOfNodes(), quadratic.numberOfPairwiseTerms());
+    quadratic.addTo(qr);
     qr.Solve();
-    IndexType numberOfChangedVariables = 0;
 
 
     // get result arg
     for (IndexType lvi = 0; lvi < nLocalVar_; ++lvi)
     {
         const IndexType globalVi = localToGlobalVi_[lvi];
-        const LabelType l = qr.GetLabel(lvi);
+        const int l = qr.GetLabel(lvi);
         if (l == 0 || l == 1)
         {
             (*argResult_)[globalVi] =  (l == 0 ?  (*argA_)[globalVi]  :   (*argB_)[globalVi]) ;
@@ -1134,7 +1142,7 @@ FusionMover<GM, ACC>::fuseFixQpbo(
             (*argResult_)[globalVi] =  (*argBest_)[globalVi];
         }
     }
-    valueResult_ = gm_.evaluate(*argResult_);
+    valueResult_ = this->evaluateResult();
     if (AccumulationType::bop(valueBest_, valueResult_))
     {
         valueResult_ = valueBest_;
@@ -0,0 +1,579 @@
+#pragma once
+#ifndef OPENGM_HIGHER_ORDER_REDUCTION_HXX
+#define OPENGM_HIGHER_ORDER_REDUCTION_HXX
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstddef>
+
+#include "opengm/opengm.hxx"
+
+namespace opengm {
+
+/// \brief Quadratic pseudo-boolean function
+///
+/// E(x) = constant + sum_i unary_i x_i + sum_(i,j) c_ij x_i x_j
+///
+/// Output buffer of HigherOrderReduction. clear() keeps the allocated
+/// memory, such that a buffer can be reused for a sequence of problems
+/// (e.g. fusion moves).
+template<class VALUE>
+class QuadraticPseudoBoolean {
+public:
+   typedef VALUE ValueType;
+   struct PairwiseTerm {
+      size_t first_;
+      size_t second_;
+      ValueType coefficient_;
+   };
+
+   QuadraticPseudoBoolean()
+   :  constant_(0)
+   {}
+   void clear(const size_t numberOfNodes) {
+      constant_ = 0;
+      unary_.assign(numberOfNodes, 0);
+      pairwise_.clear();
+   }
+   void reserve(const size_t numberOfNodes, const size_t numberOfPairwiseTerms) {
+      unary_.reserve(numberOfNodes);
+      pairwise_.reserve(numberOfPairwiseTerms);
+   }
+   size_t addNode() {
+      unary_.push_back(0);
+      return unary_.size() - 1;
+   }
+   void addPairwiseTerm(const size_t i, const size_t j, const ValueType coefficient) {
+      PairwiseTerm term;
+      term.first_ = i;
+      term.second_ = j;
+      term.coefficient_ = coefficient;
+      pairwise_.push_back(term);
+   }
+   size_t numberOfNodes() const
+      { return unary_.size(); }
+   size_t numberOfPairwiseTerms() const
+      { return pairwise_.size(); }
+   ValueType constant() const
+      { return constant_; }
+   ValueType unary(const size_t i) const
+      { return unary_[i]; }
+   const PairwiseTerm& pairwiseTerm(const size_t n) const
+      { return pairwise_[n]; }
+
+   template<class ITERATOR>
+      ValueType evaluate(ITERATOR) const;
+   template<class QR>
+      void addTo(QR&) const;
+
+   ValueType constant_;
+   std::vector<ValueType> unary_;
+   std::vector<PairwiseTerm> pairwise_;
+};
+
+/// \brief Reduction of higher order pseudo-boolean functions to quadratic ones
+///
+/// H. Ishikawa, "Transformation of general binary MRF minimization to the
+/// first-order case", PAMI 2011 (HOCR)\n
+/// A. Fix, A. Gruber, E. Boros, and R. Zabih, "A graph cut algorithm for
+/// higher-order Markov random fields", ICCV 2011 (Fix)
+///
+/// The multilinear polynomial is collected in flat arrays, either term by
+/// term (addTerm) or from the factors of a graphical model with binary
+/// variables (addFactor, addModel), which are evaluated through the
+/// function type of the factor. Duplicate monomials are merged by sorting.
+/// reduce() writes the quadratic function into a QuadraticPseudoBoolean
+/// whose first nodes are the variables; the minimum over the additional
+/// nodes equals the original function for every labeling of the variables.
+///
+/// Negative terms of degree d>2 are reduced with one additional node
+/// (Freedman and Drineas), positive ones with floor((d-1)/2) additional nodes
+/// (HOCR) or by eliminating all positive terms that start with the same
+/// variable with one additional node (Fix).
+///
+/// \ingroup inference
+template<class VALUE, class INDEX = size_t>
+class HigherOrderReduction {
+public:
+   typedef VALUE ValueType;
+   typedef INDEX IndexType;
+   typedef QuadraticPseudoBoolean<ValueType> QuadraticType;
+   enum Method {HOCR, Fix};
+
+   HigherOrderReduction(const size_t = 0, const Method = Fix);
+   void reset(const size_t);
+   void setMethod(const Method method)
+      { method_ = method; }
+   Method method() const
+      { return method_; }
+   size_t numberOfVariables() const
+      { return unary_.size(); }
+   size_t numberOfTerms() const
+      { return coefficients_.size(); }
+
+   void addConstant(const ValueType value)
+      { constant_ += value; }
+   void addUnaryTerm(const IndexType variable, const ValueType coefficient)
+      { unary_[variable] += coefficient; }
+   template<class ITERATOR>
+      void addTerm(const ValueType, ITERATOR, ITERATOR);
+   template<class FACTOR>
+      void addFactor(const FACTOR&);
+   template<class GM>
+      void addModel(const GM&);
+   void reduce(QuadraticType&);
+
+private:
+   template<class FACTOR>
+   struct FactorFunctor {
+      FactorFunctor(HigherOrderReduction& reduction, const FACTOR& factor)
+      :  reduction_(reduction), factor_(factor)
+      {}
+      template<class FUNCTION>
+      void operator()(const FUNCTION&);
+      HigherOrderReduction& reduction_;
+      const FACTOR& factor_;
+   };
+
+   struct TermLess {
+      TermLess(const HigherOrderReduction& reduction)
+      :  reduction_(reduction)
+      {}
+      bool operator()(const size_t, const size_t) const;
+      const HigherOrderReduction& reduction_;
+   };
+
+   size_t degree(const size_t t) const
+      { return begin_[t + 1] - begin_[t]; }
+   void pushTerm(const ValueType, const IndexType*, const size_t);
+   void normalize();
+   void reduceNegative(QuadraticType&, const ValueType, const IndexType*, const size_t, const IndexType* = NULL) const;
+   void reducePositive(QuadraticType&, const ValueType, const IndexType*, const size_t) const;
+
+   Method method_;
+   ValueType constant_;
+   std::vector<ValueType> unary_;
+   // terms of degree >= 2, the variables of term t are
+   // variables_[begin_[t]] ... variables_[begin_[t+1]-1] in increasing order
+   std::vector<ValueType> coefficients_;
+   std::vector<size_t> begin_;
+   std::vector<IndexType> variables_;
+   // buffers reused between the calls
+   std::vector<ValueType> values_;
+   std::vector<size_t> labels_;
+   std::vector<IndexType> term_;
+   std::vector<size_t> order_;
+   std::vector<ValueType> mergedCoefficients_;
+   std::vector<size_t> mergedBegin_;
+   std::vector<IndexType> mergedVariables_;
+   std::vector<size_t> first_;
+   std::vector<size_t> next_;
+};
+
+/// \brief evaluate the quadratic function for a labeling of all its nodes
+template<class VALUE>
+template<class ITERATOR>
+inline typename QuadraticPseudoBoolean<VALUE>::ValueType
+QuadraticPseudoBoolean<VALUE>::evaluate
+(
+   ITERATOR labels
+) const {
+   ValueType value = constant_;
+   for(size_t i = 0; i < unary_.size(); ++i) {
+      if(labels[i] != 0) {
+         value += unary_[i];
+      }
+   }
+   for(size_t n = 0; n < pairwise_.size(); ++n) {
+      if(labels[pairwise_[n].first_] != 0 && labels[pairwise_[n].second_] != 0) {
+         value += pairwise_[n].coefficient_;
+      }
+   }
+   return value;
+}
+
+/// \brief add the function to a QPBO solver (interface of QPBOGraph), the constant is not added
+template<class VALUE>
+template<class QR>
+inline void
+QuadraticPseudoBoolean<VALUE>::addTo
+(
+   QR& qr
+) const {
+   qr.SetMaxEdgeNum(static_cast<int>(pairwise_.size()));
+   const typename QR::NodeId first = qr.AddNode(static_cast<int>(unary_.size()));
+   for(size_t i = 0; i < unary_.size(); ++i) {
+      if(unary_[i] != 0) {
+         qr.AddUnaryTerm(first + i, 0, unary_[i]);
+      }
+   }
+   for(size_t n = 0; n < pairwise_.size(); ++n) {
+      qr.AddPairwiseTerm(first + pairwise_[n].first_, first + pairwise_[n].second_, 0, 0, 0, pairwise_[n].coefficient_);
+   }
+}
+
+template<class VALUE, class INDEX>
+inline
+HigherOrderReduction<VALUE, INDEX>::HigherOrderReduction
+(
+   const size_t numberOfVariables,
+   const Method method
+)
+:  method_(method)
+{
+   reset(numberOfVariables);
+}
+
+/// \brief remove all terms, the allocated memory is kept
+template<class VALUE, class INDEX>
+inline void
+HigherOrderReduction<VALUE, INDEX>::reset
+(
+   const size_t numberOfVariables
+) {
+   constant_ = 0;
+   unary_.assign(numberOfVariables, 0);
+   coefficients_.clear();
+   begin_.assign(1, 0);
+   variables_.clear();
+}
+
+template<class VALUE, class INDEX>
+inline void
+HigherOrderReduction<VALUE, INDEX>::pushTerm
+(
+   const ValueType coefficient,
+   const IndexType* variables,
+   const size_t degree
+) {
+   coefficients_.push_back(coefficient);
+   variables_.insert(variables_.end(), variables, variables + degree);
+   begin_.push_back(variables_.size());
+}
+
+/// \brief add the monomial coefficient * prod_{v in [begin,end)} x_v
+///
+/// \param coefficient
+/// \param begin iterator to the (distinct) variable indices
+/// \param end
+template<class VALUE, class INDEX>
+template<class ITERATOR>
+inline void
+HigherOrderReduction<VALUE, INDEX>::addTerm
+(
+   const ValueType coefficient,
+   ITERATOR begin,
+   ITERATOR end
+) {
+   if(coefficient == 0) {
+      return;
+   }
+   term_.assign(begin, end);
+   if(term_.size() == 0) {
+      constant_ += coefficient;
+   }
+   else if(term_.size() == 1) {
+      unary_[term_[0]] += coefficient;
+   }
+   else {
+      std::sort(term_.begin(), term_.end());
+      pushTerm(coefficient, &term_[0], term_.size());
+   }
+}
+
+// coefficients of the multilinear polynomial of the function by the
+// Moebius transform of its values, variable b of the factor is bit b
+template<class VALUE, class INDEX>
+template<class FACTOR>
+template<class FUNCTION>
+inline void
+HigherOrderReduction<VALUE, INDEX>::FactorFunctor<FACTOR>::operator()
+(
+   const FUNCTION& function
+) {
+   const size_t order = factor_.numberOfVariables();
+   const size_t numberOfAssignments = size_t(1) << order;
+   std::vector<ValueType>& values = reduction_.values_;
+   std::vector<size_t>& labels = reduction_.labels_;
+   values.resize(numberOfAssignments);
+   labels.assign(order, 0);
+   for(size_t assignment = 0; assignment < numberOfAssignments; ++assignment) {
+      for(size_t b = 0; b < order; ++b) {
+         labels[b] = (assignment >> b) & 1;
+      }
+      values[assignment] = function(labels.begin());
+   }
+   for(size_t b = 0; b < order; ++b) {
+      for(size_t assignment = 0; assignment < numberOfAssignments; ++assignment) {
+         if(assignment & (size_t(1) << b)) {
+            values[assignment] -= values[assignment ^ (size_t(1) << b)];
+         }
+      }
+   }
+   reduction_.constant_ += values[0];
+   for(size_t b = 0; b < order; ++b) {
+      reduction_.unary_[factor_.variableIndex(b)] += values[size_t(1) << b];
+   }
+   IndexType variables[64];
+   for(size_t subset = 1; subset < numberOfAssignments; ++subset) {
+      if(values[subset] == 0 || (subset & (subset - 1)) == 0) {
+         continue;
+      }
+      size_t degree = 0;
+      for(size_t b = 0; b < order; ++b) {
+         if(subset & (size_t(1) << b)) {
+            variables[degree++] = static_cast<IndexType>(factor_.variableIndex(b));
+         }
+      }
+      // the variables of a factor are sorted
+      reduction_.pushTerm(values[subset], variables, degree);
+   }
+}
+
+/// \brief add the function of a factor of binary variables
+template<class VALUE, class INDEX>
+template<class FACTOR>
+inline void
+HigherOrderReduction<VALUE, INDEX>::addFactor
+(
+   const FACTOR& factor
+) {
+   for(size_t b = 0; b < factor.numberOfVariables(); ++b) {
+      if(factor.numberOfLabels(b) != 2) {
+         throw RuntimeError("HigherOrderReduction supports only binary variables.");
+      }
+   }
+   if(factor.numberOfVariables() >= 8 * sizeof(size_t) - 1) {
+      throw RuntimeError("HigherOrderReduction: the order of the factor is too large.");
+   }
+   FactorFunctor<FACTOR> functor(*this, factor);
+   factor.callFunctor(functor);
+}
+
+/// \brief reset to the variables of the model and add all its factors
+template<class VALUE, class INDEX>
+template<class GM>
+inline void
+HigherOrderReduction<VALUE, INDEX>::addModel
+(
+   const GM& gm
+) {
+   reset(gm.numberOfVariables());
+   for(typename GM::IndexType f = 0; f < gm.numberOfFactors(); ++f) {
+      addFactor(gm[f]);
+   }
+}
+
+template<class VALUE, class INDEX>
+inline bool
+HigherOrderReduction<VALUE, INDEX>::TermLess::operator()
+(
+   const size_t s,
+   const size_t t
+) const {
+   const size_t ds = reduction_.degree(s);
+   const size_t dt = reduction_.degree(t);
+   if(ds != dt) {
+      return ds < dt;
+   }
+   const IndexType* vs = &reduction_.variables_[reduction_.begin_[s]];
+   const IndexType* vt = &reduction_.variables_[reduction_.begin_[t]];
+   return std::lexicographical_compare(vs, vs + ds, vt, vt + dt);
+}
+
+// merge duplicate monomials and remove zero terms
+template<class VALUE, class INDEX>
+void
+HigherOrderReduction<VALUE, INDEX>::normalize() {
+   order_.resize(coefficients_.size());
+   for(size_t t = 0; t < order_.size(); ++t) {
+      order_[t] = t;
+   }
+   std::sort(order_.begin(), order_.end(), TermLess(*this));
+   mergedCoefficients_.clear();
+   mergedBegin_.assign(1, 0);
+   mergedVariables_.clear();
+   TermLess less(*this);
+   for(size_t n = 0; n < order_.size(); ) {
+      const size_t t = order_[n];
+      ValueType coefficient = coefficients_[t];
+      size_t m = n + 1;
+      while(m < order_.size() && !less(t, order_[m])) {
+         coefficient += coefficients_[order_[m]];
+         ++m;
+      }
+      if(coefficient != 0) {
+         mergedCoefficients_.push_back(coefficient);
+         mergedVariables_.insert(mergedVariables_.end(), variables_.begin() + begin_[t], variables_.begin() + begin_[t + 1]);
+         mergedBegin_.push_back(mergedVariables_.size());
+      }
+      n = m;
+   }
+   coefficients_.swap(mergedCoefficients_);
+   begin_.swap(mergedBegin_);
+   variables_.swap(mergedVariables_);
+}
+
+// coefficient * x_1...x_d = min_w coefficient * w (x_1 + ... + x_d - (d-1)) for coefficient < 0,
+// the optional additional variable is the (d+1)-th factor of the monomial
+template<class VALUE, class INDEX>
+inline void
+HigherOrderReduction<VALUE, INDEX>::reduceNegative
+(
+   QuadraticType& quadratic,
+   const ValueType coefficient,
+   const IndexType* variables,
+   const size_t degree,
+   const IndexType* additional
+) const {
+   const size_t d = degree + (additional != NULL ? 1 : 0);
+   if(d == 2) {
+      quadratic.addPairwiseTerm(variables[0], additional != NULL ? *additional : variables[1], coefficient);
+      return;
+   }
+   const size_t w = quadratic.addNode();
+   for(size_t i = 0; i < degree; ++i) {
+      quadratic.addPairwiseTerm(variables[i], w, coefficient);
+   }
+   if(additional != NULL) {
+      quadratic.addPairwiseTerm(*additional, w, coefficient);
+   }
+   quadratic.unary_[w] -= coefficient * static_cast<ValueType>(d - 1);
+}
+
+// HOCR, coefficient * x_1...x_d = coefficient * (S_2 + min_w sum_i w_i (c_i (2i - S_1) - 1))
+// for coefficient > 0 with S_1 = sum_i x_i, S_2 = sum_{i<j} x_i x_j and
+// c_i = 1 for the last w_i if d is odd, c_i = 2 otherwise
+template<class VALUE, class INDEX>
+inline void
+HigherOrderReduction<VALUE, INDEX>::reducePositive
+(
+   QuadraticType& quadratic,
+   const ValueType coefficient,
+   const IndexType* variables,
+   const size_t degree
+) const {
+   for(size_t i = 0; i < degree; ++i) {
+      for(size_t j = i + 1; j < degree; ++j) {
+         quadratic.addPairwiseTerm(variables[i], variables[j], coefficient);
+      }
+   }
+   const size_t numberOfAdditional = (degree - 1) / 2;
+   for(size_t i = 1; i <= numberOfAdditional; ++i) {
+      const ValueType c = (degree % 2 == 1 && i == numberOfAdditional) ? 1 : 2;
+      const size_t w = quadratic.addNode();
+      for(size_t j = 0; j < degree; ++j) {
+         quadratic.addPairwiseTerm(variables[j], w, -c * coefficient);
+      }
+      quadratic.unary_[w] += coefficient * (c * static_cast<ValueType>(2 * i) - 1);
+   }
+}
+
+/// \brief write the reduced quadratic function into the buffer
+///
+/// The terms are merged, the polynomial itself is not changed.
+template<class VALUE, class INDEX>
+void
+HigherOrderReduction<VALUE, INDEX>::reduce
+(
+   QuadraticType& quadratic
+) {
+   normalize();
+   const size_t numberOfVariables = unary_.size();
+   const size_t numberOfTerms = coefficients_.size();
+
+   // size of the quadratic function (exact for HOCR, upper bound for Fix)
+   size_t numberOfNodes = numberOfVariables;
+   size_t numberOfPairwiseTerms = 0;
+   for(size_t t = 0; t < numberOfTerms; ++t) {
+      const size_t d = degree(t);
+      if(d == 2) {
+         ++numberOfPairwiseTerms;
+      }
+      else if(coefficients_[t] < 0) {
+         numberOfNodes += 1;
+         numberOfPairwiseTerms += d;
+      }
+      else if(method_ == HOCR) {
+         numberOfNodes += (d - 1) / 2;
+         numberOfPairwiseTerms += d * (d - 1) / 2 + ((d - 1) / 2) * d;
+      }
+      else {
+         numberOfNodes += d;
+         numberOfPairwiseTerms += d * (d + 3) / 2;
+      }
+   }
+   quadratic.clear(numberOfVariables);
+   quadratic.reserve(numberOfNodes, numberOfPairwiseTerms);
+   quadratic.constant_ = constant_;
+   std::copy(unary_.begin(), unary_.end(), quadratic.unary_.begin());
+
+   if(method_ == HOCR) {
+      for(size_t t = 0; t < numberOfTerms; ++t) {
+         const IndexType* variables = &variables_[begin_[t]];
+         if(degree(t) == 2) {
+            quadratic.addPairwiseTerm(variables[0], variables[1], coefficients_[t]);
+         }
+         else if(coefficients_[t] < 0) {
+            reduceNegative(quadratic, coefficients_[t], variables, degree(t));
+         }
+         else {
+            reducePositive(quadratic, coefficients_[t], variables, degree(t));
+         }
+      }
+      return;
+   }
+
+   // Fix: the positive terms of degree > 2 are kept in lists by their first
+   // variable. sum_H a_H x_H over the terms H of the list of variable v equals
+   // min_y (sum_H a_H) x_v y + sum_H a_H x_{H\v} - sum_H a_H x_{H\v} y
+   const size_t none = std::numeric_limits<size_t>::max();
+   first_.assign(numberOfVariables, none);
+   next_.assign(numberOfTerms, none);
+   for(size_t t = numberOfTerms; t-- > 0; ) {
+      const IndexType* variables = &variables_[begin_[t]];
+      if(degree(t) == 2) {
+         quadratic.addPairwiseTerm(variables[0], variables[1], coefficients_[t]);
+      }
+      else if(coefficients_[t] < 0) {
+         reduceNegative(quadratic, coefficients_[t], variables, degree(t));
+      }
+      else {
+         next_[t] = first_[variables[0]];
+         first_[variables[0]] = t;
+      }
+   }
+   const size_t numberOfOriginalTerms = numberOfTerms;
+   for(size_t v = 0; v < numberOfVariables; ++v) {
+      if(first_[v] == none) {
+         continue;
+      }
+      const IndexType y = static_cast<IndexType>(quadratic.addNode());
+      ValueType sum = 0;
+      for(size_t t = first_[v]; t != none; t = next_[t]) {
+         const ValueType coefficient = coefficients_[t];
+         const size_t d = degree(t);
+         term_.assign(variables_.begin() + begin_[t] + 1, variables_.begin() + begin_[t + 1]);
+         sum += coefficient;
+         if(d - 1 == 2) {
+            quadratic.addPairwiseTerm(term_[0], term_[1], coefficient);
+         }
+         else {
+            pushTerm(coefficient, &term_[0], d - 1);
+            next_.push_back(first_[term_[0]]);
+            first_[term_[0]] = coefficients_.size() - 1;
+         }
+         reduceNegative(quadratic, -coefficient, &term_[0], d - 1, &y);
+      }
+      quadratic.addPairwiseTerm(v, y, sum);
+   }
+   // remove the terms added by the elimination
+   coefficients_.resize(numberOfOriginalTerms);
+   begin_.resize(numberOfOriginalTerms + 1);
+   variables_.resize(begin_.back());
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_HIGHER_ORDER_REDUCTION_HXX
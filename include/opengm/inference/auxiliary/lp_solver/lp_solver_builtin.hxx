@@ -0,0 +1,1297 @@
+#ifndef OPENGM_LP_SOLVER_BUILTIN_HXX_
+#define OPENGM_LP_SOLVER_BUILTIN_HXX_
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/opengm.hxx>
+#include <opengm/inference/auxiliary/lpdef.hxx>
+#include <opengm/inference/auxiliary/lp_solver/lp_solver_interface.hxx>
+#include <opengm/utilities/timer.hxx>
+
+/*********************
+ * class definition *
+ *********************/
+namespace opengm {
+
+class LPSolverBuiltin : public LPSolverInterface<LPSolverBuiltin, double, int, std::vector<double>::const_iterator, double> {
+public:
+   // typedefs
+   typedef double                                        BuiltinValueType;
+   typedef int                                           BuiltinIndexType;
+   typedef std::vector<BuiltinValueType>::const_iterator BuiltinSolutionIteratorType;
+   typedef double                                        BuiltinTimingType;
+
+   typedef LPSolverInterface<LPSolverBuiltin, BuiltinValueType, BuiltinIndexType, BuiltinSolutionIteratorType, BuiltinTimingType> LPSolverBaseClass;
+
+   // enums
+   enum BuiltinParameter {TimeLimit, Threads, OptimalityTolerance, FeasibilityTolerance, MaxIterations};
+
+   // constructor
+   LPSolverBuiltin(const Parameter& parameter = Parameter());
+
+   // destructor
+   ~LPSolverBuiltin();
+
+   // statistics of the last call of solve()
+   size_t numberOfIterations() const;
+   bool converged() const;
+
+protected:
+   // types
+   enum ConstraintSense {EqualSense, LessEqualSense, GreaterEqualSense};
+   struct ScaledProblem;
+   struct Residuals;
+
+   // model
+   bool                          maximize_;
+   std::vector<BuiltinValueType> objective_;
+   std::vector<BuiltinValueType> lowerBounds_;
+   std::vector<BuiltinValueType> upperBounds_;
+   std::vector<size_t>           rowBegin_;
+   std::vector<BuiltinIndexType> columns_;
+   std::vector<BuiltinValueType> coefficients_;
+   std::vector<BuiltinValueType> rowBounds_;
+   std::vector<unsigned char>    rowSenses_;
+   std::vector<std::string>      rowNames_;
+
+   // settings
+   double timeLimit_;
+   int    numberOfThreads_;
+   double optimalityTolerance_;
+   double feasibilityTolerance_;
+   size_t maxNumberOfIterations_;
+
+   // solution and warm start
+   std::vector<BuiltinValueType> solution_;
+   std::vector<BuiltinValueType> dual_;
+   double                        primalWeight_;
+   double                        stepSize_;
+   BuiltinValueType              objectiveValue_;
+   BuiltinValueType              objectiveBound_;
+   size_t                        numberOfIterations_;
+   bool                          converged_;
+
+   // methods for class LPSolverInterface
+   // builtin infinity value
+   static BuiltinValueType infinity_impl();
+
+   // add Variables
+   void addContinuousVariables_impl(const BuiltinIndexType numVariables, const BuiltinValueType lowerBound, const BuiltinValueType upperBound);
+   void addIntegerVariables_impl(const BuiltinIndexType numVariables, const BuiltinValueType lowerBound, const BuiltinValueType upperBound);
+   void addBinaryVariables_impl(const BuiltinIndexType numVariables);
+
+   // objective function
+   void setObjective_impl(const Objective objective);
+   void setObjectiveValue_impl(const BuiltinIndexType variable, const BuiltinValueType value);
+   template<class ITERATOR_TYPE>
+   void setObjectiveValue_impl(ITERATOR_TYPE begin, const ITERATOR_TYPE end);
+   template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+   void setObjectiveValue_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin);
+
+   // constraints
+   template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+   void addEqualityConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "");
+   template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+   void addLessEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "");
+   template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+   void addGreaterEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "");
+
+   template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+   void addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin);
+
+   void addConstraintsFinished_impl();
+   void addConstraintsFinished_impl(BuiltinTimingType& timing);
+
+   // parameter
+   template <class PARAMETER_TYPE, class PARAMETER_VALUE_TYPE>
+   void setParameter_impl(const PARAMETER_TYPE parameter, const PARAMETER_VALUE_TYPE value);
+
+   // solve
+   bool solve_impl();
+   bool solve_impl(BuiltinTimingType& timing);
+
+   // solution
+   BuiltinSolutionIteratorType solutionBegin_impl() const;
+   BuiltinSolutionIteratorType solutionEnd_impl() const;
+   BuiltinValueType solution_impl(const BuiltinIndexType variable) const;
+
+   BuiltinValueType objectiveFunctionValue_impl() const;
+   BuiltinValueType objectiveFunctionValueBound_impl() const;
+
+   // model export
+   void exportModel_impl(const std::string& filename) const;
+
+   // helper functions
+   template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+   void addConstraint(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const ConstraintSense sense, const BuiltinValueType bound, const std::string& constraintName);
+   bool solveWithoutConstraints();
+   void scaleProblem(ScaledProblem& problem) const;
+   static void multiply(const ScaledProblem& problem, const std::vector<double>& x, std::vector<double>& result);
+   static void multiplyTransposed(const ScaledProblem& problem, const std::vector<double>& y, std::vector<double>& result);
+   static void evaluate(const ScaledProblem& problem, const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& ax, const std::vector<double>& aty, Residuals& residuals);
+
+   // friend
+   friend class LPSolverInterface<LPSolverBuiltin, BuiltinValueType, BuiltinIndexType, BuiltinSolutionIteratorType, BuiltinTimingType>;
+};
+
+} // namespace opengm
+
+/***********************
+ * class documentation *
+ ***********************/
+/*! \file lp_solver_builtin.hxx
+ *  \brief Provides a self-contained LP Solver which does not depend on any
+ *         external library.
+ */
+
+/*! \class opengm::LPSolverBuiltin
+ *  \brief Built-in sparse LP solver implementing the LPSolverInterface.
+ *
+ *  The solver uses the restarted primal-dual hybrid gradient method (PDHG)
+ *  with adaptive step sizes, primal weight updates and diagonal
+ *  preconditioning (Ruiz equilibration followed by Pock-Chambolle scaling)
+ *  as described in
+ *  D. Applegate, M. Diaz, O. Hinder, H. Lu, M. Lubin, B. O'Donoghue and
+ *  W. Schudy: "Practical Large-Scale Linear Programming using Primal-Dual
+ *  Hybrid Gradient", NeurIPS 2021.
+ *  Every iteration only requires one multiplication with the constraint
+ *  matrix and one with its transpose, which are parallelized with OpenMP.
+ *  Hence the solver scales to the local polytope relaxations of large models.
+ *  Primal and dual solutions, step size and primal weight of the previous call
+ *  of solve() are used as warm start for the lazy constraint loops of
+ *  opengm::LPInferenceBase. New constraints start with a zero multiplier.
+ *
+ *  The solver is a first order method and returns a solution which satisfies
+ *  the constraints up to the feasibility tolerance
+ *  (LPSolverInterface::Parameter::epRHS_) with a relative duality gap of at
+ *  most the optimality tolerance (LPSolverInterface::Parameter::epOpt_).
+ *  The bound returned by objectiveFunctionValueBound() is the Lagrangian bound
+ *  of the computed dual solution. If all variables are bounded (e.g. for the
+ *  local polytope relaxation) it is valid regardless of the accuracy of the
+ *  solution, otherwise the reduced costs of unbounded variables are only zero
+ *  up to the optimality tolerance.
+ *
+ *  \note Only linear programs are supported, adding integer or binary
+ *        variables throws an exception.
+ */
+
+/*! \typedef LPSolverBuiltin::BuiltinValueType
+ *  \brief Defines the value type used by the built-in solver.
+ */
+
+/*! \typedef LPSolverBuiltin::BuiltinIndexType
+ *  \brief Defines the index type used by the built-in solver.
+ */
+
+/*! \typedef LPSolverBuiltin::BuiltinSolutionIteratorType
+ *  \brief Defines the iterator type which can be used to iterate over the
+ *         solution of the built-in solver.
+ */
+
+/*! \typedef LPSolverBuiltin::BuiltinTimingType
+ *  \brief Defines the timing type used by the built-in solver.
+ */
+
+/*! \typedef LPSolverBuiltin::LPSolverBaseClass
+ *  \brief Defines the type of the base class.
+ */
+
+/*! \enum opengm::LPSolverBuiltin::BuiltinParameter
+ *  \brief Parameters which can be changed via
+ *         LPSolverInterface::setParameter.
+ */
+
+/*! \var LPSolverBuiltin::BuiltinParameter LPSolverBuiltin::TimeLimit
+ *  \brief Maximal time in seconds for a call of solve().
+ */
+
+/*! \var LPSolverBuiltin::BuiltinParameter LPSolverBuiltin::Threads
+ *  \brief Number of threads (0 = autoselect).
+ */
+
+/*! \var LPSolverBuiltin::BuiltinParameter LPSolverBuiltin::OptimalityTolerance
+ *  \brief Relative tolerance for the dual residual and the duality gap.
+ */
+
+/*! \var LPSolverBuiltin::BuiltinParameter LPSolverBuiltin::FeasibilityTolerance
+ *  \brief Relative tolerance for the primal residual.
+ */
+
+/*! \var LPSolverBuiltin::BuiltinParameter LPSolverBuiltin::MaxIterations
+ *  \brief Maximal number of iterations for a call of solve().
+ */
+
+/*! \fn LPSolverBuiltin::LPSolverBuiltin(const Parameter& parameter = Parameter())
+ *  \brief Default constructor for LPSolverBuiltin.
+ *
+ *  \param[in] parameter Settings for the built-in solver. Only the options
+ *                       numberOfThreads_, verbose_, epOpt_, epRHS_ and
+ *                       timeLimit_ are used.
+ */
+
+/*! \fn LPSolverBuiltin::~LPSolverBuiltin()
+ *  \brief Destructor for LPSolverBuiltin.
+ */
+
+/*! \fn size_t LPSolverBuiltin::numberOfIterations() const
+ *  \brief Number of iterations of the last call of solve().
+ */
+
+/*! \fn bool LPSolverBuiltin::converged() const
+ *  \brief Tell if the last call of solve() reached the requested tolerances
+ *         before the time or iteration limit.
+ */
+
+/*! \var LPSolverBuiltin::maximize_
+ *  \brief Tell if the objective function is maximized.
+ */
+
+/*! \var LPSolverBuiltin::objective_
+ *  \brief The coefficients of the objective function.
+ */
+
+/*! \var LPSolverBuiltin::lowerBounds_
+ *  \brief The lower bounds of the variables.
+ */
+
+/*! \var LPSolverBuiltin::upperBounds_
+ *  \brief The upper bounds of the variables.
+ */
+
+/*! \var LPSolverBuiltin::rowBegin_
+ *  \brief Start of each constraint in columns_ and coefficients_ (compressed
+ *         sparse row format).
+ */
+
+/*! \var LPSolverBuiltin::columns_
+ *  \brief The variables of the constraints.
+ */
+
+/*! \var LPSolverBuiltin::coefficients_
+ *  \brief The coefficients of the constraints.
+ */
+
+/*! \var LPSolverBuiltin::rowBounds_
+ *  \brief The right hand sides of the constraints.
+ */
+
+/*! \var LPSolverBuiltin::rowSenses_
+ *  \brief The senses of the constraints.
+ */
+
+/*! \var LPSolverBuiltin::rowNames_
+ *  \brief The names of the constraints (only used for model export).
+ */
+
+/*! \var LPSolverBuiltin::solution_
+ *  \brief The primal solution of the last call of solve().
+ */
+
+/*! \var LPSolverBuiltin::dual_
+ *  \brief The dual solution of the last call of solve(). The sign of the
+ *         multipliers of less equal constraints is flipped, such that all
+ *         inequality multipliers are non-negative.
+ */
+
+/*! \var LPSolverBuiltin::primalWeight_
+ *  \brief The primal weight of the last call of solve() (0 = not solved yet).
+ */
+
+/*! \var LPSolverBuiltin::stepSize_
+ *  \brief The step size of the last call of solve() (0 = not solved yet).
+ */
+
+/*! \fn static LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::infinity_impl()
+ *  \brief Get the value which is used by the built-in solver to represent
+ *         infinity.
+ *
+ *  \note Implementation for base class LPSolverInterface::infinity method.
+ */
+
+/*! \fn void LPSolverBuiltin::addContinuousVariables_impl(const BuiltinIndexType numVariables, const BuiltinValueType lowerBound, const BuiltinValueType upperBound)
+ *  \brief Add new continuous variables to the model.
+ *
+ *  \param[in] numVariables The number of new Variables.
+ *  \param[in] lowerBound The lower bound for the new Variables.
+ *  \param[in] upperBound The upper bound for the new Variables.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::addContinuousVariables method.
+ */
+
+/*! \fn void LPSolverBuiltin::addIntegerVariables_impl(const BuiltinIndexType numVariables, const BuiltinValueType lowerBound, const BuiltinValueType upperBound)
+ *  \brief Integer variables are not supported by the built-in solver.
+ *
+ *  \throws RuntimeError
+ */
+
+/*! \fn void LPSolverBuiltin::addBinaryVariables_impl(const BuiltinIndexType numVariables)
+ *  \brief Binary variables are not supported by the built-in solver.
+ *
+ *  \throws RuntimeError
+ */
+
+/*! \fn void LPSolverBuiltin::setObjective_impl(const Objective objective)
+ *  \brief Set objective to minimize or maximize.
+ *
+ *  \param[in] objective The new objective.
+ *
+ *  \note Implementation for base class LPSolverInterface::setObjective method.
+ */
+
+/*! \fn void LPSolverBuiltin::setObjectiveValue_impl(const BuiltinIndexType variable, const BuiltinValueType value)
+ *  \brief Set the coefficient of a variable in the objective function.
+ *
+ *  \param[in] variable The index of the variable.
+ *  \param[in] value The value which will be set as the coefficient of the
+ *                   variable in the objective function.
+ *
+ *  \note Implementation for base class LPSolverInterface::setObjectiveValue
+ *        method.
+ */
+
+/*! \fn void LPSolverBuiltin::setObjectiveValue_impl(ITERATOR_TYPE begin, const ITERATOR_TYPE end)
+ *  \brief Set values of the objective function for all variables in the
+ *         model.
+ *
+ *  \tparam ITERATOR_TYPE Iterator type used to iterate over the values which
+ *                        will be set as the coefficients of the objective
+ *                        function.
+ *
+ *  \param[in] begin Iterator pointing to the begin of the sequence of values
+ *                   which will be set as the coefficients of the objective
+ *                   function.
+ *  \param[in] end Iterator pointing to the end of the sequence of values which
+ *                 will be set as the coefficients of the objective function.
+ *
+ *  \note Implementation for base class LPSolverInterface::setObjectiveValue
+ *        method.
+ */
+
+/*! \fn void LPSolverBuiltin::setObjectiveValue_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin)
+ *  \brief Set values as the coefficients of selected variables in the
+ *         objective function.
+ *
+ *  \tparam VARIABLES_ITERATOR_TYPE Iterator type used to iterate over the
+ *                                  indices of the variables.
+ *  \tparam COEFFICIENTS_ITERATOR_TYPE Iterator type used to iterate over the
+ *                                     coefficients of the variables which will
+ *                                     be set in the objective function.
+ *
+ *  \param[in] variableIDsBegin Iterator pointing to the begin of the sequence
+ *                              of indices of the variables.
+ *  \param[in] variableIDsEnd Iterator pointing to the end of the sequence of
+ *                            indices of the variables.
+ *  \param[in] coefficientsBegin Iterator pointing to the begin of the sequence
+ *                               of values which will be set as the
+ *                               coefficients of the objective function.
+ *
+ *  \note Implementation for base class LPSolverInterface::setObjectiveValue
+ *        method.
+ */
+
+/*! \fn void LPSolverBuiltin::addEqualityConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "")
+ *  \brief Add a new equality constraint to the model.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::addEqualityConstraint method.
+ */
+
+/*! \fn void LPSolverBuiltin::addLessEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "")
+ *  \brief Add a new less equal constraint to the model.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::addLessEqualConstraint method.
+ */
+
+/*! \fn void LPSolverBuiltin::addGreaterEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName = "")
+ *  \brief Add a new greater equal constraint to the model.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::addGreaterEqualConstraint method.
+ */
+
+/*! \fn void LPSolverBuiltin::addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin)
+ *  \brief Append a block of constraints in compressed sparse row format to the
+ *         constraint matrix. Constraints with two finite and different bounds
+ *         are stored as two rows.
+ *
+ *  \note Implementation for base class LPSolverInterface::addConstraints
+ *        method.
+ */
+
+/*! \fn void LPSolverBuiltin::addConstraintsFinished_impl()
+ *  \brief Join all constraints added via
+ *         LPSolverBuiltin::addEqualityConstraint,
+ *         LPSolverBuiltin::addLessEqualConstraint and
+ *         LPSolverBuiltin::addGreaterEqualConstraint to the model.
+ *
+ *  \note
+ *        -# Implementation for base class
+ *           LPSolverInterface::addConstraintsFinished method.
+ *        -# Constraints are stored immediately, hence there is nothing to do.
+ */
+
+/*! \fn void LPSolverBuiltin::setParameter_impl(const PARAMETER_TYPE parameter, const PARAMETER_VALUE_TYPE value)
+ *  \brief Set solver parameter.
+ *
+ *  \tparam PARAMETER_TYPE The type of the parameter, has to be convertible to
+ *                         LPSolverBuiltin::BuiltinParameter.
+ *  \tparam PARAMETER_VALUE_TYPE The type of the value.
+ *
+ *  \param[in] parameter The solver parameter.
+ *  \param[in] value The new value to which the parameter will be set.
+ *
+ *  \note Implementation for base class LPSolverInterface::setParameter method.
+ */
+
+/*! \fn bool LPSolverBuiltin::solve_impl()
+ *  \brief Solve the current model.
+ *
+ *  \return False if the solver failed to compute a solution (e.g. because
+ *          the problem is unbounded), true otherwise. If the time or
+ *          iteration limit is reached the best solution found so far is
+ *          returned, see LPSolverBuiltin::converged.
+ *
+ *  \note Implementation for base class LPSolverInterface::solve method.
+ */
+
+/*! \fn bool LPSolverBuiltin::solve_impl(BuiltinTimingType& timing)
+ *  \brief Solve the current model and measure solving time.
+ *
+ *  \param[out] timing The time the solver needed to solve the problem.
+ *
+ *  \return See LPSolverBuiltin::solve_impl().
+ *
+ *  \note Implementation for base class LPSolverInterface::solve method.
+ */
+
+/*! \fn LPSolverBuiltin::BuiltinSolutionIteratorType LPSolverBuiltin::solutionBegin_impl() const
+ *  \brief Get an iterator which is pointing to the begin of the solution
+ *         computed by the built-in solver.
+ *
+ *  \note Implementation for base class LPSolverInterface::solutionBegin
+ *        method.
+ */
+
+/*! \fn LPSolverBuiltin::BuiltinSolutionIteratorType LPSolverBuiltin::solutionEnd_impl() const
+ *  \brief Get an iterator which is pointing to the end of the solution
+ *         computed by the built-in solver.
+ *
+ *  \note Implementation for base class LPSolverInterface::solutionEnd method.
+ */
+
+/*! \fn LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::solution_impl(const BuiltinIndexType variable) const;
+ *  \brief Get the solution value of a variable computed by the built-in
+ *         solver.
+ *
+ *  \note Implementation for base class LPSolverInterface::solution method.
+ */
+
+/*! \fn LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::objectiveFunctionValue_impl() const;
+ *  \brief Get the objective function value of the computed solution.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::objectiveFunctionValue method.
+ */
+
+/*! \fn LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::objectiveFunctionValueBound_impl() const;
+ *  \brief Get the Lagrangian bound of the computed dual solution.
+ *
+ *  \note Implementation for base class
+ *        LPSolverInterface::objectiveFunctionValueBound method.
+ */
+
+/*! \fn void LPSolverBuiltin::exportModel_impl(const std::string& filename) const
+ *  \brief Export model to file in the CPLEX LP file format.
+ *
+ *  \param[in] filename The name of the file where the model will be stored.
+ *
+ *  \note Implementation for base class LPSolverInterface::exportModel method.
+ */
+
+/*! \fn bool LPSolverBuiltin::solveWithoutConstraints()
+ *  \brief Solve a model without constraints by setting each variable to one
+ *         of its bounds.
+ */
+
+/*! \fn void LPSolverBuiltin::scaleProblem(ScaledProblem& problem) const
+ *  \brief Transform the model into the preconditioned minimization problem
+ *         with equality and greater equal constraints which is solved by
+ *         PDHG.
+ */
+
+/*! \fn void LPSolverBuiltin::evaluate(const ScaledProblem& problem, const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& ax, const std::vector<double>& aty, Residuals& residuals)
+ *  \brief Compute the primal and dual residuals and objective values of a
+ *         primal-dual pair of the scaled problem.
+ */
+
+/******************
+ * implementation *
+ ******************/
+namespace opengm {
+
+struct LPSolverBuiltin::ScaledProblem {
+   size_t numberOfRows_;
+   size_t numberOfColumns_;
+   // number of threads of the parallel loops
+   int numberOfThreads_;
+   // constraint matrix in compressed sparse row and column format
+   std::vector<size_t> rowBegin_;
+   std::vector<size_t> rowColumns_;
+   std::vector<double> rowValues_;
+   std::vector<size_t> columnBegin_;
+   std::vector<size_t> columnRows_;
+   std::vector<double> columnValues_;
+   std::vector<double> objective_;
+   std::vector<double> rhs_;
+   std::vector<double> lowerBounds_;
+   std::vector<double> upperBounds_;
+   std::vector<unsigned char> equality_;
+   // x = columnScaling_ * scaled x, y = rowScaling_ * scaled y
+   std::vector<double> rowScaling_;
+   std::vector<double> columnScaling_;
+   double objectiveNorm_;
+   double rhsNorm_;
+};
+
+struct LPSolverBuiltin::Residuals {
+   // residuals of the original problem (maximum norm)
+   double primalResidual_;
+   double dualResidual_;
+   // residuals of the scaled problem (euclidean norm)
+   double scaledPrimalResidual_;
+   double scaledDualResidual_;
+   double primalObjective_;
+   double dualObjective_;
+
+   double gap() const {
+      return std::abs(primalObjective_ - dualObjective_);
+   }
+   double kkt(const double primalWeight) const {
+      return std::sqrt(primalWeight * primalWeight * scaledPrimalResidual_ * scaledPrimalResidual_
+         + scaledDualResidual_ * scaledDualResidual_ / (primalWeight * primalWeight)
+         + gap() * gap());
+   }
+   bool converged(const ScaledProblem& problem, const double optimalityTolerance, const double feasibilityTolerance) const {
+      return primalResidual_ <= feasibilityTolerance * (1.0 + problem.rhsNorm_)
+         && dualResidual_ <= optimalityTolerance * (1.0 + problem.objectiveNorm_)
+         && gap() <= optimalityTolerance * (1.0 + std::abs(primalObjective_) + std::abs(dualObjective_));
+   }
+};
+
+inline LPSolverBuiltin::LPSolverBuiltin(const Parameter& parameter)
+   : LPSolverBaseClass(parameter), maximize_(false), objective_(),
+     lowerBounds_(), upperBounds_(), rowBegin_(1, 0), columns_(),
+     coefficients_(), rowBounds_(), rowSenses_(), rowNames_(),
+     timeLimit_(parameter.timeLimit_),
+     numberOfThreads_(parameter.numberOfThreads_),
+     optimalityTolerance_(parameter.epOpt_),
+     feasibilityTolerance_(parameter.epRHS_),
+     maxNumberOfIterations_(1000000), solution_(), dual_(),
+     primalWeight_(0.0), stepSize_(0.0),
+     objectiveValue_(0.0), objectiveBound_(-infinity_impl()),
+     numberOfIterations_(0), converged_(false) {
+
+}
+
+inline LPSolverBuiltin::~LPSolverBuiltin() {
+
+}
+
+inline size_t LPSolverBuiltin::numberOfIterations() const {
+   return numberOfIterations_;
+}
+
+inline bool LPSolverBuiltin::converged() const {
+   return converged_;
+}
+
+inline LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::infinity_impl() {
+   return std::numeric_limits<BuiltinValueType>::infinity();
+}
+
+inline void LPSolverBuiltin::addContinuousVariables_impl(const BuiltinIndexType numVariables, const BuiltinValueType lowerBound, const BuiltinValueType upperBound) {
+   OPENGM_CHECK_OP(lowerBound, <=, upperBound, "lower bound has to be smaller than upper bound");
+   objective_.resize(objective_.size() + numVariables, 0.0);
+   lowerBounds_.resize(lowerBounds_.size() + numVariables, lowerBound);
+   upperBounds_.resize(upperBounds_.size() + numVariables, upperBound);
+   // warm start value of the new variables
+   const BuiltinValueType start = std::min(std::max(0.0, lowerBound), upperBound);
+   solution_.resize(solution_.size() + numVariables, start);
+}
+
+inline void LPSolverBuiltin::addIntegerVariables_impl(const BuiltinIndexType /*numVariables*/, const BuiltinValueType /*lowerBound*/, const BuiltinValueType /*upperBound*/) {
+   throw RuntimeError("LPSolverBuiltin does not support integer variables.");
+}
+
+inline void LPSolverBuiltin::addBinaryVariables_impl(const BuiltinIndexType /*numVariables*/) {
+   throw RuntimeError("LPSolverBuiltin does not support binary variables.");
+}
+
+inline void LPSolverBuiltin::setObjective_impl(const Objective objective) {
+   maximize_ = (objective == Maximize);
+}
+
+inline void LPSolverBuiltin::setObjectiveValue_impl(const BuiltinIndexType variable, const BuiltinValueType value) {
+   objective_[variable] = value;
+}
+
+template<class ITERATOR_TYPE>
+inline void LPSolverBuiltin::setObjectiveValue_impl(ITERATOR_TYPE begin, const ITERATOR_TYPE end) {
+   for(size_t i = 0; begin != end; ++begin, ++i) {
+      objective_[i] = *begin;
+   }
+}
+
+template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::setObjectiveValue_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin) {
+   for(; variableIDsBegin != variableIDsEnd; ++variableIDsBegin, ++coefficientsBegin) {
+      objective_[*variableIDsBegin] = *coefficientsBegin;
+   }
+}
+
+template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::addEqualityConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName) {
+   addConstraint(variableIDsBegin, variableIDsEnd, coefficientsBegin, EqualSense, bound, constraintName);
+}
+
+template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::addLessEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName) {
+   addConstraint(variableIDsBegin, variableIDsEnd, coefficientsBegin, LessEqualSense, bound, constraintName);
+}
+
+template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::addGreaterEqualConstraint_impl(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const BuiltinValueType bound, const std::string& constraintName) {
+   addConstraint(variableIDsBegin, variableIDsEnd, coefficientsBegin, GreaterEqualSense, bound, constraintName);
+}
+
+template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin) {
+   if(rowBeginsBegin == rowBeginsEnd) {
+      return;
+   }
+   const size_t numRows = std::distance(rowBeginsBegin, rowBeginsEnd) - 1;
+   const size_t first = static_cast<size_t>(*rowBeginsBegin);
+   const size_t last = static_cast<size_t>(*(rowBeginsBegin + numRows));
+   columns_.reserve(columns_.size() + last - first);
+   coefficients_.reserve(coefficients_.size() + last - first);
+   rowBegin_.reserve(rowBegin_.size() + numRows);
+   rowBounds_.reserve(rowBounds_.size() + numRows);
+   rowSenses_.reserve(rowSenses_.size() + numRows);
+   rowNames_.reserve(rowNames_.size() + numRows);
+   for(ROW_BEGIN_ITERATOR_TYPE next = rowBeginsBegin + 1; next != rowBeginsEnd; ++rowBeginsBegin, ++next, ++lowerBoundsBegin, ++upperBoundsBegin) {
+      const BuiltinValueType lowerBound = static_cast<BuiltinValueType>(*lowerBoundsBegin);
+      const BuiltinValueType upperBound = static_cast<BuiltinValueType>(*upperBoundsBegin);
+      ConstraintSense senses[2];
+      BuiltinValueType bounds[2];
+      size_t numSenses = 0;
+      if(lowerBound == upperBound) {
+         senses[numSenses] = EqualSense;
+         bounds[numSenses++] = lowerBound;
+      } else {
+         if(lowerBound != -infinity_impl()) {
+            senses[numSenses] = GreaterEqualSense;
+            bounds[numSenses++] = lowerBound;
+         }
+         if(upperBound != infinity_impl()) {
+            senses[numSenses] = LessEqualSense;
+            bounds[numSenses++] = upperBound;
+         }
+      }
+      for(size_t i = 0; i < numSenses; ++i) {
+         for(size_t k = *rowBeginsBegin; k < static_cast<size_t>(*next); ++k) {
+            OPENGM_ASSERT(static_cast<size_t>(variableIDsBegin[k]) < objective_.size());
+            columns_.push_back(static_cast<BuiltinIndexType>(variableIDsBegin[k]));
+            coefficients_.push_back(static_cast<BuiltinValueType>(coefficientsBegin[k]));
+         }
+         rowBegin_.push_back(columns_.size());
+         rowBounds_.push_back(bounds[i]);
+         rowSenses_.push_back(static_cast<unsigned char>(senses[i]));
+         rowNames_.push_back(std::string());
+      }
+   }
+}
+
+inline void LPSolverBuiltin::addConstraintsFinished_impl() {
+
+}
+
+inline void LPSolverBuiltin::addConstraintsFinished_impl(BuiltinTimingType& timing) {
+   timing = 0.0;
+}
+
+template <class PARAMETER_TYPE, class PARAMETER_VALUE_TYPE>
+inline void LPSolverBuiltin::setParameter_impl(const PARAMETER_TYPE parameter, const PARAMETER_VALUE_TYPE value) {
+   switch(static_cast<BuiltinParameter>(parameter)) {
+      case TimeLimit: {
+         timeLimit_ = static_cast<double>(value);
+         break;
+      }
+      case Threads: {
+         numberOfThreads_ = static_cast<int>(value);
+         break;
+      }
+      case OptimalityTolerance: {
+         optimalityTolerance_ = static_cast<double>(value);
+         break;
+      }
+      case FeasibilityTolerance: {
+         feasibilityTolerance_ = static_cast<double>(value);
+         break;
+      }
+      case MaxIterations: {
+         maxNumberOfIterations_ = static_cast<size_t>(value);
+         break;
+      }
+      default: {
+         throw RuntimeError("Unknown parameter for LPSolverBuiltin.");
+      }
+   }
+}
+
+inline bool LPSolverBuiltin::solve_impl() {
+   BuiltinTimingType timing;
+   return solve_impl(timing);
+}
+
+inline bool LPSolverBuiltin::solve_impl(BuiltinTimingType& timing) {
+   Timer timer;
+   timer.tic();
+   numberOfIterations_ = 0;
+   converged_ = false;
+   if(rowSenses_.empty()) {
+      const bool success = solveWithoutConstraints();
+      timer.toc();
+      timing = timer.elapsedTime();
+      return success;
+   }
+
+   ScaledProblem problem;
+   scaleProblem(problem);
+   const size_t m = problem.numberOfRows_;
+   const size_t n = problem.numberOfColumns_;
+
+   // warm start
+   dual_.resize(m, 0.0);
+   std::vector<double> x(n);
+   std::vector<double> y(m);
+   for(size_t j = 0; j < n; ++j) {
+      x[j] = std::min(std::max(solution_[j] / problem.columnScaling_[j], problem.lowerBounds_[j]), problem.upperBounds_[j]);
+   }
+   for(size_t i = 0; i < m; ++i) {
+      y[i] = dual_[i] / problem.rowScaling_[i];
+      if(!problem.equality_[i]) {
+         y[i] = std::max(0.0, y[i]);
+      }
+   }
+   std::vector<double> ax(m);
+   std::vector<double> aty(n);
+   multiply(problem, x, ax);
+   multiplyTransposed(problem, y, aty);
+
+   // step size and primal weight
+   double maxAbsCoefficient = 0.0;
+   for(size_t k = 0; k < problem.rowValues_.size(); ++k) {
+      maxAbsCoefficient = std::max(maxAbsCoefficient, std::abs(problem.rowValues_[k]));
+   }
+   double stepSize = stepSize_ > 0.0 ? stepSize_ : (maxAbsCoefficient > 0.0 ? 1.0 / maxAbsCoefficient : 1.0);
+   double objectiveNorm = 0.0;
+   double rhsNorm = 0.0;
+   for(size_t j = 0; j < n; ++j) {
+      objectiveNorm += problem.objective_[j] * problem.objective_[j];
+   }
+   for(size_t i = 0; i < m; ++i) {
+      rhsNorm += problem.rhs_[i] * problem.rhs_[i];
+   }
+   double primalWeight = primalWeight_ > 0.0 ? primalWeight_ : ((objectiveNorm > 1e-20 && rhsNorm > 1e-20) ? std::sqrt(objectiveNorm / rhsNorm) : 1.0);
+
+   // iterates, weighted averages and last restart point
+   std::vector<double> xNew(n), yNew(m), axNew(m), atyNew(n);
+   std::vector<double> xSum(n, 0.0), ySum(m, 0.0), axSum(m, 0.0), atySum(n, 0.0);
+   std::vector<double> xAverage(n), yAverage(m), axAverage(m), atyAverage(n);
+   std::vector<double> xRestart(x), yRestart(y);
+   double stepSizeSum = 0.0;
+
+   Residuals current;
+   Residuals average;
+   evaluate(problem, x, y, ax, aty, current);
+   double restartKkt = current.kkt(primalWeight);
+   double previousCandidateKkt = std::numeric_limits<double>::infinity();
+   bool averageIsBest = false;
+   size_t totalIterations = 0;
+   size_t iterationsSinceRestart = 0;
+   const size_t evaluationFrequency = 64;
+
+   while(!current.converged(problem, optimalityTolerance_, feasibilityTolerance_)) {
+      // adaptive step
+      double usedStepSize = 0.0;
+      for(;;) {
+         const double tau = stepSize / primalWeight;
+         const double sigma = stepSize * primalWeight;
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_)
+         #endif
+         for(std::ptrdiff_t j = 0; j < static_cast<std::ptrdiff_t>(n); ++j) {
+            xNew[j] = std::min(std::max(x[j] - tau * (problem.objective_[j] - aty[j]), problem.lowerBounds_[j]), problem.upperBounds_[j]);
+         }
+         multiply(problem, xNew, axNew);
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_)
+         #endif
+         for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(m); ++i) {
+            yNew[i] = y[i] + sigma * (problem.rhs_[i] - 2.0 * axNew[i] + ax[i]);
+            if(!problem.equality_[i]) {
+               yNew[i] = std::max(0.0, yNew[i]);
+            }
+         }
+         multiplyTransposed(problem, yNew, atyNew);
+
+         double primalMovement = 0.0;
+         double dualMovement = 0.0;
+         double interaction = 0.0;
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_) reduction(+:primalMovement, interaction)
+         #endif
+         for(std::ptrdiff_t j = 0; j < static_cast<std::ptrdiff_t>(n); ++j) {
+            const double dx = xNew[j] - x[j];
+            primalMovement += dx * dx;
+            interaction += dx * (atyNew[j] - aty[j]);
+         }
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_) reduction(+:dualMovement)
+         #endif
+         for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(m); ++i) {
+            const double dy = yNew[i] - y[i];
+            dualMovement += dy * dy;
+         }
+         ++totalIterations;
+         const double movement = 0.5 * primalWeight * primalMovement + 0.5 * dualMovement / primalWeight;
+         const double stepSizeLimit = std::abs(interaction) > 0.0 ? movement / std::abs(interaction) : std::numeric_limits<double>::infinity();
+         const double k = static_cast<double>(totalIterations + 1);
+         const double nextStepSize = std::min((1.0 - std::pow(k, -0.3)) * stepSizeLimit, (1.0 + std::pow(k, -0.6)) * stepSize);
+         if(stepSize <= stepSizeLimit) {
+            usedStepSize = stepSize;
+            stepSize = nextStepSize;
+            break;
+         }
+         stepSize = nextStepSize;
+      }
+      x.swap(xNew);
+      y.swap(yNew);
+      ax.swap(axNew);
+      aty.swap(atyNew);
+      for(size_t j = 0; j < n; ++j) {
+         xSum[j] += usedStepSize * x[j];
+         atySum[j] += usedStepSize * aty[j];
+      }
+      for(size_t i = 0; i < m; ++i) {
+         ySum[i] += usedStepSize * y[i];
+         axSum[i] += usedStepSize * ax[i];
+      }
+      stepSizeSum += usedStepSize;
+      ++iterationsSinceRestart;
+
+      if(iterationsSinceRestart % evaluationFrequency != 0) {
+         continue;
+      }
+
+      // check termination for the current iterate and the average
+      for(size_t j = 0; j < n; ++j) {
+         xAverage[j] = xSum[j] / stepSizeSum;
+         atyAverage[j] = atySum[j] / stepSizeSum;
+      }
+      for(size_t i = 0; i < m; ++i) {
+         yAverage[i] = ySum[i] / stepSizeSum;
+         axAverage[i] = axSum[i] / stepSizeSum;
+      }
+      evaluate(problem, x, y, ax, aty, current);
+      evaluate(problem, xAverage, yAverage, axAverage, atyAverage, average);
+      if(parameter_.verbose_) {
+         std::cout << "LPSolverBuiltin iteration " << totalIterations << ": primal " << current.primalObjective_
+            << ", dual " << current.dualObjective_ << ", primal residual " << current.primalResidual_
+            << ", dual residual " << current.dualResidual_ << std::endl;
+      }
+      if(average.converged(problem, optimalityTolerance_, feasibilityTolerance_)) {
+         averageIsBest = true;
+         break;
+      }
+      if(current.converged(problem, optimalityTolerance_, feasibilityTolerance_)) {
+         break;
+      }
+      if(current.primalObjective_ != current.primalObjective_ || current.dualObjective_ != current.dualObjective_) {
+         // numerical failure
+         return false;
+      }
+      timer.toc();
+      if(timer.elapsedTime() >= timeLimit_ || totalIterations >= maxNumberOfIterations_) {
+         averageIsBest = average.kkt(primalWeight) < current.kkt(primalWeight);
+         break;
+      }
+
+      // adaptive restart to the better of the current iterate and the average
+      const bool restartToAverage = average.kkt(primalWeight) < current.kkt(primalWeight);
+      const double candidateKkt = restartToAverage ? average.kkt(primalWeight) : current.kkt(primalWeight);
+      const bool restart = candidateKkt <= 0.2 * restartKkt
+         || (candidateKkt <= 0.8 * restartKkt && candidateKkt > previousCandidateKkt)
+         || iterationsSinceRestart >= 0.36 * totalIterations;
+      if(!restart) {
+         previousCandidateKkt = candidateKkt;
+         continue;
+      }
+      if(restartToAverage) {
+         x.swap(xAverage);
+         y.swap(yAverage);
+         ax.swap(axAverage);
+         aty.swap(atyAverage);
+         current = average;
+      }
+      // update the primal weight from the movement since the last restart
+      double primalDistance = 0.0;
+      double dualDistance = 0.0;
+      for(size_t j = 0; j < n; ++j) {
+         primalDistance += (x[j] - xRestart[j]) * (x[j] - xRestart[j]);
+      }
+      for(size_t i = 0; i < m; ++i) {
+         dualDistance += (y[i] - yRestart[i]) * (y[i] - yRestart[i]);
+      }
+      if(primalDistance > 1e-20 && dualDistance > 1e-20) {
+         primalWeight = std::exp(0.5 * std::log(std::sqrt(dualDistance / primalDistance)) + 0.5 * std::log(primalWeight));
+      }
+      xRestart = x;
+      yRestart = y;
+      std::fill(xSum.begin(), xSum.end(), 0.0);
+      std::fill(ySum.begin(), ySum.end(), 0.0);
+      std::fill(axSum.begin(), axSum.end(), 0.0);
+      std::fill(atySum.begin(), atySum.end(), 0.0);
+      stepSizeSum = 0.0;
+      iterationsSinceRestart = 0;
+      restartKkt = current.kkt(primalWeight);
+      previousCandidateKkt = std::numeric_limits<double>::infinity();
+   }
+
+   if(averageIsBest) {
+      x.swap(xAverage);
+      y.swap(yAverage);
+      current = average;
+   }
+   numberOfIterations_ = totalIterations;
+   primalWeight_ = primalWeight;
+   stepSize_ = stepSize;
+   converged_ = current.converged(problem, optimalityTolerance_, feasibilityTolerance_);
+
+   // transform solution back to the original problem
+   objectiveValue_ = 0.0;
+   for(size_t j = 0; j < n; ++j) {
+      solution_[j] = std::min(std::max(problem.columnScaling_[j] * x[j], lowerBounds_[j]), upperBounds_[j]);
+      objectiveValue_ += objective_[j] * solution_[j];
+   }
+   for(size_t i = 0; i < m; ++i) {
+      dual_[i] = problem.rowScaling_[i] * y[i];
+   }
+   objectiveBound_ = current.dualObjective_;
+   if(maximize_) {
+      objectiveBound_ = -objectiveBound_;
+   }
+
+   timer.toc();
+   timing = timer.elapsedTime();
+   return true;
+}
+
+inline LPSolverBuiltin::BuiltinSolutionIteratorType LPSolverBuiltin::solutionBegin_impl() const {
+   return solution_.begin();
+}
+
+inline LPSolverBuiltin::BuiltinSolutionIteratorType LPSolverBuiltin::solutionEnd_impl() const {
+   return solution_.end();
+}
+
+inline LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::solution_impl(const BuiltinIndexType variable) const {
+   return solution_[variable];
+}
+
+inline LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::objectiveFunctionValue_impl() const {
+   return objectiveValue_;
+}
+
+inline LPSolverBuiltin::BuiltinValueType LPSolverBuiltin::objectiveFunctionValueBound_impl() const {
+   return objectiveBound_;
+}
+
+inline void LPSolverBuiltin::exportModel_impl(const std::string& filename) const {
+   std::ofstream file(filename.c_str());
+   if(!file) {
+      throw RuntimeError("Unable to open file " + filename + " for model export.");
+   }
+   file.precision(17);
+   file << (maximize_ ? "Maximize" : "Minimize") << std::endl << " obj:";
+   for(size_t j = 0; j < objective_.size(); ++j) {
+      if(objective_[j] != 0.0) {
+         file << (objective_[j] < 0.0 ? " - " : " + ") << std::abs(objective_[j]) << " x" << j;
+      }
+   }
+   file << std::endl << "Subject To" << std::endl;
+   for(size_t i = 0; i < rowSenses_.size(); ++i) {
+      file << " ";
+      if(!rowNames_[i].empty()) {
+         file << rowNames_[i];
+      } else {
+         file << "c" << i;
+      }
+      file << ":";
+      for(size_t k = rowBegin_[i]; k < rowBegin_[i + 1]; ++k) {
+         file << (coefficients_[k] < 0.0 ? " - " : " + ") << std::abs(coefficients_[k]) << " x" << columns_[k];
+      }
+      if(rowBegin_[i] == rowBegin_[i + 1]) {
+         file << " 0 x0";
+      }
+      file << (rowSenses_[i] == EqualSense ? " = " : (rowSenses_[i] == LessEqualSense ? " <= " : " >= ")) << rowBounds_[i] << std::endl;
+   }
+   file << "Bounds" << std::endl;
+   for(size_t j = 0; j < objective_.size(); ++j) {
+      if(lowerBounds_[j] == -infinity_impl() && upperBounds_[j] == infinity_impl()) {
+         file << " x" << j << " free" << std::endl;
+      } else {
+         file << " ";
+         if(lowerBounds_[j] == -infinity_impl()) {
+            file << "-inf";
+         } else {
+            file << lowerBounds_[j];
+         }
+         file << " <= x" << j << " <= ";
+         if(upperBounds_[j] == infinity_impl()) {
+            file << "+inf";
+         } else {
+            file << upperBounds_[j];
+         }
+         file << std::endl;
+      }
+   }
+   file << "End" << std::endl;
+}
+
+template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
+inline void LPSolverBuiltin::addConstraint(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const ConstraintSense sense, const BuiltinValueType bound, const std::string& constraintName) {
+   for(; variableIDsBegin != variableIDsEnd; ++variableIDsBegin, ++coefficientsBegin) {
+      OPENGM_ASSERT(static_cast<size_t>(*variableIDsBegin) < objective_.size());
+      columns_.push_back(static_cast<BuiltinIndexType>(*variableIDsBegin));
+      coefficients_.push_back(static_cast<BuiltinValueType>(*coefficientsBegin));
+   }
+   rowBegin_.push_back(columns_.size());
+   rowBounds_.push_back(bound);
+   rowSenses_.push_back(static_cast<unsigned char>(sense));
+   rowNames_.push_back(constraintName);
+}
+
+inline bool LPSolverBuiltin::solveWithoutConstraints() {
+   objectiveValue_ = 0.0;
+   for(size_t j = 0; j < objective_.size(); ++j) {
+      const BuiltinValueType c = maximize_ ? -objective_[j] : objective_[j];
+      if(c > 0.0) {
+         solution_[j] = lowerBounds_[j];
+      } else if(c < 0.0) {
+         solution_[j] = upperBounds_[j];
+      } else {
+         solution_[j] = std::min(std::max(0.0, lowerBounds_[j]), upperBounds_[j]);
+      }
+      if(solution_[j] == infinity_impl() || solution_[j] == -infinity_impl()) {
+         // unbounded
+         return false;
+      }
+      objectiveValue_ += objective_[j] * solution_[j];
+   }
+   objectiveBound_ = objectiveValue_;
+   converged_ = true;
+   return true;
+}
+
+inline void LPSolverBuiltin::scaleProblem(ScaledProblem& problem) const {
+   const size_t m = rowSenses_.size();
+   const size_t n = objective_.size();
+   problem.numberOfRows_ = m;
+   problem.numberOfColumns_ = n;
+   #ifdef WITH_OPENMP
+   problem.numberOfThreads_ = numberOfThreads_ > 0 ? numberOfThreads_ : omp_get_max_threads();
+   #else
+   problem.numberOfThreads_ = 1;
+   #endif
+
+   // minimization with equality and greater equal constraints
+   problem.rowBegin_.assign(rowBegin_.begin(), rowBegin_.end());
+   problem.rowColumns_.assign(columns_.begin(), columns_.end());
+   problem.rowValues_.assign(coefficients_.begin(), coefficients_.end());
+   problem.rhs_.assign(rowBounds_.begin(), rowBounds_.end());
+   problem.equality_.resize(m);
+   for(size_t i = 0; i < m; ++i) {
+      problem.equality_[i] = (rowSenses_[i] == EqualSense);
+      if(rowSenses_[i] == LessEqualSense) {
+         problem.rhs_[i] = -problem.rhs_[i];
+         for(size_t k = rowBegin_[i]; k < rowBegin_[i + 1]; ++k) {
+            problem.rowValues_[k] = -problem.rowValues_[k];
+         }
+      }
+   }
+   problem.objective_.resize(n);
+   for(size_t j = 0; j < n; ++j) {
+      problem.objective_[j] = maximize_ ? -objective_[j] : objective_[j];
+   }
+   problem.lowerBounds_.assign(lowerBounds_.begin(), lowerBounds_.end());
+   problem.upperBounds_.assign(upperBounds_.begin(), upperBounds_.end());
+
+   // Ruiz equilibration followed by Pock-Chambolle scaling (alpha = 1)
+   problem.rowScaling_.assign(m, 1.0);
+   problem.columnScaling_.assign(n, 1.0);
+   std::vector<double> rowNorms(m);
+   std::vector<double> columnNorms(n);
+   for(size_t iteration = 0; iteration < 11; ++iteration) {
+      const bool ruiz = iteration < 10;
+      std::fill(rowNorms.begin(), rowNorms.end(), 0.0);
+      std::fill(columnNorms.begin(), columnNorms.end(), 0.0);
+      for(size_t i = 0; i < m; ++i) {
+         for(size_t k = problem.rowBegin_[i]; k < problem.rowBegin_[i + 1]; ++k) {
+            const double value = std::abs(problem.rowValues_[k]);
+            const size_t j = problem.rowColumns_[k];
+            if(ruiz) {
+               rowNorms[i] = std::max(rowNorms[i], value);
+               columnNorms[j] = std::max(columnNorms[j], value);
+            } else {
+               rowNorms[i] += value;
+               columnNorms[j] += value;
+            }
+         }
+      }
+      for(size_t i = 0; i < m; ++i) {
+         rowNorms[i] = rowNorms[i] > 0.0 ? 1.0 / std::sqrt(rowNorms[i]) : 1.0;
+         problem.rowScaling_[i] *= rowNorms[i];
+      }
+      for(size_t j = 0; j < n; ++j) {
+         columnNorms[j] = columnNorms[j] > 0.0 ? 1.0 / std::sqrt(columnNorms[j]) : 1.0;
+         problem.columnScaling_[j] *= columnNorms[j];
+      }
+      for(size_t i = 0; i < m; ++i) {
+         for(size_t k = problem.rowBegin_[i]; k < problem.rowBegin_[i + 1]; ++k) {
+            problem.rowValues_[k] *= rowNorms[i] * columnNorms[problem.rowColumns_[k]];
+         }
+      }
+   }
+   problem.objectiveNorm_ = 0.0;
+   problem.rhsNorm_ = 0.0;
+   for(size_t i = 0; i < m; ++i) {
+      problem.rhsNorm_ = std::max(problem.rhsNorm_, std::abs(problem.rhs_[i]));
+      problem.rhs_[i] *= problem.rowScaling_[i];
+   }
+   for(size_t j = 0; j < n; ++j) {
+      problem.objectiveNorm_ = std::max(problem.objectiveNorm_, std::abs(problem.objective_[j]));
+      problem.objective_[j] *= problem.columnScaling_[j];
+      problem.lowerBounds_[j] /= problem.columnScaling_[j];
+      problem.upperBounds_[j] /= problem.columnScaling_[j];
+   }
+
+   // transposed matrix
+   problem.columnBegin_.assign(n + 1, 0);
+   for(size_t k = 0; k < problem.rowColumns_.size(); ++k) {
+      ++problem.columnBegin_[problem.rowColumns_[k] + 1];
+   }
+   for(size_t j = 0; j < n; ++j) {
+      problem.columnBegin_[j + 1] += problem.columnBegin_[j];
+   }
+   problem.columnRows_.resize(problem.rowColumns_.size());
+   problem.columnValues_.resize(problem.rowColumns_.size());
+   std::vector<size_t> position(problem.columnBegin_.begin(), problem.columnBegin_.end() - 1);
+   for(size_t i = 0; i < m; ++i) {
+      for(size_t k = problem.rowBegin_[i]; k < problem.rowBegin_[i + 1]; ++k) {
+         const size_t p = position[problem.rowColumns_[k]]++;
+         problem.columnRows_[p] = i;
+         problem.columnValues_[p] = problem.rowValues_[k];
+      }
+   }
+}
+
+inline void LPSolverBuiltin::multiply(const ScaledProblem& problem, const std::vector<double>& x, std::vector<double>& result) {
+   #ifdef WITH_OPENMP
+   #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_)
+   #endif
+   for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(problem.numberOfRows_); ++i) {
+      double sum = 0.0;
+      for(size_t k = problem.rowBegin_[i]; k < problem.rowBegin_[i + 1]; ++k) {
+         sum += problem.rowValues_[k] * x[problem.rowColumns_[k]];
+      }
+      result[i] = sum;
+   }
+}
+
+inline void LPSolverBuiltin::multiplyTransposed(const ScaledProblem& problem, const std::vector<double>& y, std::vector<double>& result) {
+   #ifdef WITH_OPENMP
+   #pragma omp parallel for schedule(static) num_threads(problem.numberOfThreads_)
+   #endif
+   for(std::ptrdiff_t j = 0; j < static_cast<std::ptrdiff_t>(problem.numberOfColumns_); ++j) {
+      double sum = 0.0;
+      for(size_t k = problem.columnBegin_[j]; k < problem.columnBegin_[j + 1]; ++k) {
+         sum += problem.columnValues_[k] * y[problem.columnRows_[k]];
+      }
+      result[j] = sum;
+   }
+}
+
+inline void LPSolverBuiltin::evaluate(const ScaledProblem& problem, const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& ax, const std::vector<double>& aty, Residuals& residuals) {
+   const double inf = infinity_impl();
+   double primalResidual = 0.0;
+   double scaledPrimalResidual = 0.0;
+   double dualObjective = 0.0;
+   for(size_t i = 0; i < problem.numberOfRows_; ++i) {
+      double residual = problem.rhs_[i] - ax[i];
+      if(!problem.equality_[i]) {
+         residual = std::max(0.0, residual);
+      }
+      scaledPrimalResidual += residual * residual;
+      primalResidual = std::max(primalResidual, std::abs(residual) / problem.rowScaling_[i]);
+      dualObjective += problem.rhs_[i] * y[i];
+   }
+   double dualResidual = 0.0;
+   double scaledDualResidual = 0.0;
+   double primalObjective = 0.0;
+   for(size_t j = 0; j < problem.numberOfColumns_; ++j) {
+      primalObjective += problem.objective_[j] * x[j];
+      // reduced cost, the positive part is paid by the lower bound and the
+      // negative part by the upper bound
+      const double reducedCost = problem.objective_[j] - aty[j];
+      double residual = 0.0;
+      if(reducedCost > 0.0) {
+         if(problem.lowerBounds_[j] != -inf) {
+            dualObjective += problem.lowerBounds_[j] * reducedCost;
+         } else {
+            residual = reducedCost;
+         }
+      } else if(reducedCost < 0.0) {
+         if(problem.upperBounds_[j] != inf) {
+            dualObjective += problem.upperBounds_[j] * reducedCost;
+         } else {
+            residual = -reducedCost;
+         }
+      }
+      scaledDualResidual += residual * residual;
+      dualResidual = std::max(dualResidual, residual / problem.columnScaling_[j]);
+   }
+   residuals.primalResidual_ = primalResidual;
+   residuals.dualResidual_ = dualResidual;
+   residuals.scaledPrimalResidual_ = std::sqrt(scaledPrimalResidual);
+   residuals.scaledDualResidual_ = std::sqrt(scaledDualResidual);
+   residuals.primalObjective_ = primalObjective;
+   residuals.dualObjective_ = dualObjective;
+}
+
+} // namespace opengm
+
+#endif /* OPENGM_LP_SOLVER_BUILTIN_HXX_ */
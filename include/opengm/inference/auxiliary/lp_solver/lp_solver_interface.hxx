@@ -86,6 +86,9 @@ public:
    template<class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE>
    void addGreaterEqualConstraint(VARIABLES_ITERATOR_TYPE variableIDsBegin, const VARIABLES_ITERATOR_TYPE variableIDsEnd, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, const SolverValueType bound, const std::string& constraintName = "");
 
+   template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+   void addConstraints(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin);
+
    void addConstraintsFinished();
    void addConstraintsFinished(SolverTimingType& timing);
 
@@ -110,6 +113,10 @@ public:
 protected:
    // storage
    const Parameter parameter_;
+
+   // default implementation of bulk constraints
+   template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+   void addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin);
 };
 
 } // namespace opengm
@@ -502,6 +509,48 @@ protected:
  *           LPSolverInterface::addConstraintsFinished is called.
  */
 
+/*! \fn void LPSolverInterface::addConstraints(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin)
+ *  \brief Add a block of constraints stored in compressed sparse row format
+ *         to the model.
+ *
+ *  Constraint i is lowerBound_i <= sum_k coefficient_k * variable_k <=
+ *  upperBound_i where k runs from rowBegin_i to rowBegin_{i+1}. Equality
+ *  constraints have equal bounds and one sided constraints use
+ *  -LPSolverInterface::infinity() or LPSolverInterface::infinity() as the
+ *  other bound.
+ *
+ *  \tparam ROW_BEGIN_ITERATOR_TYPE Iterator type to iterate over the row
+ *                                  begin positions.
+ *  \tparam VARIABLES_ITERATOR_TYPE Random access iterator type to iterate over
+ *                                  the variable ids of the constraints.
+ *  \tparam COEFFICIENTS_ITERATOR_TYPE Random access iterator type to iterate
+ *                                     over the coefficients of the
+ *                                     constraints.
+ *  \tparam BOUNDS_ITERATOR_TYPE Iterator type to iterate over the bounds of
+ *                               the constraints.
+ *
+ *  \param[in] rowBeginsBegin Iterator pointing to the begin of the sequence of
+ *                            row begin positions (number of constraints + 1
+ *                            values, the last one is the total number of
+ *                            entries).
+ *  \param[in] rowBeginsEnd Iterator pointing to the end of the sequence of row
+ *                          begin positions.
+ *  \param[in] variableIDsBegin Iterator pointing to the begin of the variable
+ *                              ids of all constraints.
+ *  \param[in] coefficientsBegin Iterator pointing to the begin of the
+ *                               coefficients of all constraints.
+ *  \param[in] lowerBoundsBegin Iterator pointing to the begin of the lower
+ *                              bounds of the constraints.
+ *  \param[in] upperBoundsBegin Iterator pointing to the begin of the upper
+ *                              bounds of the constraints.
+ *
+ *  \note The Solver class can provide a corresponding addConstraints_impl()
+ *        method, otherwise the constraints are added one by one via
+ *        LPSolverInterface::addEqualityConstraint,
+ *        LPSolverInterface::addLessEqualConstraint and
+ *        LPSolverInterface::addGreaterEqualConstraint.
+ */
+
 /*! \fn void LPSolverInterface::addConstraintsFinished()
  *  \brief Join all constraints added via
  *         LPSolverInterface::addEqualityConstraint,
@@ -623,6 +672,11 @@ protected:
 /*! \var LPSolverInterface::parameter_
  *  \brief Storage for parameter.
  */
+
+/*! \fn void LPSolverInterface::addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin)
+ *  \brief Default implementation of LPSolverInterface::addConstraints which
+ *         adds the constraints one by one.
+ */
 /******************
  * implementation *
  ******************/
@@ -729,6 +783,12 @@ inline void LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_I
    static_cast<SolverType*>(this)->addGreaterEqualConstraint_impl(variableIDsBegin, variableIDsEnd, coefficientsBegin, bound, constraintName);
 }
 
+template <class LP_SOLVER_TYPE, class VALUE_TYPE, class INDEX_TYPE, class SOLUTION_ITERATOR_TYPE, class SOLVER_TIMING_TYPE>
+template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+inline void LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_ITERATOR_TYPE, SOLVER_TIMING_TYPE>::addConstraints(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin) {
+   static_cast<SolverType*>(this)->addConstraints_impl(rowBeginsBegin, rowBeginsEnd, variableIDsBegin, coefficientsBegin, lowerBoundsBegin, upperBoundsBegin);
+}
+
 template <class LP_SOLVER_TYPE, class VALUE_TYPE, class INDEX_TYPE, class SOLUTION_ITERATOR_TYPE, class SOLVER_TIMING_TYPE>
 inline void LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_ITERATOR_TYPE, SOLVER_TIMING_TYPE>::addConstraintsFinished() {
    static_cast<SolverType*>(this)->addConstraintsFinished_impl();
@@ -745,6 +805,28 @@ inline void LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_I
    static_cast<SolverType*>(this)->setParameter_impl(parameter, value);
 }
 
+template <class LP_SOLVER_TYPE, class VALUE_TYPE, class INDEX_TYPE, class SOLUTION_ITERATOR_TYPE, class SOLVER_TIMING_TYPE>
+template<class ROW_BEGIN_ITERATOR_TYPE, class VARIABLES_ITERATOR_TYPE, class COEFFICIENTS_ITERATOR_TYPE, class BOUNDS_ITERATOR_TYPE>
+inline void LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_ITERATOR_TYPE, SOLVER_TIMING_TYPE>::addConstraints_impl(ROW_BEGIN_ITERATOR_TYPE rowBeginsBegin, const ROW_BEGIN_ITERATOR_TYPE rowBeginsEnd, VARIABLES_ITERATOR_TYPE variableIDsBegin, COEFFICIENTS_ITERATOR_TYPE coefficientsBegin, BOUNDS_ITERATOR_TYPE lowerBoundsBegin, BOUNDS_ITERATOR_TYPE upperBoundsBegin) {
+   if(rowBeginsBegin == rowBeginsEnd) {
+      return;
+   }
+   for(ROW_BEGIN_ITERATOR_TYPE next = rowBeginsBegin + 1; next != rowBeginsEnd; ++rowBeginsBegin, ++next, ++lowerBoundsBegin, ++upperBoundsBegin) {
+      const SolverValueType lowerBound = static_cast<SolverValueType>(*lowerBoundsBegin);
+      const SolverValueType upperBound = static_cast<SolverValueType>(*upperBoundsBegin);
+      if(lowerBound == upperBound) {
+         static_cast<SolverType*>(this)->addEqualityConstraint(variableIDsBegin + *rowBeginsBegin, variableIDsBegin + *next, coefficientsBegin + *rowBeginsBegin, lowerBound);
+      } else {
+         if(lowerBound != -SolverType::infinity()) {
+            static_cast<SolverType*>(this)->addGreaterEqualConstraint(variableIDsBegin + *rowBeginsBegin, variableIDsBegin + *next, coefficientsBegin + *rowBeginsBegin, lowerBound);
+         }
+         if(upperBound != SolverType::infinity()) {
+            static_cast<SolverType*>(this)->addLessEqualConstraint(variableIDsBegin + *rowBeginsBegin, variableIDsBegin + *next, coefficientsBegin + *rowBeginsBegin, upperBound);
+         }
+      }
+   }
+}
+
 template <class LP_SOLVER_TYPE, class VALUE_TYPE, class INDEX_TYPE, class SOLUTION_ITERATOR_TYPE, class SOLVER_TIMING_TYPE>
 inline bool LPSolverInterface<LP_SOLVER_TYPE, VALUE_TYPE, INDEX_TYPE, SOLUTION_ITERATOR_TYPE, SOLVER_TIMING_TYPE>::solve() {
    return static_cast<SolverType*>(this)->solve_impl();
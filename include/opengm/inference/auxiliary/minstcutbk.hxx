@@ -0,0 +1,696 @@
+#pragma once
+#ifndef OPENGM_MINSTCUTBK_HXX
+#define OPENGM_MINSTCUTBK_HXX
+
+#include <vector>
+#include <deque>
+#include <limits>
+#include <cstddef>
+#include <cassert>
+
+namespace opengm {
+
+/// \brief Boykov-Kolmogorov max-flow for the min st-cut framework GraphCut
+///
+/// Y. Boykov and V. Kolmogorov, "An experimental comparison of min-cut/max-flow
+/// algorithms for energy minimization in vision", PAMI 2004\n
+/// P. Kohli and P. Torr, "Efficiently solving dynamic Markov random fields
+/// using graph cuts", ICCV 2005 (reuse of the search trees)
+///
+/// In-tree implementation without external dependencies. Besides the
+/// interface of the other min st-cut wrappers (addEdge/calculateCut, node 0
+/// is the source and node 1 the sink) the class exposes the residual network
+/// on its inner nodes 0..numberOfInnerNodes()-1:
+/// - terminal capacities can be changed by signed amounts at any time,
+/// - maxflow() continues from the current flow, and with reuseTrees=true
+///   also from the search trees of the previous call; nodes whose terminal
+///   capacities or arcs changed since then have to be marked (addTerminalWeights
+///   and addArcs do this automatically),
+/// - the nodes whose side of the cut changed in the last maxflow() can be
+///   queried via changedNodes().
+///
+/// \ingroup inference
+template<class NType, class VType>
+class MinSTCutBK {
+public:
+   typedef NType node_type;
+   typedef VType ValueType;
+   typedef std::ptrdiff_t ArcIndex;
+
+   static const ArcIndex NO_ARC = -1;
+
+   MinSTCutBK();
+   MinSTCutBK(size_t numberOfNodes, size_t numberOfEdges);
+
+   // min st-cut interface of GraphCut and QPBO
+   void addEdge(node_type, node_type, ValueType);
+   void calculateCut(std::vector<bool>&);
+
+   // incremental interface on inner nodes
+   size_t addNodes(const size_t);
+   ArcIndex addArcs(const size_t, const size_t, const ValueType, const ValueType);
+   void addTerminalWeights(const size_t, ValueType, ValueType);
+   void markNode(const size_t);
+   ValueType maxflow(const bool = false);
+   void reset();
+   void reserve(const size_t, const size_t);
+
+   size_t numberOfInnerNodes() const { return nodes_.size(); }
+   size_t numberOfArcs() const { return arcs_.size(); }
+   ValueType flow() const { return flow_; }
+   bool inSourceTree(const size_t i) const { return nodes_[i].parent_ != NO_ARC && !nodes_[i].isSink_; }
+   bool inSinkTree(const size_t i) const { return nodes_[i].parent_ != NO_ARC && nodes_[i].isSink_; }
+   ValueType terminalResidual(const size_t i) const { return nodes_[i].trCap_; }
+   ArcIndex firstArc(const size_t i) const { return nodes_[i].first_; }
+   ArcIndex nextArc(const ArcIndex a) const { return arcs_[a].next_; }
+   size_t head(const ArcIndex a) const { return arcs_[a].head_; }
+   ValueType residual(const ArcIndex a) const { return arcs_[a].rCap_; }
+   /// nodes whose tree (source, sink or none) changed in the last maxflow, may contain duplicates
+   const std::vector<size_t>& changedNodes() const { return changed_; }
+   void clearChangedNodes() { changed_.clear(); }
+
+private:
+   // parent_ is the arc to the parent in the search tree, NO_ARC for free nodes, or
+   static const ArcIndex TERMINAL = -2;
+   static const ArcIndex ORPHAN = -3;
+
+   struct Node {
+      ArcIndex first_;
+      ArcIndex parent_;
+      long ts_;
+      long dist_;
+      ValueType trCap_;
+      bool isSink_;
+      bool isActive_;
+      bool isMarked_;
+   };
+   struct Arc {
+      size_t head_;
+      ArcIndex next_;
+      ValueType rCap_;
+   };
+
+   void setActive(const size_t);
+   bool nextActive(size_t&);
+   void setOrphanFront(const size_t i) { nodes_[i].parent_ = ORPHAN; orphans_.push_front(i); }
+   void setOrphanRear(const size_t i) { nodes_[i].parent_ = ORPHAN; orphans_.push_back(i); }
+   void initialize();
+   void initializeReuse();
+   void augment(const ArcIndex);
+   void processSourceOrphan(const size_t);
+   void processSinkOrphan(const size_t);
+   void adoptOrphans();
+
+   std::vector<Node> nodes_;
+   std::vector<Arc> arcs_;
+   std::deque<size_t> active_;
+   std::deque<size_t> orphans_;
+   std::vector<size_t> marked_;
+   std::vector<size_t> changed_;
+   ValueType flow_;
+   long time_;
+   bool hasTrees_;
+   static const NType S = 0;
+   static const NType T = 1;
+};
+
+template<class NType, class VType>
+const typename MinSTCutBK<NType, VType>::ArcIndex MinSTCutBK<NType, VType>::NO_ARC;
+template<class NType, class VType>
+const typename MinSTCutBK<NType, VType>::ArcIndex MinSTCutBK<NType, VType>::TERMINAL;
+template<class NType, class VType>
+const typename MinSTCutBK<NType, VType>::ArcIndex MinSTCutBK<NType, VType>::ORPHAN;
+
+template<class NType, class VType>
+inline
+MinSTCutBK<NType, VType>::MinSTCutBK()
+:  flow_(0),
+   time_(0),
+   hasTrees_(false)
+{}
+
+template<class NType, class VType>
+inline
+MinSTCutBK<NType, VType>::MinSTCutBK
+(
+   size_t numberOfNodes,
+   size_t numberOfEdges
+)
+:  flow_(0),
+   time_(0),
+   hasTrees_(false)
+{
+   assert(numberOfNodes >= 2);
+   reserve(numberOfNodes - 2, numberOfEdges);
+   addNodes(numberOfNodes - 2);
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::reserve
+(
+   const size_t numberOfNodes,
+   const size_t numberOfEdges
+) {
+   nodes_.reserve(numberOfNodes);
+   arcs_.reserve(2 * numberOfEdges);
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::reset() {
+   nodes_.clear();
+   arcs_.clear();
+   active_.clear();
+   orphans_.clear();
+   marked_.clear();
+   changed_.clear();
+   flow_ = 0;
+   time_ = 0;
+   hasTrees_ = false;
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::addEdge(node_type n1, node_type n2, ValueType cost) {
+   assert(n1 < nodes_.size() + 2);
+   assert(n2 < nodes_.size() + 2);
+   assert(cost >= 0);
+   if(n1 == S) {
+      if(n2 != T) {
+         addTerminalWeights(n2 - 2, cost, 0);
+      }
+   }
+   else if(n2 == T) {
+      if(n1 != S) {
+         addTerminalWeights(n1 - 2, 0, cost);
+      }
+   }
+   else if(n1 != T && n2 != S) {
+      addArcs(n1 - 2, n2 - 2, cost, 0);
+   }
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::calculateCut(std::vector<bool>& segmentation) {
+   maxflow();
+   segmentation.resize(nodes_.size() + 2);
+   segmentation[S] = false;
+   segmentation[T] = true;
+   for(size_t i = 0; i < nodes_.size(); ++i) {
+      segmentation[i + 2] = inSinkTree(i);
+   }
+}
+
+/// \brief add nodes, returns the index of the first new node
+template<class NType, class VType>
+inline size_t
+MinSTCutBK<NType, VType>::addNodes(const size_t number) {
+   const size_t first = nodes_.size();
+   Node node;
+   node.first_ = NO_ARC;
+   node.parent_ = NO_ARC;
+   node.ts_ = 0;
+   node.dist_ = 0;
+   node.trCap_ = 0;
+   node.isSink_ = false;
+   node.isActive_ = false;
+   node.isMarked_ = false;
+   nodes_.resize(first + number, node);
+   return first;
+}
+
+/// \brief add the arc i->j and its reverse arc j->i, returns the index of i->j
+///
+/// The reverse arc has the index returned ^ 1.
+template<class NType, class VType>
+inline typename MinSTCutBK<NType, VType>::ArcIndex
+MinSTCutBK<NType, VType>::addArcs
+(
+   const size_t i,
+   const size_t j,
+   const ValueType capacity,
+   const ValueType reverseCapacity
+) {
+   assert(i < nodes_.size() && j < nodes_.size());
+   assert(capacity >= 0 && reverseCapacity >= 0);
+   const ArcIndex a = static_cast<ArcIndex>(arcs_.size());
+   Arc arc;
+   arc.head_ = j;
+   arc.next_ = nodes_[i].first_;
+   arc.rCap_ = capacity;
+   arcs_.push_back(arc);
+   arc.head_ = i;
+   arc.next_ = nodes_[j].first_;
+   arc.rCap_ = reverseCapacity;
+   arcs_.push_back(arc);
+   nodes_[i].first_ = a;
+   nodes_[j].first_ = a + 1;
+   if(hasTrees_) {
+      markNode(i);
+      markNode(j);
+   }
+   return a;
+}
+
+/// \brief add (possibly negative) capacities to the arcs source->i and i->sink
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::addTerminalWeights
+(
+   const size_t i,
+   ValueType capacitySource,
+   ValueType capacitySink
+) {
+   const ValueType delta = nodes_[i].trCap_;
+   if(delta > 0) {
+      capacitySource += delta;
+   }
+   else {
+      capacitySink -= delta;
+   }
+   flow_ += capacitySource < capacitySink ? capacitySource : capacitySink;
+   nodes_[i].trCap_ = capacitySource - capacitySink;
+   if(hasTrees_) {
+      markNode(i);
+   }
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::markNode(const size_t i) {
+   if(!nodes_[i].isMarked_) {
+      nodes_[i].isMarked_ = true;
+      marked_.push_back(i);
+   }
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::setActive(const size_t i) {
+   if(!nodes_[i].isActive_) {
+      nodes_[i].isActive_ = true;
+      active_.push_back(i);
+   }
+}
+
+template<class NType, class VType>
+inline bool
+MinSTCutBK<NType, VType>::nextActive(size_t& i) {
+   while(!active_.empty()) {
+      i = active_.front();
+      active_.pop_front();
+      nodes_[i].isActive_ = false;
+      if(nodes_[i].parent_ != NO_ARC) {
+         return true;
+      }
+   }
+   return false;
+}
+
+template<class NType, class VType>
+void
+MinSTCutBK<NType, VType>::initialize() {
+   active_.clear();
+   orphans_.clear();
+   time_ = 0;
+   for(size_t i = 0; i < nodes_.size(); ++i) {
+      Node& node = nodes_[i];
+      node.isActive_ = false;
+      node.isMarked_ = false;
+      node.ts_ = 0;
+      if(node.trCap_ != 0) {
+         node.isSink_ = node.trCap_ < 0;
+         node.parent_ = TERMINAL;
+         node.dist_ = 1;
+         setActive(i);
+      }
+      else {
+         node.parent_ = NO_ARC;
+      }
+   }
+   marked_.clear();
+}
+
+// only the marked nodes are updated, the trees of the last call are kept
+template<class NType, class VType>
+void
+MinSTCutBK<NType, VType>::initializeReuse() {
+   active_.clear();
+   orphans_.clear();
+   ++time_;
+   for(size_t n = 0; n < marked_.size(); ++n) {
+      const size_t i = marked_[n];
+      nodes_[i].isMarked_ = false;
+      setActive(i);
+      if(nodes_[i].trCap_ == 0) {
+         if(nodes_[i].parent_ != NO_ARC && nodes_[i].parent_ != ORPHAN) {
+            setOrphanRear(i);
+         }
+         continue;
+      }
+      const bool toSink = nodes_[i].trCap_ < 0;
+      if(nodes_[i].parent_ == NO_ARC || nodes_[i].isSink_ != toSink) {
+         nodes_[i].isSink_ = toSink;
+         for(ArcIndex a = nodes_[i].first_; a != NO_ARC; a = arcs_[a].next_) {
+            const size_t j = arcs_[a].head_;
+            if(!nodes_[j].isMarked_) {
+               if(nodes_[j].parent_ == (a ^ 1)) {
+                  setOrphanRear(j);
+               }
+               if(nodes_[j].parent_ != NO_ARC && nodes_[j].isSink_ != toSink
+                  && (toSink ? arcs_[a ^ 1].rCap_ : arcs_[a].rCap_) > 0) {
+                  setActive(j);
+               }
+            }
+         }
+         changed_.push_back(i);
+      }
+      nodes_[i].parent_ = TERMINAL;
+      nodes_[i].ts_ = time_;
+      nodes_[i].dist_ = 1;
+   }
+   marked_.clear();
+   adoptOrphans();
+}
+
+/// \brief compute the maximum flow, starting from the current flow
+///
+/// \param reuseTrees continue from the search trees of the previous call
+/// \return value of the flow, which is the value of the minimum cut
+template<class NType, class VType>
+typename MinSTCutBK<NType, VType>::ValueType
+MinSTCutBK<NType, VType>::maxflow(const bool reuseTrees) {
+   changed_.clear();
+   if(reuseTrees && hasTrees_) {
+      initializeReuse();
+   }
+   else {
+      initialize();
+   }
+   hasTrees_ = true;
+
+   bool hasCurrent = false;
+   size_t current = 0;
+   while(true) {
+      size_t i = 0;
+      bool found = false;
+      if(hasCurrent) {
+         hasCurrent = false;
+         nodes_[current].isActive_ = false;
+         if(nodes_[current].parent_ != NO_ARC) {
+            i = current;
+            found = true;
+         }
+      }
+      if(!found && !nextActive(i)) {
+         break;
+      }
+
+      // grow the tree of i
+      ArcIndex middle = NO_ARC;
+      if(!nodes_[i].isSink_) {
+         for(ArcIndex a = nodes_[i].first_; a != NO_ARC; a = arcs_[a].next_) {
+            if(arcs_[a].rCap_ > 0) {
+               const size_t j = arcs_[a].head_;
+               if(nodes_[j].parent_ == NO_ARC) {
+                  nodes_[j].isSink_ = false;
+                  nodes_[j].parent_ = a ^ 1;
+                  nodes_[j].ts_ = nodes_[i].ts_;
+                  nodes_[j].dist_ = nodes_[i].dist_ + 1;
+                  setActive(j);
+                  changed_.push_back(j);
+               }
+               else if(nodes_[j].isSink_) {
+                  middle = a;
+                  break;
+               }
+               else if(nodes_[j].ts_ <= nodes_[i].ts_ && nodes_[j].dist_ > nodes_[i].dist_) {
+                  nodes_[j].parent_ = a ^ 1;
+                  nodes_[j].ts_ = nodes_[i].ts_;
+                  nodes_[j].dist_ = nodes_[i].dist_ + 1;
+               }
+            }
+         }
+      }
+      else {
+         for(ArcIndex a = nodes_[i].first_; a != NO_ARC; a = arcs_[a].next_) {
+            if(arcs_[a ^ 1].rCap_ > 0) {
+               const size_t j = arcs_[a].head_;
+               if(nodes_[j].parent_ == NO_ARC) {
+                  nodes_[j].isSink_ = true;
+                  nodes_[j].parent_ = a ^ 1;
+                  nodes_[j].ts_ = nodes_[i].ts_;
+                  nodes_[j].dist_ = nodes_[i].dist_ + 1;
+                  setActive(j);
+                  changed_.push_back(j);
+               }
+               else if(!nodes_[j].isSink_) {
+                  middle = a ^ 1;
+                  break;
+               }
+               else if(nodes_[j].ts_ <= nodes_[i].ts_ && nodes_[j].dist_ > nodes_[i].dist_) {
+                  nodes_[j].parent_ = a ^ 1;
+                  nodes_[j].ts_ = nodes_[i].ts_;
+                  nodes_[j].dist_ = nodes_[i].dist_ + 1;
+               }
+            }
+         }
+      }
+
+      ++time_;
+      if(middle != NO_ARC) {
+         // i stays active and is processed again
+         nodes_[i].isActive_ = true;
+         current = i;
+         hasCurrent = true;
+         augment(middle);
+         adoptOrphans();
+      }
+   }
+   return flow_;
+}
+
+template<class NType, class VType>
+void
+MinSTCutBK<NType, VType>::augment(const ArcIndex middle) {
+   // bottleneck capacity
+   ValueType bottleneck = arcs_[middle].rCap_;
+   size_t i = arcs_[middle ^ 1].head_;
+   for(ArcIndex a = nodes_[i].parent_; a != TERMINAL; a = nodes_[i].parent_) {
+      if(bottleneck > arcs_[a ^ 1].rCap_) {
+         bottleneck = arcs_[a ^ 1].rCap_;
+      }
+      i = arcs_[a].head_;
+   }
+   if(bottleneck > nodes_[i].trCap_) {
+      bottleneck = nodes_[i].trCap_;
+   }
+   i = arcs_[middle].head_;
+   for(ArcIndex a = nodes_[i].parent_; a != TERMINAL; a = nodes_[i].parent_) {
+      if(bottleneck > arcs_[a].rCap_) {
+         bottleneck = arcs_[a].rCap_;
+      }
+      i = arcs_[a].head_;
+   }
+   if(bottleneck > -nodes_[i].trCap_) {
+      bottleneck = -nodes_[i].trCap_;
+   }
+
+   // augment along the path
+   arcs_[middle ^ 1].rCap_ += bottleneck;
+   arcs_[middle].rCap_ -= bottleneck;
+   i = arcs_[middle ^ 1].head_;
+   while(true) {
+      const ArcIndex a = nodes_[i].parent_;
+      if(a == TERMINAL) {
+         break;
+      }
+      arcs_[a].rCap_ += bottleneck;
+      arcs_[a ^ 1].rCap_ -= bottleneck;
+      if(arcs_[a ^ 1].rCap_ == 0) {
+         setOrphanFront(i);
+      }
+      i = arcs_[a].head_;
+   }
+   nodes_[i].trCap_ -= bottleneck;
+   if(nodes_[i].trCap_ == 0) {
+      setOrphanFront(i);
+   }
+   i = arcs_[middle].head_;
+   while(true) {
+      const ArcIndex a = nodes_[i].parent_;
+      if(a == TERMINAL) {
+         break;
+      }
+      arcs_[a ^ 1].rCap_ += bottleneck;
+      arcs_[a].rCap_ -= bottleneck;
+      if(arcs_[a].rCap_ == 0) {
+         setOrphanFront(i);
+      }
+      i = arcs_[a].head_;
+   }
+   nodes_[i].trCap_ += bottleneck;
+   if(nodes_[i].trCap_ == 0) {
+      setOrphanFront(i);
+   }
+   flow_ += bottleneck;
+}
+
+template<class NType, class VType>
+inline void
+MinSTCutBK<NType, VType>::adoptOrphans() {
+   while(!orphans_.empty()) {
+      const size_t i = orphans_.front();
+      orphans_.pop_front();
+      if(nodes_[i].isSink_) {
+         processSinkOrphan(i);
+      }
+      else {
+         processSourceOrphan(i);
+      }
+   }
+}
+
+template<class NType, class VType>
+void
+MinSTCutBK<NType, VType>::processSourceOrphan(const size_t i) {
+   const long infiniteDistance = std::numeric_limits<long>::max();
+   ArcIndex minArc = NO_ARC;
+   long minDistance = infiniteDistance;
+   for(ArcIndex a0 = nodes_[i].first_; a0 != NO_ARC; a0 = arcs_[a0].next_) {
+      if(arcs_[a0 ^ 1].rCap_ > 0) {
+         size_t j = arcs_[a0].head_;
+         if(!nodes_[j].isSink_ && nodes_[j].parent_ != NO_ARC) {
+            // check the origin of j
+            long d = 0;
+            while(true) {
+               if(nodes_[j].ts_ == time_) {
+                  d += nodes_[j].dist_;
+                  break;
+               }
+               const ArcIndex a = nodes_[j].parent_;
+               ++d;
+               if(a == TERMINAL) {
+                  nodes_[j].ts_ = time_;
+                  nodes_[j].dist_ = 1;
+                  break;
+               }
+               if(a == ORPHAN) {
+                  d = infiniteDistance;
+                  break;
+               }
+               j = arcs_[a].head_;
+            }
+            if(d < infiniteDistance) {
+               if(d < minDistance) {
+                  minArc = a0;
+                  minDistance = d;
+               }
+               // set the marks along the path
+               for(j = arcs_[a0].head_; nodes_[j].ts_ != time_; j = arcs_[nodes_[j].parent_].head_) {
+                  nodes_[j].ts_ = time_;
+                  nodes_[j].dist_ = d--;
+               }
+            }
+         }
+      }
+   }
+
+   if(minArc != NO_ARC) {
+      nodes_[i].parent_ = minArc;
+      nodes_[i].ts_ = time_;
+      nodes_[i].dist_ = minDistance + 1;
+   }
+   else {
+      // i becomes free, its children become orphans
+      nodes_[i].parent_ = NO_ARC;
+      changed_.push_back(i);
+      for(ArcIndex a0 = nodes_[i].first_; a0 != NO_ARC; a0 = arcs_[a0].next_) {
+         const size_t j = arcs_[a0].head_;
+         const ArcIndex a = nodes_[j].parent_;
+         if(!nodes_[j].isSink_ && a != NO_ARC) {
+            if(arcs_[a0 ^ 1].rCap_ > 0) {
+               setActive(j);
+            }
+            if(a != TERMINAL && a != ORPHAN && arcs_[a].head_ == i) {
+               setOrphanRear(j);
+            }
+         }
+      }
+   }
+}
+
+template<class NType, class VType>
+void
+MinSTCutBK<NType, VType>::processSinkOrphan(const size_t i) {
+   const long infiniteDistance = std::numeric_limits<long>::max();
+   ArcIndex minArc = NO_ARC;
+   long minDistance = infiniteDistance;
+   for(ArcIndex a0 = nodes_[i].first_; a0 != NO_ARC; a0 = arcs_[a0].next_) {
+      if(arcs_[a0].rCap_ > 0) {
+         size_t j = arcs_[a0].head_;
+         if(nodes_[j].isSink_ && nodes_[j].parent_ != NO_ARC) {
+            // check the origin of j
+            long d = 0;
+            while(true) {
+               if(nodes_[j].ts_ == time_) {
+                  d += nodes_[j].dist_;
+                  break;
+               }
+               const ArcIndex a = nodes_[j].parent_;
+               ++d;
+               if(a == TERMINAL) {
+                  nodes_[j].ts_ = time_;
+                  nodes_[j].dist_ = 1;
+                  break;
+               }
+               if(a == ORPHAN) {
+                  d = infiniteDistance;
+                  break;
+               }
+               j = arcs_[a].head_;
+            }
+            if(d < infiniteDistance) {
+               if(d < minDistance) {
+                  minArc = a0;
+                  minDistance = d;
+               }
+               // set the marks along the path
+               for(j = arcs_[a0].head_; nodes_[j].ts_ != time_; j = arcs_[nodes_[j].parent_].head_) {
+                  nodes_[j].ts_ = time_;
+                  nodes_[j].dist_ = d--;
+               }
+            }
+         }
+      }
+   }
+
+   if(minArc != NO_ARC) {
+      nodes_[i].parent_ = minArc;
+      nodes_[i].ts_ = time_;
+      nodes_[i].dist_ = minDistance + 1;
+   }
+   else {
+      // i becomes free, its children become orphans
+      nodes_[i].parent_ = NO_ARC;
+      changed_.push_back(i);
+      for(ArcIndex a0 = nodes_[i].first_; a0 != NO_ARC; a0 = arcs_[a0].next_) {
+         const size_t j = arcs_[a0].head_;
+         const ArcIndex a = nodes_[j].parent_;
+         if(nodes_[j].isSink_ && a != NO_ARC) {
+            if(arcs_[a0].rCap_ > 0) {
+               setActive(j);
+            }
+            if(a != TERMINAL && a != ORPHAN && arcs_[a].head_ == i) {
+               setOrphanRear(j);
+            }
+         }
+      }
+   }
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_MINSTCUTBK_HXX
@@ -0,0 +1,682 @@
+#pragma once
+#ifndef OPENGM_QPBO_GRAPH_HXX
+#define OPENGM_QPBO_GRAPH_HXX
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <cstdlib>
+
+#include "opengm/opengm.hxx"
+#include "opengm/inference/auxiliary/minstcutbk.hxx"
+
+namespace opengm {
+
+/// \brief Roof duality for quadratic pseudo-boolean functions (QPBO, QPBO-P, QPBO-I)
+///
+/// E. Boros, P.L. Hammer and G. Tavares, "Preprocessing of unconstrained quadratic binary optimization", RUTCOR 2006\n
+/// C. Rother, V. Kolmogorov, V. Lempitsky, and M. Szummer, "Optimizing binary MRFs via extended roof duality", CVPR 2007
+///
+/// In-tree implementation on the residual network of MinSTCutBK. The
+/// interface follows kolmogorov::qpbo::QPBO such that both can be used
+/// interchangeably (e.g. by MQPBO, ReducedInference, the fusion movers,
+/// HigherOrderReduction and HigherOrderEnergy::ToQuadratic).
+///
+/// Probe() and Improve() change the graph only by terminal capacities and
+/// constraint arcs and continue the max-flow computation from the previous
+/// flow and search trees after each change. Probe() does not contract the
+/// graph: equivalences between variables found by probing are enforced by
+/// constraint arcs, so the mapping returned is the identity.
+///
+/// \ingroup inference
+template<class VALUE>
+class QPBOGraph {
+public:
+   typedef VALUE ValueType;
+   typedef int NodeId;
+   typedef int EdgeId;
+   typedef MinSTCutBK<size_t, ValueType> MaxFlowType;
+   typedef typename MaxFlowType::ArcIndex ArcIndex;
+
+   struct ProbeOptions {
+      ProbeOptions()
+      :  weak_persistencies(0),
+         C(0),
+         order_array(NULL)
+      {}
+      /// complete the labeling by weak persistencies after probing
+      int weak_persistencies;
+      /// unused, the capacity of the constraints is derived from the energy
+      ValueType C;
+      /// order in which the nodes are probed (NULL: node order)
+      int* order_array;
+   };
+
+   QPBOGraph(const int = 0, const int = 0);
+   void Reset();
+   NodeId AddNode(const int = 1);
+   void AddUnaryTerm(const NodeId, const ValueType, const ValueType);
+   EdgeId AddPairwiseTerm(const NodeId, const NodeId, const ValueType, const ValueType, const ValueType, const ValueType);
+   void SetMaxEdgeNum(const int);
+   /// parallel edges are supported by the network, nothing to merge
+   void MergeParallelEdges() {}
+   int GetNodeNum() const { return static_cast<int>(numberOfNodes_); }
+   int GetLabel(const NodeId i) const { return labels_[i]; }
+   void SetLabel(const NodeId i, const int label) { labels_[i] = label; }
+
+   void Solve();
+   void ComputeWeakPersistencies();
+   ValueType ComputeTwiceEnergy(const int = 0) const;
+   ValueType ComputeTwiceLowerBound() const { return twiceLowerBound_; }
+   void Probe(int*, ProbeOptions&);
+   void MergeMappings(const int, int*, const int*) const;
+   bool Improve(const int, const int*);
+   bool Improve();
+
+private:
+   struct PairwiseTerm {
+      NodeId i_;
+      NodeId j_;
+      ValueType e00_, e01_, e10_, e11_;
+   };
+
+   // node 2*i is the literal x_i, node 2*i+1 its negation. Arcs are added in
+   // pairs (u->v, mirror(v)->mirror(u)), the mirror of arc a is a^2.
+   void addTwiceUnary(const size_t, const ValueType, const ValueType);
+   void addTwicePairwise(const size_t, const size_t, const ValueType, const ValueType, const ValueType, const ValueType);
+   int strongLabel(const size_t i) const;
+   bool isFree(const size_t u) const { return !graph_.inSourceTree(u) && !graph_.inSinkTree(u); }
+   bool hasSymmetricResidual(const ArcIndex a) const { return graph_.residual(a) > 0 || graph_.residual(a ^ 2) > 0; }
+   ValueType constraintCapacity() const { return 2 * totalCapacity_ + 1; }
+   void fix(const size_t i, const int label, const ValueType capacity);
+   void updateLabels(std::vector<int>&, std::vector<std::pair<size_t, int> >*);
+   ValueType twiceEnergy(const std::vector<int>&) const;
+   size_t findClass(size_t, int&);
+
+   MaxFlowType graph_;
+   size_t numberOfNodes_;
+   std::vector<ValueType> unary0_;
+   std::vector<ValueType> unary1_;
+   std::vector<PairwiseTerm> pairwise_;
+   std::vector<int> labels_;
+   // union find with parity of the equivalences found by probing
+   std::vector<size_t> classParent_;
+   std::vector<int> classParity_;
+   ValueType twiceConstant_;
+   ValueType twiceLowerBound_;
+   ValueType totalCapacity_;
+};
+
+template<class VALUE>
+inline
+QPBOGraph<VALUE>::QPBOGraph
+(
+   const int numberOfNodes,
+   const int numberOfEdges
+)
+:  numberOfNodes_(0),
+   twiceConstant_(0),
+   twiceLowerBound_(0),
+   totalCapacity_(0)
+{
+   graph_.reserve(2 * numberOfNodes, 2 * numberOfEdges);
+   unary0_.reserve(numberOfNodes);
+   unary1_.reserve(numberOfNodes);
+   pairwise_.reserve(numberOfEdges);
+}
+
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::Reset() {
+   graph_.reset();
+   numberOfNodes_ = 0;
+   unary0_.clear();
+   unary1_.clear();
+   pairwise_.clear();
+   labels_.clear();
+   classParent_.clear();
+   classParity_.clear();
+   twiceConstant_ = 0;
+   twiceLowerBound_ = 0;
+   totalCapacity_ = 0;
+}
+
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::SetMaxEdgeNum(const int numberOfEdges) {
+   graph_.reserve(2 * numberOfNodes_, 2 * numberOfEdges);
+   pairwise_.reserve(numberOfEdges);
+}
+
+/// \brief add nodes, returns the id of the first new node
+template<class VALUE>
+inline typename QPBOGraph<VALUE>::NodeId
+QPBOGraph<VALUE>::AddNode(const int number) {
+   const size_t first = numberOfNodes_;
+   numberOfNodes_ += number;
+   graph_.addNodes(2 * number);
+   unary0_.resize(numberOfNodes_, 0);
+   unary1_.resize(numberOfNodes_, 0);
+   labels_.resize(numberOfNodes_, -1);
+   return static_cast<NodeId>(first);
+}
+
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::AddUnaryTerm
+(
+   const NodeId i,
+   const ValueType e0,
+   const ValueType e1
+) {
+   OPENGM_ASSERT(static_cast<size_t>(i) < numberOfNodes_);
+   unary0_[i] += e0;
+   unary1_[i] += e1;
+   addTwiceUnary(i, e0, e1);
+}
+
+template<class VALUE>
+inline typename QPBOGraph<VALUE>::EdgeId
+QPBOGraph<VALUE>::AddPairwiseTerm
+(
+   const NodeId i,
+   const NodeId j,
+   const ValueType e00,
+   const ValueType e01,
+   const ValueType e10,
+   const ValueType e11
+) {
+   OPENGM_ASSERT(i != j);
+   OPENGM_ASSERT(static_cast<size_t>(i) < numberOfNodes_ && static_cast<size_t>(j) < numberOfNodes_);
+   PairwiseTerm term;
+   term.i_ = i;
+   term.j_ = j;
+   term.e00_ = e00;
+   term.e01_ = e01;
+   term.e10_ = e10;
+   term.e11_ = e11;
+   pairwise_.push_back(term);
+   addTwicePairwise(i, j, e00, e01, e10, e11);
+   return static_cast<EdgeId>(pairwise_.size() - 1);
+}
+
+// both the literal and its negation carry the unary term, every cut counts it twice
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::addTwiceUnary
+(
+   const size_t i,
+   const ValueType e0,
+   const ValueType e1
+) {
+   graph_.addTerminalWeights(2 * i, e1, e0);
+   graph_.addTerminalWeights(2 * i + 1, e0, e1);
+   totalCapacity_ += 2 * ((e0 < 0 ? -e0 : e0) + (e1 < 0 ? -e1 : e1));
+}
+
+// E(x_i,x_j) = e00 + (e10-e00) x_i + (e11-e10) x_j + lambda (1-x_i) x_j
+template<class VALUE>
+void
+QPBOGraph<VALUE>::addTwicePairwise
+(
+   const size_t i,
+   const size_t j,
+   const ValueType e00,
+   const ValueType e01,
+   const ValueType e10,
+   const ValueType e11
+) {
+   twiceConstant_ += 2 * e00;
+   addTwiceUnary(i, 0, e10 - e00);
+   addTwiceUnary(j, 0, e11 - e10);
+   const ValueType lambda = e01 + e10 - e00 - e11;
+   if(lambda > 0) {
+      // submodular, cut if x_i=0 and x_j=1
+      graph_.addArcs(2 * i, 2 * j, lambda, 0);
+      graph_.addArcs(2 * j + 1, 2 * i + 1, lambda, 0);
+      totalCapacity_ += 2 * lambda;
+   }
+   else if(lambda < 0) {
+      // lambda (1-x_i) x_j = lambda x_j - lambda x_i x_j, cut if x_i=1 and x_j=1
+      addTwiceUnary(j, 0, lambda);
+      graph_.addArcs(2 * i + 1, 2 * j, -lambda, 0);
+      graph_.addArcs(2 * j + 1, 2 * i, -lambda, 0);
+      totalCapacity_ -= 2 * lambda;
+   }
+}
+
+// the source tree is the minimal source set of all minimum cuts
+template<class VALUE>
+inline int
+QPBOGraph<VALUE>::strongLabel(const size_t i) const {
+   if(graph_.inSourceTree(2 * i)) {
+      return 0;
+   }
+   if(graph_.inSinkTree(2 * i)) {
+      return 1;
+   }
+   return -1;
+}
+
+/// \brief compute the roof dual and the strong persistencies
+template<class VALUE>
+void
+QPBOGraph<VALUE>::Solve() {
+   graph_.maxflow(true);
+   graph_.clearChangedNodes();
+   twiceLowerBound_ = graph_.flow() + twiceConstant_;
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      labels_[i] = strongLabel(i);
+   }
+}
+
+/// \brief extend the labeling of Solve() or Probe() by the weak persistencies
+///
+/// The strongly connected components of the residual network of the
+/// symmetrized flow are labeled from the sink side, components which
+/// contain both literals of a variable, and all components between them,
+/// determine which further components are fixed.
+template<class VALUE>
+void
+QPBOGraph<VALUE>::ComputeWeakPersistencies() {
+   const size_t numberOfLiterals = 2 * numberOfNodes_;
+   const size_t none = std::numeric_limits<size_t>::max();
+   std::vector<size_t> index(numberOfLiterals, none);
+   std::vector<size_t> lowLink(numberOfLiterals, 0);
+   std::vector<size_t> component(numberOfLiterals, none);
+   std::vector<bool> onStack(numberOfLiterals, false);
+   std::vector<size_t> sccStack;
+   std::vector<std::pair<size_t, ArcIndex> > callStack;
+   std::vector<size_t> members;
+   std::vector<size_t> componentBegin;
+   size_t counter = 0;
+
+   // Tarjan, emits the components from the sink side (reverse topological order)
+   for(size_t root = 0; root < numberOfLiterals; ++root) {
+      if(index[root] != none || !isFree(root)) {
+         continue;
+      }
+      index[root] = lowLink[root] = counter++;
+      sccStack.push_back(root);
+      onStack[root] = true;
+      callStack.push_back(std::make_pair(root, graph_.firstArc(root)));
+      while(!callStack.empty()) {
+         const size_t u = callStack.back().first;
+         ArcIndex a = callStack.back().second;
+         bool descended = false;
+         while(a != MaxFlowType::NO_ARC) {
+            const ArcIndex current = a;
+            const size_t v = graph_.head(a);
+            a = graph_.nextArc(a);
+            if(!isFree(v) || !hasSymmetricResidual(current)) {
+               continue;
+            }
+            if(index[v] == none) {
+               callStack.back().second = a;
+               index[v] = lowLink[v] = counter++;
+               sccStack.push_back(v);
+               onStack[v] = true;
+               callStack.push_back(std::make_pair(v, graph_.firstArc(v)));
+               descended = true;
+               break;
+            }
+            else if(onStack[v] && index[v] < lowLink[u]) {
+               lowLink[u] = index[v];
+            }
+         }
+         if(descended) {
+            continue;
+         }
+         if(lowLink[u] == index[u]) {
+            componentBegin.push_back(members.size());
+            size_t v;
+            do {
+               v = sccStack.back();
+               sccStack.pop_back();
+               onStack[v] = false;
+               component[v] = componentBegin.size() - 1;
+               members.push_back(v);
+            } while(v != u);
+         }
+         callStack.pop_back();
+         if(!callStack.empty()) {
+            const size_t parent = callStack.back().first;
+            if(lowLink[u] < lowLink[parent]) {
+               lowLink[parent] = lowLink[u];
+            }
+         }
+      }
+   }
+   componentBegin.push_back(members.size());
+
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      if(isFree(2 * i)) {
+         labels_[i] = -1;
+      }
+   }
+
+   // components reachable from a self-mirrored component are on the source
+   // side, their mirrors (which reach it) on the sink side
+   std::vector<size_t> queue;
+   std::vector<bool> reached(numberOfLiterals, false);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      if(component[2 * i] != none && component[2 * i] == component[2 * i + 1]) {
+         reached[2 * i] = reached[2 * i + 1] = true;
+         queue.push_back(2 * i);
+         queue.push_back(2 * i + 1);
+      }
+   }
+   while(!queue.empty()) {
+      const size_t u = queue.back();
+      queue.pop_back();
+      for(ArcIndex a = graph_.firstArc(u); a != MaxFlowType::NO_ARC; a = graph_.nextArc(a)) {
+         const size_t v = graph_.head(a);
+         if(!reached[v] && isFree(v) && hasSymmetricResidual(a)) {
+            reached[v] = true;
+            queue.push_back(v);
+            labels_[v / 2] = static_cast<int>(v & 1);
+         }
+      }
+   }
+
+   // remaining components from the sink side to the source side
+   for(size_t c = 0; c + 1 < componentBegin.size(); ++c) {
+      const size_t first = members[componentBegin[c]];
+      if(component[first] == component[first ^ 1] || labels_[first / 2] >= 0) {
+         continue;
+      }
+      for(size_t m = componentBegin[c]; m < componentBegin[c + 1]; ++m) {
+         labels_[members[m] / 2] = static_cast<int>(members[m] & 1);
+      }
+   }
+}
+
+/// \brief twice the energy of the current labeling, unlabeled nodes are set to option (0 or 1)
+template<class VALUE>
+typename QPBOGraph<VALUE>::ValueType
+QPBOGraph<VALUE>::ComputeTwiceEnergy(const int option) const {
+   std::vector<int> labeling(labels_);
+   for(size_t i = 0; i < labeling.size(); ++i) {
+      if(labeling[i] < 0) {
+         labeling[i] = option;
+      }
+   }
+   return twiceEnergy(labeling);
+}
+
+template<class VALUE>
+typename QPBOGraph<VALUE>::ValueType
+QPBOGraph<VALUE>::twiceEnergy(const std::vector<int>& labeling) const {
+   ValueType energy = 0;
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      energy += labeling[i] == 0 ? unary0_[i] : unary1_[i];
+   }
+   for(size_t n = 0; n < pairwise_.size(); ++n) {
+      const PairwiseTerm& t = pairwise_[n];
+      if(labeling[t.i_] == 0) {
+         energy += labeling[t.j_] == 0 ? t.e00_ : t.e01_;
+      }
+      else {
+         energy += labeling[t.j_] == 0 ? t.e10_ : t.e11_;
+      }
+   }
+   return 2 * energy;
+}
+
+// penalize x_i != label with the given (signed) capacity
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::fix
+(
+   const size_t i,
+   const int label,
+   const ValueType capacity
+) {
+   if(label == 0) {
+      graph_.addTerminalWeights(2 * i, capacity, 0);
+      graph_.addTerminalWeights(2 * i + 1, 0, capacity);
+   }
+   else {
+      graph_.addTerminalWeights(2 * i, 0, capacity);
+      graph_.addTerminalWeights(2 * i + 1, capacity, 0);
+   }
+}
+
+// update the strong labels of the nodes whose literal changed its side in
+// the last max-flow computation, optionally record (node, old label)
+template<class VALUE>
+void
+QPBOGraph<VALUE>::updateLabels
+(
+   std::vector<int>& labels,
+   std::vector<std::pair<size_t, int> >* changed
+) {
+   const std::vector<size_t>& literals = graph_.changedNodes();
+   for(size_t n = 0; n < literals.size(); ++n) {
+      const size_t i = literals[n] / 2;
+      const int label = strongLabel(i);
+      if(label != labels[i]) {
+         if(changed != NULL) {
+            changed->push_back(std::make_pair(i, labels[i]));
+         }
+         labels[i] = label;
+      }
+   }
+   graph_.clearChangedNodes();
+}
+
+template<class VALUE>
+size_t
+QPBOGraph<VALUE>::findClass(size_t i, int& parity) {
+   parity = 0;
+   while(classParent_[i] != i) {
+      parity ^= classParity_[i];
+      i = classParent_[i];
+   }
+   return i;
+}
+
+/// \brief QPBO-P, fix nodes and find equivalences by probing both labels of each unlabeled node
+///
+/// \param mapping of size GetNodeNum(), set to 2*i (no contraction)
+/// \param options
+template<class VALUE>
+void
+QPBOGraph<VALUE>::Probe
+(
+   int* mapping,
+   ProbeOptions& options
+) {
+   classParent_.resize(numberOfNodes_);
+   classParity_.resize(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      classParent_[i] = i;
+      classParity_[i] = 0;
+   }
+   std::vector<int> order(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      order[i] = options.order_array == NULL ? static_cast<int>(i) : options.order_array[i];
+   }
+
+   graph_.maxflow(true);
+   graph_.clearChangedNodes();
+   std::vector<int> labels(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      labels[i] = strongLabel(i);
+   }
+   std::vector<int> probeLabel(numberOfNodes_, -2);
+   std::vector<std::pair<size_t, int> > changed0;
+   std::vector<std::pair<size_t, int> > changed1;
+   std::vector<std::pair<size_t, int> > fixes;
+   std::vector<std::pair<size_t, int> > equivalences;
+   bool found = true;
+   while(found) {
+      found = false;
+      for(size_t n = 0; n < order.size(); ++n) {
+         const size_t i = order[n];
+         if(labels[i] >= 0) {
+            continue;
+         }
+         const ValueType capacity = constraintCapacity();
+         // probe x_i = 0
+         changed0.clear();
+         fix(i, 0, capacity);
+         graph_.maxflow(true);
+         updateLabels(labels, &changed0);
+         for(size_t m = 0; m < changed0.size(); ++m) {
+            probeLabel[changed0[m].first] = labels[changed0[m].first];
+         }
+         fix(i, 0, -capacity);
+         graph_.maxflow(true);
+         updateLabels(labels, NULL);
+         // probe x_i = 1
+         changed1.clear();
+         fix(i, 1, capacity);
+         graph_.maxflow(true);
+         updateLabels(labels, &changed1);
+         fixes.clear();
+         equivalences.clear();
+         for(size_t m = 0; m < changed1.size(); ++m) {
+            const size_t j = changed1[m].first;
+            const int base = changed1[m].second;
+            if(j == i || base >= 0) {
+               continue;
+            }
+            const int label0 = probeLabel[j] == -2 ? base : probeLabel[j];
+            const int label1 = labels[j];
+            if(label0 >= 0 && label0 == label1) {
+               fixes.push_back(std::make_pair(j, label0));
+            }
+            else if(label0 >= 0 && label1 >= 0) {
+               // x_j = x_i (label0 = 0) or x_j = 1 - x_i (label0 = 1)
+               equivalences.push_back(std::make_pair(j, label0));
+            }
+         }
+         for(size_t m = 0; m < changed0.size(); ++m) {
+            probeLabel[changed0[m].first] = -2;
+         }
+         fix(i, 1, -capacity);
+
+         for(size_t m = 0; m < fixes.size(); ++m) {
+            fix(fixes[m].first, fixes[m].second, capacity);
+            found = true;
+         }
+         for(size_t m = 0; m < equivalences.size(); ++m) {
+            const size_t j = equivalences[m].first;
+            const int parity = equivalences[m].second;
+            int parityI, parityJ;
+            const size_t classI = findClass(i, parityI);
+            const size_t classJ = findClass(j, parityJ);
+            if(classI == classJ) {
+               continue;
+            }
+            classParent_[classJ] = classI;
+            classParity_[classJ] = parityI ^ parityJ ^ parity;
+            // x_i = x_j (parity 0) or x_i = 1 - x_j (parity 1) by arcs in both directions
+            graph_.addArcs(2 * i, 2 * j + parity, capacity, capacity);
+            graph_.addArcs(2 * j + 1 - parity, 2 * i + 1, capacity, capacity);
+            found = true;
+         }
+         graph_.maxflow(true);
+         updateLabels(labels, NULL);
+      }
+   }
+
+   twiceLowerBound_ = graph_.flow() + twiceConstant_;
+   labels_ = labels;
+   if(options.weak_persistencies) {
+      ComputeWeakPersistencies();
+   }
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      mapping[i] = static_cast<int>(2 * i);
+   }
+}
+
+/// \brief combine the mapping of a previous call of Probe with a new one
+template<class VALUE>
+inline void
+QPBOGraph<VALUE>::MergeMappings
+(
+   const int numberOfNodes,
+   int* mapping0,
+   const int* mapping1
+) const {
+   for(int i = 0; i < numberOfNodes; ++i) {
+      mapping0[i] = mapping1[mapping0[i] / 2] ^ (mapping0[i] & 1);
+   }
+}
+
+/// \brief QPBO-I, improve the current labeling (SetLabel) by fixing the nodes of order one at a time
+///
+/// Each node is fixed to its current label and the labeling is fused with
+/// the persistencies of the fixed problem, which never increases the energy.
+/// The fixations are removed afterwards.
+/// \return true if the energy decreased
+template<class VALUE>
+bool
+QPBOGraph<VALUE>::Improve
+(
+   const int numberOfProbes,
+   const int* order
+) {
+   std::vector<int> labeling(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      labeling[i] = labels_[i] < 0 ? 0 : labels_[i];
+   }
+   const ValueType energy = twiceEnergy(labeling);
+
+   graph_.maxflow(true);
+   graph_.clearChangedNodes();
+   twiceLowerBound_ = graph_.flow() + twiceConstant_;
+   std::vector<int> labels(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      labels[i] = strongLabel(i);
+      if(labels[i] >= 0) {
+         labeling[i] = labels[i];
+      }
+   }
+   std::vector<std::pair<size_t, int> > changed;
+   std::vector<std::pair<size_t, int> > fixes;
+   const ValueType capacity = constraintCapacity();
+   for(int n = 0; n < numberOfProbes; ++n) {
+      const size_t i = order[n];
+      if(labels[i] >= 0) {
+         continue;
+      }
+      fix(i, labeling[i], capacity);
+      fixes.push_back(std::make_pair(i, labeling[i]));
+      graph_.maxflow(true);
+      changed.clear();
+      updateLabels(labels, &changed);
+      for(size_t m = 0; m < changed.size(); ++m) {
+         const size_t j = changed[m].first;
+         if(labels[j] >= 0) {
+            labeling[j] = labels[j];
+         }
+      }
+   }
+   for(size_t n = 0; n < fixes.size(); ++n) {
+      fix(fixes[n].first, fixes[n].second, -capacity);
+   }
+   labels_ = labeling;
+   return twiceEnergy(labeling) < energy;
+}
+
+/// \brief QPBO-I with all nodes in random order (rand())
+template<class VALUE>
+bool
+QPBOGraph<VALUE>::Improve() {
+   std::vector<int> order(numberOfNodes_);
+   for(size_t i = 0; i < numberOfNodes_; ++i) {
+      order[i] = static_cast<int>(i);
+   }
+   for(size_t i = 0; i + 1 < order.size(); ++i) {
+      const size_t j = i + static_cast<size_t>((static_cast<double>(rand()) / (static_cast<double>(RAND_MAX) + 1.0)) * (order.size() - i));
+      std::swap(order[i], order[j]);
+   }
+   return Improve(static_cast<int>(order.size()), order.empty() ? NULL : &order[0]);
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_QPBO_GRAPH_HXX
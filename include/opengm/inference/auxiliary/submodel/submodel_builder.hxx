@@ -1,3 +1,9 @@
+#pragma once
+#ifndef OPENGM_SUBMODEL_BUILDER_HXX
+#define OPENGM_SUBMODEL_BUILDER_HXX
+
+#include <vector>
+#include <map>
 
 #include "opengm/opengm.hxx"
 #include "opengm/graphicalmodel/graphicalmodel.hxx"
@@ -688,7 +694,440 @@ private:
 
 };
 
-}
 
+/// \brief submodel optimizer with a reusable workspace
+///
+/// The factors of a submodel are collected once in setVariableIndices and
+/// kept as views of the factors of the original model, conditioned on the
+/// labels of the variables outside of the submodel. No factor table is
+/// copied. Acyclic submodels with factors of order <= 2 (within the
+/// submodel) are solved by dynamic programming directly on these views.
+/// All buffers grow to the largest submodel seen so far and are reused.
+template<class GM,class ACC>
+class PooledSubmodelOptimizer{
+
+public:
+    typedef GM GraphicalModelType;
+    typedef ACC AccumulationType;
+    OPENGM_GM_TYPE_TYPEDEFS;
+
+    // function types
+    typedef ViewFixVariablesFunction<GM> FixFunction;
+    typedef ViewFunction<GM> ViewingFunction;
+    typedef PositionAndLabel<IndexType,LabelType>  PosAndLabel;
+    typedef std::vector<PosAndLabel> PosAndLabelVector;
+
+    // sub gm
+    typedef typename SubmodelOptimizer<GM,ACC>::SubSpaceType SubSpaceType;
+    typedef typename SubmodelOptimizer<GM,ACC>::SubGmType SubGmType;
+
+    PooledSubmodelOptimizer(const GM & gm)
+    :   gm_(gm),
+        localVariables_(gm.numberOfVariables()),
+        globalToLocalVariables_(gm.numberOfVariables()),
+        submodelSpace_(gm.numberOfVariables()),
+        inSubmodel_(gm.numberOfVariables(),false),
+        nLocalVar_(0),
+        handledFactor_(gm.numberOfFactors(),false),
+        labels_(gm.numberOfVariables()),
+        factors_(),
+        freeBegin_(1,0),
+        freePositions_(),
+        freeVariables_(),
+        factorLabelBegin_(1,0),
+        factorLabels_(),
+        nFullFactors_(0)
+    {
+    }
+
+    // set current state
+    // O( CONST )
+    void setLabel(const IndexType vi,const LabelType label){
+        labels_[vi]=label;
+    }
+
+    LabelType label(const IndexType vi)const{
+        return labels_[vi];
+    }
+
+    // set subvariables and collect the factors of the submodel
+    // O( |SUB_VARIABLES| + |SUB_FACTORS| )
+    template<class VI_ITER>
+    void setVariableIndices(VI_ITER begin,VI_ITER end){
+        OPENGM_CHECK_OP(nLocalVar_,==,0,"internal error");
+        nLocalVar_=std::distance(begin,end);
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            const IndexType globalVi = begin[localVi];
+            OPENGM_CHECK_OP(globalVi,<,gm_.numberOfVariables(),"");
+            localVariables_[localVi]=globalVi;
+            submodelSpace_[localVi]=gm_.numberOfLabels(globalVi);
+            globalToLocalVariables_[globalVi]=localVi;
+            OPENGM_CHECK(inSubmodel_[globalVi]==false,"internal error");
+            inSubmodel_[globalVi]=true;
+        }
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            const IndexType globalVi = localVariables_[localVi];
+            const IndexType nFac = gm_.numberOfFactors(globalVi);
+            for(IndexType f=0;f<nFac;++f){
+                const IndexType fi = gm_.factorOfVariable(globalVi,f);
+                if(handledFactor_[fi]==false){
+                    handledFactor_[fi]=true;
+                    const FactorType & factor = gm_[fi];
+                    const IndexType    order  = factor.numberOfVariables();
+                    for(IndexType v=0;v<order;++v){
+                        const IndexType facVi=factor.variableIndex(v);
+                        factorLabels_.push_back(labels_[facVi]);
+                        if(inSubmodel_[facVi]){
+                            freePositions_.push_back(v);
+                            freeVariables_.push_back(globalToLocalVariables_[facVi]);
+                        }
+                    }
+                    if(freePositions_.size()-freeBegin_.back()==order){
+                        ++nFullFactors_;
+                    }
+                    factors_.push_back(fi);
+                    freeBegin_.push_back(freePositions_.size());
+                    factorLabelBegin_.push_back(factorLabels_.size());
+                }
+            }
+        }
+        for(IndexType lf=0;lf<factors_.size();++lf){
+            handledFactor_[factors_[lf]]=false;
+        }
+    }
+
+    // unset all subvariables
+    // O( |SUB_VARIABLES| )
+    void unsetVariableIndices(){
+        OPENGM_CHECK_OP(nLocalVar_,>,0,"internal error");
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            const IndexType globalVi = localVariables_[localVi];
+            OPENGM_CHECK(inSubmodel_[globalVi]==true,"internal error");
+            inSubmodel_[globalVi]=false;
+        }
+        nLocalVar_=0;
+        factors_.clear();
+        freeBegin_.resize(1);
+        freePositions_.clear();
+        freeVariables_.clear();
+        factorLabelBegin_.resize(1);
+        factorLabels_.clear();
+        nFullFactors_=0;
+    }
+
+    // build and infer with template
+    template<class SOLVER>
+    bool inferSubmodelInplace(
+        const typename SOLVER::Parameter & para ,
+        std::vector<LabelType> & resultArg,
+        const bool /*improving*/=true,
+        const bool warmStart=false
+    ){
+        OPENGM_CHECK_OP(nLocalVar_,!=,0,"");
+        resultArg.resize(nLocalVar_);
+        SOLVER solver(submodelSpace_.begin(),submodelSpace_.begin()+nLocalVar_,para);
+        buildModelInplace(solver);
+        if(warmStart){
+            for(IndexType viLocal=0;viLocal<nLocalVar_;++viLocal){
+                resultArg[viLocal]=labels_[localVariables_[viLocal]];
+            }
+            solver.setStartingPoint(resultArg.begin());
+        }
+        solver.infer();
+        solver.arg(resultArg);
+        return hasChanges(resultArg);
+    }
+
+    template<class SOLVER>
+    bool inferSubmodel(
+        const typename SOLVER::Parameter & para ,
+        std::vector<LabelType> & resultArg,
+        const bool /*improving*/=true,
+        const bool warmStart=false
+    ){
+        OPENGM_CHECK_OP(nLocalVar_,!=,0,"");
+        resultArg.resize(nLocalVar_);
+        SubGmType  subGm( SubSpaceType(submodelSpace_.begin(),submodelSpace_.begin()+nLocalVar_) );
+        buildModelOpenGm(subGm);
+        SOLVER solver(subGm,para);
+        if(warmStart){
+            for(IndexType viLocal=0;viLocal<nLocalVar_;++viLocal){
+                resultArg[viLocal]=labels_[localVariables_[viLocal]];
+            }
+            solver.setStartingPoint(resultArg.begin());
+        }
+        solver.infer();
+        solver.arg(resultArg);
+        return hasChanges(resultArg);
+    }
+
+    // exact dynamic programming on the factor views,
+    // the factors of order 2 within the submodel need to form a forest
+    bool inferDynamicProgramming(std::vector<LabelType> & resultArg){
+        OPENGM_CHECK_OP(nLocalVar_,!=,0,"");
+        resultArg.resize(nLocalVar_);
+        const IndexType nFac = factors_.size();
+
+        // unary tables (beliefs) of all local variables
+        stateBegin_.resize(nLocalVar_+1);
+        stateBegin_[0]=0;
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            stateBegin_[localVi+1]=stateBegin_[localVi]+submodelSpace_[localVi];
+        }
+        beliefs_.resize(stateBegin_[nLocalVar_]);
+        for(size_t s=0;s<beliefs_.size();++s){
+            OperatorType::neutral(beliefs_[s]);
+        }
+        adjacencyBegin_.assign(nLocalVar_+1,0);
+        for(IndexType lf=0;lf<nFac;++lf){
+            const IndexType nFree = freeBegin_[lf+1]-freeBegin_[lf];
+            if(nFree==1){
+                const IndexType localVi = freeVariables_[freeBegin_[lf]];
+                for(LabelType l=0;l<submodelSpace_[localVi];++l){
+                    setFreeLabel(lf,0,l);
+                    OperatorType::op(evaluate(lf),beliefs_[stateBegin_[localVi]+l]);
+                }
+            }
+            else if(nFree==2){
+                ++adjacencyBegin_[freeVariables_[freeBegin_[lf]]+1];
+                ++adjacencyBegin_[freeVariables_[freeBegin_[lf]+1]+1];
+            }
+            else{
+                throw RuntimeError("dynamic programming on a submodel requires factors of order <= 2 within the submodel");
+            }
+        }
+
+        // adjacency of the local variables w.r.t. the factors of order 2
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            adjacencyBegin_[localVi+1]+=adjacencyBegin_[localVi];
+        }
+        adjacencyFactors_.resize(adjacencyBegin_[nLocalVar_]);
+        adjacencyCursor_.assign(adjacencyBegin_.begin(),adjacencyBegin_.end()-1);
+        for(IndexType lf=0;lf<nFac;++lf){
+            if(freeBegin_[lf+1]-freeBegin_[lf]==2){
+                adjacencyFactors_[adjacencyCursor_[freeVariables_[freeBegin_[lf]]]++]=lf;
+                adjacencyFactors_[adjacencyCursor_[freeVariables_[freeBegin_[lf]+1]]++]=lf;
+            }
+        }
 
+        // breadth first order of each tree, the argmin table of a
+        // variable is indexed by the label of its parent
+        order_.clear();
+        parent_.resize(nLocalVar_);
+        argBegin_.resize(nLocalVar_);
+        visited_.assign(nLocalVar_,false);
+        size_t argSize=0;
+        for(IndexType root=0;root<nLocalVar_;++root){
+            if(visited_[root]){
+                continue;
+            }
+            visited_[root]=true;
+            parent_[root]=nLocalVar_;
+            order_.push_back(root);
+            for(size_t head=order_.size()-1;head<order_.size();++head){
+                const IndexType localVi = order_[head];
+                for(IndexType a=adjacencyBegin_[localVi];a<adjacencyBegin_[localVi+1];++a){
+                    const IndexType other = otherVariable(adjacencyFactors_[a],localVi);
+                    if(other==parent_[localVi]){
+                        continue;
+                    }
+                    if(visited_[other]){
+                        // several factors may connect the same pair of variables
+                        if(parent_[other]==localVi){
+                            continue;
+                        }
+                        throw RuntimeError("dynamic programming on a submodel requires an acyclic submodel");
+                    }
+                    visited_[other]=true;
+                    parent_[other]=localVi;
+                    argBegin_[other]=argSize;
+                    argSize+=submodelSpace_[localVi];
+                    order_.push_back(other);
+                }
+            }
+        }
+        argmin_.resize(argSize);
+
+        // messages from the leaves to the roots
+        for(size_t o=order_.size();o>0;--o){
+            const IndexType child  = order_[o-1];
+            const IndexType parent = parent_[child];
+            if(parent==nLocalVar_){
+                continue;
+            }
+            for(LabelType lp=0;lp<submodelSpace_[parent];++lp){
+                ValueType best;
+                ACC::neutral(best);
+                LabelType bestLabel=0;
+                for(LabelType lc=0;lc<submodelSpace_[child];++lc){
+                    ValueType value = beliefs_[stateBegin_[child]+lc];
+                    for(IndexType a=adjacencyBegin_[child];a<adjacencyBegin_[child+1];++a){
+                        const IndexType lf = adjacencyFactors_[a];
+                        if(otherVariable(lf,child)==parent){
+                            const IndexType childFree = freeVariables_[freeBegin_[lf]]==child ? 0 : 1;
+                            setFreeLabel(lf,childFree,lc);
+                            setFreeLabel(lf,1-childFree,lp);
+                            OperatorType::op(evaluate(lf),value);
+                        }
+                    }
+                    if(ACC::bop(value,best)){
+                        best=value;
+                        bestLabel=lc;
+                    }
+                }
+                OperatorType::op(best,beliefs_[stateBegin_[parent]+lp]);
+                argmin_[argBegin_[child]+lp]=bestLabel;
+            }
+        }
+
+        // labels from the roots to the leaves
+        for(size_t o=0;o<order_.size();++o){
+            const IndexType localVi = order_[o];
+            const IndexType parent  = parent_[localVi];
+            if(parent==nLocalVar_){
+                ValueType best;
+                ACC::neutral(best);
+                resultArg[localVi]=0;
+                for(LabelType l=0;l<submodelSpace_[localVi];++l){
+                    if(ACC::bop(beliefs_[stateBegin_[localVi]+l],best)){
+                        best=beliefs_[stateBegin_[localVi]+l];
+                        resultArg[localVi]=l;
+                    }
+                }
+            }
+            else{
+                resultArg[localVi]=argmin_[argBegin_[localVi]+resultArg[parent]];
+            }
+        }
+        return hasChanges(resultArg);
+    }
+
+    // build the submodel as opengm model of views
+    void buildModelOpenGm(SubGmType & subGm){
+        const IndexType nFac = factors_.size();
+        subGm.reserveFactors(nFac);
+        subGm.reserveFactorsVarialbeIndices(freePositions_.size());
+        subGm. template reserveFunctions<ViewingFunction> (nFullFactors_);
+        subGm. template reserveFunctions<FixFunction>     (nFac-nFullFactors_);
+        PosAndLabelVector positionsAndLabelsOfFixedVars;
+        for(IndexType lf=0;lf<nFac;++lf){
+            const FactorType & factor = gm_[factors_[lf]];
+            if(freeBegin_[lf+1]-freeBegin_[lf]==factor.numberOfVariables()){
+                subGm.addFactor(subGm.addFunction(ViewingFunction(factor)),
+                    freeVariables_.begin()+freeBegin_[lf],freeVariables_.begin()+freeBegin_[lf+1]);
+            }
+            else{
+                fixedPositionsAndLabels(lf,positionsAndLabelsOfFixedVars);
+                subGm.addFactor(subGm.addFunction(FixFunction(factor,positionsAndLabelsOfFixedVars)),
+                    freeVariables_.begin()+freeBegin_[lf],freeVariables_.begin()+freeBegin_[lf+1]);
+            }
+        }
+    }
+
+    // build model inplace for a given solver
+    template<class INF_TYPE>
+    void buildModelInplace(INF_TYPE & infType){
+        PosAndLabelVector positionsAndLabelsOfFixedVars;
+        for(IndexType lf=0;lf<factors_.size();++lf){
+            const FactorType & factor = gm_[factors_[lf]];
+            if(freeBegin_[lf+1]-freeBegin_[lf]==factor.numberOfVariables()){
+                infType.addFactor(freeVariables_.begin()+freeBegin_[lf],freeVariables_.begin()+freeBegin_[lf+1],factor);
+            }
+            else{
+                fixedPositionsAndLabels(lf,positionsAndLabelsOfFixedVars);
+                infType.addFactor(freeVariables_.begin()+freeBegin_[lf],freeVariables_.begin()+freeBegin_[lf+1],
+                    FixFunction(factor,positionsAndLabelsOfFixedVars));
+            }
+        }
+    }
+
+    bool inSubmodel(const IndexType vi)const{
+        return inSubmodel_[vi];
+    }
+
+    IndexType submodelSize()const{
+        return nLocalVar_;
+    }
+
+    IndexType numberOfSubmodelFactors()const{
+        return factors_.size();
+    }
+
+private:
+    // value of a submodel factor for the labels in its label buffer
+    ValueType evaluate(const IndexType lf)const{
+        return gm_[factors_[lf]](factorLabels_.begin()+factorLabelBegin_[lf]);
+    }
+
+    void setFreeLabel(const IndexType lf,const IndexType free,const LabelType label){
+        factorLabels_[factorLabelBegin_[lf]+freePositions_[freeBegin_[lf]+free]]=label;
+    }
+
+    IndexType otherVariable(const IndexType lf,const IndexType localVi)const{
+        const IndexType first = freeVariables_[freeBegin_[lf]];
+        return first==localVi ? freeVariables_[freeBegin_[lf]+1] : first;
+    }
+
+    void fixedPositionsAndLabels(const IndexType lf,PosAndLabelVector & positionsAndLabels)const{
+        positionsAndLabels.clear();
+        const IndexType order = factorLabelBegin_[lf+1]-factorLabelBegin_[lf];
+        size_t free = freeBegin_[lf];
+        for(IndexType v=0;v<order;++v){
+            if(free<freeBegin_[lf+1] && freePositions_[free]==v){
+                ++free;
+            }
+            else{
+                positionsAndLabels.push_back(PosAndLabel(v,factorLabels_[factorLabelBegin_[lf]+v]));
+            }
+        }
+    }
+
+    bool hasChanges(const std::vector<LabelType> & resultArg)const{
+        for(IndexType localVi=0;localVi<nLocalVar_;++localVi){
+            if(resultArg[localVi]!=labels_[localVariables_[localVi]]){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const GM & gm_;
+
+    // submodel
+    std::vector<IndexType> localVariables_;
+    std::vector<IndexType> globalToLocalVariables_;
+    std::vector<LabelType> submodelSpace_;
+    std::vector<bool>      inSubmodel_;
+    IndexType nLocalVar_;
+    std::vector<bool>      handledFactor_;
+
+    // global labels
+    std::vector<LabelType> labels_;
+
+    // factors of the submodel, the free positions of the submodel factor lf
+    // are freePositions_[freeBegin_[lf]] ... freePositions_[freeBegin_[lf+1]-1],
+    // its label buffer holds the labels of the fixed variables
+    std::vector<IndexType> factors_;
+    std::vector<size_t>    freeBegin_;
+    std::vector<IndexType> freePositions_;
+    std::vector<IndexType> freeVariables_;
+    std::vector<size_t>    factorLabelBegin_;
+    std::vector<LabelType> factorLabels_;
+    IndexType nFullFactors_;
+
+    // dynamic programming
+    std::vector<size_t>    stateBegin_;
+    std::vector<ValueType> beliefs_;
+    std::vector<IndexType> adjacencyBegin_;
+    std::vector<IndexType> adjacencyCursor_;
+    std::vector<IndexType> adjacencyFactors_;
+    std::vector<IndexType> order_;
+    std::vector<IndexType> parent_;
+    std::vector<size_t>    argBegin_;
+    std::vector<LabelType> argmin_;
+    std::vector<bool>      visited_;
+};
+
+}
 
+#endif // #ifndef OPENGM_SUBMODEL_BUILDER_HXX
@@ -2,6 +2,13 @@
 #ifndef OPENGM_BRUTEFORCE_HXX
 #define OPENGM_BRUTEFORCE_HXX
 
+#include <vector>
+#include <algorithm>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 #include "inference.hxx"
 #include "movemaker.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
@@ -9,7 +16,21 @@ namespace opengm {
 
 template<class GM> class Movemaker;
 
-/// Brute force inference algorithm 
+/// Brute force inference algorithm
+///
+/// The labelings are enumerated in mixed-radix Gray code order, i.e. two
+/// consecutive labelings differ in the label of exactly one variable, by one.
+/// Only the factors connected to this variable are evaluated again; the
+/// values of all factors are combined in a binary tree such that no inverse
+/// operation is needed. The space of labelings is split into chunks (by the
+/// labels of the variables with the largest indices) which are enumerated
+/// in parallel if OpenGM is built WITH_OPENMP.
+///
+/// The visitor is called after each batch of chunks (one chunk per thread).
+/// For ACC = Minimizer or Maximizer, the numberOfBest_ best labelings are
+/// kept (ties are broken by the lexicographic order of the labelings), see
+/// arg(). value() is the accumulation of the values of all labelings w.r.t.
+/// ACC (for ACC = Integrator the partition function).
 ///
 /// \ingroup inference
 template<class GM, class ACC>
@@ -35,13 +56,20 @@ public:
     };
 
    struct Parameter {
-        Parameter(){
-
-        }
+        /// \param numberOfBest number of best labelings that are kept
+        /// \param numberOfThreads number of threads (0: OpenMP default)
+        Parameter(const size_t numberOfBest = 1, const size_t numberOfThreads = 0)
+        :  numberOfBest_(numberOfBest),
+           numberOfThreads_(numberOfThreads)
+        {}
         template<class P>
-        Parameter(const P & p){
+        Parameter(const P & p)
+        :  numberOfBest_(p.numberOfBest_),
+           numberOfThreads_(p.numberOfThreads_)
+        {}
 
-        }
+        size_t numberOfBest_;
+        size_t numberOfThreads_;
    };
 
    Bruteforce(const GraphicalModelType&);
@@ -50,15 +78,51 @@ public:
    const GraphicalModelType& graphicalModel() const { return gm_; }
    InferenceTermination infer()                     { EmptyVisitorType visitor; return infer(visitor);}
    template<class VISITOR> InferenceTermination infer(VISITOR &);
-   InferenceTermination arg(std::vector<LabelType>&, const size_t = 1) const; 
-   virtual ValueType value() const; 
-   void reset(); 
- 
+   InferenceTermination arg(std::vector<LabelType>&, const size_t = 1) const;
+   virtual ValueType value() const;
+   void reset();
+
+   /// number of labelings that have been evaluated
+   UInt64Type numberOfConfigurations() const { return numberOfConfigurations_; }
+
 private:
+   struct Candidate {
+      ValueType value_;
+      std::vector<LabelType> labels_;
+   };
+   // heap order: the worst candidate is on top
+   struct CandidateLess {
+      bool operator()(const Candidate& a, const Candidate& b) const
+         { return Bruteforce<GM, ACC>::better(a.value_, a.labels_, b); }
+   };
+   // per thread
+   struct Workspace {
+      std::vector<LabelType> labels_;
+      std::vector<signed char> directions_;
+      std::vector<ValueType> tree_;
+      std::vector<LabelType> factorLabels_;
+      std::vector<Candidate> candidates_;
+      ValueType accumulated_;
+      UInt64Type numberOfConfigurations_;
+   };
+
+   static bool better(const ValueType, const std::vector<LabelType>&, const Candidate&);
+   void initializeWorkspace(Workspace&) const;
+   void updateFactor(Workspace&, const IndexType) const;
+   void visitLabeling(Workspace&) const;
+   void enumerateChunk(Workspace&, size_t) const;
+   void mergeWorkspaces();
+
     const GraphicalModelType& gm_;
-    opengm::Movemaker<GraphicalModelType> movemaker_;
+    Parameter parameter_;
     std::vector<LabelType> states_;
     ValueType energy_;
+    std::vector<Candidate> best_;
+    std::vector<Workspace> workspaces_;
+    size_t numberOfGrayVariables_; // variables enumerated within a chunk
+    size_t numberOfChunks_;
+    size_t numberOfLeaves_;
+    UInt64Type numberOfConfigurations_;
 };
 template<class GM, class AKK>
 Bruteforce<GM, AKK>::Bruteforce
@@ -66,9 +130,10 @@ Bruteforce<GM, AKK>::Bruteforce
     const GraphicalModelType& gm
 )
 :  gm_(gm),
-   movemaker_(Movemaker<GM>(gm)),
+   parameter_(),
    states_(std::vector<typename GM::LabelType>(gm.numberOfVariables() )),
-   energy_(typename Bruteforce<GM, AKK>::ValueType())
+   energy_(typename Bruteforce<GM, AKK>::ValueType()),
+   numberOfConfigurations_(0)
 {
    AKK::neutral(energy_);
 }
@@ -77,9 +142,11 @@ template<class GM, class AKK>
 void
 Bruteforce<GM, AKK>::reset()
 {
-   movemaker_.reset();
    std::fill(states_.begin(), states_.end(), 0);
    AKK::neutral(energy_);
+   best_.clear();
+   workspaces_.clear();
+   numberOfConfigurations_ = 0;
 }
 
 template<class GM, class AKK>
@@ -89,10 +156,174 @@ Bruteforce<GM, AKK>::Bruteforce
    const typename Bruteforce<GM, AKK>::Parameter& param
 )
 :  gm_(gm),
-   movemaker_(Movemaker<GM>(gm)),
+   parameter_(param),
    states_(std::vector<typename GM::LabelType>(gm.numberOfVariables())),
-   energy_(typename Bruteforce<GM, AKK>::ValueType())
-{}
+   energy_(typename Bruteforce<GM, AKK>::ValueType()),
+   numberOfConfigurations_(0)
+{
+   AKK::neutral(energy_);
+}
+
+template<class GM, class AKK>
+inline bool
+Bruteforce<GM, AKK>::better
+(
+   const ValueType value,
+   const std::vector<LabelType>& labels,
+   const Candidate& candidate
+)
+{
+   if(AKK::bop(value, candidate.value_)) {
+      return true;
+   }
+   if(AKK::bop(candidate.value_, value)) {
+      return false;
+   }
+   return labels < candidate.labels_;
+}
+
+template<class GM, class AKK>
+void
+Bruteforce<GM, AKK>::initializeWorkspace
+(
+   Workspace& workspace
+) const
+{
+   workspace.labels_.assign(gm_.numberOfVariables(), 0);
+   workspace.directions_.assign(gm_.numberOfVariables(), 1);
+   workspace.tree_.assign(2 * numberOfLeaves_, OperatorType::template neutral<ValueType>());
+   workspace.factorLabels_.assign(gm_.factorOrder(), 0);
+   workspace.candidates_.clear();
+   workspace.accumulated_ = AKK::template neutral<ValueType>();
+   workspace.numberOfConfigurations_ = 0;
+}
+
+/// evaluate a factor for the current labeling and update the tree of values
+template<class GM, class AKK>
+inline void
+Bruteforce<GM, AKK>::updateFactor
+(
+   Workspace& workspace,
+   const IndexType factorIndex
+) const
+{
+   const FactorType& factor = gm_[factorIndex];
+   for(size_t j = 0; j < factor.numberOfVariables(); ++j) {
+      workspace.factorLabels_[j] = workspace.labels_[factor.variableIndex(j)];
+   }
+   std::vector<ValueType>& tree = workspace.tree_;
+   size_t node = numberOfLeaves_ + factorIndex;
+   tree[node] = factor(workspace.factorLabels_.begin());
+   for(node /= 2; node != 0; node /= 2) {
+      OperatorType::op(tree[2 * node], tree[2 * node + 1], tree[node]);
+   }
+}
+
+template<class GM, class AKK>
+inline void
+Bruteforce<GM, AKK>::visitLabeling
+(
+   Workspace& workspace
+) const
+{
+   const ValueType value = workspace.tree_[1];
+   AKK::op(value, workspace.accumulated_);
+   ++workspace.numberOfConfigurations_;
+   if(!AKK::hasbop()) {
+      return;
+   }
+   std::vector<Candidate>& candidates = workspace.candidates_;
+   if(candidates.size() < parameter_.numberOfBest_) {
+      Candidate candidate;
+      candidate.value_ = value;
+      candidate.labels_ = workspace.labels_;
+      candidates.push_back(candidate);
+      std::push_heap(candidates.begin(), candidates.end(), CandidateLess());
+   }
+   else if(!AKK::bop(candidates.front().value_, value)
+      && better(value, workspace.labels_, candidates.front())) {
+      std::pop_heap(candidates.begin(), candidates.end(), CandidateLess());
+      candidates.back().value_ = value;
+      candidates.back().labels_ = workspace.labels_;
+      std::push_heap(candidates.begin(), candidates.end(), CandidateLess());
+   }
+}
+
+/// enumerate all labelings of the variables 0, ..., numberOfGrayVariables_-1
+/// in Gray code order, the labels of the other variables are given by the
+/// chunk index (mixed radix)
+template<class GM, class AKK>
+void
+Bruteforce<GM, AKK>::enumerateChunk
+(
+   Workspace& workspace,
+   size_t chunk
+) const
+{
+   std::vector<LabelType>& labels = workspace.labels_;
+   std::vector<signed char>& directions = workspace.directions_;
+   for(size_t j = 0; j < numberOfGrayVariables_; ++j) {
+      labels[j] = 0;
+      directions[j] = 1;
+   }
+   for(size_t j = numberOfGrayVariables_; j < gm_.numberOfVariables(); ++j) {
+      labels[j] = static_cast<LabelType>(chunk % gm_.numberOfLabels(j));
+      chunk /= gm_.numberOfLabels(j);
+   }
+   std::vector<ValueType>& tree = workspace.tree_;
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      const FactorType& factor = gm_[f];
+      for(size_t j = 0; j < factor.numberOfVariables(); ++j) {
+         workspace.factorLabels_[j] = labels[factor.variableIndex(j)];
+      }
+      tree[numberOfLeaves_ + f] = factor(workspace.factorLabels_.begin());
+   }
+   for(size_t node = numberOfLeaves_ - 1; node != 0; --node) {
+      OperatorType::op(tree[2 * node], tree[2 * node + 1], tree[node]);
+   }
+   visitLabeling(workspace);
+   for(;;) {
+      // the variable with the smallest index that can move in its direction
+      size_t j = 0;
+      for(; j < numberOfGrayVariables_; ++j) {
+         const LabelType label = labels[j];
+         if(directions[j] > 0 ? static_cast<size_t>(label) + 1 < gm_.numberOfLabels(j) : label > 0) {
+            break;
+         }
+         directions[j] = -directions[j];
+      }
+      if(j == numberOfGrayVariables_) {
+         break;
+      }
+      labels[j] = directions[j] > 0 ? labels[j] + 1 : labels[j] - 1;
+      for(typename GM::ConstFactorIterator it = gm_.factorsOfVariableBegin(j); it != gm_.factorsOfVariableEnd(j); ++it) {
+         updateFactor(workspace, *it);
+      }
+      visitLabeling(workspace);
+   }
+}
+
+/// combine the results of all threads
+template<class GM, class AKK>
+void
+Bruteforce<GM, AKK>::mergeWorkspaces()
+{
+   AKK::neutral(energy_);
+   numberOfConfigurations_ = 0;
+   best_.clear();
+   for(size_t t = 0; t < workspaces_.size(); ++t) {
+      AKK::op(workspaces_[t].accumulated_, energy_);
+      numberOfConfigurations_ += workspaces_[t].numberOfConfigurations_;
+      best_.insert(best_.end(), workspaces_[t].candidates_.begin(), workspaces_[t].candidates_.end());
+   }
+   std::sort(best_.begin(), best_.end(), CandidateLess());
+   if(best_.size() > parameter_.numberOfBest_) {
+      best_.resize(parameter_.numberOfBest_);
+   }
+   if(!best_.empty()) {
+      states_ = best_.front().labels_;
+   }
+}
 
 template<class GM, class AKK>
 template<class VISITOR>
@@ -102,36 +333,46 @@ Bruteforce<GM, AKK>::infer
    VISITOR & visitor
 )
 {
-   std::vector<LabelType> states(gm_.numberOfVariables());
-   std::vector<IndexType> vi(gm_.numberOfVariables());
-   for(size_t j=0; j<gm_.numberOfVariables(); ++j) {
-       vi[j] = j;
+   #ifdef WITH_OPENMP
+   const size_t numberOfThreads = parameter_.numberOfThreads_ != 0 ? parameter_.numberOfThreads_ : static_cast<size_t>(omp_get_max_threads());
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+
+   // leaves of the tree of factor values
+   numberOfLeaves_ = 1;
+   while(numberOfLeaves_ < gm_.numberOfFactors()) {
+      numberOfLeaves_ *= 2;
    }
+   // split the labelings into (at least) 16 chunks per thread
+   numberOfGrayVariables_ = gm_.numberOfVariables();
+   numberOfChunks_ = 1;
+   while(numberOfGrayVariables_ > 0 && numberOfChunks_ < 16 * numberOfThreads) {
+      --numberOfGrayVariables_;
+      numberOfChunks_ *= gm_.numberOfLabels(numberOfGrayVariables_);
+   }
+   workspaces_.resize(numberOfThreads);
+   for(size_t t = 0; t < numberOfThreads; ++t) {
+      initializeWorkspace(workspaces_[t]);
+   }
+   mergeWorkspaces();
 
-   AccumulationType::neutral(energy_); 
-   bool exitInf = false;
    visitor.begin(*this);
-   while(exitInf == false) {
-      ValueType energy = movemaker_.move(vi.begin(), vi.end(), states.begin());
-      if(AccumulationType::bop(energy , energy_)) {
-         states_ = states;
-      } 
-      AccumulationType::op(energy, energy_); 
-      if( visitor(*this) != visitors::VisitorReturnFlag::ContinueInf ){
-         exitInf = true;
-      }
-      bool overflow = true;
-      for(size_t j=0; j<gm_.numberOfVariables(); ++j) {
-         if( size_t(states[j]+1) < size_t(gm_.numberOfLabels(j))) {
-            ++states[j];
-            for(size_t k=0; k<j; ++k) {
-               states[k] = 0;
-            }
-            overflow = false;
-            break;
-         }
+   for(size_t batch = 0; batch < numberOfChunks_; batch += numberOfThreads) {
+      const std::ptrdiff_t batchEnd = static_cast<std::ptrdiff_t>(std::min(batch + numberOfThreads, numberOfChunks_));
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for schedule(dynamic) num_threads(static_cast<int>(numberOfThreads))
+      #endif
+      for(std::ptrdiff_t chunk = static_cast<std::ptrdiff_t>(batch); chunk < batchEnd; ++chunk) {
+         #ifdef WITH_OPENMP
+         Workspace& workspace = workspaces_[omp_get_thread_num()];
+         #else
+         Workspace& workspace = workspaces_[0];
+         #endif
+         enumerateChunk(workspace, static_cast<size_t>(chunk));
       }
-      if(overflow) {
+      mergeWorkspaces();
+      if( visitor(*this) != visitors::VisitorReturnFlag::ContinueInf ){
          break;
       }
    }
@@ -139,6 +380,7 @@ Bruteforce<GM, AKK>::infer
    return NORMAL;
 }
 
+/// \brief output the n-th best labeling (n = 1, ..., numberOfBest_)
 template<class GM, class AKK>
 inline InferenceTermination
 Bruteforce<GM, AKK>::arg
@@ -151,6 +393,10 @@ Bruteforce<GM, AKK>::arg
       states = states_; // copy
       return NORMAL;
    }
+   else if(j > 1 && j <= best_.size()) {
+      states = best_[j - 1].labels_;
+      return NORMAL;
+   }
    else {
       return UNKNOWN;
    }
@@ -159,10 +405,10 @@ Bruteforce<GM, AKK>::arg
 /// \brief return the solution (value)
 template<class GM, class ACC>
 typename GM::ValueType
-Bruteforce<GM, ACC>::value() const 
+Bruteforce<GM, ACC>::value() const
 {
    return energy_;
-} 
+}
 
 } // namespace opengm
 
@@ -6,9 +6,13 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <set>
+#include <deque>
 
-#include <boost/format.hpp>
-#include <boost/unordered_set.hpp>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
@@ -117,6 +121,15 @@ namespace detail_gcg{
 
 /// \brief Experimental Multicut 
 ///
+/// The 2-colorings of the cut and glue moves are planar max-cut problems 
+/// (WITH_BLOSSOM5 and WITH_PLANARITY) or are solved by QPBO-I. Without
+/// the external planar max-cut, planar submodels are solved exactly 
+/// up to SubmodelCGC::MaxNativeBruteForceSize variables and by QPBO-I 
+/// otherwise if Parameter::planarFallback_ is set, and planar_ is rejected
+/// if it is not (default), i.e. the approximation has to be requested. In the cut move, the regions which are to be split are
+/// solved in parallel, in the glue move, pairs of regions which have no 
+/// region in common (WITH_OPENMP).
+///
 template<class GM, class ACC>
 class CGC : public Inference<GM, ACC>
 {
@@ -133,6 +146,7 @@ public:
    typedef PottsFunction<ValueType,IndexType,LabelType> PfType;
 
    typedef  GraphicalModel<ValueType, Adder, PfType , typename GM::SpaceType> PottsGmType;
+   typedef SubmodelCGC<PottsGmType> SubmodelType;
 
    class Parameter {
    public:
@@ -143,7 +157,9 @@ public:
          const double threshold      = 0.0, 
          const bool startFromThreshold = true,
          const bool doCutMove = true,
-         const bool doGlueCutMove = true
+         const bool doGlueCutMove = true,
+         const size_t numberOfThreads = 0,
+         const bool planarFallback = false
       ):
          planar_(planar),
          maxIterations_(maxIterations),
@@ -151,7 +167,9 @@ public:
          threshold_(threshold),
          startFromThreshold_(startFromThreshold),
          doCutMove_(doCutMove),
-         doGlueCutMove_(doGlueCutMove_)
+         doGlueCutMove_(doGlueCutMove),
+         numberOfThreads_(numberOfThreads),
+         planarFallback_(planarFallback)
       {}
       
       bool planar_;
@@ -161,6 +179,12 @@ public:
       bool startFromThreshold_;
       bool doCutMove_;
       bool doGlueCutMove_;
+      /// threads of the cut and glue moves (0: OpenMP default)
+      size_t numberOfThreads_;
+      /// solve planar submodels by enumeration and QPBO-I if the external
+      /// planar max-cut is not available, otherwise planar_ is rejected
+      /// (default: false)
+      bool planarFallback_;
 
 
 
@@ -191,7 +215,9 @@ public:
 
 
    ~CGC(){
-      delete submodel_;
+      for(size_t t=0;t<submodels_.size();++t){
+         delete submodels_[t];
+      }
    }
 
 
@@ -222,6 +248,8 @@ public:
    template<class VISITOR>
    void greedy2ColoringPlanar(VISITOR & visitor);
 
+   int setUpSubmodels();
+
 
    const GraphicalModelType& gmRaw_;
 
@@ -231,7 +259,8 @@ public:
 
    std::vector<ValueType> lambdas_;
 
-   SubmodelCGC<PottsGmType> * submodel_;
+   // one submodel per thread
+   std::vector<SubmodelType *> submodels_;
 
    // redundant data for easy readability
    IndexType numVar_;
@@ -291,6 +320,11 @@ CGC<GM, ACC>::CGC
    timeout_(false)
    //dirtyFactors_(gm_.numberOfFactors(),1))
 {
+#if !(defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY))
+   if(param_.planar_ && !param_.planarFallback_){
+      throw RuntimeError("CGC: the planar max-cut requires WITH_BLOSSOM5 and WITH_PLANARITY, set planarFallback_ or unset planar_.");
+   }
+#endif
    //////////////////////////////////////
    // find all double edges
    ///////////////////////////////////////// 
@@ -340,7 +374,7 @@ CGC<GM, ACC>::CGC
    // gm_ is set up
    //lambdas_(gm.numberOfFactors()),
    //submodel_ = new SubmodelCGC<PottsGmType>(gm_,3,1,false);
-   submodel_ = new SubmodelCGC<PottsGmType>(gm_,0,0,false);
+   submodels_.push_back(new SubmodelType(gm_,0,0,true));
 
    // set up lambdas 
    for(IndexType f=0;f<numDualVar_;++f){
@@ -411,36 +445,54 @@ CGC<GM, ACC>::recursive2Coloring(VISITOR & visitor){
 
    // set starting point will set up all invariants
    const LabelType numCCsStart=this->setStartingPointFromArgPrimal(true);
-   
-
+   const int numberOfThreads = this->setUpSubmodels();
+
+   // while there are subsets to cut in deque.
+   // the ccs in the deque have distinct colors, they are solved in parallel
+   // and written back in the order of the deque, as one after another
+   std::vector<IndexType> batch;
+   std::vector<typename SubmodelType::TwoSubsetsResult> results;
+   while(!toSplit_.empty() && timeout_==false){
+      batch.assign(toSplit_.begin(),toSplit_.end());
+      toSplit_.clear();
+      if(results.size()<batch.size()){
+         results.resize(batch.size());
+      }
 
-   // while there are subsets to cut in deque
-   while(!toSplit_.empty()){
+      // infer cc  / all variables which have the color of the 
+      // example variable 
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads)
+      #endif
+      for(std::ptrdiff_t b=0;b<static_cast<std::ptrdiff_t>(batch.size());++b){
+         #ifdef WITH_OPENMP
+         SubmodelType & submodel = *submodels_[omp_get_thread_num()];
+         #else
+         SubmodelType & submodel = *submodels_[0];
+         #endif
+         const IndexType exampleVariableInCC = batch[b];
+         submodel.inferSubset(argPrimal_,argPrimal_[exampleVariableInCC],exampleVariableInCC,param_.planar_,results[b]);
+      }
 
-      
-      // get an example variable of an cc and 
-      // the "color" of all variables which are in cc
-      const LabelType exampleVariableInCC = toSplit_.front();
-      toSplit_.pop_front();
-      const LabelType ccColor = argPrimal_[exampleVariableInCC];
-
-      // infer cc  / all variables which have ccColor 
-      // the result of inference is writte in self.argPrimal via call by reference 
-      IVPairType res = submodel_->inferSubset(argPrimal_,ccColor,exampleVariableInCC,maxColor_+1,toSplit_,param_.planar_, false /*debug*/);
-      const int         numCCArg       = res.first;
-      const ValueType value2Coloring   = res.second;
-
-      // the 2 coloring on the cc can split the cc in "numCCArg" connected comps
-      // and if numCCArg is 1 this means cc can't be splitted any more
-      // otherwise we need to add an exampe var for each result cc to the deque
-      if(numCCArg>1){
-         // increment the maximum color which is in arg Primal
-         maxColor_ += numCCArg+1;
-         // update current best value
-         value_    += value2Coloring;
-         if(visitor(*this)!=0){
-            timeout_ = true;
-            break;
+      for(size_t b=0;b<batch.size();++b){
+         const typename SubmodelType::TwoSubsetsResult & res = results[b];
+         const int         numCCArg       = res.numCC_;
+         const ValueType value2Coloring   = res.value_;
+
+         // the 2 coloring on the cc can split the cc in "numCCArg" connected comps
+         // and if numCCArg is 1 this means cc can't be splitted any more
+         // otherwise we need to add an exampe var for each result cc to the deque
+         if(numCCArg>1){
+            res.writeBack(argPrimal_,maxColor_+1);
+            res.representatives(toSplit_);
+            // increment the maximum color which is in arg Primal
+            maxColor_ += numCCArg+1;
+            // update current best value
+            value_    += value2Coloring;
+            if(visitor(*this)!=0){
+               timeout_ = true;
+               break;
+            }
          }
       }
    }   
@@ -477,6 +529,7 @@ CGC<GM, ACC>::greedy2ColoringPlanar(VISITOR & visitor){
          dirtyFactors_[fi]=1;
    }
 
+   const int numberOfThreads = this->setUpSubmodels();
 
    while(changes && timeout_==false){
       changes=false;
@@ -503,69 +556,95 @@ CGC<GM, ACC>::greedy2ColoringPlanar(VISITOR & visitor){
       }
 
       // get 2 adj. connect comp , merge them and try to
-      // reoptimize them with colorings
+      // reoptimize them with colorings.
+      // pairs of ccs which have no cc in common are independent, they
+      // are solved in parallel and written back in the order of the map 
+      std::vector<IndexType> pending;
+      pending.reserve(factorCCs.size());
       for(MapIter iter=factorCCs.begin();iter!=factorCCs.end();++iter){
-         const IndexType fi = iter->second;
-         if(param_.useBookkeeping_==false ||  dirtyFactors_[fi] == 1 ){
-
-            //std::cout<<" fi dirty ? "<<bool(dirtyFactors[fi])<<" \n";
+         pending.push_back(iter->second);
+      }
+      std::vector<IndexType> deferred;
+      std::vector<IndexType> batch;
+      std::vector<typename SubmodelType::TwoSubsetsResult> results;
+      std::set<LabelType> usedColors;
+      while(!pending.empty() && timeout_==false){
+         batch.clear();
+         deferred.clear();
+         usedColors.clear();
+         for(size_t p=0;p<pending.size();++p){
+            const IndexType fi = pending[p];
+            if(param_.useBookkeeping_==true &&  dirtyFactors_[fi] != 1 ){
+               continue;
+            }
             const LabelType c0 = argPrimal_[ gm_[fi].variableIndex(0) ];
             const LabelType c1 = argPrimal_[ gm_[fi].variableIndex(1) ];
+            // not active any more
+            if(c0==c1){
+               continue;
+            }
+            if(usedColors.find(c0)!=usedColors.end() || usedColors.find(c1)!=usedColors.end()){
+               deferred.push_back(fi);
+            }
+            else{
+               usedColors.insert(c0);
+               usedColors.insert(c1);
+               batch.push_back(fi);
+            }
+         }
+         pending.swap(deferred);
+         if(results.size()<batch.size()){
+            results.resize(batch.size());
+         }
 
-            // infer by merging and resplitting
-            if(c0!=c1){
-               //std::cout<<"infer 2 subsets \n\n";
-               IVPairType res = submodel_->infer2Subsets(
-                  argPrimal_,c0,c1,
-                  gm_[fi].variableIndex(0),gm_[fi].variableIndex(1),
-                  maxColor_+1,
-                  param_.planar_
-               );
-               const int numCCArg               = res.first;
-               const ValueType value2Coloring = res.second;
-               /*
-               if(numCCArg==-1):
-                   print " one var problem"
-               
-                   print " no improvement"
-               elif(numCCArg==-3):
-                   print " OPT CUT"
-               */
-               if(numCCArg==0){
-                  //std::cout<<"zeros ccs\n";
-                  OPENGM_CHECK(false,"internal error");
-               }
-               // no improvment 
-               else if(numCCArg==-2){
-                  //std::cout<<" NO improvement\n\n\n";
-                  if(param_.useBookkeeping_)
-                     submodel_->updateDirtyness(dirtyFactors_,false);
-                    //submodel_->cleanInsideAndBorder();
+         // infer by merging and resplitting
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads)
+         #endif
+         for(std::ptrdiff_t b=0;b<static_cast<std::ptrdiff_t>(batch.size());++b){
+            #ifdef WITH_OPENMP
+            SubmodelType & submodel = *submodels_[omp_get_thread_num()];
+            #else
+            SubmodelType & submodel = *submodels_[0];
+            #endif
+            const IndexType fi = batch[b];
+            const IndexType vi0 = gm_[fi].variableIndex(0);
+            const IndexType vi1 = gm_[fi].variableIndex(1);
+            submodel.infer2Subsets(
+               argPrimal_,argPrimal_[vi0],argPrimal_[vi1],
+               vi0,vi1,
+               param_.planar_,
+               results[b]
+            );
+         }
+
+         for(size_t b=0;b<batch.size();++b){
+            const typename SubmodelType::TwoSubsetsResult & res = results[b];
+            const int numCCArg             = res.numCC_;
+            const ValueType value2Coloring = res.value_;
+            if(numCCArg==0){
+               OPENGM_CHECK(false,"internal error");
+            }
+            // no improvment 
+            else if(numCCArg==-2){
+               if(param_.useBookkeeping_)
+                  res.updateDirtyness(dirtyFactors_,false);
+            }
+            else if(numCCArg>=1){
+               changes=true;
+               res.writeBack(argPrimal_,maxColor_+1);
+               maxColor_+=numCCArg+1;
+               value_+=value2Coloring;
+               if(param_.useBookkeeping_){
+                  res.updateDirtyness(dirtyFactors_,true);
                }
-               else if(numCCArg>=1){
-                  //OPENGM_CHECK_OP(value2Coloring,<=,0.0,"internal error");
-                  //if(numCCArg==1){
-                     //OPENGM_CHECK_OP(argPrimal_[gm_[fi].variableIndex(0)],==,argPrimal_[gm_[fi].variableIndex(1)], "internal error");
-                  //}
-                  changes=true;
-                  maxColor_+=numCCArg+1;
-                  value_+=value2Coloring;
-                  if(param_.useBookkeeping_){
-                     submodel_->updateDirtyness(dirtyFactors_,true);
-                     //submodel_->cleanInsideAndBorder();
-                  }
-                 
-                  if(visitor(*this)!=0){
-                     timeout_ = true;
-                     break;
-                  }
+               if(visitor(*this)!=0){
+                  timeout_ = true;
+                  break;
                }
-               submodel_->cleanInsideAndBorder();
-            } // if still active
-         } // if dirty
-         else{
+            }
          }
-      } // for all factors
+      } // while pairs are pending
    } // while changes...
 
    inRecursive2Coloring_=false;
@@ -576,6 +655,22 @@ CGC<GM, ACC>::greedy2ColoringPlanar(VISITOR & visitor){
      
 
 
+/// one submodel per thread of the cut and glue moves
+/// \return number of threads
+template<class GM, class ACC>
+inline int
+CGC<GM, ACC>::setUpSubmodels(){
+   #ifdef WITH_OPENMP
+   const int numberOfThreads = param_.numberOfThreads_ > 0 ? static_cast<int>(param_.numberOfThreads_) : omp_get_max_threads();
+   #else
+   const int numberOfThreads = 1;
+   #endif
+   while(submodels_.size() < static_cast<size_t>(numberOfThreads)){
+      submodels_.push_back(new SubmodelType(gm_,0,0,true));
+   }
+   return numberOfThreads;
+}
+
 template<class GM, class ACC>
 inline void
 CGC<GM, ACC>::reset(){
@@ -2,22 +2,20 @@
 #define OPENGM_HMC_SUBMODEL2
 
 #include <deque>
-
-#include <boost/format.hpp>
-#include <boost/unordered_map.hpp>
+#include <vector>
+#include <algorithm>
+#include <iostream>
 
 #ifdef WITH_CPLEX
 #include <opengm/inference/multicut.hxx>
 #endif
-#ifdef WITH_QPBO
-#include "QPBO.h"
-#endif
 
 #if defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY)
 #include <opengm/inference/auxiliary/planar_maxcut.hxx>
 #endif
 #include <opengm/opengm.hxx>
 #include <opengm/utilities/timer.hxx>
+#include <opengm/inference/auxiliary/qpbo_graph.hxx>
 
 
 #undef OPENGM_CHECK_OP
@@ -44,16 +42,62 @@ public:
 
     typedef std::pair<int,ValueType> IVPairType;
 
-    // set up map from node pair to edge index
-    typedef std::pair<size_t,size_t>          Edge;
-    typedef std::pair<Edge, size_t>           EdgeMapEntry;
-    typedef boost::unordered_map<Edge,size_t> EdgeMap;
-    
     enum Mode {
         SingleSubset,
         TwoSubsets
     };
 
+    // largest submodel solved by enumeration if the external planar max-cut is not available
+    enum { MaxNativeBruteForceSize = 10 };
+
+    /**
+     * Result of inferSubset and infer2Subsets. The global labeling is not
+     * changed by inferSubset and infer2Subsets such that several submodels
+     * with distinct colors can be solved concurrently from the same global
+     * labeling and the results are written back one after another.
+     *
+     * numCC_:     number of connected components of the submodel 
+     *             (-1: single variable, -2: no improvement)
+     * value_:     change of the energy
+     * globalVis_: variables of the submodel
+     * ccLabels_:  connected component in [0, numCC_) of each variable
+     * insideFactors_, borderFactors_, lastNCC_: bookkeeping of infer2Subsets
+     */
+    class TwoSubsetsResult {
+    public:
+        TwoSubsetsResult() : numCC_(-1), value_(0.0), lastNCC_(0) {}
+
+        template<class ARG>
+        void writeBack(ARG & globalArg, const IndexType offset) const {
+            for(IndexType i=0;i<globalVis_.size();++i){
+                globalArg[globalVis_[i]]=ccLabels_[i]+offset;
+            }
+        }
+        // a variable of each connected component, in the order of the components
+        void representatives(std::deque<IndexType> & deque) const {
+            IndexVector exampleForCC(numCC_);
+            for(IndexType i=0;i<globalVis_.size();++i){
+                exampleForCC[ccLabels_[i]]=globalVis_[i];
+            }
+            deque.insert(deque.end(),exampleForCC.begin(),exampleForCC.end());
+        }
+        void updateDirtyness(std::vector<unsigned char>& dirtyFactors, const bool changes) const {
+            SubmodelCGC<GM>::updateDirtyness(
+                insideFactors_, static_cast<IndexType>(insideFactors_.size()),
+                borderFactors_, static_cast<IndexType>(borderFactors_.size()),
+                lastNCC_, dirtyFactors, changes
+            );
+        }
+
+        int numCC_;
+        ValueType value_;
+        IndexVector globalVis_;
+        LabelVector ccLabels_;
+        IndexVector insideFactors_;
+        IndexVector borderFactors_;
+        IndexType lastNCC_;
+    };
+
     // constructor from graphical model
     SubmodelCGC(const GM & gm,const IndexType maxBruteForceSize2,const IndexType maxBruteForceSize4,const bool useBfs);
 
@@ -68,39 +112,36 @@ public:
     ValueType inferBruteForce4();
    
     /**
-     * globalArg: length #nodes of full model
+     * globalArg: length #nodes of full model (not changed)
      * colorCC:   color of CC for which we want to run inference
-     * offset:    needed to disambiguate colors w.r.t. rest of the nodes
-     * deque:     After running infer, the region decomposes into N connected components.
-     *            Then, deque.size() += N, and deque[prevSize()+i]
-     *            is a representative node label of connected component i
+     * result:    value of the 2-coloring and the connected components into
+     *            which the region decomposes, see TwoSubsetsResult
      */
     template<class ARG>
-    IVPairType inferSubset(
-        ARG & globalArg,
+    void inferSubset(
+        const ARG & globalArg,
         const LabelType colorCC,
         const IndexType viCC,
-        IndexType offset,
-        std::deque<IndexType> & deque,
         const bool planar,
-        bool verbose = false
+        TwoSubsetsResult & result
     );
 
     /**
-     * globalArg: length #nodes of full model
+     * globalArg: length #nodes of full model (not changed)
      * colorCC0,  color of two neighboring CCs for which we want to run inference again
      * colorCC1
-     * offset:    needed to disambiguate colors w.r.t. rest of the nodes
+     * result:    new connected components and factors of the submodel, 
+     *            see TwoSubsetsResult
      */
     template<class ARG>
-    IVPairType infer2Subsets(
-        ARG & globalArg,
+    void infer2Subsets(
+        const ARG & globalArg,
         const LabelType colorCC0,
         const LabelType colorCC1,
         const IndexType viCC0,
         const IndexType viCC1,
-        IndexType offset,
-        const bool planar=true
+        const bool planar,
+        TwoSubsetsResult & result
     );
     
 
@@ -113,6 +154,8 @@ public:
      * 
      * dirtyFactors: current dirtyness per factor (global)
      * 
+     * insideFactors, borderFactors: factors of the submodel (see TwoSubsetsResult)
+     * 
      * This function updates dirtyFactors according to this:
      * 
      * - if a factor's variables are both in the subgraph, mark this factor as clean 
@@ -121,40 +164,43 @@ public:
      *   - if no changes, do not change dirtyness
      * 
      */
-    void updateDirtyness(std::vector<unsigned char>& dirtyFactors, const bool changes){
-        OPENGM_CHECK_OP(dirtyFactors.size(),==,gm_.numberOfFactors(), " ");
-
-        OPENGM_CHECK_OP(nInsideFactors_,>,0, " ");
-        OPENGM_CHECK_OP(nBorderFactors_,>,0, " ");
+    static void updateDirtyness(
+        const IndexVector & insideFactors, const IndexType nInsideFactors,
+        const IndexVector & borderFactors, const IndexType nBorderFactors,
+        const IndexType lastNCC,
+        std::vector<unsigned char>& dirtyFactors, const bool changes
+    ){
+        OPENGM_CHECK_OP(nInsideFactors,>,0, " ");
+        OPENGM_CHECK_OP(nBorderFactors,>,0, " ");
 
         // make inside undirty if there are no changes
         if(!changes){
-            for(IndexType f=0;f<nInsideFactors_;++f){
-                if(dirtyFactors[insideFactors_[f]] == 2) {
+            for(IndexType f=0;f<nInsideFactors;++f){
+                if(dirtyFactors[insideFactors[f]] == 2) {
                     OPENGM_CHECK(false, "shouldn't happen");
                 }
-                dirtyFactors[insideFactors_[f]] = 0;
+                dirtyFactors[insideFactors[f]] = 0;
             }
         }
         // if there are improvements 
         else{
 
             // mark inside as clean and border as dirty
-            if(lastNCC_<=2){
+            if(lastNCC<=2){
 
                 // inside to clean
-                for(IndexType f=0;f<nInsideFactors_;++f){
-                    if(dirtyFactors[insideFactors_[f]] == 2) {
+                for(IndexType f=0;f<nInsideFactors;++f){
+                    if(dirtyFactors[insideFactors[f]] == 2) {
                         OPENGM_CHECK(false, "shouldn't happen");
                     }
-                    dirtyFactors[insideFactors_[f]] = 0;
+                    dirtyFactors[insideFactors[f]] = 0;
                 }
                 // border to dirty
-                for(IndexType f=0;f<nBorderFactors_;++f){
-                    if(dirtyFactors[borderFactor_[f]] == 2) {
+                for(IndexType f=0;f<nBorderFactors;++f){
+                    if(dirtyFactors[borderFactors[f]] == 2) {
                         continue;
                     }
-                    dirtyFactors[borderFactor_[f]] = 1;
+                    dirtyFactors[borderFactors[f]] = 1;
                 }
 
             }
@@ -162,45 +208,40 @@ public:
             // mark inside and border as diry
             else{
                 //std::cout<<"\n\n\n\n\n    JOOOO \n\n\n";
-                for(IndexType f=0;f<nInsideFactors_;++f){
-                    if(dirtyFactors[insideFactors_[f]] == 2) {
+                for(IndexType f=0;f<nInsideFactors;++f){
+                    if(dirtyFactors[insideFactors[f]] == 2) {
                         OPENGM_CHECK(false, "shouldn't happen");
                     }
-                    dirtyFactors[insideFactors_[f]] = 1;
+                    dirtyFactors[insideFactors[f]] = 1;
                 }
-                for(IndexType f=0;f<nBorderFactors_;++f){
-                    if(dirtyFactors[borderFactor_[f]] == 2) {
+                for(IndexType f=0;f<nBorderFactors;++f){
+                    if(dirtyFactors[borderFactors[f]] == 2) {
                         continue;
                     }
-                    dirtyFactors[borderFactor_[f]] = 1;
+                    dirtyFactors[borderFactors[f]] = 1;
                 }
             }
         }
 
 
         /*
-        for(IndexType f=0;f<nInsideFactors_;++f){
-            if(dirtyFactors[insideFactors_[f]] == 2) {
+        for(IndexType f=0;f<nInsideFactors;++f){
+            if(dirtyFactors[insideFactors[f]] == 2) {
                 OPENGM_CHECK(false, "shouldn't happen");
             }
-            dirtyFactors[insideFactors_[f]] = 0;
+            dirtyFactors[insideFactors[f]] = 0;
         }
         if(changes){
-            for(IndexType f=0;f<nBorderFactors_;++f){
-                if(dirtyFactors[borderFactor_[f]] == 2) {
+            for(IndexType f=0;f<nBorderFactors;++f){
+                if(dirtyFactors[borderFactors[f]] == 2) {
                     continue;
                 }
-                dirtyFactors[borderFactor_[f]] = 1;
+                dirtyFactors[borderFactors[f]] = 1;
             }
         }
         */
     }
 
-    void cleanInsideAndBorder(){
-        nInsideFactors_=0;
-        nBorderFactors_=0;
-    }
-
 private:
     
     /**
@@ -276,9 +317,6 @@ private:
     IndexType numSubVar_;
     IndexType numSubFactors_;
 
-    // sub edge map
-    EdgeMap localEdgemap_;
-
     // parameters
     IndexType maxBruteForceSize2_;
     IndexType maxBruteForceSize4_;
@@ -302,18 +340,22 @@ private:
 
 template<class GM>
 template<class ARG>
-typename SubmodelCGC<GM>::IVPairType 
+void
 SubmodelCGC<GM>::infer2Subsets(
-    ARG & globalArg,
+    const ARG & globalArg,
     typename SubmodelCGC<GM>::LabelType colorCC0,
     typename SubmodelCGC<GM>::LabelType colorCC1,
     const typename SubmodelCGC<GM>::IndexType  viCC0,
     const typename SubmodelCGC<GM>::IndexType  viCC1,
-    typename SubmodelCGC<GM>::IndexType offset,
-    const bool planar
+    const bool planar,
+    typename SubmodelCGC<GM>::TwoSubsetsResult & result
 ){
 
     OPENGM_CHECK_OP(colorCC0,!=,colorCC1,"must be different colors");
+    result.globalVis_.clear();
+    result.ccLabels_.clear();
+    result.insideFactors_.clear();
+    result.borderFactors_.clear();
 
     //std::cout<<"set up sub var \n";
     if(useBfs_){
@@ -324,15 +366,14 @@ SubmodelCGC<GM>::infer2Subsets(
     }
     if(numSubVar_<=1){
         this->unsetSubVar();
-        return IVPairType(-1,0.0);
+        result.numCC_=-1;
+        result.value_=0.0;
+        return;
     }
     //std::cout<<"set up sub factors \n";
     this->setUpSubFactors();
-
-    if(false && isOptCut_==true){
-        this->unsetSubVar();
-        return IVPairType(-3,oldCutValue_);
-    }
+    result.insideFactors_.assign(insideFactors_.begin(),insideFactors_.begin()+nInsideFactors_);
+    result.borderFactors_.assign(borderFactor_.begin(),borderFactor_.begin()+nBorderFactors_);
 
     ValueType valueOfArg=0.0;
     if(numSubVar_<= maxBruteForceSize2_ && planar==true){
@@ -343,10 +384,6 @@ SubmodelCGC<GM>::infer2Subsets(
             valueOfArg=this->inferBruteForce2();
     }
     else if(planar==true){
-        OPENGM_CHECK(planar,"");
-        //this->getEmbeddingGraph();
-        //valueOfArg=this->inferIsInf();
-        //this->freeEmbeddingGraph();
         valueOfArg = this->inferPlanarMaxCut();
     }
     else{
@@ -356,65 +393,40 @@ SubmodelCGC<GM>::infer2Subsets(
     }
 
     OPENGM_CHECK(greedyMode_," ");
-    if(oldCutValue_<valueOfArg){
-        //std::cout<<"we are worse or equal same..."<<valueOfArg <<" old "<<oldCutValue_<<"\n";
-
-        //std::cout<<"no improvement \n";
-        this->unsetSubVar();
-        return IVPairType(-2,oldCutValue_);
-    }
-    else if(valueOfArg+0.0000001<oldCutValue_){
-        //std::cout<<"better....\n";
-        //std::cout<<" old "<<oldCutValue_<<"\n";
-        //std::cout<<" new "<<valueOfArg<<"\n";
- 
-    }
-    else{
-        //std::cout<<"same....\n";
-        //std::cout<<" old "<<oldCutValue_<<"\n";
-        //std::cout<<" new "<<valueOfArg<<"\n";
+    // no improvement if we are worse or the same
+    if(!(valueOfArg+0.0000001<oldCutValue_)){
         this->unsetSubVar();
-        return IVPairType(-2,oldCutValue_);
+        result.numCC_=-2;
+        result.value_=oldCutValue_;
+        return;
     }
 
-    
-    //std::cout<<"get ccs \n";
     // infer local probel and get cc's
-    IndexType numCC = this->ccFromLocalArg(offset);
+    const IndexType numCC = this->ccFromLocalArg(0);
     lastNCC_ = numCC; //remember for later
-    //std::cout<<"write back -- offset is "<<offset<<"\n";
-
-    std::vector<IndexType> exampleForCC(numCC);
-
-    // write back to global arg
-    for(IndexType localVi=0;localVi<numSubVar_;++localVi){
-        const LabelType ccLabel  = localArg_[localVi];
-        const IndexType globalVi = subVarToGlobal_[localVi];
-        OPENGM_CHECK_OP(ccLabel-offset,<,numCC," ");
-        exampleForCC[ccLabel-offset]=globalVi;
-        globalArg[globalVi]=ccLabel;
-    }
+    result.lastNCC_ = numCC;
+    result.numCC_ = static_cast<int>(numCC);
+    result.value_ = valueOfArg-oldCutValue_;
+    result.globalVis_.assign(subVarToGlobal_.begin(),subVarToGlobal_.begin()+numSubVar_);
+    result.ccLabels_.assign(localArg_.begin(),localArg_.begin()+numSubVar_);
 
     // free stuff and unset variables
     this->unsetSubVar();
-    return IVPairType(numCC,valueOfArg-oldCutValue_);
-    //return boost::python::make_tuple(numCC,valueOfArg-oldCutValue_);
 }
 
 
 template<class GM>
 template<class ARG>
-typename SubmodelCGC<GM>::IVPairType
+void
 SubmodelCGC<GM>::inferSubset(
-    ARG                                          &  globalArg,
+    const ARG                                    &  globalArg,
     typename SubmodelCGC<GM>::LabelType                colorCC,
     typename SubmodelCGC<GM>::IndexType                 viCC,
-    typename SubmodelCGC<GM>::IndexType                 offset,
-    std::deque<typename SubmodelCGC<GM>::IndexType> &     deque,
     const bool planar,
-    bool verbose
+    typename SubmodelCGC<GM>::TwoSubsetsResult & result
 ){
-    using boost::format;
+    result.globalVis_.clear();
+    result.ccLabels_.clear();
 
     // set up local problem
     if(useBfs_){
@@ -424,13 +436,11 @@ SubmodelCGC<GM>::inferSubset(
         this->setSubVarImplicit(globalArg,colorCC,viCC);
     }
     
-    if(verbose) {
-        std::cout << format("    inferSubset with %d variables") % numSubVar_ << std::endl;
-    }
-    
     if(numSubVar_<=1){
         this->unsetSubVar();
-        return IVPairType(-1.0,0.0);
+        result.numCC_=-1;
+        result.value_=0.0;
+        return;
     }
     //std::cout<<"set up sub factors \n";
     this->setUpSubFactors();
@@ -458,33 +468,16 @@ SubmodelCGC<GM>::inferSubset(
     
     //std::cout<<"get ccs \n";
     // infer local probel and get cc's
-    IndexType numCC = this->ccFromLocalArg(offset);
-
-    //std::cout<<"write back -- offset is "<<offset<<"\n";
-
-    std::vector<IndexType> exampleForCC(numCC);
-
+    const IndexType numCC = this->ccFromLocalArg(0);
+    result.numCC_ = static_cast<int>(numCC);
+    result.value_ = valueOfArg;
     if(numCC>1){
-        // write back to global arg
-        for(IndexType localVi=0;localVi<numSubVar_;++localVi){
-            const LabelType ccLabel  = localArg_[localVi];
-            const IndexType globalVi = subVarToGlobal_[localVi];
-            OPENGM_CHECK_OP(ccLabel-offset,<,numCC," ");
-            exampleForCC[ccLabel-offset]=globalVi;
-            globalArg[globalVi]=ccLabel;
-        }
-        
-        if(true){
-            for(size_t i=0;i<exampleForCC.size();++i){
-                deque.push_back(exampleForCC[i]);
-            }
-        }
+        result.globalVis_.assign(subVarToGlobal_.begin(),subVarToGlobal_.begin()+numSubVar_);
+        result.ccLabels_.assign(localArg_.begin(),localArg_.begin()+numSubVar_);
     }
 
     // free stuff and unset variables
     this->unsetSubVar();
-    return IVPairType(numCC,valueOfArg);
-
 }
 
 template<class GM>
@@ -516,17 +509,35 @@ void SubmodelCGC<GM>::setSubVarImplicitBfs(
     const typename SubmodelCGC<GM>::IndexType vi
 ){
     greedyMode_=false;
-    IndexType viLocal=0;
-    for(IndexType viGlobal=0;viGlobal<gm_.numberOfVariables();++viGlobal){
-        if(arg[viGlobal]==ccColor){
-            subVarToGlobal_[viLocal]=viGlobal;
-            globalVarToLocal_[viGlobal]=viLocal;
-            OPENGM_CHECK_OP(incluedGlobalVar_[viGlobal],==,0,"internal inconsistency");
-            incluedGlobalVar_[viGlobal]=1;
-            ++viLocal;
+
+    // the variables of a color are connected, 
+    // they are found by a search from vi
+    IndexType ssize = 1;
+    stack_[0]=vi;
+    subVarToGlobal_[0]=vi;
+    incluedGlobalVar_[vi]=1;
+    numSubVar_=1;
+
+    while(ssize>0){
+        const IndexType svi=stack_[ssize-1];
+        --ssize;
+        for(IndexType n=0;n<visAdj_[svi].size();++n){
+            const IndexType nvi =  visAdj_[svi][n];
+            if(incluedGlobalVar_[nvi]==0 && arg[nvi]==ccColor){
+                incluedGlobalVar_[nvi]=1;
+                // need to be sorted later
+                subVarToGlobal_[numSubVar_]=nvi;
+                ++numSubVar_;
+                stack_[ssize]=nvi;
+                ++ssize;
+            }
         }
     }
-    numSubVar_=viLocal;
+
+    std::sort(subVarToGlobal_.begin(),subVarToGlobal_.begin()+numSubVar_);
+    for(IndexType lvi=0;lvi<numSubVar_;++lvi){
+        globalVarToLocal_[subVarToGlobal_[lvi]]=lvi;
+    }
 }
 
 
@@ -658,7 +669,6 @@ inline SubmodelCGC<GM>::SubmodelCGC(
     nBorderFactors_(0),
     numSubVar_(0),
     numSubFactors_(0),
-    localEdgemap_(),
     maxBruteForceSize2_(0),//maxBruteForceSize2<4 ? 4 : maxBruteForceSize2),
     maxBruteForceSize4_(0)//maxBruteForceSize4<4 ? 4 : maxBruteForceSize4)
 { 
@@ -764,28 +774,34 @@ template<class GM>
 typename SubmodelCGC<GM>::ValueType SubmodelCGC<GM>::inferQPBOI(
     Mode mode
 ){  
-#ifdef WITH_QPBO
    typedef double REAL;
-   typedef typename  kolmogorov::qpbo::QPBO<REAL>::NodeId NodeId;
-   typedef typename  kolmogorov::qpbo::QPBO<REAL>::EdgeId EdgeId;
-   typedef typename  kolmogorov::qpbo::QPBO<REAL>::ProbeOptions ProbeOptions;
-                 
-   kolmogorov::qpbo::QPBO<REAL>* qpbo = new kolmogorov::qpbo::QPBO<REAL>(numSubVar_, numSubFactors_); // construct with an error message function
-   qpbo->AddNode(numSubVar_);
-   qpbo->AddUnaryTerm(0, 0.0, 10000000.0);
+   typedef opengm::QPBOGraph<REAL> QPBOType;
+   typedef typename QPBOType::NodeId NodeId;
+
+   QPBOType qpbo(numSubVar_, numSubFactors_);
+   qpbo.AddNode(numSubVar_);
+   qpbo.AddUnaryTerm(0, 0.0, 10000000.0);
    for(size_t i=0; i<numSubFactors_; ++i){
-      qpbo->AddPairwiseTerm( (NodeId)localFactorVis_(i,0), (NodeId)localFactorVis_(i,1),    (REAL)0.0, (REAL)localLambdas_[i],(REAL)localLambdas_[i],(REAL)0.0 );
+      qpbo.AddPairwiseTerm( (NodeId)localFactorVis_(i,0), (NodeId)localFactorVis_(i,1),    (REAL)0.0, (REAL)localLambdas_[i],(REAL)localLambdas_[i],(REAL)0.0 );
    }
-   qpbo->MergeParallelEdges(); 
    for(size_t i=0; i < numSubVar_ ; ++i)
-      qpbo->SetLabel(i, 0);
+      qpbo.SetLabel(i, 0);
 
-   srand( 42 );
-   qpbo->Improve();
+   // random order of QPBO-I with a fixed seed, rand() is not used
+   // since submodels are solved concurrently by CGC
+   std::vector<int> order(numSubVar_);
+   opengm::UInt64Type state = 42;
+   for(size_t i=0; i < numSubVar_ ; ++i)
+      order[i] = static_cast<int>(i);
+   for(size_t i=numSubVar_; i > 1 ; --i){
+      state = (state * 1103515245 + 12345) % 2147483648u;
+      std::swap(order[i-1], order[static_cast<size_t>((state >> 8) % i)]);
+   }
+   qpbo.Improve(static_cast<int>(numSubVar_), &order[0]);
    
    // get the labels
    for ( size_t i=0; i < numSubVar_ ; ++i ) {
-      localArg_[i] = qpbo->GetLabel(i);
+      localArg_[i] = qpbo.GetLabel(i);
    }            
 
    ValueType value=0;
@@ -795,17 +811,13 @@ typename SubmodelCGC<GM>::ValueType SubmodelCGC<GM>::inferQPBOI(
       if(localArg_[localVi0]!=localArg_[localVi1])
          value+=localLambdas_[fiLocal];
    }
-   delete qpbo;
    return value;
-#else
-   throw opengm::RuntimeError("inferQPBOI needs WITH_QPBO");
-   return 0.0;
-#endif
-  
-  
 }
 
 
+/// planar max-cut of the submodel (Blossom V on the planar embedding),
+/// without the external code small submodels are solved by enumeration 
+/// and larger ones by QPBO-I
 template<class GM>
 typename SubmodelCGC<GM>::ValueType SubmodelCGC<GM>::inferPlanarMaxCut(
 
@@ -828,8 +840,10 @@ typename SubmodelCGC<GM>::ValueType SubmodelCGC<GM>::inferPlanarMaxCut(
     }
     return value;
 #else
-   throw opengm::RuntimeError("inferPlanarMaxCut needs WITH_BLOSSOM5 and WITH_PLANARITY");
-   return 0.0;
+    if(numSubVar_<=MaxNativeBruteForceSize){
+        return this->inferBruteForce2();
+    }
+    return this->inferQPBOI(greedyMode_ ? TwoSubsets : SingleSubset);
 #endif
 }
 
@@ -841,14 +855,14 @@ typename GM::ValueType SubmodelCGC<GM>::inferBruteForce2(){
     // INFER
     ValueType bestVal=0.0;
     const opengm::UInt64Type numFlipVar=numSubVar_-1;
-    const opengm::UInt64Type numConfig=2^numFlipVar;
+    const opengm::UInt64Type numConfig=opengm::UInt64Type(1)<<numFlipVar;
     localArgTest_[0]=0;
     std::fill(localArgTest_.begin(),localArgTest_.begin()+numSubVar_,0);
     std::fill(localArg_.begin()    ,localArg_.begin()+numSubVar_,0);
     for ( opengm::UInt64Type i = 0 ; i < numConfig ; i++ ){
 
         for ( opengm::UInt64Type j = 0 ; j < numFlipVar ; j++ ){
-            localArgTest_[j+1] = static_cast<opengm::UInt64Type>(bool( i & (1 << j) ));
+            localArgTest_[j+1] = static_cast<opengm::UInt64Type>(bool( i & (opengm::UInt64Type(1) << j) ));
         }
         // EVALUATE
         ValueType newVal = 0.0;
@@ -990,9 +1004,6 @@ inline void SubmodelCGC<GM>::unsetSubVar(){
     numSubFactors_=0;
     //nInsideFactors_=0;
     //nBorderFactors_=0;
-
-
-    localEdgemap_.clear();
 }
 
 #endif /* OPENGM_HMC_SUBMODEL2 */
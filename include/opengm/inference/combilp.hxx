@@ -7,12 +7,24 @@
 
 #ifndef COMBILP_HXX_
 #define COMBILP_HXX_
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include <opengm/graphicalmodel/graphicalmodel_manipulator.hxx>
+#ifdef WITH_CPLEX
 #include <opengm/inference/lpcplex.hxx>
+#else
+#include <opengm/inference/junctiontree.hxx>
+#endif
 #include <opengm/inference/auxiliary/lp_reparametrization.hxx>
 #include <opengm/inference/trws/output_debug_utils.hxx>
 #include <opengm/inference/trws/trws_base.hxx>
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace opengm{
 
    namespace combilp_base{
@@ -106,7 +118,10 @@ namespace opengm{
             singleReparametrization_(singleReparametrization),
             saveProblemMasks_(saveProblemMasks),
             maskFileNamePre_(maskFileNamePre),
-            threads_(1)
+            threads_(1),
+            numberOfThreads_(0),
+            ilpTimeLimit_(3600.0),
+            ilpWorkMem_(1024.0*6)
             {};
          virtual ~CombiLP_base_Parameter(){};
          size_t maxNumberOfILPCycles_;
@@ -115,7 +130,10 @@ namespace opengm{
          bool singleReparametrization_;
          bool saveProblemMasks_;
          std::string maskFileNamePre_;
-         size_t threads_;
+         size_t threads_; // threads of the ILP solver
+         size_t numberOfThreads_; // submodels solved in parallel (0: OpenMP default)
+         double ilpTimeLimit_; // time limit of the ILP solver in seconds (LPCplex)
+         double ilpWorkMem_; // workspace memory of the ILP solver in MB (LPCplex)
 
 #ifdef TRWS_DEBUG_OUTPUT
          virtual void print(std::ostream& fout)const
@@ -126,13 +144,40 @@ namespace opengm{
                fout <<"singleReparametrization="<<singleReparametrization_<<std::endl;
                fout <<"saveProblemMasks="<<saveProblemMasks_<<std::endl;
                fout <<"maskFileNamePre="<<maskFileNamePre_<<std::endl;
+               fout <<"numberOfThreads="<<numberOfThreads_<<std::endl;
+               fout <<"ilpTimeLimit="<<ilpTimeLimit_<<std::endl;
+               fout <<"ilpWorkMem="<<ilpWorkMem_<<std::endl;
             }
 #endif
       };
 
 
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>//TODO: remove default ILP solver
+/*
+ * adapts the parameter of the exact solver for the submodels,
+ * e.g. to switch on the integer constraints of an LP solver
+ */
+      template<class ILPSOLVER>
+      struct ILPSolverParameterAdapter
+      {
+         static void adapt(typename ILPSOLVER::Parameter& /*param*/,const CombiLP_base_Parameter& /*combilpParam*/){};
+      };
+
+#ifdef WITH_CPLEX
+      template<class GM, class ACC>
+      struct ILPSolverParameterAdapter<LPCplex<GM,ACC> >
+      {
+         static void adapt(typename LPCplex<GM,ACC>::Parameter& param,const CombiLP_base_Parameter& combilpParam)
+         {
+            param.integerConstraint_=true;
+            param.numberOfThreads_= combilpParam.threads_;
+            param.timeLimit_ = combilpParam.ilpTimeLimit_;
+            param.workMem_= combilpParam.ilpWorkMem_;
+         };
+      };
+#endif
+
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
       class CombiLP_base
       {
       public:
@@ -147,9 +192,11 @@ namespace opengm{
 
          typedef typename opengm::GraphicalModelManipulator<typename ReparametrizerType::ReparametrizedGMType> GMManipulatorType;
 
-         typedef LPCplex<typename GMManipulatorType::MGM, Minimizer> LPCPLEX;//TODO: move to template parameters
+         typedef typename ILPSOLVER::template RebindGmAndAcc<typename GMManipulatorType::MGM, Minimizer>::type ILPSolverType;
+         typedef typename ILPSolverType::Parameter ILPSolverParameterType;
 
          CombiLP_base(LPREPARAMETRIZER& reparametrizer, const Parameter& param
+                      , const ILPSolverParameterType& ilpsolverParameter=ILPSolverParameterType()
 #ifdef TRWS_DEBUG_OUTPUT
                       , std::ostream& fout=std::cout
 #endif
@@ -174,6 +221,7 @@ namespace opengm{
          void _Reparametrize(typename ReparametrizerType::ReparametrizedGMType* pgm,const MaskType& mask);
          InferenceTermination _PerformILPInference(GMManipulatorType& modelManipulator,std::vector<LabelType>* plabeling);
          Parameter _parameter;
+         ILPSolverParameterType _ilpsolverParameter;
          ReparametrizerType& _lpparametrizer;
          std::vector<LabelType> _labeling;
          ValueType _value;
@@ -183,13 +231,15 @@ namespace opengm{
 #endif
       };
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>
-      CombiLP_base<GM,ACC,LPREPARAMETRIZER>::CombiLP_base(LPREPARAMETRIZER& reparametrizer, const Parameter& param
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
+      CombiLP_base<GM,ACC,LPREPARAMETRIZER,ILPSOLVER>::CombiLP_base(LPREPARAMETRIZER& reparametrizer, const Parameter& param
+                                                          , const ILPSolverParameterType& ilpsolverParameter
 #ifdef TRWS_DEBUG_OUTPUT
                                                           , std::ostream& fout
 #endif
          )
    :  _parameter(param)
+   ,_ilpsolverParameter(ilpsolverParameter)
    ,_lpparametrizer(reparametrizer)
    ,_labeling(_lpparametrizer.graphicalModel().numberOfVariables(),std::numeric_limits<LabelType>::max())
    ,_value(ACC::template neutral<ValueType>())
@@ -198,43 +248,81 @@ namespace opengm{
    ,_fout(param.verbose_ ? fout : *OUT::nullstream::Instance())//(fout)
 #endif
       {
+         ILPSolverParameterAdapter<ILPSolverType>::adapt(_ilpsolverParameter,_parameter);
       };
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>
-      InferenceTermination CombiLP_base<GM,ACC,LPREPARAMETRIZER>::_PerformILPInference(GMManipulatorType& modelManipulator,std::vector<LabelType>* plabeling)
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
+      InferenceTermination CombiLP_base<GM,ACC,LPREPARAMETRIZER,ILPSOLVER>::_PerformILPInference(GMManipulatorType& modelManipulator,std::vector<LabelType>* plabeling)
       {
-         InferenceTermination terminationILP=NORMAL;
          modelManipulator.buildModifiedSubModels();
-
-         std::vector<std::vector<LabelType> > submodelLabelings(modelManipulator.numberOfSubmodels());
-         for (size_t modelIndex=0;modelIndex<modelManipulator.numberOfSubmodels();++modelIndex)
+         const size_t numberOfSubmodels=modelManipulator.numberOfSubmodels();
+
+         // the submodels are disconnected, they are solved independently,
+         // largest first for a better load balance
+         std::vector<std::pair<size_t,size_t> > order(numberOfSubmodels);
+         for (size_t modelIndex=0;modelIndex<numberOfSubmodels;++modelIndex)
+            order[modelIndex]=std::make_pair(modelManipulator.getModifiedSubModel(modelIndex).numberOfVariables(),modelIndex);
+         std::sort(order.begin(),order.end(),std::greater<std::pair<size_t,size_t> >());
+
+         std::vector<std::vector<LabelType> > submodelLabelings(numberOfSubmodels);
+         std::vector<InferenceTermination> terminations(numberOfSubmodels,NORMAL);
+         // exceptions must not leave the parallel loop, they are rethrown after it
+         std::vector<RuntimeError> errors(numberOfSubmodels,RuntimeError(""));
+         std::vector<unsigned char> failed(numberOfSubmodels,0);
+#ifdef WITH_OPENMP
+         const int numberOfThreads=_parameter.numberOfThreads_>0 ? static_cast<int>(_parameter.numberOfThreads_) : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads)
+#endif
+         for (std::ptrdiff_t i=0;i<static_cast<std::ptrdiff_t>(numberOfSubmodels);++i)
          {
-            const typename GMManipulatorType::MGM& model=modelManipulator.getModifiedSubModel(modelIndex);
-            submodelLabelings[modelIndex].resize(model.numberOfVariables());
-            typename LPCPLEX::Parameter param;
-            param.integerConstraint_=true;
-            param.numberOfThreads_= _parameter.threads_;
-            param.timeLimit_ = 3600;                       // TODO: Make this a parameter (1h)
-            param.workMem_= 1024*6;                        // TODO: Make this a parameter (6GB)
-            LPCPLEX ilpSolver(model,param);
-            terminationILP=ilpSolver.infer();
+            const size_t modelIndex=order[i].second;
+            try
+            {
+               const typename GMManipulatorType::MGM& model=modelManipulator.getModifiedSubModel(modelIndex);
+               submodelLabelings[modelIndex].resize(model.numberOfVariables());
+               ILPSolverType ilpSolver(model,_ilpsolverParameter);
+               terminations[modelIndex]=ilpSolver.infer();
+               if ((terminations[modelIndex]==NORMAL) || (terminations[modelIndex]==CONVERGENCE))
+                  ilpSolver.arg(submodelLabelings[modelIndex]);
+            }
+            catch(const RuntimeError& e)
+            {
+               errors[modelIndex]=e;
+               failed[modelIndex]=1;
+            }
+            catch(const std::exception& e)
+            {
+               errors[modelIndex]=RuntimeError(e.what());
+               failed[modelIndex]=1;
+            }
+            catch(...)
+            {
+               errors[modelIndex]=RuntimeError("unknown exception in the ILP solver");
+               failed[modelIndex]=1;
+            }
+         }
+         for (size_t modelIndex=0;modelIndex<numberOfSubmodels;++modelIndex)
+            if (failed[modelIndex])
+               throw errors[modelIndex];
 
+         InferenceTermination terminationILP=NORMAL;
+         for (size_t modelIndex=0;modelIndex<numberOfSubmodels;++modelIndex)
+         {
+            terminationILP=terminations[modelIndex];
             if ((terminationILP!=NORMAL) && (terminationILP!=CONVERGENCE)){
                return terminationILP;
                //std::cout << "WARNING: solving ILP failed!"<<std::endl;
                //return NORMAL;
             }
-            else
-               ilpSolver.arg(submodelLabelings[modelIndex]);
          }
 
          modelManipulator.modifiedSubStates2OriginalState(submodelLabelings,*plabeling);
          return terminationILP;
       }
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
       template <class VISITORWRAPPER>
-      InferenceTermination CombiLP_base<GM,ACC,LPREPARAMETRIZER>::infer(MaskType& mask,const std::vector<LabelType>& lp_labeling,VISITORWRAPPER& vis)
+      InferenceTermination CombiLP_base<GM,ACC,LPREPARAMETRIZER,ILPSOLVER>::infer(MaskType& mask,const std::vector<LabelType>& lp_labeling,VISITORWRAPPER& vis)
       {
 #ifdef TRWS_DEBUG_OUTPUT
          if (!_parameter.singleReparametrization_)
@@ -342,16 +430,16 @@ namespace opengm{
       }
 
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>
-      void CombiLP_base<GM,ACC,LPREPARAMETRIZER>::
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
+      void CombiLP_base<GM,ACC,LPREPARAMETRIZER,ILPSOLVER>::
       _Reparametrize(typename ReparametrizerType::ReparametrizedGMType* pgm,const MaskType& mask)
       {
          _lpparametrizer.reparametrize(&mask);
          _lpparametrizer.getReparametrizedModel(*pgm);
       }
 
-      template<class GM, class ACC, class LPREPARAMETRIZER>
-      void CombiLP_base<GM,ACC,LPREPARAMETRIZER>::
+      template<class GM, class ACC, class LPREPARAMETRIZER, class ILPSOLVER>
+      void CombiLP_base<GM,ACC,LPREPARAMETRIZER,ILPSOLVER>::
       ReparametrizeAndSave()
       {
          typename ReparametrizerType::ReparametrizedGMType gm;
@@ -361,7 +449,7 @@ namespace opengm{
 
    }//namespace combilp_base  =========================================================================
 
-   template<class LPSOLVERPARAMETERS,class REPARAMETRIZERPARAMETERS>
+   template<class LPSOLVERPARAMETERS,class REPARAMETRIZERPARAMETERS,class ILPSOLVERPARAMETERS>
    struct CombiLP_Parameter : public combilp_base::CombiLP_base_Parameter
    {
       typedef combilp_base::CombiLP_base_Parameter parent;
@@ -373,7 +461,8 @@ namespace opengm{
 			const std::string& reparametrizedModelFileName="",
 			bool singleReparametrization=true,
 			bool saveProblemMasks=false,
-			std::string maskFileNamePre=""):
+			std::string maskFileNamePre="",
+			const ILPSOLVERPARAMETERS& ilpsolverParameter=ILPSOLVERPARAMETERS()):
          parent(maxNumberOfILPCycles,
                 verbose,
                 reparametrizedModelFileName,
@@ -381,11 +470,13 @@ namespace opengm{
                 saveProblemMasks,
                 maskFileNamePre),
          lpsolverParameter_(lpsolverParameter),
-         repaParameter_(repaParameter)
+         repaParameter_(repaParameter),
+         ilpsolverParameter_(ilpsolverParameter)
          {
          };
       LPSOLVERPARAMETERS lpsolverParameter_;
       REPARAMETRIZERPARAMETERS repaParameter_;
+      ILPSOLVERPARAMETERS ilpsolverParameter_;
 
 #ifdef TRWS_DEBUG_OUTPUT
       void print(std::ostream& fout)const
@@ -401,39 +492,47 @@ namespace opengm{
    /// Savchynskyy, B. and Kappes, J. H. and Swoboda, P. and Schnoerr, C.:
    /// "Global MAP-Optimality by Shrinking the Combinatorial Search Area with Convex Relaxation".
    /// In NIPS, 2013.
+   ///
+   /// The non arc consistent part of the model is solved exactly by ILPSOLVER,
+   /// which is rebound to the submodels and must be a minimizer,
+   /// e.g. LPCplex, JunctionTree, AStar or Bruteforce. Disconnected components
+   /// of this part are solved in parallel.
    /// \ingroup inference 
 
-   template<class GM, class ACC, class LPSOLVER>//TODO: remove default ILP solver
+#ifdef WITH_CPLEX
+   template<class GM, class ACC, class LPSOLVER, class ILPSOLVER = LPCplex<GM, Minimizer> >
+#else
+   template<class GM, class ACC, class LPSOLVER, class ILPSOLVER = JunctionTree<GM, Minimizer> >
+#endif
    class CombiLP : public Inference<GM, ACC>
    {
    public:
       typedef typename LPSOLVER::ReparametrizerType ReparametrizerType;
-      typedef combilp_base::CombiLP_base<GM,ACC,ReparametrizerType> BaseType;
+      typedef combilp_base::CombiLP_base<GM,ACC,ReparametrizerType,ILPSOLVER> BaseType;
 
       typedef ACC AccumulationType;
       typedef GM GraphicalModelType;
 
         template<class _GM>
         struct RebindGm{
-            typedef CombiLP<_GM, ACC, LPSOLVER> type;
+            typedef CombiLP<_GM, ACC, LPSOLVER, ILPSOLVER> type;
         };
 
         template<class _GM,class _ACC>
         struct RebindGmAndAcc{
-            typedef CombiLP<_GM, _ACC, LPSOLVER> type;
+            typedef CombiLP<_GM, _ACC, LPSOLVER, ILPSOLVER> type;
         };
 
 
       OPENGM_GM_TYPE_TYPEDEFS;
-      typedef visitors::VerboseVisitor<CombiLP<GM, ACC, LPSOLVER> > VerboseVisitorType;
-      typedef visitors::EmptyVisitor<CombiLP<GM, ACC, LPSOLVER> >   EmptyVisitorType;
-      typedef visitors::TimingVisitor<CombiLP<GM, ACC, LPSOLVER> >  TimingVisitorType;
+      typedef visitors::VerboseVisitor<CombiLP<GM, ACC, LPSOLVER, ILPSOLVER> > VerboseVisitorType;
+      typedef visitors::EmptyVisitor<CombiLP<GM, ACC, LPSOLVER, ILPSOLVER> >   EmptyVisitorType;
+      typedef visitors::TimingVisitor<CombiLP<GM, ACC, LPSOLVER, ILPSOLVER> >  TimingVisitorType;
 
-      typedef CombiLP_Parameter<typename LPSOLVER::Parameter,typename ReparametrizerType::Parameter> Parameter;
+      typedef CombiLP_Parameter<typename LPSOLVER::Parameter,typename ReparametrizerType::Parameter,typename ILPSOLVER::Parameter> Parameter;
       typedef typename ReparametrizerType::MaskType MaskType;
       typedef typename BaseType::GMManipulatorType GMManipulatorType;
-
-      typedef LPCplex<typename GMManipulatorType::MGM, ACC> LPCPLEX;//TODO: move to template parameters
+      typedef typename BaseType::ILPSolverType ILPSolverType;
 
       CombiLP(const GraphicalModelType& gm, const Parameter& param
 #ifdef TRWS_DEBUG_OUTPUT
@@ -471,8 +570,8 @@ namespace opengm{
 #endif
    };
 
-   template<class GM, class ACC, class LPSOLVER>
-   CombiLP<GM,ACC,LPSOLVER>::CombiLP(const GraphicalModelType& gm, const Parameter& param
+   template<class GM, class ACC, class LPSOLVER, class ILPSOLVER>
+   CombiLP<GM,ACC,LPSOLVER,ILPSOLVER>::CombiLP(const GraphicalModelType& gm, const Parameter& param
 #ifdef TRWS_DEBUG_OUTPUT
                                      , std::ostream& fout
 #endif
@@ -484,7 +583,7 @@ namespace opengm{
 #endif
      )
   ,_plpparametrizer(_lpsolver.getReparametrizer(_parameter.repaParameter_))//TODO: parameters of the reparametrizer come here
-  ,_base(*_plpparametrizer, param
+  ,_base(*_plpparametrizer, param, typename BaseType::ILPSolverParameterType(param.ilpsolverParameter_)
 #ifdef TRWS_DEBUG_OUTPUT
          ,fout
 #endif
@@ -502,9 +601,9 @@ namespace opengm{
 #endif
    };
 
-   template<class GM, class ACC, class LPSOLVER>
+   template<class GM, class ACC, class LPSOLVER, class ILPSOLVER>
    template<class VISITOR>
-   InferenceTermination CombiLP<GM,ACC,LPSOLVER>::infer(VISITOR & visitor)
+   InferenceTermination CombiLP<GM,ACC,LPSOLVER,ILPSOLVER>::infer(VISITOR & visitor)
    {
 #ifdef TRWS_DEBUG_OUTPUT
       _fout <<"Running LP solver "<<_lpsolver.name()<<std::endl;
@@ -562,7 +661,7 @@ namespace opengm{
       MaskType mask;
       combilp_base::DilateMask(_lpsolver.graphicalModel(),initialmask,&mask);
 
-      visitors::VisitorWrapper<VISITOR,CombiLP<GM,ACC,LPSOLVER> > vis(&visitor,this);
+      visitors::VisitorWrapper<VISITOR,CombiLP<GM,ACC,LPSOLVER,ILPSOLVER> > vis(&visitor,this);
       InferenceTermination terminationVal=_base.infer(mask,labeling_lp,vis);
       //InferenceTermination terminationVal=_base.infer(mask,labeling_lp,trws_base::VisitorWrapper<VISITOR,CombiLP<GM,ACC,LPSOLVER> >(&visitor,this));
       if ( (terminationVal==NORMAL) || (terminationVal==CONVERGENCE) )
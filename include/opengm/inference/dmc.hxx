@@ -5,20 +5,37 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <map>
 
 #include "opengm/opengm.hxx"
 //#include "opengm/inference/visitors/visitor.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/movemaker.hxx"
 #include "opengm/datastructures/buffer_vector.hxx"
+#include "opengm/datastructures/partition.hxx"
+#include "opengm/utilities/metaprogramming.hxx"
+#include "opengm/utilities/timer.hxx"
 
 #include <opengm/graphicalmodel/space/simplediscretespace.hxx>
 #include <opengm/functions/potts.hxx>
 #include "opengm/inference/visitors/visitors.hxx"
 
 namespace opengm {
-  
 
+/// \brief decomposition for multicuts
+///
+/// An optimal multicut cuts all edges with weight <= threshold_ between
+/// the connected components w.r.t. the other edges, hence each component
+/// is solved independently by INF.
+///
+/// The decomposition and the Potts models of the components are kept
+/// between calls of infer(). If the weights of the model have changed
+/// (e.g. parameterized functions in learning), only the weights of the
+/// changed edges are updated and only the components with a changed edge
+/// are solved again, warm-started from the previous labeling. The
+/// decomposition is rebuilt only if an edge changes sides of the
+/// threshold. The timing visitor logs the time of the decomposition, the
+/// time of the sub-inference and the number of solved components.
 template<class GM, class INF>
 class DMC : public Inference<GM, typename INF::AccumulationType>
 {
@@ -33,6 +50,12 @@ public:
     typedef opengm::visitors::EmptyVisitor<DMC<GM,INF> >  EmptyVisitorType;
     typedef opengm::visitors::TimingVisitor<DMC<GM,INF> > TimingVisitorType;
 
+    typedef PottsFunction<ValueType,IndexType,IndexType> SubFunctionType;
+    typedef SimpleDiscreteSpace<IndexType, IndexType> SubSpaceType;
+    typedef GraphicalModel<ValueType, OperatorType, SubFunctionType, SubSpaceType> SubModelType;
+    typedef typename INF:: template RebindGmAndAcc<SubModelType,ACC>::type SubInfType;
+    typedef typename INF:: template RebindGmAndAcc<GM,ACC>::type OrgInfType;
+
     class Parameter {
         public:
 
@@ -59,18 +82,34 @@ public:
     void setStartingPoint(typename std::vector<LabelType>::const_iterator);
     virtual InferenceTermination arg(std::vector<LabelType>&, const size_t = 1) const ;
     virtual ValueType value()const{
-        assert(false);  // FIXME: the return of this function was missing, just added something arbitrary
-        return ValueType();
+        return value_;
     }
 
 private:
+    void decompose();
+    void solveComponent(const IndexType);
+
     const GraphicalModelType& gm_;
     Parameter param_;
 
     ValueType value_;
     std::vector<LabelType> arg_;
+    bool hasLabeling_;
+
+    // decomposition, kept between calls of infer
+    bool decomposed_;
+    std::vector<ValueType> weights_;
+    std::vector<IndexType> changedFactors_;
+    std::vector< std::vector<IndexType> > subVar_;
+    std::vector<LabelType> offsets_;
+    std::vector<SubModelType> subGms_;
+    // component of each factor (number of components for cut edges)
+    // and its function in the model of the component
+    std::vector<IndexType> factorComponent_;
+    std::vector<typename SubModelType::FunctionIdentifier> factorFunction_;
+    std::vector<unsigned char> dirty_;
 };
-  
+
 template<class GM, class INF>
 inline
 DMC<GM, INF>::DMC
@@ -81,27 +120,34 @@ DMC<GM, INF>::DMC
 :   gm_(gm),
     param_(parameter),
     value_(),
-    arg_(gm.numberOfVariables(), 0) {
+    arg_(gm.numberOfVariables(), 0),
+    hasLabeling_(false),
+    decomposed_(false) {
 
 }
 
 
-      
+
 template<class GM, class INF>
 inline void
 DMC<GM, INF>::reset()
 {
-
+    decomposed_ = false;
+    hasLabeling_ = false;
+    subGms_.clear();
 }
-   
+
 template<class GM, class INF>
-inline void 
+inline void
 DMC<GM,INF>::setStartingPoint
 (
    typename std::vector<typename DMC<GM,INF>::LabelType>::const_iterator begin
 ) {
+    std::copy(begin, begin + gm_.numberOfVariables(), arg_.begin());
+    hasLabeling_ = true;
+    std::fill(dirty_.begin(), dirty_.end(), 1);
 }
-   
+
 template<class GM, class INF>
 inline std::string
 DMC<GM, INF>::name() const
@@ -115,7 +161,7 @@ DMC<GM, INF>::graphicalModel() const
 {
    return gm_;
 }
-  
+
 template<class GM, class INF>
 inline InferenceTermination
 DMC<GM,INF>::infer()
@@ -124,167 +170,204 @@ DMC<GM,INF>::infer()
    return infer(v);
 }
 
-  
+/// connected components w.r.t. the edges with weight > threshold_ and the
+/// Potts models of the components with more than two variables
 template<class GM, class INF>
-template<class VisitorType>
-InferenceTermination DMC<GM,INF>::infer
-(
-   VisitorType& visitor
-)
+void
+DMC<GM,INF>::decompose()
 {
-   
-    visitor.begin(*this);
-
-
-    LabelType lAA[2]={0, 0};
-    LabelType lAB[2]={0, 1};
-
-    // decomposition
     Partition<LabelType> ufd(gm_.numberOfVariables());
     for(size_t fi=0; fi< gm_.numberOfFactors(); ++fi){
-        if(gm_[fi].numberOfVariables()==2){
+        if(weights_[fi]>param_.threshold_){
+            ufd.merge(gm_[fi].variableIndex(0), gm_[fi].variableIndex(1));
+        }
+    }
+    std::map<LabelType, LabelType> repr;
+    ufd.representativeLabeling(repr);
+    const IndexType nSubProb = ufd.numberOfSets();
+    subVar_.assign(nSubProb, std::vector<IndexType>());
+    std::vector<IndexType> component(gm_.numberOfVariables());
+    std::vector<IndexType> globalToLocal(gm_.numberOfVariables());
+    for(size_t vi=0; vi<gm_.numberOfVariables(); ++vi){
+        component[vi] = repr[ufd.find(vi)];
+        globalToLocal[vi] = subVar_[component[vi]].size();
+        subVar_[component[vi]].push_back(vi);
+    }
 
-            const ValueType val00  = gm_[fi](lAA);
-            const ValueType val01  = gm_[fi](lAB);
-            const ValueType weight = val01 - val00; 
+    offsets_.resize(nSubProb);
+    subGms_.clear();
+    subGms_.resize(nSubProb);
+    LabelType offset = 0;
+    for(IndexType subProb = 0; subProb<nSubProb; ++subProb){
+        const IndexType nSubVar = subVar_[subProb].size();
+        offsets_[subProb] = offset;
+        offset += nSubVar;
+        // a single component is solved on the model itself
+        if(nSubVar>2 && nSubProb>1){
+            subGms_[subProb] = SubModelType(SubSpaceType(nSubVar, nSubVar));
+        }
+    }
 
-            if(weight>param_.threshold_){
-                const size_t vi0 = gm_[fi].variableIndex(0);
-                const size_t vi1 = gm_[fi].variableIndex(1);
-                ufd.merge(vi0, vi1);
-            }
+    factorComponent_.resize(gm_.numberOfFactors());
+    factorFunction_.resize(gm_.numberOfFactors());
+    for(size_t fi=0; fi< gm_.numberOfFactors(); ++fi){
+        const IndexType vi0 = gm_[fi].variableIndex(0);
+        const IndexType vi1 = gm_[fi].variableIndex(1);
+        if(component[vi0] != component[vi1]){
+            factorComponent_[fi] = nSubProb;
+            continue;
         }
-        else{
-            throw RuntimeError("wrong factor order for multicut");
+        const IndexType subProb = component[vi0];
+        factorComponent_[fi] = subProb;
+        const IndexType nSubVar = subVar_[subProb].size();
+        if(nSubVar>2 && nSubProb>1){
+            const IndexType lvis[] = {
+                std::min(globalToLocal[vi0],globalToLocal[vi1]),
+                std::max(globalToLocal[vi0],globalToLocal[vi1])
+            };
+            const SubFunctionType pf(nSubVar, nSubVar, 0.0, weights_[fi]);
+            factorFunction_[fi] = subGms_[subProb].addFunction(pf);
+            subGms_[subProb].addFactor(factorFunction_[fi], lvis, lvis+2);
+        }
+    }
+    dirty_.assign(nSubProb, 1);
+    decomposed_ = true;
+}
+
+/// solve a component, warm-started from the current labeling
+template<class GM, class INF>
+void
+DMC<GM,INF>::solveComponent
+(
+    const IndexType subProb
+)
+{
+    const std::vector<IndexType>& subVar = subVar_[subProb];
+    const IndexType nSubVar = subVar.size();
+    if(nSubVar<=2){
+        for(IndexType lvi=0; lvi<nSubVar; ++lvi){
+            arg_[subVar[lvi]] = offsets_[subProb];
         }
+        return;
     }
 
-    if(ufd.numberOfSets() == 1){
-        //std::cout<<" all in one cc\n";
-        // FALL BACK HERE!!!
-        typedef typename INF:: template rebind<GM,ACC>::type OrgInf;
-        typename OrgInf::Parameter orgInfParam(param_.infParam_); 
-        OrgInf orgInf(gm_, orgInfParam);
+    // current labels of the component, relabeled to 0, 1, ...
+    std::vector<LabelType> subArg(nSubVar);
+    if(hasLabeling_){
+        std::map<LabelType, LabelType> dense;
+        for(IndexType lvi=0; lvi<nSubVar; ++lvi){
+            const LabelType l = static_cast<LabelType>(dense.size());
+            subArg[lvi] = dense.insert(std::make_pair(arg_[subVar[lvi]], l)).first->second;
+        }
+    }
+
+    if(subVar_.size()==1){
+        typename OrgInfType::Parameter orgInfParam(param_.infParam_);
+        OrgInfType orgInf(gm_, orgInfParam);
+        if(hasLabeling_){
+            orgInf.setStartingPoint(subArg.begin());
+        }
         orgInf.infer();
         orgInf.arg(arg_);
-        value_ = gm_.evaluate(arg_);
     }
-    else {
-        //std::cout<<" NOT all in one cc\n";
-        std::map<LabelType, LabelType> repr;
-        ufd.representativeLabeling(repr);
-        //std::cout<<"gm_.numVar "<<gm_.numberOfVariables()<<"\n";
-        //std::cout<<"reprs size"<<repr.size()<<"\n";
-        //std::cout<<"ufd.numberOfSets() "<<ufd.numberOfSets()<<"\n";
-        std::vector< std::vector< LabelType> > subVar(ufd.numberOfSets());
-        // set up the sub var
-        for(size_t vi=0; vi<gm_.numberOfVariables(); ++vi){
-            subVar[repr[ufd.find(vi)]].push_back(vi);
+    else{
+        typename SubInfType::Parameter subInfParam(param_.infParam_);
+        SubInfType subInf(subGms_[subProb], subInfParam);
+        if(hasLabeling_){
+            subInf.setStartingPoint(subArg.begin());
         }
-
-        const size_t nSubProb = subVar.size();
-
-        std::vector<unsigned char> usedFactors_(gm_.numberOfFactors(),0);
-
-        // mark all factors where weight is smaller
-        // as param_.threshold_ as used
-        for(size_t fi=0; fi< gm_.numberOfFactors(); ++fi){
-            if(
-                ufd.find(gm_[fi].variableIndex(0)) 
-                !=  
-                ufd.find(gm_[fi].variableIndex(1))
-            )
-            {
-                usedFactors_[fi] = 1;
-            }
+        subInf.infer();
+        subInf.arg(subArg);
+        for(IndexType lvi=0; lvi<nSubVar; ++lvi){
+            arg_[subVar[lvi]] = subArg[lvi] + offsets_[subProb];
         }
+    }
+}
 
-        std::vector<IndexType> globalToLocal(gm_.numberOfVariables(), gm_.numberOfVariables()+1);
-
-        IndexType offset = 0;
-        for(size_t subProb = 0; subProb<nSubProb; ++subProb){
-            
-            //std::cout<<"subProb "<<subProb<<"\n";
-            const IndexType nSubVar = subVar[subProb].size();
-            //std::cout<<"nSubVar "<<nSubVar<<"\n";
+template<class GM, class INF>
+template<class VisitorType>
+InferenceTermination DMC<GM,INF>::infer
+(
+   VisitorType& visitor
+)
+{
+    const bool timing = meta::Compare<VisitorType, TimingVisitorType>::value;
+    if(timing){
+        visitor.addLog("decompositionTime");
+        visitor.addLog("subInferenceTime");
+        visitor.addLog("solvedComponents");
+    }
+    visitor.begin(*this);
+    Timer timer;
+    timer.tic();
 
-            typedef PottsFunction<ValueType,IndexType,IndexType> Pf;
-            typedef SimpleDiscreteSpace<IndexType, IndexType> Space;
-            typedef GraphicalModel<ValueType, OperatorType, Pf , Space> Model;
-            Space space(nSubVar, nSubVar);
-            Model subGm(space);
+    LabelType lAA[2]={0, 0};
+    LabelType lAB[2]={0, 1};
 
-            for(IndexType lvi=0; lvi<nSubVar; ++lvi){
-                const IndexType gvi = subVar[subProb][lvi];
-                globalToLocal[gvi] = lvi;
+    // weights of the edges and changes since the last call
+    bool rebuild = !decomposed_;
+    changedFactors_.clear();
+    weights_.resize(gm_.numberOfFactors());
+    for(size_t fi=0; fi< gm_.numberOfFactors(); ++fi){
+        if(gm_[fi].numberOfVariables()!=2){
+            throw RuntimeError("wrong factor order for multicut");
+        }
+        const ValueType val00  = gm_[fi](lAA);
+        const ValueType val01  = gm_[fi](lAB);
+        const ValueType weight = val01 - val00;
+        if(!decomposed_ || weight != weights_[fi]){
+            if(decomposed_ && (weight>param_.threshold_) != (weights_[fi]>param_.threshold_)){
+                rebuild = true;
             }
+            weights_[fi] = weight;
+            changedFactors_.push_back(fi);
+        }
+    }
 
-
-            if(nSubVar==1){
-                const IndexType gvi = subVar[subProb][0];
-                arg_[gvi] = offset;
-            }
-            else if(nSubVar==2){
-                const IndexType gvi0 = subVar[subProb][0];
-                const IndexType gvi1 = subVar[subProb][1];
-                arg_[gvi0] =     offset;
-                arg_[gvi1] =     offset;
+    if(rebuild){
+        decompose();
+    }
+    else{
+        const IndexType nSubProb = subVar_.size();
+        for(size_t f=0; f<changedFactors_.size(); ++f){
+            const IndexType fi = changedFactors_[f];
+            const IndexType subProb = factorComponent_[fi];
+            if(subProb==nSubProb){
+                // cut edges stay cut
+                continue;
             }
-            else{
-
-                for(IndexType lvi=0; lvi<nSubVar; ++lvi){
-                    const IndexType gvi = subVar[subProb][lvi];
-                    OPENGM_CHECK_OP(lvi, == , globalToLocal[gvi], ' ');
-                    // number of factors
-                    const size_t nf = gm_.numberOfFactors(gvi);
-
-                    for(size_t f=0; f<nf; ++f){
-                        const IndexType nfi =  gm_.factorOfVariable(gvi, f);
-                        if(usedFactors_[nfi] != 1){
-                            usedFactors_[nfi] = 1;
-
-                            // add factor to graphical model
-                            const ValueType val00  = gm_[nfi](lAA);
-                            const ValueType val01  = gm_[nfi](lAB);
-                            const ValueType weight = val01 - val00; 
-                            const IndexType vi0 = gm_[nfi].variableIndex(0);
-                            const IndexType vi1 = gm_[nfi].variableIndex(1);
-
-                            if( ufd.find(vi0) !=  ufd.find(vi1)){
-                                OPENGM_CHECK_OP(ufd.find(vi0),!=,ufd.find(vi1), "internal error");
-                            }
-
-                            const IndexType lvis[] = {
-                                std::min(globalToLocal[vi0],globalToLocal[vi1]),
-                                std::max(globalToLocal[vi0],globalToLocal[vi1])
-                            };
-                            const Pf pf(nSubVar, nSubVar, 0.0, weight);
-                            subGm.addFactor(subGm.addFunction(pf), lvis, lvis+2);
-                        }
-                    }
-                }
-
-                // infer the submodel
-                typedef typename INF:: template rebind<Model,ACC>::type SubInf;
-                typename SubInf::Parameter subInfParam(param_.infParam_); 
-                SubInf subInf(subGm, subInfParam);
-                subInf.infer();
-
-                std::vector<LabelType> subArg(subGm.numberOfVariables());
-                subInf.arg(subArg);
-
-                for(IndexType lvi=0; lvi<nSubVar; ++lvi){
-                    const IndexType gvi = subVar[subProb][lvi];
-                    arg_[gvi] = subArg[lvi] + offset;
-                }
+            if(subVar_[subProb].size()>2 && nSubProb>1){
+                subGms_[subProb]. template getFunction<SubFunctionType>(factorFunction_[fi]).parameter(1) = weights_[fi];
             }
-
-            offset += nSubVar;
+            dirty_[subProb] = 1;
         }
-        value_ = gm_.evaluate(arg_);
-        visitor.end(*this);
-
     }
+    timer.toc();
+    const double decompositionTime = timer.elapsedTime();
+
+    // solve the changed components
+    timer.reset();
+    timer.tic();
+    size_t solvedComponents = 0;
+    for(IndexType subProb = 0; subProb<subVar_.size(); ++subProb){
+        if(dirty_[subProb]){
+            solveComponent(subProb);
+            dirty_[subProb] = 0;
+            ++solvedComponents;
+        }
+    }
+    timer.toc();
+    const double subInferenceTime = timer.elapsedTime();
+
+    hasLabeling_ = true;
+    value_ = gm_.evaluate(arg_);
+    visitor(*this);
+    if(timing){
+        visitor.log("decompositionTime", decompositionTime);
+        visitor.log("subInferenceTime", subInferenceTime);
+        visitor.log("solvedComponents", static_cast<double>(solvedComponents));
+    }
+    visitor.end(*this);
     return NORMAL;
 }
 
@@ -5,6 +5,9 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <cmath>
+#include <algorithm>
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/inference.hxx"
@@ -20,11 +23,8 @@
 #ifdef WITH_CPLEX
 #include "opengm/inference/lpcplex.hxx"
 #endif
-#ifdef WITH_QPBO
-#include "QPBO.h"
 #include "opengm/inference/hqpbo.hxx"
 #include "opengm/inference/reducedinference.hxx"
-#endif
 #ifdef WITH_AD3
 #include "opengm/inference/external/ad3.hxx"
 #endif
@@ -814,6 +814,132 @@ namespace proposal_gen{
     };
 
 
+    /// proposals from the beliefs of (tree-reweighted) belief propagation
+    ///
+    /// Every proposalsPerUpdate_ calls a few more iterations of message
+    /// passing are run, continuing from the messages of the previous
+    /// update, and the argmin of the current min-marginals is proposed.
+    /// In between, proposals are sampled from the cached min-marginals
+    /// with probabilities proportional to exp(-temp*(marginal-min)).
+    template<class GM, class ACC, class UPDATE_RULES = BeliefPropagationUpdateRules<GM, ACC> >
+    class BeliefGen
+    {
+    public:
+        typedef ACC AccumulationType;
+        typedef GM GraphicalModelType;
+        OPENGM_GM_TYPE_TYPEDEFS;
+        typedef MessagePassing<GM, ACC, UPDATE_RULES, opengm::MaxDistance> InfType;
+        typedef typename InfType::Parameter InfParameter;
+
+        struct Parameter
+        {
+            Parameter(
+                const size_t stepsPerUpdate = 2,
+                const size_t proposalsPerUpdate = 5,
+                const float temp = 1.0,
+                const InfParameter & infParam = InfParameter(1, 0.0, 0.5)
+            )
+            :   stepsPerUpdate_(stepsPerUpdate),
+                proposalsPerUpdate_(proposalsPerUpdate),
+                temp_(temp),
+                infParam_(infParam)
+            {
+            }
+            size_t stepsPerUpdate_;
+            size_t proposalsPerUpdate_;
+            float temp_;
+            InfParameter infParam_;
+        };
+
+        BeliefGen(const GM &gm, const Parameter &param)
+            :  gm_(gm),
+               param_(param),
+               inf_(gm, param.infParam_),
+               maxNumLabels_(gm.maxNumberOfLabels()),
+               cumWeights_(gm.numberOfVariables()*gm.maxNumberOfLabels()),
+               marginal_(),
+               currentStep_(0),
+               randomFloat_(0.0, 1.0, 42)
+        {
+            inf_.setMaxSteps(param_.stepsPerUpdate_);
+        }
+
+        void reset()
+        {
+            inf_.reset();
+            currentStep_ = 0;
+        }
+
+        size_t defaultNumStopIt() {return 2*param_.proposalsPerUpdate_;}
+
+        void getProposal(const std::vector<LabelType> &/*current*/ , std::vector<LabelType> &proposal)
+        {
+            if(currentStep_ % std::max(param_.proposalsPerUpdate_, size_t(1)) == 0){
+                this->update(proposal);
+            }
+            else{
+                for (IndexType vi = 0; vi < gm_.numberOfVariables(); ++vi){
+                    proposal[vi] = this->sample(vi);
+                }
+            }
+            ++currentStep_;
+        }
+
+    private:
+        // cost of a marginal value such that smaller is better
+        double cost(const ValueType value) const
+        {
+            const double base = meta::Compare<OperatorType, Adder>::value
+                ? static_cast<double>(value)
+                : std::log(static_cast<double>(value));
+            return meta::Compare<ACC, Minimizer>::value ? base : -base;
+        }
+
+        // continue message passing, cache the sampling weights
+        // of the beliefs and return their argmin
+        void update(std::vector<LabelType> &argmin)
+        {
+            inf_.infer();
+            for (IndexType vi = 0; vi < gm_.numberOfVariables(); ++vi){
+                inf_.marginal(vi, marginal_);
+                const LabelType numLabels = gm_.numberOfLabels(vi);
+                double * w = &cumWeights_[vi*maxNumLabels_];
+                LabelType best = 0;
+                for(LabelType l=0; l<numLabels; ++l){
+                    w[l] = this->cost(marginal_(&l));
+                    if(w[l] < w[best]){
+                        best = l;
+                    }
+                }
+                argmin[vi] = best;
+                const double minCost = w[best];
+                double sum = 0.0;
+                for(LabelType l=0; l<numLabels; ++l){
+                    sum += std::exp(-1.0*param_.temp_*(w[l]-minCost));
+                    w[l] = sum;
+                }
+            }
+        }
+
+        LabelType sample(const IndexType vi) const
+        {
+            const LabelType numLabels = gm_.numberOfLabels(vi);
+            const double * w = &cumWeights_[vi*maxNumLabels_];
+            const double r = randomFloat_() * w[numLabels-1];
+            return static_cast<LabelType>(std::upper_bound(w, w+numLabels-1, r) - w);
+        }
+
+        const GM &gm_;
+        Parameter param_;
+        InfType inf_;
+        LabelType maxNumLabels_;
+        std::vector<double> cumWeights_;
+        IndependentFactorType marginal_;
+        size_t currentStep_;
+        opengm::RandomUniform<double> randomFloat_;
+    };
+
+
     template<class GM, class ACC>
     class DynamincGen{
     public:
@@ -9,9 +9,11 @@
 #include <cstdlib>
 #include <cmath>
 #include <typeinfo>
+#include <algorithm>
 
 #include "opengm/opengm.hxx"
 #include "opengm/utilities/random.hxx"
+#include "opengm/utilities/graph_coloring.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/movemaker.hxx"
 #include "opengm/operations/minimizer.hxx"
@@ -21,6 +23,10 @@
 #include "opengm/operations/integrator.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace opengm {
 
 /// \cond HIDDEN_SYMBOLS
@@ -46,6 +52,41 @@ namespace detail_gibbs {
          static ProbabilityType convert(const T newValue, const T oldValue)
             { return static_cast<ProbabilityType>(std::exp(oldValue - newValue)); }
    };
+
+   // unnormalized conditional probabilities of all labels of a variable
+   // from the values of the factors connected to it
+   template<class OPERATOR, class ACCUMULATOR, class PROBABILITY>
+   struct ValuesToProbabilities;
+
+   template<class PROBABILITY>
+   struct ValuesToProbabilities<Multiplier, Maximizer, PROBABILITY>
+   {
+      typedef PROBABILITY ProbabilityType;
+      template<class T>
+         static void convert(const std::vector<T>& values, std::vector<ProbabilityType>& probabilities)
+         {
+            for(size_t j = 0; j < values.size(); ++j) {
+               probabilities[j] = static_cast<ProbabilityType>(values[j]);
+            }
+         }
+   };
+
+   template<class PROBABILITY>
+   struct ValuesToProbabilities<Adder, Minimizer, PROBABILITY>
+   {
+      typedef PROBABILITY ProbabilityType;
+      template<class T>
+         static void convert(const std::vector<T>& values, std::vector<ProbabilityType>& probabilities)
+         {
+            const T minValue = *std::min_element(values.begin(), values.end());
+            for(size_t j = 0; j < values.size(); ++j) {
+               probabilities[j] = static_cast<ProbabilityType>(minValue - values[j]);
+            }
+            for(size_t j = 0; j < values.size(); ++j) {
+               probabilities[j] = std::exp(probabilities[j]);
+            }
+         }
+   };
 }
 /// \endcond
 
@@ -70,10 +111,13 @@ public:
       size_t addMarginal(VariableIndexIterator, VariableIndexIterator);
    size_t addMarginal(const size_t);
    void operator()(const GibbsType&, const ValueType, const ValueType, const size_t, const bool, const bool);
+   size_t operator()(const GibbsType&);
 
    // query
    void begin(const GibbsType&, const ValueType, const ValueType) const {}
    void end(const GibbsType&, const ValueType, const ValueType) const {}
+   void begin(const GibbsType&) const {}
+   void end(const GibbsType&) const {}
    size_t numberOfSamples() const;
    size_t numberOfAcceptedSamples() const;
    size_t numberOfRejectedSamples() const;
@@ -91,6 +135,20 @@ private:
 };
 
 /// \brief Gibbs sampling
+///
+/// With Parameter::CHROMATIC as variable proposal, the variables are
+/// greedily colored such that no two variables of the same color are
+/// connected by a factor. In each sweep, the variables of one color are
+/// drawn concurrently from their exact conditional distributions (heat
+/// bath). Several independent Markov chains (Parameter::numberOfChains_)
+/// are sampled in parallel, each from its own counter based random stream,
+/// such that the samples do not depend on the number of threads. The
+/// visitor is called for every chain after every sweep, with markovState()
+/// and markovValue() referring to that chain. Thus, a GibbsMarginalVisitor
+/// accumulates the marginals of all chains. In this mode, the numbers of
+/// sampling and burn-in steps are numbers of single variable updates per
+/// chain (rounded up to full sweeps) and the temperature schedule is not
+/// used.
 template<class GM, class ACC>
 class Gibbs 
 : public Inference<GM, ACC> {
@@ -106,7 +164,7 @@ public:
 
    class Parameter {
    public:
-      enum VariableProposal {RANDOM, CYCLIC};
+      enum VariableProposal {RANDOM, CYCLIC, CHROMATIC};
 
       Parameter(
          const size_t maxNumberOfSamplingSteps = 1e5,
@@ -125,7 +183,10 @@ public:
          useTemp_(useTemp),
          tempMin_(tmin),
          tempMax_(tmax),
-         periods_(periods){
+         periods_(periods),
+         numberOfChains_(1),
+         numberOfThreads_(0),
+         seed_(0){
          p_=static_cast<ValueType>(maxNumberOfSamplingSteps_/periods_);
       }
       bool useTemp_;
@@ -137,8 +198,12 @@ public:
       size_t numberOfBurnInSteps_;
       VariableProposal variableProposal_;
       std::vector<size_t> startPoint_;
-      
-      
+      /// number of independent Markov chains (CHROMATIC only)
+      size_t numberOfChains_;
+      /// number of OpenMP threads (0 = OpenMP default)
+      size_t numberOfThreads_;
+      /// key of the random stream of the first chain (CHROMATIC only)
+      size_t seed_;
    };
 
    Gibbs(const GraphicalModelType&, const Parameter& param = Parameter());
@@ -155,8 +220,22 @@ public:
    ValueType markovValue() const;
    LabelType currentBestState(const size_t) const;
    ValueType currentBestValue() const;
+   size_t currentChain() const;
+   bool burningIn() const;
+   bool accepted() const;
 
 private:
+   struct ChromaticWorkspace {
+      std::vector<ValueType> values_;
+      std::vector<ProbabilityType> probabilities_;
+      std::vector<LabelType> labels_;
+   };
+
+   template<class VISITOR>
+      InferenceTermination inferChromatic(VISITOR&);
+   void sweep(const size_t, const size_t, const std::vector<std::vector<IndexType> >&,
+              ChromaticWorkspace*, const int);
+
    ValueType cosTemp(const ValueType arg,const ValueType periode,const ValueType min,const ValueType max)const{
       return static_cast<ValueType>(((std::cos(arg/periode)+1.0)/2.0)*(max-min))+min;
       //if(v<
@@ -176,6 +255,12 @@ private:
    std::vector<size_t> currentBestState_;
    ValueType currentBestValue_;
    bool inInference_;
+   // state of the chains (CHROMATIC only)
+   std::vector<std::vector<LabelType> > chainStates_;
+   std::vector<ValueType> chainValues_;
+   size_t currentChain_;
+   bool burningIn_;
+   bool accepted_;
 };
 
 template<class GM, class ACC>
@@ -189,7 +274,12 @@ Gibbs<GM, ACC>::Gibbs
    gm_(gm), 
    movemaker_(gm), 
    currentBestState_(gm.numberOfVariables()),
-   currentBestValue_()
+   currentBestValue_(),
+   chainStates_(),
+   chainValues_(),
+   currentChain_(0),
+   burningIn_(false),
+   accepted_(false)
 {
    inInference_=false;
    ACC::ineutral(currentBestValue_);
@@ -271,6 +361,9 @@ template<class VISITOR>
 InferenceTermination Gibbs<GM, ACC>::infer(
    VISITOR& visitor
 ) {
+   if(parameter_.variableProposal_ == Parameter::CHROMATIC) {
+      return inferChromatic(visitor);
+   }
    inInference_=true;
    visitor.begin(*this);
    opengm::RandomUniform<size_t> randomVariable(0, gm_.numberOfVariables());
@@ -293,11 +386,13 @@ InferenceTermination Gibbs<GM, ACC>::infer(
 
          // move
          const bool burningIn = (iteration < parameter_.numberOfBurnInSteps_);
+         burningIn_ = burningIn;
          if(label != movemaker_.state(variableIndex)) {
             const ValueType oldValue = movemaker_.value();
             const ValueType newValue = movemaker_.valueAfterMove(&variableIndex, &variableIndex + 1, &label);
             if(AccumulationType::bop(newValue, oldValue)) {
                movemaker_.move(&variableIndex, &variableIndex + 1, &label);
+               accepted_ = true;
                if(AccumulationType::bop(newValue, currentBestValue_) && newValue != currentBestValue_) {
                   currentBestValue_ = newValue;
                   for(size_t k = 0; k < currentBestState_.size(); ++k) {
@@ -314,10 +409,12 @@ InferenceTermination Gibbs<GM, ACC>::infer(
                   >::convert(newValue, oldValue);
                if(randomProb() < pFlip) {
                   movemaker_.move(&variableIndex, &variableIndex + 1, &label); 
+                  accepted_ = true;
                   visitor(*this);
                   //visitor(*this, newValue, currentBestValue_, iteration, true, burningIn);
                }
                else {
+                  accepted_ = false;
                   visitor(*this);
                  // visitor(*this, newValue, currentBestValue_, iteration, false, burningIn);
                }
@@ -343,11 +440,13 @@ InferenceTermination Gibbs<GM, ACC>::infer(
 
          // move
          const bool burningIn = (iteration < parameter_.numberOfBurnInSteps_);
+         burningIn_ = burningIn;
          if(label != movemaker_.state(variableIndex)) {
             const ValueType oldValue = movemaker_.value();
             const ValueType newValue = movemaker_.valueAfterMove(&variableIndex, &variableIndex + 1, &label);
             if(AccumulationType::bop(newValue, oldValue)) {
                movemaker_.move(&variableIndex, &variableIndex + 1, &label);
+               accepted_ = true;
                if(AccumulationType::bop(newValue, currentBestValue_) && newValue != currentBestValue_) {
                   currentBestValue_ = newValue;
                   for(size_t k = 0; k < currentBestState_.size(); ++k) {
@@ -365,11 +464,13 @@ InferenceTermination Gibbs<GM, ACC>::infer(
                if(randomProb() < pFlip*this->getTemperature(iteration)){
                   //std::cout<<"temp="<<this->getTemperature(iteration)<<"\n";
                   movemaker_.move(&variableIndex, &variableIndex + 1, &label); 
+                  accepted_ = true;
                   visitor(*this);
                   //visitor(*this, newValue, currentBestValue_, iteration, true, burningIn);
                }
                else {
                   //std::cout<<"temp="<<this->getTemperature(iteration)<<"\n";
+                  accepted_ = false;
                   visitor(*this);
                   //visitor(*this, newValue, currentBestValue_, iteration, false, burningIn);
                }
@@ -384,6 +485,143 @@ InferenceTermination Gibbs<GM, ACC>::infer(
    return NORMAL;
 }
 
+/// sweep over all variables of one chain, color by color
+template<class GM, class ACC>
+void Gibbs<GM, ACC>::sweep(
+   const size_t chain,
+   const size_t sweepIndex,
+   const std::vector<std::vector<IndexType> >& colorClasses,
+   ChromaticWorkspace* workspaces,
+   const int numberOfThreads
+) {
+   std::vector<LabelType>& state = chainStates_[chain];
+   const RandomStream random(static_cast<UInt64Type>(parameter_.seed_ + chain));
+   const UInt64Type counterOffset = static_cast<UInt64Type>(sweepIndex) * gm_.numberOfVariables();
+   for(size_t c = 0; c < colorClasses.size(); ++c) {
+      const std::vector<IndexType>& colorClass = colorClasses[c];
+      const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(colorClass.size());
+      #pragma omp parallel for if(numberOfThreads > 1) num_threads(numberOfThreads)
+      for(std::ptrdiff_t i = 0; i < size; ++i) {
+         #ifdef WITH_OPENMP
+         ChromaticWorkspace& workspace = workspaces[omp_get_thread_num()];
+         #else
+         ChromaticWorkspace& workspace = workspaces[0];
+         #endif
+         const IndexType variableIndex = colorClass[i];
+         const LabelType numberOfLabels = gm_.numberOfLabels(variableIndex);
+         std::vector<ValueType>& values = workspace.values_;
+         std::vector<ProbabilityType>& probabilities = workspace.probabilities_;
+         std::vector<LabelType>& labels = workspace.labels_;
+         values.resize(numberOfLabels);
+         probabilities.resize(numberOfLabels);
+
+         // values of all labels, one factor at a time
+         std::fill(values.begin(), values.end(), OperatorType::template neutral<ValueType>());
+         for(IndexType f = 0; f < gm_.numberOfFactors(variableIndex); ++f) {
+            const FactorType& factor = gm_[gm_.factorOfVariable(variableIndex, f)];
+            IndexType position = 0;
+            for(IndexType v = 0; v < factor.numberOfVariables(); ++v) {
+               labels[v] = state[factor.variableIndex(v)];
+               if(factor.variableIndex(v) == variableIndex) {
+                  position = v;
+               }
+            }
+            for(LabelType label = 0; label < numberOfLabels; ++label) {
+               labels[position] = label;
+               OperatorType::op(factor(labels.begin()), values[label]);
+            }
+         }
+
+         // draw from the conditional distribution
+         detail_gibbs::ValuesToProbabilities<OperatorType, AccumulationType, ProbabilityType>::convert(values, probabilities);
+         for(LabelType label = 1; label < numberOfLabels; ++label) {
+            probabilities[label] += probabilities[label - 1];
+         }
+         const ProbabilityType threshold = random.uniform(counterOffset + variableIndex) * probabilities[numberOfLabels - 1];
+         LabelType label = 0;
+         while(label + 1 < numberOfLabels && probabilities[label] <= threshold) {
+            ++label;
+         }
+         state[variableIndex] = label;
+      }
+   }
+   chainValues_[chain] = gm_.evaluate(state.begin());
+}
+
+template<class GM, class ACC>
+template<class VISITOR>
+InferenceTermination Gibbs<GM, ACC>::inferChromatic(
+   VISITOR& visitor
+) {
+   #ifdef WITH_OPENMP
+   const int numberOfThreads = parameter_.numberOfThreads_ > 0 ? static_cast<int>(parameter_.numberOfThreads_) : omp_get_max_threads();
+   #else
+   const int numberOfThreads = 1;
+   #endif
+   const size_t numberOfVariables = gm_.numberOfVariables();
+   const size_t numberOfChains = std::max(parameter_.numberOfChains_, static_cast<size_t>(1));
+   const size_t numberOfBurnInSweeps = (parameter_.numberOfBurnInSteps_ + numberOfVariables - 1) / numberOfVariables;
+   const size_t numberOfSweeps = numberOfBurnInSweeps
+      + (parameter_.maxNumberOfSamplingSteps_ + numberOfVariables - 1) / numberOfVariables;
+
+   std::vector<opengm::RandomAccessSet<IndexType> > variableAdjacencyList;
+   gm_.variableAdjacencyList(variableAdjacencyList);
+   std::vector<std::vector<IndexType> > colorClasses;
+   greedyColoring(variableAdjacencyList, colorClasses);
+
+   std::vector<ChromaticWorkspace> workspaces(numberOfThreads);
+   for(size_t t = 0; t < static_cast<size_t>(numberOfThreads); ++t) {
+      workspaces[t].labels_.resize(gm_.factorOrder());
+   }
+   // all chains start at the current state of the movemaker
+   chainStates_.assign(numberOfChains, std::vector<LabelType>(movemaker_.stateBegin(), movemaker_.stateEnd()));
+   chainValues_.assign(numberOfChains, movemaker_.value());
+   // chains are distributed over the threads if there are sufficiently
+   // many of them, otherwise the variables of each color are
+   const bool parallelChains = numberOfChains >= static_cast<size_t>(numberOfThreads);
+
+   inInference_ = true;
+   accepted_ = true;
+   visitor.begin(*this);
+   bool exitInf = false;
+   for(size_t s = 0; s < numberOfSweeps && !exitInf; ++s) {
+      if(parallelChains) {
+         #pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads)
+         for(std::ptrdiff_t chain = 0; chain < static_cast<std::ptrdiff_t>(numberOfChains); ++chain) {
+            #ifdef WITH_OPENMP
+            ChromaticWorkspace* workspace = &workspaces[omp_get_thread_num()];
+            #else
+            ChromaticWorkspace* workspace = &workspaces[0];
+            #endif
+            sweep(chain, s, colorClasses, workspace, 1);
+         }
+      }
+      else {
+         for(size_t chain = 0; chain < numberOfChains; ++chain) {
+            sweep(chain, s, colorClasses, &workspaces[0], numberOfThreads);
+         }
+      }
+      burningIn_ = (s < numberOfBurnInSweeps);
+      for(currentChain_ = 0; currentChain_ < numberOfChains; ++currentChain_) {
+         if(AccumulationType::bop(chainValues_[currentChain_], currentBestValue_)) {
+            currentBestValue_ = chainValues_[currentChain_];
+            currentBestState_.assign(chainStates_[currentChain_].begin(), chainStates_[currentChain_].end());
+         }
+         if(visitor(*this) != visitors::VisitorReturnFlag::ContinueInf) {
+            exitInf = true;
+            break;
+         }
+      }
+   }
+   currentChain_ = 0;
+   movemaker_.initialize(chainStates_[0].begin());
+   chainStates_.clear();
+   chainValues_.clear();
+   visitor.end(*this);
+   inInference_ = false;
+   return NORMAL;
+}
+
 template<class GM, class ACC>
 inline InferenceTermination
 Gibbs<GM, ACC>::arg
@@ -415,6 +653,9 @@ Gibbs<GM, ACC>::markovState
 ) const
 {
    OPENGM_ASSERT(j < gm_.numberOfVariables());
+   if(!chainStates_.empty()) {
+      return chainStates_[currentChain_][j];
+   }
    return movemaker_.state(j);
 }
 
@@ -422,6 +663,9 @@ template<class GM, class ACC>
 inline typename Gibbs<GM, ACC>::ValueType
 Gibbs<GM, ACC>::markovValue() const
 {
+   if(!chainValues_.empty()) {
+      return chainValues_[currentChain_];
+   }
    return movemaker_.value();
 }
 
@@ -443,6 +687,30 @@ Gibbs<GM, ACC>::currentBestValue() const
    return currentBestValue_;
 }
 
+/// index of the Markov chain markovState() and markovValue() refer to
+template<class GM, class ACC>
+inline size_t
+Gibbs<GM, ACC>::currentChain() const
+{
+   return currentChain_;
+}
+
+/// true during the burn-in phase
+template<class GM, class ACC>
+inline bool
+Gibbs<GM, ACC>::burningIn() const
+{
+   return burningIn_;
+}
+
+/// true if the last move has been accepted
+template<class GM, class ACC>
+inline bool
+Gibbs<GM, ACC>::accepted() const
+{
+   return accepted_;
+}
+
 template<class GIBBS>
 inline
 GibbsMarginalVisitor<GIBBS>::GibbsMarginalVisitor()
@@ -503,6 +771,15 @@ GibbsMarginalVisitor<GIBBS>::operator()(
    }
 }
 
+template<class GIBBS>
+inline size_t
+GibbsMarginalVisitor<GIBBS>::operator()(
+   const typename GibbsMarginalVisitor<GIBBS>::GibbsType& gibbs
+) {
+   (*this)(gibbs, gibbs.markovValue(), gibbs.currentBestValue(), 0, gibbs.accepted(), gibbs.burningIn());
+   return visitors::VisitorReturnFlag::ContinueInf;
+}
+
 template<class GIBBS>
 template<class VariableIndexIterator>
 inline size_t
@@ -10,9 +10,11 @@
 #include <algorithm>
 #include <iostream>
 #include <functional>
+#include <limits>
 
 #include "opengm/opengm.hxx"
 #include "opengm/graphicalmodel/graphicalmodel.hxx"
+#include "opengm/utilities/queues.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
 namespace opengm {
@@ -29,6 +31,14 @@ namespace opengm {
    ///
    /// The greedy gremlin defines a baseline for other algorithms.
    ///
+   /// By default the variables are visited in breadth-first order. With
+   /// priorityQueue_ the variable whose best label is most certain, i.e. has
+   /// the largest gap to the second best label, is fixed next. The values of
+   /// the labels are accumulated incrementally: a factor is added to a
+   /// variable once all its other variables are fixed, and only this
+   /// variable is rescored in the queue, i.e. the complexity is
+   /// O(sum of the factor sizes times the labels + n log n).
+   ///
    /// \ingroup inference
    template<class GM,class ACC>
    class GreedyGremlin : public Inference<GM,ACC>
@@ -56,13 +66,17 @@ namespace opengm {
 
 
       struct Parameter {
-            Parameter(){
+            /// \param priorityQueue fix the most certain variable next
+            Parameter(const bool priorityQueue = false)
+            :  priorityQueue_(priorityQueue){
 
             }
             template<class P>
-            Parameter(const P & p){
+            Parameter(const P & p)
+            :  priorityQueue_(p.priorityQueue_){
                 
             }
+            bool priorityQueue_;
       };
       GreedyGremlin(const GM& gm, Parameter para = Parameter());
       virtual std::string name() const {return "GreedyGremlin";}
@@ -76,6 +90,9 @@ namespace opengm {
       virtual InferenceTermination args(std::vector< std::vector<LabelType> >& v)const;
 
    private:
+      void addFactorValues(const IndexType, const IndexType, std::vector<LabelType>&, ValueType*) const;
+      ValueType certainty(const ValueType*, const LabelType) const;
+
       const GM&                                   gm_;
       Parameter                                   parameter_;
       std::vector<LabelType>                      conf_;
@@ -126,55 +143,92 @@ namespace opengm {
    template<class VisitorType>
    InferenceTermination GreedyGremlin<GM,ACC>::infer(VisitorType& visitor)
    {
-      std::vector<bool>       nodeColor(gm_.numberOfVariables(),false);
-      std::vector<IndexType>  waitingList(gm_.numberOfVariables());
-      waitingList[0] = 0;
-      nodeColor[0]   = true;
+      const IndexType numberOfVariables = gm_.numberOfVariables();
+      const ValueType neutral = GM::OperatorType::template neutral<ValueType>();
+      // accumulated values of the labels of each variable w.r.t. the factors
+      // whose other variables are fixed
+      std::vector<size_t> offsets(numberOfVariables+1,0);
+      for(IndexType vi=0; vi<numberOfVariables; ++vi){
+         offsets[vi+1] = offsets[vi] + gm_.numberOfLabels(vi);
+      }
+      std::vector<ValueType> values(offsets[numberOfVariables],neutral);
+      std::vector<IndexType> numberOfFreeVariables(gm_.numberOfFactors());
+      std::vector<bool>      fixed(numberOfVariables,false);
+      std::vector<LabelType> labels(gm_.factorOrder());
+      for(IndexType f=0; f<gm_.numberOfFactors(); ++f){
+         numberOfFreeVariables[f] = gm_[f].numberOfVariables();
+         if(numberOfFreeVariables[f]==1){
+            const IndexType vi = gm_[f].variableIndex(0);
+            addFactorValues(f, vi, labels, &values[offsets[vi]]);
+         }
+      }
+
+      // breadth-first order
+      std::vector<bool>       nodeColor;
+      std::vector<IndexType>  waitingList;
       IndexType waitingListFirst = 0;
       IndexType waitingListLast  = 0;
-      visitor.begin(*this);    
-      const ValueType neutral = GM::OperatorType::template neutral<ValueType>();
-      while(waitingListFirst<waitingList.size()){
-         OPENGM_ASSERT(waitingListFirst<=waitingListLast);
-         IndexType var = waitingList[waitingListFirst++];
-         std::vector<ValueType> vals(gm_.numberOfLabels(var),neutral);
-         //for all neigboured factors
-         for(typename GM::ConstFactorIterator fit=gm_.factorsOfVariableBegin(var); fit!=gm_.factorsOfVariableEnd(var); ++fit){
-            bool useIt = true;
-            for(typename GM::ConstVariableIterator vit=gm_.variablesOfFactorBegin(*fit); vit!=gm_.variablesOfFactorEnd(*fit); ++vit){
-               if(nodeColor[*vit]==false){
-                  useIt = false;
-                  break;
+      IndexType nextStart        = 0;
+      // order by certainty
+      ChangeablePriorityQueue<ValueType, std::greater<ValueType> > queue(parameter_.priorityQueue_ ? numberOfVariables : 0);
+      if(parameter_.priorityQueue_){
+         for(IndexType vi=0; vi<numberOfVariables; ++vi){
+            queue.push(vi, certainty(&values[offsets[vi]], gm_.numberOfLabels(vi)));
+         }
+      }
+      else{
+         nodeColor.resize(numberOfVariables,false);
+         waitingList.resize(numberOfVariables);
+      }
+
+      visitor.begin(*this);
+      for(IndexType n=0; n<numberOfVariables; ++n){
+         IndexType var;
+         if(parameter_.priorityQueue_){
+            var = queue.top();
+            queue.pop();
+         }
+         else{
+            if(waitingListFirst==waitingListLast){
+               // start at the next connected component
+               while(nodeColor[nextStart]){
+                  ++nextStart;
                }
+               nodeColor[nextStart] = true;
+               waitingList[waitingListLast++] = nextStart;
             }
-            if(useIt){
-               std::vector<LabelType> l(gm_[*fit].numberOfVariables());
-               size_t p;
-               for(size_t i=0; i<l.size();++i){
-                  if(gm_[*fit].variableIndex(i)==var)
-                     p=i;
-                  else
-                     l[i] = conf_[gm_[*fit].variableIndex(i)];
-               }
-               for(l[p]=0; l[p]<gm_.numberOfLabels(var);++l[p]){
-                  const ValueType v = gm_[*fit](l.begin());
-                  GM::OperatorType::op(v,vals[l[p]]);
-               }
-            } 
+            var = waitingList[waitingListFirst++];
          }
+         fixed[var] = true;
 
          //find best and fix
-         for(size_t i=0; i<vals.size();++i){
+         const ValueType* vals = &values[offsets[var]];
+         conf_[var] = 0;
+         for(LabelType i=1; i<gm_.numberOfLabels(var); ++i){
             if(ACC::bop(vals[i],vals[conf_[var]]))
-               conf_[var]=i;                    
+               conf_[var]=i;
          }
 
-         //add white neighbours to waitingslist
+         //score the variables whose factors became complete, add white
+         //neighbours to the waitinglist
          for(typename GM::ConstFactorIterator fit=gm_.factorsOfVariableBegin(var); fit!=gm_.factorsOfVariableEnd(var); ++fit){
-            for(typename GM::ConstVariableIterator vit=gm_.variablesOfFactorBegin(*fit); vit!=gm_.variablesOfFactorEnd(*fit); ++vit){
-               if(nodeColor[*vit]==false){
-                  nodeColor[*vit]=true;
-                  waitingList[++waitingListLast] = *vit;
+            if(--numberOfFreeVariables[*fit]==1){
+               for(typename GM::ConstVariableIterator vit=gm_.variablesOfFactorBegin(*fit); vit!=gm_.variablesOfFactorEnd(*fit); ++vit){
+                  if(!fixed[*vit]){
+                     addFactorValues(*fit, *vit, labels, &values[offsets[*vit]]);
+                     if(parameter_.priorityQueue_){
+                        queue.changePriority(*vit, certainty(&values[offsets[*vit]], gm_.numberOfLabels(*vit)));
+                     }
+                     break;
+                  }
+               }
+            }
+            if(!parameter_.priorityQueue_){
+               for(typename GM::ConstVariableIterator vit=gm_.variablesOfFactorBegin(*fit); vit!=gm_.variablesOfFactorEnd(*fit); ++vit){
+                  if(nodeColor[*vit]==false){
+                     nodeColor[*vit]=true;
+                     waitingList[waitingListLast++] = *vit;
+                  }
                }
             }
          }
@@ -182,11 +236,66 @@ namespace opengm {
             break;
          }
       }
-           
-      visitor.end(*this);     
+
+      visitor.end(*this);
       return NORMAL;
    }
 
+/// accumulate the values of a factor, whose other variables are fixed, for
+/// all labels of a variable
+   template<class GM, class ACC>
+   inline void GreedyGremlin<GM,ACC>::addFactorValues
+   (
+      const IndexType factor,
+      const IndexType var,
+      std::vector<LabelType>& labels,
+      ValueType* vals
+   ) const
+   {
+      const FactorType& f = gm_[factor];
+      size_t p = 0;
+      for(size_t i=0; i<f.numberOfVariables(); ++i){
+         if(f.variableIndex(i)==var)
+            p=i;
+         else
+            labels[i] = conf_[f.variableIndex(i)];
+      }
+      for(labels[p]=0; labels[p]<gm_.numberOfLabels(var); ++labels[p]){
+         GM::OperatorType::op(f(labels.begin()),vals[labels[p]]);
+      }
+   }
+
+/// gap between the best and the second best label
+   template<class GM, class ACC>
+   inline typename GreedyGremlin<GM,ACC>::ValueType GreedyGremlin<GM,ACC>::certainty
+   (
+      const ValueType* vals,
+      const LabelType numberOfLabels
+   ) const
+   {
+      if(numberOfLabels<2){
+         return std::numeric_limits<ValueType>::max();
+      }
+      LabelType best   = ACC::bop(vals[1],vals[0]) ? 1 : 0;
+      LabelType second = 1-best;
+      for(LabelType i=2; i<numberOfLabels; ++i){
+         if(ACC::bop(vals[i],vals[best])){
+            second = best;
+            best   = i;
+         }
+         else if(ACC::bop(vals[i],vals[second])){
+            second = i;
+         }
+      }
+      const ValueType difference = vals[best]<vals[second] ? vals[second]-vals[best] : vals[best]-vals[second];
+      // infinite values (hard constraints) give an infinite or undefined difference,
+      // which would break the order of the priority queue
+      if(!(difference <= std::numeric_limits<ValueType>::max())){
+         return std::numeric_limits<ValueType>::max();
+      }
+      return difference;
+   }
+
    template<class GM, class ACC>
    InferenceTermination GreedyGremlin<GM, ACC>
    ::arg(std::vector<LabelType>& conf, const size_t n)const
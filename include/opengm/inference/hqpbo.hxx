@@ -2,6 +2,8 @@
 #ifndef OPENGM_HQPBO_HXX
 #define OPENGM_HQPBO_HXX
 
+#include <limits>
+
 #include "opengm/graphicalmodel/graphicalmodel_factor.hxx"
 #include "opengm/graphicalmodel/graphicalmodel.hxx"
 #include "opengm/operations/adder.hxx"
@@ -9,13 +11,15 @@
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
 
-#include "opengm/inference/external/qpbo.hxx"
-#include "opengm/inference/fix-fusion/fusion-move.hpp"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
+#include "opengm/inference/auxiliary/higher_order_reduction.hxx"
 
 namespace opengm {
 
 /// HQPBO Algorithm\n\n
 ///
+/// QPBO on the quadratic reduction of a model with binary variables and
+/// factors of arbitrary order (HigherOrderReduction)
 ///
 /// \ingroup inference
 template<class GM, class ACC>
@@ -42,14 +46,20 @@ public:
 
 
 
+    typedef typename HigherOrderReduction<ValueType, IndexType>::Method ReductionMethod;
+
     struct Parameter {
-        Parameter(){
+        Parameter(const ReductionMethod method = HigherOrderReduction<ValueType, IndexType>::Fix)
+        :   method_(method){
 
         }
         template<class P>
-        Parameter(const P & p){
+        Parameter(const P & p)
+        :   method_(static_cast<ReductionMethod>(p.method_)){
 
         }
+        /// reduction of the higher order terms to quadratic ones (HOCR or Fix)
+        ReductionMethod method_;
      };
 
    HQPBO(const GraphicalModelType&, Parameter = Parameter());
@@ -60,10 +70,12 @@ public:
       InferenceTermination infer(VISITOR &);
    InferenceTermination arg(std::vector<LabelType>&, const size_t& = 1) const;
    void setStartingPoint(typename std::vector<LabelType>::const_iterator begin );
+   ValueType bound() const;
 private:
    const GraphicalModelType& gm_;
-   ValueType constV_;
-   HigherOrderEnergy<ValueType, 10> hoe_;
+   Parameter parameter_;
+   HigherOrderReduction<ValueType, IndexType> reduction_;
+   typename HigherOrderReduction<ValueType, IndexType>::QuadraticType quadratic_;
    std::vector<LabelType> conf_;
    ValueType bound_;
 };
@@ -82,88 +94,13 @@ template<class GM,class ACC>
 HQPBO<GM,ACC>::HQPBO
 (
    const GM & gm,
-   typename HQPBO<GM,ACC>::Parameter
+   typename HQPBO<GM,ACC>::Parameter parameter
 )
-   :  gm_(gm), constV_(0.0), conf_(std::vector<LabelType>(gm.numberOfVariables(),0))
+   :  gm_(gm), parameter_(parameter), conf_(std::vector<LabelType>(gm.numberOfVariables(),0)),
+      bound_(-std::numeric_limits<ValueType>::infinity())
 {
-   hoe_.AddVars(gm_.numberOfVariables());
-   for (IndexType f = 0; f < gm_.numberOfFactors(); ++f)
-   {
-      IndexType size = gm_[f].numberOfVariables();
-      const LabelType l0 = 0;
-      const LabelType l1 = 1;
-      if (size == 0)
-      {
-         constV_ += gm_[f](&l0);
-         continue;
-      }
-      else if (size == 1)
-      {
-         IndexType var = gm_[f].variableIndex(0);
-         const ValueType e0 = gm_[f](&l0);
-         const ValueType e1 = gm_[f](&l1);
-         hoe_.AddUnaryTerm(var, e1 - e0);
-      }
-      else
-      {
-         unsigned int numAssignments = 1 << size;
-         AutoDeleteArray<ValueType> coeffs_array(new ValueType[numAssignments]);
-         ValueType * coeffs = coeffs_array.get();
-         for (unsigned int subset = 1; subset < numAssignments; ++subset)
-         {
-            coeffs[subset] = 0;
-         }
-         // For each boolean assignment, get the clique energy at the
-         // corresponding labeling
-         AutoDeleteArray<LabelType> cliqueLabels_array(new LabelType[size]);
-         LabelType * cliqueLabels = cliqueLabels_array.get();
-         for (unsigned int assignment = 0;  assignment < numAssignments; ++assignment)
-         {
-            for (unsigned int i = 0; i < size; ++i)
-            {
-               if (assignment & (1 << i))
-               {
-                  cliqueLabels[i] = l1;
-               }
-               else
-               {
-                  cliqueLabels[i] = l0;
-               }
-            }
-            ValueType energy = gm_[f](cliqueLabels);
-            for (unsigned int subset = 1; subset < numAssignments; ++subset)
-            {
-               if (assignment & ~subset)
-               {
-                  continue;
-               }
-               else
-               {
-                  int parity = 0;
-                  for (unsigned int b = 0; b < size; ++b)
-                  {
-                     parity ^=  (((assignment ^ subset) & (1 << b)) != 0);
-                  }
-                  coeffs[subset] += parity ? -energy : energy;
-               }
-            }
-         }
-         typename HigherOrderEnergy<ValueType, 10>::VarId vars[10];
-         for (unsigned int subset = 1; subset < numAssignments; ++subset)
-         {
-            int degree = 0;
-            for (unsigned int b = 0; b < size; ++b)
-            {
-               if (subset & (1 << b))
-               {
-                  vars[degree++] = gm_[f].variableIndex(b);
-               }
-            }
-            std::sort(vars, vars + degree);
-            hoe_.AddTerm(coeffs[subset], degree, vars);
-         }
-      }
-   }
+   reduction_.setMethod(parameter_.method_);
+   reduction_.addModel(gm_);
 }
 
 template<class GM,class ACC>
@@ -193,8 +130,9 @@ inline InferenceTermination
 HQPBO<GM,ACC>::infer(VISITOR & visitor)
 {
    visitor.begin(*this);
-   kolmogorov::qpbo::QPBO<ValueType>  qr(gm_.numberOfVariables(), 0);
-   hoe_.ToQuadratic(qr);
+   reduction_.reduce(quadratic_);
+   QPBOGraph<ValueType> qr(quadratic_.numberOfNodes(), quadratic_.numberOfPairwiseTerms());
+   quadratic_.addTo(qr);
    qr.Solve();
    IndexType numberOfChangedVariables = 0;
    for (IndexType i = 0; i < gm_.numberOfVariables(); ++i)
@@ -213,11 +151,18 @@ HQPBO<GM,ACC>::infer(VISITOR & visitor)
          //conf_[i] = 0;
       }
    }
-   bound_ = constV_ + 0.5 * qr.ComputeTwiceLowerBound();
+   bound_ = quadratic_.constant() + 0.5 * qr.ComputeTwiceLowerBound();
    visitor.end(*this);
    return NORMAL;
 }
 
+template<class GM,class ACC>
+inline typename HQPBO<GM,ACC>::ValueType
+HQPBO<GM,ACC>::bound() const
+{
+   return bound_;
+}
+
 template<class GM,class ACC>
 inline InferenceTermination
 HQPBO<GM,ACC>::arg
@@ -3,6 +3,7 @@
 #define OPENGM_ICM_HXX
 
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -11,14 +12,24 @@
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/movemaker.hxx"
 #include "opengm/datastructures/buffer_vector.hxx"
+#include "opengm/utilities/graph_coloring.hxx"
 
 
 #include "opengm/inference/visitors/visitors.hxx"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace opengm {
   
 /// \brief Iterated Conditional Modes Algorithm\n\n
 /// J. E. Besag, "On the Statistical Analysis of Dirty Pictures", Journal of the Royal Statistical Society, Series B 48(3):259-302, 1986
+///
+/// With Parameter::parallel_ the variables (factors for FACTOR moves) are
+/// greedily colored such that no two of the same color share a factor
+/// (a neighboring variable). All variables (factors) of one color are
+/// conditionally independent and are updated concurrently (OpenMP).
 /// \ingroup inference 
 template<class GM, class ACC>
 class ICM : public Inference<GM, ACC>
@@ -52,27 +63,46 @@ public:
        
        Parameter(const std::vector<LabelType>& startPoint)
           :  moveType_(SINGLE_VARIABLE),
-             startPoint_(startPoint) 
+             startPoint_(startPoint),
+             parallel_(false),
+             numberOfThreads_(0)
           {}
        Parameter(MoveType moveType, const std::vector<LabelType>& startPoint)
           :  moveType_(moveType),
-             startPoint_(startPoint) 
+             startPoint_(startPoint),
+             parallel_(false),
+             numberOfThreads_(0)
           {}
 
        Parameter(MoveType moveType = SINGLE_VARIABLE)
           :  moveType_(moveType),
-             startPoint_() 
+             startPoint_(),
+             parallel_(false),
+             numberOfThreads_(0)
+          {}
+
+       Parameter(MoveType moveType, const bool parallel, const size_t numberOfThreads = 0)
+          :  moveType_(moveType),
+             startPoint_(),
+             parallel_(parallel),
+             numberOfThreads_(numberOfThreads)
           {}
 
        template<class OP>
        Parameter(const OP & otherParameter)
           {
              moveType_ = otherParameter.moveType_== 0? SINGLE_VARIABLE : FACTOR; 
-             startPoint_(otherParameter.startPoint_); 
+             startPoint_.assign(otherParameter.startPoint_.begin(), otherParameter.startPoint_.end()); 
+             parallel_ = otherParameter.parallel_;
+             numberOfThreads_ = otherParameter.numberOfThreads_;
           }
 
         MoveType moveType_;
         std::vector<LabelType>  startPoint_;
+        /// update the variables (factors) of one color concurrently
+        bool parallel_;
+        /// number of OpenMP threads (0 = OpenMP default)
+        size_t numberOfThreads_;
     };
 
    ICM(const GraphicalModelType&);
@@ -89,6 +119,13 @@ public:
    size_t currentMoveType() const;
 
 private:
+      template<class VisitorType>
+         InferenceTermination inferChromatic(VisitorType&);
+      ValueType localValue(const IndexType, const std::vector<LabelType>&, std::vector<LabelType>&) const;
+      bool moveVariableOptimally(const IndexType, std::vector<LabelType>&, std::vector<LabelType>&) const;
+      bool moveFactorOptimally(const IndexType, std::vector<LabelType>&, std::vector<IndexType>&,
+                               std::vector<LabelType>&, std::vector<LabelType>&) const;
+
       const GraphicalModelType& gm_;
       MovemakerType movemaker_;
       Parameter param_;
@@ -187,6 +224,9 @@ InferenceTermination ICM<GM,ACC>::infer
    VisitorType& visitor
 )
 {
+   if(param_.parallel_) {
+      return inferChromatic(visitor);
+   }
    bool exitInf=false;
    visitor.begin(*this);
    if(param_.moveType_==SINGLE_VARIABLE ||param_.moveType_==FACTOR) {
@@ -263,6 +303,303 @@ InferenceTermination ICM<GM,ACC>::infer
    return NORMAL;
 }
 
+/// \brief value of all factors connected to a variable
+/// \param vi variable
+/// \param labels labeling of the model
+/// \param buffer buffer for the labels of a single factor
+template<class GM, class ACC>
+inline typename ICM<GM,ACC>::ValueType
+ICM<GM,ACC>::localValue
+(
+   const IndexType vi,
+   const std::vector<LabelType>& labels,
+   std::vector<LabelType>& buffer
+) const
+{
+   ValueType value;
+   OperatorType::neutral(value);
+   for(IndexType f=0; f<gm_.numberOfFactors(vi); ++f) {
+      const FactorType& factor = gm_[gm_.factorOfVariable(vi, f)];
+      for(IndexType v=0; v<factor.numberOfVariables(); ++v) {
+         buffer[v] = labels[factor.variableIndex(v)];
+      }
+      OperatorType::op(factor(buffer.begin()), value);
+   }
+   return value;
+}
+
+/// \brief set a variable to its optimal label given all other labels
+/// \return true if the label has changed
+template<class GM, class ACC>
+inline bool
+ICM<GM,ACC>::moveVariableOptimally
+(
+   const IndexType vi,
+   std::vector<LabelType>& labels,
+   std::vector<LabelType>& buffer
+) const
+{
+   const LabelType currentLabel = labels[vi];
+   LabelType bestLabel = currentLabel;
+   ValueType bestValue = localValue(vi, labels, buffer);
+   for(LabelType s=0; s<gm_.numberOfLabels(vi); ++s) {
+      if(s != currentLabel) {
+         labels[vi] = s;
+         const ValueType value = localValue(vi, labels, buffer);
+         if(AccumulationType::bop(value, bestValue)) {
+            bestValue = value;
+            bestLabel = s;
+         }
+      }
+   }
+   labels[vi] = bestLabel;
+   return bestLabel != currentLabel;
+}
+
+/// \brief set the variables of a factor to their optimal joint labeling
+/// given all other labels
+///
+/// The labels of the factor variables are modified in place during the
+/// enumeration, which is safe as long as no concurrently optimized factor
+/// is connected to a neighbor of one of these variables.
+/// \return true if the labeling has changed
+template<class GM, class ACC>
+inline bool
+ICM<GM,ACC>::moveFactorOptimally
+(
+   const IndexType fi,
+   std::vector<LabelType>& labels,
+   std::vector<IndexType>& factors,
+   std::vector<LabelType>& buffer,
+   std::vector<LabelType>& state
+) const
+{
+   const FactorType& factor = gm_[fi];
+   const IndexType order = factor.numberOfVariables();
+
+   // factors connected to the variables of the factor
+   factors.clear();
+   for(IndexType v=0; v<order; ++v) {
+      const IndexType vi = factor.variableIndex(v);
+      for(IndexType f=0; f<gm_.numberOfFactors(vi); ++f) {
+         factors.push_back(gm_.factorOfVariable(vi, f));
+      }
+   }
+   std::sort(factors.begin(), factors.end());
+   factors.erase(std::unique(factors.begin(), factors.end()), factors.end());
+
+   // enumerate all labelings of the factor variables
+   state.resize(2*order);
+   LabelType* current = &state[0];
+   LabelType* best    = &state[order];
+   for(IndexType v=0; v<order; ++v) {
+      current[v] = 0;
+      best[v] = labels[factor.variableIndex(v)];
+   }
+   ValueType bestValue;
+   OperatorType::neutral(bestValue);
+   for(size_t i=0; i<factors.size(); ++i) {
+      const FactorType& other = gm_[factors[i]];
+      for(IndexType v=0; v<other.numberOfVariables(); ++v) {
+         buffer[v] = labels[other.variableIndex(v)];
+      }
+      OperatorType::op(other(buffer.begin()), bestValue);
+   }
+   bool changed = false;
+   for(;;) {
+      for(IndexType v=0; v<order; ++v) {
+         labels[factor.variableIndex(v)] = current[v];
+      }
+      ValueType value;
+      OperatorType::neutral(value);
+      for(size_t i=0; i<factors.size(); ++i) {
+         const FactorType& other = gm_[factors[i]];
+         for(IndexType v=0; v<other.numberOfVariables(); ++v) {
+            buffer[v] = labels[other.variableIndex(v)];
+         }
+         OperatorType::op(other(buffer.begin()), value);
+      }
+      if(AccumulationType::bop(value, bestValue)) {
+         bestValue = value;
+         std::copy(current, current+order, best);
+         changed = true;
+      }
+      // next labeling
+      IndexType v = 0;
+      while(v<order) {
+         if(static_cast<size_t>(current[v])+1 < gm_.numberOfLabels(factor.variableIndex(v))) {
+            ++current[v];
+            break;
+         }
+         current[v] = 0;
+         ++v;
+      }
+      if(v==order) {
+         break;
+      }
+   }
+   for(IndexType v=0; v<order; ++v) {
+      labels[factor.variableIndex(v)] = best[v];
+   }
+   return changed;
+}
+
+template<class GM, class ACC>
+template<class VisitorType>
+InferenceTermination ICM<GM,ACC>::inferChromatic
+(
+   VisitorType& visitor
+)
+{
+   #ifdef WITH_OPENMP
+   const int numberOfThreads = param_.numberOfThreads_ > 0 ? static_cast<int>(param_.numberOfThreads_) : omp_get_max_threads();
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+
+   bool exitInf=false;
+   visitor.begin(*this);
+
+   const IndexType numberOfVariables = gm_.numberOfVariables();
+   const IndexType numberOfFactors = gm_.numberOfFactors();
+   std::vector<LabelType> labels(numberOfVariables);
+   for(IndexType v=0; v<numberOfVariables; ++v) {
+      labels[v] = movemaker_.state(v);
+   }
+
+   // thread local buffers
+   std::vector<std::vector<LabelType> > buffers(numberOfThreads, std::vector<LabelType>(gm_.factorOrder()));
+   std::vector<std::vector<LabelType> > states(numberOfThreads);
+   std::vector<std::vector<IndexType> > factorBuffers(numberOfThreads);
+
+   std::vector<opengm::RandomAccessSet<IndexType> > variableAdjacencyList;
+   gm_.variableAdjacencyList(variableAdjacencyList);
+
+   // single variable moves
+   {
+      std::vector<std::vector<IndexType> > colorClasses;
+      greedyColoring(variableAdjacencyList, colorClasses);
+      std::vector<unsigned char> isLocalOptimal(numberOfVariables, 0);
+      std::vector<unsigned char> changed(numberOfVariables, 0);
+      bool updates = true;
+      while(updates && exitInf==false) {
+         updates = false;
+         for(size_t c=0; c<colorClasses.size(); ++c) {
+            const std::vector<IndexType>& colorClass = colorClasses[c];
+            const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(colorClass.size());
+            #pragma omp parallel for num_threads(numberOfThreads)
+            for(std::ptrdiff_t i=0; i<size; ++i) {
+               #ifdef WITH_OPENMP
+               const size_t t = omp_get_thread_num();
+               #else
+               const size_t t = 0;
+               #endif
+               const IndexType v = colorClass[i];
+               changed[v] = 0;
+               if(isLocalOptimal[v]==0) {
+                  changed[v] = moveVariableOptimally(v, labels, buffers[t]);
+                  isLocalOptimal[v] = 1;
+               }
+            }
+            for(size_t i=0; i<colorClass.size(); ++i) {
+               const IndexType v = colorClass[i];
+               if(changed[v]) {
+                  updates = true;
+                  for(size_t n=0; n<variableAdjacencyList[v].size(); ++n) {
+                     isLocalOptimal[variableAdjacencyList[v][n]] = 0;
+                  }
+               }
+            }
+         }
+         movemaker_.initialize(labels.begin());
+         if(updates && visitor(*this) != visitors::VisitorReturnFlag::ContinueInf) {
+            exitInf=true;
+         }
+      }
+   }
+
+   // factor moves
+   if(param_.moveType_==FACTOR && exitInf==false) {
+      currentMoveType_=FACTOR;
+      // two factors conflict if a variable of the one is equal or
+      // adjacent to a variable of the other
+      std::vector<std::vector<IndexType> > factorConflicts(numberOfFactors);
+      std::vector<IndexType> mark(numberOfFactors, numberOfFactors);
+      for(IndexType f=0; f<numberOfFactors; ++f) {
+         if(gm_[f].numberOfVariables()<2) {
+            continue;
+         }
+         mark[f] = f;
+         for(IndexType v=0; v<gm_[f].numberOfVariables(); ++v) {
+            const IndexType vi = gm_[f].variableIndex(v);
+            for(size_t n=0; n<=variableAdjacencyList[vi].size(); ++n) {
+               const IndexType u = n<variableAdjacencyList[vi].size() ? variableAdjacencyList[vi][n] : vi;
+               for(IndexType ff=0; ff<gm_.numberOfFactors(u); ++ff) {
+                  const IndexType g = gm_.factorOfVariable(u, ff);
+                  if(mark[g]!=f && gm_[g].numberOfVariables()>1) {
+                     mark[g] = f;
+                     factorConflicts[f].push_back(g);
+                  }
+               }
+            }
+         }
+      }
+      std::vector<std::vector<IndexType> > colorClasses;
+      greedyColoring(factorConflicts, colorClasses);
+      std::vector<unsigned char> isLocalOptimal(numberOfFactors, 0);
+      std::vector<unsigned char> changed(numberOfFactors, 0);
+      std::vector<LabelType> oldLabels(labels);
+      bool updates = true;
+      while(updates && exitInf==false) {
+         updates = false;
+         for(size_t c=0; c<colorClasses.size(); ++c) {
+            const std::vector<IndexType>& colorClass = colorClasses[c];
+            const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(colorClass.size());
+            #pragma omp parallel for num_threads(numberOfThreads)
+            for(std::ptrdiff_t i=0; i<size; ++i) {
+               #ifdef WITH_OPENMP
+               const size_t t = omp_get_thread_num();
+               #else
+               const size_t t = 0;
+               #endif
+               const IndexType f = colorClass[i];
+               changed[f] = 0;
+               if(isLocalOptimal[f]==0 && gm_[f].numberOfVariables()>1) {
+                  changed[f] = moveFactorOptimally(f, labels, factorBuffers[t], buffers[t], states[t]);
+                  isLocalOptimal[f] = 1;
+               }
+            }
+            for(size_t i=0; i<colorClass.size(); ++i) {
+               const IndexType f = colorClass[i];
+               if(changed[f]) {
+                  updates = true;
+                  for(IndexType v=0; v<gm_[f].numberOfVariables(); ++v) {
+                     const IndexType vi = gm_[f].variableIndex(v);
+                     if(oldLabels[vi]!=labels[vi]) {
+                        oldLabels[vi] = labels[vi];
+                        // the local energy of all factors connected to vi
+                        // or to one of its neighbors has changed
+                        for(size_t n=0; n<=variableAdjacencyList[vi].size(); ++n) {
+                           const IndexType u = n<variableAdjacencyList[vi].size() ? variableAdjacencyList[vi][n] : vi;
+                           for(IndexType ff=0; ff<gm_.numberOfFactors(u); ++ff) {
+                              isLocalOptimal[gm_.factorOfVariable(u, ff)] = 0;
+                           }
+                        }
+                     }
+                  }
+               }
+            }
+         }
+         movemaker_.initialize(labels.begin());
+         if(updates && visitor(*this) != visitors::VisitorReturnFlag::ContinueInf) {
+            exitInf=true;
+         }
+      }
+   }
+   visitor.end(*this);
+   return NORMAL;
+}
+
 template<class GM, class ACC>
 inline InferenceTermination
 ICM<GM,ACC>::arg
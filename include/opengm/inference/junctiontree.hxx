@@ -0,0 +1,729 @@
+#pragma once
+#ifndef OPENGM_JUNCTIONTREE_HXX
+#define OPENGM_JUNCTIONTREE_HXX
+
+#include <vector>
+#include <set>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include "opengm/opengm.hxx"
+#include "opengm/inference/inference.hxx"
+#include "opengm/inference/visitors/visitors.hxx"
+#include "opengm/operations/normalize.hxx"
+
+namespace opengm {
+
+/// \brief Junction tree algorithm for exact inference
+///
+/// The variables are eliminated in a min-fill (or min-degree) order. The
+/// cliques of the triangulated graph are arranged in a clique tree (a forest
+/// for disconnected models) whose potential tables are built from the
+/// factors with IndependentFactor operations. Messages are passed from the
+/// leaves to the roots and back; all cliques of the same height (resp.
+/// depth) are independent and are processed in parallel if OpenGM is built
+/// WITH_OPENMP.
+///
+/// For ACC = Minimizer or Maximizer, arg() yields an optimal labeling and
+/// marginal() the normalized min- (max-) marginals. For ACC = Integrator,
+/// marginal() and factorMarginal() yield the normalized marginals.
+///
+/// Runtime and memory are exponential in the size of the largest clique
+/// (treewidth + 1), see treewidth().
+///
+/// \ingroup inference
+/// \ingroup exact_inference
+template<class GM, class ACC>
+class JunctionTree : public Inference<GM, ACC> {
+public:
+   typedef ACC AccumulationType;
+   typedef GM GraphicalModelType;
+   OPENGM_GM_TYPE_TYPEDEFS;
+   typedef visitors::VerboseVisitor<JunctionTree<GM, ACC> > VerboseVisitorType;
+   typedef visitors::EmptyVisitor<JunctionTree<GM, ACC> >   EmptyVisitorType;
+   typedef visitors::TimingVisitor<JunctionTree<GM, ACC> >  TimingVisitorType;
+
+   template<class _GM>
+   struct RebindGm {
+      typedef JunctionTree<_GM, ACC> type;
+   };
+
+   template<class _GM, class _ACC>
+   struct RebindGmAndAcc {
+      typedef JunctionTree<_GM, _ACC> type;
+   };
+
+   enum Heuristic { MIN_FILL, MIN_DEGREE };
+
+   struct Parameter {
+      /// \param heuristic elimination order heuristic
+      /// \param computeMarginals pass messages from the roots back to the
+      ///        leaves such that marginal() and factorMarginal() are available
+      ///        (not needed for arg())
+      /// \param numberOfThreads number of threads (0: OpenMP default)
+      Parameter
+      (
+         const Heuristic heuristic = MIN_FILL,
+         const bool computeMarginals = true,
+         const size_t numberOfThreads = 0
+      )
+      :  heuristic_(heuristic),
+         computeMarginals_(computeMarginals),
+         numberOfThreads_(numberOfThreads)
+      {}
+
+      template<class P>
+      Parameter(const P& p)
+      :  heuristic_(static_cast<Heuristic>(p.heuristic_)),
+         computeMarginals_(p.computeMarginals_),
+         numberOfThreads_(p.numberOfThreads_)
+      {}
+
+      Heuristic heuristic_;
+      bool computeMarginals_;
+      size_t numberOfThreads_;
+   };
+
+   JunctionTree(const GraphicalModelType&, const Parameter& = Parameter());
+   std::string name() const;
+   const GraphicalModelType& graphicalModel() const;
+   InferenceTermination infer();
+   template<class VISITOR>
+      InferenceTermination infer(VISITOR&);
+   InferenceTermination arg(std::vector<LabelType>&, const size_t = 1) const;
+   InferenceTermination marginal(const size_t, IndependentFactorType&) const;
+   InferenceTermination factorMarginal(const size_t, IndependentFactorType&) const;
+   ValueType bound() const;
+
+   size_t numberOfCliques() const;
+   const std::vector<IndexType>& clique(const size_t) const;
+   size_t treewidth() const;
+   const std::vector<IndexType>& eliminationOrder() const;
+
+private:
+   void computeEliminationOrder(std::vector<std::vector<IndexType> >&);
+   void buildCliqueTree(const std::vector<std::vector<IndexType> >&);
+   void collect();
+   void distribute();
+   void decode();
+   int numberOfThreads() const;
+
+   static const size_t noClique_ = static_cast<size_t>(-1);
+
+   const GraphicalModelType& gm_;
+   Parameter parameter_;
+   std::vector<IndexType> eliminationOrder_;
+   // clique tree, variables of cliques are sorted
+   std::vector<std::vector<IndexType> > cliques_;
+   std::vector<size_t> parent_;
+   std::vector<std::vector<size_t> > children_;
+   std::vector<std::vector<IndexType> > separators_; // with the parent
+   std::vector<std::vector<IndexType> > privateVariables_; // clique \ separator
+   std::vector<std::vector<size_t> > cliqueFactors_;
+   std::vector<size_t> cliqueOfVariable_;
+   std::vector<size_t> cliqueOfFactor_;
+   std::vector<std::vector<size_t> > heightLevels_; // leaves first
+   std::vector<std::vector<size_t> > depthLevels_; // roots first
+   // tables
+   std::vector<IndependentFactorType> upBeliefs_; // potential times messages from the children
+   std::vector<IndependentFactorType> upMessages_; // to the parent
+   std::vector<IndependentFactorType> downMessages_; // from the parent
+   std::vector<IndependentFactorType> beliefs_;
+   std::vector<LabelType> arg_;
+   ValueType optimum_;
+   bool inferenceDone_;
+   bool marginalsDone_;
+};
+
+template<class GM, class ACC>
+const size_t JunctionTree<GM, ACC>::noClique_;
+
+template<class GM, class ACC>
+JunctionTree<GM, ACC>::JunctionTree
+(
+   const GraphicalModelType& gm,
+   const Parameter& parameter
+)
+:  gm_(gm),
+   parameter_(parameter),
+   optimum_(ACC::template neutral<ValueType>()),
+   inferenceDone_(false),
+   marginalsDone_(false)
+{
+   std::vector<std::vector<IndexType> > eliminationCliques;
+   computeEliminationOrder(eliminationCliques);
+   buildCliqueTree(eliminationCliques);
+}
+
+template<class GM, class ACC>
+inline std::string
+JunctionTree<GM, ACC>::name() const {
+   return "JunctionTree";
+}
+
+template<class GM, class ACC>
+inline const typename JunctionTree<GM, ACC>::GraphicalModelType&
+JunctionTree<GM, ACC>::graphicalModel() const {
+   return gm_;
+}
+
+/// number of cliques of the clique tree (forest)
+template<class GM, class ACC>
+inline size_t
+JunctionTree<GM, ACC>::numberOfCliques() const {
+   return cliques_.size();
+}
+
+/// sorted variable indices of a clique
+template<class GM, class ACC>
+inline const std::vector<typename JunctionTree<GM, ACC>::IndexType>&
+JunctionTree<GM, ACC>::clique
+(
+   const size_t cliqueIndex
+) const {
+   OPENGM_ASSERT(cliqueIndex < cliques_.size());
+   return cliques_[cliqueIndex];
+}
+
+/// size of the largest clique minus one (w.r.t. the elimination order)
+template<class GM, class ACC>
+size_t
+JunctionTree<GM, ACC>::treewidth() const {
+   size_t maxSize = 0;
+   for(size_t c = 0; c < cliques_.size(); ++c) {
+      maxSize = std::max(maxSize, cliques_[c].size());
+   }
+   return maxSize == 0 ? 0 : maxSize - 1;
+}
+
+template<class GM, class ACC>
+inline const std::vector<typename JunctionTree<GM, ACC>::IndexType>&
+JunctionTree<GM, ACC>::eliminationOrder() const {
+   return eliminationOrder_;
+}
+
+/// greedy elimination of the variables (min-fill or min-degree), ties are
+/// broken by the degree and the variable index
+///
+/// \param[out] eliminationCliques eliminationCliques[i] is the (sorted) clique
+///             formed by the i-th eliminated variable and its neighbors
+template<class GM, class ACC>
+void
+JunctionTree<GM, ACC>::computeEliminationOrder
+(
+   std::vector<std::vector<IndexType> >& eliminationCliques
+) {
+   typedef std::set<IndexType> Neighbors;
+   typedef std::pair<std::pair<size_t, size_t>, IndexType> Key;
+   const size_t numberOfVariables = gm_.numberOfVariables();
+   std::vector<Neighbors> adjacency(numberOfVariables);
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      const size_t order = gm_[f].numberOfVariables();
+      for(size_t i = 0; i < order; ++i)
+      for(size_t j = i + 1; j < order; ++j) {
+         const IndexType v0 = gm_[f].variableIndex(i);
+         const IndexType v1 = gm_[f].variableIndex(j);
+         adjacency[v0].insert(v1);
+         adjacency[v1].insert(v0);
+      }
+   }
+
+   const bool minFill = parameter_.heuristic_ == MIN_FILL;
+   std::vector<Key> keys(numberOfVariables);
+   std::set<Key> queue;
+   std::vector<bool> eliminated(numberOfVariables, false);
+   for(IndexType v = 0; v < numberOfVariables; ++v) {
+      keys[v] = Key(std::make_pair(size_t(0), adjacency[v].size()), v);
+      if(minFill) {
+         size_t fill = 0;
+         for(typename Neighbors::const_iterator a = adjacency[v].begin(); a != adjacency[v].end(); ++a) {
+            typename Neighbors::const_iterator b = a;
+            for(++b; b != adjacency[v].end(); ++b) {
+               fill += adjacency[*a].count(*b) == 0;
+            }
+         }
+         keys[v].first.first = fill;
+      }
+      queue.insert(keys[v]);
+   }
+
+   eliminationOrder_.clear();
+   eliminationOrder_.reserve(numberOfVariables);
+   eliminationCliques.clear();
+   eliminationCliques.reserve(numberOfVariables);
+   std::vector<size_t> touched(numberOfVariables, 0);
+   while(!queue.empty()) {
+      const IndexType v = queue.begin()->second;
+      queue.erase(queue.begin());
+      eliminated[v] = true;
+      eliminationOrder_.push_back(v);
+      const Neighbors neighbors = adjacency[v];
+      std::vector<IndexType> clique(neighbors.begin(), neighbors.end());
+      clique.insert(std::lower_bound(clique.begin(), clique.end(), v), v);
+      eliminationCliques.push_back(clique);
+
+      // connect the neighbors (fill-in) and remove v
+      for(typename Neighbors::const_iterator a = neighbors.begin(); a != neighbors.end(); ++a) {
+         adjacency[*a].erase(v);
+         typename Neighbors::const_iterator b = a;
+         for(++b; b != neighbors.end(); ++b) {
+            adjacency[*a].insert(*b);
+            adjacency[*b].insert(*a);
+         }
+      }
+
+      // update the keys of the variables whose scores may have changed
+      std::vector<IndexType> affected;
+      const size_t stamp = eliminationOrder_.size();
+      for(typename Neighbors::const_iterator a = neighbors.begin(); a != neighbors.end(); ++a) {
+         if(touched[*a] != stamp) {
+            touched[*a] = stamp;
+            affected.push_back(*a);
+         }
+         if(minFill) {
+            for(typename Neighbors::const_iterator b = adjacency[*a].begin(); b != adjacency[*a].end(); ++b) {
+               if(touched[*b] != stamp) {
+                  touched[*b] = stamp;
+                  affected.push_back(*b);
+               }
+            }
+         }
+      }
+      for(size_t i = 0; i < affected.size(); ++i) {
+         const IndexType u = affected[i];
+         OPENGM_ASSERT(!eliminated[u]);
+         Key key(std::make_pair(size_t(0), adjacency[u].size()), u);
+         if(minFill) {
+            size_t fill = 0;
+            for(typename Neighbors::const_iterator a = adjacency[u].begin(); a != adjacency[u].end(); ++a) {
+               typename Neighbors::const_iterator b = a;
+               for(++b; b != adjacency[u].end(); ++b) {
+                  fill += adjacency[*a].count(*b) == 0;
+               }
+            }
+            key.first.first = fill;
+         }
+         if(key != keys[u]) {
+            queue.erase(keys[u]);
+            keys[u] = key;
+            queue.insert(key);
+         }
+      }
+   }
+}
+
+/// builds the clique tree from the elimination cliques: the parent of the
+/// clique of a variable v is the clique of the neighbor of v that is
+/// eliminated next; cliques contained in their parent are merged into it
+template<class GM, class ACC>
+void
+JunctionTree<GM, ACC>::buildCliqueTree
+(
+   const std::vector<std::vector<IndexType> >& eliminationCliques
+) {
+   const size_t numberOfVariables = gm_.numberOfVariables();
+   std::vector<size_t> position(numberOfVariables);
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      position[eliminationOrder_[i]] = i;
+   }
+   std::vector<size_t> parent(numberOfVariables, noClique_);
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      const IndexType v = eliminationOrder_[i];
+      for(size_t j = 0; j < eliminationCliques[i].size(); ++j) {
+         const IndexType u = eliminationCliques[i][j];
+         if(u != v && (parent[i] == noClique_ || position[u] < parent[i])) {
+            parent[i] = position[u];
+         }
+      }
+   }
+
+   // merge the elimination cliques that are subsets of their parent
+   std::vector<size_t> alias(numberOfVariables);
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      alias[i] = i;
+   }
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      if(alias[i] != i) {
+         continue;
+      }
+      while(parent[i] != noClique_) {
+         size_t p = parent[i];
+         while(alias[p] != p) {
+            p = alias[p];
+         }
+         const std::vector<IndexType>& c = eliminationCliques[i];
+         const std::vector<IndexType>& pc = eliminationCliques[p];
+         if(!std::includes(c.begin(), c.end(), pc.begin(), pc.end())) {
+            parent[i] = p;
+            break;
+         }
+         alias[p] = i;
+         parent[i] = parent[p];
+      }
+   }
+
+   // renumber the remaining cliques
+   std::vector<size_t> index(numberOfVariables, noClique_);
+   cliques_.clear();
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      if(alias[i] == i) {
+         index[i] = cliques_.size();
+         cliques_.push_back(eliminationCliques[i]);
+      }
+   }
+   const size_t numberOfCliques = cliques_.size();
+   parent_.assign(numberOfCliques, noClique_);
+   children_.assign(numberOfCliques, std::vector<size_t>());
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      if(alias[i] == i && parent[i] != noClique_) {
+         size_t p = parent[i];
+         while(alias[p] != p) {
+            p = alias[p];
+         }
+         parent_[index[i]] = index[p];
+         children_[index[p]].push_back(index[i]);
+      }
+   }
+   cliqueOfVariable_.resize(numberOfVariables);
+   for(size_t i = 0; i < numberOfVariables; ++i) {
+      size_t c = i;
+      while(alias[c] != c) {
+         c = alias[c];
+      }
+      cliqueOfVariable_[eliminationOrder_[i]] = index[c];
+   }
+
+   // size of the tables
+   for(size_t c = 0; c < numberOfCliques; ++c) {
+      size_t size = 1;
+      for(size_t j = 0; j < cliques_[c].size(); ++j) {
+         const size_t numberOfLabels = gm_.numberOfLabels(cliques_[c][j]);
+         if(size > std::numeric_limits<size_t>::max() / numberOfLabels) {
+            throw RuntimeError("JunctionTree: the potential table of a clique is too large.");
+         }
+         size *= numberOfLabels;
+      }
+   }
+
+   // separators
+   separators_.assign(numberOfCliques, std::vector<IndexType>());
+   privateVariables_.assign(numberOfCliques, std::vector<IndexType>());
+   for(size_t c = 0; c < numberOfCliques; ++c) {
+      if(parent_[c] == noClique_) {
+         privateVariables_[c] = cliques_[c];
+      }
+      else {
+         const std::vector<IndexType>& pc = cliques_[parent_[c]];
+         std::set_intersection(cliques_[c].begin(), cliques_[c].end(), pc.begin(), pc.end(),
+            std::back_inserter(separators_[c]));
+         std::set_difference(cliques_[c].begin(), cliques_[c].end(), pc.begin(), pc.end(),
+            std::back_inserter(privateVariables_[c]));
+      }
+   }
+
+   // every factor is assigned to the clique of its first eliminated variable
+   cliqueFactors_.assign(numberOfCliques, std::vector<size_t>());
+   cliqueOfFactor_.assign(gm_.numberOfFactors(), noClique_);
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      if(gm_[f].numberOfVariables() == 0) {
+         continue;
+      }
+      IndexType first = gm_[f].variableIndex(0);
+      for(size_t j = 1; j < gm_[f].numberOfVariables(); ++j) {
+         if(position[gm_[f].variableIndex(j)] < position[first]) {
+            first = gm_[f].variableIndex(j);
+         }
+      }
+      cliqueOfFactor_[f] = cliqueOfVariable_[first];
+      cliqueFactors_[cliqueOfVariable_[first]].push_back(f);
+   }
+
+   // levels: cliques of the same depth (height) are independent
+   depthLevels_.clear();
+   std::vector<size_t> order;
+   std::vector<size_t> depth(numberOfCliques, 0);
+   for(size_t c = 0; c < numberOfCliques; ++c) {
+      if(parent_[c] == noClique_) {
+         order.push_back(c);
+      }
+   }
+   for(size_t i = 0; i < order.size(); ++i) {
+      const size_t c = order[i];
+      if(depth[c] == depthLevels_.size()) {
+         depthLevels_.push_back(std::vector<size_t>());
+      }
+      depthLevels_[depth[c]].push_back(c);
+      for(size_t j = 0; j < children_[c].size(); ++j) {
+         depth[children_[c][j]] = depth[c] + 1;
+         order.push_back(children_[c][j]);
+      }
+   }
+   OPENGM_ASSERT(order.size() == numberOfCliques);
+   std::vector<size_t> height(numberOfCliques, 0);
+   heightLevels_.clear();
+   for(size_t i = order.size(); i > 0; --i) {
+      const size_t c = order[i - 1];
+      for(size_t j = 0; j < children_[c].size(); ++j) {
+         height[c] = std::max(height[c], height[children_[c][j]] + 1);
+      }
+      if(height[c] >= heightLevels_.size()) {
+         heightLevels_.resize(height[c] + 1);
+      }
+      heightLevels_[height[c]].push_back(c);
+   }
+}
+
+template<class GM, class ACC>
+inline InferenceTermination
+JunctionTree<GM, ACC>::infer() {
+   EmptyVisitorType visitor;
+   return infer(visitor);
+}
+
+template<class GM, class ACC>
+template<class VISITOR>
+InferenceTermination
+JunctionTree<GM, ACC>::infer
+(
+   VISITOR& visitor
+) {
+   inferenceDone_ = false;
+   marginalsDone_ = false;
+   visitor.begin(*this);
+   collect();
+   if(ACC::hasbop()) {
+      decode();
+   }
+   inferenceDone_ = true;
+   if(parameter_.computeMarginals_) {
+      distribute();
+      marginalsDone_ = true;
+   }
+   visitor(*this);
+   visitor.end(*this);
+   return NORMAL;
+}
+
+/// messages from the leaves to the roots
+template<class GM, class ACC>
+void
+JunctionTree<GM, ACC>::collect() {
+   const size_t numberOfCliques = cliques_.size();
+   upBeliefs_.resize(numberOfCliques);
+   upMessages_.resize(numberOfCliques);
+   for(size_t h = 0; h < heightLevels_.size(); ++h) {
+      const std::vector<size_t>& level = heightLevels_[h];
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads())
+      #endif
+      for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(level.size()); ++i) {
+         const size_t c = level[i];
+         IndependentFactorType& belief = upBeliefs_[c];
+         belief.assign(gm_, cliques_[c].begin(), cliques_[c].end(), OperatorType::template neutral<ValueType>());
+         for(size_t j = 0; j < cliqueFactors_[c].size(); ++j) {
+            OperatorType::op(gm_[cliqueFactors_[c][j]], belief);
+         }
+         for(size_t j = 0; j < children_[c].size(); ++j) {
+            OperatorType::op(upMessages_[children_[c][j]], belief);
+         }
+         if(parent_[c] != noClique_) {
+            opengm::accumulate<ACC>(belief, privateVariables_[c].begin(), privateVariables_[c].end(), upMessages_[c]);
+         }
+      }
+   }
+}
+
+/// messages from the roots to the leaves, the message to a child is
+/// computed from the product of the messages of its siblings to avoid
+/// inverse operations
+template<class GM, class ACC>
+void
+JunctionTree<GM, ACC>::distribute() {
+   const size_t numberOfCliques = cliques_.size();
+   beliefs_.resize(numberOfCliques);
+   downMessages_.resize(numberOfCliques);
+   for(size_t d = 0; d < depthLevels_.size(); ++d) {
+      const std::vector<size_t>& level = depthLevels_[d];
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads())
+      #endif
+      for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(level.size()); ++i) {
+         const size_t c = level[i];
+         const std::vector<size_t>& children = children_[c];
+         beliefs_[c] = upBeliefs_[c];
+         if(parent_[c] != noClique_) {
+            OperatorType::op(downMessages_[c], beliefs_[c]);
+         }
+         if(children.empty()) {
+            continue;
+         }
+         // suffix[j] = potential * message from the parent * messages from the children j+1, ...
+         std::vector<IndependentFactorType> suffix(children.size());
+         suffix.back().assign(gm_, cliques_[c].begin(), cliques_[c].end(), OperatorType::template neutral<ValueType>());
+         for(size_t j = 0; j < cliqueFactors_[c].size(); ++j) {
+            OperatorType::op(gm_[cliqueFactors_[c][j]], suffix.back());
+         }
+         if(parent_[c] != noClique_) {
+            OperatorType::op(downMessages_[c], suffix.back());
+         }
+         for(size_t j = children.size() - 1; j > 0; --j) {
+            suffix[j - 1] = suffix[j];
+            OperatorType::op(upMessages_[children[j]], suffix[j - 1]);
+         }
+         // prefix = messages from the children 0, ..., j-1
+         IndependentFactorType prefix(OperatorType::template neutral<ValueType>());
+         IndependentFactorType product;
+         std::vector<IndexType> eliminate;
+         for(size_t j = 0; j < children.size(); ++j) {
+            const size_t child = children[j];
+            product = suffix[j];
+            if(j != 0) {
+               OperatorType::op(prefix, product);
+            }
+            eliminate.clear();
+            std::set_difference(cliques_[c].begin(), cliques_[c].end(),
+               separators_[child].begin(), separators_[child].end(), std::back_inserter(eliminate));
+            opengm::accumulate<ACC>(product, eliminate.begin(), eliminate.end(), downMessages_[child]);
+            if(j == 0) {
+               prefix = upMessages_[child];
+            }
+            else {
+               OperatorType::op(upMessages_[child], prefix);
+            }
+         }
+      }
+   }
+}
+
+template<class GM, class ACC>
+inline int
+JunctionTree<GM, ACC>::numberOfThreads() const {
+   #ifdef WITH_OPENMP
+   return parameter_.numberOfThreads_ != 0 ? static_cast<int>(parameter_.numberOfThreads_) : omp_get_max_threads();
+   #else
+   return 1;
+   #endif
+}
+
+/// optimal labeling from the roots to the leaves: the belief of a clique is
+/// conditioned on the labels of its separator
+template<class GM, class ACC>
+void
+JunctionTree<GM, ACC>::decode() {
+   arg_.assign(gm_.numberOfVariables(), 0);
+   optimum_ = OperatorType::template neutral<ValueType>();
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      if(gm_[f].numberOfVariables() == 0) {
+         const LabelType* noLabel = 0;
+         OperatorType::op(gm_[f](noLabel), optimum_);
+      }
+   }
+   IndependentFactorType belief;
+   std::vector<LabelType> separatorLabels;
+   std::vector<LabelType> labels;
+   for(size_t d = 0; d < depthLevels_.size(); ++d) {
+      for(size_t i = 0; i < depthLevels_[d].size(); ++i) {
+         const size_t c = depthLevels_[d][i];
+         belief = upBeliefs_[c];
+         if(parent_[c] != noClique_) {
+            separatorLabels.resize(separators_[c].size());
+            for(size_t j = 0; j < separators_[c].size(); ++j) {
+               separatorLabels[j] = arg_[separators_[c][j]];
+            }
+            belief.fixVariables(separators_[c].begin(), separators_[c].end(), separatorLabels.begin());
+         }
+         OPENGM_ASSERT(belief.numberOfVariables() == privateVariables_[c].size());
+         ValueType value;
+         belief.template accumulate<ACC>(value, labels);
+         for(size_t j = 0; j < privateVariables_[c].size(); ++j) {
+            arg_[privateVariables_[c][j]] = labels[j];
+         }
+         if(parent_[c] == noClique_) {
+            OperatorType::op(value, optimum_);
+         }
+      }
+   }
+}
+
+template<class GM, class ACC>
+InferenceTermination
+JunctionTree<GM, ACC>::arg
+(
+   std::vector<LabelType>& conf,
+   const size_t n
+) const {
+   if(n != 1 || !ACC::hasbop()) {
+      return UNKNOWN;
+   }
+   if(!inferenceDone_) {
+      conf.assign(gm_.numberOfVariables(), 0);
+      return UNKNOWN;
+   }
+   conf = arg_;
+   return NORMAL;
+}
+
+/// optimal value (MAP) which is also a tight bound
+template<class GM, class ACC>
+typename JunctionTree<GM, ACC>::ValueType
+JunctionTree<GM, ACC>::bound() const {
+   if(!inferenceDone_ || !ACC::hasbop()) {
+      return Inference<GM, ACC>::bound();
+   }
+   return optimum_;
+}
+
+template<class GM, class ACC>
+InferenceTermination
+JunctionTree<GM, ACC>::marginal
+(
+   const size_t variableIndex,
+   IndependentFactorType& out
+) const {
+   OPENGM_ASSERT(variableIndex < gm_.numberOfVariables());
+   if(!marginalsDone_) {
+      return UNKNOWN;
+   }
+   const size_t c = cliqueOfVariable_[variableIndex];
+   std::vector<IndexType> eliminate;
+   for(size_t j = 0; j < cliques_[c].size(); ++j) {
+      if(cliques_[c][j] != variableIndex) {
+         eliminate.push_back(cliques_[c][j]);
+      }
+   }
+   opengm::accumulate<ACC>(beliefs_[c], eliminate.begin(), eliminate.end(), out);
+   Normalization::normalize<ACC, OperatorType>(out);
+   return NORMAL;
+}
+
+template<class GM, class ACC>
+InferenceTermination
+JunctionTree<GM, ACC>::factorMarginal
+(
+   const size_t factorIndex,
+   IndependentFactorType& out
+) const {
+   OPENGM_ASSERT(factorIndex < gm_.numberOfFactors());
+   if(!marginalsDone_ || cliqueOfFactor_[factorIndex] == noClique_) {
+      return UNKNOWN;
+   }
+   const size_t c = cliqueOfFactor_[factorIndex];
+   std::vector<IndexType> variables(gm_[factorIndex].variableIndicesBegin(), gm_[factorIndex].variableIndicesEnd());
+   std::sort(variables.begin(), variables.end());
+   std::vector<IndexType> eliminate;
+   std::set_difference(cliques_[c].begin(), cliques_[c].end(),
+      variables.begin(), variables.end(), std::back_inserter(eliminate));
+   opengm::accumulate<ACC>(beliefs_[c], eliminate.begin(), eliminate.end(), out);
+   Normalization::normalize<ACC, OperatorType>(out);
+   return NORMAL;
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_JUNCTIONTREE_HXX
@@ -8,6 +8,8 @@
 #include <iostream>
 #include <stdexcept>
 #include <list>
+#include <algorithm>
+#include <limits>
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/inference.hxx"
@@ -16,6 +18,10 @@
 #include "opengm/operations/minimizer.hxx"
 #include "opengm/utilities/tribool.hxx"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace opengm {
 
 /// \cond HIDDEN_SYMBOLS
@@ -113,6 +119,15 @@ private:
 /// \brief A generalization of ICM\n\n
 /// B. Andres, J. H. Kappes, U. Koethe and Hamprecht F. A., The Lazy Flipper: MAP Inference in Higher-Order Graphical Models by Depth-limited Exhaustive Search, Technical Report, 2010, http://arxiv.org/abs/1009.4102
 ///
+/// With Parameter::parallel_ the variables are partitioned into regions
+/// (consecutive chunks of a breadth first order). The subgraphs of the
+/// interior variables of all regions (variables without neighbors in other
+/// regions) are searched concurrently. Then the subgraphs close to region
+/// boundaries, and close to variables flipped in this serial phase, are
+/// searched until no flip improves the labeling. Thus, the result is
+/// optimal w.r.t. all flips of at most maxSubgraphSize connected variables
+/// and, for a fixed number of regions, independent of the number of threads.
+///
 /// \ingroup inference 
 template<class GM, class ACC = Minimizer>
 class LazyFlipper : public Inference<GM, ACC> {
@@ -150,7 +165,10 @@ public:
       )
       :  maxSubgraphSize_(maxSubgraphSize),
          startingPoint_(stateBegin, stateEnd),
-         inferMultilabel_(inferMultilabel)
+         inferMultilabel_(inferMultilabel),
+         parallel_(false),
+         numberOfRegions_(0),
+         numberOfThreads_(0)
       {}
 
       Parameter(
@@ -159,7 +177,10 @@ public:
       )
       :  maxSubgraphSize_(maxSubgraphSize), 
          startingPoint_(),
-         inferMultilabel_(inferMultilabel)
+         inferMultilabel_(inferMultilabel),
+         parallel_(false),
+         numberOfRegions_(0),
+         numberOfThreads_(0)
       {}
 
       template<class P>
@@ -168,12 +189,21 @@ public:
       )
       :  maxSubgraphSize_(p.maxSubgraphSize_),
          startingPoint_(p.startingPoint_),
-         inferMultilabel_(p.inferMultilabel_)
+         inferMultilabel_(p.inferMultilabel_),
+         parallel_(p.parallel_),
+         numberOfRegions_(p.numberOfRegions_),
+         numberOfThreads_(p.numberOfThreads_)
       {}
 
       size_t maxSubgraphSize_;
       std::vector<LabelType> startingPoint_;
       Tribool inferMultilabel_;
+      /// search the subgraphs of disjoint regions concurrently
+      bool parallel_;
+      /// number of regions (0 = number of threads)
+      size_t numberOfRegions_;
+      /// number of OpenMP threads (0 = OpenMP default)
+      size_t numberOfThreads_;
    };
 
    //LazyFlipper(const GraphicalModelType&, const size_t = 2, const Tribool useMultilabelInference = Tribool::Maybe);
@@ -199,6 +229,9 @@ private:
    template<class VisitorType>
       InferenceTermination inferMultiLabel(VisitorType&); 
    InferenceTermination inferMultiLabel(); 
+   template<class VisitorType>
+      InferenceTermination inferParallel(VisitorType&, const bool);
+   void restrictTo(const std::vector<IndexType>&, const std::vector<LabelType>&);
 
    SubgraphForestNode appendVariableToPath(SubgraphForestNode);
    SubgraphForestNode generateFirstPathOfLength(const size_t);
@@ -218,6 +251,13 @@ private:
    SubgraphForest subgraphForest_;
    size_t maxSubgraphSize_;
    Tribool useMultilabelInference_;
+   bool parallel_;
+   size_t numberOfRegions_;
+   size_t numberOfThreads_;
+   // restriction of the subgraph search (see restrictTo)
+   bool restricted_;
+   std::vector<IndexType> allowedVariables_;
+   std::vector<unsigned char> isAllowed_;
 };
 
 // implementation of Tagging
@@ -649,7 +689,13 @@ LazyFlipper<GM, ACC>::LazyFlipper(
    movemaker_(Movemaker<GM>(gm)),
    subgraphForest_(SubgraphForest()),
    maxSubgraphSize_(param.maxSubgraphSize_),
-   useMultilabelInference_(param.inferMultilabel_)
+   useMultilabelInference_(param.inferMultilabel_),
+   parallel_(param.parallel_),
+   numberOfRegions_(param.numberOfRegions_),
+   numberOfThreads_(param.numberOfThreads_),
+   restricted_(false),
+   allowedVariables_(),
+   isAllowed_()
 {
    if(gm_.numberOfVariables() == 0) {
       throw RuntimeError("The graphical model has no variables.");
@@ -780,6 +826,9 @@ LazyFlipper<GM, ACC>::infer(
       }
    }
 
+   if(parallel_) {
+      return this->inferParallel(visitor, multiLabel);
+   }
    if(multiLabel) {
       return this->inferMultiLabel(visitor);
    }
@@ -971,6 +1020,225 @@ LazyFlipper<GM, ACC>::inferMultiLabel()
    return this->inferMultiLabel(visitor);
 }
 
+// Restrict the search to connected subgraphs of the given variables
+// (sorted) and set these variables and their neighbors to the given labels.
+// The subgraph forest is cleared.
+template<class GM, class ACC>
+void
+LazyFlipper<GM, ACC>::restrictTo(
+   const std::vector<IndexType>& variables,
+   const std::vector<LabelType>& labels
+)
+{
+   OPENGM_ASSERT(labels.size() == gm_.numberOfVariables());
+   isAllowed_.resize(gm_.numberOfVariables());
+   for(size_t j=0; j<allowedVariables_.size(); ++j) {
+      isAllowed_[allowedVariables_[j]] = 0;
+   }
+   allowedVariables_ = variables;
+   restricted_ = true;
+   std::vector<IndexType> touched;
+   for(size_t j=0; j<allowedVariables_.size(); ++j) {
+      const IndexType v = allowedVariables_[j];
+      isAllowed_[v] = 1;
+      touched.push_back(v);
+      for(Adjacency::const_iterator it = variableAdjacency_.neighborsBegin(v);
+         it != variableAdjacency_.neighborsEnd(v); ++it) {
+            touched.push_back(*it);
+      }
+   }
+   std::sort(touched.begin(), touched.end());
+   touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+   std::vector<IndexType> moveIndices;
+   std::vector<LabelType> moveLabels;
+   for(size_t j=0; j<touched.size(); ++j) {
+      if(movemaker_.state(touched[j]) != labels[touched[j]]) {
+         moveIndices.push_back(touched[j]);
+         moveLabels.push_back(labels[touched[j]]);
+      }
+   }
+   movemaker_.move(moveIndices.begin(), moveIndices.end(), moveLabels.begin());
+   subgraphForest_ = SubgraphForest();
+   deactivateAllVariables(0);
+   deactivateAllVariables(1);
+}
+
+template<class GM, class ACC>
+template<class VisitorType>
+InferenceTermination
+LazyFlipper<GM, ACC>::inferParallel(
+   VisitorType& visitor,
+   const bool multiLabel
+)
+{
+   #ifdef WITH_OPENMP
+   const size_t numberOfThreads = numberOfThreads_ > 0 ? numberOfThreads_ : static_cast<size_t>(omp_get_max_threads());
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+   const size_t numberOfVariables = gm_.numberOfVariables();
+   const size_t numberOfRegions = std::min(numberOfVariables,
+      numberOfRegions_ == 0 ? numberOfThreads : numberOfRegions_);
+
+   // regions: consecutive chunks of a breadth first order of the variables
+   std::vector<size_t> region(numberOfVariables);
+   {
+      std::vector<IndexType> order;
+      order.reserve(numberOfVariables);
+      std::vector<unsigned char> visited(numberOfVariables, 0);
+      for(size_t s=0; s<numberOfVariables; ++s) {
+         if(visited[s]) {
+            continue;
+         }
+         visited[s] = 1;
+         size_t head = order.size();
+         order.push_back(s);
+         while(head < order.size()) {
+            const IndexType v = order[head++];
+            for(Adjacency::const_iterator it = variableAdjacency_.neighborsBegin(v);
+               it != variableAdjacency_.neighborsEnd(v); ++it) {
+                  if(!visited[*it]) {
+                     visited[*it] = 1;
+                     order.push_back(*it);
+                  }
+            }
+         }
+      }
+      for(size_t j=0; j<numberOfVariables; ++j) {
+         region[order[j]] = (j * numberOfRegions) / numberOfVariables;
+      }
+   }
+
+   // interior variables (all neighbors in the same region) of each region and
+   // boundary variables (with a neighbor in another region)
+   std::vector<std::vector<IndexType> > interior(numberOfRegions);
+   std::vector<IndexType> boundary;
+   for(size_t v=0; v<numberOfVariables; ++v) {
+      bool isInterior = true;
+      for(Adjacency::const_iterator it = variableAdjacency_.neighborsBegin(v);
+         it != variableAdjacency_.neighborsEnd(v); ++it) {
+            if(region[*it] != region[v]) {
+               isInterior = false;
+               break;
+            }
+      }
+      if(isInterior) {
+         interior[region[v]].push_back(v);
+      }
+      else {
+         boundary.push_back(v);
+      }
+   }
+
+   visitor.begin(*this);
+   std::vector<LabelType> labels(movemaker_.stateBegin(), movemaker_.stateEnd());
+   const Parameter workerParameter(maxSubgraphSize_, labels.begin(), labels.end(), Tribool(multiLabel));
+   // one lazy flipper per thread, reused for all regions
+   std::vector<LazyFlipper<GM, ACC>*> workers(numberOfThreads, static_cast<LazyFlipper<GM, ACC>*>(NULL));
+   std::vector<std::vector<LabelType> > results(numberOfRegions);
+   EmptyVisitorType emptyVisitor;
+
+   // subgraphs of interior variables (concurrently). Interior variables of
+   // different regions are not adjacent, hence these subgraphs and the
+   // factors connected to them do not depend on other regions.
+   #pragma omp parallel for schedule(dynamic) num_threads(static_cast<int>(numberOfThreads))
+   for(std::ptrdiff_t r=0; r<static_cast<std::ptrdiff_t>(numberOfRegions); ++r) {
+      #ifdef WITH_OPENMP
+      const size_t t = omp_get_thread_num();
+      #else
+      const size_t t = 0;
+      #endif
+      if(interior[r].empty()) {
+         continue;
+      }
+      if(workers[t] == NULL) {
+         workers[t] = new LazyFlipper<GM, ACC>(gm_, workerParameter);
+      }
+      LazyFlipper<GM, ACC>& worker = *workers[t];
+      worker.restrictTo(interior[r], labels);
+      if(multiLabel) {
+         worker.inferMultiLabel(emptyVisitor);
+      }
+      else {
+         worker.inferBinaryLabel(emptyVisitor);
+      }
+      results[r].resize(interior[r].size());
+      for(size_t j=0; j<interior[r].size(); ++j) {
+         results[r][j] = worker.movemaker_.state(interior[r][j]);
+      }
+   }
+   for(size_t r=0; r<numberOfRegions; ++r) {
+      for(size_t j=0; j<interior[r].size(); ++j) {
+         labels[interior[r][j]] = results[r][j];
+      }
+   }
+   movemaker_.initialize(labels.begin());
+
+   // subgraphs that are not improvable any more lie within distance
+   // maxSubgraphSize-1 of a boundary variable. They are searched serially.
+   // Each flip can make subgraphs within distance maxSubgraphSize of the
+   // flipped variables improvable, which are searched in the next round.
+   if(visitor(*this) == visitors::VisitorReturnFlag::ContinueInf && !boundary.empty()) {
+      if(workers[0] == NULL) {
+         workers[0] = new LazyFlipper<GM, ACC>(gm_, workerParameter);
+      }
+      LazyFlipper<GM, ACC>& worker = *workers[0];
+      const size_t noDistance = std::numeric_limits<size_t>::max();
+      std::vector<size_t> distance(numberOfVariables, noDistance);
+      std::vector<IndexType> seeds = boundary;
+      size_t maxDistance = maxSubgraphSize_ - 1;
+      while(!seeds.empty()) {
+         // ball of radius maxDistance around the seeds
+         std::vector<IndexType> ball(seeds);
+         for(size_t j=0; j<ball.size(); ++j) {
+            distance[ball[j]] = 0;
+         }
+         for(size_t j=0; j<ball.size(); ++j) {
+            const IndexType v = ball[j];
+            if(distance[v] < maxDistance) {
+               for(Adjacency::const_iterator it = variableAdjacency_.neighborsBegin(v);
+                  it != variableAdjacency_.neighborsEnd(v); ++it) {
+                     if(distance[*it] == noDistance) {
+                        distance[*it] = distance[v] + 1;
+                        ball.push_back(*it);
+                     }
+               }
+            }
+         }
+         for(size_t j=0; j<ball.size(); ++j) {
+            distance[ball[j]] = noDistance;
+         }
+         std::sort(ball.begin(), ball.end());
+         worker.restrictTo(ball, labels);
+         if(multiLabel) {
+            worker.inferMultiLabel(emptyVisitor);
+         }
+         else {
+            worker.inferBinaryLabel(emptyVisitor);
+         }
+         seeds.clear();
+         for(size_t j=0; j<ball.size(); ++j) {
+            if(labels[ball[j]] != worker.movemaker_.state(ball[j])) {
+               labels[ball[j]] = worker.movemaker_.state(ball[j]);
+               seeds.push_back(ball[j]);
+            }
+         }
+         maxDistance = maxSubgraphSize_;
+         if(!seeds.empty()) {
+            movemaker_.initialize(labels.begin());
+            if(visitor(*this) != visitors::VisitorReturnFlag::ContinueInf) {
+               break;
+            }
+         }
+      }
+   }
+   for(size_t t=0; t<workers.size(); ++t) {
+      delete workers[t];
+   }
+   visitor.end(*this);
+   return NORMAL;
+}
+
 template<class GM, class ACC>
 inline InferenceTermination
 LazyFlipper<GM, ACC>::arg(
@@ -1037,7 +1305,9 @@ LazyFlipper<GM, ACC>::appendVariableToPath(
       while(q != NONODE) {
          for(Adjacency::const_iterator it = variableAdjacency_.neighborsBegin(subgraphForest_.value(q));
             it != variableAdjacency_.neighborsEnd(subgraphForest_.value(q)); ++it) {
-               candidateVariableIndices.insert(*it);
+               if(!restricted_ || isAllowed_[*it]) {
+                  candidateVariableIndices.insert(*it);
+               }
          }
          q = subgraphForest_.parent(q);
       }
@@ -1093,6 +1363,12 @@ LazyFlipper<GM, ACC>::generateFirstPathOfLength(
    }
    else {
       if(length == 1) {
+         if(restricted_) {
+            if(allowedVariables_.empty()) {
+               return NONODE;
+            }
+            return subgraphForest_.push_back(allowedVariables_[0], NONODE);
+         }
          SubgraphForestNode p = subgraphForest_.push_back(0, NONODE);
          // variable index = 0, parent = NONODE
          return p;
@@ -1120,6 +1396,16 @@ LazyFlipper<GM, ACC>::generateNextPathOfSameLength(
 )
 {
    if(subgraphForest_.level(predecessor) == 0) {
+      if(restricted_) {
+         typename std::vector<IndexType>::const_iterator it = std::upper_bound(
+            allowedVariables_.begin(), allowedVariables_.end(), subgraphForest_.value(predecessor));
+         if(it == allowedVariables_.end()) {
+            return NONODE;
+         }
+         SubgraphForestNode newNode = subgraphForest_.push_back(*it, NONODE);
+         subgraphForest_.setLevelOrderSuccessor(predecessor, newNode);
+         return newNode;
+      }
       if(subgraphForest_.value(predecessor) + 1 < gm_.numberOfVariables()) {
          SubgraphForestNode newNode =
             subgraphForest_.push_back(subgraphForest_.value(predecessor) + 1, NONODE);
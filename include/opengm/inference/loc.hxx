@@ -5,17 +5,20 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <stdexcept>
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
 #include <cmath>
 #include <queue>
 #include <deque>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 #include "opengm/opengm.hxx"
 #include "opengm/utilities/random.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/movemaker.hxx"
-#include "opengm/inference/external/ad3.hxx"
 
 #include <cmath>
 #include <algorithm>
@@ -32,9 +35,10 @@
 #include <opengm/inference/messagepassing/messagepassing.hxx>
 #include "opengm/inference/visitors/visitors.hxx"
 
-// external (autoinc)
-#include "opengm/inference/external/ad3.hxx"
 // external (inclued by with)
+#ifdef WITH_AD3
+#include "opengm/inference/external/ad3.hxx"
+#endif
 #ifdef WITH_CPLEX
 #include "opengm/inference/lpcplex.hxx"
 #endif
@@ -47,7 +51,15 @@ namespace opengm {
 /// In this implementation, the user needs to set the parameter of the 
 /// truncated geometric distribution by hand. Depending on the size of
 /// the subgraph, either A* or exhaustive search is used for MAP 
-/// estimation on the subgraph 
+/// estimation on the subgraph. The submodels are built as views of the
+/// factors of the model, tree submodels are solved by dynamic programming
+/// on these views with a workspace that is reused for all submodels.
+///
+/// With Parameter::parallel_, batches of windows are optimized
+/// concurrently. The windows of one batch and their boundaries do not
+/// overlap, so their moves are independent. The moves are committed in
+/// the order of the seeds, and only if they do not increase the energy.
+/// The result does not depend on the number of threads.
 /// \ingroup inference 
 template<class GM, class ACC>
 class LOC : public Inference<GM, ACC> {
@@ -62,7 +74,7 @@ public:
    typedef opengm::visitors::TimingVisitor<LOC<GM,ACC> >    TimingVisitorType;
 
 
-   typedef SubmodelOptimizer<GM,ACC> SubOptimizer;
+   typedef PooledSubmodelOptimizer<GM,ACC> SubOptimizer;
    typedef typename SubOptimizer::SubGmType SubGmType;
 
    // subsolvers 
@@ -75,8 +87,10 @@ public:
    typedef opengm::MessagePassing<SubGmType, AccumulationType,UpdateRulesTypeBp  , opengm::MaxDistance> BpSubInf;
    typedef opengm::MessagePassing<SubGmType, AccumulationType,UpdateRulesTypeTrbp, opengm::MaxDistance> TrBpSubInf;
 
-   // external (autoincluded)
+   // external
+   #ifdef WITH_AD3
    typedef opengm::external::AD3Inf<SubGmType,AccumulationType> Ad3SubInf;
+   #endif
    #ifdef WITH_CPLEX
    typedef opengm::LPCplex<SubGmType,AccumulationType> LpCplexSubInf;
    #endif
@@ -98,11 +112,14 @@ public:
       /// \param phi parameter of the truncated geometric distribution is used to select a certain subgraph radius with a certain probability
       /// \param maxRadius maximum radius for the subgraphes which are optimized within opengm:::LOC
       /// \param maxIteration maximum number of iterations (in one iteration on subgraph gets) optimized
+      /// \param solver subsolver of the blocks, the default is "ad3" if WITH_AD3 is defined and "astar" otherwise
       /// \param ad3Threshold if the subgraph size is bigger than ad3Threshold opengm::external::Ad3Inf is used to optimize the subgraphes
       /// \param stopAfterNBadIterations stop after n iterations without improvement
+      /// \param parallel optimize batches of non-overlapping windows concurrently
+      /// \param numberOfThreads number of OpenMP threads (0 = OpenMP default)
       Parameter
       (
-         const std::string solver="ad3",
+         const std::string solver=defaultSolver(),
          const double phi = 0.3,
          const size_t maxBlockRadius  = 50,
          const size_t maxTreeRadius = 50,
@@ -111,7 +128,9 @@ public:
          const size_t stopAfterNBadIterations=10000,
          const size_t maxBlockSize = 0,
          const size_t maxTreeSize     =0,
-         const int treeRuns        =1
+         const int treeRuns        =1,
+         const bool parallel       =false,
+         const size_t numberOfThreads =0
       )
       :  solver_(solver),
          phi_(phi),
@@ -121,7 +140,11 @@ public:
          maxIterations_(maxIterations),
          stopAfterNBadIterations_(stopAfterNBadIterations),
          maxBlockSize_(maxBlockSize),
-         treeRuns_(treeRuns)
+         maxTreeSize_(maxTreeSize),
+         treeRuns_(treeRuns),
+         parallel_(parallel),
+         numberOfThreads_(numberOfThreads),
+         windowsPerBatch_(64)
       {
 
       }
@@ -139,11 +162,25 @@ public:
          maxIterations_(p.maxIterations_),
          stopAfterNBadIterations_(p.stopAfterNBadIterations_),
          maxBlockSize_(p.maxBlockSize_),
-         treeRuns_(p.treeRuns_)
+         maxTreeSize_(p.maxTreeSize_),
+         treeRuns_(p.treeRuns_),
+         parallel_(p.parallel_),
+         numberOfThreads_(p.numberOfThreads_),
+         windowsPerBatch_(p.windowsPerBatch_)
       {
 
       }
       
+      /// default subsolver, "ad3" needs the flag WITH_AD3
+      static std::string defaultSolver()
+      {
+         #ifdef WITH_AD3
+         return "ad3";
+         #else
+         return "astar";
+         #endif
+      }
+
       // subsolver used for submodel ("ad3" or "astar" so far)
       std::string solver_;
       /// phi of the truncated geometric distribution is used to select a certain subgraph radius with a certain probability
@@ -163,6 +200,12 @@ public:
       size_t maxBlockSize_;
       size_t maxTreeSize_;
       int treeRuns_;
+      /// optimize batches of non-overlapping windows concurrently
+      bool parallel_;
+      /// number of OpenMP threads (0 = OpenMP default)
+      size_t numberOfThreads_;
+      /// maximum number of windows (seeds) per batch
+      size_t windowsPerBatch_;
    };
 
    LOC(const GraphicalModelType&, const Parameter& param = Parameter());
@@ -221,6 +264,9 @@ public:
 
 
 private:
+   template<class VisitorType>
+      void inferParallel(VisitorType&, opengm::RandomDiscreteWeighted<size_t, double>&, opengm::RandomDiscreteWeighted<size_t, double>&);
+   void resetSubgraph();
    void getSubgraphVis(const size_t, const size_t, std::vector<size_t>&);
    void getSubgraphTreeVis(const size_t, const size_t, std::vector<size_t>&);
    void inline initializeProbabilities(std::vector<double>&,const size_t maxRadius);
@@ -231,6 +277,7 @@ private:
    std::vector<bool> usedVi_;
    std::vector<bool> checkedVi_;
    std::vector<UInt64Type> distance_;
+   std::vector<IndexType> touchedVi_;
 
 
    // submodel
@@ -242,6 +289,7 @@ private:
 
 
    bool optimizeSubmodel(std::vector<size_t> & subgraphVi,const bool);
+   bool solveSubmodel(SubOptimizer&, std::vector<size_t>&, const bool, std::vector<LabelType>&);
 };
 
 template<class GM, class ACC>
@@ -257,6 +305,7 @@ LOC<GM, ACC>::LOC
    usedVi_(gm.numberOfVariables(), false),
    checkedVi_(gm.numberOfVariables(), false),
    distance_(gm.numberOfVariables()), 
+   touchedVi_(),
    subOptimizer_(gm),
    cleanRegion_(gm.numberOfVariables(),false)
 {
@@ -274,6 +323,9 @@ LOC<GM, ACC>::reset()
 {
    movemaker_.reset();
    std::fill(usedVi_.begin(),usedVi_.end(),false);
+   std::fill(checkedVi_.begin(),checkedVi_.end(),false);
+   std::fill(distance_.begin(),distance_.end(),0);
+   touchedVi_.clear();
    // compute variable adjacency is not nessesary
    // since reset assumes that the structure of
    // the graphical model has not changed
@@ -332,6 +384,18 @@ LOC<GM, ACC>::graphicalModel() const {
    return gm_;
 }
 
+// reset the marks of the variables visited by the last subgraph growth
+template<class GM, class ACC>
+inline void
+LOC<GM, ACC>::resetSubgraph() {
+   for(size_t i=0;i<touchedVi_.size();++i) {
+      usedVi_[touchedVi_[i]]=false;
+      checkedVi_[touchedVi_[i]]=false;
+      distance_[touchedVi_[i]]=0;
+   }
+   touchedVi_.clear();
+}
+
 template<class GM, class ACC>
 void LOC<GM, ACC>::getSubgraphVis
 (
@@ -339,15 +403,14 @@ void LOC<GM, ACC>::getSubgraphVis
    const size_t radius,
    std::vector<size_t>& vis
 ) {
-   std::fill(usedVi_.begin(),usedVi_.end(),false);
+   resetSubgraph();
    vis.clear();
    vis.push_back(startVi);
    usedVi_[startVi]=true;
+   touchedVi_.push_back(startVi);
    std::queue<size_t> viQueue;
    viQueue.push(startVi);
 
-   std::fill(distance_.begin(),distance_.begin()+gm_.numberOfVariables(),0);
-
    const size_t maxSgSize = (param_.maxBlockSize_==0? gm_.numberOfVariables() :param_.maxBlockSize_);
    while(viQueue.size()!=0  &&  vis.size()<=maxSgSize) {
       size_t cvi=viQueue.front();
@@ -359,6 +422,7 @@ void LOC<GM, ACC>::getSubgraphVis
          if(usedVi_[vn]==false) {
             // set as visited
             usedVi_[vn]=true;
+            touchedVi_.push_back(vn);
             // insert into the subgraph vis
             distance_[vn]=distance_[cvi]+1;
             if(distance_[vn]<=radius){
@@ -385,20 +449,18 @@ void LOC<GM, ACC>::getSubgraphTreeVis
 ) {
 
    //std::cout<<"build tree\n";
-   std::fill(usedVi_.begin(),usedVi_.end(),false);
-   std::fill(checkedVi_.begin(),checkedVi_.end(),false);
+   resetSubgraph();
    vis.clear();
    vis.push_back(startVi);
    usedVi_[startVi]=true;
    checkedVi_[startVi]=true;
+   touchedVi_.push_back(startVi);
    std::deque<IndexType> viQueue;
    viQueue.push_back(startVi);
 
    bool first=true;
    const size_t maxSgSize = (param_.maxTreeSize_==0? gm_.numberOfVariables() :param_.maxTreeSize_);
 
-   std::fill(distance_.begin(),distance_.begin()+gm_.numberOfVariables(),0);
-   //std::fill(distance_.begin(),distance_.begin()+vis.size(),0);
 
    while(viQueue.size()!=0 && /*r<radius &&*/  vis.size()<=maxSgSize) {
       IndexType cvi=viQueue.front();
@@ -459,6 +521,9 @@ void LOC<GM, ACC>::getSubgraphTreeVis
                //std::cout<<"in 3....\n";
                // insert into queue
 
+               if(distance_[vn]==0){
+                  touchedVi_.push_back(vn);
+               }
                distance_[vn]=distance_[cvi]+1;
                if(distance_[vn]<=radius)
                   viQueue.push_back(vn);
@@ -524,63 +589,68 @@ LOC<GM, ACC>::infer
    }
 
 
-   for(IndexType run=0;run<2;++run){
-      std::vector<bool> coverdVar(gm_.numberOfVariables(),false);
+   if(param_.parallel_){
+      inferParallel(visitor,randomRadiusBlock,randomRadiusTree);
+   }
+   else{
+      for(IndexType run=0;run<2;++run){
+         std::vector<bool> coverdVar(gm_.numberOfVariables(),false);
 
-      for(IndexType vi=0;vi<gm_.numberOfVariables();++vi){
-         if(coverdVar[vi]==false){
-            size_t viStart = vi;
-             // select random radius block and tree
-            size_t radiusBlock   = (useBlocks ? randomRadiusBlock()+1 : 0);
-            size_t radiusTree    = (useTrees  ? randomRadiusTree()+1  : 0);
+         for(IndexType vi=0;vi<gm_.numberOfVariables();++vi){
+            if(coverdVar[vi]==false){
+               size_t viStart = vi;
+                // select random radius block and tree
+               size_t radiusBlock   = (useBlocks ? randomRadiusBlock()+1 : 0);
+               size_t radiusTree    = (useTrees  ? randomRadiusTree()+1  : 0);
 
 
-            //std::cout<<"viStart "<<viStart<<" rt "<<radiusTree<<" rb "<<radiusBlock<<"\n";
+               //std::cout<<"viStart "<<viStart<<" rt "<<radiusTree<<" rb "<<radiusBlock<<"\n";
 
         
 
             
-            if(useTrees){
-                  //std::cout<<"get'n optimize tree model\n";
-                  if(param_.treeRuns_>0){
-                     for(size_t tr=0;tr<(size_t)(param_.treeRuns_);++tr){
-                        this->getSubgraphTreeVis(viStart, radiusTree, subgGraphViTree);
-                        std::sort(subgGraphViTree.begin(), subgGraphViTree.end());
-                        optimizeSubmodel(subgGraphViTree,true);
+               if(useTrees){
+                     //std::cout<<"get'n optimize tree model\n";
+                     if(param_.treeRuns_>0){
+                        for(size_t tr=0;tr<(size_t)(param_.treeRuns_);++tr){
+                           this->getSubgraphTreeVis(viStart, radiusTree, subgGraphViTree);
+                           std::sort(subgGraphViTree.begin(), subgGraphViTree.end());
+                           optimizeSubmodel(subgGraphViTree,true);
+                        }
                      }
-                  }
-                  else{
-                     size_t nTr=(param_.treeRuns_==0? 1: std::abs(param_.treeRuns_));
-                     bool changes=true;
-                     while(changes){
-                        this->getSubgraphTreeVis(viStart, radiusTree, subgGraphViTree);
-                        std::sort(subgGraphViTree.begin(), subgGraphViTree.end());
-                        changes=false;
-                        for(size_t tr=0;tr<nTr;++tr){
+                     else{
+                        size_t nTr=(param_.treeRuns_==0? 1: std::abs(param_.treeRuns_));
+                        bool changes=true;
+                        while(changes){
                            this->getSubgraphTreeVis(viStart, radiusTree, subgGraphViTree);
                            std::sort(subgGraphViTree.begin(), subgGraphViTree.end());
-                           bool c=optimizeSubmodel(subgGraphViTree,true);
-                           if(c){
-                              changes=true;
+                           changes=false;
+                           for(size_t tr=0;tr<nTr;++tr){
+                              this->getSubgraphTreeVis(viStart, radiusTree, subgGraphViTree);
+                              std::sort(subgGraphViTree.begin(), subgGraphViTree.end());
+                              bool c=optimizeSubmodel(subgGraphViTree,true);
+                              if(c){
+                                 changes=true;
+                              }
                            }
                         }
                      }
+               }
+               //std::cout<<"bevore block "<<movemaker_.value()<<"\n";
+               if(useBlocks){
+                  this->getSubgraphVis(viStart, radiusBlock, subgGraphViBLock);
+                  std::sort(subgGraphViBLock.begin(), subgGraphViBLock.end());
+                  optimizeSubmodel(subgGraphViBLock,false);
+
+                  for(IndexType lvi=0;lvi<subgGraphViBLock.size();++lvi){
+                     coverdVar[subgGraphViBLock[lvi]]=true;
                   }
-            }
-            //std::cout<<"bevore block "<<movemaker_.value()<<"\n";
-            if(useBlocks){
-               this->getSubgraphVis(viStart, radiusBlock, subgGraphViBLock);
-               std::sort(subgGraphViBLock.begin(), subgGraphViBLock.end());
-               optimizeSubmodel(subgGraphViBLock,false);
-
-               for(IndexType lvi=0;lvi<subgGraphViBLock.size();++lvi){
-                  coverdVar[subgGraphViBLock[lvi]]=true;
                }
-            }
-            //std::cout<<"after block "<<movemaker_.value()<<"\n";
+               //std::cout<<"after block "<<movemaker_.value()<<"\n";
         
-            //std::cout<<"after tree  "<<movemaker_.value()<<"\n";
-            visitor(*this);
+               //std::cout<<"after tree  "<<movemaker_.value()<<"\n";
+               visitor(*this);
+            }
          }
       }
    }
@@ -653,47 +723,7 @@ bool LOC<GM, ACC>::optimizeSubmodel(std::vector<size_t> & subgGraphVi,const bool
    bool changes=false;
    std::vector<LabelType> states;
    if(subgGraphVi.size()>2){
-      subOptimizer_.setVariableIndices(subgGraphVi.begin(), subgGraphVi.end());
-
-
-      if (useTrees){
-         //std::cout<<"infer with tres\n";
-         changes = subOptimizer_.mergeFactorsAndInferDp(states);
-         //changes = subOptimizer_. template inferSubmodel<BpSubInf>(typename BpSubInf::Parameter() ,states);
-         //changes = subOptimizer_. template inferSubmodel<DpSubInf>(typename DpSubInf::Parameter() ,states);
-         //std::cout<<"infer with tress\n";
-      }
-      // OPTIMAL OR MONOTON MOVERS
-      else if(param_.solver_==std::string("ad3")){
-         changes = subOptimizer_. template inferSubmodelInplace<Ad3SubInf>(typename Ad3SubInf::Parameter(Ad3SubInf::AD3_ILP) ,states);
-      }
-
-      else if (param_.solver_==std::string("astar")){
-         //changes = subOptimizer_. template inferSubmodel<AStarSubInf>(typename AStarSubInf::Parameter() ,states);
-      }
-      else if (param_.solver_==std::string("cplex")){
-         #ifdef WITH_CPLEX
-            //typedef opengm::LPCplex<SubGmType,AccumulationType> LpCplexSubInf;
-            typename LpCplexSubInf::Parameter subParam;
-            subParam.integerConstraint_=true;
-            changes = subOptimizer_. template inferSubmodel<LpCplexSubInf>(subParam ,states); 
-         #else  
-            throw RuntimeError("solver cplex needs flag WITH_CPLEX defined bevore the #include of LOC sovler");
-         #endif  
-      }
-      // MONOTON MOVERS
-      else if(param_.solver_[0]=='l' && param_.solver_[1]=='f'){
-         std::stringstream ss;
-         for(size_t i=2;i<param_.solver_.size();++i){
-            ss<<param_.solver_[i];
-         }
-         size_t maxSgSize;
-         ss>>maxSgSize;
-         changes = subOptimizer_. template inferSubmodel<LfSubInf>(typename LfSubInf::Parameter(maxSgSize) ,states,true,true);  
-      }
-
-      subOptimizer_.unsetVariableIndices();
-
+      changes = solveSubmodel(subOptimizer_,subgGraphVi,useTrees,states);
       if(changes){
          movemaker_.move(subgGraphVi.begin(), subgGraphVi.end(), states.begin());
          for(IndexType v=0;v<subgGraphVi.size();++v){
@@ -708,6 +738,259 @@ bool LOC<GM, ACC>::optimizeSubmodel(std::vector<size_t> & subgGraphVi,const bool
    return changes;
 }
 
+// optimal (or improving) labels of a submodel w.r.t. the labels of the optimizer
+template<class GM, class ACC>
+bool LOC<GM, ACC>::solveSubmodel
+(
+   SubOptimizer& optimizer,
+   std::vector<size_t>& subgGraphVi,
+   const bool useTrees,
+   std::vector<LabelType>& states
+) {
+   bool changes=false;
+   optimizer.setVariableIndices(subgGraphVi.begin(), subgGraphVi.end());
+   if (useTrees){
+      changes = optimizer.inferDynamicProgramming(states);
+   }
+   // OPTIMAL OR MONOTON MOVERS
+   else if(param_.solver_==std::string("ad3")){
+      #ifdef WITH_AD3
+         changes = optimizer. template inferSubmodelInplace<Ad3SubInf>(typename Ad3SubInf::Parameter(Ad3SubInf::AD3_ILP) ,states);
+      #else
+         throw RuntimeError("solver ad3 needs flag WITH_AD3 defined bevore the #include of LOC sovler");
+      #endif
+   }
+
+   else if (param_.solver_==std::string("astar")){
+      changes = optimizer. template inferSubmodel<AStarSubInf>(typename AStarSubInf::Parameter() ,states);
+   }
+   else if (param_.solver_==std::string("cplex")){
+      #ifdef WITH_CPLEX
+         //typedef opengm::LPCplex<SubGmType,AccumulationType> LpCplexSubInf;
+         typename LpCplexSubInf::Parameter subParam;
+         subParam.integerConstraint_=true;
+         changes = optimizer. template inferSubmodel<LpCplexSubInf>(subParam ,states); 
+      #else  
+         throw RuntimeError("solver cplex needs flag WITH_CPLEX defined bevore the #include of LOC sovler");
+      #endif  
+   }
+   // MONOTON MOVERS
+   else if(param_.solver_[0]=='l' && param_.solver_[1]=='f'){
+      std::stringstream ss;
+      for(size_t i=2;i<param_.solver_.size();++i){
+         ss<<param_.solver_[i];
+      }
+      size_t maxSgSize;
+      ss>>maxSgSize;
+      changes = optimizer. template inferSubmodel<LfSubInf>(typename LfSubInf::Parameter(maxSgSize) ,states,true,true);  
+   }
+
+   optimizer.unsetVariableIndices();
+   return changes;
+}
+
+template<class GM, class ACC>
+template<class VisitorType>
+void LOC<GM, ACC>::inferParallel
+(
+   VisitorType& visitor,
+   opengm::RandomDiscreteWeighted<size_t, double>& randomRadiusBlock,
+   opengm::RandomDiscreteWeighted<size_t, double>& randomRadiusTree
+) {
+   #ifdef WITH_OPENMP
+   const size_t numberOfThreads = param_.numberOfThreads_ > 0 ? param_.numberOfThreads_ : static_cast<size_t>(omp_get_max_threads());
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+   const IndexType numberOfVariables = gm_.numberOfVariables();
+   const bool useTrees  = param_.maxTreeRadius_  > 0;
+   const bool useBlocks = param_.maxBlockRadius_ > 0;
+   // tree runs with treeRuns_ <= 0 are repeated until the trees do not change
+   const size_t treeRuns = !useTrees ? 0 : (param_.treeRuns_ == 0 ? 1 : static_cast<size_t>(std::abs(param_.treeRuns_)));
+   const size_t windowsPerSeed = treeRuns + (useBlocks ? 1 : 0);
+   const size_t maxSeeds = std::max(param_.windowsPerBatch_, static_cast<size_t>(1));
+
+   // one submodel optimizer per thread, all of them know the current labels
+   struct SubOptimizers {
+      ~SubOptimizers() {
+         for(size_t t=0;t<pointers_.size();++t) {
+            delete pointers_[t];
+         }
+      }
+      std::vector<SubOptimizer*> pointers_;
+   } subOptimizers;
+   std::vector<SubOptimizer*>& optimizers = subOptimizers.pointers_;
+   optimizers.resize(numberOfThreads, static_cast<SubOptimizer*>(NULL));
+   for(size_t t=0;t<numberOfThreads;++t) {
+      optimizers[t] = new SubOptimizer(gm_);
+      for(IndexType vi=0;vi<numberOfVariables;++vi) {
+         optimizers[t]->setLabel(vi,movemaker_.state(vi));
+      }
+   }
+   std::vector<std::vector<LabelType> > states(numberOfThreads);
+   // exceptions must not leave the parallel loop, they are rethrown after it
+   std::vector<RuntimeError> errors(maxSeeds, RuntimeError(""));
+   std::vector<unsigned char> failed(maxSeeds, 0);
+
+   // windows of the seeds of one batch, the union of the windows of a seed
+   // and the labels of this union after the optimization
+   std::vector<std::vector<size_t> > windows(maxSeeds * windowsPerSeed);
+   std::vector<std::vector<IndexType> > seedVariables(maxSeeds);
+   std::vector<std::vector<LabelType> > seedLabels(maxSeeds);
+   std::vector<unsigned char> seedChanges(maxSeeds);
+   // windows of the batch and their boundaries
+   std::vector<unsigned char> reserved(numberOfVariables, 0);
+   std::vector<IndexType> reservedVis;
+
+   for(IndexType run=0;run<2;++run){
+      std::vector<bool> coverdVar(numberOfVariables,false);
+      IndexType firstSeed=0;
+      while(true) {
+         while(firstSeed<numberOfVariables && coverdVar[firstSeed]) {
+            ++firstSeed;
+         }
+         if(firstSeed==numberOfVariables) {
+            break;
+         }
+
+         // schedule seeds whose windows do not intersect the windows and
+         // boundaries of the seeds scheduled before, the other seeds are
+         // deferred to later batches
+         size_t numberOfSeeds=0;
+         for(IndexType vi=firstSeed;vi<numberOfVariables && numberOfSeeds<maxSeeds;++vi) {
+            if(coverdVar[vi] || reserved[vi]) {
+               continue;
+            }
+            std::vector<IndexType>& variables = seedVariables[numberOfSeeds];
+            variables.clear();
+            for(size_t w=0;w<windowsPerSeed;++w) {
+               std::vector<size_t>& window = windows[numberOfSeeds * windowsPerSeed + w];
+               if(w<treeRuns) {
+                  this->getSubgraphTreeVis(vi, randomRadiusTree()+1, window);
+               }
+               else {
+                  this->getSubgraphVis(vi, randomRadiusBlock()+1, window);
+               }
+               std::sort(window.begin(), window.end());
+               variables.insert(variables.end(), window.begin(), window.end());
+            }
+            std::sort(variables.begin(), variables.end());
+            variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+            bool conflict=false;
+            for(size_t v=0;v<variables.size() && !conflict;++v) {
+               conflict = reserved[variables[v]]!=0;
+            }
+            if(conflict) {
+               continue;
+            }
+            for(size_t v=0;v<variables.size();++v) {
+               const IndexType u=variables[v];
+               for(size_t n=0;n<=viAdjacency_[u].size();++n) {
+                  const IndexType r = n<viAdjacency_[u].size() ? viAdjacency_[u][n] : u;
+                  if(reserved[r]==0) {
+                     reserved[r]=1;
+                     reservedVis.push_back(r);
+                  }
+               }
+            }
+            coverdVar[vi]=true;
+            if(useBlocks) {
+               const std::vector<size_t>& block = windows[numberOfSeeds * windowsPerSeed + treeRuns];
+               for(size_t v=0;v<block.size();++v) {
+                  coverdVar[block[v]]=true;
+               }
+            }
+            ++numberOfSeeds;
+         }
+
+         // optimize the windows of the seeds concurrently
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(dynamic) num_threads(static_cast<int>(numberOfThreads))
+         #endif
+         for(std::ptrdiff_t j=0;j<static_cast<std::ptrdiff_t>(numberOfSeeds);++j) {
+            #ifdef WITH_OPENMP
+            const size_t t = omp_get_thread_num();
+            #else
+            const size_t t = 0;
+            #endif
+            SubOptimizer& optimizer = *optimizers[t];
+            try {
+               bool changes=false;
+               bool treeChanges=true;
+               while(treeChanges) {
+                  treeChanges=false;
+                  for(size_t w=0;w<treeRuns;++w) {
+                     std::vector<size_t>& window = windows[j * windowsPerSeed + w];
+                     if(window.size()>2 && solveSubmodel(optimizer,window,true,states[t])) {
+                        for(size_t v=0;v<window.size();++v) {
+                           optimizer.setLabel(window[v],states[t][v]);
+                        }
+                        treeChanges=true;
+                        changes=true;
+                     }
+                  }
+                  if(param_.treeRuns_>0) {
+                     break;
+                  }
+               }
+               if(useBlocks) {
+                  std::vector<size_t>& window = windows[j * windowsPerSeed + treeRuns];
+                  if(window.size()>2 && solveSubmodel(optimizer,window,false,states[t])) {
+                     for(size_t v=0;v<window.size();++v) {
+                        optimizer.setLabel(window[v],states[t][v]);
+                     }
+                     changes=true;
+                  }
+               }
+               seedChanges[j]=changes;
+               seedLabels[j].resize(seedVariables[j].size());
+               for(size_t v=0;v<seedVariables[j].size();++v) {
+                  seedLabels[j][v]=optimizer.label(seedVariables[j][v]);
+               }
+            }
+            catch(const RuntimeError& e) {
+               errors[j]=e;
+               failed[j]=1;
+            }
+            catch(const std::exception& e) {
+               errors[j]=RuntimeError(e.what());
+               failed[j]=1;
+            }
+            catch(...) {
+               errors[j]=RuntimeError("unknown exception in the optimization of a submodel");
+               failed[j]=1;
+            }
+         }
+         for(size_t j=0;j<numberOfSeeds;++j) {
+            if(failed[j]) {
+               throw errors[j];
+            }
+         }
+
+         // commit the moves in the order of the seeds
+         for(size_t j=0;j<numberOfSeeds;++j) {
+            const std::vector<IndexType>& variables = seedVariables[j];
+            if(seedChanges[j]) {
+               const ValueType value = movemaker_.valueAfterMove(variables.begin(), variables.end(), seedLabels[j].begin());
+               if(!ACC::bop(movemaker_.value(), value)) {
+                  movemaker_.move(variables.begin(), variables.end(), seedLabels[j].begin());
+               }
+            }
+            for(size_t t=0;t<numberOfThreads;++t) {
+               for(size_t v=0;v<variables.size();++v) {
+                  optimizers[t]->setLabel(variables[v],movemaker_.state(variables[v]));
+               }
+            }
+         }
+         for(size_t i=0;i<reservedVis.size();++i) {
+            reserved[reservedVis[i]]=0;
+         }
+         reservedVis.clear();
+         visitor(*this);
+      }
+   }
+}
+
 
 template<class GM, class ACC>
 inline InferenceTermination
@@ -7,12 +7,16 @@
 #include <list>
 #include <typeinfo>
 #include <limits>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 #include <opengm/datastructures/marray/marray.hxx>
 #include <opengm/inference/inference.hxx>
 #include <opengm/inference/visitors/visitors.hxx>
 #include <opengm/datastructures/linear_constraint.hxx>
 #include <opengm/inference/auxiliary/lp_functiontransfer.hxx>
+#include <opengm/inference/auxiliary/constraint_separation.hxx>
 #include <opengm/functions/constraint_functions/linear_constraint_function_base.hxx>
 #include <opengm/utilities/metaprogramming.hxx>
 #include <opengm/utilities/subsequence_iterator.hxx>
@@ -264,6 +268,7 @@ protected:
    void addLocalPolytopeConstraints();
    void addLoosePolytopeConstraints();
    void addTightPolytopeConstraints();
+   void assembleLocalPolytopeConstraints(const bool variableConstraints, const bool factorConstraints, std::vector<size_t>& rowBegin, std::vector<SolverIndexType>& variableIDs, std::vector<SolverValueType>& coefficients, std::vector<SolverValueType>& bounds) const;
 
    // LP variables mapping functions
    SolverIndexType nodeLPVariableIndex(const IndexType nodeID, const LabelType label) const;
@@ -297,6 +302,8 @@ protected:
    template <typename Parameter::Relaxation RELAXATION, typename Parameter::ChallengeHeuristic HEURISTIC, bool ADD_ALL_VIOLATED_CONSTRAINTS>
    bool tightenPolytopeRelaxed();
    void checkInactiveConstraint(const ConstraintStorage& constraint, double& weight) const;
+   void checkInactiveConstraint(const ConstraintStorage& constraint, const SolverSolutionIteratorType currentSolution, double& weight) const;
+   void findViolatedInactiveConstraints(std::vector<std::pair<InactiveConstraintsListIteratorType, double> >& violatedConstraints, const size_t maxNumConstraints, const bool sortByWeight);
    void addInactiveConstraint(const ConstraintStorage& constraint);
 
    // friends
@@ -1213,6 +1220,26 @@ struct AddViolatedLinearConstraintsRelaxedFunctor {
  *         polytope relaxation.
  */
 
+/*! \fn void LPInferenceBase::assembleLocalPolytopeConstraints(const bool variableConstraints, const bool factorConstraints, std::vector<size_t>& rowBegin, std::vector<SolverIndexType>& variableIDs, std::vector<SolverValueType>& coefficients, std::vector<SolverValueType>& bounds) const
+ *  \brief Assemble the variable and factor constraints of the local polytope
+ *         in compressed sparse row format.
+ *
+ *  The size of each constraint is known in advance from the shapes of the
+ *  factors, hence the offsets of all constraints are computed first and the
+ *  constraints are filled in parallel. The order of the constraints and of
+ *  the entries within each constraint is the same as in
+ *  LPInferenceBase::addLocalPolytopeVariableConstraint and
+ *  LPInferenceBase::addLocalPolytopeFactorConstraint.
+ *
+ *  \param[in] variableConstraints Assemble the variable constraints.
+ *  \param[in] factorConstraints Assemble the factor constraints.
+ *  \param[out] rowBegin Start of each constraint in variableIDs and
+ *                       coefficients (number of constraints + 1 entries).
+ *  \param[out] variableIDs The lp variables of all constraints.
+ *  \param[out] coefficients The coefficients of all constraints.
+ *  \param[out] bounds The right hand sides of the (equality) constraints.
+ */
+
 /*! \fn LPInferenceBase::SolverIndexType LPInferenceBase::nodeLPVariableIndex(const IndexType nodeID, const LabelType label) const
  *  \brief Get the lp variable which corresponds to the variable label pair of
  *         the graphical model.
@@ -1587,6 +1614,36 @@ struct AddViolatedLinearConstraintsRelaxedFunctor {
  *                     set to 0.0 if the constraint is not violated.
  */
 
+/*! \fn void LPInferenceBase::checkInactiveConstraint(const ConstraintStorage& constraint, const SolverSolutionIteratorType currentSolution, double& weight) const
+ *  \brief Check if a given linear constraint from the local polytope
+ *         constraints is violated by a given solution.
+ *
+ *  \param[in] constraint The linear constraint which will be checked for
+ *                        violation.
+ *  \param[in] currentSolution Iterator pointing to the begin of the current
+ *                             solution of the LP/MIP model.
+ *  \param[out] weight The weight by which the constraint is violated. Will be
+ *                     set to 0.0 if the constraint is not violated.
+ */
+
+/*! \fn void LPInferenceBase::findViolatedInactiveConstraints(std::vector<std::pair<InactiveConstraintsListIteratorType, double> >& violatedConstraints, const size_t maxNumConstraints, const bool sortByWeight)
+ *  \brief Find the violated linear constraints from the local polytope
+ *         constraints which are not yet added to the LP/MIP model.
+ *
+ *  The inactive constraints are checked in parallel if OpenMP is enabled.
+ *
+ *  \param[out] violatedConstraints The violated constraints and the weights
+ *                                  by which they are violated.
+ *  \param[in] maxNumConstraints The maximum number of violated constraints
+ *                               (all if set to 0).
+ *  \param[in] sortByWeight If set to true, the violated constraints with the
+ *                          largest weights are selected by a
+ *                          opengm::ViolatedConstraintPool (which also removes
+ *                          duplicates) and sorted by decreasing weight.
+ *                          Otherwise the first violated constraints of the
+ *                          list of inactive constraints are selected.
+ */
+
 /*! \fn void LPInferenceBase::addInactiveConstraint(const ConstraintStorage& constraint)
  *  \brief Add a linear constraint from the local polytope constraint to the
  *         LP/MIP model.
@@ -2196,20 +2253,30 @@ inline void LPInferenceBase<LP_INFERENCE_TYPE>::createObjectiveFunction() {
 
 template <class LP_INFERENCE_TYPE>
 inline void LPInferenceBase<LP_INFERENCE_TYPE>::addLocalPolytopeConstraints() {
-   // \sum_i \mu_i = 1
-   for(IndexType i = 0; i < gm_.numberOfVariables(); ++i) {
-      addLocalPolytopeVariableConstraint(i, true);
-   }
+   if(parameter_.nameConstraints_) {
+      // \sum_i \mu_i = 1
+      for(IndexType i = 0; i < gm_.numberOfVariables(); ++i) {
+         addLocalPolytopeVariableConstraint(i, true);
+      }
 
-   // \sum_i \mu_{f;i_1,...,i_n} - \mu{b;j}= 0
-   for(IndexType i = 0; i < higherOrderFactors_.size(); ++i) {
-      const IndexType factorIndex = higherOrderFactors_[i];
-      for(IndexType j = 0; j < gm_[factorIndex].numberOfVariables(); ++j) {
-         const IndexType node = gm_[factorIndex].variableIndex(j);
-         for(LabelType k = 0; k < gm_.numberOfLabels(node); k++) {
-            addLocalPolytopeFactorConstraint(i, j, k, true);
+      // \sum_i \mu_{f;i_1,...,i_n} - \mu{b;j}= 0
+      for(IndexType i = 0; i < higherOrderFactors_.size(); ++i) {
+         const IndexType factorIndex = higherOrderFactors_[i];
+         for(IndexType j = 0; j < gm_[factorIndex].numberOfVariables(); ++j) {
+            const IndexType node = gm_[factorIndex].variableIndex(j);
+            for(LabelType k = 0; k < gm_.numberOfLabels(node); k++) {
+               addLocalPolytopeFactorConstraint(i, j, k, true);
+            }
          }
       }
+   } else {
+      // both at once as one block
+      std::vector<size_t> rowBegin;
+      std::vector<SolverIndexType> variableIDs;
+      std::vector<SolverValueType> coefficients;
+      std::vector<SolverValueType> bounds;
+      assembleLocalPolytopeConstraints(true, true, rowBegin, variableIDs, coefficients, bounds);
+      static_cast<LPInferenceType*>(this)->addConstraints(rowBegin.begin(), rowBegin.end(), variableIDs.begin(), coefficients.begin(), bounds.begin(), bounds.begin());
    }
 
    // add constraints for linear constraint factor variables
@@ -2276,20 +2343,40 @@ inline void LPInferenceBase<LP_INFERENCE_TYPE>::addLocalPolytopeConstraints() {
 
 template <class LP_INFERENCE_TYPE>
 inline void LPInferenceBase<LP_INFERENCE_TYPE>::addLoosePolytopeConstraints() {
-   // \sum_i \mu_i = 1
-   for(IndexType i = 0; i < gm_.numberOfVariables(); ++i) {
-      addLocalPolytopeVariableConstraint(i, true);
-   }
+   if(parameter_.nameConstraints_) {
+      // \sum_i \mu_i = 1
+      for(IndexType i = 0; i < gm_.numberOfVariables(); ++i) {
+         addLocalPolytopeVariableConstraint(i, true);
+      }
 
-   // \sum_i \mu_{f;i_1,...,i_n} - \mu{b;j}= 0
-   for(IndexType i = 0; i < higherOrderFactors_.size(); ++i) {
-      const IndexType factorIndex = higherOrderFactors_[i];
-      for(IndexType j = 0; j < gm_[factorIndex].numberOfVariables(); ++j) {
-         const IndexType node = gm_[factorIndex].variableIndex(j);
-         for(LabelType k = 0; k < gm_.numberOfLabels(node); k++) {
-            addLocalPolytopeFactorConstraint(i, j, k, false);
+      // \sum_i \mu_{f;i_1,...,i_n} - \mu{b;j}= 0
+      for(IndexType i = 0; i < higherOrderFactors_.size(); ++i) {
+         const IndexType factorIndex = higherOrderFactors_[i];
+         for(IndexType j = 0; j < gm_[factorIndex].numberOfVariables(); ++j) {
+            const IndexType node = gm_[factorIndex].variableIndex(j);
+            for(LabelType k = 0; k < gm_.numberOfLabels(node); k++) {
+               addLocalPolytopeFactorConstraint(i, j, k, false);
+            }
          }
       }
+   } else {
+      std::vector<size_t> rowBegin;
+      std::vector<SolverIndexType> variableIDs;
+      std::vector<SolverValueType> coefficients;
+      std::vector<SolverValueType> bounds;
+      assembleLocalPolytopeConstraints(true, false, rowBegin, variableIDs, coefficients, bounds);
+      static_cast<LPInferenceType*>(this)->addConstraints(rowBegin.begin(), rowBegin.end(), variableIDs.begin(), coefficients.begin(), bounds.begin(), bounds.begin());
+
+      // factor constraints are inactive until they are violated
+      assembleLocalPolytopeConstraints(false, true, rowBegin, variableIDs, coefficients, bounds);
+      for(size_t i = 0; i + 1 < rowBegin.size(); ++i) {
+         inactiveConstraints_.push_back(ConstraintStorage());
+         ConstraintStorage& constraint = inactiveConstraints_.back();
+         constraint.variableIDs_.assign(variableIDs.begin() + rowBegin[i], variableIDs.begin() + rowBegin[i + 1]);
+         constraint.coefficients_.assign(coefficients.begin() + rowBegin[i], coefficients.begin() + rowBegin[i + 1]);
+         constraint.bound_ = bounds[i];
+         constraint.operator_ = LinearConstraintType::LinearConstraintOperatorType::Equal;
+      }
    }
 
    // add constraints for linear constraint factor variables
@@ -2379,6 +2466,90 @@ inline typename LPInferenceBase<LP_INFERENCE_TYPE>::SolverIndexType LPInferenceB
    return nodesLPVariablesOffset_[nodeID] + label;
 }
 
+template <class LP_INFERENCE_TYPE>
+inline void LPInferenceBase<LP_INFERENCE_TYPE>::assembleLocalPolytopeConstraints(const bool variableConstraints, const bool factorConstraints, std::vector<size_t>& rowBegin, std::vector<SolverIndexType>& variableIDs, std::vector<SolverValueType>& coefficients, std::vector<SolverValueType>& bounds) const {
+   // sizes of the variable constraints
+   const IndexType numVariableConstraints = variableConstraints ? gm_.numberOfVariables() : 0;
+   size_t numRows = numVariableConstraints;
+   size_t numEntries = 0;
+   for(IndexType i = 0; i < numVariableConstraints; ++i) {
+      numEntries += gm_.numberOfLabels(i);
+   }
+
+   // sizes of the factor constraints, each factor has one constraint per
+   // variable and label with factor size / number of labels + 1 entries
+   const IndexType numFactors = factorConstraints ? higherOrderFactors_.size() : 0;
+   std::vector<size_t> factorRowOffsets(numFactors);
+   std::vector<size_t> factorEntryOffsets(numFactors);
+   for(IndexType i = 0; i < numFactors; ++i) {
+      const FactorType& factor = gm_[higherOrderFactors_[i]];
+      factorRowOffsets[i] = numRows;
+      factorEntryOffsets[i] = numEntries;
+      for(IndexType j = 0; j < factor.numberOfVariables(); ++j) {
+         numRows += factor.numberOfLabels(j);
+         numEntries += factor.size() + factor.numberOfLabels(j);
+      }
+   }
+
+   rowBegin.resize(numRows + 1);
+   variableIDs.resize(numEntries);
+   coefficients.resize(numEntries);
+   bounds.resize(numRows);
+   rowBegin[numRows] = numEntries;
+
+   // \sum_i \mu_i = 1
+   size_t entry = 0;
+   for(IndexType i = 0; i < numVariableConstraints; ++i) {
+      rowBegin[i] = entry;
+      bounds[i] = 1.0;
+      for(LabelType j = 0; j < gm_.numberOfLabels(i); ++j) {
+         variableIDs[entry] = nodeLPVariableIndex(i, j);
+         coefficients[entry] = 1.0;
+         ++entry;
+      }
+   }
+
+   // \sum_i \mu_{f;i_1,...,i_n} - \mu{b;j}= 0
+   #ifdef WITH_OPENMP
+   const int numThreads = parameter_.numberOfThreads_ > 0 ? static_cast<int>(parameter_.numberOfThreads_) : omp_get_max_threads();
+   #pragma omp parallel for schedule(dynamic, 64) num_threads(numThreads)
+   #endif
+   for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(numFactors); ++i) {
+      const IndexType factorIndex = higherOrderFactors_[i];
+      const FactorType& factor = gm_[factorIndex];
+      const size_t factorSize = factor.size();
+      const SolverIndexType factorOffset = factorLPVariableIndex(factorIndex, 0);
+      std::vector<size_t> positions;
+      size_t row = factorRowOffsets[i];
+      size_t factorEntry = factorEntryOffsets[i];
+      size_t stride = 1;
+      for(IndexType j = 0; j < factor.numberOfVariables(); ++j) {
+         const IndexType node = factor.variableIndex(j);
+         const LabelType numLabels = factor.numberOfLabels(j);
+         const size_t rowSize = factorSize / numLabels + 1;
+         positions.resize(numLabels);
+         for(LabelType k = 0; k < numLabels; ++k) {
+            rowBegin[row + k] = factorEntry + k * rowSize;
+            bounds[row + k] = 0.0;
+            positions[k] = rowBegin[row + k];
+            variableIDs[positions[k] + rowSize - 1] = nodeLPVariableIndex(node, k);
+            coefficients[positions[k] + rowSize - 1] = -1.0;
+         }
+         // the labelings of the factor are enumerated with the first variable
+         // changing fastest
+         for(size_t l = 0; l < factorSize; ++l) {
+            const LabelType k = static_cast<LabelType>((l / stride) % numLabels);
+            variableIDs[positions[k]] = factorOffset + static_cast<SolverIndexType>(l);
+            coefficients[positions[k]] = 1.0;
+            ++positions[k];
+         }
+         row += numLabels;
+         factorEntry += numLabels * rowSize;
+         stride *= numLabels;
+      }
+   }
+}
+
 template <class LP_INFERENCE_TYPE>
 inline typename LPInferenceBase<LP_INFERENCE_TYPE>::SolverIndexType LPInferenceBase<LP_INFERENCE_TYPE>::factorLPVariableIndex (const IndexType factorID, const size_t labelingIndex) const {
    OPENGM_ASSERT(factorID < gm_.numberOfFactors());
@@ -2909,33 +3080,13 @@ inline bool LPInferenceBase<LP_INFERENCE_TYPE>::tightenPolytope() {
    if(ADD_ALL_VIOLATED_CONSTRAINTS) {
       bool violatedConstraintAdded = false;
       if(RELAXATION == Parameter::LoosePolytope) {
-         double currentWeight;
-         InactiveConstraintsListIteratorType inactiveConstraintsBegin = inactiveConstraints_.begin();
-         InactiveConstraintsListIteratorType inactiveConstraintsEnd = inactiveConstraints_.end();
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               addInactiveConstraint(*inactiveConstraintsBegin);
-               violatedConstraintAdded = true;
-               const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-               ++inactiveConstraintsBegin;
-               inactiveConstraints_.erase(removeInactiveConstraintIterator);
-               break;
-            } else {
-               ++inactiveConstraintsBegin;
-            }
-         }
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               addInactiveConstraint(*inactiveConstraintsBegin);
-               const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-               ++inactiveConstraintsBegin;
-               inactiveConstraints_.erase(removeInactiveConstraintIterator);
-            } else {
-               ++inactiveConstraintsBegin;
-            }
+         std::vector<std::pair<InactiveConstraintsListIteratorType, double> > violatedConstraints;
+         findViolatedInactiveConstraints(violatedConstraints, 0, false);
+         for(size_t i = 0; i < violatedConstraints.size(); ++i) {
+            addInactiveConstraint(*(violatedConstraints[i].first));
+            inactiveConstraints_.erase(violatedConstraints[i].first);
          }
+         violatedConstraintAdded = !violatedConstraints.empty();
       }
 
       // add violated linear constraints from linear constraint factors
@@ -2970,32 +3121,15 @@ inline bool LPInferenceBase<LP_INFERENCE_TYPE>::tightenPolytope() {
       SortedViolatedConstraintsListType sortedViolatedConstraints;
 
       if(RELAXATION == Parameter::LoosePolytope) {
-         double currentWeight;
-         InactiveConstraintsListIteratorType inactiveConstraintsBegin = inactiveConstraints_.begin();
-         InactiveConstraintsListIteratorType inactiveConstraintsEnd = inactiveConstraints_.end();
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               if(HEURISTIC == Parameter::Random) {
-                  addInactiveConstraint(*inactiveConstraintsBegin);
-                  ++numConstraintsAdded;
-                  const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-                  ++inactiveConstraintsBegin;
-                  inactiveConstraints_.erase(removeInactiveConstraintIterator);
-                  if(numConstraintsAdded == parameter_.maxNumConstraintsPerIter_) {
-                     break;
-                  }
-               } else {
-                  sortedViolatedConstraints.insert(typename SortedViolatedConstraintsListType::value_type(currentWeight, std::make_pair(inactiveConstraintsBegin, std::make_pair(linearConstraintFactors_.size(), static_cast<const LinearConstraintType*>(NULL)))));
-                  if(sortedViolatedConstraints.size() > parameter_.maxNumConstraintsPerIter_) {
-                     // remove constraints with to small weight
-                     sortedViolatedConstraints.erase(sortedViolatedConstraints.begin());
-                     OPENGM_ASSERT(sortedViolatedConstraints.size() == parameter_.maxNumConstraintsPerIter_);
-                  }
-                  ++inactiveConstraintsBegin;
-               }
+         std::vector<std::pair<InactiveConstraintsListIteratorType, double> > violatedConstraints;
+         findViolatedInactiveConstraints(violatedConstraints, parameter_.maxNumConstraintsPerIter_, HEURISTIC != Parameter::Random);
+         for(size_t i = 0; i < violatedConstraints.size(); ++i) {
+            if(HEURISTIC == Parameter::Random) {
+               addInactiveConstraint(*(violatedConstraints[i].first));
+               ++numConstraintsAdded;
+               inactiveConstraints_.erase(violatedConstraints[i].first);
             } else {
-               ++inactiveConstraintsBegin;
+               sortedViolatedConstraints.insert(typename SortedViolatedConstraintsListType::value_type(violatedConstraints[i].second, std::make_pair(violatedConstraints[i].first, std::make_pair(linearConstraintFactors_.size(), static_cast<const LinearConstraintType*>(NULL)))));
             }
          }
       }
@@ -3052,33 +3186,13 @@ inline bool LPInferenceBase<LP_INFERENCE_TYPE>::tightenPolytopeRelaxed() {
    if(ADD_ALL_VIOLATED_CONSTRAINTS) {
       bool violatedConstraintAdded = false;
       if(RELAXATION == Parameter::LoosePolytope) {
-         double currentWeight;
-         InactiveConstraintsListIteratorType inactiveConstraintsBegin = inactiveConstraints_.begin();
-         InactiveConstraintsListIteratorType inactiveConstraintsEnd = inactiveConstraints_.end();
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               addInactiveConstraint(*inactiveConstraintsBegin);
-               violatedConstraintAdded = true;
-               const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-               ++inactiveConstraintsBegin;
-               inactiveConstraints_.erase(removeInactiveConstraintIterator);
-               break;
-            } else {
-               ++inactiveConstraintsBegin;
-            }
-         }
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               addInactiveConstraint(*inactiveConstraintsBegin);
-               const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-               ++inactiveConstraintsBegin;
-               inactiveConstraints_.erase(removeInactiveConstraintIterator);
-            } else {
-               ++inactiveConstraintsBegin;
-            }
+         std::vector<std::pair<InactiveConstraintsListIteratorType, double> > violatedConstraints;
+         findViolatedInactiveConstraints(violatedConstraints, 0, false);
+         for(size_t i = 0; i < violatedConstraints.size(); ++i) {
+            addInactiveConstraint(*(violatedConstraints[i].first));
+            inactiveConstraints_.erase(violatedConstraints[i].first);
          }
+         violatedConstraintAdded = !violatedConstraints.empty();
       }
 
       // add violated linear constraints from linear constraint factors
@@ -3113,32 +3227,15 @@ inline bool LPInferenceBase<LP_INFERENCE_TYPE>::tightenPolytopeRelaxed() {
       SortedViolatedConstraintsListType sortedViolatedConstraints;
 
       if(RELAXATION == Parameter::LoosePolytope) {
-         double currentWeight;
-         InactiveConstraintsListIteratorType inactiveConstraintsBegin = inactiveConstraints_.begin();
-         InactiveConstraintsListIteratorType inactiveConstraintsEnd = inactiveConstraints_.end();
-         while(inactiveConstraintsBegin != inactiveConstraintsEnd) {
-            checkInactiveConstraint(*inactiveConstraintsBegin, currentWeight);
-            if(currentWeight > parameter_.tolerance_) {
-               if(HEURISTIC == Parameter::Random) {
-                  addInactiveConstraint(*inactiveConstraintsBegin);
-                  ++numConstraintsAdded;
-                  const InactiveConstraintsListIteratorType removeInactiveConstraintIterator = inactiveConstraintsBegin;
-                  ++inactiveConstraintsBegin;
-                  inactiveConstraints_.erase(removeInactiveConstraintIterator);
-                  if(numConstraintsAdded == parameter_.maxNumConstraintsPerIter_) {
-                     break;
-                  }
-               } else {
-                  sortedViolatedConstraints.insert(typename SortedViolatedConstraintsListType::value_type(currentWeight, std::make_pair(inactiveConstraintsBegin, std::make_pair(linearConstraintFactors_.size(), static_cast<LinearConstraintType*>(NULL)))));
-                  if(sortedViolatedConstraints.size() > parameter_.maxNumConstraintsPerIter_) {
-                     // remove constraints with to small weight
-                     sortedViolatedConstraints.erase(sortedViolatedConstraints.begin());
-                     OPENGM_ASSERT(sortedViolatedConstraints.size() == parameter_.maxNumConstraintsPerIter_);
-                  }
-                  ++inactiveConstraintsBegin;
-               }
+         std::vector<std::pair<InactiveConstraintsListIteratorType, double> > violatedConstraints;
+         findViolatedInactiveConstraints(violatedConstraints, parameter_.maxNumConstraintsPerIter_, HEURISTIC != Parameter::Random);
+         for(size_t i = 0; i < violatedConstraints.size(); ++i) {
+            if(HEURISTIC == Parameter::Random) {
+               addInactiveConstraint(*(violatedConstraints[i].first));
+               ++numConstraintsAdded;
+               inactiveConstraints_.erase(violatedConstraints[i].first);
             } else {
-               ++inactiveConstraintsBegin;
+               sortedViolatedConstraints.insert(typename SortedViolatedConstraintsListType::value_type(violatedConstraints[i].second, std::make_pair(violatedConstraints[i].first, std::make_pair(linearConstraintFactors_.size(), static_cast<LinearConstraintType*>(NULL)))));
             }
          }
       }
@@ -3186,7 +3283,11 @@ inline bool LPInferenceBase<LP_INFERENCE_TYPE>::tightenPolytopeRelaxed() {
 
 template <class LP_INFERENCE_TYPE>
 inline void LPInferenceBase<LP_INFERENCE_TYPE>::checkInactiveConstraint(const ConstraintStorage& constraint, double& weight) const {
-   const SolverSolutionIteratorType currentSolution = static_cast<const LPInferenceType*>(this)->solutionBegin();
+   checkInactiveConstraint(constraint, static_cast<const LPInferenceType*>(this)->solutionBegin(), weight);
+}
+
+template <class LP_INFERENCE_TYPE>
+inline void LPInferenceBase<LP_INFERENCE_TYPE>::checkInactiveConstraint(const ConstraintStorage& constraint, const SolverSolutionIteratorType currentSolution, double& weight) const {
    double sum = 0.0;
    for(size_t i = 0; i < constraint.variableIDs_.size(); ++i) {
       sum += constraint.coefficients_[i] * currentSolution[constraint.variableIDs_[i]];
@@ -3220,6 +3321,69 @@ inline void LPInferenceBase<LP_INFERENCE_TYPE>::checkInactiveConstraint(const Co
    }
 }
 
+template <class LP_INFERENCE_TYPE>
+inline void LPInferenceBase<LP_INFERENCE_TYPE>::findViolatedInactiveConstraints(std::vector<std::pair<InactiveConstraintsListIteratorType, double> >& violatedConstraints, const size_t maxNumConstraints, const bool sortByWeight) {
+   typedef ViolatedConstraintPool<SolverIndexType, SolverValueType> ViolatedConstraintPoolType;
+
+   std::vector<InactiveConstraintsListIteratorType> inactiveConstraints;
+   inactiveConstraints.reserve(inactiveConstraints_.size());
+   for(InactiveConstraintsListIteratorType iter = inactiveConstraints_.begin(); iter != inactiveConstraints_.end(); ++iter) {
+      inactiveConstraints.push_back(iter);
+   }
+
+   // the solution is fetched once as the solver might update it lazily
+   const SolverSolutionIteratorType currentSolution = static_cast<const LPInferenceType*>(this)->solutionBegin();
+   #ifdef WITH_OPENMP
+   const size_t numThreads = parameter_.numberOfThreads_ > 0 ? static_cast<size_t>(parameter_.numberOfThreads_) : static_cast<size_t>(omp_get_max_threads());
+   #else
+   const size_t numThreads = 1;
+   #endif
+   ViolatedConstraintPoolType pool(sortByWeight ? maxNumConstraints : 0, numThreads);
+   std::vector<double> weights(sortByWeight ? 0 : inactiveConstraints.size());
+
+   #ifdef WITH_OPENMP
+   #pragma omp parallel for schedule(dynamic, 64) num_threads(static_cast<int>(numThreads))
+   #endif
+   for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(inactiveConstraints.size()); ++i) {
+      const ConstraintStorage& constraint = *inactiveConstraints[i];
+      double currentWeight;
+      checkInactiveConstraint(constraint, currentSolution, currentWeight);
+      if(!sortByWeight) {
+         weights[i] = currentWeight;
+      } else if(currentWeight > parameter_.tolerance_) {
+         #ifdef WITH_OPENMP
+         const size_t thread = omp_get_thread_num();
+         #else
+         const size_t thread = 0;
+         #endif
+         typename ViolatedConstraintPoolType::Sense sense = ViolatedConstraintPoolType::GreaterEqual;
+         if(constraint.operator_ == LinearConstraintType::LinearConstraintOperatorType::LessEqual) {
+            sense = ViolatedConstraintPoolType::LessEqual;
+         } else if(constraint.operator_ == LinearConstraintType::LinearConstraintOperatorType::Equal) {
+            sense = ViolatedConstraintPoolType::Equal;
+         }
+         pool.add(thread, constraint.variableIDs_.begin(), constraint.variableIDs_.end(), constraint.coefficients_.begin(), sense, constraint.bound_, currentWeight, i);
+      }
+   }
+
+   violatedConstraints.clear();
+   if(sortByWeight) {
+      pool.merge();
+      for(size_t i = 0; i < pool.size(); ++i) {
+         violatedConstraints.push_back(std::make_pair(inactiveConstraints[pool.id(i)], static_cast<double>(pool.violation(i))));
+      }
+   } else {
+      for(size_t i = 0; i < inactiveConstraints.size(); ++i) {
+         if(weights[i] > parameter_.tolerance_) {
+            violatedConstraints.push_back(std::make_pair(inactiveConstraints[i], weights[i]));
+            if(violatedConstraints.size() == maxNumConstraints) {
+               break;
+            }
+         }
+      }
+   }
+}
+
 template <class LP_INFERENCE_TYPE>
 inline void LPInferenceBase<LP_INFERENCE_TYPE>::addInactiveConstraint(const ConstraintStorage& constraint) {
    switch(constraint.operator_) {
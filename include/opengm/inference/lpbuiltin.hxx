@@ -0,0 +1,131 @@
+#ifndef OPENGM_LPBUILTIN_HXX_
+#define OPENGM_LPBUILTIN_HXX_
+
+#include <opengm/inference/auxiliary/lp_solver/lp_solver_builtin.hxx>
+#include <opengm/inference/lp_inference_base.hxx>
+
+namespace opengm {
+
+/********************
+ * class definition *
+ *******************/
+template<class GM_TYPE, class ACC_TYPE>
+class LPBuiltin : public LPSolverBuiltin, public LPInferenceBase<LPBuiltin<GM_TYPE, ACC_TYPE> > {
+public:
+   // typedefs
+   typedef ACC_TYPE                                                          AccumulationType;
+   typedef GM_TYPE                                                           GraphicalModelType;
+   OPENGM_GM_TYPE_TYPEDEFS;
+   typedef LPInferenceBase<LPBuiltin<GraphicalModelType, AccumulationType> > LPInferenceBaseType;
+   typedef typename LPInferenceBaseType::Parameter                           Parameter;
+
+   // construction
+   LPBuiltin(const GraphicalModelType& gm, const Parameter& parameter = Parameter());
+   virtual ~LPBuiltin();
+
+   // public member functions
+   virtual std::string name() const;
+
+   template<class _GM>
+   struct RebindGm{
+       typedef LPBuiltin<_GM, ACC_TYPE> type;
+   };
+
+   template<class _GM,class _ACC>
+   struct RebindGmAndAcc{
+       typedef LPBuiltin<_GM, _ACC > type;
+   };
+};
+
+template<class GM_TYPE, class ACC_TYPE>
+struct LPInferenceTraits<LPBuiltin<GM_TYPE, ACC_TYPE> > {
+   // typedefs
+   typedef ACC_TYPE                                              AccumulationType;
+   typedef GM_TYPE                                               GraphicalModelType;
+   typedef LPSolverBuiltin                                       SolverType;
+   typedef typename LPSolverBuiltin::BuiltinIndexType            SolverIndexType;
+   typedef typename LPSolverBuiltin::BuiltinValueType            SolverValueType;
+   typedef typename LPSolverBuiltin::BuiltinSolutionIteratorType SolverSolutionIteratorType;
+   typedef typename LPSolverBuiltin::BuiltinTimingType           SolverTimingType;
+   typedef typename LPSolverBuiltin::Parameter                   SolverParameterType;
+};
+
+/***********************
+ * class documentation *
+ **********************/
+/*! \file lpbuiltin.hxx
+ *  \brief Provides implementation for LP inference with the built-in LP solver.
+ */
+
+/*! \class LPBuiltin
+ *  \brief LP inference with the built-in LP solver.
+ *
+ *  This class combines opengm::LPSolverBuiltin and opengm::LPInferenceBase to
+ *  provide inference for graphical models without an external LP solver.
+ *  Only LP relaxations are supported, hence integerConstraintNodeVar_ and
+ *  integerConstraintFactorVar_ have to be false.
+ *
+ *  \tparam GM_TYPE Graphical Model type.
+ *  \tparam ACC_TYPE Accumulation type.
+ *
+ *  \ingroup inference
+ */
+
+/*! \typedef LPBuiltin::AccumulationType
+ *  \brief Typedef of the Accumulation type.
+ */
+
+/*! \typedef LPBuiltin::GraphicalModelType
+ *  \brief Typedef of the graphical model type.
+ */
+
+/*! \typedef LPBuiltin::LPInferenceBaseType
+ *  \brief Typedef of class opengm::LPInferenceBase with appropriate template
+ *         parameter.
+ */
+
+/*! \typedef LPBuiltin::Parameter
+ *  \brief Typedef of the parameter type defined by class
+ *         opengm::LPInferenceBase.
+ */
+
+/*! \fn LPBuiltin::LPBuiltin(const GraphicalModelType& gm, const Parameter& parameter = Parameter())
+ *  \brief LPBuiltin constructor.
+ *
+ *  \param[in] gm The graphical model for inference.
+ *  \param[in] parameter The parameter defining the settings for inference. See
+ *                       opengm::LPSolverInterface::Parameter and
+ *                       opengm::LPInferenceBase::Parameter for possible
+ *                       settings.
+ */
+
+/*! \fn LPBuiltin::~LPBuiltin()
+ *  \brief LPBuiltin destructor.
+ */
+
+/*! \fn std::string LPBuiltin::name() const
+ *  \brief Name of the inference method.
+ */
+
+/******************
+ * implementation *
+ *****************/
+template<class GM_TYPE, class ACC_TYPE>
+inline LPBuiltin<GM_TYPE, ACC_TYPE>::LPBuiltin(const GraphicalModelType& gm, const Parameter& parameter)
+   : LPSolverBuiltin(parameter), LPInferenceBaseType(gm, parameter) {
+
+}
+
+template<class GM_TYPE, class ACC_TYPE>
+inline LPBuiltin<GM_TYPE, ACC_TYPE>::~LPBuiltin() {
+
+}
+
+template<class GM_TYPE, class ACC_TYPE>
+inline std::string LPBuiltin<GM_TYPE, ACC_TYPE>::name() const {
+   return "LPBuiltin";
+}
+
+} // namespace opengm
+
+#endif /* OPENGM_LPBUILTIN_HXX_ */
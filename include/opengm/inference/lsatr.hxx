@@ -6,17 +6,13 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cmath>
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
-
-#include <maxflowlib.h>
-
-#ifndef NOVIGRA
-#include "vigra/multi_distance.hxx"
-#include "vigra/multi_array.hxx"
-#endif
+#include "opengm/inference/auxiliary/minstcutbk.hxx"
+#include "opengm/utilities/distance_transform.hxx"
 
 namespace opengm {
   
@@ -32,6 +28,13 @@ namespace opengm {
 /// * Corresponding/Reimplemented Matlab Code:
 ///    http://www.csd.uwo.ca/~ygorelic/downloads.html
 /// * Thanks to Lena Gorelick for very helpful comments
+///
+/// The submodular approximations are solved by the in-tree max-flow 
+/// MinSTCutBK. Its residual network and search trees are kept over all
+/// iterations, a new working point or trust region only changes the 
+/// terminal capacities of the nodes concerned. The Euclidean distance 
+/// of the trust region is computed exactly by EuclideanDistanceTransform
+/// on the grid (1D or 2D) detected from the model.
 /// \ingroup inference 
 
 
@@ -50,7 +53,6 @@ namespace opengm {
       enum DISTANCE {HAMMING, EUCLIDEAN};
       
       LSA_TR_HELPER() { distanceType_= EUCLIDEAN;};
-      ~LSA_TR_HELPER(){ if(graph_!=NULL){delete graph_; delete changedList_;}  };
       template<class GM>
       void init(const GM&, const std::vector<LabelType>& );
       void set(const double);
@@ -63,10 +65,10 @@ namespace opengm {
       void evalBoth(const std::vector<LabelType>& label, const std::vector<LabelType>& workingPoint, const double lambda, double& value, double& valueAprox) const;
 
    private: 
-      typedef maxflowLib::Graph<double,double,double>          graph_type;
-      typedef maxflowLib::Block<typename graph_type::node_id>  block_type;
+      typedef MinSTCutBK<size_t,double> graph_type;
 
       void updateDistance();
+      void addUnaries(const size_t, const double);
 
       size_t                            numVar_;
       double                            lambda_;
@@ -79,11 +81,13 @@ namespace opengm {
       std::vector<double>               approxUnaries_;
       std::vector< LSA_TR_WeightedEdge> supEdges_; 
       std::vector< LSA_TR_WeightedEdge> subEdges_;
-      graph_type*                       graph_; 
-      block_type*                       changedList_;
+      graph_type                        graph_; 
       bool                              solved_;
       DISTANCE                          distanceType_;
       std::vector<size_t>               shape_;
+      EuclideanDistanceTransform<double> distanceTransform_;
+      std::vector<double>               distance0_;
+      std::vector<double>               distance1_;
    };
 
 
@@ -185,6 +189,7 @@ namespace opengm {
       workingPoint_ = workingPoint;
       lambda_       = 0.2;
       constTerm_    = 0; 
+      constTermApproximation_ = 0;
       unaries_.resize(numVar_,0); 
       distance_.resize(numVar_,0);
  
@@ -231,12 +236,11 @@ namespace opengm {
       std::cout <<  subEdges_.size() <<" submodular edges."<<std::endl;
       std::cout <<  supEdges_.size() <<" supermodular edges."<<std::endl;
            
-      graph_       = new graph_type(gm.numberOfVariables(),subEdges_.size()+1);
-      changedList_ = new block_type(gm.numberOfVariables());
-     
-      graph_->add_node(numVar_); 
+      graph_.reset();
+      graph_.reserve(numVar_,subEdges_.size());
+      graph_.addNodes(numVar_); 
       for(size_t i=0; i<subEdges_.size(); ++i){
-         graph_->add_edge( subEdges_[i].u, subEdges_[i].v, subEdges_[i].w, subEdges_[i].w);
+         graph_.addArcs( subEdges_[i].u, subEdges_[i].v, subEdges_[i].w, subEdges_[i].w);
       }
       approxUnaries_.assign(unaries_.begin(),unaries_.end());
       for(size_t i=0; i<supEdges_.size(); ++i){
@@ -277,19 +281,28 @@ namespace opengm {
       } 
       if(shape_.size() ==1 && distanceType_ == EUCLIDEAN)
          std::cout << "Warning : Shape of labeling is 1 and Euclidean distance does not make sense! Maybe autodetection of shape fails ..." <<std::endl;
+      distanceTransform_.setShape(shape_.begin(),shape_.end());
           
     
 
       updateDistance();
       constTermTrustRegion_ = 0;
-      for(int i=0; i<approxUnaries_.size(); ++i){
+      for(size_t i=0; i<approxUnaries_.size(); ++i){
          approxUnaries_[i] += lambda_*distance_[i]; 
-         graph_->add_tweights( i, 0,  approxUnaries_[i]); 
+         addUnaries( i, approxUnaries_[i]); 
          if(distance_[i]<0)
             constTermTrustRegion_-=lambda_*distance_[i];
       }
    };
 
+   /// add the cost of label 1 to the terminal capacities of a node, 
+   /// unchanged nodes keep their search trees in the next max-flow
+   template<class LabelType>
+   inline void LSA_TR_HELPER<LabelType>::addUnaries(const size_t i, const double value) {
+      if(value != 0)
+         graph_.addTerminalWeights( i, 0, value );
+   }
+
    template<class LabelType>
    void LSA_TR_HELPER<LabelType>::updateDistance() {
       if (distanceType_==HAMMING){
@@ -302,96 +315,19 @@ namespace opengm {
             } 
          }
       }
-#ifdef NOVIGRA 
       else if(distanceType_==EUCLIDEAN){
-         std::cout << "Warning : The useage of euclidean distance requires VIGRA!" <<std::endl;
-         std::cout << " Vigra is disabled -> Switch to Hamming distance!" <<std::endl;
-         distanceType_=HAMMING;
-         for(int i=0; i<numVar_; ++i){
+         // distance of label 0 to the nearest label 1 and vice versa 
+         distanceTransform_(workingPoint_.begin(), LabelType(1), distance1_);
+         distanceTransform_(workingPoint_.begin(), LabelType(0), distance0_);
+         for(size_t i=0; i<numVar_; ++i){
             if(workingPoint_[i]==0){ 
-               distance_[i] = 1;      
+               distance_[i] = (distance1_[i]-0.5); 
             }
             else{
-               distance_[i] = -1; 
+               distance_[i] = -(distance0_[i]-0.5); 
             } 
          }
       }
-#else
-      else if(distanceType_==EUCLIDEAN){
-         std::vector<size_t> s = shape_;
-         std::vector<double> dist0(numVar_,0); 
-         std::vector<double> dist1(numVar_,0);
-         if(s.size()==1){
-            typedef vigra::MultiArrayView<1, LabelType> ArrayType; 
-            typedef vigra::MultiArrayView<1, double>    DArrayType;
-            typedef typename ArrayType::difference_type ShapeType;
-            ShapeType shape(s[0]);
-            ShapeType stride(1);
-            
-            
-            ArrayType source( shape, stride, &workingPoint_[0] );
-            DArrayType dest0( shape, stride, &dist0[0] );
-            DArrayType dest1( shape, stride, &dist1[0] );
-            
-            vigra::separableMultiDistance(source, dest0, false);
-            vigra::separableMultiDistance(source, dest1, true);
-            for(int i=0; i<numVar_; ++i){
-               if(workingPoint_[i]==0){ 
-                  distance_[i] = (dist1[i]-0.5); 
-               }
-               else{
-                  distance_[i] = -(dist0[i]-0.5);  
-               } 
-            }
-         }
-         else if(s.size()==2){
-            typedef vigra::MultiArrayView<2, LabelType> ArrayType; 
-            typedef vigra::MultiArrayView<2, double>    DArrayType;
-            typedef typename ArrayType::difference_type ShapeType;
-            ShapeType shape(s[0],s[1]);
-            ShapeType stride(1,s[0]);
-            
-            
-            ArrayType source( shape, stride, &workingPoint_[0] );
-            DArrayType dest0( shape, stride, &dist0[0] );
-            DArrayType dest1( shape, stride, &dist1[0] );
-            
-            vigra::separableMultiDistance(source, dest0, false);
-            vigra::separableMultiDistance(source, dest1, true);
-            for(int i=0; i<numVar_; ++i){
-               if(workingPoint_[i]==0){ 
-                  distance_[i] = (dist1[i]-0.5); 
-               }
-               else{
-                  distance_[i] = -(dist0[i]-0.5); 
-               } 
-            }
-         } 
-         else if(s.size()==3){
-            typedef vigra::MultiArrayView<3, LabelType> ArrayType; 
-            typedef vigra::MultiArrayView<3, double>    DArrayType;
-            typedef typename ArrayType::difference_type ShapeType;
-            ShapeType shape(s[0],s[1],s[2]);
-            ShapeType stride(1,s[0],s[0]*s[1]);
-            
-            
-            ArrayType source( shape, stride, &workingPoint_[0] );
-            DArrayType dest0( shape, stride, &dist0[0] );
-            DArrayType dest1( shape, stride, &dist1[0] );
-            
-            vigra::separableMultiDistance(source, dest0, false);
-            vigra::separableMultiDistance(source, dest1, true);
-            for(int i=0; i<numVar_; ++i){
-               if(workingPoint_[i]==0){ 
-                  distance_[i] = (dist1[i]-0.5); 
-               }
-               else{
-                  distance_[i] = -(dist0[i]-0.5); 
-               } 
-            }
-         }
-      }//end EUCLIDEAN
-#endif
       else{
          std::cout <<"Unknown distance"<<std::endl;
       }
@@ -400,30 +336,15 @@ namespace opengm {
 
    template<class LabelType>
    double LSA_TR_HELPER<LabelType>::optimize(std::vector<LabelType>& label){
-      double value;
-      //std::cout << lambda_ <<std::endl;
-      if(solved_){ //use warmstart
-         value = graph_->maxflow(true,changedList_); 
-         for (typename graph_type::node_id* ptr = changedList_->ScanFirst(); ptr; ptr = changedList_->ScanNext()) {
-            typename graph_type::node_id var = *ptr; 
-            OPENGM_ASSERT(var>=0 && var<numVar_);
-            graph_->remove_from_changed_list(var);
-         }
-         
-         for(size_t var=0; var<numVar_; ++var) {
-            if (graph_->what_segment(var) == graph_type::SOURCE) { label[var]=1;}
-            else                                                 { label[var]=0;}
-         } 
-         changedList_->Reset();
-      }
-      else{ //first round without warmstart
-         value = graph_->maxflow();
-         for(size_t var=0; var<numVar_; ++var) {
-            if (graph_->what_segment(var) == graph_type::SOURCE) { label[var]=1;}
-            else                                                 { label[var]=0;}
-         }   
-         solved_=true;
+      // warmstart from the flow and the search trees of the last call
+      const double value = graph_.maxflow(solved_);
+      graph_.clearChangedNodes();
+      // nodes that are free after the cut belong to the source side (label 1)
+      for(size_t var=0; var<numVar_; ++var) {
+         if (graph_.inSinkTree(var)) { label[var]=0;}
+         else                        { label[var]=1;}
       } 
+      solved_=true;
       return value + constTerm_ + constTermApproximation_ + constTermTrustRegion_; 
    }   
 
@@ -433,25 +354,11 @@ namespace opengm {
      double difLambda  = newLambda - lambda_;
      lambda_ = newLambda;
      constTermTrustRegion_ = 0;
-     if(solved_){
-        for(int i=0; i<approxUnaries_.size(); ++i){
-           double oldcap = graph_->get_trcap(i);
-           approxUnaries_[i] += difLambda*distance_[i]; 
-           graph_->add_tweights( i, 0, difLambda*distance_[i] ); 
-           if(distance_[i]<0)
-              constTermTrustRegion_ -= difLambda*distance_[i];
-           double newcap = graph_->get_trcap(i);
-           if (!((newcap > 0 && oldcap > 0)||(newcap < 0 && oldcap < 0))){
-              graph_->mark_node(i);
-           }
-        }
-     }else{
-        for(int i=0; i<approxUnaries_.size(); ++i){ 
-           approxUnaries_[i] += difLambda*distance_[i]; 
-           graph_->add_tweights( i, 0, difLambda*distance_[i] );
-           if(distance_[i]<0)
-              constTermTrustRegion_ -= difLambda*distance_[i];  
-        }
+     for(size_t i=0; i<approxUnaries_.size(); ++i){
+        approxUnaries_[i] += difLambda*distance_[i]; 
+        addUnaries( i, difLambda*distance_[i] ); 
+        if(distance_[i]<0)
+           constTermTrustRegion_ -= lambda_*distance_[i];
      }
   } 
 
@@ -476,25 +383,11 @@ namespace opengm {
          if(workingPoint_[var0]==1 && workingPoint_[var1]==1)
             constTermApproximation_ -= w;
       } 
-      if(solved_){
-         for(int i=0; i<numVar_; ++i){
-            double oldcap = graph_->get_trcap(i);
-            newApproxUnaries[i] += lambda_*distance_[i]; 
-            graph_->add_tweights( i, 0, newApproxUnaries[i]-approxUnaries_[i] ); 
-            if(distance_[i]<0)
-               constTermTrustRegion_ -= lambda_*distance_[i];
-           double newcap = graph_->get_trcap(i);
-           if (!((newcap > 0 && oldcap > 0)||(newcap < 0 && oldcap < 0))){
-              graph_->mark_node(i);
-           }
-        }
-     }else{
-         for(int i=0; i<numVar_; ++i){ 
-            newApproxUnaries[i] += lambda_*distance_[i]; 
-            graph_->add_tweights( i, 0, newApproxUnaries[i]-approxUnaries_[i]);
-            if(distance_[i]<0)
-               constTermTrustRegion_ -= lambda_*distance_[i]; 
-         }
+      for(size_t i=0; i<numVar_; ++i){ 
+         newApproxUnaries[i] += lambda_*distance_[i]; 
+         addUnaries( i, newApproxUnaries[i]-approxUnaries_[i]);
+         if(distance_[i]<0)
+            constTermTrustRegion_ -= lambda_*distance_[i]; 
       }
       approxUnaries_.assign(newApproxUnaries.begin(),newApproxUnaries.end());
 
@@ -5,6 +5,11 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <algorithm>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
@@ -19,7 +24,7 @@
 #include <opengm/datastructures/marray/marray_hdf5.hxx>
 #endif
 
-#include "opengm/inference/external/qpbo.hxx"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
 
 namespace opengm {
    
@@ -30,6 +35,11 @@ namespace opengm {
    /// ii) P. Kohli, A. Shekhovtsov, C. Rother, V. Kolmogorov, and P. Torr: On partial optimality in multi-label MRFs, ICML 2008                (MQPBO)
    /// iii) P. Swoboda, B.  Savchynskyy, J.H.  Kappes, and C. Schnörr : Partial Optimality via Iterative Pruning for the Potts Model, SSVM 2013 (MQPBO with permutation sampling)
    ///
+   /// The binary problems of Kovtun's method (one per label) share the graph
+   /// structure and differ only in the unary capacities. They are built from
+   /// one skeleton of the model and solved in parallel with one QPBO solver
+   /// per thread (WITH_OPENMP).
+   ///
    /// Corresponding author: Joerg Hendrik Kappes
    ///
    ///\ingroup inference
@@ -62,7 +72,7 @@ namespace opengm {
       
       class Parameter{
       public:
-         Parameter(): useKovtunsMethod_(true), probing_(false),  strongPersistency_(false), rounds_(0), permutationType_(NONE) {};
+         Parameter(): useKovtunsMethod_(true), probing_(false),  strongPersistency_(false), rounds_(0), permutationType_(NONE), numberOfThreads_(0) {};
          
 
         template<class P>
@@ -72,7 +82,8 @@ namespace opengm {
             probing_(p.probing_),
             strongPersistency_(p.strongPersistency_),
             rounds_(p.rounds_),
-            permutationType_(p.permutationType_){
+            permutationType_(p.permutationType_),
+            numberOfThreads_(p.numberOfThreads_){
 
         }
 
@@ -82,6 +93,8 @@ namespace opengm {
          bool strongPersistency_;
          size_t rounds_;
          PermutationType permutationType_;
+         /// number of threads for the labels of Kovtun's method (0: OpenMP default)
+         size_t numberOfThreads_;
       };
 
       MQPBO(const GmType&, const Parameter& = Parameter());
@@ -105,14 +118,22 @@ namespace opengm {
       double optimalityV() const;
       double optimality() const;
    private: 
-      InferenceTermination testQuess(LabelType guess);
+      struct KovtunEdge {
+         int var0_;
+         int var1_;
+         ValueType v00_;
+         ValueType v01_;
+      };
+      void buildKovtunSkeleton();
+      void solveQuess(const LabelType, QPBOGraph<GraphValueType>&, std::vector<IndexType>&) const;
+      void applyQuess(const LabelType, const std::vector<IndexType>&);
       void AddUnaryTerm(int var, ValueType v0, ValueType v1);
       void AddPairwiseTerm(int var0, int var1,ValueType v00,ValueType v01,ValueType v10,ValueType v11);
 
       const GmType& gm_;
       Parameter param_;
 
-      kolmogorov::qpbo::QPBO<GraphValueType>* qpbo_;
+      QPBOGraph<GraphValueType>* qpbo_;
       ValueType constTerm_;
       ValueType bound_;
       //int* label_;
@@ -125,6 +146,12 @@ namespace opengm {
       std::vector<LabelType>                       label_;
       std::vector<size_t>                          variableOffset_; 
 
+      // skeleton of the binary problems of Kovtun's method: summed unary
+      // values of all variables (unaryOffset_[var] + label) and the edges
+      std::vector<size_t>                          unaryOffset_;
+      std::vector<ValueType>                       unaryValues_;
+      std::vector<KovtunEdge>                      kovtunEdges_;
+
       size_t numNodes_;
       size_t numEdges_;
 
@@ -190,12 +217,12 @@ namespace opengm {
 
       if(param_.rounds_>0){
          //std::cout << "Large" <<std::endl;
-         qpbo_ = new kolmogorov::qpbo::QPBO<GraphValueType > (numNodes_, numEdges_); // max number of nodes & edges
+         qpbo_ = new QPBOGraph<GraphValueType> (numNodes_, numEdges_); // max number of nodes & edges
          qpbo_->AddNode(numNodes_);
       }
       else{
          //std::cout << "Small" <<std::endl;      
-         qpbo_ = new kolmogorov::qpbo::QPBO<GraphValueType > (gm_.numberOfVariables(), numSOF); // max number of nodes & edges
+         qpbo_ = new QPBOGraph<GraphValueType> (gm_.numberOfVariables(), numSOF); // max number of nodes & edges
          qpbo_->AddNode(gm_.numberOfVariables());
       }
    } 
@@ -256,56 +283,98 @@ namespace opengm {
    } 
        
    template<class GM, class ACC>
-   inline InferenceTermination
-   MQPBO<GM,ACC>::testQuess(LabelType guess)
+   inline void
+   MQPBO<GM,ACC>::buildKovtunSkeleton()
    {
-      qpbo_->Reset();
-      qpbo_->AddNode(gm_.numberOfVariables());
-      for(size_t f = 0; f < gm_.numberOfFactors(); ++f) {
-         if(gm_[f].numberOfVariables() == 0) {
-            ;
-         }
-         else if(gm_[f].numberOfVariables() == 1) {
-            const LabelType numLabels =  gm_[f].numberOfLabels(0);
+      unaryOffset_.resize(gm_.numberOfVariables()+1);
+      unaryOffset_[0] = 0;
+      for(IndexType var=0; var<gm_.numberOfVariables(); ++var){
+         unaryOffset_[var+1] = unaryOffset_[var] + gm_.numberOfLabels(var);
+      }
+      unaryValues_.assign(unaryOffset_.back(), 0);
+      kovtunEdges_.clear();
+      for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+         if(gm_[f].numberOfVariables() == 1) {
             const IndexType var = gm_[f].variableIndex(0);
-            
-            ValueType v0 = gm_[f](&guess);
-            ValueType v1; ACC::neutral(v1);
-            for(LabelType i=0; i<guess; ++i)
-               ACC::op(gm_[f](&i),v1);
-            for(LabelType i=guess+1; i<numLabels; ++i)
-               ACC::op(gm_[f](&i),v1);
-            AddUnaryTerm(var, v0, v1);
+            for(LabelType l=0; l<gm_[f].numberOfLabels(0); ++l){
+               unaryValues_[unaryOffset_[var]+l] += gm_[f](&l);
+            }
          }
          else if(gm_[f].numberOfVariables() == 2) {
-            const IndexType var0 = gm_[f].variableIndex(0);
-            const IndexType var1 = gm_[f].variableIndex(1); 
-            
-            LabelType c[2] = {guess,guess};
-            LabelType c2[2] = {0,1};
+            // Potts: the values do not depend on the guess
+            const LabelType c[2]  = {0,0};
+            const LabelType c2[2] = {0,1};
+            KovtunEdge edge;
+            edge.var0_ = static_cast<int>(gm_[f].variableIndex(0));
+            edge.var1_ = static_cast<int>(gm_[f].variableIndex(1));
+            edge.v00_  = gm_[f](c);
+            edge.v01_  = gm_[f](c2);
+            kovtunEdges_.push_back(edge);
+         }
+      }
+   }
 
-            ValueType v00 = gm_[f](c);
-            ValueType v01 = gm_[f](c2);
-            ValueType v10 = v01; 
-            ValueType v11 = std::min(v00,v01);
-            AddPairwiseTerm(var0, var1,v00,v01,v10,v11);
+   /// binary problem of Kovtun's method for one label, the variables
+   /// for which the label is (strongly) persistent are returned
+   template<class GM, class ACC>
+   inline void
+   MQPBO<GM,ACC>::solveQuess
+   (
+      const LabelType guess,
+      QPBOGraph<GraphValueType>& qpbo,
+      std::vector<IndexType>& persistent
+   ) const
+   {
+      qpbo.Reset();
+      qpbo.AddNode(gm_.numberOfVariables());
+      for(IndexType var=0; var<gm_.numberOfVariables(); ++var){
+         const ValueType* v = &unaryValues_[unaryOffset_[var]];
+         const LabelType numLabels = gm_.numberOfLabels(var);
+         if(guess >= numLabels){
+            // the variable cannot take the label
+            qpbo.AddUnaryTerm(var, 1e30, 0.0);
+            continue;
          }
+         ValueType v1; ACC::neutral(v1);
+         for(LabelType i=0; i<guess; ++i)
+            ACC::op(v[i],v1);
+         for(LabelType i=guess+1; i<numLabels; ++i)
+            ACC::op(v[i],v1);
+         qpbo.AddUnaryTerm(var, scale*v[guess], scale*v1);
       }
-      qpbo_->MergeParallelEdges();
-      qpbo_->Solve();
+      for(size_t e=0; e<kovtunEdges_.size(); ++e){
+         const KovtunEdge& edge = kovtunEdges_[e];
+         const ValueType v11 = std::min(edge.v00_,edge.v01_);
+         qpbo.AddPairwiseTerm(edge.var0_, edge.var1_, scale*edge.v00_, scale*edge.v01_, scale*edge.v01_, scale*v11);
+      }
+      qpbo.MergeParallelEdges();
+      qpbo.Solve();
+      persistent.clear();
       for(IndexType var=0; var<gm_.numberOfVariables();++var){
-         if(qpbo_->GetLabel(var)==0){
-            for(LabelType l=0; l<gm_.numberOfLabels(var); ++l){
-               partialOptimality_[var][l] =opengm::Tribool::False;   
-            } 
-            partialOptimality_[var][guess] =opengm::Tribool::True; 
-            optimal_[var]=true;
-            label_[var]=guess;
+         if(qpbo.GetLabel(var)==0){
+            persistent.push_back(var);
          }
       }
-      return NORMAL;
    }
 
+   template<class GM, class ACC>
+   inline void
+   MQPBO<GM,ACC>::applyQuess
+   (
+      const LabelType guess,
+      const std::vector<IndexType>& persistent
+   )
+   {
+      for(size_t n=0; n<persistent.size(); ++n){
+         const IndexType var = persistent[n];
+         for(LabelType l=0; l<gm_.numberOfLabels(var); ++l){
+            partialOptimality_[var][l] =opengm::Tribool::False;   
+         } 
+         partialOptimality_[var][guess] =opengm::Tribool::True; 
+         optimal_[var]=true;
+         label_[var]=guess;
+      }
+   }
 
    template<class GM, class ACC>
    inline InferenceTermination
@@ -663,7 +732,7 @@ namespace opengm {
             qpbo_->SetLabel(i, qpbo_->GetLabel(i));
             mapping[i] = i * 2;
          }
-         typename kolmogorov::qpbo::QPBO<GraphValueType>::ProbeOptions options;
+         typename QPBOGraph<GraphValueType>::ProbeOptions options;
          options.C = 1000000000;
          if(!param_.strongPersistency_)
             options.weak_persistencies = 1;
@@ -846,15 +915,98 @@ namespace opengm {
       if(param_.useKovtunsMethod_){
          if(isPotts){
             //std::cout << "Use Kovtuns method for potts"<<std::endl;
+            buildKovtunSkeleton();
+            std::vector<std::vector<IndexType> > persistent(maxNumberOfLabels);
+            bool stop = false;
+            // exceptions must not leave the parallel region, they are rethrown after it
+            std::vector<RuntimeError> errors(maxNumberOfLabels, RuntimeError(""));
+            std::vector<unsigned char> failed(maxNumberOfLabels, 0);
+#ifdef WITH_OPENMP
+            const int numberOfThreads = param_.numberOfThreads_ > 0 ? static_cast<int>(param_.numberOfThreads_) : omp_get_max_threads();
+#pragma omp parallel num_threads(numberOfThreads)
+#endif
+            {
+               QPBOGraph<GraphValueType> qpbo(gm_.numberOfVariables(), kovtunEdges_.size());
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic) ordered
+#endif
+               for(std::ptrdiff_t l=0; l<static_cast<std::ptrdiff_t>(maxNumberOfLabels); ++l) {
+                  bool skip;
+#ifdef WITH_OPENMP
+#pragma omp critical(mqpbo_kovtun)
+#endif
+                  skip = stop;
+                  try{
+                     if(!skip)
+                        solveQuess(static_cast<LabelType>(l), qpbo, persistent[l]);
+                  }
+                  catch(const RuntimeError& e){
+                     errors[l] = e;
+                     failed[l] = 1;
+                  }
+                  catch(const std::exception& e){
+                     errors[l] = RuntimeError(e.what());
+                     failed[l] = 1;
+                  }
+                  catch(...){
+                     errors[l] = RuntimeError("unknown exception in Kovtun's method");
+                     failed[l] = 1;
+                  }
+                  // the results are applied in the order of the labels as in the sequential
+                  // method, the visitor is called for each label and may stop the method
+#ifdef WITH_OPENMP
+#pragma omp ordered
+#endif
+                  {
+                     bool stopNow;
+#ifdef WITH_OPENMP
+#pragma omp critical(mqpbo_kovtun)
+#endif
+                     stopNow = stop;
+                     if(stopNow){
+                        // the method was stopped before this label
+                        failed[l] = 0;
+                     }
+                     else if(!failed[l]){
+                        try{
+                           applyQuess(static_cast<LabelType>(l), persistent[l]);
+                           double xoptimality = optimality(); 
+                           double xoptimalityV = optimalityV();
+                           const size_t flag = visitor(*this);
+                           visitor.log("optimality",xoptimality);
+                           visitor.log("optimalityV",xoptimalityV);
+                           stopNow = flag != visitors::VisitorReturnFlag::ContinueInf;
+                        }
+                        catch(const RuntimeError& e){
+                           errors[l] = e;
+                           failed[l] = 1;
+                        }
+                        catch(const std::exception& e){
+                           errors[l] = RuntimeError(e.what());
+                           failed[l] = 1;
+                        }
+                        catch(...){
+                           errors[l] = RuntimeError("unknown exception in the visitor of MQPBO");
+                           failed[l] = 1;
+                        }
+                        //std::cout << "partialOptimality  : " << optimality() << std::endl; 
+                     }
+                     if(stopNow || failed[l]){
+#ifdef WITH_OPENMP
+#pragma omp critical(mqpbo_kovtun)
+#endif
+                        stop = true;
+                     }
+                  }
+               }
+            }
             for(LabelType l=0; l<maxNumberOfLabels; ++l) {
-               testQuess(l);
-               double xoptimality = optimality(); 
-               double xoptimalityV = optimalityV();
-               visitor(*this);
-               visitor.log("optimality",xoptimality);
-               visitor.log("optimalityV",xoptimalityV);
-
-               //std::cout << "partialOptimality  : " << optimality() << std::endl; 
+               if(failed[l])
+                  throw errors[l];
+            }
+            if(stop){
+               visitor.end(*this);
+               return NORMAL;
             }
          }
          else{
@@ -0,0 +1,895 @@
+#pragma once
+#ifndef OPENGM_MULTICUT_HEURISTIC_HXX
+#define OPENGM_MULTICUT_HEURISTIC_HXX
+
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <string>
+#include <typeinfo>
+#include <limits>
+#include <functional>
+#include <cmath>
+#ifdef WITH_BOOST
+#include <boost/unordered_map.hpp>
+#else
+#include <ext/hash_map>
+#endif
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include "opengm/opengm.hxx"
+#include "opengm/operations/adder.hxx"
+#include "opengm/operations/minimizer.hxx"
+#include "opengm/inference/inference.hxx"
+#include "opengm/inference/visitors/visitors.hxx"
+#include "opengm/datastructures/partition.hxx"
+#include "opengm/utilities/random.hxx"
+
+namespace opengm {
+
+/// \cond HIDDEN_SYMBOLS
+namespace multicut_heuristic {
+
+/// weighted graph with adjacency in compressed rows, the weight of an edge
+/// is the cost of cutting it
+class WeightedGraph {
+public:
+   WeightedGraph(const size_t numberOfNodes = 0)
+   :  numberOfNodes_(numberOfNodes)
+   {}
+
+   void addEdge(const size_t u, const size_t v, const double weight) {
+      OPENGM_ASSERT(u < numberOfNodes_ && v < numberOfNodes_ && u != v);
+      edges_.push_back(std::make_pair(std::min(u, v), std::max(u, v)));
+      weights_.push_back(weight);
+   }
+
+   /// merge parallel edges and build the adjacency
+   void finalize() {
+      std::vector<size_t> order(edges_.size());
+      for(size_t e = 0; e < order.size(); ++e) {
+         order[e] = e;
+      }
+      std::sort(order.begin(), order.end(), EdgeLess(edges_));
+      std::vector<std::pair<size_t, size_t> > edges;
+      std::vector<double> weights;
+      for(size_t i = 0; i < order.size(); ++i) {
+         const size_t e = order[i];
+         if(!edges.empty() && edges.back() == edges_[e]) {
+            weights.back() += weights_[e];
+         }
+         else {
+            edges.push_back(edges_[e]);
+            weights.push_back(weights_[e]);
+         }
+      }
+      edges_.swap(edges);
+      weights_.swap(weights);
+
+      offsets_.assign(numberOfNodes_ + 1, 0);
+      for(size_t e = 0; e < edges_.size(); ++e) {
+         ++offsets_[edges_[e].first + 1];
+         ++offsets_[edges_[e].second + 1];
+      }
+      for(size_t n = 0; n < numberOfNodes_; ++n) {
+         offsets_[n + 1] += offsets_[n];
+      }
+      adjacentNodes_.resize(2 * edges_.size());
+      adjacentEdges_.resize(2 * edges_.size());
+      std::vector<size_t> position(offsets_.begin(), offsets_.end() - 1);
+      for(size_t e = 0; e < edges_.size(); ++e) {
+         const size_t u = edges_[e].first;
+         const size_t v = edges_[e].second;
+         adjacentNodes_[position[u]] = v;
+         adjacentEdges_[position[u]++] = e;
+         adjacentNodes_[position[v]] = u;
+         adjacentEdges_[position[v]++] = e;
+      }
+   }
+
+   size_t numberOfNodes() const { return numberOfNodes_; }
+   size_t numberOfEdges() const { return edges_.size(); }
+   size_t u(const size_t e) const { return edges_[e].first; }
+   size_t v(const size_t e) const { return edges_[e].second; }
+   double weight(const size_t e) const { return weights_[e]; }
+   double& weight(const size_t e) { return weights_[e]; }
+   size_t degree(const size_t n) const { return offsets_[n + 1] - offsets_[n]; }
+   size_t adjacentNode(const size_t n, const size_t j) const { return adjacentNodes_[offsets_[n] + j]; }
+   size_t adjacentEdge(const size_t n, const size_t j) const { return adjacentEdges_[offsets_[n] + j]; }
+
+   /// sum of the weights of the cut edges
+   template<class LABELING>
+   double energy(const LABELING& labels) const {
+      double energy = 0.0;
+      for(size_t e = 0; e < edges_.size(); ++e) {
+         if(labels[edges_[e].first] != labels[edges_[e].second]) {
+            energy += weights_[e];
+         }
+      }
+      return energy;
+   }
+
+private:
+   struct EdgeLess {
+      EdgeLess(const std::vector<std::pair<size_t, size_t> >& edges)
+      :  edges_(edges)
+      {}
+      bool operator()(const size_t a, const size_t b) const
+         { return edges_[a] < edges_[b]; }
+      const std::vector<std::pair<size_t, size_t> >& edges_;
+   };
+
+   size_t numberOfNodes_;
+   std::vector<std::pair<size_t, size_t> > edges_;
+   std::vector<double> weights_;
+   std::vector<size_t> offsets_;
+   std::vector<size_t> adjacentNodes_;
+   std::vector<size_t> adjacentEdges_;
+};
+
+/// relabel such that the labels are 0, 1, ... in the order of first occurrence
+/// \return number of labels
+inline size_t denseLabeling(std::vector<size_t>& labels) {
+   const size_t noLabel = std::numeric_limits<size_t>::max();
+   size_t maxLabel = 0;
+   for(size_t n = 0; n < labels.size(); ++n) {
+      maxLabel = std::max(maxLabel, labels[n]);
+   }
+   std::vector<size_t> newLabel(labels.empty() ? 0 : maxLabel + 1, noLabel);
+   size_t numberOfLabels = 0;
+   for(size_t n = 0; n < labels.size(); ++n) {
+      if(newLabel[labels[n]] == noLabel) {
+         newLabel[labels[n]] = numberOfLabels++;
+      }
+      labels[n] = newLabel[labels[n]];
+   }
+   return numberOfLabels;
+}
+
+/// greedy additive edge contraction: the pair of adjacent clusters with the
+/// largest positive (summed) weight is joined until no such pair is left
+///
+/// \param[out] partition clusters of the nodes
+inline void greedyAdditiveContraction
+(
+   const WeightedGraph& graph,
+   Partition<size_t>& partition
+) {
+#ifdef WITH_BOOST
+   typedef boost::unordered_map<size_t, double> WeightMap;
+#else
+   typedef __gnu_cxx::hash_map<size_t, double> WeightMap;
+#endif
+   typedef std::pair<double, std::pair<size_t, size_t> > QueueEntry;
+   const size_t numberOfNodes = graph.numberOfNodes();
+   partition.reset(numberOfNodes);
+   std::vector<WeightMap> adjacency(numberOfNodes);
+   std::vector<size_t> size(numberOfNodes, 1);
+   std::priority_queue<QueueEntry> queue;
+   for(size_t e = 0; e < graph.numberOfEdges(); ++e) {
+      adjacency[graph.u(e)][graph.v(e)] = graph.weight(e);
+      adjacency[graph.v(e)][graph.u(e)] = graph.weight(e);
+      if(graph.weight(e) > 0.0) {
+         queue.push(QueueEntry(graph.weight(e), std::make_pair(graph.u(e), graph.v(e))));
+      }
+   }
+   while(!queue.empty()) {
+      const QueueEntry entry = queue.top();
+      queue.pop();
+      const size_t a = entry.second.first;
+      const size_t b = entry.second.second;
+      if(size[a] == 0 || size[b] == 0) {
+         continue; // one of the clusters has been contracted
+      }
+      WeightMap::const_iterator it = adjacency[a].find(b);
+      if(it == adjacency[a].end() || it->second != entry.first) {
+         continue; // the weight has changed
+      }
+      // the cluster with fewer neighbors is contracted into the other one
+      const size_t keep = adjacency[a].size() >= adjacency[b].size() ? a : b;
+      const size_t drop = keep == a ? b : a;
+      partition.merge(a, b);
+      size[keep] += size[drop];
+      size[drop] = 0;
+      adjacency[keep].erase(drop);
+      for(WeightMap::const_iterator nit = adjacency[drop].begin(); nit != adjacency[drop].end(); ++nit) {
+         const size_t x = nit->first;
+         if(x == keep) {
+            continue;
+         }
+         adjacency[x].erase(drop);
+         double& weight = adjacency[keep][x];
+         weight += nit->second;
+         adjacency[x][keep] = weight;
+         if(weight > 0.0) {
+            queue.push(QueueEntry(weight, std::make_pair(keep, x)));
+         }
+      }
+      WeightMap().swap(adjacency[drop]);
+   }
+}
+
+/// workspace of kernighanLinPair, one per thread
+struct KernighanLinWorkspace {
+   void resize(const size_t numberOfNodes) {
+      flipped_.assign(numberOfNodes, false);
+      touched_.assign(numberOfNodes, false);
+      moved_.assign(numberOfNodes, false);
+      gain_.resize(numberOfNodes);
+   }
+   std::vector<bool> flipped_; // moved to the other cluster of the pair
+   std::vector<bool> touched_; // gain is up to date
+   std::vector<bool> moved_; // in the current sequence
+   std::vector<double> gain_; // change of the energy if the node is moved
+   std::vector<size_t> flippedNodes_;
+   std::vector<size_t> touchedNodes_;
+   std::vector<size_t> sequence_;
+   std::vector<size_t> candidates_;
+};
+
+/// side of a node w.r.t. a pair of clusters (0: first, 1: second, 2: neither)
+inline unsigned char kernighanLinSide
+(
+   const std::vector<size_t>& labels,
+   const KernighanLinWorkspace& workspace,
+   const size_t n,
+   const size_t cluster0,
+   const size_t cluster1
+) {
+   const unsigned char side = labels[n] == cluster0 ? 0 : (labels[n] == cluster1 ? 1 : 2);
+   return side != 2 && workspace.flipped_[n] ? 1 - side : side;
+}
+
+/// Kernighan-Lin for two clusters: sequences of greedy single node moves
+/// between the two clusters are computed and their best prefix is applied,
+/// until no improving prefix is found (or maxIterations is reached). The
+/// candidates of the moves are the given nodes (the boundary between the
+/// clusters) and the neighbors of moved nodes. The labels are not changed.
+///
+/// \param cluster1 if it is no label of a node, cluster0 may be split
+/// \param[in,out] candidates initial candidates (destroyed)
+/// \param[out] moves nodes that change the cluster
+/// \return change of the energy (<= 0)
+inline double kernighanLinPair
+(
+   const WeightedGraph& graph,
+   const std::vector<size_t>& labels,
+   const size_t cluster0,
+   const size_t cluster1,
+   std::vector<size_t>& candidates,
+   KernighanLinWorkspace& workspace,
+   const size_t maxIterations,
+   std::vector<size_t>& moves
+) {
+   typedef std::pair<double, size_t> QueueEntry;
+   // a sequence is terminated after this number of moves without improvement
+   const size_t maxNumberOfNonImprovingMoves = 128;
+   const double epsilon = 1e-9;
+   std::vector<bool>& flipped = workspace.flipped_;
+   std::vector<bool>& touched = workspace.touched_;
+   std::vector<bool>& moved = workspace.moved_;
+   std::vector<double>& gain = workspace.gain_;
+   std::vector<size_t>& sequence = workspace.sequence_;
+   std::vector<size_t>& touchedNodes = workspace.touchedNodes_;
+   double improvement = 0.0;
+   for(size_t iteration = 0; iteration < maxIterations && !candidates.empty(); ++iteration) {
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+      touchedNodes.clear();
+      for(size_t i = 0; i < candidates.size(); ++i) {
+         const size_t n = candidates[i];
+         if(touched[n] || kernighanLinSide(labels, workspace, n, cluster0, cluster1) == 2) {
+            continue;
+         }
+         touched[n] = true;
+         touchedNodes.push_back(n);
+         queue.push(QueueEntry(0.0, n)); // gain is computed below
+      }
+      for(size_t i = 0; i < touchedNodes.size(); ++i) {
+         const size_t n = touchedNodes[i];
+         const unsigned char side = kernighanLinSide(labels, workspace, n, cluster0, cluster1);
+         double g = 0.0;
+         for(size_t j = 0; j < graph.degree(n); ++j) {
+            const unsigned char s = kernighanLinSide(labels, workspace, graph.adjacentNode(n, j), cluster0, cluster1);
+            if(s == side) {
+               g += graph.weight(graph.adjacentEdge(n, j));
+            }
+            else if(s != 2) {
+               g -= graph.weight(graph.adjacentEdge(n, j));
+            }
+         }
+         gain[n] = g;
+      }
+      queue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> >();
+      for(size_t i = 0; i < touchedNodes.size(); ++i) {
+         queue.push(QueueEntry(gain[touchedNodes[i]], touchedNodes[i]));
+      }
+
+      // greedy sequence of moves
+      sequence.clear();
+      double sum = 0.0;
+      double bestSum = 0.0;
+      size_t bestLength = 0;
+      while(!queue.empty() && sequence.size() < bestLength + maxNumberOfNonImprovingMoves) {
+         const QueueEntry entry = queue.top();
+         queue.pop();
+         const size_t n = entry.second;
+         if(moved[n] || entry.first != gain[n]) {
+            continue;
+         }
+         const unsigned char oldSide = kernighanLinSide(labels, workspace, n, cluster0, cluster1);
+         moved[n] = true;
+         if(!flipped[n]) {
+            workspace.flippedNodes_.push_back(n);
+         }
+         flipped[n] = !flipped[n];
+         sequence.push_back(n);
+         sum += gain[n];
+         if(sum < bestSum - epsilon) {
+            bestSum = sum;
+            bestLength = sequence.size();
+         }
+         for(size_t j = 0; j < graph.degree(n); ++j) {
+            const size_t m = graph.adjacentNode(n, j);
+            const unsigned char side = kernighanLinSide(labels, workspace, m, cluster0, cluster1);
+            if(side == 2 || moved[m]) {
+               continue;
+            }
+            if(touched[m]) {
+               const double w = graph.weight(graph.adjacentEdge(n, j));
+               gain[m] += side == oldSide ? -2.0 * w : 2.0 * w;
+            }
+            else {
+               touched[m] = true;
+               touchedNodes.push_back(m);
+               double g = 0.0;
+               for(size_t k = 0; k < graph.degree(m); ++k) {
+                  const unsigned char s = kernighanLinSide(labels, workspace, graph.adjacentNode(m, k), cluster0, cluster1);
+                  if(s == side) {
+                     g += graph.weight(graph.adjacentEdge(m, k));
+                  }
+                  else if(s != 2) {
+                     g -= graph.weight(graph.adjacentEdge(m, k));
+                  }
+               }
+               gain[m] = g;
+            }
+            queue.push(QueueEntry(gain[m], m));
+         }
+      }
+      // undo the moves behind the best prefix
+      for(size_t i = bestLength; i < sequence.size(); ++i) {
+         flipped[sequence[i]] = !flipped[sequence[i]];
+      }
+      for(size_t i = 0; i < sequence.size(); ++i) {
+         moved[sequence[i]] = false;
+      }
+      // the touched nodes are the candidates of the next sequence
+      candidates.swap(touchedNodes);
+      for(size_t i = 0; i < candidates.size(); ++i) {
+         touched[candidates[i]] = false;
+      }
+      if(bestLength == 0) {
+         break;
+      }
+      improvement += bestSum;
+   }
+   moves.clear();
+   for(size_t i = 0; i < workspace.flippedNodes_.size(); ++i) {
+      const size_t n = workspace.flippedNodes_[i];
+      if(flipped[n]) {
+         moves.push_back(n);
+         flipped[n] = false;
+      }
+   }
+   workspace.flippedNodes_.clear();
+   return improvement;
+}
+
+/// Kernighan-Lin refinement of a clustering. In each iteration,
+/// - pairs of adjacent clusters are improved by kernighanLinPair, where the
+///   pairs of a matching of the cluster graph are processed in parallel
+///   (WITH_OPENMP),
+/// - each cluster is tried to be split (in parallel),
+/// - adjacent clusters are joined by greedy additive contraction of the
+///   cluster graph.
+/// Only clusters that have changed in the previous iteration are considered.
+///
+/// \param[in,out] labels cluster labels, dense on return
+/// \param maxNumberOfThreads number of threads (0 = OpenMP default)
+/// \return energy
+inline double kernighanLin
+(
+   const WeightedGraph& graph,
+   std::vector<size_t>& labels,
+   const size_t maxIterations,
+   const size_t maxNumberOfThreads = 0
+) {
+   const double epsilon = 1e-9;
+   const size_t numberOfNodes = graph.numberOfNodes();
+   #ifdef WITH_OPENMP
+   const size_t numberOfThreads = omp_in_parallel() ? 1
+      : (maxNumberOfThreads != 0 ? maxNumberOfThreads : static_cast<size_t>(omp_get_max_threads()));
+   #else
+   const size_t numberOfThreads = 1;
+   #endif
+   std::vector<KernighanLinWorkspace> workspaces(numberOfThreads);
+   for(size_t t = 0; t < numberOfThreads; ++t) {
+      workspaces[t].resize(numberOfNodes);
+   }
+   size_t numberOfClusters = denseLabeling(labels);
+   std::vector<bool> dirty(numberOfClusters, true);
+   for(size_t iteration = 0; iteration < maxIterations; ++iteration) {
+      // cut edges between pairs of clusters of which at least one is dirty
+      std::vector<std::pair<std::pair<size_t, size_t>, size_t> > cutEdges;
+      for(size_t e = 0; e < graph.numberOfEdges(); ++e) {
+         const size_t a = labels[graph.u(e)];
+         const size_t b = labels[graph.v(e)];
+         if(a != b && (dirty[a] || dirty[b])) {
+            cutEdges.push_back(std::make_pair(std::make_pair(std::min(a, b), std::max(a, b)), e));
+         }
+      }
+      std::sort(cutEdges.begin(), cutEdges.end());
+      std::vector<size_t> pairs; // index of the first cut edge of a pair
+      for(size_t i = 0; i < cutEdges.size(); ++i) {
+         if(i == 0 || cutEdges[i].first != cutEdges[i - 1].first) {
+            pairs.push_back(i);
+         }
+      }
+      std::vector<bool> changed(numberOfClusters, false);
+      std::vector<size_t> busy(numberOfClusters, 0);
+      size_t round = 0;
+      while(!pairs.empty()) {
+         ++round;
+         std::vector<size_t> matching;
+         std::vector<size_t> rest;
+         for(size_t i = 0; i < pairs.size(); ++i) {
+            const size_t a = cutEdges[pairs[i]].first.first;
+            const size_t b = cutEdges[pairs[i]].first.second;
+            if(busy[a] != round && busy[b] != round) {
+               busy[a] = round;
+               busy[b] = round;
+               matching.push_back(pairs[i]);
+            }
+            else {
+               rest.push_back(pairs[i]);
+            }
+         }
+         std::vector<double> improvements(matching.size());
+         std::vector<std::vector<size_t> > moves(matching.size());
+         #ifdef WITH_OPENMP
+         #pragma omp parallel for schedule(dynamic) if(numberOfThreads > 1) num_threads(static_cast<int>(numberOfThreads))
+         #endif
+         for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(matching.size()); ++i) {
+            #ifdef WITH_OPENMP
+            KernighanLinWorkspace& workspace = workspaces[numberOfThreads > 1 ? omp_get_thread_num() : 0];
+            #else
+            KernighanLinWorkspace& workspace = workspaces[0];
+            #endif
+            const std::pair<size_t, size_t> pair = cutEdges[matching[i]].first;
+            std::vector<size_t>& candidates = workspace.candidates_;
+            candidates.clear();
+            for(size_t j = matching[i]; j < cutEdges.size() && cutEdges[j].first == pair; ++j) {
+               candidates.push_back(graph.u(cutEdges[j].second));
+               candidates.push_back(graph.v(cutEdges[j].second));
+            }
+            improvements[i] = kernighanLinPair(graph, labels, pair.first, pair.second,
+               candidates, workspace, maxIterations, moves[i]);
+         }
+         for(size_t i = 0; i < matching.size(); ++i) {
+            const size_t a = cutEdges[matching[i]].first.first;
+            const size_t b = cutEdges[matching[i]].first.second;
+            for(size_t j = 0; j < moves[i].size(); ++j) {
+               labels[moves[i][j]] = labels[moves[i][j]] == a ? b : a;
+            }
+            if(improvements[i] < -epsilon) {
+               changed[a] = true;
+               changed[b] = true;
+            }
+         }
+         pairs.swap(rest);
+      }
+
+      // splits, the new clusters get the labels numberOfNodes + c
+      std::vector<std::vector<size_t> > members(numberOfClusters);
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         if(dirty[labels[n]]) {
+            members[labels[n]].push_back(n);
+         }
+      }
+      std::vector<double> improvements(numberOfClusters, 0.0);
+      std::vector<std::vector<size_t> > moves(numberOfClusters);
+      #ifdef WITH_OPENMP
+      #pragma omp parallel for schedule(dynamic) if(numberOfThreads > 1) num_threads(static_cast<int>(numberOfThreads))
+      #endif
+      for(std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(numberOfClusters); ++c) {
+         if(members[c].size() < 2) {
+            continue;
+         }
+         #ifdef WITH_OPENMP
+         KernighanLinWorkspace& workspace = workspaces[numberOfThreads > 1 ? omp_get_thread_num() : 0];
+         #else
+         KernighanLinWorkspace& workspace = workspaces[0];
+         #endif
+         improvements[c] = kernighanLinPair(graph, labels, c, numberOfNodes + c,
+            members[c], workspace, maxIterations, moves[c]);
+      }
+      for(size_t c = 0; c < numberOfClusters; ++c) {
+         if(improvements[c] < -epsilon) {
+            for(size_t j = 0; j < moves[c].size(); ++j) {
+               labels[moves[c][j]] = numberOfNodes + c;
+            }
+            changed[c] = true;
+         }
+      }
+
+      // joins
+      std::vector<bool> nodeChanged(numberOfNodes);
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         nodeChanged[n] = labels[n] >= numberOfNodes || changed[labels[n]];
+      }
+      numberOfClusters = denseLabeling(labels);
+      WeightedGraph clusterGraph(numberOfClusters);
+      for(size_t e = 0; e < graph.numberOfEdges(); ++e) {
+         if(labels[graph.u(e)] != labels[graph.v(e)]) {
+            clusterGraph.addEdge(labels[graph.u(e)], labels[graph.v(e)], graph.weight(e));
+         }
+      }
+      clusterGraph.finalize();
+      Partition<size_t> partition;
+      greedyAdditiveContraction(clusterGraph, partition);
+      std::vector<size_t> clusterSize(numberOfClusters, 0);
+      for(size_t c = 0; c < numberOfClusters; ++c) {
+         ++clusterSize[partition.find(c)];
+      }
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         const size_t c = partition.find(labels[n]);
+         nodeChanged[n] = nodeChanged[n] || clusterSize[c] > 1;
+         labels[n] = c;
+      }
+
+      numberOfClusters = denseLabeling(labels);
+      dirty.assign(numberOfClusters, false);
+      bool anyChange = false;
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         if(nodeChanged[n]) {
+            dirty[labels[n]] = true;
+            anyChange = true;
+         }
+      }
+      if(!anyChange) {
+         break;
+      }
+   }
+   return graph.energy(labels);
+}
+
+} // namespace multicut_heuristic
+/// \endcond
+
+/// \brief Native multicut heuristics\n\n
+/// Primal heuristics for the multicut problem that do not need an LP solver:
+/// - greedy additive edge contraction (GAEC)
+/// - Kernighan-Lin refinement on pairs of adjacent clusters, pairs of a
+///   matching of the cluster graph are refined in parallel (WITH_OPENMP)
+/// - warm start: a starting point replaces the greedy contraction in the
+///   first run and is refined by Kernighan-Lin
+/// - fusion of several runs on randomly perturbed weights: the graph is
+///   contracted along the edges that are not cut in any run and the problem
+///   on the contracted graph is solved again, starting from the best run
+///
+/// - Cite: M. Keuper, E. Levinkov, N. Bonneel, G. Lavoue, T. Brox and B. Andres, "Efficient Decomposition of Image and Mesh Graphs by Lifted Multicuts", ICCV 2015 (GAEC and KL)
+/// - Maximum factor order : second order Potts functions only (like Multicut and PartitionMove)
+/// - Maximum number of labels : same as the number of variables
+/// - Convergent : converges to a fix point of the Kernighan-Lin moves
+///
+/// \ingroup inference
+template<class GM, class ACC>
+class MulticutHeuristic : public Inference<GM, ACC>
+{
+public:
+   typedef ACC AccumulationType;
+   typedef GM GraphicalModelType;
+   OPENGM_GM_TYPE_TYPEDEFS;
+   typedef visitors::VerboseVisitor<MulticutHeuristic<GM, ACC> > VerboseVisitorType;
+   typedef visitors::EmptyVisitor<MulticutHeuristic<GM, ACC> >   EmptyVisitorType;
+   typedef visitors::TimingVisitor<MulticutHeuristic<GM, ACC> >  TimingVisitorType;
+
+   template<class _GM>
+   struct RebindGm{
+      typedef MulticutHeuristic<_GM, ACC> type;
+   };
+
+   template<class _GM,class _ACC>
+   struct RebindGmAndAcc{
+      typedef MulticutHeuristic<_GM, _ACC > type;
+   };
+
+   struct Parameter {
+      /// \param kernighanLin refine the greedy contraction by Kernighan-Lin
+      /// \param numberOfRuns number of runs that are fused (1: no fusion)
+      /// \param noise perturbation of the weights in all but the first run,
+      ///        relative to the mean absolute weight
+      Parameter
+      (
+         const bool kernighanLin = true,
+         const size_t numberOfRuns = 1,
+         const double noise = 0.5
+      )
+      :  kernighanLin_(kernighanLin),
+         numberOfRuns_(numberOfRuns),
+         noise_(noise),
+         maxNumberOfIterations_(100),
+         seed_(0),
+         numberOfThreads_(0)
+      {}
+
+      template<class P>
+      Parameter(const P& p)
+      :  kernighanLin_(p.kernighanLin_),
+         numberOfRuns_(p.numberOfRuns_),
+         noise_(p.noise_),
+         maxNumberOfIterations_(p.maxNumberOfIterations_),
+         seed_(p.seed_),
+         numberOfThreads_(p.numberOfThreads_)
+      {}
+
+      bool kernighanLin_;
+      size_t numberOfRuns_;
+      double noise_;
+      /// maximal number of Kernighan-Lin iterations
+      size_t maxNumberOfIterations_;
+      size_t seed_;
+      /// number of threads (0: OpenMP default)
+      size_t numberOfThreads_;
+   };
+
+   MulticutHeuristic(const GraphicalModelType&, const Parameter& = Parameter());
+   virtual std::string name() const { return "MulticutHeuristic"; }
+   const GraphicalModelType& graphicalModel() const { return gm_; }
+   virtual InferenceTermination infer();
+   template<class VisitorType> InferenceTermination infer(VisitorType&);
+   virtual void setStartingPoint(typename std::vector<LabelType>::const_iterator);
+   virtual InferenceTermination arg(std::vector<LabelType>&, const size_t = 1) const;
+   virtual ValueType value() const;
+
+private:
+   typedef multicut_heuristic::WeightedGraph WeightedGraph;
+
+   double solve(const WeightedGraph&, const WeightedGraph&, std::vector<size_t>&) const;
+
+   const GraphicalModelType& gm_;
+   Parameter parameter_;
+   WeightedGraph graph_;
+   double constant_;
+   double energy_;
+   std::vector<LabelType> states_;
+   // empty if there is no starting point
+   std::vector<size_t> startingPoint_;
+};
+
+template<class GM, class ACC>
+MulticutHeuristic<GM, ACC>::MulticutHeuristic
+(
+   const GraphicalModelType& gm,
+   const Parameter& parameter
+)
+:  gm_(gm),
+   parameter_(parameter),
+   graph_(gm.numberOfVariables()),
+   constant_(0.0),
+   energy_(0.0),
+   states_(gm.numberOfVariables(), 0),
+   startingPoint_()
+{
+   if(typeid(ACC) != typeid(opengm::Minimizer) || typeid(OperatorType) != typeid(opengm::Adder)) {
+      throw RuntimeError("This implementation does only supports Min-Plus-Semiring.");
+   }
+   for(IndexType v = 0; v < gm_.numberOfVariables(); ++v) {
+      if(gm_.numberOfLabels(v) < gm_.numberOfVariables()) {
+         throw RuntimeError("Invalid Model for Multicut-Solver! Solver currently do not support first order terms!");
+      }
+   }
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      if(gm_[f].numberOfVariables() == 0) {
+         const LabelType l = 0;
+         constant_ += gm_[f](&l);
+      }
+      else if(gm_[f].numberOfVariables() == 2 && gm_[f].isPotts()) {
+         const LabelType cc0[] = {0, 0};
+         const LabelType cc1[] = {0, 1};
+         constant_ += gm_[f](cc0);
+         graph_.addEdge(gm_[f].variableIndex(0), gm_[f].variableIndex(1), gm_[f](cc1) - gm_[f](cc0));
+      }
+      else {
+         throw RuntimeError("Invalid Model for Multicut-Solver! Solver requires a potts model!");
+      }
+   }
+   graph_.finalize();
+   energy_ = constant_;
+}
+
+template<class GM, class ACC>
+inline InferenceTermination
+MulticutHeuristic<GM, ACC>::infer()
+{
+   EmptyVisitorType visitor;
+   return infer(visitor);
+}
+
+template<class GM, class ACC>
+inline void
+MulticutHeuristic<GM, ACC>::setStartingPoint
+(
+   typename std::vector<LabelType>::const_iterator begin
+)
+{
+   startingPoint_.assign(begin, begin + gm_.numberOfVariables());
+}
+
+/// greedy additive contraction w.r.t. the (perturbed) weights of a graph,
+/// followed by Kernighan-Lin w.r.t. the original weights
+template<class GM, class ACC>
+double
+MulticutHeuristic<GM, ACC>::solve
+(
+   const WeightedGraph& graph,
+   const WeightedGraph& perturbedGraph,
+   std::vector<size_t>& labels
+) const
+{
+   Partition<size_t> partition;
+   multicut_heuristic::greedyAdditiveContraction(perturbedGraph, partition);
+   labels.resize(graph.numberOfNodes());
+   for(size_t n = 0; n < graph.numberOfNodes(); ++n) {
+      labels[n] = partition.find(n);
+   }
+   if(parameter_.kernighanLin_) {
+      return multicut_heuristic::kernighanLin(graph, labels, parameter_.maxNumberOfIterations_, parameter_.numberOfThreads_);
+   }
+   multicut_heuristic::denseLabeling(labels);
+   return graph.energy(labels);
+}
+
+template<class GM, class ACC>
+template<class VisitorType>
+InferenceTermination
+MulticutHeuristic<GM, ACC>::infer
+(
+   VisitorType& visitor
+)
+{
+   #ifdef WITH_OPENMP
+   const int numberOfThreads = parameter_.numberOfThreads_ != 0 ? static_cast<int>(parameter_.numberOfThreads_) : omp_get_max_threads();
+   #endif
+   visitor.begin(*this);
+   const size_t numberOfNodes = graph_.numberOfNodes();
+   const size_t numberOfRuns = std::max<size_t>(parameter_.numberOfRuns_, 1);
+   double meanWeight = 0.0;
+   for(size_t e = 0; e < graph_.numberOfEdges(); ++e) {
+      meanWeight += std::fabs(graph_.weight(e));
+   }
+   if(graph_.numberOfEdges() != 0) {
+      meanWeight /= graph_.numberOfEdges();
+   }
+
+   // independent runs, the first one on the original weights
+   std::vector<std::vector<size_t> > proposals(numberOfRuns);
+   std::vector<double> energies(numberOfRuns);
+   const RandomStream random(static_cast<UInt64Type>(parameter_.seed_));
+   #ifdef WITH_OPENMP
+   #pragma omp parallel for schedule(dynamic) if(numberOfRuns > 1) num_threads(numberOfThreads)
+   #endif
+   for(std::ptrdiff_t r = 0; r < static_cast<std::ptrdiff_t>(numberOfRuns); ++r) {
+      if(r == 0 && !startingPoint_.empty()) {
+         proposals[r] = startingPoint_;
+         if(parameter_.kernighanLin_) {
+            energies[r] = multicut_heuristic::kernighanLin(graph_, proposals[r], parameter_.maxNumberOfIterations_, parameter_.numberOfThreads_);
+         }
+         else {
+            multicut_heuristic::denseLabeling(proposals[r]);
+            energies[r] = graph_.energy(proposals[r]);
+         }
+      }
+      else if(r == 0) {
+         energies[r] = solve(graph_, graph_, proposals[r]);
+      }
+      else {
+         WeightedGraph perturbedGraph(graph_);
+         const UInt64Type offset = static_cast<UInt64Type>(r) * graph_.numberOfEdges();
+         for(size_t e = 0; e < graph_.numberOfEdges(); ++e) {
+            perturbedGraph.weight(e) += parameter_.noise_ * meanWeight * (2.0 * random.uniform(offset + e) - 1.0);
+         }
+         energies[r] = solve(graph_, perturbedGraph, proposals[r]);
+      }
+   }
+   const size_t best = std::min_element(energies.begin(), energies.end()) - energies.begin();
+   std::vector<size_t> labels = proposals[best];
+   double energy = energies[best];
+   for(size_t n = 0; n < numberOfNodes; ++n) {
+      states_[n] = static_cast<LabelType>(labels[n]);
+   }
+   energy_ = constant_ + energy;
+
+   if(numberOfRuns > 1 && visitor(*this) == visitors::VisitorReturnFlag::ContinueInf) {
+      // contract the edges that are not cut in any run
+      Partition<size_t> consensus(numberOfNodes);
+      for(size_t e = 0; e < graph_.numberOfEdges(); ++e) {
+         bool cut = false;
+         for(size_t r = 0; r < numberOfRuns && !cut; ++r) {
+            cut = proposals[r][graph_.u(e)] != proposals[r][graph_.v(e)];
+         }
+         if(!cut) {
+            consensus.merge(graph_.u(e), graph_.v(e));
+         }
+      }
+      std::vector<size_t> contractedNode(numberOfNodes);
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         contractedNode[n] = consensus.find(n);
+      }
+      const size_t numberOfContractedNodes = multicut_heuristic::denseLabeling(contractedNode);
+      WeightedGraph contracted(numberOfContractedNodes);
+      for(size_t e = 0; e < graph_.numberOfEdges(); ++e) {
+         const size_t a = contractedNode[graph_.u(e)];
+         const size_t b = contractedNode[graph_.v(e)];
+         if(a != b) {
+            contracted.addEdge(a, b, graph_.weight(e));
+         }
+      }
+      contracted.finalize();
+
+      // start from the best run (which is a clustering of the contracted graph)
+      // and from the greedy contraction of the contracted graph
+      std::vector<size_t> fused(numberOfContractedNodes);
+      for(size_t n = 0; n < numberOfNodes; ++n) {
+         fused[contractedNode[n]] = labels[n];
+      }
+      double fusedEnergy = multicut_heuristic::kernighanLin(contracted, fused, parameter_.maxNumberOfIterations_, parameter_.numberOfThreads_);
+      std::vector<size_t> greedy;
+      const double greedyEnergy = solve(contracted, contracted, greedy);
+      if(greedyEnergy < fusedEnergy) {
+         fused.swap(greedy);
+         fusedEnergy = greedyEnergy;
+      }
+      if(fusedEnergy < energy) {
+         energy = fusedEnergy;
+         for(size_t n = 0; n < numberOfNodes; ++n) {
+            states_[n] = static_cast<LabelType>(fused[contractedNode[n]]);
+         }
+         energy_ = constant_ + energy;
+      }
+   }
+   visitor(*this);
+   visitor.end(*this);
+   return NORMAL;
+}
+
+template<class GM, class ACC>
+InferenceTermination
+MulticutHeuristic<GM, ACC>::arg
+(
+   std::vector<LabelType>& x,
+   const size_t N
+) const
+{
+   if(N != 1) {
+      return UNKNOWN;
+   }
+   x = states_;
+   return NORMAL;
+}
+
+/// energy of the current clustering
+template<class GM, class ACC>
+typename MulticutHeuristic<GM, ACC>::ValueType
+MulticutHeuristic<GM, ACC>::value() const
+{
+   return static_cast<ValueType>(energy_);
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_MULTICUT_HEURISTIC_HXX
@@ -26,6 +26,7 @@
 #include "opengm/utilities/timer.hxx"
 #include "opengm/utilities/queues.hxx"
 #include "opengm/utilities/partitions.hxx"
+#include "opengm/inference/auxiliary/constraint_separation.hxx"
 
 #include <ilcplex/ilocplex.h>
 //ILOSTLBEGIN
@@ -222,6 +223,7 @@ private:
    /// For each variable it contains a map indexed by neighbord nodes giving the index to the LP-variable
    /// e.g. neighbours[a][b] = i means a has the neighbour b and the edge has the index i in the linear objective
    std::vector<EdgeMapType >   neighbours; 
+   CycleSeparation<IndexType>  cycleSeparation_;
 
    IloEnv         env_;
    IloModel       model_;
@@ -1380,57 +1382,34 @@ size_t Multicut<GM, ACC>::findCycleConstraints(
    std::map<std::pair<IndexType,IndexType>,size_t> counter;
 
    if(!parameter_.useOldPriorityQueue_){
-      std::vector<IndexType>                  prev(neighbours.size());
-      opengm::ChangeablePriorityQueue<double> openNodes(neighbours.size());
-      std::vector<IndexType> path;
-      path.reserve(neighbours.size());
-      for(size_t i=0; i<numberOfInternalEdges_;++i) {
-      
-         IndexType u = edgeNodes_[i].first;//[0];
-         IndexType v = edgeNodes_[i].second;//[1]; 
-      
-         if(usePreBounding && partit[u] != partit[v])
-            continue;
-
-         OPENGM_ASSERT(i+numberOfTerminalEdges_ == neighbours[u][v]);
-         OPENGM_ASSERT(i+numberOfTerminalEdges_ == neighbours[v][u]);
-      
-         if(sol_[numberOfTerminalEdges_+i]>EPS_){
-            //search for cycle
-            double pathLength;
-            pathLength = shortestPath2(u,v,neighbours,sol_,path,prev,openNodes,sol_[numberOfTerminalEdges_+i],addOnlyFacetDefiningConstraints && parameter_.useChordalSearch_);
-            //   pathLength = shortestPath(u,v,neighbours,sol_,path,sol_[numberOfTerminalEdges_+i],addOnlyFacetDefiningConstraints);
-
-            if(sol_[numberOfTerminalEdges_+i]-EPS_>pathLength){
-               bool postChordlessCheck = addOnlyFacetDefiningConstraints && !parameter_.useChordalSearch_; 
-               bool chordless = true;
-               if(postChordlessCheck){
-                  for(size_t n1=0;n1<path.size();++n1){
-                     for(size_t n2=n1+2;n2<path.size();++n2){ 
-                        if(path[n1]==v && path[n2]==u) continue;
-                        if(neighbours[path[n2]].find(path[n1])!=neighbours[path[n2]].end()) {
-                           chordless = false; // do not update node if path is chordal
-                           break;
-                        } 
-                     } 
-                     if(!chordless)
-                        break;
-                  } 
-               }
-               if(chordless){
-                  OPENGM_ASSERT(path.size()>2);
-                  constraint.add(IloRange(env_, 0  , 1000000000)); 
-                  //negative zero seemed to be required for numerical reasons, even CPlex handel this by its own, too.
-                  constraint[constraintCounter_].setLinearCoef(x_[numberOfTerminalEdges_+i],-1);
-                  for(size_t n=0;n<path.size()-1;++n){
-                     constraint[constraintCounter_].setLinearCoef(x_[neighbours[path[n]][path[n+1]]],1);
-                  }
-                  ++constraintCounter_;
-               } 
-            }
-         } 
-         if(constraintCounter_-tempConstrainCounter >= parameter_.maximalNumberOfConstraintsPerRound_)
-            break;
+      // shortest path searches from all edges in parallel, the most violated
+      // inequalities are added
+      if(cycleSeparation_.numberOfEdges() != numberOfInternalEdges_){
+         cycleSeparation_.reset(neighbours.size());
+         for(size_t i=0; i<numberOfInternalEdges_;++i)
+            cycleSeparation_.addEdge(edgeNodes_[i].first, edgeNodes_[i].second);
+         cycleSeparation_.finalize();
+      }
+      std::vector<double> x(numberOfInternalEdges_);
+      for(size_t i=0; i<numberOfInternalEdges_;++i)
+         x[i] = sol_[numberOfTerminalEdges_+i];
+      std::vector<bool> candidates;
+      if(usePreBounding){
+         candidates.resize(numberOfInternalEdges_);
+         for(size_t i=0; i<numberOfInternalEdges_;++i)
+            candidates[i] = partit[edgeNodes_[i].first] == partit[edgeNodes_[i].second];
+      }
+      typename CycleSeparation<IndexType>::Parameter separationParameter(
+         addOnlyFacetDefiningConstraints, parameter_.useChordalSearch_, EPS_, parameter_.numThreads_);
+      ViolatedConstraintPool<LPIndexType, double> pool(parameter_.maximalNumberOfConstraintsPerRound_);
+      cycleSeparation_.separate(x, pool, separationParameter, usePreBounding ? &candidates : NULL);
+      for(size_t c=0; c<pool.size(); ++c){
+         OPENGM_ASSERT(pool.termsEnd(c)-pool.termsBegin(c)>2);
+         constraint.add(IloRange(env_, 0  , 1000000000)); 
+         for(typename ViolatedConstraintPool<LPIndexType, double>::TermIteratorType it=pool.termsBegin(c); it!=pool.termsEnd(c); ++it){
+            constraint[constraintCounter_].setLinearCoef(x_[numberOfTerminalEdges_+it->first],it->second);
+         }
+         ++constraintCounter_;
       }
    }
    else{
@@ -8,12 +8,17 @@
 #include "opengm/operations/minimizer.hxx"
 #include "opengm/inference/inference.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
 
 namespace opengm {
    
 /// QPBO Algorithm\n\n
 /// C. Rother, V. Kolmogorov, V. Lempitsky, and M. Szummer, "Optimizing binary MRFs via extended roof duality", CVPR 2007
 ///
+/// With the default parameter the roof dual is computed by MIN_ST_CUT. Weak
+/// persistencies, probing (QPBO-P) and improve (QPBO-I) are computed on the
+/// in-tree QPBOGraph, which reuses the flow between the probing steps.
+///
 /// \ingroup inference 
 template<class GM, class MIN_ST_CUT>
 class QPBO : public Inference<GM, opengm::Minimizer>
@@ -38,9 +43,26 @@ public:
 
 
    struct Parameter{
-     Parameter ( ) {};
-     template<class P>
-     Parameter (const P & p) {};
+      Parameter ( )
+      :  strongPersistency_(true),
+         useProbeing_(false),
+         useImproveing_(false)
+      {}
+      template<class P>
+      Parameter (const P & p)
+      :  strongPersistency_(p.strongPersistency_),
+         useProbeing_(p.useProbeing_),
+         useImproveing_(p.useImproveing_),
+         label_(p.label_.begin(), p.label_.end())
+      {}
+      /// only strong persistencies (otherwise also weak persistencies)
+      bool strongPersistency_;
+      /// using probeing technique
+      bool useProbeing_;
+      /// using improving technique
+      bool useImproveing_;
+      /// initial configuration for improving
+      std::vector<size_t> label_;
    };
 
    QPBO(const GraphicalModelType&, Parameter = Parameter());
@@ -50,6 +72,7 @@ public:
    template<class VISITOR>
       InferenceTermination infer(VISITOR &);
    InferenceTermination arg(std::vector<LabelType>&, const size_t& = 1) const;
+   ValueType bound() const;
    double partialOptimality(std::vector<bool>&) const;
 
 private:
@@ -58,11 +81,13 @@ private:
    void addEdgeCapacity(size_t v,size_t w, ValueType val);
    void addPairwiseFactorType(const FactorType& factor);
    void addPairwiseFactorType(size_t var0,size_t var1,ValueType A,ValueType B,ValueType C,ValueType D);
+   bool extended() const { return !parameter_.strongPersistency_ || parameter_.useProbeing_ || parameter_.useImproveing_; }
 
    // get the index of the opposite literal in the graph_
    size_t neg(size_t var) const { return (var+numVars_)%(2*numVars_); }
 
    const GraphicalModelType& gm_;
+   Parameter parameter_;
    //std::vector<LabelType> state_;
    std::vector<bool> stateBool_;
    size_t numVars_;
@@ -71,22 +96,58 @@ private:
    ValueType tolerance_;
    size_t source_;
    size_t sink_;
+   QPBOGraph<ValueType> qpboGraph_;
+   // persistent labels of the extended QPBO, -1 for unlabeled variables
+   std::vector<int> label_;
+   std::vector<LabelType> arg_;
+   ValueType bound_;
 };
 
 template<class GM,class MIN_ST_CUT>
 QPBO<GM,MIN_ST_CUT>::QPBO
 (
    const GM & gm,
-   typename QPBO<GM,MIN_ST_CUT>::Parameter
+   typename QPBO<GM,MIN_ST_CUT>::Parameter parameter
 )
 :  gm_(gm),
+   parameter_(parameter),
    numVars_(gm_.numberOfVariables()),
-   minStCut_(2*gm_.numberOfVariables()+2, 6*gm_.numberOfVariables()) /// now many edges?
+   minStCut_(2*gm_.numberOfVariables()+2, 6*gm_.numberOfVariables()), /// now many edges?
+   bound_(-std::numeric_limits<ValueType>::infinity())
 {
    constTerm_ = 0;
    source_ = 2*numVars_;
    sink_   = 2*numVars_ + 1;
 
+   if(extended()) {
+      for(size_t j=0; j<gm_.numberOfVariables(); ++j) {
+         if(gm_.numberOfLabels(j) != 2) {
+            throw RuntimeError("This implementation of QPBO supports only binary variables.");
+         }
+      }
+      qpboGraph_.AddNode(static_cast<int>(numVars_));
+      const LabelType l00[] = {0, 0};
+      const LabelType l01[] = {0, 1};
+      const LabelType l10[] = {1, 0};
+      const LabelType l11[] = {1, 1};
+      for(size_t j=0; j<gm_.numberOfFactors(); ++j) {
+         switch (gm_[j].numberOfVariables()) {
+         case 0:
+            constTerm_ += gm_[j](l00);
+            break;
+         case 1:
+            qpboGraph_.AddUnaryTerm(gm_[j].variableIndex(0), gm_[j](l00), gm_[j](l10));
+            break;
+         case 2:
+            qpboGraph_.AddPairwiseTerm(gm_[j].variableIndex(0), gm_[j].variableIndex(1),
+                                       gm_[j](l00), gm_[j](l01), gm_[j](l10), gm_[j](l11));
+            break;
+         default: throw RuntimeError("This implementation of the QPBO optimizer does not support factors of order >2.");
+         }
+      }
+      return;
+   }
+
    // add pairwise factors
    for(size_t j=0; j<gm_.numberOfFactors(); ++j) {
       switch (gm_[j].numberOfVariables()) {
@@ -134,7 +195,67 @@ inline InferenceTermination
 QPBO<GM,MIN_ST_CUT>::infer(VISITOR & visitor) 
 {
    visitor.begin(*this);
-   minStCut_.calculateCut(stateBool_); 
+   if(!extended()) {
+      minStCut_.calculateCut(stateBool_); 
+      visitor.end(*this);
+      return NORMAL;
+   }
+
+   qpboGraph_.Solve();
+   if(!parameter_.strongPersistency_) {
+      qpboGraph_.ComputeWeakPersistencies();
+   }
+   bound_ = constTerm_ + 0.5 * qpboGraph_.ComputeTwiceLowerBound();
+   label_.resize(numVars_);
+   std::vector<int> unlabeled;
+   for(size_t i=0; i<numVars_; ++i) {
+      label_[i] = qpboGraph_.GetLabel(i);
+      if(label_[i] < 0) {
+         unlabeled.push_back(static_cast<int>(i));
+      }
+   }
+
+   if(parameter_.useProbeing_ && unlabeled.size() > 0) {
+      typename QPBOGraph<ValueType>::ProbeOptions options;
+      options.weak_persistencies = parameter_.strongPersistency_ ? 0 : 1;
+      std::vector<int> mapping(numVars_);
+      qpboGraph_.Probe(&mapping[0], options);
+      bound_ = constTerm_ + 0.5 * qpboGraph_.ComputeTwiceLowerBound();
+      unlabeled.clear();
+      for(size_t i=0; i<numVars_; ++i) {
+         label_[i] = qpboGraph_.GetLabel(mapping[i] / 2);
+         if(label_[i] < 0) {
+            unlabeled.push_back(static_cast<int>(i));
+         }
+         else {
+            label_[i] = (label_[i] + mapping[i]) % 2;
+         }
+      }
+   }
+
+   arg_.resize(numVars_);
+   for(size_t i=0; i<numVars_; ++i) {
+      if(label_[i] >= 0) {
+         arg_[i] = label_[i];
+      }
+      else {
+         arg_[i] = parameter_.label_.size() > i ? parameter_.label_[i] : 0;
+      }
+   }
+   if(parameter_.useImproveing_ && unlabeled.size() > 0) {
+      // the graph is not contracted by probing, node i is variable i
+      for(size_t i=0; i<numVars_; ++i) {
+         qpboGraph_.SetLabel(i, static_cast<int>(arg_[i]));
+      }
+      for(size_t i=0; i+1<unlabeled.size(); ++i) {
+         const size_t j = i + static_cast<size_t>((static_cast<double>(rand()) / (static_cast<double>(RAND_MAX) + 1.0)) * (unlabeled.size() - i));
+         std::swap(unlabeled[i], unlabeled[j]);
+      }
+      qpboGraph_.Improve(static_cast<int>(unlabeled.size()), &unlabeled[0]);
+      for(size_t i=0; i<numVars_; ++i) {
+         arg_[i] = qpboGraph_.GetLabel(i);
+      }
+   }
    visitor.end(*this);
    return NORMAL;
 }
@@ -150,6 +271,11 @@ QPBO<GM,MIN_ST_CUT>::arg
    if(n > 1) {
       return UNKNOWN;
    }
+   else if(extended()) {
+      arg.assign(arg_.begin(), arg_.end());
+      arg.resize(numVars_, 0);
+      return NORMAL;
+   }
    else {
       arg.resize(numVars_);
       for(size_t j=0; j<arg.size(); ++j) {
@@ -173,6 +299,15 @@ QPBO<GM,MIN_ST_CUT>::partialOptimality
 {
    double opt = 0;
    optVec.resize(numVars_);
+   if(extended()) {
+      for(size_t j=0; j<optVec.size(); ++j) {
+         optVec[j] = j < label_.size() && label_[j] >= 0;
+         if(optVec[j]) {
+            opt++;
+         }
+      }
+      return opt/gm_.numberOfVariables();
+   }
    for(size_t j=0; j<optVec.size(); ++j)
       if (stateBool_[j+2] != stateBool_[neg(j)+2]) {
          optVec[j] = true;
@@ -180,7 +315,15 @@ QPBO<GM,MIN_ST_CUT>::partialOptimality
       } else
          optVec[j] = false;
 
-   return opt/gm_.numerOfVariables();
+   return opt/gm_.numberOfVariables();
+}
+
+/// lower bound of the roof dual, only available with weak persistencies, probing or improving
+template<class GM,class MIN_ST_CUT>
+inline typename QPBO<GM,MIN_ST_CUT>::ValueType
+QPBO<GM,MIN_ST_CUT>::bound() const
+{
+   return bound_;
 }
 
 template<class GM,class MIN_ST_CUT>
@@ -7,6 +7,13 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
@@ -14,9 +21,11 @@
 #include "opengm/utilities/metaprogramming.hxx"
 #include "opengm/datastructures/partition.hxx"
 
-#include "opengm/inference/external/qpbo.hxx"
+#include "opengm/inference/qpbo.hxx"
+#include "opengm/inference/auxiliary/minstcutbk.hxx"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
 #include "opengm/inference/mqpbo.hxx"
-#include "opengm/inference/fix-fusion/fusion-move.hpp"
+#include "opengm/inference/auxiliary/higher_order_reduction.hxx"
 #include "opengm/graphicalmodel/graphicalmodel_manipulator.hxx"
 
 #include "opengm/utilities/modelTrees.hxx"
@@ -60,10 +69,8 @@ namespace opengm {
   /// additional to the CVPR-Paper
   /// * the complete code is refactort - parts of the code are moved to graphicalmodel_manipulator.hxx
   /// * higher order models are supported
-  ///
-  /// it requires:
-  /// * external-qpbo
-  /// * Boost for order reduction (we hope to remove this dependence soon)
+  /// * independent subparts are solved in parallel (largest first), subparts
+  ///   with at most maxEnumerationSize_ variables are solved by enumeration
   ///
   /// Parts of the original code was implemented during the bachelor thesis of Jan Kuske
   ///
@@ -106,6 +113,10 @@ namespace opengm {
         bool Persistency_;
         bool Tentacle_;
         bool ConnectedComponents_;
+        /// independent subparts with at most this number of variables are solved by enumeration
+        size_t maxEnumerationSize_;
+        /// number of threads for the independent subparts (0: OpenMP default)
+        size_t numberOfThreads_;
 
 
         template<class P>
@@ -113,7 +124,9 @@ namespace opengm {
         :   subParameter_(p.subParameter_),
             Persistency_(p.Persistency_),
             Tentacle_(p.Tentacle_),
-            ConnectedComponents_(p.ConnectedComponents_)
+            ConnectedComponents_(p.ConnectedComponents_),
+            maxEnumerationSize_(p.maxEnumerationSize_),
+            numberOfThreads_(p.numberOfThreads_)
         {
         }
 
@@ -121,13 +134,17 @@ namespace opengm {
             const bool Persistency=false,
             const bool Tentacle=false,
             const bool ConnectedComponents=false,
-            typename INF::Parameter subParameter = typename INF::Parameter()
+            typename INF::Parameter subParameter = typename INF::Parameter(),
+            const size_t maxEnumerationSize=2,
+            const size_t numberOfThreads=0
         )
         :
+            subParameter_(subParameter),
             Persistency_(Persistency),
             Tentacle_(Tentacle),
             ConnectedComponents_(ConnectedComponents),
-            subParameter_(subParameter)
+            maxEnumerationSize_(maxEnumerationSize),
+            numberOfThreads_(numberOfThreads)
         {
 
         };
@@ -244,7 +261,7 @@ namespace opengm {
   template<class GM, class ACC, class INF>
   void ReducedInference<GM,ACC,INF>::getPartialOptimalityByQPBO(std::vector<LabelType>& arg, std::vector<bool>& opt)
   {
-    typedef external::QPBO<GM> QPBO;
+    typedef opengm::QPBO<GM, MinSTCutBK<size_t, ValueType> > QPBO;
     typename QPBO::Parameter paraQPBO;
     paraQPBO.strongPersistency_=false;
     QPBO qpbo(gm_,paraQPBO);
@@ -256,69 +273,12 @@ namespace opengm {
   template<class GM, class ACC, class INF>
   void ReducedInference<GM,ACC,INF>::getPartialOptimalityByFixsHOQPBO(std::vector<LabelType>& arg, std::vector<bool>& opt)
   {
-    const size_t maxOrder = 10;
-    ValueType constV = 0;
-    HigherOrderEnergy<ValueType, maxOrder> hoe;
-    hoe.AddVars(gm_.numberOfVariables());
-    for(IndexType f=0; f<gm_.numberOfFactors(); ++f){
-      IndexType size = gm_[f].numberOfVariables();
-      const LabelType l0 = 0;
-      const LabelType l1 = 1;
-      if (size == 0) {
-	constV += gm_[f](&l0);
-	continue;
-      } else if (size == 1) {
-	IndexType var = gm_[f].variableIndex(0);
-	const ValueType e0 = gm_[f](&l0);
-	const ValueType e1 = gm_[f](&l1);
-	hoe.AddUnaryTerm(var, e1 - e0);
-      } else {
-	unsigned int numAssignments = 1 << size;
-	AutoDeleteArray<ValueType> coeffs_array(new ValueType[numAssignments]);
-	ValueType * coeffs = coeffs_array.get();
-	for (unsigned int subset = 1; subset < numAssignments; ++subset) {
-	  coeffs[subset] = 0;
-	}
-	// For each boolean assignment, get the clique energy at the
-	// corresponding labeling
-	AutoDeleteArray<LabelType> cliqueLabels_array(new LabelType[size]);
-	LabelType * cliqueLabels = cliqueLabels_array.get();
-	for(unsigned int assignment = 0;  assignment < numAssignments; ++assignment){
-	  for (unsigned int i = 0; i < size; ++i) {
-	    if (assignment & (1 << i)) {
-	      cliqueLabels[i] = l1;
-	    } else {
-	      cliqueLabels[i] = l0;
-	    }
-	  }
-	  ValueType energy = gm_[f](cliqueLabels);
-	  for (unsigned int subset = 1; subset < numAssignments; ++subset){
-	    if (assignment & ~subset) {
-	      continue;
-	    } else {
-	      int parity = 0;
-	      for (unsigned int b = 0; b < size; ++b) {
-		parity ^=  (((assignment ^ subset) & (1 << b)) != 0);
-	      }
-	      coeffs[subset] += parity ? -energy : energy;
-	    }
-	  }
-	}
-	typename HigherOrderEnergy<ValueType, maxOrder> ::VarId vars[maxOrder];
-	for (unsigned int subset = 1; subset < numAssignments; ++subset) {
-	  int degree = 0;
-	  for (unsigned int b = 0; b < size; ++b) {
-	    if (subset & (1 << b)) {
-	      vars[degree++] = gm_[f].variableIndex(b);
-	    }
-	  }
-	  std::sort(vars, vars+degree);
-	  hoe.AddTerm(coeffs[subset], degree, vars);
-	}
-      }
-    }
-    kolmogorov::qpbo::QPBO<ValueType>  qr(gm_.numberOfVariables(), 0);
-    hoe.ToQuadratic(qr);
+    HigherOrderReduction<ValueType, IndexType> reduction;
+    typename HigherOrderReduction<ValueType, IndexType>::QuadraticType quadratic;
+    reduction.addModel(gm_);
+    reduction.reduce(quadratic);
+    QPBOGraph<ValueType>  qr(quadratic.numberOfNodes(), quadratic.numberOfPairwiseTerms());
+    quadratic.addTo(qr);
     qr.Solve();
 
     for (IndexType i = 0; i < gm_.numberOfVariables(); ++i) {
@@ -336,7 +296,7 @@ namespace opengm {
 	opt[i] = false;
       }
     }
-    bound_ = constV + 0.5 * qr.ComputeTwiceLowerBound();
+    bound_ = quadratic.constant() + 0.5 * qr.ComputeTwiceLowerBound();
   }
 
   template<class GM, class ACC, class INF>
@@ -421,6 +381,11 @@ namespace opengm {
        }
     }
 
+    // Solve small independent subparts by enumeration
+    if(param_.ConnectedComponents_ == true){
+       numFixedVars += gmm.template fixSmallSubModels<ACC>(param_.maxEnumerationSize_);
+    }
+
     //std::cout << numFixedVars <<" of " <<gm_.numberOfVariables() << " are fixed."<<std::endl;
 
     if(numFixedVars == gm_.numberOfVariables()){
@@ -455,21 +420,75 @@ namespace opengm {
     // CONNTECTED COMPONENTS INFERENCE
     if(param_.ConnectedComponents_ == true){
       gmm.buildModifiedSubModels();
-      std::vector<std::vector<LabelType> > args(gmm.numberOfSubmodels(),std::vector<LabelType>() );
-      for(size_t i=0; i<gmm.numberOfSubmodels(); ++i){
+      const size_t numberOfSubmodels = gmm.numberOfSubmodels();
+      std::vector<std::vector<LabelType> > args(numberOfSubmodels,std::vector<LabelType>() );
+      std::vector<ValueType> bounds(numberOfSubmodels);
+      // largest submodels first for a better load balance
+      std::vector<std::pair<IndexType,size_t> > order(numberOfSubmodels);
+      for(size_t i=0; i<numberOfSubmodels; ++i){
          args[i].resize(gmm.getModifiedSubModel(i).numberOfVariables());
+         order[i] = std::make_pair(gmm.getModifiedSubModel(i).numberOfVariables(), i);
       }
-      for(size_t i=0; i<gmm.numberOfSubmodels(); ++i){
-         typename ReducedInferenceHelper<GM>::InfGmType agm = gmm.getModifiedSubModel(i);
-         subinf(agm, param_.Tentacle_, args[i],v,b);
-         //OperatorType::op(v,sv);
-         OperatorType::op(b,sb);
-         //gmm.modifiedSubStates2OriginalState(args, state_);
-         //visitor(*this,value(),bound(),"numberOfComp",i);
-         if( visitor(*this) != visitors::VisitorReturnFlag::ContinueInf ) {
-            visitor.end(*this);
-            return NORMAL;
+      std::sort(order.begin(), order.end(), std::greater<std::pair<IndexType,size_t> >());
+      bool stop = false;
+      // exceptions must not leave the parallel loop, they are rethrown after it
+      std::vector<RuntimeError> errors(numberOfSubmodels, RuntimeError(""));
+      std::vector<unsigned char> failed(numberOfSubmodels, 0);
+#ifdef WITH_OPENMP
+      const int numberOfThreads = param_.numberOfThreads_ > 0 ? static_cast<int>(param_.numberOfThreads_) : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(numberOfThreads)
+#endif
+      for(std::ptrdiff_t n=0; n<static_cast<std::ptrdiff_t>(numberOfSubmodels); ++n){
+         bool skip;
+#ifdef WITH_OPENMP
+#pragma omp critical(reducedinference_visitor)
+#endif
+         skip = stop;
+         if(skip)
+            continue;
+         const size_t i = order[n].second;
+         try{
+            ValueType sv;
+            subinf(gmm.getModifiedSubModel(i), param_.Tentacle_, args[i],sv,bounds[i]);
+            //visitor(*this,value(),bound(),"numberOfComp",i);
+#ifdef WITH_OPENMP
+#pragma omp critical(reducedinference_visitor)
+#endif
+            {
+               if( !stop && visitor(*this) != visitors::VisitorReturnFlag::ContinueInf ) {
+                  stop = true;
+               }
+            }
+         }
+         catch(const RuntimeError& e){
+            errors[i] = e;
+            failed[i] = 1;
          }
+         catch(const std::exception& e){
+            errors[i] = RuntimeError(e.what());
+            failed[i] = 1;
+         }
+         catch(...){
+            errors[i] = RuntimeError("unknown exception in the inference of a submodel");
+            failed[i] = 1;
+         }
+         if(failed[i]){
+#ifdef WITH_OPENMP
+#pragma omp critical(reducedinference_visitor)
+#endif
+            stop = true;
+         }
+      }
+      for(size_t i=0; i<numberOfSubmodels; ++i){
+         if(failed[i])
+            throw errors[i];
+      }
+      if(stop){
+         visitor.end(*this);
+         return NORMAL;
+      }
+      for(size_t i=0; i<numberOfSubmodels; ++i){
+         OperatorType::op(bounds[i],sb);
       }
       bound_= sb;
       gmm.modifiedSubStates2OriginalState(args, state_);
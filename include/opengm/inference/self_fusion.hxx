@@ -3,12 +3,16 @@
 
 #include <vector>
 #include <string>
+#include <stdexcept>
 #include <iostream>
 
 #include "opengm/opengm.hxx"
 #include "opengm/inference/visitors/visitors.hxx"
 #include "opengm/inference/inference.hxx"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 // Fusion Move Solver
 #include "opengm/inference/lazyflipper.hxx"
@@ -19,11 +23,9 @@
 #ifdef WITH_CPLEX
 #include "opengm/inference/lpcplex.hxx"
 #endif
-#ifdef WITH_QPBO
-#include "QPBO.h"
+#include "opengm/inference/auxiliary/qpbo_graph.hxx"
 #include "opengm/inference/reducedinference.hxx"
 #include "opengm/inference/hqpbo.hxx"
-#endif
 
 // fusion move model generator
 #include "opengm/inference/auxiliary/fusion_move/fusion_mover.hxx"
@@ -45,11 +47,8 @@ struct FusionVisitor{
     typedef opengm::LazyFlipper<SubGmType,AccumulationType>     LazyFlipperSubInf;
 
 
-    #ifdef WITH_QPBO
-    typedef kolmogorov::qpbo::QPBO<double>                          QpboSubInf;
-    typedef opengm::external::QPBO<SubGmType>                       QPBOSubInf;
+    typedef QPBOGraph<double>                                       QpboSubInf;
     typedef opengm::HQPBO<SubGmType,AccumulationType>               HQPBOSubInf;
-    #endif
     #ifdef WITH_CPLEX
     typedef opengm::LPCplex<SubGmType,AccumulationType>             CplexSubInf;
     #endif
@@ -77,9 +76,42 @@ struct FusionVisitor{
         argBest_(argBest),
         argOut_(selfFusion.graphicalModel().numberOfVariables()),
         returnFlag_(visitors::VisitorReturnFlag::ContinueInf),
-        numNoProgress_(0)
+        numNoProgress_(0),
+        pipelined_(selfFusion.parameter().pipelined_),
+        workerMovers_(),
+        numberOfWorkers_(0),
+        activeWorkers_(0),
+        queue_(),
+        queueValues_(),
+        queueBegin_(0),
+        queueCount_(0),
+        bestVersion_(0),
+        failed_(false),
+        error_("")
     {
+        if(pipelined_){
+            #ifdef WITH_OPENMP
+            const size_t numberOfThreads = selfFusion.parameter().numberOfThreads_ > 0
+                ? selfFusion.parameter().numberOfThreads_ : static_cast<size_t>(omp_get_max_threads());
+            #else
+            const size_t numberOfThreads = 1;
+            #endif
+            // one thread runs the base solver
+            numberOfWorkers_ = std::max<size_t>(numberOfThreads, 2) - 1;
+            workerMovers_.resize(numberOfThreads);
+            for(size_t t=0; t<numberOfThreads; ++t){
+                workerMovers_[t] = new FusionMoverType(gm_);
+            }
+            const size_t queueSize = std::max<size_t>(selfFusion.parameter().queueSize_, 1);
+            queue_.resize(queueSize);
+            queueValues_.resize(queueSize);
+        }
+    }
 
+    ~FusionVisitor(){
+        for(size_t t=0; t<workerMovers_.size(); ++t){
+            delete workerMovers_[t];
+        }
     }
 
     void begin(
@@ -93,14 +125,110 @@ struct FusionVisitor{
     ){
     }
 
+    /// number of threads of the pipelined mode, one per fusion mover
+    int numberOfThreads() const{
+        return static_cast<int>(workerMovers_.size());
+    }
+
+    /// remember the first error of the pipelined mode, it is rethrown
+    /// after the parallel region
+    void setError(const RuntimeError & error){
+        #ifdef WITH_OPENMP
+        #pragma omp critical(opengm_self_fusion_best)
+        #endif
+        {
+            if(!failed_){
+                failed_ = true;
+                error_ = error;
+            }
+        }
+    }
+
     size_t operator()(
         INF  & inf
     ){
+        if(pipelined_){
+            return this->pipelinedVisit(inf);
+        }
         return this->fuseVisit(inf);
     }
 
 
 
+    /// fuse two labelings with the fusion solver of the parameter
+    ValueType fuse(
+        FusionMoverType &               fusionMover,
+        const std::vector<LabelType> &  argA,
+        const std::vector<LabelType> &  argB,
+        std::vector<LabelType> &        argOut,
+        const ValueType                 valueA,
+        const ValueType                 valueB
+    ){
+        const typename SelfFusionType::Parameter & param = selfFusion_.parameter();
+
+        // setup which to labels should be fused and declare 
+        // output label vector
+        fusionMover.setup(argA,argB,argOut,valueA,valueB);
+        // get the number of fusion-move variables
+        const IndexType nFuseMoveVar=fusionMover.numberOfFusionMoveVariable();
+        if(nFuseMoveVar==0){
+            return valueA;
+        }
+
+        if(param.fusionSolver_==SelfFusionType::LazyFlipperFusion){
+            //std::cout<<"fuse with lazy flipper "<<param.maxSubgraphSize_<<"\n";
+            return fusionMover. template fuse<LazyFlipperSubInf> (
+                typename LazyFlipperSubInf::Parameter(param.maxSubgraphSize_),true
+            );
+        }
+        #ifdef WITH_CPLEX
+        else if(param.fusionSolver_==SelfFusionType::CplexFusion ){
+           // NON reduced inference
+           if(param.reducedInf_==false){
+              //std::cout <<"ILP"<<std::endl;
+              typename CplexSubInf::Parameter p;
+              p.integerConstraint_ = true;
+              p.numberOfThreads_   = 1;
+              p.timeLimit_         = param.fusionTimeLimit_;
+              return fusionMover. template fuse<CplexSubInf> (p,true);
+           } 
+           // reduced inference
+           else{
+              //std::cout <<"RILP"<<std::endl;
+              typedef typename ReducedInferenceHelper<SubGmType>::InfGmType ReducedGmType;
+              typedef opengm::LPCplex<ReducedGmType, AccumulationType>      _CplexSubInf;
+              typedef ReducedInference<SubGmType,AccumulationType,_CplexSubInf>          CplexReducedSubInf; 
+              typename _CplexSubInf::Parameter _subInfParam;
+              _subInfParam.integerConstraint_ = true; 
+              _subInfParam.numberOfThreads_   = 1;
+              _subInfParam.timeLimit_         = param.fusionTimeLimit_; 
+              typename CplexReducedSubInf::Parameter subInfParam(true,param.tentacles_,param.connectedComponents_,_subInfParam);
+              return fusionMover. template fuse<CplexReducedSubInf> (subInfParam,true); 
+           }
+        }
+        #endif
+
+        else if(param.fusionSolver_==SelfFusionType::QpboFusion ){
+            
+            if(selfFusion_.maxOrder()<=2){
+                //std::cout<<"fuse with qpbo\n";
+                return fusionMover. template fuseQpbo<QpboSubInf> ();
+                //typename QPBOSubInf::Parameter subInfParam;
+                //subInfParam.strongPersistency_ = false;
+                //subInfParam.label_ = argBest_;
+                //value_ = fusionMover_. template fuse<QPBOSubInf> (subInfParam,false); 
+            }
+            else{
+                //std::cout<<"fuse with fix-qpbo\n";
+                //value_ = fusionMover_. template fuseFixQpbo<QpboSubInf> ();
+                typename HQPBOSubInf::Parameter subInfParam;
+                return fusionMover. template fuse<HQPBOSubInf> (subInfParam,true);
+            }
+        }
+        else{
+           throw std::runtime_error("Unknown Fusion Type! Maybe caused by missing linking!");
+        }
+    }
 
 
 
@@ -113,10 +241,7 @@ struct FusionVisitor{
         if(iteration_==0 ){         
             inference.arg(argBest_);
             ValueType value = inference.value();
-            if(AccumulationType::bop(value,value_)){
-               std::copy(argOut_.begin(),argOut_.end(),argBest_.begin());
-               value_ = value;
-            }
+            value_ = value;
             returnFlag_ =   selfFusionVisitor_(selfFusion_);
             selfFusionVisitor_.log("infValue",value);
         }
@@ -127,115 +252,216 @@ struct FusionVisitor{
             const ValueType infValue = inference.value();
             bound_   = inference.bound();
             lastInfValue_=infValue;
-            IndexType nLocalVar=0;
-            for(IndexType vi=0;vi<gm_.numberOfVariables();++vi){
-                if(argBest_[vi]!=argFromInf_[vi]){
-                    ++nLocalVar;
-                }
-            }
 
+            value_ = this->fuse(fusionMover_,argBest_,argFromInf_,argOut_,value_,infValue);
 
-            // setup which to labels should be fused and declare 
-            // output label vector
-            fusionMover_.setup(argBest_,argFromInf_,argOut_,value_,infValue);
-            // get the number of fusion-move variables
-            const IndexType nFuseMoveVar=fusionMover_.numberOfFusionMoveVariable();
+            // write fusion result into best arg
+            std::copy(argOut_.begin(),argOut_.end(),argBest_.begin());
 
-            if(nFuseMoveVar>0){
+            //std::cout<<"fusionValue "<<value_<<" infValue "<<infValue<<"\n";
 
+            returnFlag_ =  selfFusionVisitor_(selfFusion_);
+                            selfFusionVisitor_.log("infValue",infValue);
+        }
+        ++iteration_;
 
-                if(param.fusionSolver_==SelfFusionType::LazyFlipperFusion){
-                    //std::cout<<"fuse with lazy flipper "<<param.maxSubgraphSize_<<"\n";
-                    value_ = fusionMover_. template fuse<LazyFlipperSubInf> (
-                        typename LazyFlipperSubInf::Parameter(param.maxSubgraphSize_),true
-                    );
+        if(oldValue == value_){
+           ++numNoProgress_;
+        }else{
+           numNoProgress_=0; 
+        }
+        
+        if(numNoProgress_>=param.numStopIt_)
+           return visitors::VisitorReturnFlag::StopInfTimeout;
 
-                }
-                #ifdef WITH_CPLEX
-                else if(param.fusionSolver_==SelfFusionType::CplexFusion ){
-#ifdef WITH_QPBO
-                   // NON reduced inference
-                   if(param.reducedInf_==false){
-#endif  
-                      //std::cout <<"ILP"<<std::endl;
-                      typename CplexSubInf::Parameter p;
-                      p.integerConstraint_ = true;
-                      p.numberOfThreads_   = 1;
-                      p.timeLimit_         = param.fusionTimeLimit_;
-                      value_ = fusionMover_. template fuse<CplexSubInf> (p,true);
- #ifdef WITH_QPBO
-                   } 
-                   // reduced inference
-                   else{
-                      //std::cout <<"RILP"<<std::endl;
-                      typedef typename ReducedInferenceHelper<SubGmType>::InfGmType ReducedGmType;
-                      typedef opengm::LPCplex<ReducedGmType, AccumulationType>      _CplexSubInf;
-                      typedef ReducedInference<SubGmType,AccumulationType,_CplexSubInf>          CplexReducedSubInf; 
-                      typename _CplexSubInf::Parameter _subInfParam;
-                      _subInfParam.integerConstraint_ = true; 
-                      _subInfParam.numberOfThreads_   = 1;
-                      _subInfParam.timeLimit_         = param.fusionTimeLimit_; 
-                      typename CplexReducedSubInf::Parameter subInfParam(true,param.tentacles_,param.connectedComponents_,_subInfParam);
-                      value_ = fusionMover_. template fuse<CplexReducedSubInf> (subInfParam,true); 
-                   }
-                  
- #endif
-                   
-                }
-                #endif
+        return returnFlag_;
+    } 
 
-                #ifdef WITH_QPBO
-                else if(param.fusionSolver_==SelfFusionType::QpboFusion ){
-                    
-                    if(selfFusion_.maxOrder()<=2){
-                        //std::cout<<"fuse with qpbo\n";
-                        value_ = fusionMover_. template fuseQpbo<QpboSubInf> ();
-                        //typename QPBOSubInf::Parameter subInfParam;
-                        //subInfParam.strongPersistency_ = false;
-                        //subInfParam.label_ = argBest_;
-                        //value_ = fusionMover_. template fuse<QPBOSubInf> (subInfParam,false); 
-                    }
-                    else{
-                        //std::cout<<"fuse with fix-qpbo\n";
-                        //value_ = fusionMover_. template fuseFixQpbo<QpboSubInf> ();
-                        typename HQPBOSubInf::Parameter subInfParam;
-                        value_ = fusionMover_. template fuse<HQPBOSubInf> (subInfParam,true);
-                    }
-                }
-                #endif
-                else{
-                   throw std::runtime_error("Unknown Fusion Type! Maybe caused by missing linking!");
-                }
 
 
-                // write fusion result into best arg
-                std::copy(argOut_.begin(),argOut_.end(),argBest_.begin());
+    /// pass the labeling of the base solver to the fusion workers, without
+    /// waiting for the fusion
+    size_t pipelinedVisit(INF & inference){
 
-                //std::cout<<"fusionValue "<<value_<<" infValue "<<infValue<<"\n";
+        const typename SelfFusionType::Parameter & param = selfFusion_.parameter();
+        bool failed = false;
 
+        if(iteration_==0){
+            inference.arg(argFromInf_);
+            const ValueType value = inference.value();
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_best)
+            #endif
+            {
+                argBest_.swap(argFromInf_);
+                value_ = value;
+                ++bestVersion_;
+                lastValue_ = value_;
+                returnFlag_ =   selfFusionVisitor_(selfFusion_);
+                selfFusionVisitor_.log("infValue",value);
+            }
+            argFromInf_.resize(gm_.numberOfVariables());
+        }
+        else if(iteration_%fuseNth_==0){
+            inference.arg(argFromInf_);
+            const ValueType infValue = inference.value();
+            lastInfValue_=infValue;
+            bool spawn = false;
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_queue)
+            #endif
+            {
+                // the queue is bounded, the oldest labeling is dropped
+                if(queueCount_==queue_.size()){
+                    queueBegin_ = (queueBegin_+1)%queue_.size();
+                    --queueCount_;
+                }
+                const size_t slot = (queueBegin_+queueCount_)%queue_.size();
+                queue_[slot].swap(argFromInf_);
+                queueValues_[slot] = infValue;
+                ++queueCount_;
+                if(activeWorkers_<numberOfWorkers_){
+                    ++activeWorkers_;
+                    spawn = true;
+                }
+            }
+            if(spawn){
+                #ifdef WITH_OPENMP
+                #pragma omp task
+                #endif
+                this->fuseQueued();
+            }
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_best)
+            #endif
+            {
+                bound_   = inference.bound();
+                if(lastValue_ == value_){
+                   ++numNoProgress_;
+                }else{
+                   numNoProgress_=0; 
+                }
+                lastValue_ = value_;
                 returnFlag_ =  selfFusionVisitor_(selfFusion_);
                                 selfFusionVisitor_.log("infValue",infValue);
-            } 
-
-            else{
-               returnFlag_ =   selfFusionVisitor_(selfFusion_);
-               selfFusionVisitor_.log("infValue",value_);
+                failed = failed_;
             }
         }
         ++iteration_;
 
-        if(oldValue == value_){
-           ++numNoProgress_;
-        }else{
-           numNoProgress_=0; 
-        }
-        
+        // a fusion worker failed, stop the base solver
+        if(failed)
+           return visitors::VisitorReturnFlag::StopInfTimeout;
+
         if(numNoProgress_>=param.numStopIt_)
            return visitors::VisitorReturnFlag::StopInfTimeout;
 
         return returnFlag_;
-    } 
+    }
 
+    /// fusion worker: fuse the queued labelings into the best labeling until
+    /// the queue is empty
+    void fuseQueued(){
+        bool failed = false;
+        try{
+            this->fuseQueuedLabelings();
+        }
+        catch(const RuntimeError & e){
+            this->setError(e);
+            failed = true;
+        }
+        catch(const std::exception & e){
+            this->setError(RuntimeError(e.what()));
+            failed = true;
+        }
+        catch(...){
+            this->setError(RuntimeError("unknown exception in a fusion worker"));
+            failed = true;
+        }
+        if(failed){
+            // the worker leaves before the queue is empty
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_queue)
+            #endif
+            {
+                --activeWorkers_;
+            }
+        }
+    }
+
+    void fuseQueuedLabelings(){
+        #ifdef WITH_OPENMP
+        FusionMoverType & fusionMover = *workerMovers_[omp_get_thread_num()];
+        #else
+        FusionMoverType & fusionMover = *workerMovers_[0];
+        #endif
+        std::vector<LabelType> proposal;
+        std::vector<LabelType> best;
+        std::vector<LabelType> out(gm_.numberOfVariables());
+        while(true){
+            bool done = false;
+            ValueType proposalValue = ValueType();
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_queue)
+            #endif
+            {
+                if(queueCount_==0){
+                    --activeWorkers_;
+                    done = true;
+                }
+                else{
+                    proposal.swap(queue_[queueBegin_]);
+                    proposalValue = queueValues_[queueBegin_];
+                    queueBegin_ = (queueBegin_+1)%queue_.size();
+                    --queueCount_;
+                }
+            }
+            if(done){
+                break;
+            }
+
+            ValueType bestValue;
+            size_t version;
+            #ifdef WITH_OPENMP
+            #pragma omp critical(opengm_self_fusion_best)
+            #endif
+            {
+                best = argBest_;
+                bestValue = value_;
+                version = bestVersion_;
+            }
+            while(true){
+                const ValueType value = this->fuse(fusionMover,best,proposal,out,bestValue,proposalValue);
+                bool committed = false;
+                #ifdef WITH_OPENMP
+                #pragma omp critical(opengm_self_fusion_best)
+                #endif
+                {
+                    if(version==bestVersion_){
+                        if(AccumulationType::bop(value,value_)){
+                            std::copy(out.begin(),out.end(),argBest_.begin());
+                            value_ = value;
+                            ++bestVersion_;
+                        }
+                        committed = true;
+                    }
+                    else{
+                        best = argBest_;
+                        bestValue = value_;
+                        version = bestVersion_;
+                    }
+                }
+                if(committed){
+                    break;
+                }
+                // another worker improved the best labeling in the meantime,
+                // fuse the result into the new best labeling
+                proposal.swap(out);
+                proposalValue = value;
+                out.resize(gm_.numberOfVariables());
+            }
+        }
+    }
 
 
 
@@ -259,6 +485,23 @@ struct FusionVisitor{
     size_t returnFlag_;
     size_t numNoProgress_;
 
+    // pipelined fusion
+    bool pipelined_;
+    std::vector<FusionMoverType *> workerMovers_;
+    size_t numberOfWorkers_;
+    size_t activeWorkers_;
+    // bounded ring buffer of the labelings of the base solver
+    std::vector<std::vector<LabelType> > queue_;
+    std::vector<ValueType> queueValues_;
+    size_t queueBegin_;
+    size_t queueCount_;
+    // incremented whenever the best labeling changes
+    size_t bestVersion_;
+    ValueType lastValue_;
+    // first error of the pipelined mode
+    bool failed_;
+    RuntimeError error_;
+
 };
 
 
@@ -310,7 +553,9 @@ public:
         const bool tentacles = false,
         const bool connectedComponents = false,
         const double fusionTimeLimit = 100.0,
-        const size_t numStopIt = 10
+        const size_t numStopIt = 10,
+        const bool pipelined = false,
+        const size_t numberOfThreads = 0
       )
       : fuseNth_(fuseNth),
         fusionSolver_(fusionSolver),
@@ -320,7 +565,10 @@ public:
         connectedComponents_(connectedComponents),
         tentacles_(tentacles),
         fusionTimeLimit_(fusionTimeLimit),
-        numStopIt_(numStopIt)
+        numStopIt_(numStopIt),
+        pipelined_(pipelined),
+        numberOfThreads_(numberOfThreads),
+        queueSize_(4)
       {
 
       }
@@ -337,7 +585,10 @@ public:
         connectedComponents_(p.connectedComponents_),
         tentacles_(p.tentacles_),
         fusionTimeLimit_(p.fusionTimeLimit_),
-        numStopIt_(p.numStopIt_)
+        numStopIt_(p.numStopIt_),
+        pipelined_(p.pipelined_),
+        numberOfThreads_(p.numberOfThreads_),
+        queueSize_(p.queueSize_)
       { 
         if(p.fusionSolver_ == 0){
             fusionSolver_ = QpboFusion;
@@ -359,6 +610,14 @@ public:
       bool tentacles_;
       double fusionTimeLimit_;
       size_t numStopIt_;
+      /// run the base solver on one thread and fuse its labelings
+      /// asynchronously on the other threads (WITH_OPENMP)
+      bool pipelined_;
+      /// number of threads of the pipelined mode (0: OpenMP default)
+      size_t numberOfThreads_;
+      /// maximal number of labelings waiting for fusion, the oldest is
+      /// dropped if the base solver is faster than the fusion
+      size_t queueSize_;
    };
 
    SelfFusion(const GraphicalModelType&, const Parameter& = Parameter());
@@ -467,7 +726,39 @@ InferenceTermination SelfFusion<INFERENCE>::infer
    FusionVisitor<INFERENCE,SelfType,VisitorType> fusionVisitor(*this,visitor,argBest_,value_,bound_,param_.fuseNth_);
 
    INFERENCE inf(gm_,param_.infParam_);
-   inf.infer(fusionVisitor);
+   if(param_.pipelined_){
+      // the base solver runs on one thread and spawns fusion tasks which
+      // are executed by the other threads, the implicit barrier at the end
+      // of the parallel region waits for the remaining fusion moves
+      #ifdef WITH_OPENMP
+      #pragma omp parallel num_threads(fusionVisitor.numberOfThreads())
+      #endif
+      {
+         #ifdef WITH_OPENMP
+         #pragma omp single
+         #endif
+         {
+            try{
+               inf.infer(fusionVisitor);
+            }
+            catch(const RuntimeError & e){
+               fusionVisitor.setError(e);
+            }
+            catch(const std::exception & e){
+               fusionVisitor.setError(RuntimeError(e.what()));
+            }
+            catch(...){
+               fusionVisitor.setError(RuntimeError("unknown exception in the base solver"));
+            }
+         }
+      }
+      if(fusionVisitor.failed_){
+         throw fusionVisitor.error_;
+      }
+   }
+   else{
+      inf.infer(fusionVisitor);
+   }
    visitor.end(*this);
    return NORMAL;
 }
@@ -19,9 +19,13 @@
 #include "opengm/datastructures/randomaccessset.hxx"
 #include "opengm/datastructures/partition.hxx"
 #include "opengm/inference/movemaker.hxx"
-#include "opengm/inference/visitors/visitor.hxx"
+#include "opengm/inference/visitors/visitors.hxx"
 #include "opengm/functions/view_convert_function.hxx"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 namespace opengm {
 
 /// \cond suppress doxygen
@@ -46,6 +50,38 @@ namespace detail_swendsenwang {
          static ProbabilityType convert(const T x)
             { return static_cast<ProbabilityType>(std::exp(-x)); }
    };
+
+   // unnormalized probabilities of all labels of a cluster
+   // from the values of the first order factors connected to it
+   template<class OPERATOR, class ACCUMULATOR, class PROBABILITY>
+   struct ValuesToProbabilities;
+
+   template<class PROBABILITY>
+   struct ValuesToProbabilities<Multiplier, Maximizer, PROBABILITY>
+   {
+      typedef PROBABILITY ProbabilityType;
+      template<class T>
+         static void convert(const std::vector<T>& values, std::vector<ProbabilityType>& probabilities)
+         {
+            for(size_t j = 0; j < values.size(); ++j) {
+               probabilities[j] = static_cast<ProbabilityType>(values[j]);
+            }
+         }
+   };
+
+   template<class PROBABILITY>
+   struct ValuesToProbabilities<Adder, Minimizer, PROBABILITY>
+   {
+      typedef PROBABILITY ProbabilityType;
+      template<class T>
+         static void convert(const std::vector<T>& values, std::vector<ProbabilityType>& probabilities)
+         {
+            const T minValue = *std::min_element(values.begin(), values.end());
+            for(size_t j = 0; j < values.size(); ++j) {
+               probabilities[j] = std::exp(static_cast<ProbabilityType>(minValue - values[j]));
+            }
+         }
+   };
 }
 /// \endcond no longer suppress doxygen
 
@@ -109,7 +145,13 @@ private:
 
 /// \brief Generalized Swendsen-Wang sampling\n\n
 /// A. Barbu, S. Zhu, "Generalizing swendsen-wang to sampling arbitrary posterior probabilities", PAMI 27:1239-1253, 2005
-/// 
+///
+/// With Parameter::parallel_, the sampler instead performs sweeps of the
+/// classic Swendsen-Wang (Edwards-Sokal) algorithm for models with first
+/// order factors and attractive Potts factors: all bonds are activated in
+/// parallel, clusters are formed by a concurrent union-find, and all clusters
+/// are relabeled concurrently. Each sweep is one sampling step.
+///
 /// \ingroup inference 
 template<class GM, class ACC>
 class SwendsenWang 
@@ -121,7 +163,7 @@ public:
    typedef double ProbabilityType;
    typedef SwendsenWangEmptyVisitor<SwendsenWang<GM, ACC> > EmptyVisitorType;
    typedef SwendsenWangVerboseVisitor<SwendsenWang<GM, ACC> > VerboseVisitorType;
-   typedef TimingVisitor<SwendsenWang<GM, ACC> > TimingVisitorType;
+   typedef visitors::TimingVisitor<SwendsenWang<GM, ACC> > TimingVisitorType;
 
    struct Parameter
    {
@@ -135,13 +177,23 @@ public:
       :  maxNumberOfSamplingSteps_(maxNumberOfSamplingSteps),
          numberOfBurnInSteps_(numberOfBurnInSteps),
          lowestAllowedProbability_(lowestAllowedProbability),
-         initialState_(initialState)
+         initialState_(initialState),
+         parallel_(false),
+         numberOfThreads_(0),
+         seed_(0)
       {}
 
       size_t maxNumberOfSamplingSteps_;
       size_t numberOfBurnInSteps_;
       ProbabilityType lowestAllowedProbability_;
       std::vector<LabelType> initialState_;
+      /// parallel Swendsen-Wang sweeps (first order and Potts factors only),
+      /// the numbers of steps are then numbers of sweeps
+      bool parallel_;
+      /// number of OpenMP threads (0 = OpenMP default)
+      size_t numberOfThreads_;
+      /// key of the random stream (parallel_ only)
+      size_t seed_;
    };
 
    SwendsenWang(const GraphicalModelType&, const Parameter& param = Parameter());
@@ -159,6 +211,8 @@ public:
    ValueType currentBestValue() const;
 
 private:
+   template<class VISITOR>
+      InferenceTermination inferParallel(VISITOR&);
    void computeEdgeProbabilities();
    void cluster(Partition<size_t>&) const;
    template<bool BURNED_IN, class VARIABLE_ITERATOR, class STATE_ITERATOR>
@@ -195,7 +249,9 @@ SwendsenWang<GM, ACC>::SwendsenWang
    for(size_t j=0; j<gm_.numberOfVariables(); ++j) {
       edgeProbabilities_[j].resize(variableAdjacency_[j].size());
    }
-   computeEdgeProbabilities();
+   if(!parameter_.parallel_) {
+      computeEdgeProbabilities();
+   }
 }
 
 template<class GM, class ACC>
@@ -214,7 +270,9 @@ SwendsenWang<GM, ACC>::reset()
       std::fill(currentBestState_.begin(),currentBestState_.end(),0);
    }
    currentBestValue_ = movemaker_.value();
-   computeEdgeProbabilities();
+   if(!parameter_.parallel_) {
+      computeEdgeProbabilities();
+   }
 }
 
 template<class GM, class ACC>
@@ -239,6 +297,9 @@ SwendsenWang<GM, ACC>::infer
    VISITOR& visitor
 )
 {
+   if(parameter_.parallel_) {
+      return inferParallel(visitor);
+   }
    Partition<size_t> partition(gm_.numberOfVariables());
    std::vector<size_t> representatives(gm_.numberOfVariables());
    std::vector<bool> visited(gm_.numberOfVariables());
@@ -357,6 +418,156 @@ SwendsenWang<GM, ACC>::infer
    return NORMAL;
 }
 
+template<class GM, class ACC>
+template<class VISITOR>
+InferenceTermination
+SwendsenWang<GM, ACC>::inferParallel
+(
+   VISITOR& visitor
+)
+{
+   #ifdef WITH_OPENMP
+   const int numberOfThreads = parameter_.numberOfThreads_ > 0 ? static_cast<int>(parameter_.numberOfThreads_) : omp_get_max_threads();
+   #else
+   const int numberOfThreads = 1;
+   #endif
+   const size_t numberOfVariables = gm_.numberOfVariables();
+
+   // bonds: the variables of all Potts factors with their activation
+   // probabilities 1 - p(unequal) / p(equal)
+   std::vector<IndexType> bondVariables;
+   std::vector<ProbabilityType> bondProbabilities;
+   for(IndexType f = 0; f < gm_.numberOfFactors(); ++f) {
+      const FactorType& factor = gm_[f];
+      if(factor.numberOfVariables() < 2) {
+         continue;
+      }
+      if(factor.numberOfVariables() > 2 || !factor.isPotts()) {
+         throw RuntimeError("Parallel Swendsen-Wang sampling requires first order and Potts factors.");
+      }
+      if(factor.numberOfLabels(0) < 2) {
+         continue;
+      }
+      const LabelType equal[] = {0, 0};
+      const LabelType unequal[] = {0, 1};
+      const ProbabilityType probEqual =
+         detail_swendsenwang::ValueToProbability<OperatorType, AccumulationType, ProbabilityType>::convert(factor(equal));
+      const ProbabilityType probUnequal =
+         detail_swendsenwang::ValueToProbability<OperatorType, AccumulationType, ProbabilityType>::convert(factor(unequal));
+      if(probEqual <= 0 || probUnequal > probEqual) {
+         throw RuntimeError("Parallel Swendsen-Wang sampling requires attractive Potts factors.");
+      }
+      if(probUnequal < probEqual) {
+         bondVariables.push_back(factor.variableIndex(0));
+         bondVariables.push_back(factor.variableIndex(1));
+         bondProbabilities.push_back(1 - probUnequal / probEqual);
+      }
+   }
+   const std::ptrdiff_t numberOfBonds = static_cast<std::ptrdiff_t>(bondProbabilities.size());
+
+   // one random number per bond and per cluster in each sweep
+   const RandomStream random(static_cast<UInt64Type>(parameter_.seed_));
+   const UInt64Type numbersPerSweep = static_cast<UInt64Type>(numberOfBonds + numberOfVariables);
+   std::vector<LabelType> labels(movemaker_.stateBegin(), movemaker_.stateEnd());
+   ConcurrentPartition<IndexType> partition(numberOfVariables);
+   std::vector<IndexType> roots(numberOfVariables);
+   std::vector<IndexType> clusterBegin(numberOfVariables + 1);
+   std::vector<IndexType> clusterVariables(numberOfVariables);
+   std::vector<std::vector<ValueType> > values(numberOfThreads);
+   std::vector<std::vector<ProbabilityType> > probabilities(numberOfThreads);
+
+   const size_t numberOfSweeps = parameter_.numberOfBurnInSteps_ + parameter_.maxNumberOfSamplingSteps_;
+   for(size_t s = 0; s < numberOfSweeps; ++s) {
+      const UInt64Type counterOffset = static_cast<UInt64Type>(s) * numbersPerSweep;
+
+      // activate bonds between equally labeled variables and merge clusters
+      partition.reset(numberOfVariables);
+      #pragma omp parallel for num_threads(numberOfThreads)
+      for(std::ptrdiff_t b = 0; b < numberOfBonds; ++b) {
+         const IndexType v0 = bondVariables[2 * b];
+         const IndexType v1 = bondVariables[2 * b + 1];
+         if(labels[v0] == labels[v1]
+         && random.uniform(counterOffset + static_cast<UInt64Type>(b)) < bondProbabilities[b]) {
+            partition.merge(v0, v1);
+         }
+      }
+      #pragma omp parallel for num_threads(numberOfThreads)
+      for(std::ptrdiff_t v = 0; v < static_cast<std::ptrdiff_t>(numberOfVariables); ++v) {
+         roots[v] = partition.find(static_cast<IndexType>(v));
+      }
+
+      // group the variables by cluster (counting sort by root)
+      std::fill(clusterBegin.begin(), clusterBegin.end(), static_cast<IndexType>(0));
+      for(size_t v = 0; v < numberOfVariables; ++v) {
+         ++clusterBegin[roots[v] + 1];
+      }
+      for(size_t v = 0; v < numberOfVariables; ++v) {
+         clusterBegin[v + 1] += clusterBegin[v];
+      }
+      for(size_t v = 0; v < numberOfVariables; ++v) {
+         // clusterBegin[r] is used as insertion position and restored below
+         clusterVariables[clusterBegin[roots[v]]++] = static_cast<IndexType>(v);
+      }
+      for(size_t v = numberOfVariables; v > 0; --v) {
+         clusterBegin[v] = clusterBegin[v - 1];
+      }
+      clusterBegin[0] = 0;
+
+      // draw a new label for every cluster from the first order factors
+      #pragma omp parallel for schedule(dynamic, 64) num_threads(numberOfThreads)
+      for(std::ptrdiff_t r = 0; r < static_cast<std::ptrdiff_t>(numberOfVariables); ++r) {
+         if(roots[r] != static_cast<IndexType>(r)) {
+            continue;
+         }
+         #ifdef WITH_OPENMP
+         const size_t thread = omp_get_thread_num();
+         #else
+         const size_t thread = 0;
+         #endif
+         const LabelType numberOfLabels = gm_.numberOfLabels(r);
+         std::vector<ValueType>& clusterValues = values[thread];
+         std::vector<ProbabilityType>& clusterProbabilities = probabilities[thread];
+         clusterValues.assign(numberOfLabels, OperatorType::template neutral<ValueType>());
+         clusterProbabilities.resize(numberOfLabels);
+         for(IndexType k = clusterBegin[r]; k < clusterBegin[r + 1]; ++k) {
+            const IndexType variable = clusterVariables[k];
+            OPENGM_ASSERT(gm_.numberOfLabels(variable) == numberOfLabels);
+            for(IndexType f = 0; f < gm_.numberOfFactors(variable); ++f) {
+               const FactorType& factor = gm_[gm_.factorOfVariable(variable, f)];
+               if(factor.numberOfVariables() == 1) {
+                  for(LabelType label = 0; label < numberOfLabels; ++label) {
+                     OperatorType::op(factor(&label), clusterValues[label]);
+                  }
+               }
+            }
+         }
+         detail_swendsenwang::ValuesToProbabilities<OperatorType, AccumulationType, ProbabilityType>::convert(clusterValues, clusterProbabilities);
+         for(LabelType label = 1; label < numberOfLabels; ++label) {
+            clusterProbabilities[label] += clusterProbabilities[label - 1];
+         }
+         const ProbabilityType threshold = random.uniform(counterOffset + static_cast<UInt64Type>(numberOfBonds + r))
+            * clusterProbabilities[numberOfLabels - 1];
+         LabelType label = 0;
+         while(label + 1 < numberOfLabels && clusterProbabilities[label] <= threshold) {
+            ++label;
+         }
+         for(IndexType k = clusterBegin[r]; k < clusterBegin[r + 1]; ++k) {
+            labels[clusterVariables[k]] = label;
+         }
+      }
+
+      movemaker_.initialize(labels.begin());
+      const bool burningIn = (s < parameter_.numberOfBurnInSteps_);
+      if(!burningIn && ACC::bop(movemaker_.value(), currentBestValue_)) {
+         currentBestValue_ = movemaker_.value();
+         std::copy(movemaker_.stateBegin(), movemaker_.stateEnd(), currentBestState_.begin());
+      }
+      visitor(*this, s, numberOfVariables, true, burningIn);
+   }
+
+   return NORMAL;
+}
+
 template<class GM, class ACC>
 inline InferenceTermination
 SwendsenWang<GM, ACC>::infer()
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef OPENGM_DISTANCE_TRANSFORM_HXX
+#define OPENGM_DISTANCE_TRANSFORM_HXX
+
+#include <vector>
+#include <cmath>
+#include <iterator>
+
+#include "opengm/opengm.hxx"
+
+namespace opengm {
+
+/// \brief exact Euclidean distance transform of labelings of a grid
+///
+/// P. Felzenszwalb and D. Huttenlocher, "Distance transforms of sampled
+/// functions", Theory of Computing 8, 2012
+///
+/// The squared distances are computed by one pass of the lower envelope of
+/// parabolas along each dimension, i.e. in linear time. The grid is stored
+/// with the first coordinate running fastest. If no element has the label,
+/// the distance is sqrt(1 + sum of the squared extents of the grid), which is
+/// larger than any distance on the grid.
+///
+/// Corresponding function of VIGRA: separableMultiDistance
+///
+template<class VALUE = double>
+class EuclideanDistanceTransform {
+public:
+   typedef VALUE ValueType;
+
+   EuclideanDistanceTransform();
+   template<class ITERATOR>
+      EuclideanDistanceTransform(ITERATOR, ITERATOR);
+   template<class ITERATOR>
+      void setShape(ITERATOR, ITERATOR);
+   size_t size() const { return size_; }
+   template<class ITERATOR, class LABEL>
+      void operator()(ITERATOR, const LABEL, std::vector<ValueType>&);
+
+private:
+   void transformLine(ValueType*, const size_t, const size_t);
+
+   std::vector<size_t> shape_;
+   size_t size_;
+   ValueType infinity_;
+   // buffers of the 1-dimensional transform
+   std::vector<ValueType> line_;
+   std::vector<size_t> vertices_;
+   std::vector<ValueType> boundaries_;
+};
+
+template<class VALUE>
+inline
+EuclideanDistanceTransform<VALUE>::EuclideanDistanceTransform()
+:  shape_(),
+   size_(0),
+   infinity_(0)
+{}
+
+/// \param shapeBegin begin of the sequence of the extents of the grid
+/// \param shapeEnd end of the sequence of the extents of the grid
+template<class VALUE>
+template<class ITERATOR>
+inline
+EuclideanDistanceTransform<VALUE>::EuclideanDistanceTransform
+(
+   ITERATOR shapeBegin,
+   ITERATOR shapeEnd
+)
+:  shape_(),
+   size_(0),
+   infinity_(0)
+{
+   setShape(shapeBegin, shapeEnd);
+}
+
+template<class VALUE>
+template<class ITERATOR>
+inline void
+EuclideanDistanceTransform<VALUE>::setShape
+(
+   ITERATOR shapeBegin,
+   ITERATOR shapeEnd
+) {
+   shape_.assign(shapeBegin, shapeEnd);
+   size_ = 1;
+   size_t maxExtent = 0;
+   // any squared distance on the grid is smaller than infinity_
+   infinity_ = 1;
+   for(size_t d = 0; d < shape_.size(); ++d) {
+      size_ *= shape_[d];
+      infinity_ += static_cast<ValueType>(shape_[d]) * static_cast<ValueType>(shape_[d]);
+      maxExtent = shape_[d] > maxExtent ? shape_[d] : maxExtent;
+   }
+   line_.resize(maxExtent);
+   vertices_.resize(maxExtent);
+   boundaries_.resize(maxExtent + 1);
+}
+
+/// \brief distances of all elements to the nearest element with a given label
+///
+/// \param labels iterator to the labels of the grid
+/// \param label label of the elements to which the distances are measured
+/// \param[out] distances distances, 0 for the elements with this label
+template<class VALUE>
+template<class ITERATOR, class LABEL>
+void
+EuclideanDistanceTransform<VALUE>::operator()
+(
+   ITERATOR labels,
+   const LABEL label,
+   std::vector<ValueType>& distances
+) {
+   typedef typename std::iterator_traits<ITERATOR>::value_type IteratorLabelType;
+   const IteratorLabelType iteratorLabel = static_cast<IteratorLabelType>(label);
+   distances.resize(size_);
+   for(size_t i = 0; i < size_; ++i, ++labels) {
+      distances[i] = *labels == iteratorLabel ? 0 : infinity_;
+   }
+   size_t stride = 1;
+   for(size_t d = 0; d < shape_.size(); ++d) {
+      const size_t n = shape_[d];
+      // lines along dimension d start at the elements with coordinate 0 in d
+      for(size_t outer = 0; outer < size_; outer += stride * n) {
+         for(size_t inner = 0; inner < stride; ++inner) {
+            transformLine(&distances[outer + inner], n, stride);
+         }
+      }
+      stride *= n;
+   }
+   for(size_t i = 0; i < size_; ++i) {
+      distances[i] = distances[i] < infinity_ ? std::sqrt(distances[i]) : std::sqrt(infinity_);
+   }
+}
+
+/// squared distance transform of one line in place, by the lower envelope of
+/// the parabolas (q - v)^2 + f(v)
+template<class VALUE>
+inline void
+EuclideanDistanceTransform<VALUE>::transformLine
+(
+   ValueType* f,
+   const size_t n,
+   const size_t stride
+) {
+   if(n < 2) {
+      return;
+   }
+   for(size_t q = 0; q < n; ++q) {
+      line_[q] = f[q * stride];
+   }
+   size_t k = 0;
+   vertices_[0] = 0;
+   boundaries_[0] = -infinity_;
+   boundaries_[1] = infinity_;
+   for(size_t q = 1; q < n; ++q) {
+      ValueType s;
+      while(true) {
+         const ValueType v = static_cast<ValueType>(vertices_[k]);
+         const ValueType x = static_cast<ValueType>(q);
+         s = ((line_[q] + x * x) - (line_[vertices_[k]] + v * v)) / (2 * x - 2 * v);
+         if(s > boundaries_[k] || k == 0) {
+            break;
+         }
+         --k;
+      }
+      ++k;
+      vertices_[k] = q;
+      boundaries_[k] = s;
+      boundaries_[k + 1] = infinity_;
+   }
+   k = 0;
+   for(size_t q = 0; q < n; ++q) {
+      while(boundaries_[k + 1] < static_cast<ValueType>(q)) {
+         ++k;
+      }
+      const ValueType delta = static_cast<ValueType>(q) - static_cast<ValueType>(vertices_[k]);
+      f[q * stride] = delta * delta + line_[vertices_[k]];
+   }
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_DISTANCE_TRANSFORM_HXX
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef OPENGM_GRAPH_COLORING_HXX
+#define OPENGM_GRAPH_COLORING_HXX
+
+#include <vector>
+#include <limits>
+
+namespace opengm {
+
+/// \brief greedy (first fit) coloring of a graph given by adjacency lists
+///
+/// The nodes are visited in ascending order and each node gets the smallest
+/// color which is not used by an already colored neighbor. Nodes of the same
+/// color are pairwise non-adjacent.
+///
+/// \param adjacency adjacency[n] is a sequence of the neighbors of node n
+/// \param[out] colorClasses colorClasses[c] holds the nodes of color c in ascending order
+/// \return number of colors
+///
+template<class ADJACENCY_LIST, class INDEX>
+size_t
+greedyColoring
+(
+   const std::vector<ADJACENCY_LIST>& adjacency,
+   std::vector<std::vector<INDEX> >& colorClasses
+)
+{
+   const size_t noColor = std::numeric_limits<size_t>::max();
+   std::vector<size_t> color(adjacency.size(), noColor);
+   // usedBy[c] == n+1 <=> color c is used by a neighbor of node n
+   std::vector<size_t> usedBy;
+   colorClasses.clear();
+   for(size_t n = 0; n < adjacency.size(); ++n) {
+      for(size_t i = 0; i < adjacency[n].size(); ++i) {
+         const size_t c = color[adjacency[n][i]];
+         if(c != noColor) {
+            usedBy[c] = n + 1;
+         }
+      }
+      size_t c = 0;
+      while(c < usedBy.size() && usedBy[c] == n + 1) {
+         ++c;
+      }
+      if(c == usedBy.size()) {
+         usedBy.push_back(0);
+         colorClasses.push_back(std::vector<INDEX>());
+      }
+      color[n] = c;
+      colorClasses[c].push_back(static_cast<INDEX>(n));
+   }
+   return colorClasses.size();
+}
+
+} // namespace opengm
+
+#endif // #ifndef OPENGM_GRAPH_COLORING_HXX
@@ -226,6 +226,45 @@ private:
    opengm::RandomUniform<U> randomFloatingPoint_;
 };
 
+/// counter based random number generator
+///
+/// The n-th number of a stream is a hash (SplitMix64 finalizer) of the key of
+/// the stream and n. Thus, numbers of one or several streams can be drawn
+/// concurrently and independently of the order in which they are drawn.
+class RandomStream
+{
+public:
+   RandomStream(const UInt64Type key = 0)
+   :  key_(mix(key + golden()))
+   {}
+
+   UInt64Type operator()(const UInt64Type counter) const
+   {
+      return mix(key_ ^ (counter * golden()));
+   }
+
+   /// uniform random number in [0, 1)
+   double uniform(const UInt64Type counter) const
+   {
+      return static_cast<double>((*this)(counter) >> 11) / 9007199254740992.0; // 2^53
+   }
+
+private:
+   static UInt64Type golden()
+   {
+      return (static_cast<UInt64Type>(0x9E3779B9UL) << 32) | static_cast<UInt64Type>(0x7F4A7C15UL);
+   }
+
+   static UInt64Type mix(UInt64Type z)
+   {
+      z = (z ^ (z >> 30)) * ((static_cast<UInt64Type>(0xBF58476DUL) << 32) | static_cast<UInt64Type>(0x1CE4E5B9UL));
+      z = (z ^ (z >> 27)) * ((static_cast<UInt64Type>(0x94D049BBUL) << 32) | static_cast<UInt64Type>(0x133111EBUL));
+      return z ^ (z >> 31);
+   }
+
+   UInt64Type key_;
+};
+
 } // namespace opengm
 
 /// \endcond
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/bruteforce.hxx>
+#include <opengm/inference/movemaker.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 4; // width of the grid
+const size_t ny = 3; // height of the grid
+const size_t numberOfLabels = 4;
+const double lambda = 0.5; // coupling strength of the Potts model
+const size_t numberOfBest = 10;
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double> , PottsFunction<double> ) , Space> Model;
+typedef Bruteforce<Model, Minimizer> BruteforceType;
+
+inline size_t variableIndex(const size_t x, const size_t y) {
+   return x + nx * y;
+}
+
+// enumeration in lexicographic order with a full Movemaker update per
+// labeling (as done by Bruteforce before the Gray code enumeration)
+double movemakerEnumeration(const Model& gm, size_t& numberOfConfigurations) {
+   Movemaker<Model> movemaker(gm);
+   vector<size_t> labels(gm.numberOfVariables(), 0);
+   vector<size_t> variables(gm.numberOfVariables());
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      variables[v] = v;
+   }
+   double best = Minimizer::neutral<double>();
+   numberOfConfigurations = 0;
+   for(;;) {
+      const double value = movemaker.move(variables.begin(), variables.end(), labels.begin());
+      best = std::min(best, value);
+      ++numberOfConfigurations;
+      size_t v = 0;
+      while(v < labels.size() && ++labels[v] == gm.numberOfLabels(v)) {
+         labels[v] = 0;
+         ++v;
+      }
+      if(v == labels.size()) {
+         break;
+      }
+   }
+   return best;
+}
+
+// measures the number of evaluated labelings per second of the Gray code
+// enumeration of Bruteforce (top-k, several threads) and of a plain
+// enumeration with full Movemaker updates
+int main() {
+   srand(42);
+   Model gm(Space(nx * ny, numberOfLabels));
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {numberOfLabels};
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      if(x + 1 < nx) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x + 1, y)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x, y + 1)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+   }
+
+   std::cout << setw(20) << "enumeration" << setw(12) << "time [s]" << setw(16) << "labelings/s"
+             << setw(16) << "value" << std::endl;
+   Timer timer;
+   {
+      size_t numberOfConfigurations;
+      timer.tic();
+      const double value = movemakerEnumeration(gm, numberOfConfigurations);
+      timer.toc();
+      std::cout << setw(20) << "movemaker" << setw(12) << timer.elapsedTime()
+                << setw(16) << numberOfConfigurations / timer.elapsedTime()
+                << setw(16) << value << std::endl;
+   }
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+      BruteforceType bruteforce(gm, BruteforceType::Parameter(numberOfBest, numberOfThreads));
+      timer.tic();
+      bruteforce.infer();
+      timer.toc();
+      std::cout << setw(12) << "gray code, " << setw(2) << numberOfThreads << " thr." << setw(12) << timer.elapsedTime()
+                << setw(16) << bruteforce.numberOfConfigurations() / timer.elapsedTime()
+                << setw(16) << bruteforce.value() << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/cgc.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 100; // width of the grid
+const size_t ny = 100; // height of the grid
+const double repulsive = 0.4; // fraction of edges with negative weights
+
+typedef GraphicalModel<double, Adder, PottsFunction<double>, SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef CGC<Model, Minimizer> CGCType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// multicut of a grid graph with random edge weights
+void buildModel(Model& gm) {
+   const size_t numberOfLabels = nx * ny;
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, numberOfLabels));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      for(size_t d = 0; d < 2; ++d) {
+         if((d == 0 && x + 1 < nx) || (d == 1 && y + 1 < ny)) {
+            const size_t vis[] = {v, d == 0 ? v + 1 : v + nx};
+            const double weight = uniform() < repulsive ? -uniform() : uniform();
+            gm.addFactor(gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, weight)), vis, vis + 2);
+         }
+      }
+   }
+}
+
+// cut and glue moves, wall time for 1, 2, 4, ... threads
+int main() {
+   srand(42);
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   Model gm;
+   buildModel(gm);
+   cout << "multicut of a " << nx << "x" << ny << " grid: " << gm.numberOfFactors() << " edges" << endl;
+   cout << setw(10) << "planar" << setw(10) << "threads" << setw(12) << "time [s]" << setw(14) << "value" << endl;
+   for(size_t planar = 0; planar < 2; ++planar) {
+      for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+         CGCType::Parameter parameter;
+         parameter.planar_ = planar == 1;
+         parameter.planarFallback_ = true;
+         parameter.numberOfThreads_ = numberOfThreads;
+         CGCType cgc(gm, parameter);
+         #ifdef WITH_OPENMP
+         const double start = omp_get_wtime();
+         cgc.infer();
+         const double time = omp_get_wtime() - start;
+         #else
+         Timer timer;
+         timer.tic();
+         cgc.infer();
+         timer.toc();
+         const double time = timer.elapsedTime();
+         #endif
+         cout << setw(10) << planar << setw(10) << numberOfThreads << setw(12) << time << setw(14) << cgc.value() << endl;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/multicut-heuristic.hxx>
+#include <opengm/inference/dmc.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 200; // width of the image
+const size_t ny = 200; // height of the image
+const size_t blockSize = 10; // size of the blocks with attractive edges
+const size_t numberOfRounds = 20; // number of changes of the weights
+const size_t changedBlocks = 4; // number of blocks whose weights change per round
+
+typedef GraphicalModel<double, Adder, PottsFunction<double>, SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef MulticutHeuristic<Model, Minimizer> McType;
+typedef DMC<Model, McType> DMCType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// grid graph whose edges are mostly attractive inside of the blocks and
+// repulsive between the blocks, i.e. the blocks are the components
+void buildModel(Model& gm, vector<vector<Model::FunctionIdentifier> >& blockFunctions) {
+   const size_t n = nx * ny;
+   const size_t bx = nx / blockSize;
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(n, n));
+   blockFunctions.assign(bx * (ny / blockSize), vector<Model::FunctionIdentifier>());
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      for(size_t d = 0; d < 2; ++d) {
+         const size_t x1 = x + (d == 0 ? 1 : 0);
+         const size_t y1 = y + (d == 1 ? 1 : 0);
+         if(x1 >= nx || y1 >= ny) {
+            continue;
+         }
+         const size_t b0 = x / blockSize + bx * (y / blockSize);
+         const size_t b1 = x1 / blockSize + bx * (y1 / blockSize);
+         const double w = b0 == b1 ? 2.0 * uniform() - 0.7 : -uniform() - 0.1;
+         const Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(n, n, 0.0, w));
+         const size_t vis[] = {v, x1 + nx * y1};
+         gm.addFactor(fid, vis, vis + 2);
+         if(b0 == b1) {
+            blockFunctions[b0].push_back(fid);
+         }
+      }
+   }
+}
+
+// changes the weights of a few blocks, keeping their signs
+void changeWeights(Model& gm, const vector<vector<Model::FunctionIdentifier> >& blockFunctions) {
+   for(size_t i = 0; i < changedBlocks; ++i) {
+      const vector<Model::FunctionIdentifier>& fids = blockFunctions[rand() % blockFunctions.size()];
+      for(size_t f = 0; f < fids.size(); ++f) {
+         double& w = gm.getFunction<PottsFunction<double> >(fids[f]).parameter(1);
+         w = w > 0 ? w + 0.2 * uniform() : w - 0.2 * uniform();
+      }
+   }
+}
+
+// repeated DMC after changes of the weights of a few blocks: a fresh DMC in
+// each round vs. one DMC that re-solves only the changed components
+int main() {
+   srand(42);
+   Model gm;
+   vector<vector<Model::FunctionIdentifier> > blockFunctions;
+   buildModel(gm, blockFunctions);
+   cout << "grid multicut model: " << gm.numberOfVariables() << " variables, " << gm.numberOfFactors() << " factors" << endl;
+   Model gmIncremental = gm;
+   DMCType incremental(gmIncremental, DMCType::Parameter());
+   double freshTime = 0.0;
+   double incrementalTime = 0.0;
+   double freshValue = 0.0;
+   double incrementalValue = 0.0;
+   for(size_t round = 0; round <= numberOfRounds; ++round) {
+      if(round != 0) {
+         const unsigned int seed = rand();
+         srand(seed);
+         changeWeights(gm, blockFunctions);
+         srand(seed);
+         changeWeights(gmIncremental, blockFunctions);
+      }
+      Timer timer;
+      timer.tic();
+      DMCType fresh(gm, DMCType::Parameter());
+      fresh.infer();
+      timer.toc();
+      freshTime += timer.elapsedTime();
+      freshValue = fresh.value();
+      timer.reset();
+      timer.tic();
+      incremental.infer();
+      timer.toc();
+      incrementalTime += timer.elapsedTime();
+      incrementalValue = incremental.value();
+   }
+   cout << setw(16) << "method" << setw(12) << "time [s]" << setw(16) << "final value" << endl;
+   cout << setw(16) << "fresh" << setw(12) << freshTime << setw(16) << freshValue << endl;
+   cout << setw(16) << "incremental" << setw(12) << incrementalTime << setw(16) << incrementalValue << endl;
+   return 0;
+}
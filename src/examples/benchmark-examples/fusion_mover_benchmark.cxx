@@ -0,0 +1,100 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/auxiliary/fusion_move/fusion_mover.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 200; // width of the grid
+const size_t ny = 200; // height of the grid
+const size_t numberOfLabels = 8;
+const double lambda = 0.3; // coupling strength of the Potts model
+const size_t numberOfRepetitions = 50;
+const size_t maxSubgraphSize = 2; // of the lazy flipper which solves the fusion moves
+
+inline size_t variableIndex(const size_t x, const size_t y) {
+   return x + nx * y;
+}
+
+// measures the latency of a single fusion move (two-label sub-problem solved
+// by the lazy flipper) as a function of the number of variables in which the
+// two fused labelings differ
+int main() {
+   typedef SimpleDiscreteSpace<size_t, size_t> Space;
+   typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double> , PottsFunction<double> ) , Space> Model;
+   typedef FusionMover<Model, Minimizer> FusionMoverType;
+   typedef FusionMoverType::SubGmType SubModel;
+   typedef LazyFlipper<SubModel, Minimizer> SubInference;
+
+   srand(42);
+   Model gm(Space(nx * ny, numberOfLabels));
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {numberOfLabels};
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      if(x + 1 < nx) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x + 1, y)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x, y + 1)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+   }
+
+   std::vector<size_t> argA(gm.numberOfVariables());
+   for(size_t v = 0; v < argA.size(); ++v) {
+      argA[v] = rand() % numberOfLabels;
+   }
+   const double valueA = gm.evaluate(argA.begin());
+
+   FusionMoverType fusionMover(gm);
+   const SubInference::Parameter subParam(maxSubgraphSize);
+   std::vector<size_t> argB(argA.size());
+   std::vector<size_t> argResult(argA.size());
+
+   std::cout << setw(12) << "#differing" << setw(16) << "latency [ms]" << setw(16) << "fusion value" << std::endl;
+   for(size_t nDiff = 1; nDiff <= gm.numberOfVariables(); nDiff *= 4) {
+      double total = 0.0;
+      double value = 0.0;
+      for(size_t r = 0; r < numberOfRepetitions; ++r) {
+         argB = argA;
+         for(size_t i = 0; i < nDiff; ++i) {
+            const size_t v = rand() % argB.size();
+            argB[v] = (argA[v] + 1 + rand() % (numberOfLabels - 1)) % numberOfLabels;
+         }
+         const double valueB = gm.evaluate(argB.begin());
+
+         Timer timer;
+         timer.tic();
+         fusionMover.setup(argA, argB, argResult, valueA, valueB);
+         if(fusionMover.numberOfFusionMoveVariable() > 0) {
+            value = fusionMover.fuse<SubInference>(subParam, true);
+         }
+         timer.toc();
+         total += timer.elapsedTime();
+      }
+      std::cout << setw(12) << nDiff
+                << setw(16) << 1000.0 * total / numberOfRepetitions
+                << setw(16) << value << std::endl;
+   }
+   return 0;
+}
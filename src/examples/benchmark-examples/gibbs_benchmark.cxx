@@ -0,0 +1,154 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/gibbs.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 50; // width of the grid
+const size_t ny = 50; // height of the grid
+const size_t numberOfLabels = 4;
+const double lambda = 0.5; // coupling strength of the Potts model
+const size_t numberOfBurnInSweeps = 100;
+const size_t numberOfSweeps = 1000; // per chain
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double> , PottsFunction<double> ) , Space> Model;
+typedef Gibbs<Model, Minimizer> GibbsType;
+
+inline size_t variableIndex(const size_t x, const size_t y) {
+   return x + nx * y;
+}
+
+// records the energy of every chain once per sweep after the burn-in
+class TraceVisitor {
+public:
+   TraceVisitor(const size_t numberOfChains, const size_t visitNth)
+   :  traces_(numberOfChains), visitNth_(visitNth), calls_(0)
+   {}
+   void begin(const GibbsType&) {}
+   void end(const GibbsType&) {}
+   size_t operator()(const GibbsType& gibbs) {
+      if(!gibbs.burningIn() && ++calls_ % visitNth_ == 0) {
+         traces_[gibbs.currentChain()].push_back(gibbs.markovValue());
+      }
+      return visitors::VisitorReturnFlag::ContinueInf;
+   }
+   vector<vector<double> > traces_;
+
+private:
+   size_t visitNth_;
+   size_t calls_;
+};
+
+// effective sample size of a trace, autocorrelations are summed up to the
+// first negative pair (Geyer's initial positive sequence)
+double effectiveSampleSize(const vector<double>& trace) {
+   const size_t n = trace.size();
+   double mean = 0.0;
+   for(size_t i = 0; i < n; ++i) {
+      mean += trace[i];
+   }
+   mean /= n;
+   double variance = 0.0;
+   for(size_t i = 0; i < n; ++i) {
+      variance += (trace[i] - mean) * (trace[i] - mean);
+   }
+   if(variance == 0.0) {
+      return 0.0;
+   }
+   double sum = 0.0;
+   for(size_t lag = 1; lag + 1 < n; lag += 2) {
+      double pair = 0.0;
+      for(size_t k = lag; k <= lag + 1; ++k) {
+         double c = 0.0;
+         for(size_t i = 0; i + k < n; ++i) {
+            c += (trace[i] - mean) * (trace[i + k] - mean);
+         }
+         pair += c / variance;
+      }
+      if(pair < 0.0) {
+         break;
+      }
+      sum += pair;
+   }
+   return n / (1.0 + 2.0 * sum);
+}
+
+void run(const Model& gm, const string& name, GibbsType::Parameter parameter, const size_t visitNth) {
+   const size_t numberOfChains = parameter.variableProposal_ == GibbsType::Parameter::CHROMATIC ? parameter.numberOfChains_ : 1;
+   TraceVisitor visitor(numberOfChains, visitNth);
+   GibbsType gibbs(gm, parameter);
+   Timer timer;
+   timer.tic();
+   gibbs.infer(visitor);
+   timer.toc();
+   double ess = 0.0;
+   size_t samples = 0;
+   for(size_t c = 0; c < numberOfChains; ++c) {
+      ess += effectiveSampleSize(visitor.traces_[c]);
+      samples += visitor.traces_[c].size();
+   }
+   std::cout << setw(24) << name << setw(12) << timer.elapsedTime() << setw(12) << samples
+             << setw(12) << ess << setw(16) << ess / timer.elapsedTime() << std::endl;
+}
+
+// compares the effective number of samples (of the energy) per second of
+// Metropolis sampling and chromatic heat bath sampling with several chains
+int main() {
+   srand(42);
+   Model gm(Space(nx * ny, numberOfLabels));
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {numberOfLabels};
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      if(x + 1 < nx) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x + 1, y)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x, y + 1)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+   }
+   const size_t n = gm.numberOfVariables();
+
+   std::cout << setw(24) << "sampler" << setw(12) << "time [s]" << setw(12) << "samples"
+             << setw(12) << "ESS" << setw(16) << "ESS/s" << std::endl;
+   {
+      // the visitor is called for every proposed move that changes a label
+      GibbsType::Parameter parameter(numberOfSweeps * n, numberOfBurnInSweeps * n);
+      parameter.variableProposal_ = GibbsType::Parameter::RANDOM;
+      run(gm, "metropolis", parameter, n);
+   }
+   for(size_t numberOfChains = 1; numberOfChains <= 8; numberOfChains *= 2) {
+      GibbsType::Parameter parameter(numberOfSweeps * n, numberOfBurnInSweeps * n);
+      parameter.variableProposal_ = GibbsType::Parameter::CHROMATIC;
+      parameter.numberOfChains_ = numberOfChains;
+      std::ostringstream name;
+      name << "chromatic, " << numberOfChains << " chain(s)";
+      run(gm, name.str(), parameter, 1);
+   }
+   return 0;
+}
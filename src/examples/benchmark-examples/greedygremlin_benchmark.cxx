@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/greedygremlin.hxx>
+#include <opengm/inference/icm.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 1000; // width of the image
+const size_t ny = 1000; // height of the image
+const size_t numberOfLabels = 4; // number of labels
+const double lambda = 0.3; // weight of the Potts terms
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef GreedyGremlin<Model, Minimizer> GreedyGremlinType;
+typedef ICM<Model, Minimizer> ICMType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// Potts model on a grid with random data terms
+void buildModel(Model& gm) {
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, numberOfLabels));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t v = 0; v < nx * ny; ++v) {
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+}
+
+template<class INF>
+void run(INF& inf, const string& name) {
+   Timer timer;
+   timer.tic();
+   inf.infer();
+   timer.toc();
+   cout << setw(16) << name << setw(12) << timer.elapsedTime() << setw(16) << inf.value() << endl;
+}
+
+// GreedyGremlin in breadth-first order and with the priority queue on a
+// grid with a million variables, ICM for comparison
+int main() {
+   srand(42);
+   Model gm;
+   buildModel(gm);
+   cout << "grid model: " << gm.numberOfVariables() << " variables, " << gm.numberOfFactors() << " factors" << endl;
+   cout << setw(16) << "method" << setw(12) << "time [s]" << setw(16) << "value" << endl;
+   {
+      GreedyGremlinType gg(gm, GreedyGremlinType::Parameter(false));
+      run(gg, "GG (bfs)");
+   }
+   {
+      GreedyGremlinType gg(gm, GreedyGremlinType::Parameter(true));
+      run(gg, "GG (queue)");
+   }
+   {
+      ICMType icm(gm);
+      run(icm, "ICM");
+   }
+   return 0;
+}
@@ -0,0 +1,205 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/inference/auxiliary/higher_order_reduction.hxx>
+#include <opengm/inference/auxiliary/qpbo_graph.hxx>
+#include <opengm/utilities/timer.hxx>
+#ifdef WITH_BOOST
+#include <opengm/inference/fix-fusion/fusion-move.hpp>
+#endif
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 100; // width of the image
+const size_t ny = 100; // height of the image
+const double truncation = 4.0; // truncation of the smoothness terms
+const double lambda = 1.0; // weight of the smoothness terms
+const size_t repetitions = 10; // reductions per method for the timing
+
+typedef GraphicalModel<double, Adder, ExplicitFunction<double>, SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef HigherOrderReduction<double> Reduction;
+typedef QPBOGraph<double> QPBOType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// fusion move of two depth proposals a and b: label 0 of a variable takes the
+// depth of a, label 1 the depth of b
+void addFusionFactor(Model& gm, const vector<double>& a, const vector<double>& b, const size_t* variables, const size_t order) {
+   const size_t shape[] = {2, 2, 2, 2};
+   ExplicitFunction<double> f(shape, shape + order);
+   for(size_t assignment = 0; assignment < (size_t(1) << order); ++assignment) {
+      double depth[4];
+      for(size_t i = 0; i < order; ++i) {
+         depth[i] = (assignment >> i) & 1 ? b[variables[i]] : a[variables[i]];
+      }
+      double value;
+      if(order == 3) {
+         // second order smoothness along a row or a column
+         value = fabs(depth[0] - 2.0 * depth[1] + depth[2]);
+      }
+      else {
+         // spread of the depths in a 2x2 clique
+         value = *max_element(depth, depth + 4) - *min_element(depth, depth + 4);
+      }
+      size_t labels[4];
+      for(size_t i = 0; i < order; ++i) {
+         labels[i] = (assignment >> i) & 1;
+      }
+      f(labels) = lambda * min(value, truncation);
+   }
+   gm.addFactor(gm.addFunction(f), variables, variables + order);
+}
+
+void buildModel(Model& gm, const size_t maxOrder) {
+   vector<double> depth(nx * ny);
+   vector<double> a(nx * ny);
+   vector<double> b(nx * ny);
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      depth[y * nx + x] = 0.05 * x + 0.03 * y + (x > nx / 2 ? 5.0 : 0.0);
+      a[y * nx + x] = depth[y * nx + x] + 2.0 * (uniform() - 0.5);
+      b[y * nx + x] = 0.04 * x + 0.04 * y + 4.0 * (uniform() - 0.5);
+   }
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, 2));
+   const size_t shape[] = {2};
+   for(size_t v = 0; v < nx * ny; ++v) {
+      ExplicitFunction<double> f(shape, shape + 1);
+      f(0) = fabs(a[v] - depth[v]);
+      f(1) = fabs(b[v] - depth[v]);
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = y * nx + x;
+      if(x + 2 < nx) {
+         const size_t variables[] = {v, v + 1, v + 2};
+         addFusionFactor(gm, a, b, variables, 3);
+      }
+      if(y + 2 < ny) {
+         const size_t variables[] = {v, v + nx, v + 2 * nx};
+         addFusionFactor(gm, a, b, variables, 3);
+      }
+      if(maxOrder == 4 && x + 1 < nx && y + 1 < ny) {
+         const size_t variables[] = {v, v + 1, v + nx, v + nx + 1};
+         addFusionFactor(gm, a, b, variables, 4);
+      }
+   }
+}
+
+void printResult(const string& name, const double time, const size_t numberOfNodes, const string& numberOfEdges, const Model& gm, const QPBOType& qr, const double bound) {
+   size_t numberOfLabeled = 0;
+   for(size_t i = 0; i < gm.numberOfVariables(); ++i) {
+      if(qr.GetLabel(static_cast<int>(i)) >= 0) {
+         ++numberOfLabeled;
+      }
+   }
+   cout << setw(12) << name << setw(14) << time / repetitions
+        << setw(10) << numberOfNodes << setw(10) << numberOfEdges
+        << setw(12) << 100.0 * numberOfLabeled / gm.numberOfVariables()
+        << setw(16) << bound << endl;
+}
+
+void runNative(const Model& gm, const Reduction::Method method, const string& name) {
+   Reduction reduction(0, method);
+   Reduction::QuadraticType quadratic;
+   QPBOType qr;
+   Timer timer;
+   timer.tic();
+   for(size_t r = 0; r < repetitions; ++r) {
+      reduction.addModel(gm);
+      reduction.reduce(quadratic);
+      qr.Reset();
+      quadratic.addTo(qr);
+   }
+   timer.toc();
+   qr.Solve();
+   qr.ComputeWeakPersistencies();
+   ostringstream edges;
+   edges << quadratic.numberOfPairwiseTerms();
+   printResult(name, timer.elapsedTime(), quadratic.numberOfNodes(), edges.str(), gm, qr, quadratic.constant() + 0.5 * qr.ComputeTwiceLowerBound());
+}
+
+#ifdef WITH_BOOST
+// reduction of the fix-fusion code, the polynomial is built as in the
+// former implementation of HQPBO
+void runHigherOrderEnergy(const Model& gm) {
+   QPBOType qr;
+   double constant = 0.0;
+   Timer timer;
+   timer.tic();
+   for(size_t r = 0; r < repetitions; ++r) {
+      HigherOrderEnergy<double, 4> hoe;
+      hoe.AddVars(gm.numberOfVariables());
+      constant = 0.0;
+      for(size_t f = 0; f < gm.numberOfFactors(); ++f) {
+         const size_t order = gm[f].numberOfVariables();
+         double coefficients[16];
+         size_t labels[4];
+         for(size_t assignment = 0; assignment < (size_t(1) << order); ++assignment) {
+            for(size_t i = 0; i < order; ++i) {
+               labels[i] = (assignment >> i) & 1;
+            }
+            coefficients[assignment] = gm[f](labels);
+         }
+         for(size_t i = 0; i < order; ++i)
+         for(size_t assignment = 0; assignment < (size_t(1) << order); ++assignment) {
+            if(assignment & (size_t(1) << i)) {
+               coefficients[assignment] -= coefficients[assignment ^ (size_t(1) << i)];
+            }
+         }
+         constant += coefficients[0];
+         for(size_t subset = 1; subset < (size_t(1) << order); ++subset) {
+            HigherOrderEnergy<double, 4>::VarId variables[4];
+            int degree = 0;
+            for(size_t i = 0; i < order; ++i) {
+               if(subset & (size_t(1) << i)) {
+                  variables[degree++] = static_cast<HigherOrderEnergy<double, 4>::VarId>(gm[f].variableIndex(i));
+               }
+            }
+            hoe.AddTerm(coefficients[subset], degree, variables);
+         }
+      }
+      qr.Reset();
+      hoe.ToQuadratic(qr);
+   }
+   timer.toc();
+   qr.Solve();
+   qr.ComputeWeakPersistencies();
+   printResult("fix-fusion", timer.elapsedTime(), qr.GetNodeNum(), "-", gm, qr, constant + 0.5 * qr.ComputeTwiceLowerBound());
+}
+#endif
+
+// reduction of random fusion moves of order 3 (second order smoothness of
+// depth maps) and order 4 (2x2 cliques) to QPBO problems
+int main() {
+   srand(42);
+   for(size_t maxOrder = 3; maxOrder <= 4; ++maxOrder) {
+      Model gm;
+      buildModel(gm, maxOrder);
+      cout << "fusion model with factors up to order " << maxOrder << ": "
+           << gm.numberOfVariables() << " variables, " << gm.numberOfFactors() << " factors" << endl;
+      cout << setw(12) << "method" << setw(14) << "time [s]" << setw(10) << "nodes"
+           << setw(10) << "edges" << setw(12) << "labeled %" << setw(16) << "bound" << endl;
+#ifdef WITH_BOOST
+      runHigherOrderEnergy(gm);
+#endif
+      runNative(gm, Reduction::HOCR, "HOCR");
+      runNative(gm, Reduction::Fix, "Fix");
+      cout << endl;
+   }
+   return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/lazyflipper.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 150; // width of the grid
+const size_t ny = 150; // height of the grid
+const size_t numberOfRandomVariables = nx * ny; // variables of the random graph
+const size_t averageDegree = 4; // of the random graph
+const size_t maxSubgraphSize = 3;
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, ExplicitFunction<double>, Space> Model;
+typedef LazyFlipper<Model, Minimizer> LazyFlipperType;
+
+inline size_t variableIndex(const size_t x, const size_t y) {
+   return x + nx * y;
+}
+
+void addUnaries(Model& gm) {
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {2};
+      ExplicitFunction<double> f(shape, shape + 1);
+      f(0) = 0.0;
+      f(1) = static_cast<double>(rand()) / RAND_MAX - 0.5;
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+}
+
+// frustrated (Ising spin glass like) pairwise factor
+void addPairwise(Model& gm, size_t v0, size_t v1) {
+   if(v0 > v1) {
+      std::swap(v0, v1);
+   }
+   const size_t shape[] = {2, 2};
+   ExplicitFunction<double> f(shape, shape + 2);
+   const double w = static_cast<double>(rand()) / RAND_MAX - 0.5;
+   f(0, 0) = 0.0;
+   f(1, 1) = 0.0;
+   f(0, 1) = w;
+   f(1, 0) = w;
+   size_t vis[] = {v0, v1};
+   gm.addFactor(gm.addFunction(f), vis, vis + 2);
+}
+
+void run(const Model& gm, const string& name) {
+   LazyFlipperType::Parameter serialParameter(maxSubgraphSize);
+   LazyFlipperType serial(gm, serialParameter);
+   Timer timer;
+   timer.tic();
+   serial.infer();
+   timer.toc();
+   const double serialTime = timer.elapsedTime();
+
+   std::cout << name << std::endl;
+   std::cout << setw(10) << "threads" << setw(14) << "time [s]" << setw(12) << "speedup"
+             << setw(16) << "value" << std::endl;
+   std::cout << setw(10) << "serial" << setw(14) << serialTime << setw(12) << 1.0
+             << setw(16) << serial.value() << std::endl;
+
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+      LazyFlipperType::Parameter parameter(maxSubgraphSize);
+      parameter.parallel_ = true;
+      parameter.numberOfThreads_ = numberOfThreads;
+      parameter.numberOfRegions_ = numberOfThreads;
+      LazyFlipperType parallel(gm, parameter);
+      timer.tic();
+      parallel.infer();
+      timer.toc();
+      std::cout << setw(10) << numberOfThreads << setw(14) << timer.elapsedTime()
+                << setw(12) << serialTime / timer.elapsedTime()
+                << setw(16) << parallel.value() << std::endl;
+   }
+}
+
+// measures the scaling of the parallel lazy flipper (regions searched
+// concurrently) with the number of threads on a grid and a random graph
+int main() {
+   srand(42);
+   {
+      Model gm(Space(nx * ny, 2));
+      addUnaries(gm);
+      for(size_t y = 0; y < ny; ++y)
+      for(size_t x = 0; x < nx; ++x) {
+         if(x + 1 < nx) {
+            addPairwise(gm, variableIndex(x, y), variableIndex(x + 1, y));
+         }
+         if(y + 1 < ny) {
+            addPairwise(gm, variableIndex(x, y), variableIndex(x, y + 1));
+         }
+      }
+      run(gm, "grid");
+   }
+   {
+      Model gm(Space(numberOfRandomVariables, 2));
+      addUnaries(gm);
+      for(size_t e = 0; e < numberOfRandomVariables * averageDegree / 2; ++e) {
+         const size_t v0 = rand() % numberOfRandomVariables;
+         const size_t v1 = rand() % numberOfRandomVariables;
+         if(v0 != v1) {
+            addPairwise(gm, v0, v1);
+         }
+      }
+      run(gm, "random graph");
+   }
+   return 0;
+}
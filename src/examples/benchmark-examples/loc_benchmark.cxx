@@ -0,0 +1,93 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/loc.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 100; // width of the image
+const size_t ny = 100; // height of the image
+const size_t numberOfLabels = 4; // number of labels
+const double lambda = 0.2; // weight of the Potts terms
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef LOC<Model, Minimizer> LOCType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// Potts model with random data terms
+void buildModel(Model& gm) {
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, numberOfLabels));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t v = 0; v < nx * ny; ++v) {
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+}
+
+// tree windows (dynamic programming) and small blocks (A*),
+// sequential schedule and batches of windows for 1, 2, 4, ..., 16 threads
+int main() {
+   srand(42);
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = std::min(omp_get_max_threads(), 16);
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   Model gm;
+   buildModel(gm);
+   cout << "Potts model on a " << nx << "x" << ny << " grid with " << numberOfLabels << " labels" << endl;
+   cout << setw(12) << "schedule" << setw(10) << "threads" << setw(12) << "time [s]" << setw(14) << "value" << endl;
+   for(size_t numberOfThreads = 0; numberOfThreads <= maxNumberOfThreads; numberOfThreads = (numberOfThreads == 0 ? 1 : 2 * numberOfThreads)) {
+      srand(0);
+      const bool parallel = numberOfThreads > 0;
+      LOCType::Parameter parameter("astar", 0.5, 3, 10, 0.9, 100000, 10000, 8, 0, 1, parallel, numberOfThreads);
+      LOCType loc(gm, parameter);
+      #ifdef WITH_OPENMP
+      const double start = omp_get_wtime();
+      loc.infer();
+      const double time = omp_get_wtime() - start;
+      #else
+      Timer timer;
+      timer.tic();
+      loc.infer();
+      timer.toc();
+      const double time = timer.elapsedTime();
+      #endif
+      cout << setw(12) << (parallel ? "batches" : "sequential") << setw(10) << (parallel ? numberOfThreads : 1) << setw(12) << time << setw(14) << loc.value() << endl;
+   }
+   return 0;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/lpbuiltin.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 300; // width of the grid
+const size_t ny = 300; // height of the grid
+const size_t numberOfLabels = 8;
+const double lambda = 0.6; // weight of the Potts terms
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), Space> Model;
+typedef LPBuiltin<Model, Minimizer> LPBuiltinType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// the LP is assembled in the constructor
+void run(const Model& gm, const string& name, const LPBuiltinType::Parameter& parameter) {
+   Timer timer;
+   timer.tic();
+   LPBuiltinType lp(gm, parameter);
+   timer.toc();
+   std::cout << setw(32) << name << setw(12) << timer.elapsedTime() << std::endl;
+}
+
+// time to assemble the local polytope relaxation of a Potts model with about
+// 10^7 constraint entries, in bulk and one constraint at a time
+int main() {
+   srand(42);
+   Model gm(Space(nx * ny, numberOfLabels));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t v = 0; v < nx * ny; ++v) {
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+   std::cout << nx * ny << " variables, " << numberOfLabels << " labels, " << gm.numberOfFactors() << " factors" << std::endl;
+   std::cout << setw(32) << "assembly" << setw(12) << "time [s]" << std::endl;
+
+   LPBuiltinType::Parameter parameter;
+   parameter.nameConstraints_ = true;
+   run(gm, "one at a time (named)", parameter);
+   parameter.nameConstraints_ = false;
+
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+      parameter.numberOfThreads_ = numberOfThreads;
+      parameter.relaxation_ = LPBuiltinType::Parameter::LocalPolytope;
+      std::ostringstream localName;
+      localName << "local polytope, " << numberOfThreads << " thr.";
+      run(gm, localName.str(), parameter);
+      parameter.relaxation_ = LPBuiltinType::Parameter::LoosePolytope;
+      std::ostringstream looseName;
+      looseName << "loose polytope, " << numberOfThreads << " thr.";
+      run(gm, looseName.str(), parameter);
+   }
+   return 0;
+}
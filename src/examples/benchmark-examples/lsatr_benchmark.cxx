@@ -0,0 +1,108 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/lsatr.hxx>
+#include <opengm/inference/icm.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 200; // width of the image
+const size_t ny = 200; // height of the image
+const double noise = 1.5; // amplitude of the noise of the data terms
+const double lambda = 0.5; // weight of the Potts terms of neighbors
+const double alpha = 0.3; // maximal absolute weight of the terms of pixels at distance 2
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef LSA_TR<Model, Minimizer> LSATRType;
+typedef ICM<Model, Minimizer> ICMType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// binary segmentation of a noisy disc, the terms of pixels at distance 2
+// have random signs and are not submodular if they are negative
+void buildModel(Model& gm) {
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, 2));
+   const size_t shape[] = {2};
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const double dx = static_cast<double>(x) - 0.5 * nx;
+      const double dy = static_cast<double>(y) - 0.5 * ny;
+      const bool inside = dx * dx + dy * dy < 0.1 * nx * ny;
+      ExplicitFunction<double> f(shape, shape + 1);
+      f(0) = 0.0;
+      f(1) = (inside ? -1.0 : 1.0) + noise * (2.0 * uniform() - 1.0);
+      const size_t v = x + nx * y;
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(2, 2, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(x + 2 < nx) {
+         const size_t vis[] = {v, v + 2};
+         gm.addFactor(gm.addFunction(PottsFunction<double>(2, 2, 0.0, alpha * (2.0 * uniform() - 1.0))), vis, vis + 2);
+      }
+      if(y + 2 < ny) {
+         const size_t vis[] = {v, v + 2 * nx};
+         gm.addFactor(gm.addFunction(PottsFunction<double>(2, 2, 0.0, alpha * (2.0 * uniform() - 1.0))), vis, vis + 2);
+      }
+   }
+}
+
+template<class INF>
+void run(INF& inf, const string& name) {
+   Timer timer;
+   timer.tic();
+   inf.infer();
+   timer.toc();
+   cout << setw(16) << name << setw(12) << timer.elapsedTime() << setw(16) << inf.value() << endl;
+}
+
+// LSA-TR with the Euclidean and the Hamming trust region on a binary grid
+// model with non-submodular terms, ICM for comparison
+int main() {
+   srand(42);
+   Model gm;
+   buildModel(gm);
+   cout << "binary grid model: " << gm.numberOfVariables() << " variables, " << gm.numberOfFactors() << " factors" << endl;
+   cout << setw(16) << "method" << setw(12) << "time [s]" << setw(16) << "value" << endl;
+   {
+      LSATRType::Parameter parameter;
+      parameter.distance_ = LSATRType::Parameter::EUCLIDEAN;
+      LSATRType lsatr(gm, parameter);
+      run(lsatr, "LSA-TR (eucl.)");
+   }
+   {
+      LSATRType::Parameter parameter;
+      parameter.distance_ = LSATRType::Parameter::HAMMING;
+      LSATRType lsatr(gm, parameter);
+      run(lsatr, "LSA-TR (hamm.)");
+   }
+   {
+      ICMType icm(gm);
+      run(icm, "ICM");
+   }
+   return 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/mqpbo.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 100; // width of the image
+const size_t ny = 100; // height of the image
+const size_t numberOfRegions = 30; // regions of constant label in the image
+const double noise = 0.3; // fraction of pixels with random data terms
+const double lambda = 0.4; // weight of the Potts terms
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef MQPBO<Model, Minimizer> MQPBOType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// Potts segmentation with region labels as in the reducedinference benchmark
+void buildModel(Model& gm, const size_t numberOfLabels) {
+   std::vector<size_t> centers(2 * numberOfRegions);
+   for(size_t r = 0; r < numberOfRegions; ++r) {
+      centers[2 * r] = rand() % nx;
+      centers[2 * r + 1] = rand() % ny;
+   }
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, numberOfLabels));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      size_t label = 0;
+      size_t bestDistance = nx * nx + ny * ny;
+      for(size_t r = 0; r < numberOfRegions; ++r) {
+         const size_t dx = x > centers[2 * r] ? x - centers[2 * r] : centers[2 * r] - x;
+         const size_t dy = y > centers[2 * r + 1] ? y - centers[2 * r + 1] : centers[2 * r + 1] - y;
+         if(dx * dx + dy * dy < bestDistance) {
+            bestDistance = dx * dx + dy * dy;
+            label = (r * 7) % numberOfLabels;
+         }
+      }
+      ExplicitFunction<double> f(shape, shape + 1);
+      const bool noisy = uniform() < noise;
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = noisy ? uniform() : (l == label ? 0.0 : 1.0 + uniform());
+      }
+      const size_t v = x + nx * y;
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+}
+
+// partial optimality by Kovtun's method, wall time for 1, 2, 4, ... threads
+int main() {
+   srand(42);
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   cout << setw(10) << "labels" << setw(10) << "threads" << setw(12) << "time [s]" << setw(14) << "optimality" << endl;
+   const size_t labels[] = {20, 50, 100};
+   for(size_t n = 0; n < 3; ++n) {
+      Model gm;
+      buildModel(gm, labels[n]);
+      for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+         MQPBOType::Parameter parameter;
+         parameter.useKovtunsMethod_ = true;
+         parameter.numberOfThreads_ = numberOfThreads;
+         MQPBOType mqpbo(gm, parameter);
+         #ifdef WITH_OPENMP
+         const double start = omp_get_wtime();
+         mqpbo.infer();
+         const double time = omp_get_wtime() - start;
+         #else
+         Timer timer;
+         timer.tic();
+         mqpbo.infer();
+         timer.toc();
+         const double time = timer.elapsedTime();
+         #endif
+         cout << setw(10) << labels[n] << setw(10) << numberOfThreads << setw(12) << time << setw(14) << mqpbo.optimality() << endl;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/multicut-heuristic.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t numberOfRandomNodes = 100000;
+const size_t averageDegree = 10; // of the random graph
+const size_t nx = 400; // width of the image
+const size_t ny = 400; // height of the image
+const size_t numberOfRegions = 200; // of the ground truth of the image
+const double noise = 1.2; // of the edge weights of the image
+const size_t numberOfRuns = 4; // fused runs
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, PottsFunction<double>, Space> Model;
+typedef MulticutHeuristic<Model, Minimizer> MulticutHeuristicType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+void addEdge(Model& gm, const size_t v0, const size_t v1, const double weight) {
+   const size_t vis[] = {std::min(v0, v1), std::max(v0, v1)};
+   const size_t n = gm.numberOfVariables();
+   gm.addFactor(gm.addFunction(PottsFunction<double>(n, n, 0.0, weight)), vis, vis + 2);
+}
+
+void run(const Model& gm, const string& name, const MulticutHeuristicType::Parameter& parameter) {
+   MulticutHeuristicType mc(gm, parameter);
+   Timer timer;
+   timer.tic();
+   mc.infer();
+   timer.toc();
+   std::cout << setw(28) << name << setw(12) << timer.elapsedTime() << setw(16) << mc.value() << std::endl;
+}
+
+void runAll(const Model& gm, const string& name) {
+   std::cout << name << ": " << gm.numberOfVariables() << " nodes, " << gm.numberOfFactors() << " edges" << std::endl;
+   std::cout << setw(28) << "solver" << setw(12) << "time [s]" << setw(16) << "energy" << std::endl;
+   run(gm, "greedy contraction", MulticutHeuristicType::Parameter(false));
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+      MulticutHeuristicType::Parameter parameter(true);
+      parameter.numberOfThreads_ = numberOfThreads;
+      std::ostringstream klName;
+      klName << "+ kernighan-lin, " << numberOfThreads << " thr.";
+      run(gm, klName.str(), parameter);
+      parameter.numberOfRuns_ = numberOfRuns;
+      std::ostringstream fusionName;
+      fusionName << "+ fusion of " << numberOfRuns << ", " << numberOfThreads << " thr.";
+      run(gm, fusionName.str(), parameter);
+   }
+}
+
+// runtime and energy of greedy additive edge contraction, Kernighan-Lin and
+// fusion on a random graph and on the grid graph of a noisy image partition
+int main() {
+   srand(42);
+   {
+      Model gm(Space(numberOfRandomNodes, numberOfRandomNodes));
+      for(size_t e = 0; e < numberOfRandomNodes * averageDegree / 2; ++e) {
+         const size_t v0 = rand() % numberOfRandomNodes;
+         const size_t v1 = rand() % numberOfRandomNodes;
+         if(v0 != v1) {
+            addEdge(gm, v0, v1, 2.0 * uniform() - 1.1);
+         }
+      }
+      runAll(gm, "random graph");
+   }
+   {
+      // ground truth: nearest of random region centers
+      vector<double> cx(numberOfRegions), cy(numberOfRegions);
+      for(size_t r = 0; r < numberOfRegions; ++r) {
+         cx[r] = uniform() * nx;
+         cy[r] = uniform() * ny;
+      }
+      vector<size_t> region(nx * ny);
+      for(size_t y = 0; y < ny; ++y)
+      for(size_t x = 0; x < nx; ++x) {
+         double best = 1e300;
+         for(size_t r = 0; r < numberOfRegions; ++r) {
+            const double d = (x - cx[r]) * (x - cx[r]) + (y - cy[r]) * (y - cy[r]);
+            if(d < best) {
+               best = d;
+               region[x + nx * y] = r;
+            }
+         }
+      }
+      Model gm(Space(nx * ny, nx * ny));
+      for(size_t y = 0; y < ny; ++y)
+      for(size_t x = 0; x < nx; ++x) {
+         const size_t v = x + nx * y;
+         if(x + 1 < nx) {
+            addEdge(gm, v, v + 1, (region[v] == region[v + 1] ? 1.0 : -1.0) + noise * (2.0 * uniform() - 1.0));
+         }
+         if(y + 1 < ny) {
+            addEdge(gm, v, v + nx, (region[v] == region[v + nx] ? 1.0 : -1.0) + noise * (2.0 * uniform() - 1.0));
+         }
+      }
+      runAll(gm, "image partition");
+   }
+   return 0;
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/fusion_based_inf.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 30; // width of the grid
+const size_t ny = 30; // height of the grid
+const size_t numberOfLabels = 16;
+const size_t blockSize = 6; // the ground truth is constant on blocks
+const double noise = 0.5; // fraction of noisy observations
+const double lambda = 0.6; // strong coupling compared to the unaries in {0,1}
+const size_t numberOfIterations = 40;
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double> , PottsFunction<double> ) , Space> Model;
+
+struct Protocol {
+   string name;
+   vector<double> times;
+   vector<double> values;
+};
+
+inline size_t variableIndex(const size_t x, const size_t y) {
+   return x + nx * y;
+}
+
+template<class GEN>
+Protocol run(const Model& gm, const string& name, const typename GEN::Parameter& genParam) {
+   typedef FusionBasedInf<Model, GEN> Inf;
+   typename Inf::Parameter param(genParam);
+   param.numIt_ = numberOfIterations;
+   param.numStopIt_ = numberOfIterations;
+   Inf inf(gm, param);
+   typename Inf::TimingVisitorType visitor(1, 0, false);
+   inf.infer(visitor);
+   Protocol p;
+   p.name = name;
+   p.times = visitor.getTimes();
+   p.values = visitor.getValues();
+   return p;
+}
+
+// compares the time-to-energy of fusion based inference with different
+// proposal generators on a strongly coupled Potts grid (denoising of a
+// piecewise constant labeling)
+int main() {
+   srand(42);
+   // piecewise constant ground truth with noisy observations
+   vector<size_t> blockLabels((nx / blockSize + 1) * (ny / blockSize + 1));
+   for(size_t b = 0; b < blockLabels.size(); ++b) {
+      blockLabels[b] = rand() % numberOfLabels;
+   }
+   Model gm(Space(nx * ny, numberOfLabels));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      size_t observed = blockLabels[x / blockSize + (nx / blockSize + 1) * (y / blockSize)];
+      if(static_cast<double>(rand()) / RAND_MAX < noise) {
+         observed = rand() % numberOfLabels;
+      }
+      const size_t shape[] = {numberOfLabels};
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = (s == observed ? 0.0 : 1.0);
+      }
+      size_t vis[] = {variableIndex(x, y)};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      if(x + 1 < nx) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x + 1, y)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         size_t vis[] = {variableIndex(x, y), variableIndex(x, y + 1)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+   }
+
+   typedef proposal_gen::AlphaExpansionGen<Model, Minimizer> AlphaExpansionGen;
+   typedef proposal_gen::RandomGen<Model, Minimizer> RandomGen;
+   typedef proposal_gen::BeliefGen<Model, Minimizer> BpGen;
+   typedef proposal_gen::BeliefGen<Model, Minimizer, TrbpUpdateRules<Model, Minimizer> > TrbpGen;
+
+   vector<Protocol> protocols;
+   protocols.push_back(run<AlphaExpansionGen>(gm, "alpha-expansion", AlphaExpansionGen::Parameter()));
+   protocols.push_back(run<RandomGen>(gm, "random", RandomGen::Parameter()));
+   protocols.push_back(run<BpGen>(gm, "bp-beliefs", BpGen::Parameter()));
+   TrbpGen::Parameter trwsParam;
+   trwsParam.infParam_.damping_ = 0.0;
+   trwsParam.infParam_.inferSequential_ = true;
+   protocols.push_back(run<TrbpGen>(gm, "trws-beliefs", trwsParam));
+
+   // target energy: within 1% of the best energy found by any generator
+   double best = protocols[0].values.back();
+   for(size_t p = 1; p < protocols.size(); ++p) {
+      best = std::min(best, protocols[p].values.back());
+   }
+   const double target = best + 0.01 * std::abs(best);
+
+   std::cout << "target energy " << target << std::endl;
+   std::cout << setw(18) << "generator" << setw(14) << "final value" << setw(14) << "total [s]"
+             << setw(18) << "time-to-target" << setw(18) << "iter-to-target" << std::endl;
+   for(size_t p = 0; p < protocols.size(); ++p) {
+      const Protocol& pr = protocols[p];
+      size_t hit = pr.values.size();
+      for(size_t i = 0; i < pr.values.size(); ++i) {
+         if(pr.values[i] <= target) {
+            hit = i;
+            break;
+         }
+      }
+      std::cout << setw(18) << pr.name << setw(14) << pr.values.back() << setw(14) << pr.times.back();
+      if(hit < pr.values.size()) {
+         std::cout << setw(18) << pr.times[hit] << setw(18) << hit << std::endl;
+      }
+      else {
+         std::cout << setw(18) << "-" << setw(18) << "-" << std::endl;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/reducedinference.hxx>
+#include <opengm/inference/messagepassing/messagepassing.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 200; // width of the image
+const size_t ny = 200; // height of the image
+const size_t numberOfLabels = 4;
+const size_t numberOfRegions = 12; // regions of constant label in the image
+const double noise = 0.35; // fraction of pixels with random data terms
+const double lambda = 0.5; // weight of the Potts terms
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), DiscreteSpace<size_t, size_t> > Model;
+typedef ReducedInferenceHelper<Model>::InfGmType SubModel;
+typedef BeliefPropagationUpdateRules<SubModel, Minimizer> UpdateRules;
+typedef MessagePassing<SubModel, Minimizer, UpdateRules, MaxDistance> SubInference;
+typedef ReducedInference<Model, Minimizer, SubInference> ReducedInferenceType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+void run(const Model& gm, const string& name, const ReducedInferenceType::Parameter& parameter) {
+   ReducedInferenceType inf(gm, parameter);
+   Timer timer;
+   timer.tic();
+   inf.infer();
+   timer.toc();
+   std::cout << setw(32) << name << setw(12) << timer.elapsedTime() << setw(16) << inf.value() << std::endl;
+}
+
+// multi-label Potts segmentation with clean data terms in most of the image,
+// such that most variables are persistent and the remainder splits into
+// many small independent subparts
+int main() {
+   srand(42);
+   std::vector<size_t> centers(2 * numberOfRegions);
+   for(size_t r = 0; r < numberOfRegions; ++r) {
+      centers[2 * r] = rand() % nx;
+      centers[2 * r + 1] = rand() % ny;
+   }
+   const std::vector<size_t> numbersOfLabels(nx * ny, numberOfLabels);
+   Model gm(DiscreteSpace<size_t, size_t>(numbersOfLabels.begin(), numbersOfLabels.end()));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      // label of the nearest region center
+      size_t label = 0;
+      size_t bestDistance = nx * nx + ny * ny;
+      for(size_t r = 0; r < numberOfRegions; ++r) {
+         const size_t dx = x > centers[2 * r] ? x - centers[2 * r] : centers[2 * r] - x;
+         const size_t dy = y > centers[2 * r + 1] ? y - centers[2 * r + 1] : centers[2 * r + 1] - y;
+         if(dx * dx + dy * dy < bestDistance) {
+            bestDistance = dx * dx + dy * dy;
+            label = r % numberOfLabels;
+         }
+      }
+      ExplicitFunction<double> f(shape, shape + 1);
+      const bool noisy = uniform() < noise;
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = noisy ? uniform() : (l == label ? 0.0 : 2.0 + uniform());
+      }
+      const size_t v = x + nx * y;
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+   std::cout << nx * ny << " variables, " << numberOfLabels << " labels, " << gm.numberOfFactors() << " factors" << std::endl;
+   std::cout << setw(32) << "subparts" << setw(12) << "time [s]" << setw(16) << "energy" << std::endl;
+
+   ReducedInferenceType::Parameter parameter;
+   parameter.Persistency_ = true;
+   parameter.ConnectedComponents_ = true;
+   parameter.subParameter_.maximumNumberOfSteps_ = 50;
+
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+      parameter.numberOfThreads_ = numberOfThreads;
+      parameter.maxEnumerationSize_ = 0;
+      std::ostringstream subName;
+      subName << "BP only, " << numberOfThreads << " thr.";
+      run(gm, subName.str(), parameter);
+      parameter.maxEnumerationSize_ = 4;
+      std::ostringstream enumerationName;
+      enumerationName << "enumeration <= 4, " << numberOfThreads << " thr.";
+      run(gm, enumerationName.str(), parameter);
+   }
+   return 0;
+}
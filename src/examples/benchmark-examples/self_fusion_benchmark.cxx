@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/messagepassing/messagepassing.hxx>
+#include <opengm/inference/self_fusion.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t nx = 100; // width of the image
+const size_t ny = 100; // height of the image
+const size_t numberOfLabels = 8; // number of labels
+const double lambda = 0.6; // weight of the Potts terms
+// inference parameters
+const size_t numberOfSteps = 50; // number of iterations of belief propagation
+const size_t numberOfThreads = 4; // number of threads of the pipelined mode
+
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double>, PottsFunction<double>), SimpleDiscreteSpace<size_t, size_t> > Model;
+typedef BeliefPropagationUpdateRules<Model, Minimizer> UpdateRules;
+typedef MessagePassing<Model, Minimizer, UpdateRules, MaxDistance> BPType;
+typedef SelfFusion<BPType> SelfFusionType;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// Potts model on a grid with random data terms
+void buildModel(Model& gm) {
+   gm = Model(SimpleDiscreteSpace<size_t, size_t>(nx * ny, numberOfLabels));
+   const size_t shape[] = {numberOfLabels};
+   for(size_t v = 0; v < nx * ny; ++v) {
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t l = 0; l < numberOfLabels; ++l) {
+         f(l) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   const Model::FunctionIdentifier potts = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < ny; ++y)
+   for(size_t x = 0; x < nx; ++x) {
+      const size_t v = x + nx * y;
+      if(x + 1 < nx) {
+         const size_t vis[] = {v, v + 1};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+      if(y + 1 < ny) {
+         const size_t vis[] = {v, v + nx};
+         gm.addFactor(potts, vis, vis + 2);
+      }
+   }
+}
+
+template<class INF>
+void run(INF& inf, const string& name) {
+   Timer timer;
+   timer.tic();
+   inf.infer();
+   timer.toc();
+   cout << setw(24) << name << setw(12) << timer.elapsedTime() << setw(16) << inf.value() << endl;
+}
+
+// self fusion of belief propagation, fusing inside of the iterations of
+// belief propagation vs. fusing asynchronously on the other threads
+int main() {
+   srand(42);
+   Model gm;
+   buildModel(gm);
+   cout << "grid model: " << gm.numberOfVariables() << " variables, " << gm.numberOfFactors() << " factors" << endl;
+   cout << setw(24) << "method" << setw(12) << "time [s]" << setw(16) << "value" << endl;
+   BPType::Parameter bpParameter(numberOfSteps, 0.0, 0.5);
+   {
+      BPType bp(gm, bpParameter);
+      run(bp, "BP");
+   }
+   for(size_t fusionSolver = 0; fusionSolver < 2; ++fusionSolver) {
+      const SelfFusionType::FusionSolver solver = fusionSolver == 0 ? SelfFusionType::QpboFusion : SelfFusionType::LazyFlipperFusion;
+      const string solverName = fusionSolver == 0 ? "QPBO" : "LF";
+      {
+         SelfFusionType::Parameter parameter(1, solver, bpParameter, 2, false, false, false, 100.0, numberOfSteps);
+         SelfFusionType selfFusion(gm, parameter);
+         run(selfFusion, "self fusion " + solverName);
+      }
+      {
+         SelfFusionType::Parameter parameter(1, solver, bpParameter, 2, false, false, false, 100.0, numberOfSteps, true, numberOfThreads);
+         SelfFusionType selfFusion(gm, parameter);
+         run(selfFusion, "pipelined " + solverName);
+      }
+   }
+   return 0;
+}
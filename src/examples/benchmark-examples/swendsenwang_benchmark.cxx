@@ -0,0 +1,106 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/swendsenwang.hxx>
+#include <opengm/utilities/timer.hxx>
+
+using namespace std; // 'using' is used only in example code
+using namespace opengm;
+
+// model parameters (global variables are used only in example code)
+const size_t gridSizes[] = {16, 256, 1024}; // widths (and heights) of the grids
+const size_t numberOfGridSizes = 3;
+// the generalized sampler computes its edge probabilities from the factors
+// around every edge which is exponential in the number of labels
+const size_t maxSerialGridSize = 16;
+const size_t numberOfLabels = 2;
+const double lambda = 1.0; // coupling strength of the Potts model
+const size_t numberOfSerialSteps = 1000;
+const size_t numberOfSweeps = 20;
+
+typedef SimpleDiscreteSpace<size_t, size_t> Space;
+typedef GraphicalModel<double, Adder, OPENGM_TYPELIST_2(ExplicitFunction<double> , PottsFunction<double> ) , Space> Model;
+typedef SwendsenWang<Model, Minimizer> SwendsenWangType;
+
+void buildGrid(Model& gm, const size_t n) {
+   gm = Model(Space(n * n, numberOfLabels));
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {numberOfLabels};
+      ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   Model::FunctionIdentifier fid = gm.addFunction(PottsFunction<double>(numberOfLabels, numberOfLabels, 0.0, lambda));
+   for(size_t y = 0; y < n; ++y)
+   for(size_t x = 0; x < n; ++x) {
+      if(x + 1 < n) {
+         size_t vis[] = {x + n * y, x + 1 + n * y};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+      if(y + 1 < n) {
+         size_t vis[] = {x + n * y, x + n * (y + 1)};
+         gm.addFactor(fid, vis, vis + 2);
+      }
+   }
+}
+
+void report(const size_t n, const string& sampler, const size_t numberOfThreads,
+            const double time, const size_t numberOfSteps, const double value) {
+   std::cout << setw(10) << n << setw(12) << sampler << setw(10) << numberOfThreads
+             << setw(14) << time << setw(14) << numberOfSteps / time
+             << setw(16) << value << std::endl;
+}
+
+// measures the sampling steps per second of the serial generalized
+// Swendsen-Wang sampler (one cluster per step) and the sweeps per second of
+// the parallel sampler (all clusters per sweep) on Potts grids
+int main() {
+   srand(42);
+   #ifdef WITH_OPENMP
+   const size_t maxNumberOfThreads = omp_get_max_threads();
+   #else
+   const size_t maxNumberOfThreads = 1;
+   #endif
+   std::cout << setw(10) << "grid" << setw(12) << "sampler" << setw(10) << "threads"
+             << setw(14) << "time [s]" << setw(14) << "steps/s" << setw(16) << "best value" << std::endl;
+   for(size_t g = 0; g < numberOfGridSizes; ++g) {
+      const size_t n = gridSizes[g];
+      Model gm;
+      buildGrid(gm, n);
+      Timer timer;
+      if(n <= maxSerialGridSize) {
+         SwendsenWangType::Parameter parameter(numberOfSerialSteps, 0);
+         SwendsenWangType sw(gm, parameter);
+         timer.tic();
+         sw.infer();
+         timer.toc();
+         report(n, "serial", 1, timer.elapsedTime(), numberOfSerialSteps, sw.currentBestValue());
+      }
+      for(size_t numberOfThreads = 1; numberOfThreads <= maxNumberOfThreads; numberOfThreads *= 2) {
+         SwendsenWangType::Parameter parameter(numberOfSweeps, 0);
+         parameter.parallel_ = true;
+         parameter.numberOfThreads_ = numberOfThreads;
+         SwendsenWangType sw(gm, parameter);
+         timer.tic();
+         sw.infer();
+         timer.toc();
+         report(n, "parallel", numberOfThreads, timer.elapsedTime(), numberOfSweeps, sw.currentBestValue());
+      }
+   }
+   return 0;
+}
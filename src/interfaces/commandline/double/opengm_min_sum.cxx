@@ -42,9 +42,7 @@
 #include "../../common/caller/qpbo_caller.hxx"
 #endif
 
-#if (defined(WITH_MAXFLOW) )
 #include "../../common/caller/lsatr_caller.hxx"
-#endif
 
 #ifdef WITH_QPBO
 #include "../../common/caller/mqpbo_caller.hxx"
@@ -118,9 +116,7 @@
 #endif
 
 
-#if defined(WITH_QPBO) || defined(WITH_CPLEX) || defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY)
 #include "../../common/caller/cgc_caller.hxx"
-#endif
 
 
 
@@ -248,9 +244,7 @@ int main(int argc, char** argv) {
       interface::LPGurobiCaller<InterfaceType, GmType, AccumulatorType>,
       interface::LPGurobi2Caller<InterfaceType, GmType, AccumulatorType>,
 #endif
-#ifdef WITH_MAXFLOW
       interface::LSA_TRCaller<InterfaceType, GmType, AccumulatorType>,
-#endif
 
 #ifdef WITH_DAOOPT
       interface::DAOOPTCaller<InterfaceType, GmType, AccumulatorType>,
@@ -261,9 +255,7 @@ int main(int argc, char** argv) {
 #endif
 
 
-#if defined(WITH_QPBO) || defined(WITH_CPLEX) || defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY)
       interface::CgcCaller<InterfaceType, GmType, AccumulatorType>,
-#endif      
 #if  defined(WITH_VIGRA) && ( defined(WITH_QPBO) || defined(WITH_CPLEX) || defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY) )
       interface::IntersectionBasedCaller<InterfaceType, GmType, AccumulatorType>,
 #endif      
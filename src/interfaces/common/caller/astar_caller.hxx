@@ -37,7 +37,7 @@ protected:
 template <class IO, class GM, class ACC>
 inline AStarCaller<IO, GM, ACC>::AStarCaller(IO& ioIn)
    : BaseClass(name_, "detailed description of AStar caller...", ioIn) {
-   addArgument(Size_TArgument<>(astarParameter_.maxHeapSize_, "", "maxheapsize", "maximum size of the heap", astarParameter_.maxHeapSize_));
+   addArgument(Size_TArgument<>(astarParameter_.maxHeapSize_, "", "maxheapsize", "maximum number of search nodes in memory", astarParameter_.maxHeapSize_));
    addArgument(Size_TArgument<>(astarParameter_.numberOfOpt_, "", "numopt", "number of optimizations", astarParameter_.numberOfOpt_));
    addArgument(ArgumentBase<typename A_Star::ValueType>(astarParameter_.objectiveBound_, "", "objectivebound", "boundary for the objective", astarParameter_.objectiveBound_));
    std::vector<std::string> possibleHeuristics;
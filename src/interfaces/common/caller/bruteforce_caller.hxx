@@ -37,7 +37,7 @@ protected:
 template <class IO, class GM, class ACC>
 inline BruteforceCaller<IO, GM, ACC>::BruteforceCaller(IO& ioIn)
    : BaseClass("Bruteforce", "detailed description of Bruteforce Parser...", ioIn){
-
+   addArgument(Size_TArgument<>(bruteforceParameter_.numberOfThreads_, "", "numberOfThreads", "number of threads (0: OpenMP default)", bruteforceParameter_.numberOfThreads_));
 }
 
 template <class IO, class GM, class ACC>
@@ -51,6 +51,9 @@ inline CgcCaller<IO, GM, ACC>::CgcCaller(IO& ioIn)
    addArgument(BoolArgument(param_.planar_, 
       "", "planar", "is model planar"));
 
+   addArgument(BoolArgument(param_.planarFallback_, 
+      "", "planarFallback", "solve planar submodels by QPBO-I without the external planar max-cut"));
+
 
    addArgument(BoolArgument(param_.useBookkeeping_, 
       "ub", "useBookkeeping", "use useBookkeeping ?"));
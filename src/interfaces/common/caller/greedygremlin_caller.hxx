@@ -36,6 +36,7 @@ protected:
 template <class IO, class GM, class ACC>
 inline GreedyGremlinCaller<IO, GM, ACC>::GreedyGremlinCaller(IO& ioIn)
    : BaseClass(name_, "detailed description of GreedyGremlin caller...", ioIn) {
+   addArgument(BoolArgument(ggParameter_.priorityQueue_, "", "priorityQueue", "Fix the variable with the most certain label next instead of breadth-first order"));
 }
 
 template <class IO, class GM, class ACC>
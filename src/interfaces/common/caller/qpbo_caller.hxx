@@ -46,24 +46,26 @@ protected:
    void runImplHelper(GM& model, OutputBase& output, const bool verbose);
    template <class QPBO>
    void runFinal(GM& model, OutputBase& output, const typename QPBO::Parameter& param, const bool verbose);
+   bool noStrongPersistency;
+   bool useProbeing;
+   bool useImproveing;
+   std::vector<size_t> label;
 #ifdef WITH_QPBO
    bool externQPBO_;
    typedef opengm::external::QPBO<GM>  QPBO_EXTERN;
    typename QPBO_EXTERN::Parameter qpbo_externparameter;
-   bool noStrongPersistency;
-
 #endif
 };
 
 template <class IO, class GM, class ACC>
 inline QPBOCaller<IO, GM, ACC>::QPBOCaller(IO& ioIn)
    : BaseClass(ioIn, name_, "detailed description of QPBO caller...") {
+   addArgument(BoolArgument(noStrongPersistency, "", "nostrong", "Don't use strong persistency (compute weak persistencies)"));
+   addArgument(BoolArgument(useImproveing, "", "improve", "Use improving (QPBO-I)"));
+   addArgument(BoolArgument(useProbeing, "", "probe", "Use probing (QPBO-P)"));
+   addArgument(VectorArgument<std::vector<size_t> >(label, "", "label", "location of the file containing the initial configuration for improving"));
 #ifdef WITH_QPBO
-   addArgument(BoolArgument(externQPBO_, "", "extern", "Use extern QPBO. If extern QPBO is used only the arguments labeled for use with extern QPBO are considered."));
-   addArgument(BoolArgument(qpbo_externparameter.strongPersistency_, "", "nostrong", "For use with extern QPBO: don't use strong persistency"));
-   //addArgument(BoolArgument(qpbo_externparameter.useImproveing_, "", "improve", "For use with extern QPBO: use improving"));
-   //addArgument(BoolArgument(qpbo_externparameter.useProbeing_, "", "probe", "For use with extern QPBO: use probing"));
-   addArgument(VectorArgument<std::vector<size_t> >(qpbo_externparameter.label_, "", "label", "For use with extern QPBO: location of the file containing the initial configuration for improving"));
+   addArgument(BoolArgument(externQPBO_, "", "extern", "Use extern QPBO."));
 #endif
    //TODO remove scale argument which comes from GraphCutCaller but is unnecessary here
 }
@@ -79,11 +81,18 @@ void QPBOCaller<IO, GM, ACC>::runImplHelper(GM& model, OutputBase& output, const
 #ifdef WITH_QPBO
    if(externQPBO_) {
       qpbo_externparameter.strongPersistency_ = !noStrongPersistency;
+      qpbo_externparameter.useProbeing_ = useProbeing;
+      qpbo_externparameter.useImproveing_ = useImproveing;
+      qpbo_externparameter.label_ = label;
       runFinal<QPBO_EXTERN>(model, output, qpbo_externparameter, verbose);
    } else {
 #endif
    typedef QPBO<GM, MINSTCUT> QPBO;
    typename QPBO::Parameter qpboparameter;
+   qpboparameter.strongPersistency_ = !noStrongPersistency;
+   qpboparameter.useProbeing_ = useProbeing;
+   qpboparameter.useImproveing_ = useImproveing;
+   qpboparameter.label_ = label;
    runFinal<QPBO>(model, output, qpboparameter, verbose);
 #ifdef WITH_QPBO
    }
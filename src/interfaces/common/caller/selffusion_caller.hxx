@@ -38,6 +38,7 @@ protected:
    size_t maxSubgraphSize_;
    double lbpDamping_;
    bool reducedInf_,connectedComponents_,tentacles_;
+   bool pipelined_;
    
 public:
    const static std::string name_;
@@ -72,6 +73,7 @@ inline  SelfFusionCaller<IO, GM, ACC>::SelfFusionCaller(IO& ioIn)
    addArgument(BoolArgument(reducedInf_,"","reducedInf", "use reduced inference"));
    addArgument(BoolArgument(connectedComponents_,"","connectedComponents", "use reduced inference connectedComponents"));
    addArgument(BoolArgument(tentacles_,"","tentacles", "use reduced inference tentacles"));
+   addArgument(BoolArgument(pipelined_,"","pipelined", "fuse asynchronously while the proposal inference keeps iterating, uses the given number of threads"));
 }
 
 template <class IO, class GM, class ACC>
@@ -104,6 +106,8 @@ inline void SelfFusionCaller<IO, GM, ACC>::runImpl(GM& model, OutputBase& output
       para_.reducedInf_ = reducedInf_;
       para_.connectedComponents_ = connectedComponents_;
       para_.tentacles_ = tentacles_;
+      para_.pipelined_ = pipelined_;
+      para_.numberOfThreads_ = numberOfThreads_;
 
       this-> template infer<INF, TimingVisitorType, typename INF::Parameter>(model, output, verbose, para_);
    } 
@@ -126,6 +130,8 @@ inline void SelfFusionCaller<IO, GM, ACC>::runImpl(GM& model, OutputBase& output
       para_.reducedInf_ = reducedInf_;
       para_.connectedComponents_ = connectedComponents_;
       para_.tentacles_ = tentacles_;
+      para_.pipelined_ = pipelined_;
+      para_.numberOfThreads_ = numberOfThreads_;
 
 
       if(selectedEnergyType_ == "VIEW") {
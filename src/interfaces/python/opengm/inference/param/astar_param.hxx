@@ -59,7 +59,7 @@ public:
          "  A good bound will speedup inference"
          )
          .def_readwrite("maxHeapSize", &Parameter::maxHeapSize_,
-         "Maximum size of the heap which is used while inference"
+         "Maximum number of search nodes which are kept in memory while inference"
          )
          .def_readwrite("numberOfOpt", &Parameter::numberOfOpt_,
          "Select which n best states should be searched for while inference:"
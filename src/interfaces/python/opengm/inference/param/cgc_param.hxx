@@ -45,6 +45,8 @@ public:
       .def_readwrite("startFromThreshold", &Parameter::startFromThreshold_, "start from threshold")
       .def_readwrite("doCutMove", &Parameter::doCutMove_, "do  the cut move")
       .def_readwrite("doGlueCutMove", &Parameter::doGlueCutMove_, "do  the glue and cut move")
+      .def_readwrite("numberOfThreads", &Parameter::numberOfThreads_, "threads of the cut and glue moves (0: OpenMP default)")
+      .def_readwrite("planarFallback", &Parameter::planarFallback_, "solve planar submodels by enumeration and QPBO-I without the external planar max-cut")
 
       .def ("set", &SelfType::set, 
          (
@@ -1,5 +1,7 @@
 
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
 #include <opengm/opengm.hxx>
 
 #include <opengm/operations/adder.hxx>
@@ -16,6 +18,87 @@
 #include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
 #include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
 
+// the memory-bounded search must find the same N-best solutions as an
+// exhaustive enumeration, even if only few search nodes fit into memory
+void memoryBoundedTest() {
+   typedef opengm::GraphicalModel<double, opengm::Adder > GraphicalModelType;
+   typedef opengm::AStar<GraphicalModelType, opengm::Minimizer> ASTAR;
+   const size_t numberOfVariables = 9;
+   const size_t numberOfLabels = 3;
+   const size_t numberOfOpt = 3;
+
+   srand(0);
+   GraphicalModelType gm(opengm::DiscreteSpace<size_t, size_t>(numberOfVariables, numberOfLabels));
+   for(size_t v = 0; v < numberOfVariables; ++v) {
+      const size_t shape[] = {numberOfLabels};
+      opengm::ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t s = 0; s < numberOfLabels; ++s) {
+         f(s) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v};
+      gm.addFactor(gm.addFunction(f), vis, vis + 1);
+   }
+   for(size_t v = 0; v < numberOfVariables; ++v)
+   for(size_t w = v + 1; w < numberOfVariables; ++w) {
+      const size_t shape[] = {numberOfLabels, numberOfLabels};
+      opengm::ExplicitFunction<double> f(shape, shape + 2);
+      for(size_t s = 0; s < numberOfLabels; ++s)
+      for(size_t t = 0; t < numberOfLabels; ++t) {
+         f(s, t) = static_cast<double>(rand()) / RAND_MAX;
+      }
+      size_t vis[] = {v, w};
+      gm.addFactor(gm.addFunction(f), vis, vis + 2);
+   }
+
+   // exhaustive enumeration
+   std::vector<double> values;
+   std::vector<size_t> labeling(numberOfVariables, 0);
+   for(;;) {
+      values.push_back(gm.evaluate(labeling.begin()));
+      size_t v = 0;
+      while(v < numberOfVariables && ++labeling[v] == numberOfLabels) {
+         labeling[v++] = 0;
+      }
+      if(v == numberOfVariables) {
+         break;
+      }
+   }
+   std::sort(values.begin(), values.end());
+
+   const size_t heapSizes[] = {3000000, 200, 40};
+   for(size_t h = 0; h < 3; ++h) {
+      ASTAR::Parameter para;
+      para.heuristic_ = para.FASTHEURISTIC;
+      para.numberOfOpt_ = numberOfOpt;
+      para.maxHeapSize_ = heapSizes[h];
+      ASTAR astar(gm, para);
+      OPENGM_TEST(astar.infer() == opengm::NORMAL);
+      OPENGM_TEST(astar.optimal());
+      OPENGM_TEST(astar.numberOfNodes() <= heapSizes[h]);
+      std::vector<std::vector<size_t> > solutions;
+      astar.args(solutions);
+      OPENGM_TEST_EQUAL(solutions.size(), numberOfOpt);
+      for(size_t n = 0; n < numberOfOpt; ++n) {
+         OPENGM_TEST_EQUAL_TOLERANCE(gm.evaluate(solutions[n].begin()), values[n], 1e-8);
+      }
+   }
+
+   // a budget which cannot hold a single path of the search tree
+   {
+      ASTAR::Parameter para;
+      para.maxHeapSize_ = 10;
+      ASTAR astar(gm, para);
+      bool thrown = false;
+      try {
+         astar.infer();
+      }
+      catch(opengm::RuntimeError&) {
+         thrown = true;
+      }
+      OPENGM_TEST(thrown);
+   }
+}
+
 int main() {
    {
       typedef opengm::GraphicalModel<double, opengm::Adder > SumGmType;
@@ -129,6 +212,11 @@ int main() {
          prodTester.test<ASTAR>(para);
          std::cout << " OK!"<<std::endl;
        }
+       {
+         std::cout << "  * Minimization/Adder with bounded memory ..."<<std::endl;
+         memoryBoundedTest();
+         std::cout << " OK!"<<std::endl;
+       }
        std::cout << "done!"<<std::endl;
    }
 }
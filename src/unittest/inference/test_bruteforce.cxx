@@ -1,8 +1,12 @@
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
 
 #include <opengm/unittests/test.hxx>
 #include <opengm/graphicalmodel/graphicalmodel.hxx>
 #include <opengm/operations/multiplier.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/integrator.hxx>
 #include <opengm/inference/bruteforce.hxx>
 
 template<class T>
@@ -58,11 +62,91 @@ struct BruteforceTest
     }
 };
 
+// compares the Gray code enumeration (top-k, several threads) to a plain
+// enumeration of all labelings
+struct EnumerationTest
+{
+    typedef opengm::GraphicalModel<double, opengm::Adder> GraphicalModelType;
+    typedef opengm::GraphicalModel<double, opengm::Multiplier> ProductModelType;
+    typedef opengm::ExplicitFunction<double> ExplicitFunctionType;
+
+    template<class GM>
+    static GM model()
+    {
+        srand(1);
+        const size_t numberOfLabels[] = {2, 3, 4, 2, 3, 2};
+        const size_t numberOfVariables = 6;
+        GM gm(opengm::DiscreteSpace<size_t, size_t>(numberOfLabels, numberOfLabels + numberOfVariables));
+        const size_t factors[][3] = {{0, 0, 0}, {2, 2, 2}, {0, 1, 1}, {1, 2, 3}, {3, 4, 4}, {0, 4, 5}, {2, 5, 5}};
+        const size_t orders[] = {1, 1, 2, 3, 2, 3, 2};
+        for(size_t i = 0; i < 7; ++i) {
+            size_t shape[3];
+            for(size_t j = 0; j < orders[i]; ++j) {
+                shape[j] = numberOfLabels[factors[i][j]];
+            }
+            ExplicitFunctionType f(shape, shape + orders[i]);
+            for(size_t k = 0; k < f.size(); ++k) {
+                // few distinct values such that ties occur
+                f(k) = 0.5 + (rand() % 4) * 0.25;
+            }
+            gm.addFactor(gm.addFunction(f), factors[i], factors[i] + orders[i]);
+        }
+        return gm;
+    }
+
+    void run()
+    {
+        typedef opengm::Bruteforce<GraphicalModelType, opengm::Minimizer> Bruteforce;
+        const GraphicalModelType gm = model<GraphicalModelType>();
+        // all labelings in lexicographic order, sorted by value (stable)
+        std::vector<std::pair<double, std::vector<size_t> > > labelings;
+        std::vector<size_t> labels(gm.numberOfVariables(), 0);
+        for(;;) {
+            labelings.push_back(std::make_pair(gm.evaluate(labels.begin()), labels));
+            size_t v = gm.numberOfVariables();
+            while(v > 0 && ++labels[v - 1] == gm.numberOfLabels(v - 1)) {
+                labels[v - 1] = 0;
+                --v;
+            }
+            if(v == 0) {
+                break;
+            }
+        }
+        std::sort(labelings.begin(), labelings.end());
+
+        const size_t numberOfBest = 7;
+        for(size_t numberOfThreads = 1; numberOfThreads <= 3; ++numberOfThreads) {
+            Bruteforce bruteforce(gm, Bruteforce::Parameter(numberOfBest, numberOfThreads));
+            OPENGM_TEST(bruteforce.infer() == opengm::NORMAL);
+            OPENGM_TEST(bruteforce.numberOfConfigurations() == labelings.size());
+            OPENGM_TEST_EQUAL_TOLERANCE(bruteforce.value(), labelings[0].first, 1e-10);
+            std::vector<size_t> sol;
+            for(size_t n = 1; n <= numberOfBest; ++n) {
+                OPENGM_TEST(bruteforce.arg(sol, n) == opengm::NORMAL);
+                OPENGM_TEST(sol == labelings[n - 1].second);
+                OPENGM_TEST_EQUAL_TOLERANCE(gm.evaluate(sol.begin()), labelings[n - 1].first, 1e-10);
+            }
+            OPENGM_TEST(bruteforce.arg(sol, numberOfBest + 1) == opengm::UNKNOWN);
+        }
+
+        // partition function
+        const ProductModelType pgm = model<ProductModelType>();
+        double z = 0.0;
+        for(size_t i = 0; i < labelings.size(); ++i) {
+            z += pgm.evaluate(labelings[i].second.begin());
+        }
+        opengm::Bruteforce<ProductModelType, opengm::Integrator> integrator(pgm);
+        OPENGM_TEST(integrator.infer() == opengm::NORMAL);
+        OPENGM_TEST_EQUAL_TOLERANCE(integrator.value(), z, 1e-8 * z);
+    }
+};
+
 int main() {
    std::cout << "Bruteforce Tests ..." << std::endl;
    {
       {BruteforceTest<float> t; t.run();}
       {BruteforceTest<double> t; t.run();}
+      {EnumerationTest t; t.run();}
    }
    return 0;
 }
@@ -51,12 +51,14 @@ struct CGCTest
    
       typedef opengm::CGC<GmType, ACC> CGC;
       typename CGC::Parameter para;
+      para.planarFallback_=true;
       tester.template test<CGC>(para); 
       para.planar_=true;
       tester.template test<CGC>(para); 
 
       typedef opengm::CGC<GmType2, ACC> CGC2;
       typename CGC2::Parameter para2;
+      para2.planarFallback_=true;
       tester2.template test<CGC2>(para2); 
       para2.planar_=true;
       tester2.template test<CGC2>(para2); 
@@ -104,6 +106,7 @@ struct CGCTest
      typedef opengm::Bruteforce<Model, opengm::Minimizer> BF;
      typename CGC::Parameter para;
      para.planar_=true;
+     para.planarFallback_=true;
 
      CGC cgc(gm,para);
      cgc.infer();
@@ -117,6 +120,75 @@ struct CGCTest
      OPENGM_TEST(gm.evaluate(l) ==  gm.evaluate(l2));
   }  
 
+  // the cut and glue moves give the same partition for any number of threads
+  void testThreads(){
+     typedef double                                                                 ValueType;
+     typedef size_t                                                                 IndexType;
+     typedef size_t                                                                 LabelType;
+     typedef opengm::PottsFunction<ValueType,IndexType,LabelType>                   PottsFunction;
+     typedef opengm::DiscreteSpace<IndexType, LabelType>                            SpaceType;
+     typedef opengm::GraphicalModel<ValueType,opengm::Adder,PottsFunction,SpaceType> Model;
+
+     srand(7);
+     const IndexType N = 20;
+     const IndexType M = 20;
+     const LabelType numLabel = N*M;
+     std::vector<LabelType> numbersOfLabels(N*M,numLabel);
+     Model gm(SpaceType(numbersOfLabels.begin(), numbersOfLabels.end()));
+     IndexType vars[]  = {0,1};
+     for(IndexType n=0; n<N;++n){
+        for(IndexType m=0; m<M;++m){
+           vars[0] = n + m*N;
+           if(n+1<N){
+              vars[1] =  (n+1) + (m  )*N;
+              PottsFunction potts(numLabel, numLabel, 0.0, (rand()%200) - 80.0);
+              gm.addFactor( gm.addFunction(potts), vars, vars + 2);
+           }
+           if(m+1<M){
+              vars[1] =  (n  ) + (m+1)*N;
+              PottsFunction potts(numLabel, numLabel, 0.0, (rand()%200) - 80.0);
+              gm.addFactor( gm.addFunction(potts), vars, vars + 2);
+           }
+        }
+     }
+
+     typedef opengm::CGC<Model, opengm::Minimizer> CGC;
+     for(size_t planar=0; planar<2; ++planar){
+        typename CGC::Parameter para;
+        para.planar_ = planar==1;
+        para.planarFallback_ = true;
+        para.numberOfThreads_ = 1;
+        CGC cgc1(gm,para);
+        cgc1.infer();
+        std::vector<LabelType> l1;
+        cgc1.arg(l1);
+
+        para.numberOfThreads_ = 0;
+        CGC cgc2(gm,para);
+        cgc2.infer();
+        std::vector<LabelType> l2;
+        cgc2.arg(l2);
+
+        OPENGM_TEST_EQUAL_TOLERANCE(cgc1.value(), gm.evaluate(l1), 1e-6);
+        OPENGM_TEST_EQUAL_TOLERANCE(cgc2.value(), gm.evaluate(l2), 1e-6);
+        OPENGM_TEST(l1 == l2);
+     }
+
+#if !(defined(WITH_BLOSSOM5) && defined(WITH_PLANARITY))
+     // without the external planar max-cut, planar_ requires planarFallback_
+     typename CGC::Parameter para;
+     para.planar_ = true;
+     bool rejected = false;
+     try{
+        CGC cgc(gm,para);
+     }
+     catch(const opengm::RuntimeError&){
+        rejected = true;
+     }
+     OPENGM_TEST(rejected);
+#endif
+  }
+
   void run(){
     std::cout <<std::endl;  
     std::cout << "  * Start Black-Box Tests for Min-Sum (CGC)..."<<std::endl;
@@ -125,6 +197,8 @@ struct CGCTest
     for(size_t i=0; i<20; ++i){
        testSmall();
     } 
+    std::cout << "  * Start tests of the parallel cut and glue moves..."<<std::endl;
+    testThreads();
     std::cout << "PASS!"<<std::endl;
   }
 };
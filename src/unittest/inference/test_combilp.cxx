@@ -14,6 +14,9 @@
 #include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
 
 #include <opengm/inference/trws/trws_trws.hxx>
+#include <opengm/inference/astar.hxx>
+#include <opengm/inference/bruteforce.hxx>
+#include <opengm/inference/junctiontree.hxx>
 #include <opengm/inference/combilp.hxx>
 
 int main() {
@@ -58,6 +61,36 @@ int main() {
 	   minTester.test<CombiLPType>(param);
    }
 
+   {
+	   typedef opengm::TRWSi<GraphicalModelType,opengm::Minimizer> TRWSiSolverType;
+	   typedef opengm::JunctionTree<GraphicalModelType,opengm::Minimizer> ILPSolverType;
+	   typedef opengm::CombiLP<GraphicalModelType,opengm::Minimizer,TRWSiSolverType,ILPSolverType> CombiLPType;
+	   CombiLPType::Parameter param;
+	   param.lpsolverParameter_.maxNumberOfIterations_=100;
+	   param.ilpsolverParameter_.computeMarginals_=false;
+	   minTester.test<CombiLPType>(param);
+	   param.numberOfThreads_=2;
+	   minTester.test<CombiLPType>(param);
+   }
+
+   {
+	   typedef opengm::TRWSi<GraphicalModelType,opengm::Minimizer> TRWSiSolverType;
+	   typedef opengm::AStar<GraphicalModelType,opengm::Minimizer> ILPSolverType;
+	   typedef opengm::CombiLP<GraphicalModelType,opengm::Minimizer,TRWSiSolverType,ILPSolverType> CombiLPType;
+	   CombiLPType::Parameter param;
+	   param.lpsolverParameter_.maxNumberOfIterations_=100;
+	   minTester.test<CombiLPType>(param);
+   }
+
+   {
+	   typedef opengm::TRWSi<GraphicalModelType,opengm::Minimizer> TRWSiSolverType;
+	   typedef opengm::Bruteforce<GraphicalModelType,opengm::Minimizer> ILPSolverType;
+	   typedef opengm::CombiLP<GraphicalModelType,opengm::Minimizer,TRWSiSolverType,ILPSolverType> CombiLPType;
+	   CombiLPType::Parameter param;
+	   param.lpsolverParameter_.maxNumberOfIterations_=100;
+	   minTester.test<CombiLPType>(param);
+   }
+
 //   {
 //	   typedef opengm::TRWSi<GraphicalModelType2,opengm::Minimizer> TRWSiSolverType;
 //	   typedef opengm::CombiLP<GraphicalModelType2,opengm::Minimizer,TRWSiSolverType> CombiLPType;
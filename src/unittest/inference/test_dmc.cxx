@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <vector>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/bruteforce.hxx>
+#include <opengm/inference/multicut-heuristic.hxx>
+#include <opengm/inference/dmc.hxx>
+
+typedef opengm::SimpleDiscreteSpace<size_t, size_t> Space;
+typedef opengm::GraphicalModel<double, opengm::Adder, opengm::PottsFunction<double>, Space> Model;
+typedef opengm::Bruteforce<Model, opengm::Minimizer> Bruteforce;
+typedef opengm::MulticutHeuristic<Model, opengm::Minimizer> MulticutHeuristic;
+typedef opengm::DMC<Model, Bruteforce> BruteforceDMC;
+typedef opengm::DMC<Model, MulticutHeuristic> HeuristicDMC;
+
+const size_t numberOfGroups = 4;
+const size_t groupSize = 4;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+// groups of variables with mostly attractive edges, connected by repulsive
+// edges, i.e. the groups are the components of the decomposition
+void buildModel(Model& gm, std::vector<Model::FunctionIdentifier>& intraGroup) {
+   const size_t n = numberOfGroups * groupSize;
+   gm = Model(Space(n, n));
+   intraGroup.clear();
+   for(size_t i = 0; i < n; ++i)
+   for(size_t j = i + 1; j < n; ++j) {
+      const bool sameGroup = i / groupSize == j / groupSize;
+      if(!sameGroup && rand() % 4 != 0) {
+         continue;
+      }
+      const double weight = sameGroup ? 2.0 * uniform() - 0.5 : -uniform() - 0.1;
+      const Model::FunctionIdentifier fid = gm.addFunction(opengm::PottsFunction<double>(n, n, 0.0, weight));
+      const size_t vis[] = {i, j};
+      gm.addFactor(fid, vis, vis + 2);
+      if(sameGroup) {
+         intraGroup.push_back(fid);
+      }
+   }
+}
+
+double& weight(Model& gm, const Model::FunctionIdentifier& fid) {
+   return gm.getFunction<opengm::PottsFunction<double> >(fid).parameter(1);
+}
+
+template<class DMC>
+double fresh(const Model& gm) {
+   DMC dmc(gm, typename DMC::Parameter());
+   OPENGM_TEST(dmc.infer() == opengm::NORMAL);
+   return dmc.value();
+}
+
+// repeated inference after changes of the weights agrees with inference on
+// a fresh decomposition and solves only the changed components again
+void incrementalTest() {
+   srand(0);
+   for(size_t test = 0; test < 5; ++test) {
+      Model gm;
+      std::vector<Model::FunctionIdentifier> intraGroup;
+      buildModel(gm, intraGroup);
+      BruteforceDMC dmc(gm, BruteforceDMC::Parameter());
+      BruteforceDMC::TimingVisitorType visitor(1, 0, false);
+      OPENGM_TEST(dmc.infer(visitor) == opengm::NORMAL);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), fresh<BruteforceDMC>(gm), 1e-8);
+      OPENGM_TEST_EQUAL(visitor.protocolMap().find("solvedComponents")->second.back(), numberOfGroups);
+
+      // change the weight of an edge of one group, keeping its sign
+      double& w = weight(gm, intraGroup[0]);
+      w = w > 0 ? w + 1.0 : w - 1.0;
+      BruteforceDMC::TimingVisitorType visitor2(1, 0, false);
+      OPENGM_TEST(dmc.infer(visitor2) == opengm::NORMAL);
+      std::vector<size_t> labels;
+      OPENGM_TEST(dmc.arg(labels) == opengm::NORMAL);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), gm.evaluate(labels.begin()), 1e-8);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), fresh<BruteforceDMC>(gm), 1e-8);
+      OPENGM_TEST_EQUAL(visitor2.protocolMap().find("solvedComponents")->second.back(), 1);
+
+      // nothing changed
+      BruteforceDMC::TimingVisitorType visitor3(1, 0, false);
+      OPENGM_TEST(dmc.infer(visitor3) == opengm::NORMAL);
+      OPENGM_TEST_EQUAL(visitor3.protocolMap().find("solvedComponents")->second.back(), 0);
+
+      // change the sign of an edge, which changes the decomposition
+      double& w2 = weight(gm, intraGroup[intraGroup.size() - 1]);
+      w2 = -w2 - 0.1;
+      OPENGM_TEST(dmc.infer() == opengm::NORMAL);
+      OPENGM_TEST(dmc.arg(labels) == opengm::NORMAL);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), gm.evaluate(labels.begin()), 1e-8);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), fresh<BruteforceDMC>(gm), 1e-8);
+   }
+}
+
+// the heuristic is warm-started from the previous labeling, which does not
+// get worse by the Kernighan-Lin refinement
+void warmStartTest() {
+   srand(1);
+   for(size_t test = 0; test < 5; ++test) {
+      Model gm;
+      std::vector<Model::FunctionIdentifier> intraGroup;
+      buildModel(gm, intraGroup);
+      HeuristicDMC dmc(gm, HeuristicDMC::Parameter());
+      OPENGM_TEST(dmc.infer() == opengm::NORMAL);
+      for(size_t i = 0; i < intraGroup.size(); i += 3) {
+         double& w = weight(gm, intraGroup[i]);
+         w = w > 0 ? w + uniform() : w - uniform();
+      }
+      std::vector<size_t> labels;
+      OPENGM_TEST(dmc.arg(labels) == opengm::NORMAL);
+      const double previous = gm.evaluate(labels.begin());
+      OPENGM_TEST(dmc.infer() == opengm::NORMAL);
+      OPENGM_TEST(dmc.arg(labels) == opengm::NORMAL);
+      OPENGM_TEST_EQUAL_TOLERANCE(dmc.value(), gm.evaluate(labels.begin()), 1e-8);
+      OPENGM_TEST(dmc.value() <= previous + 1e-8);
+   }
+}
+
+int main() {
+   std::cout << "DMC Tests ..." << std::endl;
+   incrementalTest();
+   warmStartTest();
+   std::cout << "done!" << std::endl;
+   return 0;
+}
@@ -173,6 +173,9 @@ int main()
 
     typedef opengm::proposal_gen::AlphaBetaSwapGen<SumGmType, opengm::Minimizer> ABGen;
     typedef opengm::proposal_gen::AlphaBetaSwapGen<SumGmType, opengm::Minimizer> AEGen;
+    typedef opengm::proposal_gen::BeliefGen<SumGmType, opengm::Minimizer> BPGen;
+    typedef opengm::TrbpUpdateRules<SumGmType, opengm::Minimizer> TrbpUpdateRules;
+    typedef opengm::proposal_gen::BeliefGen<SumGmType, opengm::Minimizer, TrbpUpdateRules> TRBPGen;
 
 
     std::cout << "FusionBasedInf AlphaExpansion Tests ..." << std::endl;
@@ -191,6 +194,23 @@ int main()
        sumTester.test<InfType>(para);
        std::cout << " OK!"<<std::endl;
     }
+    std::cout << "FusionBasedInf Belief Propagation Tests ..." << std::endl;
+    {
+       std::cout << "  * Minimization/Adder  ..." << std::endl;
+       typedef opengm::FusionBasedInf<SumGmType, BPGen> InfType;
+       InfType::Parameter para;
+       sumTester.test<InfType>(para);
+       std::cout << " OK!"<<std::endl;
+    }
+    std::cout << "FusionBasedInf Tree-Reweighted Belief Propagation Tests ..." << std::endl;
+    {
+       std::cout << "  * Minimization/Adder  ..." << std::endl;
+       typedef opengm::FusionBasedInf<SumGmType, TRBPGen> InfType;
+       InfType::Parameter para;
+       para.proposalParam_.proposalsPerUpdate_ = 1;
+       sumTester.test<InfType>(para);
+       std::cout << " OK!"<<std::endl;
+    }
 
 
 }
@@ -21,7 +21,8 @@ public:
     typedef opengm::GraphicalModel<double, Operation> GraphicalModel;
     typedef opengm::Gibbs<GraphicalModel, Accumulation> Gibbs;
 
-    GibbsTest();
+    // numberOfChains > 0: chromatic sampling with several chains
+    GibbsTest(const size_t numberOfChains = 0);
     void run();
 
 private:
@@ -45,12 +46,19 @@ private:
 
 template<class OP, class ACC>
 inline
-GibbsTest<OP, ACC>::GibbsTest()
+GibbsTest<OP, ACC>::GibbsTest(const size_t numberOfChains)
 :   numberOfVariables(10),
     numberOfLabels(2),
     parameter(),
     relativeTolerance(0.3)
-{}
+{
+    if(numberOfChains > 0) {
+       parameter.variableProposal_ = Gibbs::Parameter::CHROMATIC;
+       parameter.numberOfChains_ = numberOfChains;
+       parameter.maxNumberOfSamplingSteps_ = 20000;
+       parameter.numberOfBurnInSteps_ = 1000;
+    }
+}
 
 #define VALUE_EQUAL(op,acc,ve,vu) \
     template<> inline double GibbsTest<op, acc>::valueEqual() const { return ve; } \
@@ -174,10 +182,43 @@ void standardTests() {
     }
 }
 
+void chromaticTests() {
+    typedef opengm::GraphicalModel<double, opengm::Adder> SumGmType;
+    typedef opengm::Gibbs<SumGmType, opengm::Minimizer> Gibbs;
+    typedef opengm::BlackBoxTestGrid<SumGmType> SumGridTest;
+
+    std::cout << "Chromatic Gibbs Tests ..." << std::endl;
+    {
+       std::cout << "  * Marginals of several chains..." << std::endl;
+       { GibbsTest<opengm::Multiplier, opengm::Maximizer> test(4); test.run(); }
+       { GibbsTest<opengm::Adder, opengm::Minimizer> test(4); test.run(); }
+       std::cout << " OK!"<<std::endl;
+    }
+    {
+       std::cout << "  * Samples do not depend on the number of threads..." << std::endl;
+       SumGmType gm = SumGridTest(6, 6, 3, false, true, SumGridTest::RANDOM, opengm::PASS, 1).getModel(0);
+       Gibbs::Parameter para(3600, 360);
+       para.variableProposal_ = Gibbs::Parameter::CHROMATIC;
+       para.numberOfChains_ = 3;
+       para.numberOfThreads_ = 1;
+       Gibbs gibbs1(gm, para);
+       gibbs1.infer();
+       para.numberOfThreads_ = 4;
+       Gibbs gibbs2(gm, para);
+       gibbs2.infer();
+       OPENGM_TEST_EQUAL(gibbs1.currentBestValue(), gibbs2.currentBestValue());
+       for(size_t j = 0; j < gm.numberOfVariables(); ++j) {
+          OPENGM_TEST_EQUAL(gibbs1.markovState(j), gibbs2.markovState(j));
+       }
+       std::cout << " OK!"<<std::endl;
+    }
+}
+
 int main() {
     { GibbsTest<opengm::Multiplier, opengm::Maximizer> test; test.run(); }
     { GibbsTest<opengm::Adder, opengm::Minimizer> test; test.run(); }
 
     standardTests();
+    chromaticTests();
     return 0;
 }
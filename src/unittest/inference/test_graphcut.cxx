@@ -15,6 +15,7 @@
 #include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
 #include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
 
+#include <opengm/inference/auxiliary/minstcutbk.hxx>
 #ifdef WITH_BOOST
 #  ifdef NDEBUG
 #    include <opengm/inference/auxiliary/minstcutboost.hxx>
@@ -74,6 +75,17 @@ int main() {
 #endif
 */
 
+   std::cout << "  * Test Min-Sum with Boykov-Kolmogorov" << std::endl;
+   {
+      typedef opengm::MinSTCutBK<size_t, float> MinStCutType;
+      typedef opengm::GraphCut<GraphicalModelType, opengm::Minimizer, MinStCutType> MinGraphCut;
+      MinGraphCut::Parameter para;
+      minTester.test<MinGraphCut>(para);
+      typedef opengm::GraphCut<SumGmType2, opengm::Minimizer, MinStCutType> MinGraphCut2;
+      MinGraphCut2::Parameter para2;
+      minTester2.test<MinGraphCut2>(para2);
+   }
+
 #ifdef WITH_MAXFLOW
    std::cout << "  * Test Min-Sum with Kolmogorov" << std::endl;
    {
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <vector>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/operations/maximizer.hxx>
+#include <opengm/inference/greedygremlin.hxx>
+
+typedef opengm::SimpleDiscreteSpace<size_t, size_t> Space;
+typedef opengm::GraphicalModel<double, opengm::Adder, OPENGM_TYPELIST_2(opengm::ExplicitFunction<double>, opengm::PottsFunction<double>), Space> Model;
+
+inline double uniform() {
+   return static_cast<double>(rand()) / RAND_MAX;
+}
+
+void addUnaries(Model& gm) {
+   for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+      const size_t shape[] = {gm.numberOfLabels(v)};
+      opengm::ExplicitFunction<double> f(shape, shape + 1);
+      for(size_t l = 0; l < shape[0]; ++l) {
+         f(l) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+}
+
+template<class ACC>
+void run(const Model& gm, const bool priorityQueue, std::vector<size_t>& labels) {
+   typedef opengm::GreedyGremlin<Model, ACC> GreedyGremlin;
+   GreedyGremlin gg(gm, typename GreedyGremlin::Parameter(priorityQueue));
+   OPENGM_TEST(gg.infer() == opengm::NORMAL);
+   OPENGM_TEST(gg.arg(labels) == opengm::NORMAL);
+   OPENGM_TEST_EQUAL(labels.size(), gm.numberOfVariables());
+   for(size_t v = 0; v < labels.size(); ++v) {
+      OPENGM_TEST(labels[v] < gm.numberOfLabels(v));
+   }
+   OPENGM_TEST_EQUAL_TOLERANCE(gg.value(), gm.evaluate(labels.begin()), 1e-8);
+}
+
+// without pairwise factors both orders find the optimum, also for variables
+// that are not connected to the first variable
+template<class ACC>
+void unaryTest() {
+   srand(0);
+   Model gm(Space(20, 4));
+   addUnaries(gm);
+   const size_t vis[] = {3, 7};
+   gm.addFactor(gm.addFunction(opengm::PottsFunction<double>(4, 4, 0.0, 0.0)), vis, vis + 2);
+   for(size_t priorityQueue = 0; priorityQueue < 2; ++priorityQueue) {
+      std::vector<size_t> labels;
+      run<ACC>(gm, priorityQueue == 1, labels);
+      for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+         for(size_t l = 0; l < 4; ++l) {
+            OPENGM_TEST(!ACC::bop(gm[v](&l), gm[v](&labels[v])));
+         }
+      }
+   }
+}
+
+// the most certain variable is fixed first and determines its neighbors
+void priorityTest() {
+   Model gm(Space(3, 2));
+   const size_t shape[] = {2};
+   opengm::ExplicitFunction<double> weak(shape, shape + 1);
+   weak(0) = 0.0;
+   weak(1) = 0.1;
+   opengm::ExplicitFunction<double> strong(shape, shape + 1);
+   strong(0) = 5.0;
+   strong(1) = 0.0;
+   const size_t v0 = 0;
+   const size_t v2 = 2;
+   gm.addFactor(gm.addFunction(weak), &v0, &v0 + 1);
+   gm.addFactor(gm.addFunction(strong), &v2, &v2 + 1);
+   const Model::FunctionIdentifier potts = gm.addFunction(opengm::PottsFunction<double>(2, 2, 0.0, 1.0));
+   const size_t vis01[] = {0, 1};
+   const size_t vis12[] = {1, 2};
+   gm.addFactor(potts, vis01, vis01 + 2);
+   gm.addFactor(potts, vis12, vis12 + 2);
+   std::vector<size_t> labels;
+   run<opengm::Minimizer>(gm, true, labels);
+   OPENGM_TEST_EQUAL(labels[0], 1);
+   OPENGM_TEST_EQUAL(labels[1], 1);
+   OPENGM_TEST_EQUAL(labels[2], 1);
+   run<opengm::Minimizer>(gm, false, labels);
+   OPENGM_TEST_EQUAL(labels[0], 0);
+}
+
+// higher order factors on a random model
+void randomTest() {
+   srand(1);
+   Model gm(Space(30, 3));
+   addUnaries(gm);
+   for(size_t i = 0; i < 40; ++i) {
+      size_t vis[] = {static_cast<size_t>(rand() % 10), static_cast<size_t>(10 + rand() % 10), static_cast<size_t>(20 + rand() % 10)};
+      const size_t shape[] = {3, 3, 3};
+      opengm::ExplicitFunction<double> f(shape, shape + 3);
+      for(size_t j = 0; j < f.size(); ++j) {
+         f(j) = uniform();
+      }
+      gm.addFactor(gm.addFunction(f), vis, vis + 3);
+   }
+   std::vector<size_t> labels;
+   run<opengm::Minimizer>(gm, false, labels);
+   run<opengm::Minimizer>(gm, true, labels);
+   run<opengm::Maximizer>(gm, true, labels);
+}
+
+int main() {
+   std::cout << "GreedyGremlin Tests ..." << std::endl;
+   unaryTest<opengm::Minimizer>();
+   unaryTest<opengm::Maximizer>();
+   priorityTest();
+   randomTest();
+   std::cout << "done!" << std::endl;
+   return 0;
+}
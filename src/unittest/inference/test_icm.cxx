@@ -63,7 +63,42 @@ int main() {
       prodTester.test<ICM>(para);
       std::cout << " OK!"<<std::endl;
    }
+   {
+      std::cout << "  * Minimization/Adder  (parallel) ..." << std::endl;
+      typedef opengm::ICM<SumGmType, opengm::Minimizer> ICM;
+      ICM::Parameter para(ICM::SINGLE_VARIABLE, true);
+      sumTester.test<ICM>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      std::cout << "  * Minimization/Adder  (parallel factor moves) ..." << std::endl;
+      typedef opengm::ICM<SumGmType, opengm::Minimizer> ICM;
+      ICM::Parameter para(ICM::FACTOR, true);
+      sumTester.test<ICM>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      std::cout << "  * Maximization/Multiplier  (parallel factor moves) ..." << std::endl;
+      typedef opengm::ICM<ProdGmType, opengm::Maximizer> ICM;
+      ICM::Parameter para(ICM::FACTOR, true);
+      prodTester.test<ICM>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      std::cout << "  * Minimization/Adder  (parallel result is a local optimum) ..." << std::endl;
+      typedef opengm::ICM<SumGmType, opengm::Minimizer> ICM;
+      SumGmType gm = SumGridTest(8, 8, 4, false, true, SumGridTest::RANDOM, opengm::PASS, 1).getModel(0);
+      for(size_t m=0; m<2; ++m) {
+         const ICM::MoveType moveType = m==0 ? ICM::SINGLE_VARIABLE : ICM::FACTOR;
+         ICM chromatic(gm, ICM::Parameter(moveType, true));
+         chromatic.infer();
+         std::vector<SumGmType::LabelType> arg;
+         chromatic.arg(arg);
+         OPENGM_TEST_EQUAL_TOLERANCE(chromatic.value(), gm.evaluate(arg.begin()), 0.00001);
+         ICM sequential(gm, ICM::Parameter(moveType, arg));
+         sequential.infer();
+         OPENGM_TEST_EQUAL_TOLERANCE(chromatic.value(), sequential.value(), 0.00001);
+      }
+      std::cout << " OK!"<<std::endl;
+   }
 }
-
-
-
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <vector>
+#include <cmath>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/multiplier.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/operations/maximizer.hxx>
+#include <opengm/operations/integrator.hxx>
+#include <opengm/inference/junctiontree.hxx>
+
+#include <opengm/unittests/blackboxtester.hxx>
+#include <opengm/unittests/blackboxtests/blackboxtestgrid.hxx>
+#include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
+#include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
+
+// compares the marginals of all variables and factors of a small loopy
+// model with third order factors to exhaustive enumeration
+template<class OP, class ACC>
+void marginalTest(const typename opengm::JunctionTree<opengm::GraphicalModel<double, OP>, ACC>::Heuristic heuristic) {
+   typedef opengm::GraphicalModel<double, OP> GraphicalModelType;
+   typedef typename GraphicalModelType::IndependentFactorType IndependentFactorType;
+   typedef opengm::JunctionTree<GraphicalModelType, ACC> JunctionTreeType;
+   typedef opengm::ExplicitFunction<double> ExplicitFunctionType;
+
+   srand(0);
+   const size_t numberOfVariables = 7;
+   const size_t numbersOfLabels[] = {2, 3, 2, 2, 3, 2, 2};
+   GraphicalModelType gm(opengm::DiscreteSpace<size_t, size_t>(numbersOfLabels, numbersOfLabels + numberOfVariables));
+   const size_t factors[][3] = {
+      {0, 1, 2}, {1, 3, 4}, {2, 4, 5}, {0, 5, 6}, {3, 6, 6}
+   };
+   for(size_t v = 0; v < numberOfVariables; ++v) {
+      ExplicitFunctionType f(numbersOfLabels + v, numbersOfLabels + v + 1);
+      for(size_t s = 0; s < numbersOfLabels[v]; ++s) {
+         f(s) = 0.5 + static_cast<double>(rand()) / RAND_MAX;
+      }
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+   }
+   for(size_t i = 0; i < 5; ++i) {
+      const size_t order = factors[i][1] == factors[i][2] ? 2 : 3;
+      size_t shape[3];
+      for(size_t j = 0; j < order; ++j) {
+         shape[j] = numbersOfLabels[factors[i][j]];
+      }
+      ExplicitFunctionType f(shape, shape + order);
+      for(size_t k = 0; k < f.size(); ++k) {
+         f(k) = 0.5 + static_cast<double>(rand()) / RAND_MAX;
+      }
+      gm.addFactor(gm.addFunction(f), factors[i], factors[i] + order);
+   }
+
+   typename JunctionTreeType::Parameter parameter(heuristic);
+   JunctionTreeType jt(gm, parameter);
+   OPENGM_TEST(jt.infer() == opengm::NORMAL);
+   OPENGM_TEST(jt.treewidth() >= 2);
+
+   // exhaustive enumeration
+   std::vector<IndependentFactorType> marginals(gm.numberOfFactors());
+   for(size_t f = 0; f < gm.numberOfFactors(); ++f) {
+      marginals[f].assign(gm, gm[f].variableIndicesBegin(), gm[f].variableIndicesEnd(), ACC::template neutral<double>());
+   }
+   std::vector<size_t> labels(numberOfVariables, 0);
+   for(;;) {
+      const double value = gm.evaluate(labels.begin());
+      for(size_t f = 0; f < gm.numberOfFactors(); ++f) {
+         std::vector<size_t> factorLabels;
+         for(size_t j = 0; j < gm[f].numberOfVariables(); ++j) {
+            factorLabels.push_back(labels[gm[f].variableIndex(j)]);
+         }
+         ACC::op(value, marginals[f](factorLabels.begin()));
+      }
+      size_t v = 0;
+      for(; v < numberOfVariables; ++v) {
+         if(++labels[v] < numbersOfLabels[v]) {
+            break;
+         }
+         labels[v] = 0;
+      }
+      if(v == numberOfVariables) {
+         break;
+      }
+   }
+
+   IndependentFactorType out;
+   for(size_t f = 0; f < gm.numberOfFactors(); ++f) {
+      opengm::Normalization::normalize<ACC, OP>(marginals[f]);
+      OPENGM_TEST(jt.factorMarginal(f, out) == opengm::NORMAL);
+      OPENGM_TEST(out.numberOfVariables() == gm[f].numberOfVariables());
+      for(size_t k = 0; k < out.size(); ++k) {
+         OPENGM_TEST_EQUAL_TOLERANCE(out(k), marginals[f](k), 1e-8);
+      }
+      if(gm[f].numberOfVariables() == 1) {
+         OPENGM_TEST(jt.marginal(gm[f].variableIndex(0), out) == opengm::NORMAL);
+         for(size_t k = 0; k < out.size(); ++k) {
+            OPENGM_TEST_EQUAL_TOLERANCE(out(k), marginals[f](k), 1e-8);
+         }
+      }
+   }
+}
+
+int main() {
+   typedef opengm::GraphicalModel<double, opengm::Adder> SumGmType;
+   typedef opengm::GraphicalModel<double, opengm::Multiplier> ProdGmType;
+   typedef opengm::BlackBoxTestGrid<SumGmType> SumGridTest;
+   typedef opengm::BlackBoxTestFull<SumGmType> SumFullTest;
+   typedef opengm::BlackBoxTestStar<SumGmType> SumStarTest;
+   typedef opengm::BlackBoxTestGrid<ProdGmType> ProdGridTest;
+   typedef opengm::BlackBoxTestFull<ProdGmType> ProdFullTest;
+   typedef opengm::BlackBoxTestStar<ProdGmType> ProdStarTest;
+
+   opengm::InferenceBlackBoxTester<SumGmType> sumTester;
+   sumTester.addTest(new SumGridTest(4, 4, 2, false, true, SumGridTest::RANDOM, opengm::OPTIMAL, 5));
+   sumTester.addTest(new SumGridTest(3, 5, 3, true, true, SumGridTest::POTTS, opengm::OPTIMAL, 5));
+   sumTester.addTest(new SumStarTest(6, 4, false, true, SumStarTest::RANDOM, opengm::OPTIMAL, 10));
+   sumTester.addTest(new SumStarTest(1000, 10, false, true, SumStarTest::RANDOM, opengm::PASS, 2));
+   sumTester.addTest(new SumFullTest(5, 3, false, 3, SumFullTest::RANDOM, opengm::OPTIMAL, 5));
+
+   opengm::InferenceBlackBoxTester<ProdGmType> prodTester;
+   prodTester.addTest(new ProdGridTest(4, 4, 2, false, true, ProdGridTest::RANDOM, opengm::OPTIMAL, 5));
+   prodTester.addTest(new ProdStarTest(6, 4, false, true, ProdStarTest::RANDOM, opengm::OPTIMAL, 10));
+   prodTester.addTest(new ProdFullTest(5, 3, false, 3, ProdFullTest::RANDOM, opengm::OPTIMAL, 5));
+
+   std::cout << "Junction Tree Tests" << std::endl;
+   {
+      std::cout << "  * Minimization/Adder ..." << std::endl;
+      typedef opengm::JunctionTree<SumGmType, opengm::Minimizer> JT;
+      JT::Parameter para;
+      sumTester.test<JT>(para, true, true, true, true);
+      para.heuristic_ = JT::MIN_DEGREE;
+      sumTester.test<JT>(para);
+      std::cout << " OK!" << std::endl;
+   }
+   {
+      std::cout << "  * Maximizer/Adder ..." << std::endl;
+      typedef opengm::JunctionTree<SumGmType, opengm::Maximizer> JT;
+      JT::Parameter para(JT::MIN_FILL, false);
+      sumTester.test<JT>(para);
+      std::cout << " OK!" << std::endl;
+   }
+   {
+      std::cout << "  * Maximizer/Multiplier ..." << std::endl;
+      typedef opengm::JunctionTree<ProdGmType, opengm::Maximizer> JT;
+      JT::Parameter para;
+      prodTester.test<JT>(para, true, true, true, true);
+      std::cout << " OK!" << std::endl;
+   }
+   {
+      std::cout << "  * Marginals ..." << std::endl;
+      typedef opengm::JunctionTree<ProdGmType, opengm::Integrator> SumProduct;
+      typedef opengm::JunctionTree<SumGmType, opengm::Minimizer> MinSum;
+      marginalTest<opengm::Multiplier, opengm::Integrator>(SumProduct::MIN_FILL);
+      marginalTest<opengm::Multiplier, opengm::Integrator>(SumProduct::MIN_DEGREE);
+      marginalTest<opengm::Adder, opengm::Minimizer>(MinSum::MIN_FILL);
+      std::cout << " OK!" << std::endl;
+   }
+   std::cout << "done!" << std::endl;
+   return 0;
+}
@@ -53,6 +53,24 @@ int main() {
       prodTester.test<LF>(para);
       std::cout << " OK!"<<std::endl;
    }
+   {
+      std::cout << "  * Minimization/Adder  (parallel) ..." << std::endl;
+      typedef opengm::LazyFlipper<SumGmType, opengm::Minimizer> LF;
+      LF::Parameter para;
+      para.parallel_ = true;
+      para.numberOfRegions_ = 2;
+      sumTester.test<LF>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      std::cout << "  * Maximization/Multiplier  (parallel) ..." << std::endl;
+      typedef opengm::LazyFlipper<ProdGmType, opengm::Maximizer> LF;
+      LF::Parameter para;
+      para.parallel_ = true;
+      para.numberOfRegions_ = 2;
+      prodTester.test<LF>(para);
+      std::cout << " OK!"<<std::endl;
+   }
 
    additionalTest();
 }
@@ -92,4 +110,23 @@ void additionalTest() {
 
       OPENGM_TEST_EQUAL(lazyFlipper.value(), model.evaluate(label.begin()));
    }
+
+   // parallel search: the result must be optimal w.r.t. all flips of at
+   // most maxSubgraphSize variables, i.e. a serial search must not improve it
+   for(size_t numberOfRegions=1; numberOfRegions<=8; numberOfRegions*=2) {
+      LazyFlipper::Parameter parameter(size_t(3));
+      parameter.parallel_ = true;
+      parameter.numberOfRegions_ = numberOfRegions;
+      LazyFlipper lazyFlipper(model, parameter);
+      lazyFlipper.infer();
+
+      std::vector<size_t> label;
+      lazyFlipper.arg(label);
+      OPENGM_TEST_EQUAL_TOLERANCE(lazyFlipper.value(), model.evaluate(label.begin()), 0.0001);
+
+      LazyFlipper::Parameter serialParameter(size_t(3), label.begin(), label.end());
+      LazyFlipper serialLazyFlipper(model, serialParameter);
+      serialLazyFlipper.infer();
+      OPENGM_TEST_EQUAL_TOLERANCE(lazyFlipper.value(), serialLazyFlipper.value(), 0.0001);
+   }
 }
@@ -10,12 +10,84 @@
 #include <opengm/operations/maximizer.hxx>
 
 #include <opengm/inference/loc.hxx>
+#include <opengm/unittests/test.hxx>
 
 #include <opengm/unittests/blackboxtester.hxx>
 #include <opengm/unittests/blackboxtests/blackboxtestgrid.hxx>
 #include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
 #include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
 
+// dynamic programming on the views of the pooled optimizer vs.
+// dynamic programming on the merged explicit submodel
+template<class GM>
+void testPooledDynamicProgramming(const GM & gm) {
+   typedef opengm::SubmodelOptimizer<GM, opengm::Minimizer> Optimizer;
+   typedef opengm::PooledSubmodelOptimizer<GM, opengm::Minimizer> PooledOptimizer;
+   Optimizer optimizer(gm);
+   PooledOptimizer pooledOptimizer(gm);
+   std::vector<size_t> labels(gm.numberOfVariables());
+   for(size_t vi = 0; vi < gm.numberOfVariables(); ++vi) {
+      labels[vi] = rand() % gm.numberOfLabels(vi);
+      optimizer.setLabel(vi, labels[vi]);
+      pooledOptimizer.setLabel(vi, labels[vi]);
+   }
+   // rows, columns and combs of a 5x5 grid (acyclic submodels)
+   std::vector<std::vector<size_t> > submodels;
+   for(size_t i = 0; i < 5; ++i) {
+      std::vector<size_t> row, column;
+      for(size_t j = 0; j < 5; ++j) {
+         row.push_back(i * 5 + j);
+         column.push_back(j * 5 + i);
+      }
+      std::sort(column.begin(), column.end());
+      submodels.push_back(row);
+      submodels.push_back(column);
+   }
+   std::vector<size_t> comb;
+   for(size_t vi = 0; vi < 25; ++vi) {
+      if(vi < 5 || vi % 5 == 0 || vi % 5 == 2 || vi % 5 == 4) {
+         comb.push_back(vi);
+      }
+   }
+   submodels.push_back(comb);
+   for(size_t s = 0; s < submodels.size(); ++s) {
+      std::vector<size_t> states, pooledStates;
+      optimizer.setVariableIndices(submodels[s].begin(), submodels[s].end());
+      pooledOptimizer.setVariableIndices(submodels[s].begin(), submodels[s].end());
+      const bool changes = optimizer.mergeFactorsAndInferDp(states);
+      const bool pooledChanges = pooledOptimizer.inferDynamicProgramming(pooledStates);
+      optimizer.unsetVariableIndices();
+      pooledOptimizer.unsetVariableIndices();
+      OPENGM_TEST(changes == pooledChanges);
+      std::vector<size_t> x = labels, y = labels;
+      for(size_t v = 0; v < submodels[s].size(); ++v) {
+         x[submodels[s][v]] = states[v];
+         y[submodels[s][v]] = pooledStates[v];
+      }
+      OPENGM_TEST_EQUAL_TOLERANCE(gm.evaluate(x.begin()), gm.evaluate(y.begin()), 1e-6);
+   }
+}
+
+// batches of non-overlapping windows: the result does not depend on the
+// number of threads and the energy does not increase
+template<class GM>
+void testParallel(const GM & gm) {
+   typedef opengm::LOC<GM, opengm::Minimizer> LOC;
+   std::vector<size_t> start(gm.numberOfVariables(), 0);
+   std::vector<double> values;
+   for(size_t threads = 1; threads <= 3; ++threads) {
+      srand(0);
+      typename LOC::Parameter para("astar", 0.5, 2, 5, 0.9, 100000, 10000, 8, 0, 1, true, threads);
+      LOC loc(gm, para);
+      loc.setStartingPoint(start.begin());
+      loc.infer();
+      values.push_back(loc.value());
+   }
+   OPENGM_TEST(values[0] <= gm.evaluate(start.begin()));
+   OPENGM_TEST_EQUAL_TOLERANCE(values[0], values[1], 1e-8);
+   OPENGM_TEST_EQUAL_TOLERANCE(values[0], values[2], 1e-8);
+}
+
 int main() {
 
    typedef opengm::GraphicalModel<double, opengm::Adder> SumGmType;
@@ -35,7 +107,38 @@ int main() {
    // prodTester.addTest(new ProdGridTest(3,4 , 2, false, true, ProdGridTest::RANDOM, opengm::PASS, 5));
    //prodTester.addTest(new ProdFullTest(4,    3, false,    3, ProdFullTest::RANDOM, opengm::PASS, 5));
    
+   {
+      std::cout << "  * Pooled submodel optimizer ..." << std::endl;
+      SumGridTest test(5, 5, 3, false, true, SumGridTest::RANDOM, opengm::PASS, 1);
+      for(size_t i = 0; i < 5; ++i) {
+         testPooledDynamicProgramming(test.getModel(i));
+      }
+      std::cout << " OK!"<<std::endl;
+   }
+
+   {
+      std::cout << "  * Parallel windows ..." << std::endl;
+      SumGridTest test(6, 6, 3, false, true, SumGridTest::RANDOM, opengm::PASS, 1);
+      for(size_t i = 0; i < 3; ++i) {
+         testParallel(test.getModel(i));
+      }
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      // the default subsolver is available in every build
+      std::cout << "  * Default parameter ..." << std::endl;
+      typedef opengm::LOC<SumGmType, opengm::Minimizer> LOC;
+      SumGridTest test(4, 4, 2, false, true, SumGridTest::POTTS, opengm::PASS, 1);
+      const SumGmType gm = test.getModel(0);
+      LOC::Parameter para;
+      para.maxIterations_ = 20;
+      LOC loc(gm, para);
+      OPENGM_TEST(loc.infer() == opengm::NORMAL);
+      std::cout << " OK!"<<std::endl;
+   }
+
    //const size_t ad3Threshold=4;
+#ifdef WITH_AD3
    std::cout << "LOC -AD3 Tests ..." << std::endl;
    {
       std::cout << "  * Maximization/Adder  ..." << std::endl;
@@ -51,7 +154,23 @@ int main() {
       sumTester.test<LOC>(para);
       std::cout << " OK!"<<std::endl;
    }
+#endif
    std::cout << "LOC -ASTAR Tests ..." << std::endl;
+   {
+      std::cout << "  * Minimization/Adder  ..." << std::endl;
+      typedef opengm::LOC<SumGmType, opengm::Minimizer> LOC;
+      LOC::Parameter para("astar",0.5,2,0,0.9,100000,10000,8);
+      sumTester.test<LOC>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   {
+      std::cout << "  * Minimization/Adder (parallel) ..." << std::endl;
+      typedef opengm::LOC<SumGmType, opengm::Minimizer> LOC;
+      LOC::Parameter para("astar",0.5,2,10,0.9,100000,10000,8,0,1,true);
+      sumTester.test<LOC>(para);
+      std::cout << " OK!"<<std::endl;
+   }
+   std::cout << "LOC -DP Tests ..." << std::endl;
    {
       std::cout << "  * Maximization/Adder  ..." << std::endl;
       typedef opengm::LOC<SumGmType, opengm::Maximizer> LOC;
@@ -0,0 +1,102 @@
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/operations/maximizer.hxx>
+
+#include <opengm/unittests/blackboxtester.hxx>
+#include <opengm/unittests/blackboxtests/blackboxtestgrid.hxx>
+#include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
+#include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
+
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/unittests/test.hxx>
+#include <opengm/inference/lpbuiltin.hxx>
+
+#include <iostream>
+
+int main(){
+   {
+      typedef opengm::GraphicalModel<double, opengm::Adder > SumGmType;
+      typedef opengm::BlackBoxTestGrid<SumGmType> SumGridTest;
+      typedef opengm::BlackBoxTestFull<SumGmType> SumFullTest;
+      typedef opengm::BlackBoxTestStar<SumGmType> SumStarTest;
+
+      opengm::InferenceBlackBoxTester<SumGmType> sumTester;
+      sumTester.addTest(new SumGridTest(4, 4, 2, false, true, SumGridTest::RANDOM, opengm::PASS, 5));
+      sumTester.addTest(new SumGridTest(4, 4, 2, false, false,SumGridTest::RANDOM, opengm::PASS, 5));
+      sumTester.addTest(new SumStarTest(6,    4, false, true, SumStarTest::RANDOM, opengm::PASS, 20));
+      sumTester.addTest(new SumFullTest(5,    2, false, 3,    SumFullTest::RANDOM, opengm::PASS, 5));
+
+      // the local polytope relaxation is tight for tree structured models
+      opengm::InferenceBlackBoxTester<SumGmType> sumTesterOpt;
+      sumTesterOpt.addTest(new SumStarTest(6,    4, false, true, SumStarTest::RANDOM, opengm::OPTIMAL, 20));
+
+      std::cout << "LPBuiltin Tests"<<std::endl;
+      {
+         std::cout << "  * Minimization/Adder LP ..."<<std::endl;
+         typedef opengm::GraphicalModel<double,opengm::Adder > GmType;
+         typedef opengm::LPBuiltin<GmType, opengm::Minimizer>    BUILTIN;
+         BUILTIN::Parameter para;
+         sumTester.test<BUILTIN>(para);
+         sumTesterOpt.test<BUILTIN>(para);
+         para.relaxation_ = BUILTIN::Parameter::LoosePolytope;
+         sumTester.test<BUILTIN>(para);
+         sumTesterOpt.test<BUILTIN>(para);
+         para.challengeHeuristic_ = BUILTIN::Parameter::Weighted;
+         para.maxNumConstraintsPerIter_ = 10;
+         sumTester.test<BUILTIN>(para);
+         std::cout << " OK!"<<std::endl;
+      }
+      {
+         std::cout << "  * Maximization/Adder LP ..."<<std::endl;
+         typedef opengm::GraphicalModel<double,opengm::Adder > GmType;
+         typedef opengm::LPBuiltin<GmType, opengm::Maximizer>    BUILTIN;
+         BUILTIN::Parameter para;
+         sumTester.test<BUILTIN>(para);
+         sumTesterOpt.test<BUILTIN>(para);
+         para.relaxation_ = BUILTIN::Parameter::LoosePolytope;
+         para.numberOfThreads_ = 2;
+         sumTester.test<BUILTIN>(para);
+         std::cout << " OK!"<<std::endl;
+      }
+      {
+         std::cout << "  * Bulk and per constraint assembly ..."<<std::endl;
+         typedef opengm::GraphicalModel<double,opengm::Adder > GmType;
+         typedef opengm::LPBuiltin<GmType, opengm::Minimizer>    BUILTIN;
+         opengm::BlackBoxTestFull<GmType> fullTest(4, 3, false, 3, opengm::BlackBoxTestFull<GmType>::RANDOM, opengm::PASS, 1);
+         const GmType gm = fullTest.getModel(0);
+         BUILTIN::Parameter para;
+         para.numberOfThreads_ = 2;
+         for(size_t relaxation = 0; relaxation < 2; ++relaxation) {
+            para.relaxation_ = relaxation == 0 ? BUILTIN::Parameter::LocalPolytope : BUILTIN::Parameter::LoosePolytope;
+            para.nameConstraints_ = false;
+            BUILTIN bulk(gm, para);
+            bulk.infer();
+            para.nameConstraints_ = true;
+            BUILTIN named(gm, para);
+            named.infer();
+            // same rows in the same order
+            OPENGM_TEST(bulk.bound() == named.bound());
+            OPENGM_TEST(bulk.value() == named.value());
+         }
+         std::cout << " OK!"<<std::endl;
+      }
+      {
+         std::cout << "  * Integer constraints are rejected ..."<<std::endl;
+         typedef opengm::GraphicalModel<double,opengm::Adder > GmType;
+         typedef opengm::LPBuiltin<GmType, opengm::Minimizer>    BUILTIN;
+         const size_t numbersOfLabels[] = {2, 2, 2};
+         GmType gm(opengm::DiscreteSpace<size_t, size_t>(numbersOfLabels, numbersOfLabels + 3));
+         BUILTIN::Parameter para;
+         para.integerConstraintNodeVar_ = true;
+         bool exceptionThrown = false;
+         try {
+            BUILTIN lp(gm, para);
+         } catch(opengm::RuntimeError&) {
+            exceptionThrown = true;
+         }
+         OPENGM_TEST(exceptionThrown);
+         std::cout << " OK!"<<std::endl;
+      }
+   }
+   return 0;
+}
@@ -2,7 +2,10 @@
 #include <iostream>
 #include <stdlib.h>
 #include <limits>
+#include <cmath>
 
+#include <opengm/unittests/test.hxx>
+#include <opengm/inference/auxiliary/minstcutbk.hxx>
 #ifdef WITH_MAXFLOW 
 #  include <opengm/inference/auxiliary/minstcutkolmogorov.hxx>
 #endif
@@ -121,6 +124,59 @@ void test4()
    alg.calculateCut(cut);
 }
 
+// changes of the capacities after a max-flow computation are continued
+// from the previous flow and search trees
+template<class ALG>
+void testReuse(size_t id)
+{
+   srand(id);
+   const size_t numberOfNodes = 30;
+   const size_t numberOfArcs = 100;
+   std::vector<size_t> tails, heads;
+   std::vector<typename ALG::ValueType> capacities;
+   std::vector<typename ALG::ValueType> source(numberOfNodes, 0), sink(numberOfNodes, 0);
+   ALG alg;
+   alg.addNodes(numberOfNodes);
+   for(size_t i = 0; i < numberOfArcs; ++i) {
+      const size_t n1 = rand() % numberOfNodes;
+      const size_t n2 = (n1 + 1 + rand() % (numberOfNodes - 1)) % numberOfNodes;
+      tails.push_back(n1);
+      heads.push_back(n2);
+      capacities.push_back(rand() % 100);
+      alg.addArcs(n1, n2, capacities.back(), 0);
+   }
+   for(size_t i = 0; i < numberOfNodes; ++i) {
+      source[i] = rand() % 100;
+      sink[i] = rand() % 100;
+      alg.addTerminalWeights(i, source[i], sink[i]);
+   }
+   alg.maxflow();
+   for(size_t round = 0; round < 5; ++round) {
+      for(size_t k = 0; k < 5; ++k) {
+         const size_t i = rand() % numberOfNodes;
+         const typename ALG::ValueType deltaSource = static_cast<typename ALG::ValueType>(rand() % 100) - source[i] / 2;
+         const typename ALG::ValueType deltaSink = static_cast<typename ALG::ValueType>(rand() % 100) - sink[i] / 2;
+         source[i] += deltaSource;
+         sink[i] += deltaSink;
+         alg.addTerminalWeights(i, deltaSource, deltaSink);
+      }
+      const typename ALG::ValueType flow = alg.maxflow(true);
+
+      ALG fresh;
+      fresh.addNodes(numberOfNodes);
+      for(size_t i = 0; i < numberOfArcs; ++i) {
+         fresh.addArcs(tails[i], heads[i], capacities[i], 0);
+      }
+      for(size_t i = 0; i < numberOfNodes; ++i) {
+         fresh.addTerminalWeights(i, source[i], sink[i]);
+      }
+      OPENGM_TEST(std::fabs(flow - fresh.maxflow()) < 1e-6);
+      for(size_t i = 0; i < numberOfNodes; ++i) {
+         OPENGM_TEST(alg.inSinkTree(i) == fresh.inSinkTree(i));
+      }
+   }
+}
+
 template<class ALG>
 void test(size_t numTests)
 {
@@ -142,6 +198,15 @@ void test(size_t numTests)
 int main()
 {
    std::cout << "MinStCut Test ... "<<std::endl;
+   {
+      std::cout << "  * Test Boykov-Kolmogorov ... " << std::flush;
+      typedef opengm::MinSTCutBK<size_t, float> ALG;
+      test<ALG>(5);
+      for(size_t id = 0; id < 5; ++id)
+         testReuse<opengm::MinSTCutBK<size_t, double> >(id);
+      std::cout << "*" << std::flush;
+      std::cout << " OK!" << std::endl;
+   }
 #ifdef WITH_MAXFLOW
    {
       std::cout << "  * Test Kolomogorov ... " << std::flush;
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <vector>
+#include <string>
 #include <set>
 #include <functional>
 
@@ -10,6 +11,7 @@
 #include <opengm/operations/maximizer.hxx>
 
 
+#include <opengm/functions/explicit_function.hxx>
 #include <opengm/inference/mqpbo.hxx>
 
 #include <opengm/unittests/blackboxtester.hxx>
@@ -17,6 +19,22 @@
 #include <opengm/unittests/blackboxtests/blackboxtestfull.hxx>
 #include <opengm/unittests/blackboxtests/blackboxteststar.hxx>
 
+// counts the calls and stops the inference after maxCalls calls
+template<class INF>
+struct StoppingVisitor {
+   StoppingVisitor(const size_t maxCalls) : calls_(0), maxCalls_(maxCalls) {}
+   void begin(INF&) {}
+   size_t operator()(INF&) {
+      ++calls_;
+      return calls_ < maxCalls_ ? opengm::visitors::VisitorReturnFlag::ContinueInf : opengm::visitors::VisitorReturnFlag::StopInfTimeout;
+   }
+   void end(INF&) {}
+   void addLog(const std::string&) {}
+   void log(const std::string&, const double) {}
+   size_t calls_;
+   size_t maxCalls_;
+};
+
 int main() {
    typedef opengm::GraphicalModel<double, opengm::Adder > AdderGmType;
    typedef opengm::BlackBoxTestGrid<AdderGmType> AdderGridTest;
@@ -67,6 +85,81 @@ int main() {
          adderTester2.test<MQPBOType > (para);   
       }
 
+      {
+         std::cout << "  * Kovtuns method with one and several threads ..." << std::endl;
+         typedef opengm::GraphicalModel<double, opengm::Adder> GmType;
+         typedef opengm::MQPBO<GmType,opengm::Minimizer> MQPBOType;
+         const size_t nx = 20;
+         const size_t ny = 20;
+         const size_t numberOfLabels = 20;
+         srand(0);
+         std::vector<size_t> numbersOfLabels(nx * ny, numberOfLabels);
+         GmType gm(opengm::DiscreteSpace<size_t, size_t>(numbersOfLabels.begin(), numbersOfLabels.end()));
+         const size_t shape[] = {numberOfLabels, numberOfLabels};
+         for(size_t v = 0; v < nx * ny; ++v) {
+            opengm::ExplicitFunction<double> f(shape, shape + 1);
+            const size_t label = (v % nx) * numberOfLabels / nx;
+            for(size_t l = 0; l < numberOfLabels; ++l) {
+               f(l) = (l == label ? 0.0 : 1.0) + 0.4 * rand() / RAND_MAX;
+            }
+            gm.addFactor(gm.addFunction(f), &v, &v + 1);
+         }
+         opengm::ExplicitFunction<double> potts(shape, shape + 2, 0.4);
+         for(size_t l = 0; l < numberOfLabels; ++l) {
+            potts(l, l) = 0.0;
+         }
+         const GmType::FunctionIdentifier fid = gm.addFunction(potts);
+         for(size_t y = 0; y < ny; ++y)
+         for(size_t x = 0; x < nx; ++x) {
+            const size_t v = x + nx * y;
+            if(x + 1 < nx) {
+               const size_t vis[] = {v, v + 1};
+               gm.addFactor(fid, vis, vis + 2);
+            }
+            if(y + 1 < ny) {
+               const size_t vis[] = {v, v + nx};
+               gm.addFactor(fid, vis, vis + 2);
+            }
+         }
+         MQPBOType::Parameter para;
+         para.numberOfThreads_ = 1;
+         MQPBOType mqpbo1(gm, para);
+         mqpbo1.infer();
+         para.numberOfThreads_ = 0;
+         MQPBOType mqpbo2(gm, para);
+         mqpbo2.infer();
+         OPENGM_TEST(mqpbo1.optimality() > 0.5);
+         for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+            for(size_t l = 0; l < numberOfLabels; ++l) {
+               const opengm::Tribool a = mqpbo1.partialOptimality(v)[l];
+               const opengm::Tribool b = mqpbo2.partialOptimality(v)[l];
+               OPENGM_TEST(a.maybe() == b.maybe() && bool(a) == bool(b));
+            }
+         }
+         std::cout << " OK!" << std::endl;
+
+         std::cout << "  * Kovtuns method stopped by the visitor ..." << std::endl;
+         para.numberOfThreads_ = 1;
+         MQPBOType mqpbo3(gm, para);
+         StoppingVisitor<MQPBOType> visitor3(3);
+         mqpbo3.infer(visitor3);
+         para.numberOfThreads_ = 0;
+         MQPBOType mqpbo4(gm, para);
+         StoppingVisitor<MQPBOType> visitor4(3);
+         mqpbo4.infer(visitor4);
+         OPENGM_TEST_EQUAL(visitor3.calls_, 3);
+         OPENGM_TEST_EQUAL(visitor4.calls_, 3);
+         OPENGM_TEST(mqpbo3.optimality() < mqpbo1.optimality());
+         for(size_t v = 0; v < gm.numberOfVariables(); ++v) {
+            for(size_t l = 0; l < numberOfLabels; ++l) {
+               const opengm::Tribool a = mqpbo3.partialOptimality(v)[l];
+               const opengm::Tribool b = mqpbo4.partialOptimality(v)[l];
+               OPENGM_TEST(a.maybe() == b.maybe() && bool(a) == bool(b));
+            }
+         }
+         std::cout << " OK!" << std::endl;
+      }
+
     }
    return 0;
 }
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <vector>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/graphicalmodel/space/simplediscretespace.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
+#include <opengm/inference/bruteforce.hxx>
+#include <opengm/inference/multicut-heuristic.hxx>
+
+typedef opengm::SimpleDiscreteSpace<size_t, size_t> Space;
+typedef opengm::GraphicalModel<double, opengm::Adder, OPENGM_TYPELIST_2(opengm::ExplicitFunction<double>, opengm::PottsFunction<double>), Space> Model;
+typedef opengm::MulticutHeuristic<Model, opengm::Minimizer> MulticutHeuristic;
+
+void addEdge(Model& gm, const size_t v0, const size_t v1, const double weight) {
+   const size_t vis[] = {v0, v1};
+   const size_t n = gm.numberOfVariables();
+   gm.addFactor(gm.addFunction(opengm::PottsFunction<double>(n, n, 0.0, weight)), vis, vis + 2);
+}
+
+double run(const Model& gm, const MulticutHeuristic::Parameter& parameter, std::vector<size_t>& labels) {
+   MulticutHeuristic mc(gm, parameter);
+   OPENGM_TEST(mc.infer() == opengm::NORMAL);
+   OPENGM_TEST(mc.arg(labels) == opengm::NORMAL);
+   OPENGM_TEST(labels.size() == gm.numberOfVariables());
+   OPENGM_TEST_EQUAL_TOLERANCE(mc.value(), gm.evaluate(labels.begin()), 1e-8);
+   return mc.value();
+}
+
+// two cliques with attractive edges, connected by repulsive edges
+void twoCliquesTest() {
+   Model gm(Space(8, 8));
+   for(size_t i = 0; i < 8; ++i)
+   for(size_t j = i + 1; j < 8; ++j) {
+      addEdge(gm, i, j, (i < 4) == (j < 4) ? 1.0 : -1.0);
+   }
+   std::vector<size_t> labels;
+   MulticutHeuristic::Parameter parameter(false);
+   OPENGM_TEST_EQUAL_TOLERANCE(run(gm, parameter, labels), -16.0, 1e-8);
+   for(size_t i = 0; i < 8; ++i) {
+      OPENGM_TEST((labels[i] == labels[0]) == (i < 4));
+   }
+}
+
+// compares greedy contraction, Kernighan-Lin and fusion on small random
+// graphs to the optimum
+void randomTest() {
+   srand(0);
+   const size_t numberOfVariables = 7;
+   for(size_t test = 0; test < 10; ++test) {
+      Model gm(Space(numberOfVariables, numberOfVariables));
+      for(size_t i = 0; i < numberOfVariables; ++i)
+      for(size_t j = i + 1; j < numberOfVariables; ++j) {
+         if(rand() % 3 != 0) {
+            addEdge(gm, i, j, 2.0 * rand() / RAND_MAX - 1.0);
+         }
+      }
+      opengm::Bruteforce<Model, opengm::Minimizer> bruteforce(gm);
+      bruteforce.infer();
+      const double optimum = bruteforce.value();
+
+      std::vector<size_t> labels;
+      const double greedy = run(gm, MulticutHeuristic::Parameter(false), labels);
+      const double kernighanLin = run(gm, MulticutHeuristic::Parameter(true), labels);
+      MulticutHeuristic::Parameter fusionParameter(true, 4);
+      fusionParameter.numberOfThreads_ = 1;
+      const double fusion = run(gm, fusionParameter, labels);
+      fusionParameter.numberOfThreads_ = 3;
+      std::vector<size_t> labels3;
+      const double fusion3 = run(gm, fusionParameter, labels3);
+      OPENGM_TEST(optimum <= greedy + 1e-8);
+      OPENGM_TEST(optimum <= fusion + 1e-8);
+      OPENGM_TEST(kernighanLin <= greedy + 1e-8);
+      OPENGM_TEST(fusion <= kernighanLin + 1e-8);
+      OPENGM_TEST(fusion == fusion3);
+      OPENGM_TEST(labels == labels3);
+   }
+}
+
+void invalidModelTest() {
+   Model gm(Space(3, 3));
+   addEdge(gm, 0, 1, 1.0);
+   const size_t shape[] = {3};
+   opengm::ExplicitFunction<double> f(shape, shape + 1, 0.0);
+   const size_t vi[] = {2};
+   gm.addFactor(gm.addFunction(f), vi, vi + 1);
+   bool exceptionThrown = false;
+   try {
+      MulticutHeuristic mc(gm);
+   }
+   catch(opengm::RuntimeError&) {
+      exceptionThrown = true;
+   }
+   OPENGM_TEST(exceptionThrown);
+}
+
+int main() {
+   std::cout << "Multicut Heuristic Tests ..." << std::endl;
+   twoCliquesTest();
+   randomTest();
+   invalidModelTest();
+   std::cout << "done!" << std::endl;
+   return 0;
+}
@@ -10,6 +10,8 @@
 #include <opengm/operations/minimizer.hxx>
 #include <opengm/operations/maximizer.hxx>
 #include <opengm/inference/qpbo.hxx>
+#include <opengm/inference/auxiliary/minstcutbk.hxx>
+#include <opengm/unittests/test.hxx>
 
 #include <opengm/unittests/blackboxtester.hxx>
 #include <opengm/unittests/blackboxtests/blackboxtestgrid.hxx>
@@ -47,6 +49,48 @@ struct QPBOTest
   }
 };
 */
+
+// the persistencies of probing, weak persistencies and improve are
+// compared with an exhaustive search
+template<class QPBO>
+void testPartialOptimality(typename QPBO::Parameter para) {
+   typedef opengm::GraphicalModel<double, opengm::Adder> GmType;
+   typedef opengm::BlackBoxTestFull<GmType> FullTest;
+   typedef typename GmType::LabelType LabelType;
+   for(size_t id = 0; id < 10; ++id) {
+      FullTest test(8, 2, false, 2, FullTest::RANDOM, opengm::PASS, 1);
+      const GmType gm = test.getModel(id);
+      std::vector<LabelType> labeling(gm.numberOfVariables());
+      double optimum = std::numeric_limits<double>::infinity();
+      for(size_t n = 0; n < (size_t(1) << gm.numberOfVariables()); ++n) {
+         for(size_t i = 0; i < gm.numberOfVariables(); ++i) {
+            labeling[i] = (n >> i) & 1;
+         }
+         optimum = std::min(optimum, gm.evaluate(labeling.begin()));
+      }
+
+      QPBO qpbo(gm, para);
+      qpbo.infer();
+      std::vector<LabelType> arg;
+      std::vector<bool> opt;
+      qpbo.arg(arg);
+      qpbo.partialOptimality(opt);
+      OPENGM_TEST(qpbo.bound() <= optimum + 1e-6);
+      double constrainedOptimum = std::numeric_limits<double>::infinity();
+      for(size_t n = 0; n < (size_t(1) << gm.numberOfVariables()); ++n) {
+         bool consistent = true;
+         for(size_t i = 0; i < gm.numberOfVariables(); ++i) {
+            labeling[i] = (n >> i) & 1;
+            consistent = consistent && (!opt[i] || labeling[i] == arg[i]);
+         }
+         if(consistent) {
+            constrainedOptimum = std::min(constrainedOptimum, gm.evaluate(labeling.begin()));
+         }
+      }
+      OPENGM_TEST_EQUAL_TOLERANCE(constrainedOptimum, optimum, 1e-6);
+   }
+}
+
 int main() {
 //void run() {
    typedef opengm::GraphicalModel<float, opengm::Adder> GraphicalModelType;
@@ -62,7 +106,45 @@ int main() {
    minTester.addTest(new FullTest(5,    2, false, 3,    FullTest::POTTS, opengm::OPTIMAL, 3));
    
    
+   opengm::InferenceBlackBoxTester<GraphicalModelType> nonSubmodularTester;
+   nonSubmodularTester.addTest(new GridTest(4, 4, 2, false, true, GridTest::RANDOM, opengm::PASS, 3));
+   nonSubmodularTester.addTest(new FullTest(6,    2, false, 3,    FullTest::RANDOM, opengm::PASS, 3));
+
    std::cout << "Test QPBO ..." << std::endl;
+
+   std::cout << "  * Test Min-Sum with Boykov-Kolmogorov" << std::endl;
+   {
+      typedef opengm::MinSTCutBK<size_t, float> MinStCutType;
+      typedef opengm::QPBO<GraphicalModelType, MinStCutType> MinQPBO;
+      MinQPBO::Parameter para;
+      minTester.test<MinQPBO>(para);
+   }
+   std::cout << "  * Test Min-Sum with weak persistencies, probing and improving" << std::endl;
+   {
+      typedef opengm::MinSTCutBK<size_t, float> MinStCutType;
+      typedef opengm::QPBO<GraphicalModelType, MinStCutType> MinQPBO;
+      MinQPBO::Parameter para;
+      para.strongPersistency_ = false;
+      minTester.test<MinQPBO>(para);
+      nonSubmodularTester.test<MinQPBO>(para);
+      para.useProbeing_ = true;
+      minTester.test<MinQPBO>(para);
+      nonSubmodularTester.test<MinQPBO>(para);
+      para.useImproveing_ = true;
+      nonSubmodularTester.test<MinQPBO>(para);
+
+      typedef opengm::GraphicalModel<double, opengm::Adder> GmType;
+      typedef opengm::QPBO<GmType, opengm::MinSTCutBK<size_t, double> > QPBOType;
+      QPBOType::Parameter p;
+      p.strongPersistency_ = false;
+      testPartialOptimality<QPBOType>(p);
+      p.strongPersistency_ = true;
+      p.useProbeing_ = true;
+      testPartialOptimality<QPBOType>(p);
+      p.strongPersistency_ = false;
+      p.useImproveing_ = true;
+      testPartialOptimality<QPBOType>(p);
+   }
    
 #ifdef WITH_MAXFLOW
    std::cout << "  * Test Min-Sum with Kolmogorov" << std::endl;
@@ -1,5 +1,4 @@
 #include <iostream>
-#ifdef WITH_QPBO
 #include <stdlib.h>
 #include <vector>
 #include <set>
@@ -65,17 +64,83 @@ struct RINFTest
     para.ConnectedComponents_ = true;
     std::cout << "    - Minimization/Adder (with persistency and CC) ..."<<std::endl;
     this->test<InfType>(para);
+    para.numberOfThreads_ = 2;
+    para.maxEnumerationSize_ = 3;
+    std::cout << "    - Minimization/Adder (with persistency and parallel CC) ..."<<std::endl;
+    this->test<InfType>(para);
+  };
+
+  // independent chains of 1 to 6 variables and a 3x3 grid, solved by
+  // enumeration and in parallel, compared to the sequential solution
+  void testComponents()
+  {
+    std::cout << "  * Independent subparts ..."<<std::endl;
+    typedef opengm::ReducedInferenceHelper<GraphicalModelType>::InfGmType InfGmType;
+    typedef opengm::Bruteforce<InfGmType, opengm::Minimizer>               SubInfType;
+    typedef opengm::ReducedInference<GraphicalModelType, opengm::Minimizer,SubInfType> InfType;
+
+    srand(0);
+    const size_t numberOfLabels = 3;
+    std::vector<std::pair<size_t, size_t> > edges;
+    size_t numberOfVariables = 0;
+    for(size_t length = 1; length <= 6; ++length){
+      for(size_t i = 0; i + 1 < length; ++i)
+        edges.push_back(std::make_pair(numberOfVariables + i, numberOfVariables + i + 1));
+      numberOfVariables += length;
+    }
+    for(size_t y = 0; y < 3; ++y)
+    for(size_t x = 0; x < 3; ++x){
+      const size_t v = numberOfVariables + 3 * y + x;
+      if(x + 1 < 3) edges.push_back(std::make_pair(v, v + 1));
+      if(y + 1 < 3) edges.push_back(std::make_pair(v, v + 3));
+    }
+    numberOfVariables += 9;
+
+    const std::vector<size_t> numbersOfLabels(numberOfVariables, numberOfLabels);
+    GraphicalModelType gm(opengm::DiscreteSpace<size_t, size_t>(numbersOfLabels.begin(), numbersOfLabels.end()));
+    const size_t shape[] = {numberOfLabels, numberOfLabels};
+    for(size_t v = 0; v < numberOfVariables; ++v){
+      ExplicitFunctionType f(shape, shape + 1);
+      for(size_t l = 0; l < numberOfLabels; ++l)
+        f(l) = static_cast<ValueType>(rand()) / RAND_MAX;
+      gm.addFactor(gm.addFunction(f), &v, &v + 1);
+    }
+    for(size_t e = 0; e < edges.size(); ++e){
+      ExplicitFunctionType f(shape, shape + 2);
+      for(size_t l0 = 0; l0 < numberOfLabels; ++l0)
+      for(size_t l1 = 0; l1 < numberOfLabels; ++l1)
+        f(l0, l1) = static_cast<ValueType>(rand()) / RAND_MAX;
+      const size_t vis[] = {edges[e].first, edges[e].second};
+      gm.addFactor(gm.addFunction(f), vis, vis + 2);
+    }
+
+    InfType::Parameter para;
+    para.ConnectedComponents_ = true;
+    para.maxEnumerationSize_ = 0;
+    para.numberOfThreads_ = 1;
+    InfType sequential(gm, para);
+    sequential.infer();
+
+    para.maxEnumerationSize_ = 4;
+    para.numberOfThreads_ = 3;
+    InfType parallel(gm, para);
+    parallel.infer();
+    OPENGM_TEST_EQUAL_TOLERANCE(sequential.value(), parallel.value(), 1e-8);
+    OPENGM_TEST_EQUAL_TOLERANCE(sequential.bound(), parallel.bound(), 1e-8);
+
+    // everything solved by enumeration
+    para.maxEnumerationSize_ = 9;
+    InfType enumeration(gm, para);
+    enumeration.infer();
+    OPENGM_TEST_EQUAL_TOLERANCE(sequential.value(), enumeration.value(), 1e-8);
+    std::cout << "    OK!"<<std::endl;
   };
 };
-#endif
+
 int main() {
-   #ifdef WITH_QPBO
    std::cout << "Reduced Inference Tests ..." << std::endl;
    {
-      RINFTest t; t.run();
+      RINFTest t; t.run(); t.testComponents();
    }
-   #else
-   std::cout << "Compiled withput QPBO , RINF-Tests  is disabled..." << std::endl;
-   #endif
    return 0;
 }
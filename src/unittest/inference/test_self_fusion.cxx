@@ -63,6 +63,41 @@ int main() {
          std::cout << " OK!"<<std::endl;
 
       }
+      {
+
+         std::cout << "  * Self Fusion  Belief Propagation  Minimization/Adder with QPBO fusion..."<<std::endl;
+         typedef opengm::GraphicalModel<double, opengm::Adder> GraphicalModelType;
+         typedef opengm::BeliefPropagationUpdateRules<GraphicalModelType,opengm::Minimizer> UpdateRulesType;
+         typedef opengm::MessagePassing<GraphicalModelType, opengm::Minimizer,UpdateRulesType, opengm::MaxDistance> InfType;
+         
+         typedef opengm::SelfFusion<InfType> SelfFusionInf;
+
+         InfType::Parameter infParam;
+         SelfFusionInf::Parameter selfFuseInfParam(1,SelfFusionInf::QpboFusion,infParam);
+         sumTester.test<SelfFusionInf>(selfFuseInfParam);
+         std::cout << " OK!"<<std::endl;
+
+      }
+      {
+
+         std::cout << "  * Self Fusion  Belief Propagation  Minimization/Adder pipelined..."<<std::endl;
+         typedef opengm::GraphicalModel<double, opengm::Adder> GraphicalModelType;
+         typedef opengm::BeliefPropagationUpdateRules<GraphicalModelType,opengm::Minimizer> UpdateRulesType;
+         typedef opengm::MessagePassing<GraphicalModelType, opengm::Minimizer,UpdateRulesType, opengm::MaxDistance> InfType;
+         
+         typedef opengm::SelfFusion<InfType> SelfFusionInf;
+
+         InfType::Parameter infParam;
+         SelfFusionInf::Parameter selfFuseInfParam(1,SelfFusionInf::QpboFusion,infParam);
+         selfFuseInfParam.pipelined_ = true;
+         selfFuseInfParam.numberOfThreads_ = 3;
+         sumTester.test<SelfFusionInf>(selfFuseInfParam);
+         selfFuseInfParam.fusionSolver_ = SelfFusionInf::LazyFlipperFusion;
+         selfFuseInfParam.queueSize_ = 1;
+         sumTester.test<SelfFusionInf>(selfFuseInfParam);
+         std::cout << " OK!"<<std::endl;
+
+      }
 
 
 
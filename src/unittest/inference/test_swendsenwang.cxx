@@ -21,7 +21,7 @@ public:
     typedef opengm::GraphicalModel<double, Operation> GraphicalModel;
     typedef opengm::SwendsenWang<GraphicalModel, Accumulation> SwendsenWang;
 
-    SwendsenWangTest();
+    SwendsenWangTest(const bool parallel = false);
     void run();
 
 private:
@@ -44,12 +44,18 @@ private:
 
 template<class OP, class ACC>
 inline
-SwendsenWangTest<OP, ACC>::SwendsenWangTest()
+SwendsenWangTest<OP, ACC>::SwendsenWangTest(const bool parallel)
 :   numberOfVariables(10),
     numberOfStates(2),
     parameter(1e5, 1e5),
     relativeTolerance(0.3)
-{}
+{
+    if(parallel) {
+       // every sweep relabels all clusters
+       parameter = typename SwendsenWang::Parameter(1e4, 1e3);
+       parameter.parallel_ = true;
+    }
+}
 
 #define VALUE_EQUAL(op,acc,ve,vu) \
     template<> inline double SwendsenWangTest<op, acc>::valueEqual() const { return ve; } \
@@ -139,7 +145,7 @@ void SwendsenWangTest<OP, ACC>::run()
 //   with true 1st order marginals computed by BP
 // - 2nd order marginals sampled using Swendsen-Wang
 //   with 2nd order marginals sampled using Gibbs
-void biasedModelTest() {
+void biasedModelTest(const bool parallel = false) {
    typedef opengm::GraphicalModel<double, opengm::Multiplier> GraphicalModel;
    typedef opengm::SwendsenWang<GraphicalModel, opengm::Maximizer> SwendsenWang;
    typedef opengm::Gibbs<GraphicalModel, opengm::Maximizer> Gibbs;
@@ -201,6 +207,11 @@ void biasedModelTest() {
    // sample 1st and 2nd order marginals using Swendsen Wang
    SwendsenWang::Parameter swParameter(numberOfSamplingSteps,
       numberOfBurnInSteps);
+   if(parallel) {
+      swParameter = SwendsenWang::Parameter(numberOfSamplingSteps / 10,
+         numberOfBurnInSteps / 100);
+      swParameter.parallel_ = true;
+   }
    SwendsenWang sw(gm, swParameter);
    opengm::SwendsenWangMarginalVisitor<SwendsenWang> visitor(gm);
    for(size_t j = 0; j < gm.numberOfVariables(); ++j) {
@@ -269,6 +280,9 @@ void biasedModelTest() {
 int main() {
    { SwendsenWangTest<opengm::Multiplier, opengm::Maximizer> test; test.run(); }
    { SwendsenWangTest<opengm::Adder, opengm::Minimizer> test; test.run(); }
+   { SwendsenWangTest<opengm::Multiplier, opengm::Maximizer> test(true); test.run(); }
+   { SwendsenWangTest<opengm::Adder, opengm::Minimizer> test(true); test.run(); }
    biasedModelTest();
+   biasedModelTest(true);
    return 0;
 }
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <vector>
+#include <limits>
+#include <iostream>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/inference/auxiliary/constraint_separation.hxx>
+
+typedef opengm::ViolatedConstraintPool<size_t, double> Pool;
+typedef opengm::CycleSeparation<size_t> Separation;
+
+// shortest path between the nodes of edge e without using e (Bellman-Ford)
+double shortestPathLength(const size_t numberOfNodes, const std::vector<std::pair<size_t, size_t> >& edges, const std::vector<double>& x, const size_t e) {
+   std::vector<double> distance(numberOfNodes, std::numeric_limits<double>::infinity());
+   distance[edges[e].first] = 0.0;
+   for(size_t i = 0; i < numberOfNodes; ++i)
+   for(size_t f = 0; f < edges.size(); ++f) {
+      if(f != e) {
+         const double w = std::max(0.0, x[f]);
+         distance[edges[f].second] = std::min(distance[edges[f].second], distance[edges[f].first] + w);
+         distance[edges[f].first] = std::min(distance[edges[f].first], distance[edges[f].second] + w);
+      }
+   }
+   return distance[edges[e].second];
+}
+
+void poolTest() {
+   std::cout << "  * ViolatedConstraintPool ..." << std::flush;
+   const size_t indices[][3] = {{3, 1, 2}, {1, 2, 3}, {1, 2, 4}, {5, 6, 7}};
+   const double coefficients[][3] = {{1, 1, -1}, {1, -1, 1}, {1, 1, -1}, {1, 1, -1}};
+   Pool pool(2, 2);
+   pool.add(0, indices[0], indices[0] + 3, coefficients[0], 0.0, 0.5, 0);
+   pool.add(1, indices[1], indices[1] + 3, coefficients[1], 0.0, 0.5, 1); // duplicate of 0
+   pool.add(1, indices[2], indices[2] + 3, coefficients[2], 0.0, 0.2, 2);
+   pool.add(0, indices[3], indices[3] + 3, coefficients[3], 0.0, 0.3, 3);
+   OPENGM_TEST(pool.merge() == 2);
+   OPENGM_TEST(pool.id(0) == 0);
+   OPENGM_TEST(pool.id(1) == 3);
+   OPENGM_TEST(pool.violation(0) == 0.5);
+   OPENGM_TEST(pool.termsEnd(0) - pool.termsBegin(0) == 3);
+   OPENGM_TEST(pool.termsBegin(0)->first == 1);
+   OPENGM_TEST(pool.termsBegin(0)[1].second == -1.0);
+   std::cout << " OK!" << std::endl;
+}
+
+// compares the separated cycle inequalities on random grids to an
+// exhaustive test of all edges
+void cycleTest() {
+   std::cout << "  * CycleSeparation ..." << std::flush;
+   srand(0);
+   const size_t width = 7;
+   const size_t height = 6;
+   const size_t numberOfNodes = width * height;
+   for(size_t test = 0; test < 10; ++test) {
+      Separation separation(numberOfNodes);
+      std::vector<std::pair<size_t, size_t> > edges;
+      for(size_t y = 0; y < height; ++y)
+      for(size_t x = 0; x < width; ++x) {
+         const size_t n = y * width + x;
+         if(x + 1 < width) {
+            OPENGM_TEST(separation.addEdge(n, n + 1) == edges.size());
+            edges.push_back(std::make_pair(n, n + 1));
+         }
+         if(y + 1 < height) {
+            OPENGM_TEST(separation.addEdge(n, n + width) == edges.size());
+            edges.push_back(std::make_pair(n, n + width));
+         }
+         if(x + 1 < width && y + 1 < height && rand() % 2 == 0) {
+            separation.addEdge(n, n + width + 1);
+            edges.push_back(std::make_pair(n, n + width + 1));
+         }
+      }
+      separation.finalize();
+      std::vector<double> x(edges.size());
+      for(size_t e = 0; e < edges.size(); ++e) {
+         x[e] = rand() % 4 == 0 ? static_cast<double>(rand()) / RAND_MAX : 0.05 * rand() / RAND_MAX;
+      }
+      std::vector<double> violation(edges.size(), 0.0);
+      size_t numberOfViolated = 0;
+      for(size_t e = 0; e < edges.size(); ++e) {
+         const double length = shortestPathLength(numberOfNodes, edges, x, e);
+         if(x[e] > 1e-8 && length < x[e] - 1e-8) {
+            violation[e] = x[e] - length;
+            ++numberOfViolated;
+         }
+      }
+
+      Separation::Parameter parameter;
+      Pool pool;
+      OPENGM_TEST(separation.separate(x, pool, parameter) == numberOfViolated);
+      for(size_t i = 0; i < pool.size(); ++i) {
+         const size_t e = pool.id(i);
+         OPENGM_TEST_EQUAL_TOLERANCE(pool.violation(i), violation[e], 1e-8);
+         OPENGM_TEST(i == 0 || pool.violation(i) <= pool.violation(i - 1));
+         // the terms form a cycle containing e with coefficient -1
+         double lhs = 0.0;
+         std::vector<size_t> degree(numberOfNodes, 0);
+         for(Pool::TermIteratorType it = pool.termsBegin(i); it != pool.termsEnd(i); ++it) {
+            OPENGM_TEST(it->second == (it->first == e ? -1.0 : 1.0));
+            lhs += it->second * x[it->first];
+            ++degree[edges[it->first].first];
+            ++degree[edges[it->first].second];
+         }
+         OPENGM_TEST_EQUAL_TOLERANCE(-lhs, pool.violation(i), 1e-8);
+         for(size_t n = 0; n < numberOfNodes; ++n) {
+            OPENGM_TEST(degree[n] == 0 || degree[n] == 2);
+         }
+      }
+
+      // at most 5 constraints, the most violated ones
+      Pool pool5(5);
+      OPENGM_TEST(separation.separate(x, pool5, parameter) == std::min<size_t>(5, numberOfViolated));
+      for(size_t i = 0; i < pool5.size(); ++i) {
+         OPENGM_TEST(pool5.id(i) == pool.id(i));
+      }
+
+      // chordless cycles
+      parameter.chordless_ = true;
+      separation.separate(x, pool, parameter);
+      for(size_t i = 0; i < pool.size(); ++i) {
+         std::vector<size_t> degree(numberOfNodes, 0);
+         for(Pool::TermIteratorType it = pool.termsBegin(i); it != pool.termsEnd(i); ++it) {
+            ++degree[edges[it->first].first];
+            ++degree[edges[it->first].second];
+         }
+         for(size_t e = 0; e < edges.size(); ++e) {
+            bool inCycle = false;
+            for(Pool::TermIteratorType it = pool.termsBegin(i); it != pool.termsEnd(i); ++it) {
+               inCycle = inCycle || it->first == e;
+            }
+            OPENGM_TEST(inCycle || degree[edges[e].first] == 0 || degree[edges[e].second] == 0);
+         }
+      }
+
+      #ifdef WITH_OPENMP
+      // the result does not depend on the number of threads
+      parameter.chordless_ = false;
+      parameter.numberOfThreads_ = 3;
+      Pool pool3;
+      separation.separate(x, pool3, parameter);
+      OPENGM_TEST(pool3.size() == numberOfViolated);
+      for(size_t i = 0; i < pool5.size(); ++i) {
+         OPENGM_TEST(pool3.id(i) == pool5.id(i));
+      }
+      #endif
+   }
+   std::cout << " OK!" << std::endl;
+}
+
+int main() {
+   std::cout << "Constraint Separation Tests" << std::endl;
+   poolTest();
+   cycleTest();
+   std::cout << "done!" << std::endl;
+   return 0;
+}
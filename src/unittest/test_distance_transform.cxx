@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <vector>
+#include <cmath>
+#include <iostream>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/utilities/distance_transform.hxx>
+
+// distance of each element to the nearest element with the label by exhaustive search
+void bruteForceDistances(const std::vector<size_t>& shape, const std::vector<size_t>& labels, const size_t label, std::vector<double>& distances) {
+   const size_t size = labels.size();
+   // the distance of the transform if no element has the label
+   double squaredExtents = 0.0;
+   for(size_t d = 0; d < shape.size(); ++d) {
+      squaredExtents += static_cast<double>(shape[d] * shape[d]);
+   }
+   distances.assign(size, std::sqrt(squaredExtents + 1.0));
+   for(size_t i = 0; i < size; ++i)
+   for(size_t j = 0; j < size; ++j) {
+      if(labels[j] != label) {
+         continue;
+      }
+      double squared = 0.0;
+      size_t a = i;
+      size_t b = j;
+      for(size_t d = 0; d < shape.size(); ++d) {
+         const double delta = static_cast<double>(a % shape[d]) - static_cast<double>(b % shape[d]);
+         squared += delta * delta;
+         a /= shape[d];
+         b /= shape[d];
+      }
+      distances[i] = std::min(distances[i], std::sqrt(squared));
+   }
+}
+
+void randomGridTest(const std::vector<size_t>& shape, const double density) {
+   opengm::EuclideanDistanceTransform<double> transform(shape.begin(), shape.end());
+   std::vector<size_t> labels(transform.size());
+   std::vector<double> distances;
+   std::vector<double> expected;
+   for(size_t test = 0; test < 10; ++test) {
+      for(size_t i = 0; i < labels.size(); ++i) {
+         labels[i] = static_cast<double>(rand()) / RAND_MAX < density ? 1 : 0;
+      }
+      for(size_t label = 0; label < 2; ++label) {
+         transform(labels.begin(), label, distances);
+         bruteForceDistances(shape, labels, label, expected);
+         OPENGM_TEST_EQUAL(distances.size(), expected.size());
+         for(size_t i = 0; i < distances.size(); ++i) {
+            OPENGM_TEST_EQUAL_TOLERANCE(distances[i], expected[i], 1e-8);
+         }
+      }
+   }
+}
+
+int main() {
+   srand(0);
+   std::cout << "EuclideanDistanceTransform test... " << std::flush;
+   std::vector<size_t> shape(1, 50);
+   randomGridTest(shape, 0.1);
+   shape.assign(2, 12);
+   shape[1] = 17;
+   randomGridTest(shape, 0.05);
+   randomGridTest(shape, 0.9);
+   shape.assign(3, 6);
+   shape[0] = 1;
+   randomGridTest(shape, 0.1);
+   shape[0] = 5;
+   randomGridTest(shape, 0.02);
+   // no element with the label, sqrt(1 + 4*4 + 4*4)
+   shape.assign(2, 4);
+   std::vector<size_t> labels(16, 0);
+   std::vector<double> distances;
+   opengm::EuclideanDistanceTransform<double> transform(shape.begin(), shape.end());
+   transform(labels.begin(), 1, distances);
+   for(size_t i = 0; i < distances.size(); ++i) {
+      OPENGM_TEST_EQUAL_TOLERANCE(distances[i], std::sqrt(33.0), 1e-8);
+   }
+   std::cout << "OK!" << std::endl;
+   return 0;
+}
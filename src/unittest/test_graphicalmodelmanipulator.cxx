@@ -3,6 +3,7 @@
 #include <opengm/unittests/test.hxx>
 #include <opengm/graphicalmodel/graphicalmodel_manipulator.hxx>
 #include <opengm/operations/adder.hxx>
+#include <opengm/operations/minimizer.hxx>
 
 
 struct ManipulatorTest {
@@ -80,6 +81,26 @@ struct ManipulatorTest {
       for(IndexType i=0; i<l1.size();++i)
          OPENGM_ASSERT(l1[i]==l2x[i]);
       
+      std::cout << "fix small submodels ..."<<std::endl;
+      opengm::GraphicalModelManipulator<GraphicalModelType> gmm2(gm);
+      gmm2.fixVariable(0,2);
+      gmm2.fixVariable(3,2); 
+      gmm2.fixVariable(4,1); 
+      OPENGM_TEST_EQUAL(gmm2.fixSmallSubModels<opengm::Minimizer>(2), 2);
+      OPENGM_TEST(gmm2.isFixed(1) && gmm2.isFixed(2) && !gmm2.isFixed(5));
+      gmm2.lock();
+      gmm2.buildModifiedSubModels();
+      OPENGM_TEST_EQUAL(gmm2.numberOfSubmodels(), 1);
+      std::vector<std::vector<LabelType> > ll2(1, l2b);
+      std::vector<LabelType> l3;
+      gmm2.modifiedSubStates2OriginalState(ll2,l3);
+      // the labels of variables 1 and 2 are optimal
+      for(LabelType i=0; i<3; ++i)
+         for(LabelType j=0; j<3; ++j){
+            std::vector<LabelType> l4 = l3;
+            l4[1] = i; l4[2] = j;
+            OPENGM_TEST(gm.evaluate(l3) <= gm.evaluate(l4));
+         }
 
       return;
    }
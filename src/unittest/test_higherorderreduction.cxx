@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <iostream>
+
+#include <opengm/unittests/test.hxx>
+#include <opengm/graphicalmodel/graphicalmodel.hxx>
+#include <opengm/operations/adder.hxx>
+#include <opengm/functions/explicit_function.hxx>
+#include <opengm/functions/potts.hxx>
+#include <opengm/inference/auxiliary/higher_order_reduction.hxx>
+#include <opengm/inference/auxiliary/qpbo_graph.hxx>
+
+typedef opengm::HigherOrderReduction<double> Reduction;
+typedef Reduction::QuadraticType Quadratic;
+typedef opengm::GraphicalModel<
+   double, opengm::Adder,
+   opengm::meta::TypeListGenerator<
+      opengm::ExplicitFunction<double>,
+      opengm::PottsFunction<double>
+   >::type,
+   opengm::DiscreteSpace<>
+> Model;
+
+double randomValue() {
+   return static_cast<double>(rand() % 21) - 10.0;
+}
+
+// minimum of the quadratic function over the additional nodes by exhaustive search
+double minimumOverAdditional(const Quadratic& quadratic, std::vector<size_t>& labels, const size_t numberOfVariables) {
+   const size_t numberOfAdditional = quadratic.numberOfNodes() - numberOfVariables;
+   double minimum = std::numeric_limits<double>::infinity();
+   for(size_t a = 0; a < (size_t(1) << numberOfAdditional); ++a) {
+      for(size_t i = 0; i < numberOfAdditional; ++i) {
+         labels[numberOfVariables + i] = (a >> i) & 1;
+      }
+      minimum = std::min(minimum, quadratic.evaluate(labels.begin()));
+   }
+   return minimum;
+}
+
+// random polynomials with terms up to degree 4, the reduced function has to
+// agree with the polynomial for all labelings of the variables
+void polynomialTest(const Reduction::Method method) {
+   srand(0);
+   const size_t numberOfVariables = 5;
+   Reduction reduction(0, method);
+   Quadratic quadratic;
+   for(size_t test = 0; test < 50; ++test) {
+      reduction.reset(numberOfVariables);
+      std::vector<double> coefficients;
+      std::vector<std::vector<size_t> > terms;
+      for(size_t t = 0; t < 6; ++t) {
+         std::vector<size_t> term;
+         const size_t degree = static_cast<size_t>(rand() % 5);
+         while(term.size() < degree) {
+            const size_t v = static_cast<size_t>(rand() % numberOfVariables);
+            if(std::find(term.begin(), term.end(), v) == term.end()) {
+               term.push_back(v);
+            }
+         }
+         coefficients.push_back(randomValue());
+         terms.push_back(term);
+         reduction.addTerm(coefficients.back(), term.begin(), term.end());
+      }
+      // duplicate monomial, has to be merged
+      reduction.addTerm(1.0, terms[0].rbegin(), terms[0].rend());
+      coefficients.push_back(1.0);
+      terms.push_back(terms[0]);
+      reduction.reduce(quadratic);
+
+      std::vector<size_t> labels(quadratic.numberOfNodes(), 0);
+      for(size_t x = 0; x < (size_t(1) << numberOfVariables); ++x) {
+         double value = 0.0;
+         for(size_t t = 0; t < terms.size(); ++t) {
+            bool active = true;
+            for(size_t n = 0; n < terms[t].size(); ++n) {
+               active = active && ((x >> terms[t][n]) & 1);
+            }
+            value += active ? coefficients[t] : 0.0;
+         }
+         for(size_t i = 0; i < numberOfVariables; ++i) {
+            labels[i] = (x >> i) & 1;
+         }
+         OPENGM_TEST_EQUAL_TOLERANCE(minimumOverAdditional(quadratic, labels, numberOfVariables), value, 1e-8);
+      }
+   }
+}
+
+// factors of order 1 to 4 of a random model with binary variables
+void modelTest(const Reduction::Method method) {
+   srand(1);
+   const size_t numberOfVariables = 6;
+   Reduction reduction(0, method);
+   Quadratic quadratic;
+   for(size_t test = 0; test < 20; ++test) {
+      std::vector<size_t> numbersOfLabels(numberOfVariables, 2);
+      Model gm(opengm::DiscreteSpace<>(numbersOfLabels.begin(), numbersOfLabels.end()));
+      for(size_t f = 0; f < 6; ++f) {
+         const size_t order = 1 + f % 4;
+         std::vector<size_t> variables;
+         while(variables.size() < order) {
+            const size_t v = static_cast<size_t>(rand() % numberOfVariables);
+            if(std::find(variables.begin(), variables.end(), v) == variables.end()) {
+               variables.push_back(v);
+            }
+         }
+         std::sort(variables.begin(), variables.end());
+         if(order == 2 && test % 2 == 0) {
+            opengm::PottsFunction<double> function(2, 2, randomValue(), randomValue());
+            gm.addFactor(gm.addFunction(function), variables.begin(), variables.end());
+         }
+         else {
+            opengm::ExplicitFunction<double> function(numbersOfLabels.begin(), numbersOfLabels.begin() + order);
+            for(size_t n = 0; n < function.size(); ++n) {
+               function(n) = randomValue();
+            }
+            gm.addFactor(gm.addFunction(function), variables.begin(), variables.end());
+         }
+      }
+      reduction.addModel(gm);
+      reduction.reduce(quadratic);
+
+      std::vector<size_t> labels(quadratic.numberOfNodes(), 0);
+      for(size_t x = 0; x < (size_t(1) << numberOfVariables); ++x) {
+         for(size_t i = 0; i < numberOfVariables; ++i) {
+            labels[i] = (x >> i) & 1;
+         }
+         OPENGM_TEST_EQUAL_TOLERANCE(minimumOverAdditional(quadratic, labels, numberOfVariables), gm.evaluate(labels.begin()), 1e-8);
+      }
+
+      // the labels QPBO assigns to the variables are optimal
+      opengm::QPBOGraph<double> qr(static_cast<int>(quadratic.numberOfNodes()), static_cast<int>(quadratic.numberOfPairwiseTerms()));
+      quadratic.addTo(qr);
+      qr.Solve();
+      qr.ComputeWeakPersistencies();
+      double minimum = std::numeric_limits<double>::infinity();
+      for(size_t x = 0; x < (size_t(1) << numberOfVariables); ++x) {
+         for(size_t i = 0; i < numberOfVariables; ++i) {
+            labels[i] = (x >> i) & 1;
+         }
+         minimum = std::min(minimum, gm.evaluate(labels.begin()));
+      }
+      for(size_t x = 0; x < (size_t(1) << numberOfVariables); ++x) {
+         bool consistent = true;
+         for(size_t i = 0; i < numberOfVariables; ++i) {
+            labels[i] = (x >> i) & 1;
+            const int label = qr.GetLabel(static_cast<int>(i));
+            consistent = consistent && (label < 0 || label == static_cast<int>(labels[i]));
+         }
+         if(consistent) {
+            OPENGM_TEST(gm.evaluate(labels.begin()) >= minimum - 1e-8);
+         }
+      }
+      OPENGM_TEST(quadratic.constant() + 0.5 * qr.ComputeTwiceLowerBound() <= minimum + 1e-8);
+   }
+}
+
+void nonBinaryTest() {
+   std::vector<size_t> numbersOfLabels(2, 3);
+   Model gm(opengm::DiscreteSpace<>(numbersOfLabels.begin(), numbersOfLabels.end()));
+   opengm::PottsFunction<double> function(3, 3, 0.0, 1.0);
+   size_t variables[] = {0, 1};
+   gm.addFactor(gm.addFunction(function), variables, variables + 2);
+   Reduction reduction;
+   bool thrown = false;
+   try {
+      reduction.addModel(gm);
+   }
+   catch(opengm::RuntimeError&) {
+      thrown = true;
+   }
+   OPENGM_TEST(thrown);
+}
+
+int main() {
+   std::cout << "HigherOrderReduction test... " << std::endl;
+   std::cout << "  * HOCR ..." << std::flush;
+   polynomialTest(Reduction::HOCR);
+   modelTest(Reduction::HOCR);
+   std::cout << " OK!" << std::endl;
+   std::cout << "  * Fix ..." << std::flush;
+   polynomialTest(Reduction::Fix);
+   modelTest(Reduction::Fix);
+   std::cout << " OK!" << std::endl;
+   std::cout << "  * non-binary variables ..." << std::flush;
+   nonBinaryTest();
+   std::cout << " OK!" << std::endl;
+   return 0;
+}
@@ -1,8 +1,14 @@
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <string>
 #include <iterator>
+#include <vector>
 
 #include <opengm/unittests/test.hxx>
+#include <opengm/inference/auxiliary/lp_solver/lp_solver_builtin.hxx>
 
 #ifdef WITH_CPLEX
 #include <opengm/inference/auxiliary/lp_solver/lp_solver_cplex.hxx>
@@ -14,6 +20,7 @@
 
 template <class SOLVER_TYPE, class SOLVER_VALUE_TYPE, class PARAMETER1_TYPE, class PARAMETER1_VALUE_TYPE, class PARAMETER2_TYPE, class PARAMETER2_VALUE_TYPE>
 void testLPSolver(const SOLVER_VALUE_TYPE expectedInfinityValue, const PARAMETER1_TYPE timingParameter, const PARAMETER1_VALUE_TYPE maxTime, const PARAMETER2_TYPE threadParameter, const PARAMETER2_VALUE_TYPE maxNumThreads);
+void testLPSolverBuiltin();
 
 int main(int argc, char** argv){
   try{
@@ -29,6 +36,9 @@ int main(int argc, char** argv){
    testLPSolver<opengm::LPSolverGurobi>(GRB_INFINITY, GRB_DoubleParam_TimeLimit, 1.0, GRB_IntParam_Threads, 1);
 #endif
 
+   std::cout << "Test Builtin Solver" << std::endl;
+   testLPSolverBuiltin();
+
    std::cout << "done..." << std::endl;
    return 0;
   }
@@ -200,3 +210,159 @@ void testLPSolver(const SOLVER_VALUE_TYPE expectedInfinityValue, const PARAMETER
    ilpSolverMaximize.exportModel("ilpSolverMaximizeModel.lp");
    OPENGM_TEST(!std::remove("ilpSolverMaximizeModel.lp"));
 }
+
+// The built-in solver is a first order method, hence solutions are only
+// compared up to its tolerance. Optimality of random LPs is certified by the
+// duality gap between objectiveFunctionValue() and the Lagrangian bound.
+void testLPSolverBuiltin() {
+   typedef opengm::LPSolverBuiltin SolverType;
+   const double tolerance = 1e-4;
+
+   std::cout << "  * simplex" << std::endl;
+   {
+      SolverType lpSolverMinimize;
+      SolverType lpSolverMaximize;
+      OPENGM_TEST_EQUAL(SolverType::infinity(), std::numeric_limits<double>::infinity());
+      lpSolverMinimize.addContinuousVariables(3, 0.0, 1.0);
+      lpSolverMaximize.addContinuousVariables(3, 0.0, 1.0);
+      lpSolverMinimize.setObjective(SolverType::Minimize);
+      lpSolverMaximize.setObjective(SolverType::Maximize);
+      const double objectiveFunctionValues[] = {1.0, 2.0, 3.0};
+      lpSolverMinimize.setObjectiveValue(objectiveFunctionValues, objectiveFunctionValues + 3);
+      lpSolverMaximize.setObjectiveValue(objectiveFunctionValues, objectiveFunctionValues + 3);
+      const double constraintValues[] = {1.0, 1.0, 1.0};
+      const int constraintIndices[] = {0, 1, 2};
+      lpSolverMinimize.addEqualityConstraint(constraintIndices, constraintIndices + 3, constraintValues, 1.0, "Equality_Sum_Constraint");
+      lpSolverMaximize.addLessEqualConstraint(constraintIndices, constraintIndices + 3, constraintValues, 1.0, "Less_Equal_Sum_Constraint");
+      lpSolverMaximize.addGreaterEqualConstraint(constraintIndices, constraintIndices + 3, constraintValues, 1.0, "Greater_Equal_Sum_Constraint");
+      lpSolverMinimize.addConstraintsFinished();
+      lpSolverMaximize.addConstraintsFinished();
+      lpSolverMinimize.setParameter(SolverType::Threads, 1);
+      lpSolverMaximize.setParameter(SolverType::TimeLimit, 1.0);
+
+      OPENGM_TEST(lpSolverMinimize.solve());
+      double timing = -1.0;
+      OPENGM_TEST(lpSolverMaximize.solve(timing));
+      OPENGM_TEST(timing >= 0.0);
+      OPENGM_TEST(lpSolverMinimize.converged());
+      OPENGM_TEST(lpSolverMaximize.converged());
+      OPENGM_TEST_EQUAL(std::distance(lpSolverMinimize.solutionBegin(), lpSolverMinimize.solutionEnd()), 3);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.solution(0), 1.0, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMaximize.solution(2), 1.0, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.objectiveFunctionValue(), 1.0, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMaximize.objectiveFunctionValue(), 3.0, tolerance);
+      OPENGM_TEST(lpSolverMinimize.objectiveFunctionValueBound() <= 1.0);
+      OPENGM_TEST(lpSolverMaximize.objectiveFunctionValueBound() >= 3.0);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.objectiveFunctionValueBound(), 1.0, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMaximize.objectiveFunctionValueBound(), 3.0, tolerance);
+
+      // warm start after adding a constraint which cuts off the solution
+      const int cutIndices[] = {0};
+      lpSolverMinimize.addLessEqualConstraint(cutIndices, cutIndices + 1, constraintValues, 0.25);
+      OPENGM_TEST(lpSolverMinimize.solve());
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.solution(0), 0.25, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.solution(1), 0.75, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolverMinimize.objectiveFunctionValue(), 1.75, tolerance);
+
+      lpSolverMinimize.exportModel("lpSolverBuiltinModel.lp");
+      OPENGM_TEST(!std::remove("lpSolverBuiltinModel.lp"));
+   }
+
+   std::cout << "  * random transportation problems" << std::endl;
+   srand(0);
+   for(size_t test = 0; test < 10; ++test) {
+      // supply nodes 0..s-1, demand nodes s..s+d-1, a variable per pair
+      const int s = 4 + rand() % 5;
+      const int d = 4 + rand() % 5;
+      SolverType lpSolver;
+      lpSolver.addContinuousVariables(s * d, 0.0, SolverType::infinity());
+      std::vector<double> cost(s * d);
+      for(int k = 0; k < s * d; ++k) {
+         cost[k] = 1.0 + 9.0 * rand() / RAND_MAX;
+      }
+      lpSolver.setObjectiveValue(cost.begin(), cost.end());
+      std::vector<int> indices;
+      std::vector<double> ones(s > d ? s : d, 1.0);
+      for(int i = 0; i < s; ++i) {
+         indices.clear();
+         for(int j = 0; j < d; ++j) {
+            indices.push_back(i * d + j);
+         }
+         lpSolver.addLessEqualConstraint(indices.begin(), indices.end(), ones.begin(), static_cast<double>(d));
+      }
+      for(int j = 0; j < d; ++j) {
+         indices.clear();
+         for(int i = 0; i < s; ++i) {
+            indices.push_back(i * d + j);
+         }
+         lpSolver.addGreaterEqualConstraint(indices.begin(), indices.end(), ones.begin(), static_cast<double>(s) - 1.0);
+      }
+      OPENGM_TEST(lpSolver.solve());
+      OPENGM_TEST(lpSolver.converged());
+      const double value = lpSolver.objectiveFunctionValue();
+      const double bound = lpSolver.objectiveFunctionValueBound();
+      OPENGM_TEST(std::abs(value - bound) <= tolerance * (1.0 + value));
+      for(int j = 0; j < d; ++j) {
+         double inflow = 0.0;
+         for(int i = 0; i < s; ++i) {
+            OPENGM_TEST(lpSolver.solution(i * d + j) >= 0.0);
+            inflow += lpSolver.solution(i * d + j);
+         }
+         OPENGM_TEST(inflow >= static_cast<double>(s) - 1.0 - tolerance);
+      }
+   }
+
+   std::cout << "  * bulk constraints" << std::endl;
+   {
+      // x_0 + x_1 + x_2 = 1, 0.5 <= x_1 + x_2 <= 0.75 and a free row
+      SolverType lpSolver;
+      lpSolver.addContinuousVariables(3, 0.0, 1.0);
+      const double objectiveFunctionValues[] = {1.0, 2.0, 3.0};
+      lpSolver.setObjectiveValue(objectiveFunctionValues, objectiveFunctionValues + 3);
+      const size_t rowBegins[] = {0, 3, 5, 6};
+      const int variableIDs[] = {0, 1, 2, 1, 2, 0};
+      const double coefficients[] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+      const double lowerBounds[] = {1.0, 0.5, -lpSolver.infinity()};
+      const double upperBounds[] = {1.0, 0.75, lpSolver.infinity()};
+      lpSolver.addConstraints(rowBegins, rowBegins + 4, variableIDs, coefficients, lowerBounds, upperBounds);
+      const int namedIndices[] = {2};
+      lpSolver.addLessEqualConstraint(namedIndices, namedIndices + 1, coefficients, 1.0, "named");
+      lpSolver.addConstraintsFinished();
+      OPENGM_TEST(lpSolver.solve());
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolver.solution(0), 0.5, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolver.solution(1), 0.5, tolerance);
+      OPENGM_TEST_EQUAL_TOLERANCE(lpSolver.objectiveFunctionValue(), 1.5, tolerance);
+
+      // one name per row: the ranged row is split into two rows, the free
+      // row is dropped
+      lpSolver.exportModel("lpSolverBuiltinBulkModel.lp");
+      std::ifstream file("lpSolverBuiltinBulkModel.lp");
+      std::string line;
+      size_t numberOfRows = 0;
+      bool namedRowFound = false;
+      while(std::getline(file, line)) {
+         if(line.find(':') != std::string::npos && line.find(" obj:") != 0) {
+            ++numberOfRows;
+         }
+         if(line.find(" named: + 1 x2 <= 1") == 0) {
+            namedRowFound = true;
+         }
+      }
+      file.close();
+      OPENGM_TEST_EQUAL(numberOfRows, 4);
+      OPENGM_TEST(namedRowFound);
+      OPENGM_TEST(!std::remove("lpSolverBuiltinBulkModel.lp"));
+   }
+
+   std::cout << "  * integer variables are rejected" << std::endl;
+   {
+      SolverType lpSolver;
+      bool exceptionThrown = false;
+      try {
+         lpSolver.addBinaryVariables(1);
+      } catch(opengm::RuntimeError&) {
+         exceptionThrown = true;
+      }
+      OPENGM_TEST(exceptionThrown);
+   }
+}